@@ -1,11 +1,18 @@
 /**
  * exanic_pybind: ExaNIC C SDK 的 pybind11 封装（仅 Linux）
  *
- * 封装 exanic.h / fifo_rx.h 中的接口，供 Python 调用。ExaNIC SDK 为 C 源码，
+ * 封装 exanic.h / fifo_rx.h / fifo_tx.h 中的接口，供 Python 调用。ExaNIC SDK 为 C 源码，
  * 由 CMake 编译为静态库并链接进本模块。
  *
  * 暴露接口：acquire_handle, acquire_rx_buffer, receive_frame, release_rx_buffer,
+ * acquire_tx_buffer, transmit_frame, get_tx_timestamp, tx_ops, release_tx_buffer,
  * release_handle, get_last_error。句柄以 capsule 形式在 Python 间传递。
+ * tx_ops 返回 fq::TxOps capsule（见 native_pybind/include/fq/tx_ops.hpp），供
+ * native_pybind.UdpTickPublisher 在解码线程内直接写 TX 缓冲区。
+ *
+ * TX 端口与网卡句柄按引用计数释放（计数只在持有 GIL 时修改）：release_tx_buffer 只放下
+ * 句柄自身的引用，仍有 tx_ops 存活时 TX 缓冲区留到最后一个 ops capsule 回收；网卡上仍有
+ * 未释放的 TX 端口时 release_handle 同样推迟到最后一个端口释放之后。
  */
 
 #include <ctime>
@@ -16,16 +23,85 @@
 #include <Python.h>
 #include <cstring>
 #include <string>
+#include <unordered_map>
 
 extern "C" {
 #include "exanic.h"
+#include "exanic_time.h"
 #include "fifo_rx.h"
+#include "fifo_tx.h"
 }
 
+#include "fq/tx_ops.hpp"
+
 namespace py = pybind11;
 
 static const char* CAPSULE_EXANIC = "exanic_t";
 static const char* CAPSULE_EXANIC_RX = "exanic_rx_t";
+static const char* CAPSULE_EXANIC_TX = "exanic_tx_t";
+
+// TX 缓冲区 + 所属网卡（时间戳换算需要网卡句柄）+ 供 native 发布者调用的 TxOps
+struct ExanicTxPort {
+    exanic_t* nic;
+    exanic_tx_t* tx;
+    fq::TxOps ops;
+    int refs;  ///< TX 句柄 capsule 1 份 + 每个存活的 tx_ops capsule 1 份
+};
+
+// 网卡上未释放的 TX 端口数；closing 表示 release_handle 已调用、等最后一个端口释放
+struct NicRefs {
+    int ports = 0;
+    bool closing = false;
+};
+
+static std::unordered_map<exanic_t*, NicRefs> g_nic_refs;
+
+static void nic_unref(exanic_t* nic) {
+    auto it = g_nic_refs.find(nic);
+    if (it == g_nic_refs.end() || --it->second.ports > 0)
+        return;
+    bool closing = it->second.closing;
+    g_nic_refs.erase(it);
+    if (closing)
+        exanic_release_handle(nic);
+}
+
+static void port_unref(ExanicTxPort* port) {
+    if (--port->refs > 0)
+        return;
+    exanic_release_tx_buffer(port->tx);
+    nic_unref(port->nic);
+    delete port;
+}
+
+static char* tx_begin(void* ctx, size_t frame_size) {
+    return exanic_begin_transmit_frame(static_cast<ExanicTxPort*>(ctx)->tx, frame_size);
+}
+
+static int tx_end(void* ctx, size_t size) {
+    return exanic_end_transmit_frame(static_cast<ExanicTxPort*>(ctx)->tx, size);
+}
+
+static void tx_abort(void* ctx) {
+    exanic_abort_transmit_frame(static_cast<ExanicTxPort*>(ctx)->tx);
+}
+
+// 最近一帧的 32 位硬件时间戳展开为 64 位后换算为 ns（须在发送后数秒内调用）
+static int64_t tx_last_ns(void* ctx) {
+    ExanicTxPort* port = static_cast<ExanicTxPort*>(ctx);
+    exanic_cycles32_t ts = exanic_get_tx_timestamp(port->tx);
+    return exanic_cycles_to_ns(port->nic, exanic_expand_timestamp(port->nic, ts));
+}
+
+static ExanicTxPort* tx_port(py::object tx_cap) {
+    if (!PyCapsule_IsValid(tx_cap.ptr(), CAPSULE_EXANIC_TX))
+        throw std::runtime_error("invalid exanic_tx handle capsule");
+    return static_cast<ExanicTxPort*>(PyCapsule_GetPointer(tx_cap.ptr(), CAPSULE_EXANIC_TX));
+}
+
+static void release_tx_context(PyObject* cap) {
+    port_unref(static_cast<ExanicTxPort*>(PyCapsule_GetContext(cap)));
+}
 
 PYBIND11_MODULE(exanic_pybind, m) {
     m.doc() = "ExaNIC C API Python bindings (Linux only)";
@@ -70,13 +146,69 @@ PYBIND11_MODULE(exanic_pybind, m) {
         PyCapsule_SetPointer(rx_cap.ptr(), nullptr);  // avoid double free
     }, py::arg("rx_handle"), "Release RX buffer.");
 
+    m.def("acquire_tx_buffer", [](py::object handle_cap, int port_number, size_t requested_size) -> py::object {
+        if (!PyCapsule_IsValid(handle_cap.ptr(), CAPSULE_EXANIC))
+            throw std::runtime_error("invalid exanic handle capsule");
+        exanic_t* nic = static_cast<exanic_t*>(PyCapsule_GetPointer(handle_cap.ptr(), CAPSULE_EXANIC));
+        exanic_tx_t* tx = exanic_acquire_tx_buffer(nic, port_number, requested_size);
+        if (!tx)
+            return py::none();
+        ExanicTxPort* port = new ExanicTxPort;
+        port->nic = nic;
+        port->tx = tx;
+        port->ops.ctx = port;
+        port->ops.begin = &tx_begin;
+        port->ops.end = &tx_end;
+        port->ops.abort = &tx_abort;
+        port->ops.last_tx_ns = &tx_last_ns;
+        port->refs = 1;
+        ++g_nic_refs[nic].ports;
+        return py::capsule(port, CAPSULE_EXANIC_TX);
+    }, py::arg("handle"), py::arg("port_number"), py::arg("requested_size") = 0,
+       "Acquire TX buffer (0 = default size). Returns capsule or None.");
+
+    m.def("transmit_frame", [](py::object tx_cap, const py::bytes& frame) -> int {
+        char* data = nullptr;
+        Py_ssize_t size = 0;
+        if (PyBytes_AsStringAndSize(frame.ptr(), &data, &size) != 0)
+            throw py::error_already_set();
+        return exanic_transmit_frame(tx_port(tx_cap)->tx, data, static_cast<size_t>(size));
+    }, py::arg("tx_handle"), py::arg("frame"), "Transmit one frame. Returns 0 on success, -1 on error.");
+
+    m.def("get_tx_timestamp", [](py::object tx_cap) -> int64_t {
+        return tx_last_ns(tx_port(tx_cap));
+    }, py::arg("tx_handle"), "Hardware timestamp (ns) of the last transmitted frame on this port.");
+
+    m.def("tx_ops", [](py::object tx_cap) -> py::object {
+        ExanicTxPort* port = tx_port(tx_cap);
+        // ops capsule 持有端口一份引用，发布者存活期间 release_tx_buffer 不会回收 TX 缓冲区
+        PyObject* cap = PyCapsule_New(&port->ops, fq::kTxOpsCapsule, &release_tx_context);
+        if (!cap)
+            throw py::error_already_set();
+        ++port->refs;
+        PyCapsule_SetContext(cap, port);
+        return py::reinterpret_steal<py::object>(cap);
+    }, py::arg("tx_handle"), "fq.TxOps capsule for native_pybind.UdpTickPublisher.");
+
+    m.def("release_tx_buffer", [](py::object tx_cap) {
+        if (!PyCapsule_IsValid(tx_cap.ptr(), CAPSULE_EXANIC_TX))
+            return;
+        ExanicTxPort* port = static_cast<ExanicTxPort*>(PyCapsule_GetPointer(tx_cap.ptr(), CAPSULE_EXANIC_TX));
+        PyCapsule_SetName(tx_cap.ptr(), "exanic_tx_t (released)");  // 再次释放或使用时判为无效句柄
+        port_unref(port);
+    }, py::arg("tx_handle"), "Release TX buffer (deferred while a tx_ops capsule is alive).");
+
     m.def("release_handle", [](py::object handle_cap) {
         if (!PyCapsule_IsValid(handle_cap.ptr(), CAPSULE_EXANIC))
             return;
         exanic_t* nic = static_cast<exanic_t*>(PyCapsule_GetPointer(handle_cap.ptr(), CAPSULE_EXANIC));
-        exanic_release_handle(nic);
-        PyCapsule_SetPointer(handle_cap.ptr(), nullptr);
-    }, py::arg("handle"), "Release ExaNIC handle.");
+        auto it = g_nic_refs.find(nic);
+        if (it != g_nic_refs.end())
+            it->second.closing = true;  // 仍有 TX 端口，由最后一个端口释放时关闭
+        else
+            exanic_release_handle(nic);
+        PyCapsule_SetName(handle_cap.ptr(), "exanic_t (released)");
+    }, py::arg("handle"), "Release ExaNIC handle (deferred while TX ports are alive).");
 
     m.def("get_last_error", []() -> std::string {
         const char* err = exanic_get_last_error();
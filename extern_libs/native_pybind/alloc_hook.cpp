@@ -0,0 +1,123 @@
+/**
+ * alloc_hook.cpp: 计数版全局 operator new/delete（FQ_ALLOC_TRACKING 构建选项）
+ *
+ * 链入 native_pybind 时统计模块内 C++ 代码（含 pybind11 绑定层）的堆分配；
+ * 检查程序额外定义 FQ_ALLOC_HOOK_MALLOC，同时替换 malloc/calloc/realloc/free，
+ * 以覆盖直接调用 C 分配函数的路径。计数写入 fq/alloc_tracker.hpp 的线程局部计数器。
+ */
+#include <cstdlib>
+#include <new>
+
+#include "fq/alloc_tracker.hpp"
+
+#ifdef FQ_ALLOC_HOOK_MALLOC
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void __libc_free(void* p);
+}
+#endif
+
+namespace {
+
+struct HookMark {
+    HookMark() { fq::alloc_detail::hook_linked().store(true, std::memory_order_relaxed); }
+} g_hook_mark;
+
+// operator new 直接使用底层分配函数，避免与 malloc 钩子重复计数
+inline void* raw_malloc(size_t size) {
+#ifdef FQ_ALLOC_HOOK_MALLOC
+    return __libc_malloc(size);
+#else
+    return std::malloc(size);
+#endif
+}
+
+inline void raw_free(void* p) {
+#ifdef FQ_ALLOC_HOOK_MALLOC
+    __libc_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+inline void* counted_new(size_t size) {
+    fq::record_alloc(size);
+    if (void* p = raw_malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+inline void* counted_new_aligned(size_t size, std::align_val_t align) {
+    fq::record_alloc(size);
+    const size_t a = static_cast<size_t>(align);
+    void* p = std::aligned_alloc(a, (size + a - 1) / a * a);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+inline void counted_delete(void* p) noexcept {
+    if (!p) return;
+    fq::record_free();
+    raw_free(p);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new(size_t size, std::align_val_t align) { return counted_new_aligned(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_new_aligned(size, align); }
+
+void operator delete(void* p) noexcept { counted_delete(p); }
+void operator delete[](void* p) noexcept { counted_delete(p); }
+void operator delete(void* p, size_t) noexcept { counted_delete(p); }
+void operator delete[](void* p, size_t) noexcept { counted_delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_delete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_delete(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_delete(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_delete(p); }
+
+#ifdef FQ_ALLOC_HOOK_MALLOC
+extern "C" {
+
+void* malloc(size_t size) {
+    fq::record_alloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    fq::record_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) {
+    fq::record_alloc(size);
+    if (p) fq::record_free();
+    return __libc_realloc(p, size);
+}
+
+void free(void* p) {
+    if (!p) return;
+    fq::record_free();
+    __libc_free(p);
+}
+
+}  // extern "C"
+#endif
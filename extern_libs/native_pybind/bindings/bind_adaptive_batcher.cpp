@@ -0,0 +1,48 @@
+/**
+ * bind_adaptive_batcher.cpp: fq::AdaptiveBatcher 的 pybind11 绑定
+ */
+#include "bind_common.hpp"
+
+#include "fq/adaptive_batcher.hpp"
+
+namespace fq {
+namespace bindings {
+
+void bind_adaptive_batcher(py::module_& m) {
+    py::class_<AdaptiveBatcher>(m, "AdaptiveBatcher")
+        .def(py::init([](double max_latency, size_t max_batch, double min_poll_interval,
+                         double max_poll_interval, double idle_rate, double rate_window) {
+                 AdaptiveBatcherConfig cfg;
+                 cfg.max_latency = max_latency;
+                 cfg.max_batch = max_batch;
+                 cfg.min_poll_interval = min_poll_interval;
+                 cfg.max_poll_interval = max_poll_interval;
+                 cfg.idle_rate = idle_rate;
+                 cfg.rate_window = rate_window;
+                 return AdaptiveBatcher(cfg);
+             }),
+             py::arg("max_latency") = 0.02, py::arg("max_batch") = 4096,
+             py::arg("min_poll_interval") = 0.0005, py::arg("max_poll_interval") = 0.005,
+             py::arg("idle_rate") = 200.0, py::arg("rate_window") = 0.5)
+        .def("observe", &AdaptiveBatcher::observe, py::arg("n"), py::arg("now"))
+        .def("should_flush", &AdaptiveBatcher::should_flush, py::arg("pending"), py::arg("oldest"), py::arg("now"))
+        .def("next_poll_interval", &AdaptiveBatcher::next_poll_interval,
+             py::arg("pending"), py::arg("oldest"), py::arg("now"))
+        .def("on_flush", &AdaptiveBatcher::on_flush, py::arg("n"), py::arg("oldest"), py::arg("now"))
+        .def("metrics", [](const AdaptiveBatcher& b) {
+            const AdaptiveBatcherMetrics& s = b.metrics();
+            py::dict d;
+            d["arrival_rate"] = s.arrival_rate;
+            d["target_batch"] = s.target_batch;
+            d["batching"] = s.batching;
+            d["flushes"] = s.flushes;
+            d["flushed"] = s.flushed;
+            d["last_batch"] = s.last_batch;
+            d["last_delay"] = s.last_delay;
+            d["max_delay"] = s.max_delay;
+            return d;
+        }, "Current operating point and flush statistics.");
+}
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,138 @@
+/**
+ * bind_alert_engine.cpp: fq::AlertEngine 的 pybind11 绑定
+ *
+ * 构造参数即 src/processor/alerts.py compile_rules() 的编译结果（CompiledRules 按位置展开），
+ * 与同文件中纯 Python AlertEngine 接口一致；字节码无效抛 ValueError。
+ * evaluate() 返回告警事件 dict，symbol/exchange/datetime 直接复用输入 dict 中的对象。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/stl.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "fq/alert_engine.hpp"
+#include "fq/tick_batch.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+using RuleTuple = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, int64_t, int64_t, std::vector<int32_t>>;
+using SlotTuple = std::tuple<int, int64_t>;
+
+AlertProgram make_program(const std::vector<std::string>& names, const std::vector<int>& ops,
+                          const std::vector<int32_t>& args, const std::vector<double>& consts,
+                          const std::vector<RuleTuple>& rules, const std::vector<SlotTuple>& history) {
+    if (names.size() != rules.size()) throw std::invalid_argument("alert program: names/rules size mismatch");
+    AlertProgram p;
+    p.ops.reserve(ops.size());
+    for (int op : ops) {
+        if (op < 0 || op >= kOpCount) throw std::invalid_argument("alert program: bad opcode");
+        p.ops.push_back(static_cast<uint8_t>(op));
+    }
+    p.args = args;
+    p.consts = consts;
+    for (const RuleTuple& r : rules)
+        p.rules.push_back(AlertRule{std::get<0>(r), std::get<1>(r), std::get<2>(r), std::get<3>(r), std::get<4>(r),
+                                    std::get<5>(r), std::get<6>(r)});
+    for (const SlotTuple& s : history) {
+        if (std::get<0>(s) < 0 || std::get<0>(s) >= kAlertFieldCount)
+            throw std::invalid_argument("alert program: invalid history slot");
+        p.history.push_back(AlertHistorySlot{static_cast<uint8_t>(std::get<0>(s)), std::get<1>(s)});
+    }
+    return p;
+}
+
+class PyAlertEngine {
+public:
+    PyAlertEngine(const std::vector<std::string>& names, const std::vector<int>& ops, const std::vector<int32_t>& args,
+                  const std::vector<double>& consts, const std::vector<RuleTuple>& rules,
+                  const std::vector<SlotTuple>& history, size_t instruments, size_t history_size)
+        : engine_(make_program(names, ops, args, consts, rules, history), instruments, history_size),
+          events_(rules.empty() ? 1 : rules.size()) {
+        for (const std::string& n : names) names_.append(py::str(n));
+    }
+
+    /// 对一条行情求值，返回触发数（事件暂存于内部缓冲）
+    size_t on_tick(const Tick& t) { return engine_.on_tick(t, events_.data(), events_.size()); }
+
+    /// 把最近一次 on_tick 的 n 个事件转为 dict 追加到 out；src 为输入 dict
+    void append(PyObject* src, const Tick& t, size_t n, py::list& out) const {
+        for (size_t k = 0; k < n; ++k) out.append(event_dict(src, t, events_[k]));
+    }
+
+    AlertEngine& engine() { return engine_; }
+    const py::list& names() const { return names_; }
+
+private:
+    py::dict event_dict(PyObject* src, const Tick& t, const AlertEvent& e) const {
+        // 键顺序与 src/processor/alerts.py 的纯 Python 实现一致
+        py::dict d;
+        auto copy = [&](const char* key) {
+            PyObject* v = PyDict_GetItemString(src, key);
+            d[key] = v ? py::reinterpret_borrow<py::object>(v) : py::none();
+        };
+        copy("symbol");
+        d["instrument_id"] = e.instrument_id;
+        copy("exchange");
+        copy("datetime");
+        d["event"] = "alert";
+        d["rule"] = names_[e.rule];
+        d["value"] = e.value;
+        d["last_price"] = t.last_price;
+        d["bid_price_1"] = t.bid_price_1;
+        d["ask_price_1"] = t.ask_price_1;
+        return d;
+    }
+
+    AlertEngine engine_;
+    std::vector<AlertEvent> events_;  ///< 单条行情最多触发全部规则各一次
+    py::list names_;
+};
+
+}  // namespace
+
+void bind_alert_engine(py::module_& m) {
+    py::class_<PyAlertEngine>(m, "AlertEngine")
+        .def(py::init<const std::vector<std::string>&, const std::vector<int>&, const std::vector<int32_t>&,
+                      const std::vector<double>&, const std::vector<RuleTuple>&, const std::vector<SlotTuple>&,
+                      size_t, size_t>(),
+             py::arg("names"), py::arg("ops"), py::arg("args"), py::arg("consts"), py::arg("rules"),
+             py::arg("history"), py::arg("instruments") = 1024, py::arg("history_size") = 256)
+        .def("evaluate", [](PyAlertEngine& self, const py::list& data_list, size_t start) {
+            py::list out;
+            const size_t n = data_list.size();
+            Tick t{};
+            for (size_t i = start; i < n; ++i) {
+                PyObject* item = PyList_GET_ITEM(data_list.ptr(), static_cast<Py_ssize_t>(i));
+                if (!PyDict_Check(item) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                if (const size_t fired = self.on_tick(t)) self.append(item, t, fired, out);
+            }
+            return out;
+        }, py::arg("data_list"), py::arg("start") = 0,
+           "Evaluate all applicable rules on each tick from start; returns alert event dicts.")
+        .def("evaluate_batch", [](PyAlertEngine& self, const TickBatch& batch, size_t start) {
+            py::list out;
+            for (size_t i = start; i < batch.size(); ++i) {
+                const Tick& t = batch.data()[i];
+                // 只有触发时才需要 symbol/datetime 等对象，按需由槽位重建 dict
+                if (const size_t fired = self.on_tick(t)) self.append(tick_to_dict(t).ptr(), t, fired, out);
+            }
+            return out;
+        }, py::arg("batch"), py::arg("start") = 0, "Same as evaluate() straight from the batch slots.")
+        .def("reset", [](PyAlertEngine& self) { self.engine().reset(); })
+        .def_property_readonly("names", &PyAlertEngine::names)
+        .def_property_readonly("rules", [](PyAlertEngine& self) { return self.engine().rules(); })
+        .def_property_readonly("instruments", [](PyAlertEngine& self) { return self.engine().instruments(); })
+        .def_property_readonly("ticks", [](PyAlertEngine& self) { return self.engine().ticks(); })
+        .def_property_readonly("evaluations", [](PyAlertEngine& self) { return self.engine().evaluations(); })
+        .def_property_readonly("fired", [](PyAlertEngine& self) { return self.engine().fired(); })
+        .def_property_readonly("overflow", [](PyAlertEngine& self) { return self.engine().overflow(); });
+}
+
+}  // namespace bindings
+}  // namespace fq
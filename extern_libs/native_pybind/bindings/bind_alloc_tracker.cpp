@@ -0,0 +1,37 @@
+/**
+ * bind_alloc_tracker.cpp: 按线程分配计数的 pybind11 绑定
+ *
+ * 仅在以 FQ_ALLOC_TRACKING=ON 构建时计数（alloc_tracking_enabled() 为 True）。
+ * 计数覆盖本模块内的 C++ 分配（含 pybind11 调用分发本身的少量固定分配，
+ * 由 Python 侧 AllocationGuard 校准扣除）；Python 对象分配不在统计范围内。
+ */
+#include "bind_common.hpp"
+
+#include "fq/alloc_tracker.hpp"
+
+namespace fq {
+namespace bindings {
+
+static py::dict stats_dict(const AllocStats& s) {
+    py::dict d;
+    d["allocs"] = s.allocs;
+    d["frees"] = s.frees;
+    d["bytes"] = s.bytes;
+    return d;
+}
+
+void bind_alloc_tracker(py::module_& m) {
+    m.def("alloc_tracking_enabled", &alloc_tracking_enabled,
+          "True if the module was built with FQ_ALLOC_TRACKING (counting operator new/delete).");
+    m.def("thread_alloc_stats", [] { return stats_dict(thread_alloc_stats()); },
+          "Cumulative heap allocations made by native code on the calling thread.");
+
+    py::class_<AllocScope>(m, "AllocScope")
+        .def(py::init<>())
+        .def("restart", &AllocScope::restart, "Start counting from now on the calling thread.")
+        .def("allocations", &AllocScope::allocations, "Allocations on the calling thread since restart().")
+        .def("bytes", &AllocScope::bytes, "Bytes allocated on the calling thread since restart().");
+}
+
+}  // namespace bindings
+}  // namespace fq
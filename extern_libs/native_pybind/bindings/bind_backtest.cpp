@@ -0,0 +1,109 @@
+/**
+ * bind_backtest.cpp: fq::FillSimulator 与 fq::BacktestLoop 的 pybind11 绑定
+ *
+ * FillSimulator 与 src/backtest/fill_simulator.py 的纯 Python 实现接口一致：延迟以秒给出，
+ * on_tick() 接收标准化行情 dict，返回本条行情触发的成交 dict 列表。
+ * BacktestLoop.run() 接收若干 TICK_DTYPE 记录数组（各自按时间有序；可附带文件内合约下标 -> 进程内 ID 表），
+ * 归并、撮合与装批都在 C++ 中完成，只在成交与批次满时回调 Python；批次为 TickBatch，
+ * 与实盘 on_batch_callback 收到的对象相同。
+ */
+#include "bind_common.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "fq/backtest.hpp"
+#include "fq/tick_batch.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+py::dict fill_dict(const SimFill& f) {
+    py::dict d;
+    d["order_id"] = f.order_id;
+    d["instrument_id"] = f.instrument_id;
+    d["side"] = static_cast<int>(f.side);
+    d["price"] = f.price;
+    d["volume"] = f.quantity;
+    d["ts"] = f.ts;
+    d["liquidity"] = f.maker ? "maker" : "taker";
+    return d;
+}
+
+const void* contiguous(const py::handle& obj, size_t itemsize, size_t& count, const char* what) {
+    const py::buffer_info info = py::reinterpret_borrow<py::buffer>(obj).request();
+    if (info.ndim != 1 || info.itemsize != static_cast<py::ssize_t>(itemsize) ||
+        (info.shape[0] > 1 && info.strides[0] != static_cast<py::ssize_t>(itemsize)))
+        throw py::value_error(std::string("BacktestLoop.run expects contiguous 1-D ") + what + " arrays");
+    count = static_cast<size_t>(info.shape[0]);
+    return info.ptr;
+}
+
+/// records 或 (records, ids)：ids 为 int32 数组，把记录内 instrument_id 映射为进程内 ID
+TickSpan record_span(const py::handle& stream) {
+    TickSpan span{};
+    if (py::isinstance<py::tuple>(stream)) {
+        const py::tuple pair = py::reinterpret_borrow<py::tuple>(stream);
+        if (pair.size() != 2) throw py::value_error("BacktestLoop.run expects records or (records, ids)");
+        const py::object records = pair[0], ids = pair[1];
+        span.data = static_cast<const Tick*>(contiguous(records, sizeof(Tick), span.size, "TICK_DTYPE"));
+        span.ids = static_cast<const int32_t*>(contiguous(ids, sizeof(int32_t), span.id_count, "int32 id"));
+        return span;
+    }
+    span.data = static_cast<const Tick*>(contiguous(stream, sizeof(Tick), span.size, "TICK_DTYPE"));
+    return span;
+}
+
+}  // namespace
+
+void bind_backtest(py::module_& m) {
+    py::class_<FillSimulator>(m, "FillSimulator")
+        .def(py::init([](double latency, double queue_fill_ratio, size_t max_orders) {
+                 SimConfig cfg;
+                 cfg.latency_us = static_cast<int64_t>(std::llround(latency * 1e6));
+                 cfg.queue_fill_ratio = queue_fill_ratio;
+                 cfg.max_orders = max_orders;
+                 return new FillSimulator(cfg);
+             }),
+             py::arg("latency") = 0.0, py::arg("queue_fill_ratio") = 1.0, py::arg("max_orders") = 65536)
+        .def("submit", &FillSimulator::submit, py::arg("instrument_id"), py::arg("side"), py::arg("price"),
+             py::arg("volume"), py::arg("ts"), "Submit an order (price <= 0 is market). Returns 0 if rejected.")
+        .def("cancel", &FillSimulator::cancel, py::arg("order_id"))
+        .def("live_orders", &FillSimulator::live_orders)
+        .def("on_tick", [](FillSimulator& self, const py::dict& data) {
+            py::list out;
+            Tick t{};
+            if (!dict_to_tick(data, t)) return out;
+            SimFill fills[kSimFillsPerTick];
+            const size_t n = self.on_tick(t, fills, kSimFillsPerTick);
+            for (size_t i = 0; i < n; ++i) out.append(fill_dict(fills[i]));
+            return out;
+        }, py::arg("data"), "Advance one normalized tick dict; returns the fills it triggered.");
+
+    py::class_<BacktestLoop>(m, "BacktestLoop")
+        .def(py::init<FillSimulator&>(), py::arg("simulator"), py::keep_alive<1, 2>())
+        .def("run", [](BacktestLoop& self, const py::list& streams, size_t batch_size, const py::function& on_batch,
+                       const py::function& on_fill) {
+            // 数组在 run 期间由 streams 持有；TickSpan 直接指向其缓冲区（可为只读 mmap，不复制）
+            std::vector<TickSpan> spans;
+            spans.reserve(streams.size());
+            for (const py::handle& stream : streams) spans.push_back(record_span(stream));
+            TickMerger merger(std::move(spans));
+            py::object batch_obj = py::cast(new TickBatch(batch_size == 0 ? 1 : batch_size),
+                                            py::return_value_policy::take_ownership);
+            TickBatch& batch = batch_obj.cast<TickBatch&>();
+            return self.run(
+                merger, batch, [&](const SimFill& f) { on_fill(fill_dict(f)); },
+                [&](TickBatch&, int64_t now) { on_batch(batch_obj, now); });
+        }, py::arg("streams"), py::arg("batch_size"), py::arg("on_batch"), py::arg("on_fill"),
+           "Replay time-ordered TICK_DTYPE arrays (or (records, ids) pairs), calling on_batch(TickBatch, now) per batch and "
+           "on_fill(dict) per fill. Returns the number of ticks replayed.")
+        .def("last_price", &BacktestLoop::last_price, py::arg("instrument_id"),
+             "Latest non-zero last_price seen for the instrument (0 if none).");
+}
+
+}  // namespace bindings
+}  // namespace fq
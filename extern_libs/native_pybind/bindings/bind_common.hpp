@@ -0,0 +1,86 @@
+/**
+ * bind_common.hpp: native_pybind 各子模块绑定函数声明
+ *
+ * 每个原生组件在 bindings/bind_<组件>.cpp 中实现 bind_<组件>(m)，
+ * 由 native_pybind.cpp 的 PYBIND11_MODULE 统一注册。
+ */
+#pragma once
+
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+
+#include "fq/tick.hpp"
+
+namespace py = pybind11;
+
+namespace fq {
+namespace bindings {
+
+/// 将任意 Python bytes/str 视为原始字节（str 按 UTF-8 编码），不复制
+inline bool raw_view(const py::handle& obj, const char*& data, size_t& size) {
+    if (PyBytes_Check(obj.ptr())) {
+        char* p = nullptr;
+        Py_ssize_t n = 0;
+        if (PyBytes_AsStringAndSize(obj.ptr(), &p, &n) != 0) throw py::error_already_set();
+        data = p;
+        size = static_cast<size_t>(n);
+        return true;
+    }
+    if (PyUnicode_Check(obj.ptr())) {
+        Py_ssize_t n = 0;
+        const char* p = PyUnicode_AsUTF8AndSize(obj.ptr(), &n);
+        if (!p) throw py::error_already_set();
+        data = p;
+        size = static_cast<size_t>(n);
+        return true;
+    }
+    return false;
+}
+
+/// dict 数值字段（缺失或 None 为 0），直接走 CPython API，不经 pybind11 类型转换
+inline double dict_double(PyObject* d, const char* key) {
+    PyObject* v = PyDict_GetItemString(d, key);
+    if (!v || v == Py_None) return 0.0;
+    const double x = PyFloat_AsDouble(v);
+    if (x == -1.0 && PyErr_Occurred()) throw py::error_already_set();
+    return x;
+}
+
+inline int64_t dict_int64(PyObject* d, const char* key) {
+    PyObject* v = PyDict_GetItemString(d, key);
+    if (!v || v == Py_None) return 0;
+    if (PyFloat_Check(v)) return static_cast<int64_t>(PyFloat_AS_DOUBLE(v));
+    const long long x = PyLong_AsLongLong(v);
+    if (x == -1 && PyErr_Occurred()) throw py::error_already_set();
+    return static_cast<int64_t>(x);
+}
+
+/// 标准化行情 dict -> Tick（缺少 instrument_id 时按 symbol 登记；定义于 bind_tick_batch.cpp）
+bool dict_to_tick(const py::dict& d, Tick& t);
+
+/// Tick -> 标准化行情 dict（键顺序与 DataParser 输出一致；定义于 bind_tick_batch.cpp）
+py::dict tick_to_dict(const Tick& t);
+
+void bind_symbol_table(py::module_& m);
+void bind_tick_batch(py::module_& m);
+void bind_adaptive_batcher(py::module_& m);
+void bind_priority_lanes(py::module_& m);
+void bind_sharding(py::module_& m);
+void bind_wait_strategy(py::module_& m);
+void bind_alloc_tracker(py::module_& m);
+void bind_trade_inference(py::module_& m);
+void bind_backtest(py::module_& m);
+void bind_cross_section(py::module_& m);
+void bind_csv_encoder(py::module_& m);
+void bind_csv_import(py::module_& m);
+void bind_reorder_buffer(py::module_& m);
+void bind_hot_standby(py::module_& m);
+void bind_udp_publisher(py::module_& m);
+void bind_ewm_covariance(py::module_& m);
+void bind_feature_tensor(py::module_& m);
+void bind_alert_engine(py::module_& m);
+void bind_ws_fanout(py::module_& m);
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,80 @@
+/**
+ * bind_cross_section.cpp: fq::CrossSection 的 pybind11 绑定
+ *
+ * matrix()/block()/latest()/times() 返回直接指向原生块的 numpy 视图（不复制），
+ * 视图在下一次 clear()/update() 写入对应行前有效；需要保留时请 .copy() 或先持久化。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/numpy.h>
+
+#include <cmath>
+#include <string>
+
+#include "fq/cross_section.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+size_t field_index(const std::string& name) {
+    for (size_t f = 0; f < kCrossFieldCount; ++f)
+        if (name == cross_field_name(f)) return f;
+    throw py::key_error("unknown cross-section field: " + name);
+}
+
+}  // namespace
+
+void bind_cross_section(py::module_& m) {
+    py::class_<CrossSection>(m, "CrossSection")
+        .def(py::init([](size_t instruments, size_t rows, double interval, double max_gap) {
+                 return new CrossSection(instruments, rows, static_cast<int64_t>(std::llround(interval * 1e6)),
+                                         static_cast<int64_t>(std::llround(max_gap * 1e6)));
+             }),
+             py::arg("instruments") = 1024, py::arg("rows") = 1200, py::arg("interval") = 0.5,
+             py::arg("max_gap") = 60.0)
+        .def("update", [](CrossSection& self, const py::list& data_list, size_t start) {
+            const size_t n = data_list.size();
+            Tick t{};
+            for (size_t i = start; i < n; ++i) {
+                py::handle item = PyList_GET_ITEM(data_list.ptr(), static_cast<Py_ssize_t>(i));
+                if (!PyDict_Check(item.ptr()) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                if (!self.on_tick(t)) return i;
+            }
+            return n;
+        }, py::arg("data_list"), py::arg("start") = 0,
+           "Apply normalized ticks from start; returns the index of the first tick not applied because the block "
+           "is full (len(data_list) when all applied).")
+        .def("matrix", [](py::object self, const std::string& field) {
+            const CrossSection& cs = self.cast<const CrossSection&>();
+            return py::array_t<double>({cs.rows_filled(), cs.instruments()},
+                                       {cs.instruments() * sizeof(double), sizeof(double)},
+                                       cs.field_block(field_index(field)), self);
+        }, py::arg("field"), "(rows_filled x instruments) view of one field.")
+        .def("block", [](py::object self) {
+            const CrossSection& cs = self.cast<const CrossSection&>();
+            return py::array_t<double>({static_cast<size_t>(kCrossFieldCount), cs.rows_filled(), cs.instruments()},
+                                       {cs.rows() * cs.instruments() * sizeof(double),
+                                        cs.instruments() * sizeof(double), sizeof(double)},
+                                       cs.field_block(0), self);
+        }, "(fields x rows_filled x instruments) view of all fields, in FIELDS order.")
+        .def("latest", [](py::object self, const std::string& field) {
+            const CrossSection& cs = self.cast<const CrossSection&>();
+            return py::array_t<double>({cs.instruments()}, {sizeof(double)}, cs.latest(field_index(field)), self);
+        }, py::arg("field"), "Current latest-value column of one field.")
+        .def("times", [](py::object self) {
+            const CrossSection& cs = self.cast<const CrossSection&>();
+            return py::array_t<int64_t>({cs.rows_filled()}, {sizeof(int64_t)}, cs.times(), self);
+        }, "Grid time of each row (sim_time: days since 1970-01-01 * 86400e6 + time_us).")
+        .def("clear", &CrossSection::clear)
+        .def("reset", &CrossSection::reset)
+        .def_property_readonly("full", &CrossSection::full)
+        .def_property_readonly("rows_filled", &CrossSection::rows_filled)
+        .def_property_readonly("rows", &CrossSection::rows)
+        .def_property_readonly("instruments", &CrossSection::instruments)
+        .def_property_readonly("interval_us", &CrossSection::interval_us);
+}
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,195 @@
+/**
+ * bind_csv_encoder.cpp: 与 FileStorage 逐字节一致的批量 CSV 编码器绑定
+ *
+ * encode() 按 (合约, 交易日) 把一批标准化行情编码到各文件缓冲，返回 [(路径, 表头, 行)]；
+ * 是否写表头（文件不存在）与实际写入由 Python 侧决定，每批每个文件一次 write。
+ * 字段值按 csv 模块的规则转文本：float 用 repr，其余用 str，None 为空；datetime 列按 isoformat()。
+ */
+#include "bind_common.hpp"
+
+#include <datetime.h>
+
+#include <iterator>
+#include <string>
+
+#include "fq/csv_encoder.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+void append_object_text(std::string& out, PyObject* obj, bool repr) {
+    PyObject* s = repr ? PyObject_Repr(obj) : PyObject_Str(obj);
+    if (!s) throw py::error_already_set();
+    Py_ssize_t n = 0;
+    const char* p = PyUnicode_AsUTF8AndSize(s, &n);
+    if (!p) {
+        Py_DECREF(s);
+        throw py::error_already_set();
+    }
+    csv_append_text(out, p, static_cast<size_t>(n));
+    Py_DECREF(s);
+}
+
+/// 与 csv.writer 对单个字段的转换一致
+void append_value(std::string& out, PyObject* v) {
+    if (v == Py_None) return;
+    if (PyFloat_CheckExact(v)) {
+        csv_append_float(out, PyFloat_AS_DOUBLE(v));
+    } else if (PyLong_CheckExact(v)) {
+        int overflow = 0;
+        const long long x = PyLong_AsLongLongAndOverflow(v, &overflow);
+        if (overflow) {
+            append_object_text(out, v, false);
+        } else {
+            if (x == -1 && PyErr_Occurred()) throw py::error_already_set();
+            csv_append_int(out, x);
+        }
+    } else if (PyUnicode_CheckExact(v)) {
+        Py_ssize_t n = 0;
+        const char* p = PyUnicode_AsUTF8AndSize(v, &n);
+        if (!p) throw py::error_already_set();
+        csv_append_text(out, p, static_cast<size_t>(n));
+    } else {
+        append_object_text(out, v, PyFloat_Check(v));
+    }
+}
+
+bool is_key(PyObject* k, const char* name) {
+    return PyUnicode_Check(k) && PyUnicode_CompareWithASCIIString(k, name) == 0;
+}
+
+// 只对行情行去掉 kCsvNonPersistedFields，事件行（含 event 键）保留全部列
+bool is_persisted(PyObject* k, bool tick_row) {
+    if (!tick_row) return true;
+    for (const char* name : kCsvNonPersistedFields)
+        if (is_key(k, name)) return false;
+    return true;
+}
+
+/// 行结束：csv 模块对“仅一个空字段”的行写 ""，避免被读成空行
+void end_row(std::string& out, size_t row_start, size_t fields) {
+    if (fields == 1 && out.size() == row_start) out.append("\"\"");
+    out.append("\r\n");
+}
+
+class CsvEncoder {
+public:
+    explicit CsvEncoder(const std::string& base_path) : files_(base_path) {}
+
+    size_t cached_files() const { return files_.size(); }
+
+    py::list encode(const py::list& data_list) {
+        files_.begin_batch();
+        const Py_ssize_t n = PyList_GET_SIZE(data_list.ptr());
+        for (Py_ssize_t i = 0; i < n; ++i) encode_row(PyList_GET_ITEM(data_list.ptr(), i));
+        py::list out;
+        for (size_t idx : files_.active()) {
+            CsvFileBuffers::File& f = files_.at(idx);
+            out.append(py::make_tuple(py::str(f.path), py::bytes(f.header), py::bytes(f.body)));
+        }
+        return out;
+    }
+
+private:
+    void encode_row(PyObject* d) {
+        if (!PyDict_Check(d)) throw py::type_error("CsvEncoder.encode expects a list of dicts");
+        PyObject* dt = PyDict_GetItemString(d, "datetime");
+        if (!dt) throw py::key_error("datetime");
+        if (PyUnicode_Check(dt)) {
+            // 与 FileStorage 一致：字符串时间先解析并回写到原 dict
+            py::object parsed = fromisoformat()(py::reinterpret_borrow<py::object>(dt));
+            if (PyDict_SetItemString(d, "datetime", parsed.ptr()) != 0) throw py::error_already_set();
+            dt = PyDict_GetItemString(d, "datetime");
+        }
+        if (!PyDateTime_Check(dt)) throw py::type_error("datetime must be a datetime or ISO string");
+        const int32_t date = PyDateTime_GET_YEAR(dt) * 10000 + PyDateTime_GET_MONTH(dt) * 100 + PyDateTime_GET_DAY(dt);
+
+        PyObject* sym = PyDict_GetItemString(d, "symbol");
+        symbol_.clear();
+        if (sym && PyUnicode_Check(sym)) {
+            Py_ssize_t len = 0;
+            const char* p = PyUnicode_AsUTF8AndSize(sym, &len);
+            if (!p) throw py::error_already_set();
+            symbol_.assign(p, static_cast<size_t>(len));
+        } else if (sym) {
+            py::str s(py::reinterpret_borrow<py::object>(sym));
+            symbol_ = s.cast<std::string>();
+        } else {
+            symbol_ = "unknown";
+        }
+        CsvFileBuffers::File& f = files_.file(symbol_.data(), symbol_.size(), date);
+        const bool tick_row = PyDict_GetItemString(d, "event") == nullptr;
+
+        if (f.rows == 0) {
+            size_t fields = 0;
+            Py_ssize_t pos = 0;
+            PyObject* k = nullptr;
+            PyObject* v = nullptr;
+            while (PyDict_Next(d, &pos, &k, &v)) {
+                if (!is_persisted(k, tick_row)) continue;
+                if (fields++) f.header.push_back(',');
+                append_value(f.header, k);
+            }
+            end_row(f.header, 0, fields);
+        }
+
+        const size_t row_start = f.body.size();
+        size_t fields = 0;
+        Py_ssize_t pos = 0;
+        PyObject* k = nullptr;
+        PyObject* v = nullptr;
+        while (PyDict_Next(d, &pos, &k, &v)) {
+            if (!is_persisted(k, tick_row)) continue;
+            if (fields++) f.body.push_back(',');
+            if (is_key(k, "datetime")) {
+                append_isoformat(f.body, v);
+            } else {
+                append_value(f.body, v);
+            }
+        }
+        end_row(f.body, row_start, fields);
+        ++f.rows;
+    }
+
+    void append_isoformat(std::string& out, PyObject* dt) {
+        if (PyDateTime_CheckExact(dt) && !reinterpret_cast<PyDateTime_DateTime*>(dt)->hastzinfo) {
+            iso_.append(out, PyDateTime_GET_YEAR(dt), PyDateTime_GET_MONTH(dt), PyDateTime_GET_DAY(dt),
+                        PyDateTime_DATE_GET_HOUR(dt), PyDateTime_DATE_GET_MINUTE(dt),
+                        PyDateTime_DATE_GET_SECOND(dt), PyDateTime_DATE_GET_MICROSECOND(dt));
+            return;
+        }
+        py::str s = py::reinterpret_borrow<py::object>(dt).attr("isoformat")();
+        const std::string text = s.cast<std::string>();
+        csv_append_text(out, text.data(), text.size());
+    }
+
+    py::object& fromisoformat() {
+        if (!fromisoformat_) fromisoformat_ = py::module_::import("datetime").attr("datetime").attr("fromisoformat");
+        return fromisoformat_;
+    }
+
+    CsvFileBuffers files_;
+    IsoDateTimeFormatter iso_;
+    std::string symbol_;
+    py::object fromisoformat_;
+};
+
+}  // namespace
+
+void bind_csv_encoder(py::module_& m) {
+    PyDateTime_IMPORT;
+    py::class_<CsvEncoder>(m, "CsvEncoder")
+        .def(py::init<const std::string&>(), py::arg("base_path"))
+        .def("encode", &CsvEncoder::encode, py::arg("data_list"),
+             "Encode normalized ticks into per-file CSV buffers; returns [(path, header, body)].")
+        .def_property_readonly("cached_files", &CsvEncoder::cached_files,
+                               "Per-(symbol, day) file buffers kept between batches.");
+    py::tuple fields(std::size(kCsvNonPersistedFields));
+    for (size_t i = 0; i < fields.size(); ++i) fields[i] = py::str(kCsvNonPersistedFields[i]);
+    m.attr("CSV_NON_PERSISTED_FIELDS") = fields;
+}
+
+}  // namespace bindings
+}  // namespace fq
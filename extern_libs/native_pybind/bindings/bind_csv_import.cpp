@@ -0,0 +1,46 @@
+/**
+ * bind_csv_import.cpp: CSV 归档批量导入（fq::import_csv_day）的 pybind11 绑定
+ *
+ * import_csv_day() 在释放 GIL 的情况下以线程池并行解析同一天的各合约 CSV 并写出 .fqt，
+ * 返回导入统计 dict。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/stl.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fq/csv_import.hpp"
+
+namespace fq {
+namespace bindings {
+
+void bind_csv_import(py::module_& m) {
+    m.def("import_csv_day",
+          [](const std::vector<std::string>& paths, const std::vector<std::string>& symbols,
+             const std::string& out_path, unsigned threads) {
+              if (paths.size() != symbols.size()) throw py::value_error("paths and symbols must have the same length");
+              CsvImportStats stats;
+              bool ok;
+              {
+                  py::gil_scoped_release release;
+                  ok = import_csv_day(paths, symbols, out_path.c_str(), threads, stats);
+              }
+              if (!ok) throw std::runtime_error("failed to write day file: " + out_path);
+              py::dict d;
+              d["files"] = stats.files;
+              d["failed_files"] = stats.failed_files;
+              d["rows"] = stats.rows;
+              d["rejected"] = stats.rejected;
+              d["out_of_order"] = stats.out_of_order;
+              d["bytes"] = stats.bytes;
+              return d;
+          },
+          py::arg("paths"), py::arg("symbols"), py::arg("out_path"), py::arg("threads") = 0,
+          "Parse one day's per-symbol CSV files in parallel and write an indexed .fqt day file.");
+}
+
+}  // namespace bindings
+}  // namespace fq
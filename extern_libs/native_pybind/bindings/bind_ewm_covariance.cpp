@@ -0,0 +1,76 @@
+/**
+ * bind_ewm_covariance.cpp: fq::EwmCovariance 的 pybind11 绑定
+ *
+ * halflife / interval / max_gap 以秒传入；snapshot() 返回新分配的稠密矩阵（副本，可长期持有），
+ * mids() 为指向原生最新中间价表的视图。与 src/processor/covariance.py 的 numpy 实现接口一致。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/numpy.h>
+
+#include <cmath>
+#include <limits>
+
+#include "fq/ewm_covariance.hpp"
+
+namespace fq {
+namespace bindings {
+
+void bind_ewm_covariance(py::module_& m) {
+    py::class_<EwmCovariance>(m, "EwmCovariance")
+        .def(py::init([](size_t instruments, double interval, double halflife, double max_gap, size_t min_periods) {
+                 const double steps = interval > 0 ? halflife / interval : halflife;
+                 return new EwmCovariance(instruments, static_cast<int64_t>(std::llround(interval * 1e6)),
+                                          ewm_alpha_from_halflife(steps),
+                                          static_cast<int64_t>(std::llround(max_gap * 1e6)), min_periods);
+             }),
+             py::arg("instruments") = 512, py::arg("interval") = 1.0, py::arg("halflife") = 300.0,
+             py::arg("max_gap") = 60.0, py::arg("min_periods") = 2)
+        .def("update", [](EwmCovariance& self, const py::list& data_list, size_t start) {
+            const size_t n = data_list.size();
+            size_t steps = 0;
+            Tick t{};
+            for (size_t i = start; i < n; ++i) {
+                py::handle item = PyList_GET_ITEM(data_list.ptr(), static_cast<Py_ssize_t>(i));
+                if (!PyDict_Check(item.ptr()) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                steps += self.on_tick(t);
+            }
+            return steps;
+        }, py::arg("data_list"), py::arg("start") = 0,
+           "Apply normalized ticks from start; returns the number of grid updates performed.")
+        .def("cov", &EwmCovariance::cov, py::arg("i"), py::arg("j"),
+             "Covariance of log mid returns for an instrument_id pair (NaN until both have min_periods).")
+        .def("corr", &EwmCovariance::corr, py::arg("i"), py::arg("j"))
+        .def("snapshot", [](const EwmCovariance& self, bool correlation, size_t n) {
+            if (n == 0 || n > self.instruments()) n = self.instruments();
+            py::array_t<double> out({n, n});
+            double* p = out.mutable_data();
+            {
+                py::gil_scoped_release release;
+                self.snapshot(p, n, correlation);
+            }
+            return out;
+        }, py::arg("correlation") = false, py::arg("n") = 0,
+           "Dense (n x n) covariance or correlation matrix of the first n instrument_ids (copy).")
+        .def("mids", [](py::object self) {
+            const EwmCovariance& e = self.cast<const EwmCovariance&>();
+            return py::array_t<double>({e.instruments()}, {sizeof(double)}, e.mids(), self);
+        }, "Current latest mid-price column (view).")
+        .def("mean", &EwmCovariance::mean, py::arg("i"))
+        .def("nobs", &EwmCovariance::nobs, py::arg("i"))
+        .def("reset", &EwmCovariance::reset)
+        .def_property_readonly("steps", &EwmCovariance::steps)
+        .def_property_readonly("dropped", &EwmCovariance::dropped,
+                               "Ticks skipped because instrument_id >= instruments.")
+        .def_property_readonly("last_grid", [](const EwmCovariance& self) -> py::object {
+            if (self.last_grid() == std::numeric_limits<int64_t>::min()) return py::none();
+            return py::int_(self.last_grid());
+        })
+        .def_property_readonly("instruments", &EwmCovariance::instruments)
+        .def_property_readonly("interval_us", &EwmCovariance::interval_us)
+        .def_property_readonly("alpha", &EwmCovariance::alpha)
+        .def_property_readonly("min_periods", &EwmCovariance::min_periods);
+}
+
+}  // namespace bindings
+}  // namespace fq
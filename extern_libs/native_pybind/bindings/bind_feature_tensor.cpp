@@ -0,0 +1,84 @@
+/**
+ * bind_feature_tensor.cpp: fq::FeatureTensorWriter 的 pybind11 绑定
+ *
+ * 只绑定写端；读取端为 src/processor/features.py 的 FeatureTensorReader（numpy 直接映射共享区）。
+ * 与同文件中纯 Python FeatureTensorWriter 接口一致；特征名无效抛 ValueError，共享内存失败抛 RuntimeError。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/stl.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fq/feature_tensor.hpp"
+#include "fq/tick_batch.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+class PyFeatureTensorWriter {
+public:
+    PyFeatureTensorWriter(const std::vector<std::string>& features, const std::string& name, size_t capacity,
+                          size_t instruments, size_t history, double session_gap)
+        : names_(features),
+          writer_(parse_all(features), instruments, history, static_cast<int64_t>(std::llround(session_gap * 1e6))) {
+        if (!writer_.open(name, names_, capacity))
+            throw std::runtime_error("cannot create feature tensor shared memory " + name);
+    }
+
+    FeatureTensorWriter& writer() { return writer_; }
+    const std::vector<std::string>& names() const { return names_; }
+
+private:
+    static std::vector<FeatureSpec> parse_all(const std::vector<std::string>& features) {
+        if (features.empty()) throw std::invalid_argument("feature list is empty");
+        std::vector<FeatureSpec> specs(features.size());
+        for (size_t i = 0; i < features.size(); ++i)
+            if (!parse_feature(features[i], specs[i])) throw std::invalid_argument("unknown feature: " + features[i]);
+        return specs;
+    }
+
+    std::vector<std::string> names_;
+    FeatureTensorWriter writer_;
+};
+
+}  // namespace
+
+void bind_feature_tensor(py::module_& m) {
+    py::class_<PyFeatureTensorWriter>(m, "FeatureTensorWriter")
+        .def(py::init<const std::vector<std::string>&, const std::string&, size_t, size_t, size_t, double>(),
+             py::arg("features"), py::arg("name") = "/fq_features", py::arg("capacity") = 65536,
+             py::arg("instruments") = 1024, py::arg("history") = 512, py::arg("session_gap") = 600.0)
+        .def("update", [](PyFeatureTensorWriter& self, const py::list& data_list, size_t start) {
+            const size_t n = data_list.size();
+            size_t rows = 0;
+            Tick t{};
+            for (size_t i = start; i < n; ++i) {
+                py::handle item = PyList_GET_ITEM(data_list.ptr(), static_cast<Py_ssize_t>(i));
+                if (!PyDict_Check(item.ptr()) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                rows += self.writer().on_tick(t);
+            }
+            return rows;
+        }, py::arg("data_list"), py::arg("start") = 0,
+           "Compute and commit one feature row per tick from start; returns the number of rows written.")
+        .def("update_batch", [](PyFeatureTensorWriter& self, const TickBatch& batch, size_t start) {
+            size_t rows = 0;
+            for (size_t i = start; i < batch.size(); ++i) rows += self.writer().on_tick(batch.data()[i]);
+            return rows;
+        }, py::arg("batch"), py::arg("start") = 0, "Same as update() straight from the batch slots.")
+        .def("unlink", [](PyFeatureTensorWriter& self) { return self.writer().tensor().unlink(); })
+        .def("close", [](PyFeatureTensorWriter& self) { self.writer().tensor().close(); })
+        .def_property_readonly("seq", [](PyFeatureTensorWriter& self) { return self.writer().tensor().seq(); })
+        .def_property_readonly("capacity",
+                               [](PyFeatureTensorWriter& self) { return self.writer().tensor().capacity(); })
+        .def_property_readonly("features", &PyFeatureTensorWriter::names)
+        .def_property_readonly("name", [](PyFeatureTensorWriter& self) { return self.writer().tensor().name(); });
+}
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,119 @@
+/**
+ * bind_hot_standby.cpp: fq::StandbyRegion 的 pybind11 绑定
+ *
+ * 本进程合约 ID -> 共享区槽位下标按需缓存（槽位一经登记不再变化）；
+ * 时间参数为秒（time.monotonic()），缺省取 steady_clock 当前时间。
+ */
+#include "bind_common.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fq/hot_standby.hpp"
+#include "fq/symbol_table.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+class PyStandbyRegion {
+public:
+    PyStandbyRegion(const std::string& name, size_t slots) : slot_of_(kMaxInstruments, -1) {
+        if (!region_.open(name, slots)) throw std::runtime_error("cannot open standby region " + name);
+    }
+
+    StandbyRegion& region() {
+        if (!region_.is_open()) throw std::runtime_error("standby region is closed");
+        return region_;
+    }
+
+    /// 本进程合约 ID -> 槽位；create 时登记新合约
+    int32_t slot(int32_t instrument_id, bool create) {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= slot_of_.size()) return -1;
+        int32_t& cached = slot_of_[static_cast<size_t>(instrument_id)];
+        if (cached >= 0) return cached;
+        const SymbolTable& table = global_symbol_table();
+        const char* name = table.name(instrument_id);
+        SymbolKey key;
+        if (!name || !normalize_symbol(name, table.name_len(instrument_id), key)) return -1;
+        cached = region().find_slot(key, create);
+        return cached;
+    }
+
+    void close() { region_.close(); }
+
+private:
+    StandbyRegion region_;
+    std::vector<int32_t> slot_of_;
+};
+
+int64_t now_ns_of(const py::object& now) {
+    if (now.is_none()) return monotonic_ns();
+    return static_cast<int64_t>(std::llround(now.cast<double>() * 1e9));
+}
+
+}  // namespace
+
+void bind_hot_standby(py::module_& m) {
+    py::class_<PyStandbyRegion>(m, "StandbyRegion")
+        .def(py::init<const std::string&, size_t>(), py::arg("name"), py::arg("slots") = 8192)
+        .def("publish", [](PyStandbyRegion& self, const py::list& data_list) {
+            size_t n = 0;
+            Tick t{};
+            for (const py::handle& item : data_list) {
+                if (!PyDict_Check(item.ptr()) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                const int32_t s = self.slot(t.instrument_id, true);
+                if (s < 0) continue;
+                self.region().publish(s, t);
+                ++n;
+            }
+            self.region().advance_journal(n);
+            return n;
+        }, py::arg("data_list"), "Record a persisted batch: latest tick per symbol and journal position.")
+        .def("unpersisted", [](PyStandbyRegion& self, const py::list& data_list) {
+            py::list out;
+            Tick t{};
+            Tick mirrored{};
+            for (const py::handle& item : data_list) {
+                if (PyDict_Check(item.ptr()) && dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) {
+                    const int32_t s = self.slot(t.instrument_id, false);
+                    if (s >= 0 && self.region().read(s, mirrored) && tick_key(t) <= tick_key(mirrored)) continue;
+                }
+                out.append(item);
+            }
+            return out;
+        }, py::arg("data_list"), "Ticks not yet covered by the leader's persisted position.")
+        .def("last", [](PyStandbyRegion& self, const std::string& symbol) -> py::object {
+            SymbolKey key;
+            if (!normalize_symbol(symbol.data(), symbol.size(), key)) return py::none();
+            const int32_t s = self.region().find_slot(key, false);
+            Tick t{};
+            if (s < 0 || !self.region().read(s, t)) return py::none();
+            t.instrument_id = global_symbol_table().intern(key.bytes, key.len);
+            return tick_to_dict(t);
+        }, py::arg("symbol"), "Latest tick the leader persisted for symbol, or None.")
+        .def("heartbeat", [](PyStandbyRegion& self, const py::object& now) {
+            self.region().heartbeat(now_ns_of(now));
+        }, py::arg("now") = py::none())
+        .def("leader_alive", [](PyStandbyRegion& self, double timeout, const py::object& now) {
+            return self.region().leader_alive(now_ns_of(now), static_cast<int64_t>(std::llround(timeout * 1e9)));
+        }, py::arg("timeout"), py::arg("now") = py::none(),
+           "Leader heartbeat is fresher than timeout seconds and its process still exists.")
+        .def("claim", [](PyStandbyRegion& self, uint64_t expected_epoch, int64_t pid, const py::object& now) {
+            return self.region().claim(expected_epoch, pid, now_ns_of(now));
+        }, py::arg("expected_epoch"), py::arg("pid"), py::arg("now") = py::none(),
+           "Become leader if epoch is still expected_epoch (compare-and-swap to epoch + 1).")
+        .def("unlink", [](PyStandbyRegion& self) { return self.region().unlink(); })
+        .def("close", [](PyStandbyRegion& self) { self.close(); })
+        .def_property_readonly("epoch", [](PyStandbyRegion& self) { return self.region().epoch(); })
+        .def_property_readonly("leader_pid", [](PyStandbyRegion& self) { return self.region().leader_pid(); })
+        .def_property_readonly("journal_seq", [](PyStandbyRegion& self) { return self.region().journal_seq(); })
+        .def_property_readonly("symbols", [](PyStandbyRegion& self) { return self.region().symbols(); })
+        .def_property_readonly("slots", [](PyStandbyRegion& self) { return self.region().slots(); });
+}
+
+}  // namespace bindings
+}  // namespace fq
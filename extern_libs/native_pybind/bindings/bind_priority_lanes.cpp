@@ -0,0 +1,72 @@
+/**
+ * bind_priority_lanes.cpp: fq::LaneMap / fq::LaneScheduler 的 pybind11 绑定
+ *
+ * Python 侧以 PriorityLanes 一个对象使用：partition() 把一批标准化 dict 按
+ * instrument_id 分到各通道，plan() 给出本轮各通道可取出的条数。
+ */
+#include "bind_common.hpp"
+
+#include <pybind11/stl.h>
+
+#include <string>
+#include <vector>
+
+#include "fq/priority_lanes.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+struct PyPriorityLanes {
+    LaneMap map;
+    LaneScheduler scheduler;
+
+    PyPriorityLanes(std::vector<uint32_t> weights, bool strict, uint8_t default_lane)
+        : map(default_lane), scheduler(std::move(weights), strict) {}
+};
+
+py::list partition(PyPriorityLanes& self, const py::list& data_list) {
+    const size_t n_lanes = self.scheduler.lanes();
+    std::vector<py::list> lanes(n_lanes);
+    for (const py::handle& item : data_list) {
+        int32_t iid = kInvalidInstrument;
+        PyObject* v = PyDict_Check(item.ptr()) ? PyDict_GetItemString(item.ptr(), "instrument_id") : nullptr;
+        if (v && PyLong_Check(v)) iid = static_cast<int32_t>(PyLong_AsLong(v));
+        size_t lane = self.map.lane_of(iid);
+        if (lane >= n_lanes) lane = n_lanes - 1;
+        lanes[lane].append(item);
+    }
+    py::list out(n_lanes);
+    for (size_t i = 0; i < n_lanes; ++i) out[i] = lanes[i];
+    return out;
+}
+
+py::list plan(PyPriorityLanes& self, const std::vector<size_t>& backlog, size_t budget) {
+    const size_t n_lanes = self.scheduler.lanes();
+    if (backlog.size() != n_lanes) throw py::value_error("backlog size must equal number of lanes");
+    std::vector<size_t> take(n_lanes, 0);
+    self.scheduler.plan(backlog.data(), take.data(), budget);
+    return py::cast(take);
+}
+
+}  // namespace
+
+void bind_priority_lanes(py::module_& m) {
+    py::class_<PyPriorityLanes>(m, "PriorityLanes")
+        .def(py::init<std::vector<uint32_t>, bool, uint8_t>(), py::arg("weights"), py::arg("strict") = true,
+             py::arg("default_lane") = 0)
+        .def("set_lane", [](PyPriorityLanes& s, int32_t iid, uint8_t lane) { s.map.set_lane(iid, lane); },
+             py::arg("instrument_id"), py::arg("lane"))
+        .def("add_product", [](PyPriorityLanes& s, const std::string& p, uint8_t lane) { s.map.add_product(p, lane); },
+             py::arg("product"), py::arg("lane"))
+        .def("lane_of", [](PyPriorityLanes& s, int32_t iid) { return s.map.lane_of(iid); }, py::arg("instrument_id"))
+        .def("partition", &partition, py::arg("data_list"), "Split normalized dicts into per-lane lists.")
+        .def("plan", &plan, py::arg("backlog"), py::arg("budget"),
+             "Per-lane item counts to drain this round (strict or weighted DRR).")
+        .def_property_readonly("lanes", [](const PyPriorityLanes& s) { return s.scheduler.lanes(); })
+        .def_property_readonly("strict", [](const PyPriorityLanes& s) { return s.scheduler.strict(); });
+}
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,146 @@
+/**
+ * bind_reorder_buffer.cpp: fq::ReorderBuffer 的 pybind11 绑定
+ *
+ * 暂存的是行情 dict 本身（持有引用），放行时原样交回，不做 dict <-> Tick 转换；
+ * 重排键只读 instrument_id（缺失时按 symbol 登记）、datetime 与 volume 三个字段。
+ * 时间参数为秒（time.monotonic()），缺省取 steady_clock 当前时间。
+ */
+#include "bind_common.hpp"
+
+#include <datetime.h>
+
+#include <chrono>
+#include <cmath>
+
+#include "fq/backtest.hpp"
+#include "fq/reorder_buffer.hpp"
+#include "fq/symbol_table.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+/// 持有引用的 PyObject* 暂存；析构时释放仍在暂存中的 dict
+class PyReorderBuffer {
+public:
+    PyReorderBuffer(int64_t max_hold_us, size_t capacity, size_t instruments)
+        : buf_(max_hold_us, capacity, instruments) {}
+
+    ~PyReorderBuffer() {
+        buf_.flush([](PyObject*& o) { Py_DECREF(o); });
+    }
+
+    ReorderBuffer<PyObject*>& buf() { return buf_; }
+
+private:
+    ReorderBuffer<PyObject*> buf_;
+};
+
+int64_t now_us_of(const py::object& now) {
+    if (now.is_none()) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+    return static_cast<int64_t>(std::llround(now.cast<double>() * 1e6));
+}
+
+/// 重排键；无法取得合约或 datetime 时返回 false（原样放行）
+bool item_key(PyObject* d, int32_t& instrument_id, ReorderKey& key) {
+    PyObject* iid = PyDict_GetItemString(d, "instrument_id");
+    if (iid && iid != Py_None) {
+        instrument_id = static_cast<int32_t>(dict_int64(d, "instrument_id"));
+    } else {
+        PyObject* sym = PyDict_GetItemString(d, "symbol");
+        const char* data = nullptr;
+        size_t size = 0;
+        if (!sym || !raw_view(sym, data, size)) return false;
+        instrument_id = global_symbol_table().intern(data, size);
+    }
+    if (instrument_id == kInvalidInstrument) return false;
+    PyObject* dt = PyDict_GetItemString(d, "datetime");
+    if (!dt || !PyDateTime_Check(dt)) return false;
+    const uint32_t date = static_cast<uint32_t>(PyDateTime_GET_YEAR(dt) * 10000 + PyDateTime_GET_MONTH(dt) * 100 +
+                                                PyDateTime_GET_DAY(dt));
+    const int64_t time_us = make_time_us(PyDateTime_DATE_GET_HOUR(dt), PyDateTime_DATE_GET_MINUTE(dt),
+                                         PyDateTime_DATE_GET_SECOND(dt), PyDateTime_DATE_GET_MICROSECOND(dt));
+    key = ReorderKey{sim_time(date, time_us), dict_int64(d, "volume")};
+    return true;
+}
+
+/// 放行的 dict 追加到 out，并释放暂存时持有的引用
+struct ListSink {
+    PyObject* out;
+    void operator()(PyObject*& o) const {
+        const int rc = PyList_Append(out, o);
+        Py_DECREF(o);
+        if (rc != 0) throw py::error_already_set();
+    }
+};
+
+}  // namespace
+
+void bind_reorder_buffer(py::module_& m) {
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) throw py::error_already_set();
+
+    py::class_<PyReorderBuffer>(m, "ReorderBuffer")
+        .def(py::init([](double max_hold, size_t capacity, size_t instruments) {
+                 return new PyReorderBuffer(static_cast<int64_t>(std::llround(max_hold * 1e6)), capacity, instruments);
+             }),
+             py::arg("max_hold") = 0.0002, py::arg("capacity") = 65536, py::arg("instruments") = kMaxInstruments)
+        .def("push", [](PyReorderBuffer& self, const py::list& data_list, const py::object& now) {
+            const int64_t now_us = now_us_of(now);
+            py::list out;
+            ListSink sink{out.ptr()};
+            ReorderBuffer<PyObject*>& buf = self.buf();
+            for (const py::handle& item : data_list) {
+                PyObject* d = item.ptr();
+                int32_t iid = kInvalidInstrument;
+                ReorderKey key{};
+                Py_INCREF(d);
+                if (!PyDict_Check(d) || !item_key(d, iid, key)) {
+                    sink(d);
+                    continue;
+                }
+                if (buf.push(iid, key, d, now_us, sink) == ReorderResult::kLate) Py_DECREF(d);
+            }
+            buf.poll(now_us, sink);
+            return out;
+        }, py::arg("data_list"), py::arg("now") = py::none(),
+           "Hold normalized ticks and return those released by now (late ticks are dropped).")
+        .def("poll", [](PyReorderBuffer& self, const py::object& now) {
+            py::list out;
+            self.buf().poll(now_us_of(now), ListSink{out.ptr()});
+            return out;
+        }, py::arg("now") = py::none(), "Release ticks whose hold time has expired.")
+        .def("flush", [](PyReorderBuffer& self) {
+            py::list out;
+            self.buf().flush(ListSink{out.ptr()});
+            return out;
+        }, "Release every held tick in order.")
+        .def("next_deadline", [](PyReorderBuffer& self) -> py::object {
+            if (self.buf().held() == 0) return py::none();
+            return py::float_(static_cast<double>(self.buf().next_deadline()) * 1e-6);
+        }, "Monotonic time (seconds) at which the oldest held tick is due, or None.")
+        .def("metrics", [](PyReorderBuffer& self) {
+            const ReorderStats& s = self.buf().stats();
+            py::dict d;
+            d["pushed"] = s.pushed;
+            d["released"] = s.released;
+            d["reordered"] = s.reordered;
+            d["late"] = s.late;
+            d["forced"] = s.forced;
+            d["bypassed"] = s.bypassed;
+            d["held"] = self.buf().held();
+            return d;
+        })
+        .def_property_readonly("held", [](PyReorderBuffer& self) { return self.buf().held(); })
+        .def_property_readonly("max_hold", [](PyReorderBuffer& self) {
+            return static_cast<double>(self.buf().max_hold_us()) * 1e-6;
+        });
+}
+
+}  // namespace bindings
+}  // namespace fq
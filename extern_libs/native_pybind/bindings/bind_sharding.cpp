@@ -0,0 +1,121 @@
+/**
+ * bind_sharding.cpp: 合约分片函数的 pybind11 绑定
+ *
+ * Python 侧分片处理器用 shard_partition() 把一批标准化 dict 按 instrument_id
+ * 分到各工作线程，分片规则见 fq/sharding.hpp 的 shard_of()。
+ * ShardedTickWriter 为默认 清洗 → 存储 分片处理器的原生实现：submit() 持 GIL 把 dict 转为 Tick，
+ * 释放 GIL 后投递到各分片的 SpscRing，工作线程不经 Python 去重并写 CSV（见 fq/tick_writer.hpp）。
+ */
+#include "bind_common.hpp"
+
+#include <string>
+#include <vector>
+
+#include "fq/sharding.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick_writer.hpp"
+
+namespace fq {
+namespace bindings {
+
+static py::list shard_partition(const py::list& data_list, size_t shards) {
+    if (shards == 0) throw py::value_error("shards must be positive");
+    std::vector<py::list> parts(shards);
+    for (const py::handle& item : data_list) {
+        int32_t iid = kInvalidInstrument;
+        PyObject* v = PyDict_Check(item.ptr()) ? PyDict_GetItemString(item.ptr(), "instrument_id") : nullptr;
+        if (v && PyLong_Check(v)) iid = static_cast<int32_t>(PyLong_AsLong(v));
+        parts[shard_of(iid, shards)].append(item);
+    }
+    py::list out(shards);
+    for (size_t i = 0; i < shards; ++i) out[i] = parts[i];
+    return out;
+}
+
+namespace {
+
+class PyShardedTickWriter {
+public:
+    PyShardedTickWriter(size_t workers, const std::string& base_path, size_t max_seen_size, size_t ring_size)
+        : writer_(workers, base_path, max_seen_size, ring_size) {}
+
+    void submit(const py::list& data_list) {
+        scratch_.clear();
+        for (const py::handle& item : data_list) {
+            Tick t{};
+            bool ok = false;
+            if (PyDict_Check(item.ptr())) {
+                try {
+                    ok = dict_to_tick(py::reinterpret_borrow<py::dict>(item), t);
+                } catch (const py::error_already_set&) {
+                    ok = false;  // 字段类型不符：计入 rejected，不影响同批其余行情
+                } catch (const py::cast_error&) {
+                    ok = false;
+                }
+            }
+            if (ok) {
+                scratch_.push_back(t);
+            } else {
+                ++rejected_;
+            }
+        }
+        if (scratch_.empty()) return;
+        py::gil_scoped_release release;
+        writer_.submit(scratch_.data(), scratch_.size());
+    }
+
+    void flush() {
+        py::gil_scoped_release release;
+        writer_.flush();
+    }
+
+    void close() {
+        py::gil_scoped_release release;
+        writer_.stop();
+    }
+
+    py::dict metrics() const {
+        py::list backlog, processed, errors;
+        for (size_t i = 0; i < writer_.workers(); ++i) {
+            backlog.append(writer_.backlog(i));
+            processed.append(writer_.processed(i));
+            errors.append(writer_.errors(i));
+        }
+        py::dict m;
+        m["backlog"] = backlog;
+        m["processed"] = processed;
+        m["errors"] = errors;
+        m["rejected"] = rejected_;
+        return m;
+    }
+
+    size_t workers() const { return writer_.workers(); }
+
+private:
+    ShardedTickWriter writer_;
+    std::vector<Tick> scratch_;
+    uint64_t rejected_ = 0;
+};
+
+}  // namespace
+
+void bind_sharding(py::module_& m) {
+    m.def("shard_of", &shard_of, py::arg("instrument_id"), py::arg("shards"),
+          "Instrument id -> worker shard (same rule as shard_partition).");
+    m.def("shard_partition", &shard_partition, py::arg("data_list"), py::arg("shards"),
+          "Split normalized dicts into per-shard lists, preserving per-instrument order.");
+
+    py::class_<PyShardedTickWriter>(m, "ShardedTickWriter")
+        .def(py::init<size_t, const std::string&, size_t, size_t>(), py::arg("workers"), py::arg("base_path"),
+             py::arg("max_seen_size") = 10000, py::arg("ring_size") = 16384)
+        .def("submit", &PyShardedTickWriter::submit, py::arg("data_list"),
+             "Convert dicts to ticks and queue them per shard (clean + CSV write run on native threads).")
+        .def("flush", &PyShardedTickWriter::flush, "Wait until every queued tick has been written.")
+        .def("close", &PyShardedTickWriter::close, "Drain the queues and stop the worker threads.")
+        .def("metrics", &PyShardedTickWriter::metrics,
+             "Per-shard backlog (ticks), processed rows and failed batches, plus rejected dicts.")
+        .def_property_readonly("workers", &PyShardedTickWriter::workers);
+}
+
+}  // namespace bindings
+}  // namespace fq
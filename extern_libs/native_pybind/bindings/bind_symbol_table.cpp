@@ -0,0 +1,49 @@
+/**
+ * bind_symbol_table.cpp: fq::SymbolTable 的 pybind11 绑定
+ */
+#include "bind_common.hpp"
+
+#include "fq/symbol_table.hpp"
+
+namespace fq {
+namespace bindings {
+
+static int32_t intern_obj(SymbolTable& table, const py::handle& raw) {
+    const char* data = nullptr;
+    size_t size = 0;
+    if (!raw_view(raw, data, size)) throw py::type_error("symbol must be bytes or str");
+    return table.intern(data, size);
+}
+
+static int32_t find_obj(const SymbolTable& table, const py::handle& raw) {
+    const char* data = nullptr;
+    size_t size = 0;
+    if (!raw_view(raw, data, size)) throw py::type_error("symbol must be bytes or str");
+    return table.find(data, size);
+}
+
+void bind_symbol_table(py::module_& m) {
+    py::class_<SymbolTable>(m, "SymbolTable")
+        .def(py::init<size_t>(), py::arg("capacity") = kMaxInstruments)
+        .def("intern", &intern_obj, py::arg("raw"),
+             "Intern raw fixed-width symbol bytes (or str). Returns dense id, -1 if invalid/full.")
+        .def("find", &find_obj, py::arg("raw"), "Look up without interning. Returns id or -1.")
+        .def("name", [](const SymbolTable& t, int32_t id) -> py::object {
+            const char* s = t.name(id);
+            if (!s) return py::none();
+            PyObject* u = PyUnicode_DecodeUTF8(s, static_cast<Py_ssize_t>(t.name_len(id)), "replace");
+            if (!u) throw py::error_already_set();
+            return py::reinterpret_steal<py::object>(u);
+        }, py::arg("instrument_id"), "Instrument id -> normalized symbol str (None if unknown).")
+        .def("__len__", &SymbolTable::size)
+        .def_property_readonly("capacity", &SymbolTable::capacity);
+
+    m.def("global_symbol_table", &global_symbol_table, py::return_value_policy::reference,
+          "Process-wide symbol table shared by all native stages.");
+    m.attr("MAX_SYMBOL_LEN") = kMaxSymbolLen;
+    m.attr("MAX_INSTRUMENTS") = kMaxInstruments;
+    m.attr("INVALID_INSTRUMENT") = kInvalidInstrument;
+}
+
+}  // namespace bindings
+}  // namespace fq
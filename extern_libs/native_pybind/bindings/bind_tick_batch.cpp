@@ -0,0 +1,247 @@
+/**
+ * bind_tick_batch.cpp: fq::TickBatch 与惰性 TickView 的 pybind11 绑定
+ *
+ * TickView 只持有 (批次, 下标, generation)，属性访问时才从槽位解码为 Python 对象；
+ * 迭代批次时复用同一个 TickView（游标语义），不做逐条分配。需要长期保留某条
+ * 行情时请使用 batch[i] 或 view.to_dict()。
+ */
+#include "bind_common.hpp"
+
+#include <datetime.h>
+
+#include <vector>
+
+#include "fq/decoders.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick_batch.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+struct TickView {
+    py::object owner;  // 持有批次，保证槽位内存有效
+    const TickBatch* batch;
+    size_t index;
+    uint64_t generation;
+
+    const Tick& tick() const {
+        if (batch->generation() != generation || index >= batch->size())
+            throw py::value_error("TickView is stale: its batch has been cleared or swapped");
+        return (*batch)[index];
+    }
+};
+
+struct TickIterator {
+    py::object view_obj;
+    TickView* view;
+    size_t next;
+};
+
+// 合约 ID -> 已物化的 Python str（GIL 保护；进程退出时有意泄漏，避免解释器析构后释放）
+std::vector<PyObject*>* g_symbol_names = new std::vector<PyObject*>();
+
+py::object symbol_str(int32_t instrument_id) {
+    if (instrument_id < 0) return py::str("");
+    const size_t idx = static_cast<size_t>(instrument_id);
+    if (idx < g_symbol_names->size() && (*g_symbol_names)[idx])
+        return py::reinterpret_borrow<py::object>((*g_symbol_names)[idx]);
+    const SymbolTable& table = global_symbol_table();
+    const char* s = table.name(instrument_id);
+    if (!s) return py::str("");
+    PyObject* u = PyUnicode_DecodeUTF8(s, static_cast<Py_ssize_t>(table.name_len(instrument_id)), "replace");
+    if (!u) throw py::error_already_set();
+    if (idx >= g_symbol_names->size()) g_symbol_names->resize(idx + 1, nullptr);
+    (*g_symbol_names)[idx] = u;  // 缓存持有一份引用
+    return py::reinterpret_borrow<py::object>(u);
+}
+
+py::object tick_datetime(const Tick& t) {
+    int64_t us = t.time_us;
+    const int micros = static_cast<int>(us % 1000000);
+    us /= 1000000;
+    const int second = static_cast<int>(us % 60);
+    us /= 60;
+    const int minute = static_cast<int>(us % 60);
+    const int hour = static_cast<int>(us / 60);
+    PyObject* dt = PyDateTime_FromDateAndTime(
+        static_cast<int>(t.trade_date / 10000), static_cast<int>(t.trade_date / 100 % 100),
+        static_cast<int>(t.trade_date % 100), hour, minute, second, micros);
+    if (!dt) throw py::error_already_set();
+    return py::reinterpret_steal<py::object>(dt);
+}
+
+template <typename T>
+T dict_get(const py::dict& d, const char* key, T def) {
+    PyObject* v = PyDict_GetItemString(d.ptr(), key);
+    if (!v || v == Py_None) return def;
+    return py::reinterpret_borrow<py::object>(v).cast<T>();
+}
+
+using Decoder = bool (*)(const char*, size_t, SymbolTable&, Tick&);
+
+bool append_raw(TickBatch& batch, const py::bytes& raw, Decoder decode) {
+    char* data = nullptr;
+    Py_ssize_t size = 0;
+    if (PyBytes_AsStringAndSize(raw.ptr(), &data, &size) != 0) throw py::error_already_set();
+    Tick* slot = batch.emplace();
+    if (!slot) return false;
+    if (!decode(data, static_cast<size_t>(size), global_symbol_table(), *slot)) {
+        batch.pop_back();
+        return false;
+    }
+    return true;
+}
+
+#define FQ_TICK_FIELD(name) \
+    def_property_readonly(#name, [](const TickView& v) { return v.tick().name; })
+
+}  // namespace
+
+py::dict tick_to_dict(const Tick& t) {
+    // 键顺序与 DataParser 输出一致，FileStorage 按此顺序写 CSV 表头
+    py::dict d;
+    d["symbol"] = symbol_str(t.instrument_id);
+    d["instrument_id"] = t.instrument_id;
+    d["exchange"] = exchange_name(t.exchange);
+    d["last_price"] = t.last_price;
+    d["volume"] = t.volume;
+    d["turnover"] = t.turnover;
+    d["open_interest"] = t.open_interest;
+    d["datetime"] = tick_datetime(t);
+    d["bid_price_1"] = t.bid_price_1;
+    d["bid_volume_1"] = t.bid_volume_1;
+    d["ask_price_1"] = t.ask_price_1;
+    d["ask_volume_1"] = t.ask_volume_1;
+    d["open_price"] = t.open_price;
+    d["high_price"] = t.high_price;
+    d["low_price"] = t.low_price;
+    d["pre_close"] = t.pre_close;
+    d["pre_settlement"] = t.pre_settlement;
+    return d;
+}
+
+bool dict_to_tick(const py::dict& d, Tick& t) {
+    PyObject* iid = PyDict_GetItemString(d.ptr(), "instrument_id");
+    if (iid && iid != Py_None) {
+        t.instrument_id = py::reinterpret_borrow<py::object>(iid).cast<int32_t>();
+    } else {
+        PyObject* sym = PyDict_GetItemString(d.ptr(), "symbol");
+        const char* data = nullptr;
+        size_t size = 0;
+        if (!sym || !raw_view(sym, data, size)) return false;
+        t.instrument_id = global_symbol_table().intern(data, size);
+    }
+    if (t.instrument_id == kInvalidInstrument) return false;
+    const std::string ex = dict_get<std::string>(d, "exchange", std::string());
+    t.exchange = exchange_from_name(ex.data(), ex.size());
+    t.source = Source::kUnknown;
+    t.flags = 0;
+    t.reserved = 0;
+    PyObject* dt = PyDict_GetItemString(d.ptr(), "datetime");
+    if (!dt || !PyDateTime_Check(dt)) return false;
+    t.trade_date = static_cast<uint32_t>(PyDateTime_GET_YEAR(dt) * 10000 + PyDateTime_GET_MONTH(dt) * 100 +
+                                         PyDateTime_GET_DAY(dt));
+    t.time_us = make_time_us(PyDateTime_DATE_GET_HOUR(dt), PyDateTime_DATE_GET_MINUTE(dt),
+                             PyDateTime_DATE_GET_SECOND(dt), PyDateTime_DATE_GET_MICROSECOND(dt));
+    t.last_price = dict_get<double>(d, "last_price", 0.0);
+    t.volume = dict_get<int64_t>(d, "volume", 0);
+    t.turnover = dict_get<double>(d, "turnover", 0.0);
+    t.open_interest = dict_get<double>(d, "open_interest", 0.0);
+    t.bid_price_1 = dict_get<double>(d, "bid_price_1", 0.0);
+    t.bid_volume_1 = dict_get<int64_t>(d, "bid_volume_1", 0);
+    t.ask_price_1 = dict_get<double>(d, "ask_price_1", 0.0);
+    t.ask_volume_1 = dict_get<int64_t>(d, "ask_volume_1", 0);
+    t.open_price = dict_get<double>(d, "open_price", 0.0);
+    t.high_price = dict_get<double>(d, "high_price", 0.0);
+    t.low_price = dict_get<double>(d, "low_price", 0.0);
+    t.pre_close = dict_get<double>(d, "pre_close", 0.0);
+    t.pre_settlement = dict_get<double>(d, "pre_settlement", 0.0);
+    return true;
+}
+
+void bind_tick_batch(py::module_& m) {
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) throw py::error_already_set();
+
+    py::class_<TickView>(m, "TickView")
+        .def_property_readonly("symbol", [](const TickView& v) { return symbol_str(v.tick().instrument_id); })
+        .def_property_readonly("exchange", [](const TickView& v) { return exchange_name(v.tick().exchange); })
+        .def_property_readonly("datetime", [](const TickView& v) { return tick_datetime(v.tick()); })
+        .FQ_TICK_FIELD(instrument_id)
+        .FQ_TICK_FIELD(trade_date)
+        .FQ_TICK_FIELD(time_us)
+        .FQ_TICK_FIELD(last_price)
+        .FQ_TICK_FIELD(volume)
+        .FQ_TICK_FIELD(turnover)
+        .FQ_TICK_FIELD(open_interest)
+        .FQ_TICK_FIELD(bid_price_1)
+        .FQ_TICK_FIELD(bid_volume_1)
+        .FQ_TICK_FIELD(ask_price_1)
+        .FQ_TICK_FIELD(ask_volume_1)
+        .FQ_TICK_FIELD(open_price)
+        .FQ_TICK_FIELD(high_price)
+        .FQ_TICK_FIELD(low_price)
+        .FQ_TICK_FIELD(pre_close)
+        .FQ_TICK_FIELD(pre_settlement)
+        .def("to_dict", [](const TickView& v) { return tick_to_dict(v.tick()); },
+             "Materialize the tick as a legacy FUTURES_BASE_FIELDS dict.")
+        .def("__repr__", [](const TickView& v) {
+            return py::str("<TickView {} {} @{}>").format(symbol_str(v.tick().instrument_id),
+                                                         v.tick().last_price, v.index);
+        });
+
+    py::class_<TickIterator>(m, "TickIterator")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", [](TickIterator& it) -> py::object {
+            if (it.next >= it.view->batch->size()) throw py::stop_iteration();
+            it.view->index = it.next++;
+            return it.view_obj;
+        });
+
+    py::class_<TickBatch>(m, "TickBatch")
+        .def(py::init<size_t>(), py::arg("capacity") = 4096)
+        .def("__len__", &TickBatch::size)
+        .def("__getitem__", [](py::object self, py::ssize_t i) {
+            const TickBatch& b = self.cast<const TickBatch&>();
+            const py::ssize_t n = static_cast<py::ssize_t>(b.size());
+            if (i < 0) i += n;
+            if (i < 0 || i >= n) throw py::index_error();
+            return TickView{self, &b, static_cast<size_t>(i), b.generation()};
+        })
+        .def("__iter__", [](py::object self) {
+            const TickBatch& b = self.cast<const TickBatch&>();
+            py::object view_obj = py::cast(TickView{self, &b, 0, b.generation()});
+            TickView* view = view_obj.cast<TickView*>();
+            return TickIterator{view_obj, view, 0};
+        }, "Iterate with a single reused cursor view (valid until the next step).")
+        .def("append_gfex_l2", [](TickBatch& b, const py::bytes& raw) { return append_raw(b, raw, &decode_gfex_l2); },
+             py::arg("raw"), "Decode one NanoGfexL2MdType frame into the next slot. False if full/invalid.")
+        .def("append_dce_l1", [](TickBatch& b, const py::bytes& raw) { return append_raw(b, raw, &decode_dce_l1); },
+             py::arg("raw"), "Decode one DCEL1_Quotation payload into the next slot.")
+        .def("append_czce_l1", [](TickBatch& b, const py::bytes& raw) { return append_raw(b, raw, &decode_czce_l1); },
+             py::arg("raw"), "Decode one CZCEL2_Quotation payload into the next slot.")
+        .def("append_dict", [](TickBatch& b, const py::dict& d) {
+            // 先转换到局部记录再占槽：字段类型不符时 cast 抛出，不会留下半填充的槽位
+            Tick t;
+            if (b.full() || !dict_to_tick(d, t)) return false;
+            *b.emplace() = t;
+            return true;
+        }, py::arg("data"), "Append a normalized FUTURES_BASE_FIELDS dict. False if full/invalid.")
+        .def("to_dicts", [](const TickBatch& b) {
+            py::list out(b.size());
+            for (size_t i = 0; i < b.size(); ++i) out[i] = tick_to_dict(b[i]);
+            return out;
+        }, "Materialize all ticks as legacy dicts.")
+        .def("clear", &TickBatch::clear)
+        .def("swap", &TickBatch::swap, py::arg("other"))
+        .def_property_readonly("capacity", &TickBatch::capacity)
+        .def_property_readonly("full", &TickBatch::full)
+        .def_property_readonly("generation", &TickBatch::generation);
+}
+
+#undef FQ_TICK_FIELD
+
+}  // namespace bindings
+}  // namespace fq
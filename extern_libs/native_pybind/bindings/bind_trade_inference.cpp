@@ -0,0 +1,93 @@
+/**
+ * bind_trade_inference.cpp: fq::TradeInference 的 pybind11 绑定
+ *
+ * infer() 接收一批标准化行情 dict，按 instrument_id 连续推断区间成交，返回成交 dict 列表；
+ * symbol/exchange/datetime 直接复用输入 dict 中的对象，不重新构造。
+ */
+#include "bind_common.hpp"
+
+#include <datetime.h>
+
+#include "fq/symbol_table.hpp"
+#include "fq/trade_inference.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+bool item_snapshot(PyObject* d, Snapshot& s) {
+    PyObject* iid = PyDict_GetItemString(d, "instrument_id");
+    if (iid && PyLong_Check(iid)) {
+        s.instrument_id = static_cast<int32_t>(PyLong_AsLong(iid));
+    } else {
+        PyObject* sym = PyDict_GetItemString(d, "symbol");
+        const char* data = nullptr;
+        size_t size = 0;
+        if (!sym || !raw_view(sym, data, size)) return false;
+        s.instrument_id = global_symbol_table().intern(data, size);
+    }
+    if (s.instrument_id < 0) return false;
+    PyObject* dt = PyDict_GetItemString(d, "datetime");
+    if (!dt || !PyDateTime_Check(dt)) return false;
+    s.trade_date = static_cast<uint32_t>(PyDateTime_GET_YEAR(dt) * 10000 + PyDateTime_GET_MONTH(dt) * 100 +
+                                         PyDateTime_GET_DAY(dt));
+    s.time_us = make_time_us(PyDateTime_DATE_GET_HOUR(dt), PyDateTime_DATE_GET_MINUTE(dt),
+                             PyDateTime_DATE_GET_SECOND(dt), PyDateTime_DATE_GET_MICROSECOND(dt));
+    s.volume = dict_int64(d, "volume");
+    s.turnover = dict_double(d, "turnover");
+    s.last_price = dict_double(d, "last_price");
+    s.bid_price_1 = dict_double(d, "bid_price_1");
+    s.ask_price_1 = dict_double(d, "ask_price_1");
+    return true;
+}
+
+py::dict trade_dict(PyObject* src, const InferredTrade& t) {
+    // 键顺序与 src/processor/trade_inference.py 的纯 Python 实现一致
+    py::dict d;
+    auto copy = [&](const char* key) {
+        PyObject* v = PyDict_GetItemString(src, key);
+        d[key] = v ? py::reinterpret_borrow<py::object>(v) : py::none();
+    };
+    copy("symbol");
+    d["instrument_id"] = t.instrument_id;
+    copy("exchange");
+    copy("datetime");
+    d["event"] = "trade";
+    d["price"] = t.vwap;
+    d["volume"] = t.quantity;
+    d["turnover"] = t.turnover;
+    d["side"] = side_name(t.side);
+    d["rule"] = side_rule_name(t.rule);
+    d["bid_price_1"] = t.bid_price;
+    d["ask_price_1"] = t.ask_price;
+    return d;
+}
+
+}  // namespace
+
+void bind_trade_inference(py::module_& m) {
+    PyDateTime_IMPORT;
+    if (!PyDateTimeAPI) throw py::error_already_set();
+
+    py::class_<TradeInference>(m, "TradeInference")
+        .def(py::init<size_t>(), py::arg("capacity") = kMaxInstruments)
+        .def("set_multiplier", &TradeInference::set_multiplier, py::arg("instrument_id"), py::arg("multiplier"),
+             "Contract multiplier used for VWAP = dTurnover / (dVolume * multiplier).")
+        .def("multiplier", &TradeInference::multiplier, py::arg("instrument_id"),
+             "Configured or estimated multiplier (0 if unknown).")
+        .def("infer", [](TradeInference& self, const py::list& data_list) {
+            py::list out;
+            Snapshot s{};
+            InferredTrade t{};
+            for (const py::handle& item : data_list) {
+                if (!PyDict_Check(item.ptr()) || !item_snapshot(item.ptr(), s)) continue;
+                if (self.on_snapshot(s, t)) out.append(trade_dict(item.ptr(), t));
+            }
+            return out;
+        }, py::arg("data_list"), "Infer trades (with aggressor side) from consecutive normalized snapshots.")
+        .def_property_readonly("capacity", &TradeInference::capacity);
+}
+
+}  // namespace bindings
+}  // namespace fq
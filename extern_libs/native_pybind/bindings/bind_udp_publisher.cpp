@@ -0,0 +1,228 @@
+/**
+ * bind_udp_publisher.cpp: fq::UdpTickPublisher / fq::SoftFrameRing 的 pybind11 绑定
+ *
+ * 发送端以 "fq.TxOps" capsule 传入（exanic_pybind.tx_ops() 或 SoftFrameRing.tx_ops()），
+ * capsule 的 context 持有其所属对象的引用，发布者存活期间发送端不会被回收。
+ * 也可直接传入带 tx_ops() 方法的对象。与 src/api/tx_publisher.py 的纯 Python 实现接口一致。
+ */
+#include "bind_common.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fq/soft_nic.hpp"
+#include "fq/tick_batch.hpp"
+#include "fq/udp_publisher.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+/// TxOps capsule，context 持有 owner 的引用
+py::object make_tx_ops_capsule(TxOps* ops, PyObject* owner) {
+    PyObject* cap = PyCapsule_New(ops, kTxOpsCapsule, [](PyObject* c) {
+        Py_XDECREF(static_cast<PyObject*>(PyCapsule_GetContext(c)));
+    });
+    if (!cap) throw py::error_already_set();
+    Py_INCREF(owner);
+    PyCapsule_SetContext(cap, owner);
+    return py::reinterpret_steal<py::object>(cap);
+}
+
+class PySoftFrameRing {
+public:
+    explicit PySoftFrameRing(size_t capacity) : ring_(capacity), ops_(ring_.tx_ops()) {}
+
+    SoftFrameRing& ring() { return ring_; }
+    TxOps* ops() { return &ops_; }
+
+private:
+    SoftFrameRing ring_;
+    TxOps ops_;
+};
+
+uint32_t parse_ipv4(const std::string& s) {
+    in_addr addr;
+    if (::inet_pton(AF_INET, s.c_str(), &addr) != 1) throw std::invalid_argument("invalid IPv4 address: " + s);
+    return ntohl(addr.s_addr);
+}
+
+void parse_mac(const std::string& s, uint8_t out[6]) {
+    unsigned v[6];
+    char tail;
+    if (std::sscanf(s.c_str(), "%x:%x:%x:%x:%x:%x%c", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &tail) != 6)
+        throw std::invalid_argument("invalid MAC address: " + s);
+    for (int i = 0; i < 6; ++i) {
+        if (v[i] > 0xff) throw std::invalid_argument("invalid MAC address: " + s);
+        out[i] = static_cast<uint8_t>(v[i]);
+    }
+}
+
+class PyUdpTickPublisher {
+public:
+    PyUdpTickPublisher(py::object tx, const UdpEndpoint& endpoint, size_t ticks_per_frame, size_t stamp_spins,
+                       size_t stamp_capacity)
+        : tx_(std::move(tx)),
+          publisher_(*static_cast<TxOps*>(PyCapsule_GetPointer(tx_.ptr(), kTxOpsCapsule)), endpoint,
+                     ticks_per_frame, stamp_spins, stamp_capacity) {}
+
+    UdpTickPublisher& publisher() { return publisher_; }
+    std::vector<Tick>& scratch() { return scratch_; }
+
+private:
+    py::object tx_;  ///< 持有 capsule（及其所属发送端）
+    UdpTickPublisher publisher_;
+    std::vector<Tick> scratch_;  ///< publish(list) 的转换缓冲，批间复用容量
+};
+
+py::object tx_ops_of(const py::object& tx) {
+    py::object cap = PyCapsule_CheckExact(tx.ptr()) ? tx : tx.attr("tx_ops")();
+    if (cap.is_none() || !PyCapsule_IsValid(cap.ptr(), kTxOpsCapsule))
+        throw std::invalid_argument("tx does not provide an fq.TxOps capsule");
+    return cap;
+}
+
+PyUdpTickPublisher* make_publisher(const py::object& tx, const std::string& dst_ip, uint16_t dst_port,
+                                   const std::string& dst_mac, const std::string& src_ip, uint16_t src_port,
+                                   const std::string& src_mac, size_t ticks_per_frame, const py::object& symbols,
+                                   size_t stamp_spins, size_t stamp_capacity, uint8_t ttl) {
+    UdpEndpoint ep{};
+    ep.dst_ip = parse_ipv4(dst_ip);
+    ep.src_ip = parse_ipv4(src_ip);
+    ep.dst_port = dst_port;
+    ep.src_port = src_port ? src_port : dst_port;
+    ep.ttl = ttl;
+    parse_mac(src_mac, ep.src_mac);
+    if (!dst_mac.empty()) {
+        parse_mac(dst_mac, ep.dst_mac);
+    } else if ((ep.dst_ip >> 28) == 0xe) {
+        // 组播：01:00:5e + IP 低 23 位
+        const uint8_t mac[6] = {0x01, 0x00, 0x5e, static_cast<uint8_t>((ep.dst_ip >> 16) & 0x7f),
+                                static_cast<uint8_t>(ep.dst_ip >> 8), static_cast<uint8_t>(ep.dst_ip)};
+        std::memcpy(ep.dst_mac, mac, 6);
+    } else {
+        throw std::invalid_argument("dst_mac is required for unicast dst_ip " + dst_ip);
+    }
+    auto* self = new PyUdpTickPublisher(tx_ops_of(tx), ep, ticks_per_frame, stamp_spins, stamp_capacity);
+    if (!symbols.is_none()) {
+        SymbolTable& table = global_symbol_table();
+        for (const py::handle& s : symbols) {
+            const std::string name = s.cast<std::string>();
+            self->publisher().allow(table.intern(name.data(), name.size()));
+        }
+    }
+    return self;
+}
+
+py::dict wire_to_dict(const WireTick& w) {
+    Tick t{};
+    t.instrument_id = global_symbol_table().intern(w.symbol, ::strnlen(w.symbol, sizeof(w.symbol)));
+    t.exchange = static_cast<Exchange>(w.exchange);
+    t.source = static_cast<Source>(w.source);
+    t.flags = w.flags;
+    t.trade_date = w.trade_date;
+    t.time_us = w.time_us;
+    t.last_price = w.last_price;
+    t.volume = w.volume;
+    t.turnover = w.turnover;
+    t.open_interest = w.open_interest;
+    t.bid_price_1 = w.bid_price_1;
+    t.bid_volume_1 = w.bid_volume_1;
+    t.ask_price_1 = w.ask_price_1;
+    t.ask_volume_1 = w.ask_volume_1;
+    return tick_to_dict(t);
+}
+
+}  // namespace
+
+void bind_udp_publisher(py::module_& m) {
+    py::class_<PySoftFrameRing>(m, "SoftFrameRing")
+        .def(py::init<size_t>(), py::arg("capacity") = 1024)
+        .def("transmit_frame", [](PySoftFrameRing& self, const py::bytes& frame) {
+            const char* data = nullptr;
+            size_t size = 0;
+            raw_view(frame, data, size);
+            return self.ring().transmit(data, size);
+        }, py::arg("frame"), "Transmit one frame. Returns 0, or -1 when the ring is full or the frame too large.")
+        .def("receive_frame", [](PySoftFrameRing& self, size_t max_size) {
+            char buf[SoftFrameRing::kMaxFrame];
+            const int64_t n = self.ring().receive(buf, max_size < sizeof(buf) ? max_size : sizeof(buf));
+            return n > 0 ? py::bytes(buf, static_cast<size_t>(n)) : py::bytes("");
+        }, py::arg("max_size") = 2048, "Receive one frame. Returns frame bytes or empty bytes if none.")
+        .def("get_tx_timestamp", [](PySoftFrameRing& self) { return self.ring().last_tx_ns(); },
+             "Timestamp (CLOCK_MONOTONIC ns) of the last transmitted frame, 0 if none.")
+        .def("tx_ops", [](py::object self) {
+            return make_tx_ops_capsule(self.cast<PySoftFrameRing&>().ops(), self.ptr());
+        })
+        .def_property_readonly("pending", [](PySoftFrameRing& self) { return self.ring().pending(); })
+        .def_property_readonly("dropped", [](PySoftFrameRing& self) { return self.ring().dropped(); })
+        .def_property_readonly("capacity", [](PySoftFrameRing& self) { return self.ring().capacity(); });
+
+    py::class_<PyUdpTickPublisher>(m, "UdpTickPublisher")
+        .def(py::init(&make_publisher), py::arg("tx"), py::arg("dst_ip"), py::arg("dst_port"),
+             py::arg("dst_mac") = "", py::arg("src_ip") = "0.0.0.0", py::arg("src_port") = 0,
+             py::arg("src_mac") = "00:00:00:00:00:00", py::arg("ticks_per_frame") = 1,
+             py::arg("symbols") = py::none(), py::arg("stamp_spins") = 256, py::arg("stamp_capacity") = 4096,
+             py::arg("ttl") = 64)
+        .def("publish", [](PyUdpTickPublisher& self, const py::list& data_list) {
+            std::vector<Tick>& ticks = self.scratch();
+            ticks.clear();
+            Tick t{};
+            for (const py::handle& item : data_list) {
+                if (PyDict_Check(item.ptr()) && dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) {
+                    ticks.push_back(t);
+                } else {
+                    t.instrument_id = kInvalidInstrument;  // 计入 filtered
+                    ticks.push_back(t);
+                }
+            }
+            return self.publisher().publish(ticks.data(), ticks.size());
+        }, py::arg("data_list"), "Publish normalized tick dicts. Returns the number of ticks sent.")
+        .def("publish_batch", [](PyUdpTickPublisher& self, const TickBatch& batch, size_t start) {
+            if (start >= batch.size()) return static_cast<size_t>(0);
+            return self.publisher().publish(batch.data() + start, batch.size() - start);
+        }, py::arg("batch"), py::arg("start") = 0, "Publish batch[start:] straight from the batch slots.")
+        .def("tx_timestamps", [](PyUdpTickPublisher& self) {
+            py::list out;
+            TxStamp s;
+            while (self.publisher().pop_stamp(s)) out.append(py::make_tuple(s.seq, s.tx_ns));
+            return out;
+        }, "Drain recorded (frame seq, tx timestamp ns) pairs.")
+        .def("metrics", [](PyUdpTickPublisher& self) {
+            const TxPublisherStats& s = self.publisher().stats();
+            py::dict d;
+            d["frames"] = s.frames;
+            d["ticks"] = s.ticks;
+            d["filtered"] = s.filtered;
+            d["errors"] = s.errors;
+            d["stamped"] = s.stamped;
+            d["unstamped"] = s.unstamped;
+            d["stamp_overflow"] = s.stamp_overflow;
+            d["seq"] = self.publisher().seq();
+            return d;
+        })
+        .def_property_readonly("seq", [](PyUdpTickPublisher& self) { return self.publisher().seq(); })
+        .def_property_readonly("ticks_per_frame",
+                               [](PyUdpTickPublisher& self) { return self.publisher().ticks_per_frame(); });
+
+    m.def("decode_tick_frame", [](const py::bytes& frame, uint16_t dst_port) {
+        const char* data = nullptr;
+        size_t size = 0;
+        raw_view(frame, data, size);
+        py::list ticks;
+        const uint64_t seq = decode_tick_frame(data, size, dst_port, [&](const WireTick& w) {
+            ticks.append(wire_to_dict(w));
+        });
+        return py::make_tuple(seq, ticks);
+    }, py::arg("frame"), py::arg("dst_port") = 0,
+       "Decode a published tick frame. Returns (seq, [tick dict]); seq is 0 for foreign frames.");
+}
+
+}  // namespace bindings
+}  // namespace fq
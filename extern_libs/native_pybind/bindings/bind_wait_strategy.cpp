@@ -0,0 +1,52 @@
+/**
+ * bind_wait_strategy.cpp: fq::WaitStrategy 的 pybind11 绑定
+ *
+ * Python 侧时间参数以秒为单位；idle() 期间释放 GIL，自旋/休眠不阻塞其他 Python 线程。
+ */
+#include "bind_common.hpp"
+
+#include <string>
+
+#include "fq/wait_strategy.hpp"
+
+namespace fq {
+namespace bindings {
+
+void bind_wait_strategy(py::module_& m) {
+    py::class_<WaitStrategy>(m, "WaitStrategy")
+        .def(py::init([](const std::string& mode, uint32_t spin_iters, uint32_t yield_iters, uint32_t max_pause,
+                         double park_timeout, double block_timeout) {
+                 WaitConfig cfg;
+                 if (!wait_mode_from_name(mode.c_str(), cfg.mode))
+                     throw py::value_error("unknown wait strategy mode: " + mode);
+                 cfg.spin_iters = spin_iters;
+                 cfg.yield_iters = yield_iters;
+                 cfg.max_pause = max_pause;
+                 cfg.park_timeout_ns = static_cast<int64_t>(park_timeout * 1e9);
+                 cfg.block_timeout_ns = static_cast<int64_t>(block_timeout * 1e9);
+                 return new WaitStrategy(cfg);
+             }),
+             py::arg("mode") = "spin_park", py::arg("spin_iters") = 1000, py::arg("yield_iters") = 100,
+             py::arg("max_pause") = 64, py::arg("park_timeout") = 0.001, py::arg("block_timeout") = 0.0001)
+        .def("idle", &WaitStrategy::idle, py::call_guard<py::gil_scoped_release>(),
+             "Wait once according to the current phase (no data this round).")
+        .def("reset", &WaitStrategy::reset, "Data found: return to the spin phase.")
+        .def("notify", &WaitStrategy::notify, "Wake a parked consumer.")
+        .def_property_readonly("mode", [](const WaitStrategy& w) { return std::string(wait_mode_name(w.config().mode)); })
+        .def("stats", [](const WaitStrategy& w) {
+            const WaitStats& s = w.stats();
+            py::dict d;
+            d["mode"] = wait_mode_name(w.config().mode);
+            d["spin_time"] = s.spin_ns * 1e-9;
+            d["yield_time"] = s.yield_ns * 1e-9;
+            d["park_time"] = s.park_ns * 1e-9;
+            d["spins"] = s.spins;
+            d["yields"] = s.yields;
+            d["parks"] = s.parks;
+            d["wakeups"] = s.wakeups;
+            return d;
+        }, "Time spent spinning / yielding / parked and phase counters.");
+}
+
+}  // namespace bindings
+}  // namespace fq
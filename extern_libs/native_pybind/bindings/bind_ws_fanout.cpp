@@ -0,0 +1,109 @@
+/**
+ * bind_ws_fanout.cpp: fq::SnapshotTable + fq::WsFanoutServer 的 pybind11 绑定
+ *
+ * 一个 Python 对象同时持有最新行情表与服务，构造参数与 src/api/ws_fanout.py 的纯 Python
+ * WsFanoutServer 一致；start() 监听失败抛 RuntimeError。publish() 只写表，不碰任何 socket。
+ */
+#include "bind_common.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "fq/tick_batch.hpp"
+#include "fq/ws_fanout.hpp"
+
+namespace fq {
+namespace bindings {
+
+namespace {
+
+WsFanoutOptions make_options(const std::string& host, int port, double rate, double max_rate, size_t max_clients,
+                             const std::string& format) {
+    if (port < 0 || port > 0xFFFF) throw std::invalid_argument("ws_fanout: port out of range");
+    if (format != "json" && format != "binary") throw std::invalid_argument("unknown format: " + format);
+    WsFanoutOptions o;
+    o.host = host;
+    o.port = static_cast<uint16_t>(port);
+    o.default_rate = rate;
+    o.max_rate = max_rate;
+    o.max_clients = max_clients;
+    o.binary = format == "binary";
+    return o;
+}
+
+class PyWsFanoutServer {
+public:
+    PyWsFanoutServer(const std::string& host, int port, size_t capacity, double rate, double max_rate,
+                     size_t max_clients, const std::string& format)
+        : table_(capacity), server_(table_, make_options(host, port, rate, max_rate, max_clients, format)) {}
+
+    SnapshotTable& table() { return table_; }
+    WsFanoutServer& server() { return server_; }
+
+private:
+    SnapshotTable table_;     ///< 须先于 server_ 构造、后于其析构
+    WsFanoutServer server_;
+};
+
+}  // namespace
+
+void bind_ws_fanout(py::module_& m) {
+    py::class_<PyWsFanoutServer>(m, "WsFanoutServer")
+        .def(py::init<const std::string&, int, size_t, double, double, size_t, const std::string&>(),
+             py::arg("host") = "127.0.0.1", py::arg("port") = 8765, py::arg("capacity") = kMaxInstruments,
+             py::arg("rate") = 4.0, py::arg("max_rate") = 50.0, py::arg("max_clients") = 256,
+             py::arg("format") = "json")
+        .def("publish", [](PyWsFanoutServer& self, const py::list& data_list, size_t start) {
+            const size_t n = data_list.size();
+            const int64_t now = realtime_ns();  // 同一批共用一个接收时间
+            size_t written = 0;
+            Tick t{};
+            for (size_t i = start; i < n; ++i) {
+                PyObject* item = PyList_GET_ITEM(data_list.ptr(), static_cast<Py_ssize_t>(i));
+                if (!PyDict_Check(item) || !dict_to_tick(py::reinterpret_borrow<py::dict>(item), t)) continue;
+                if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= self.table().capacity()) continue;
+                self.table().publish(t, now);
+                ++written;
+            }
+            return written;
+        }, py::arg("data_list"), py::arg("start") = 0,
+           "Write each tick from start into the latest-snapshot table; returns the number written.")
+        .def("publish_batch", [](PyWsFanoutServer& self, const TickBatch& batch, size_t start) {
+            const int64_t now = realtime_ns();
+            size_t written = 0;
+            for (size_t i = start; i < batch.size(); ++i) {
+                const Tick& t = batch.data()[i];
+                if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= self.table().capacity()) continue;
+                self.table().publish(t, now);
+                ++written;
+            }
+            return written;
+        }, py::arg("batch"), py::arg("start") = 0, "Same as publish() straight from the batch slots.")
+        .def("start", [](PyWsFanoutServer& self) {
+            std::string error;
+            if (!self.server().start(&error)) throw std::runtime_error(error);
+        })
+        .def("stop", [](PyWsFanoutServer& self) {
+            py::gil_scoped_release release;
+            self.server().stop();
+        })
+        .def("stats", [](PyWsFanoutServer& self) {
+            const WsFanoutStats s = self.server().stats();
+            py::dict d;
+            d["clients"] = s.clients;
+            d["accepted"] = s.accepted;
+            d["rejected"] = s.rejected;
+            d["messages"] = s.messages;
+            d["ticks"] = s.ticks;
+            d["bytes"] = s.bytes;
+            d["conflated"] = s.conflated;
+            return d;
+        })
+        .def_property_readonly("port", [](PyWsFanoutServer& self) { return self.server().port(); })
+        .def_property_readonly("running", [](PyWsFanoutServer& self) { return self.server().running(); })
+        .def_property_readonly("capacity", [](PyWsFanoutServer& self) { return self.table().capacity(); });
+}
+
+}  // namespace bindings
+}  // namespace fq
@@ -0,0 +1,504 @@
+/**
+ * alloc_check.cpp: 热路径零分配检查 / 微基准（ctest: hot_path_allocations）
+ *
+ * 每个用例先预热（首次登记合约、时区初始化、通道缓存等允许分配），再在 AllocScope 内
+ * 重复执行热路径；期间任何 operator new 或 malloc 都判为失败。输出每用例的 ns/op，
+ * 兼作回归基准。用法：fq_alloc_check [迭代次数]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fq/adaptive_batcher.hpp"
+#include "fq/alert_engine.hpp"
+#include "fq/backtest.hpp"
+#include "fq/cross_section.hpp"
+#include "fq/csv_encoder.hpp"
+#include "fq/alloc_tracker.hpp"
+#include "fq/decoders.hpp"
+#include "fq/ewm_covariance.hpp"
+#include "fq/feature_tensor.hpp"
+#include "fq/hot_standby.hpp"
+#include "fq/packed_tick.hpp"
+#include "fq/priority_lanes.hpp"
+#include "fq/reorder_buffer.hpp"
+#include "fq/sharded_pool.hpp"
+#include "fq/soft_nic.hpp"
+#include "fq/spsc_ring.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick_batch.hpp"
+#include "fq/tick_writer.hpp"
+#include "fq/trade_inference.hpp"
+#include "fq/udp_publisher.hpp"
+#include "fq/wait_strategy.hpp"
+#include "fq/ws_fanout.hpp"
+
+namespace {
+
+constexpr size_t kSymbols = 64;
+constexpr size_t kWarmup = 1000;
+
+struct Case {
+    const char* name;
+    std::function<void(size_t)> body;  ///< 参数为迭代序号
+};
+
+std::vector<std::string> make_symbols() {
+    std::vector<std::string> out;
+    const char* products[] = {"rb", "au", "lc", "si", "m", "y", "SR", "CF"};
+    for (size_t i = 0; i < kSymbols; ++i) out.push_back(std::string(products[i % 8]) + std::to_string(2501 + i));
+    return out;
+}
+
+std::vector<std::vector<char>> make_gfex_frames(const std::vector<std::string>& symbols) {
+    std::vector<std::vector<char>> frames;
+    for (const std::string& s : symbols) {
+        fq::NanoGfexL2MdType md;
+        std::memset(&md, 0, sizeof(md));
+        std::memcpy(md.contract_name, s.data(), std::min(s.size(), sizeof(md.contract_name)));
+        std::memcpy(md.gen_time, "09:30:01.500", 12);
+        md.last_price = 100.0;
+        md.match_total_qty = 10;
+        const char* p = reinterpret_cast<const char*>(&md);
+        frames.emplace_back(p, p + sizeof(md));
+    }
+    return frames;
+}
+
+template <typename Q>
+std::vector<std::vector<char>> make_frames(const std::vector<std::string>& symbols, char (Q::*field)[sizeof(Q::Symbol)]) {
+    std::vector<std::vector<char>> frames;
+    for (const std::string& s : symbols) {
+        Q q;
+        std::memset(&q, 0, sizeof(q));
+        std::memcpy(q.*field, s.data(), s.size());
+        q.LastPrice = 1;
+        const char* p = reinterpret_cast<const char*>(&q);
+        frames.emplace_back(p, p + sizeof(q));
+    }
+    return frames;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t iters = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 200000;
+    if (!fq::alloc_tracking_enabled()) {
+        std::fprintf(stderr, "alloc hook not linked\n");
+        return 2;
+    }
+    // 自检：钩子确实在计数，避免空转通过
+    {
+        fq::AllocScope scope;
+        // 经 volatile 指针调用，防止编译器消除成对的分配/释放
+        void* (*volatile do_malloc)(size_t) = std::malloc;
+        void (*volatile do_free)(void*) = std::free;
+        int* volatile s = new int(1);
+        delete s;
+        do_free(do_malloc(16));
+        if (scope.allocations() != 2) {
+            std::fprintf(stderr, "alloc hook not counting (got %llu, want 2)\n",
+                         static_cast<unsigned long long>(scope.allocations()));
+            return 2;
+        }
+    }
+
+    const std::vector<std::string> symbols = make_symbols();
+    const auto gfex = make_gfex_frames(symbols);
+    const auto dce = make_frames<fq::DCEL1Quotation>(symbols, &fq::DCEL1Quotation::Symbol);
+    const auto czce = make_frames<fq::CZCEL2Quotation>(symbols, &fq::CZCEL2Quotation::Symbol);
+
+    fq::SymbolTable table(1024);
+    fq::TickBatch batch(4096), spare(4096);
+    fq::AdaptiveBatcher batcher;
+    fq::LaneMap lanes(1, &table);
+    lanes.add_product("rb", 0);
+    fq::LaneScheduler scheduler({4, 1}, false);
+    size_t backlog[2] = {0, 0}, take[2] = {0, 0};
+    fq::SpscRing<fq::Tick> ring(1024);
+    fq::SpscRing<fq::PackedTick> packed_ring(1024);
+    fq::WaitConfig spin_cfg;
+    spin_cfg.mode = fq::WaitMode::kBusySpin;
+    spin_cfg.max_pause = 4;
+    fq::WaitStrategy spin(spin_cfg);
+    // 回测：kSymbols 条各 256 帧的行情序列，归并回放并撮合
+    std::vector<std::vector<fq::Tick>> day(kSymbols);
+    std::vector<fq::TickSpan> spans;
+    for (size_t s = 0; s < kSymbols; ++s) {
+        for (size_t k = 0; k < 256; ++k) {
+            fq::Tick t{};
+            t.instrument_id = static_cast<int32_t>(s);
+            t.trade_date = 20250129;
+            t.time_us = static_cast<int64_t>(k * 500000 + s);
+            t.volume = static_cast<int64_t>(k) * 4;
+            t.last_price = 100.0 + static_cast<double>(k % 3);
+            t.bid_price_1 = 100.0;
+            t.bid_volume_1 = 10;
+            t.ask_price_1 = 101.0;
+            t.ask_volume_1 = 10;
+            day[s].push_back(t);
+        }
+        spans.push_back(fq::TickSpan{day[s].data(), day[s].size()});
+    }
+    fq::TickMerger merger(spans);
+    fq::SimConfig sim_cfg;
+    sim_cfg.latency_us = 1000;
+    fq::FillSimulator sim(sim_cfg, 1024);
+    fq::SimFill sim_fills[16];
+    // 回测主循环：4 个合约各取前 16 条共 64 条，16 条一批回调，每批按最后一条挂一笔限价单
+    std::vector<fq::TickSpan> loop_spans;
+    // 第二条序列带 ID 映射（同 .fqt 文件内合约下标），走回放时改写 instrument_id 的路径
+    const int32_t loop_ids[kSymbols] = {0, 5};
+    for (size_t s = 0; s < 4; ++s) loop_spans.push_back(fq::TickSpan{day[s].data(), 16});
+    loop_spans[1].ids = loop_ids;
+    loop_spans[1].id_count = kSymbols;
+    fq::TickMerger loop_merger(loop_spans);
+    fq::FillSimulator loop_sim(sim_cfg, 1024);
+    fq::BacktestLoop loop(loop_sim, 1024);
+    fq::TickBatch loop_batch(16);
+    size_t loop_fills = 0;
+
+    // 每条行情推进 1ms，500ms 网格约每 500 条快照一次，块满后清空复用
+    fq::CrossSection cross(kSymbols, 64, 500000, 60000000);
+    int64_t cross_clock = 0;
+    // 500 合约轮转，每条推进 1ms，500ms 网格即每 500 条做一次全矩阵秩 1 更新
+    fq::EwmCovariance ewm(500, 500000, fq::ewm_alpha_from_halflife(120), 60000000);
+    int64_t ewm_clock = 0;
+    // 特征张量：11 列（含 3 个收益周期）逐条写入共享内存环
+    const std::vector<std::string> feature_names = {"mid_price", "spread", "imbalance", "bid_volume_1",
+                                                    "ask_volume_1", "volume_delta", "return:1", "return:10",
+                                                    "return:60", "time_of_day", "session_elapsed"};
+    std::vector<fq::FeatureSpec> feature_specs(feature_names.size());
+    for (size_t f = 0; f < feature_names.size(); ++f)
+        if (!fq::parse_feature(feature_names[f], feature_specs[f])) std::abort();
+    fq::FeatureTensorWriter features(feature_specs, kSymbols, 512, 600000000);
+    if (!features.open("/fq_alloc_check_feat_" + std::to_string(::getpid()), feature_names, 4096)) std::abort();
+    features.tensor().unlink();
+    // 1000 条规则，交替为“价差 > 阈值 for 2ms”与“|last - ago(last, 1ms)| > 阈值 and imbalance > 0”
+    fq::AlertProgram alert_program;
+    alert_program.history.push_back({fq::kAlertLast, 1000});
+    for (uint32_t r = 0; r < 1000; ++r) {
+        auto emit = [&](uint8_t op, int32_t arg) {
+            alert_program.ops.push_back(op);
+            alert_program.args.push_back(arg);
+        };
+        const uint32_t begin = static_cast<uint32_t>(alert_program.ops.size());
+        alert_program.consts.push_back(0.5 + static_cast<double>(r % 8));
+        const int32_t c = static_cast<int32_t>(alert_program.consts.size() - 1);
+        if (r % 2 == 0) {
+            emit(fq::kOpField, fq::kAlertSpread), emit(fq::kOpConst, c), emit(fq::kOpGt, 0);
+        } else {
+            emit(fq::kOpField, fq::kAlertLast), emit(fq::kOpAsOf, 0), emit(fq::kOpSub, 0), emit(fq::kOpAbs, 0);
+            emit(fq::kOpConst, c), emit(fq::kOpGt, 0);
+            emit(fq::kOpField, fq::kAlertImbalance), emit(fq::kOpConst, 0), emit(fq::kOpGt, 0), emit(fq::kOpAnd, 0);
+        }
+        const uint32_t end = static_cast<uint32_t>(alert_program.ops.size());
+        alert_program.rules.push_back({begin, end, begin, end, r % 2 == 0 ? 2000 : 0, 0, {}});
+    }
+    fq::AlertEngine alerts(std::move(alert_program), kSymbols, 64);
+    std::vector<fq::AlertEvent> alert_events(alerts.rules());
+    fq::SnapshotTable snapshots(kSymbols);
+    uint64_t alert_fired = 0;
+    fq::ReorderBuffer<fq::Tick> reorder(1000, 4096, kSymbols);
+    uint64_t reorder_out = 0;
+    size_t reorder_clock = 0;
+    auto reorder_sink = [&](fq::Tick&) { ++reorder_out; };
+    // 热备镜像：每条登记一次（槽位已按合约缓存），备进程侧一致读取
+    fq::StandbyRegion standby;
+    const std::string standby_name = "/fq_alloc_check_" + std::to_string(::getpid());
+    if (!standby.open(standby_name, 256)) std::abort();
+    standby.unlink();
+    std::vector<int32_t> standby_slots;
+    for (const std::string& s : symbols) {
+        fq::SymbolKey key{};
+        if (!fq::normalize_symbol(s.data(), s.size(), key)) std::abort();
+        standby_slots.push_back(standby.find_slot(key, true));
+    }
+
+    // TX 发布：逐条成帧写入软件帧环并记录发送时间戳，接收端解码后取走时间戳
+    fq::SoftFrameRing tx_ring(1024);
+    fq::UdpEndpoint tx_ep{};
+    tx_ep.dst_ip = 0xef010101;
+    tx_ep.dst_port = 30001;
+    tx_ep.src_port = 30001;
+    fq::UdpTickPublisher tx_pub(tx_ring.tx_ops(), tx_ep);
+    std::vector<int32_t> tx_ids;
+    for (const std::string& s : symbols) tx_ids.push_back(fq::global_symbol_table().intern(s.data(), s.size()));
+    char tx_frame[fq::SoftFrameRing::kMaxFrame];
+    uint64_t tx_decoded = 0;
+
+    // 每 256 行一批，文件缓冲批间复用容量
+    fq::CsvFileBuffers csv_files("data/market_data");
+    fq::IsoDateTimeFormatter csv_iso;
+
+    fq::TradeInference trades(1024);
+    fq::InferredTrade trade{};
+    uint64_t handled[2] = {0, 0};
+    fq::ShardedPool<std::pair<int32_t, uint32_t>> pool(
+        2, 4096, [&](size_t shard, std::pair<int32_t, uint32_t>& item) { handled[shard] += item.second; });
+    // 分片落盘：去重 + 编码在本线程执行，每 256 条写出一次到临时目录
+    char writer_dir[] = "/tmp/fq_alloc_check_XXXXXX";
+    if (!::mkdtemp(writer_dir)) std::abort();
+    fq::TickDedup writer_dedup(512);
+    fq::CsvTickWriter writer(writer_dir, fq::global_symbol_table());
+    size_t writer_rows = 0, writer_calls = 0;
+
+    auto decode_into_batch = [&](const std::vector<std::vector<char>>& frames, size_t i,
+                                 bool (*decode)(const char*, size_t, fq::SymbolTable&, fq::Tick&)) {
+        const std::vector<char>& f = frames[i % kSymbols];
+        fq::Tick* t = batch.emplace();
+        if (!t) {
+            batch.swap(spare);
+            batch.clear();
+            t = batch.emplace();
+        }
+        if (!decode(f.data(), f.size(), table, *t)) batch.pop_back();
+    };
+
+    std::vector<Case> cases = {
+        {"symbol_table.intern", [&](size_t i) {
+             const std::string& s = symbols[i % kSymbols];
+             if (table.intern(s.data(), s.size()) == fq::kInvalidInstrument) std::abort();
+         }},
+        {"decode_gfex_l2", [&](size_t i) { decode_into_batch(gfex, i, fq::decode_gfex_l2); }},
+        {"decode_dce_l1", [&](size_t i) { decode_into_batch(dce, i, fq::decode_dce_l1); }},
+        {"decode_czce_l1", [&](size_t i) { decode_into_batch(czce, i, fq::decode_czce_l1); }},
+        {"adaptive_batcher", [&](size_t i) {
+             const double now = static_cast<double>(i) * 1e-4;
+             batcher.observe(8, now);
+             if (batcher.should_flush(8, now - 1e-3, now)) batcher.on_flush(8, now - 1e-3, now);
+         }},
+        {"priority_lanes", [&](size_t i) {
+             ++backlog[lanes.lane_of(static_cast<int32_t>(i % kSymbols))];
+             const size_t n = scheduler.plan(backlog, take, 64);
+             backlog[0] -= take[0];
+             backlog[1] -= take[1];
+             (void)n;
+         }},
+        {"spsc_ring", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             if (!ring.try_push(t) || !ring.try_pop(t)) std::abort();
+         }},
+        {"spsc_ring.packed_tick", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             t.time_us = static_cast<int64_t>(i);
+             t.last_price = 3500.0 + static_cast<double>(i % 7);
+             t.volume = static_cast<int64_t>(i);
+             fq::PackedTick p;
+             fq::pack_tick(t, static_cast<int64_t>(i), p);
+             if (!packed_ring.try_push(p) || !packed_ring.try_pop(p)) std::abort();
+             fq::Tick out;
+             fq::unpack_tick(p, nullptr, out);
+             if (out.time_us != t.time_us || out.last_price != t.last_price) std::abort();
+         }},
+        {"wait_strategy.busy_spin", [&](size_t i) {
+             if (i % 8 == 0) spin.reset();
+             spin.idle();
+         }},
+        {"trade_inference", [&](size_t i) {
+             fq::Snapshot s{};
+             s.instrument_id = static_cast<int32_t>(i % kSymbols);
+             s.trade_date = 20250129;
+             s.volume = static_cast<int64_t>(i / kSymbols) * 2;
+             s.turnover = static_cast<double>(s.volume) * 1000.0;
+             s.last_price = 100.0;
+             s.bid_price_1 = 99.0;
+             s.ask_price_1 = 101.0;
+             trades.on_snapshot(s, trade);
+         }},
+        {"backtest.merge_fill", [&](size_t i) {
+             const fq::Tick* t = merger.next();
+             if (!t) {
+                 merger.reset();
+                 t = merger.next();
+             }
+             if (i % 64 == 0 && sim.live_orders() < 512)
+                 sim.submit(t->instrument_id, (i & 64) ? 1 : -1, (i & 64) ? 100.0 : 101.0, 2, fq::sim_time(*t));
+             sim.on_tick(*t, sim_fills, 16);
+         }},
+        {"backtest.loop/64", [&](size_t) {
+             loop_merger.reset();
+             loop.run(
+                 loop_merger, loop_batch, [&](const fq::SimFill&) { ++loop_fills; },
+                 [&](fq::TickBatch& b, int64_t now) {
+                     const fq::Tick& t = b[b.size() - 1];
+                     if (loop_sim.live_orders() < 16)
+                         loop_sim.submit(t.instrument_id, (now & 1) ? 1 : -1, t.last_price, 2, now);
+                 });
+         }},
+        {"cross_section", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             t.time_us = (cross_clock += 1000);
+             t.last_price = 100.0 + static_cast<double>(i % 7);
+             if (!cross.on_tick(t)) {
+                 cross.clear();
+                 cross.on_tick(t);
+             }
+         }},
+        {"ewm_covariance", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % 500);
+             t.trade_date = 20250129;
+             t.time_us = (ewm_clock += 1000);
+             t.last_price = 100.0 + static_cast<double>((i * 7 + i / 500) % 13) * 0.1;
+             ewm.on_tick(t);
+         }},
+        {"feature_tensor", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             t.time_us = 34200000000LL + static_cast<int64_t>(i) * 1000;
+             t.last_price = 100.0;
+             t.bid_price_1 = 100.0 + static_cast<double>(i / kSymbols % 5);
+             t.ask_price_1 = t.bid_price_1 + 1.0;
+             t.bid_volume_1 = static_cast<int64_t>(i % 7);
+             t.ask_volume_1 = 3;
+             t.volume = static_cast<int64_t>(i);
+             if (!features.on_tick(t)) std::abort();
+         }},
+        {"alert_engine_1000", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             t.time_us = 34200000000LL + static_cast<int64_t>(i) * 100;
+             t.last_price = 100.0 + static_cast<double>(i / kSymbols % 11);
+             t.bid_price_1 = 100.0;
+             t.ask_price_1 = t.bid_price_1 + static_cast<double>(i / kSymbols % 9);
+             t.bid_volume_1 = static_cast<int64_t>(i % 7);
+             t.ask_volume_1 = 3;
+             t.volume = static_cast<int64_t>(i);
+             alert_fired += alerts.on_tick(t, alert_events.data(), alert_events.size());
+         }},
+        {"snapshot_table.publish", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             t.time_us = 34200000000LL + static_cast<int64_t>(i) * 100;
+             t.last_price = 100.0 + static_cast<double>(i % 11);
+             snapshots.publish(t);
+         }},
+        {"csv_encoder", [&](size_t i) {
+             if (i % 256 == 0) csv_files.begin_batch();
+             const std::string& s = symbols[i % 16];
+             fq::CsvFileBuffers::File& f = csv_files.file(s.data(), s.size(), 20250129);
+             std::string& o = f.body;
+             fq::csv_append_text(o, s.data(), s.size());
+             o.append(",SHFE,");
+             fq::csv_append_float(o, 3500.0 + static_cast<double>(i % 100) * 0.5);
+             o.push_back(',');
+             fq::csv_append_int(o, static_cast<int64_t>(i));
+             o.push_back(',');
+             csv_iso.append(o, 2025, 1, 29, 9, 30, static_cast<int>(i / 1000 % 60), static_cast<int>(i % 1000) * 500);
+             o.append("\r\n");
+             ++f.rows;
+         }},
+        {"reorder_buffer", [&](size_t) {
+             // 每个合约每 8 条中交换相邻两条的到达顺序；逻辑时钟每条前进 10us，持有 1ms
+             const size_t i = reorder_clock++;
+             fq::Tick t{};
+             t.instrument_id = static_cast<int32_t>(i % kSymbols);
+             t.trade_date = 20250129;
+             const size_t n = i / kSymbols;
+             const size_t seq = n % 8 == 4 ? n + 1 : (n % 8 == 5 ? n - 1 : n);
+             t.time_us = static_cast<int64_t>(seq) * 1000;
+             t.volume = static_cast<int64_t>(seq);
+             const int64_t now = static_cast<int64_t>(i) * 10;
+             reorder.push(t.instrument_id, fq::ReorderKey{fq::sim_time(t), t.volume}, t, now, reorder_sink);
+             reorder.poll(now, reorder_sink);
+         }},
+        {"hot_standby.publish", [&](size_t i) {
+             fq::Tick t{};
+             t.trade_date = 20250129;
+             t.time_us = static_cast<int64_t>(i);
+             t.volume = static_cast<int64_t>(i);
+             const int32_t slot = standby_slots[i % kSymbols];
+             standby.publish(slot, t);
+             standby.advance_journal(1);
+             fq::Tick mirrored;
+             if (!standby.read(slot, mirrored) || mirrored.volume != t.volume) std::abort();
+         }},
+        {"udp_publisher.publish", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = tx_ids[i % kSymbols];
+             t.trade_date = 20250129;
+             t.time_us = static_cast<int64_t>(i);
+             t.volume = static_cast<int64_t>(i);
+             t.last_price = 100.0;
+             if (tx_pub.publish(&t, 1) != 1) std::abort();
+             const int64_t n = tx_ring.receive(tx_frame, sizeof(tx_frame));
+             if (n <= 0) std::abort();
+             fq::decode_tick_frame(tx_frame, static_cast<size_t>(n), 30001, [&](const fq::WireTick& w) {
+                 if (w.volume == t.volume) ++tx_decoded;
+             });
+             fq::TxStamp stamp;
+             if (!tx_pub.pop_stamp(stamp) || stamp.seq != tx_pub.seq()) std::abort();
+         }},
+        {"sharded_pool.submit", [&](size_t i) {
+             const int32_t iid = static_cast<int32_t>(i % kSymbols);
+             pool.submit(fq::shard_of(iid, pool.workers()), {iid, 1});
+             if (i % 1024 == 1023) pool.flush();
+         }},
+        {"tick_writer.dedup_encode", [&](size_t i) {
+             fq::Tick t{};
+             t.instrument_id = tx_ids[i % kSymbols];
+             t.exchange = fq::Exchange::kSHFE;
+             t.trade_date = 20250129;
+             t.time_us = 32400000000LL + static_cast<int64_t>(i / 2);  // 每两条重复一次
+             t.last_price = 3500.0 + static_cast<double>(i % 7) * 0.5;
+             t.volume = static_cast<int64_t>(i);
+             if (writer_dedup.insert(t.instrument_id, t.trade_date, t.time_us)) {
+                 writer.append(t);
+                 ++writer_rows;
+             }
+             if (++writer_calls % 256 == 0) {
+                 writer_dedup.end_batch();
+                 if (writer.flush() != 0) std::abort();
+             }
+         }},
+    };
+
+    // 预热：首次登记合约、localtime 时区加载、通道缓存扩容等
+    for (Case& c : cases)
+        for (size_t i = 0; i < kWarmup; ++i) c.body(i);
+    pool.flush();
+
+    int failures = 0;
+    for (Case& c : cases) {
+        fq::AllocScope scope;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iters; ++i) c.body(i);
+        const auto t1 = std::chrono::steady_clock::now();
+        const uint64_t allocs = scope.allocations();
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(iters);
+        std::printf("%-26s %8.1f ns/op  allocs=%llu bytes=%llu  %s\n", c.name, ns,
+                    static_cast<unsigned long long>(allocs), static_cast<unsigned long long>(scope.bytes()),
+                    allocs == 0 ? "OK" : "FAIL");
+        if (allocs != 0) ++failures;
+    }
+    pool.flush();
+    pool.stop();
+    if (handled[0] + handled[1] == 0) std::abort();
+    writer.flush();
+    for (const std::string& s : symbols) ::unlink((std::string(writer_dir) + "/" + s + "_20250129.csv").c_str());
+    ::rmdir(writer_dir);
+    if (writer_rows == 0) std::abort();
+    if (reorder_out == 0 || reorder.stats().late != 0 || reorder.stats().reordered == 0) std::abort();
+    if (alert_fired == 0 || alerts.overflow() != 0) std::abort();
+    if (ewm.steps() == 0 || !(ewm.corr(0, 1) == ewm.corr(0, 1))) std::abort();
+    if (tx_decoded != tx_pub.stats().ticks || tx_pub.stats().unstamped != 0) std::abort();
+    if (failures) {
+        std::fprintf(stderr, "%d hot path(s) allocated after warm-up\n", failures);
+        return 1;
+    }
+    return 0;
+}
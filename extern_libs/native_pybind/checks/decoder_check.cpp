@@ -0,0 +1,125 @@
+/**
+ * decoder_check.cpp: 原始帧解码一致性检查（ctest: decoder_golden）
+ *
+ * 黄金文件 tests/data/tick_decoders.golden 由纯 Python 解析器生成（tests/test_tick_view.py，
+ * pytest 同时断言文件与当前解析器一致）。这里用原生解码器解码同一批原始帧并逐字段比较，
+ * 浮点按位相等；Python 侧解码失败的帧原生侧也必须拒绝。用法：fq_decoder_check <黄金文件>
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fq/decoders.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace {
+
+using Decoder = bool (*)(const char*, size_t, fq::SymbolTable&, fq::Tick&);
+
+Decoder decoder_for(const std::string& kind) {
+    if (kind == "gfex_l2") return &fq::decode_gfex_l2;
+    if (kind == "dce_l1") return &fq::decode_dce_l1;
+    if (kind == "czce_l1") return &fq::decode_czce_l1;
+    return nullptr;
+}
+
+bool unhex(const std::string& hex, std::vector<char>& out) {
+    if (hex.size() % 2) return false;
+    out.resize(hex.size() / 2);
+    for (size_t i = 0; i < out.size(); ++i) {
+        char* end = nullptr;
+        const std::string byte = hex.substr(i * 2, 2);
+        out[i] = static_cast<char>(std::strtoul(byte.c_str(), &end, 16));
+        if (*end != '\0') return false;
+    }
+    return true;
+}
+
+/// 比较一行黄金记录与原生解码结果，返回首个不一致的字段名（一致时返回 nullptr）
+const char* compare(std::istringstream& expected, const fq::Tick& t, const fq::SymbolTable& symbols) {
+    std::string symbol, date, time_us;
+    expected >> symbol >> date >> time_us;
+    if (symbol != std::string(symbols.name(t.instrument_id), symbols.name_len(t.instrument_id))) return "symbol";
+    if (date != "-" && std::strtoul(date.c_str(), nullptr, 10) != t.trade_date) return "trade_date";
+    if (std::strtoll(time_us.c_str(), nullptr, 10) != t.time_us) return "time_us";
+    struct Field {
+        const char* name;
+        const double* real;
+        const int64_t* integer;
+    };
+    const Field fields[] = {
+        {"last_price", &t.last_price, nullptr},       {"volume", nullptr, &t.volume},
+        {"turnover", &t.turnover, nullptr},           {"open_interest", &t.open_interest, nullptr},
+        {"bid_price_1", &t.bid_price_1, nullptr},     {"bid_volume_1", nullptr, &t.bid_volume_1},
+        {"ask_price_1", &t.ask_price_1, nullptr},     {"ask_volume_1", nullptr, &t.ask_volume_1},
+        {"open_price", &t.open_price, nullptr},       {"high_price", &t.high_price, nullptr},
+        {"low_price", &t.low_price, nullptr},         {"pre_close", &t.pre_close, nullptr},
+        {"pre_settlement", &t.pre_settlement, nullptr},
+    };
+    for (const Field& f : fields) {
+        std::string text;
+        if (!(expected >> text)) return f.name;
+        if (f.real && std::strtod(text.c_str(), nullptr) != *f.real) return f.name;
+        if (f.integer && std::strtoll(text.c_str(), nullptr, 10) != *f.integer) return f.name;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <tick_decoders.golden>\n", argv[0]);
+        return 2;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 2;
+    }
+    fq::SymbolTable symbols(1024);
+    size_t checked = 0, failed = 0, lineno = 0;
+    std::vector<char> raw;
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lineno;
+        if (line.empty()) continue;
+        std::istringstream expected(line);
+        std::string kind, hex, status;
+        expected >> kind >> hex >> status;
+        const Decoder decode = decoder_for(kind);
+        if (!decode || !unhex(hex, raw)) {
+            std::printf("FAIL line %zu: malformed record\n", lineno);
+            ++failed;
+            continue;
+        }
+        ++checked;
+        fq::Tick t{};
+        const bool ok = decode(raw.data(), raw.size(), symbols, t);
+        const char* mismatch = nullptr;
+        if (status == "rejected") {
+            if (ok) mismatch = "accepted";
+        } else if (!ok) {
+            mismatch = "rejected";
+        } else {
+            std::istringstream fields(line);
+            fields >> kind >> hex;
+            mismatch = compare(fields, t, symbols);
+        }
+        if (mismatch) {
+            std::printf("FAIL line %zu (%s): %s differs from Python parser\n", lineno, kind.c_str(), mismatch);
+            ++failed;
+        }
+    }
+    if (checked == 0) {
+        std::printf("FAIL: no records in %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("%zu frames checked, %zu mismatches\n", checked, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * fq/adaptive_batcher.hpp: 自适应攒批控制器
+ *
+ * 根据观测到的到达速率决定批大小与刷新截止时间：
+ * - 速率低于 idle_rate 时视为空闲，有数据即刷新（最低延迟）
+ * - 繁忙时目标批大小 = rate * max_latency（上限 max_batch），最早一条等待不超过 max_latency
+ * 到达速率为按时间衰减的 EWMA（时间常数 rate_window），与轮询频率无关。
+ * 时间单位统一为秒（单调时钟），控制器本身不取时钟，由调用方传入 now。
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace fq {
+
+struct AdaptiveBatcherConfig {
+    double max_latency = 0.02;          ///< 攒批延迟预算（秒）
+    size_t max_batch = 4096;            ///< 单批上限
+    double min_poll_interval = 0.0005;  ///< 繁忙时最短轮询间隔（秒）
+    double max_poll_interval = 0.005;   ///< 空闲时轮询间隔（秒）
+    double idle_rate = 200.0;           ///< 低于该到达速率（条/秒）视为空闲
+    double rate_window = 0.5;           ///< 速率 EWMA 时间常数（秒）
+};
+
+struct AdaptiveBatcherMetrics {
+    double arrival_rate = 0.0;  ///< 当前到达速率估计（条/秒）
+    size_t target_batch = 1;    ///< 当前目标批大小
+    bool batching = false;      ///< 是否处于攒批（繁忙）状态
+    uint64_t flushes = 0;
+    uint64_t flushed = 0;       ///< 累计刷新条数
+    size_t last_batch = 0;
+    double last_delay = 0.0;    ///< 最近一批最早一条的等待时间（秒）
+    double max_delay = 0.0;
+};
+
+class AdaptiveBatcher {
+public:
+    explicit AdaptiveBatcher(const AdaptiveBatcherConfig& config = AdaptiveBatcherConfig())
+        : cfg_(config), last_observe_(-1.0) {
+        cfg_.max_batch = std::max<size_t>(1, cfg_.max_batch);
+        cfg_.min_poll_interval = std::max(0.0, cfg_.min_poll_interval);
+        cfg_.max_poll_interval = std::max(cfg_.min_poll_interval, cfg_.max_poll_interval);
+        cfg_.rate_window = std::max(1e-6, cfg_.rate_window);
+    }
+
+    /// 记录一次轮询收到的条数
+    void observe(size_t n, double now) {
+        if (last_observe_ < 0.0) {
+            last_observe_ = now;
+            pending_arrivals_ = n;
+            return;
+        }
+        pending_arrivals_ += n;
+        const double dt = now - last_observe_;
+        if (dt <= 0.0) return;  // 同一时刻的多次观测累加到下一次
+        const double a = 1.0 - std::exp(-dt / cfg_.rate_window);
+        m_.arrival_rate += a * (static_cast<double>(pending_arrivals_) / dt - m_.arrival_rate);
+        pending_arrivals_ = 0;
+        last_observe_ = now;
+        update_target();
+    }
+
+    /// 当前积压 pending 条、最早一条到达于 oldest 时是否应刷新
+    bool should_flush(size_t pending, double oldest, double now) const {
+        if (pending == 0) return false;
+        if (pending >= m_.target_batch || pending >= cfg_.max_batch) return true;
+        return now - oldest >= cfg_.max_latency;
+    }
+
+    /// 距下一次轮询应等待的时间（秒）
+    double next_poll_interval(size_t pending, double oldest, double now) const {
+        if (pending == 0)
+            return m_.batching ? cfg_.min_poll_interval : cfg_.max_poll_interval;
+        const double remaining = oldest + cfg_.max_latency - now;
+        return std::min(cfg_.max_poll_interval, std::max(cfg_.min_poll_interval, remaining));
+    }
+
+    /// 记录一次刷新
+    void on_flush(size_t n, double oldest, double now) {
+        const double delay = std::max(0.0, now - oldest);
+        ++m_.flushes;
+        m_.flushed += n;
+        m_.last_batch = n;
+        m_.last_delay = delay;
+        m_.max_delay = std::max(m_.max_delay, delay);
+    }
+
+    const AdaptiveBatcherMetrics& metrics() const { return m_; }
+    const AdaptiveBatcherConfig& config() const { return cfg_; }
+
+private:
+    void update_target() {
+        m_.batching = m_.arrival_rate >= cfg_.idle_rate;
+        if (!m_.batching) {
+            m_.target_batch = 1;
+            return;
+        }
+        const double target = m_.arrival_rate * cfg_.max_latency;
+        m_.target_batch = static_cast<size_t>(
+            std::min(static_cast<double>(cfg_.max_batch), std::max(1.0, std::floor(target))));
+    }
+
+    AdaptiveBatcherConfig cfg_;
+    AdaptiveBatcherMetrics m_;
+    double last_observe_;
+    size_t pending_arrivals_ = 0;
+};
+
+}  // namespace fq
@@ -0,0 +1,428 @@
+/**
+ * fq/alert_engine.hpp: 编译后的行情告警规则求值（扁平字节码栈式虚拟机）
+ *
+ * 规则表达式在配置加载时由 src/processor/alerts.py 编译为扁平字节码（op + 参数），全部规则共用一段代码区：
+ *   - 每条规则一段条件代码 [cond_begin, cond_end) 与可选的取值代码 [value_begin, value_end)（事件中的 value）
+ *   - 操作数为 double，比较与逻辑运算结果为 1/0；NaN 参与比较为假，条件以“非 0 且非 NaN”为真
+ *   - kAsOf 读取本合约 horizon 之前的 as-of 字段值（历史槽位，见 AlertHistorySlot），缺失为 NaN
+ * 每条行情先算一次字段向量与全部历史槽位，再依次执行作用于本合约的规则（全局规则 + 按合约登记的规则），
+ * 单条规则只是几条指令的 switch 循环；最常见的“字段 比较 常量”形式在构造时识别为直接比较，不经解释循环。
+ * 条件须连续成立 hold（行情时间）后触发一次事件，条件转假后重新计时；两次触发间隔不少于 cooldown。
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fq/backtest.hpp"
+#include "fq/spsc_ring.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+/// 规则可引用的字段（顺序与 src/processor/alerts.py FIELDS 一致）
+enum AlertField : uint8_t {
+    kAlertLast = 0,
+    kAlertVolume,
+    kAlertTurnover,
+    kAlertOpenInterest,
+    kAlertBid,
+    kAlertBidVolume,
+    kAlertAsk,
+    kAlertAskVolume,
+    kAlertOpen,
+    kAlertHigh,
+    kAlertLow,
+    kAlertPreClose,
+    kAlertPreSettlement,
+    kAlertMid,
+    kAlertSpread,
+    kAlertImbalance,
+    kAlertVolumeDelta,
+    kAlertTimeOfDay,
+    kAlertFieldCount,
+};
+
+enum AlertOp : uint8_t {
+    kOpConst = 0,  ///< 参数：常量下标
+    kOpField,      ///< 参数：AlertField
+    kOpAsOf,       ///< 参数：历史槽位
+    kOpAdd,
+    kOpSub,
+    kOpMul,
+    kOpDiv,
+    kOpNeg,
+    kOpAbs,
+    kOpMin,
+    kOpMax,
+    kOpLt,
+    kOpLe,
+    kOpGt,
+    kOpGe,
+    kOpEq,
+    kOpNe,
+    kOpAnd,
+    kOpOr,
+    kOpNot,
+    kOpCount,
+};
+
+struct AlertHistorySlot {
+    uint8_t field;
+    int64_t horizon_us;
+};
+
+struct AlertRule {
+    uint32_t cond_begin, cond_end;
+    uint32_t value_begin, value_end;  ///< 相等时事件 value 为 NaN
+    int64_t hold_us;
+    int64_t cooldown_us;
+    std::vector<int32_t> scope;       ///< 空为全部合约
+};
+
+struct AlertProgram {
+    std::vector<uint8_t> ops;
+    std::vector<int32_t> args;
+    std::vector<double> consts;
+    std::vector<AlertRule> rules;
+    std::vector<AlertHistorySlot> history;
+};
+
+struct AlertEvent {
+    uint32_t rule;
+    int32_t instrument_id;
+    int64_t time;  ///< sim_time
+    double value;
+};
+
+class AlertEngine {
+public:
+    /// 虚拟机栈深上限（编译器保证不超过）
+    static constexpr size_t kMaxStack = 64;
+
+    /**
+     * @param instruments 合约数（instrument_id 上限）
+     * @param history 每合约保留的历史条数（as-of 需覆盖的最长 horizon）
+     * @throws std::invalid_argument 字节码越界或栈深超限
+     */
+    AlertEngine(AlertProgram program, size_t instruments, size_t history)
+        : p_(std::move(program)),
+          instruments_(instruments == 0 ? 1 : instruments),
+          history_(next_pow2(history < 2 ? 2 : history)),
+          by_instrument_(instruments_) {
+        validate();
+        hot_.resize(p_.rules.size());
+        for (size_t r = 0; r < p_.rules.size(); ++r) {
+            const AlertRule& rule = p_.rules[r];
+            Hot& h = hot_[r];
+            h.cond_begin = rule.cond_begin;
+            h.cond_end = rule.cond_end;
+            h.hold_us = rule.hold_us;
+            h.cooldown_us = rule.cooldown_us;
+            const uint32_t b = rule.cond_begin;
+            if (rule.cond_end - b == 3 && p_.ops[b] == kOpField && p_.ops[b + 1] == kOpConst &&
+                p_.ops[b + 2] >= kOpLt && p_.ops[b + 2] <= kOpNe) {
+                h.op = p_.ops[b + 2];
+                h.field = static_cast<uint8_t>(p_.args[b]);
+                h.threshold = p_.consts[static_cast<size_t>(p_.args[b + 1])];
+            }
+        }
+        for (uint32_t r = 0; r < p_.rules.size(); ++r) {
+            if (p_.rules[r].scope.empty()) {
+                global_.push_back(r);
+                continue;
+            }
+            for (int32_t iid : p_.rules[r].scope)
+                if (iid >= 0 && static_cast<size_t>(iid) < instruments_) by_instrument_[iid].push_back(r);
+        }
+        // 需要保留历史的字段（去重），每个历史槽位记录其字段在历史表中的列
+        bool used[kAlertFieldCount] = {};
+        for (const AlertHistorySlot& s : p_.history) used[s.field] = true;
+        for (uint8_t f = 0; f < kAlertFieldCount; ++f)
+            if (used[f]) hist_fields_.push_back(f);
+        for (const AlertHistorySlot& s : p_.history)
+            for (size_t c = 0; c < hist_fields_.size(); ++c)
+                if (hist_fields_[c] == s.field) slot_column_.push_back(c);
+        rule_state_.reset(new RuleState[p_.rules.size() * instruments_]);
+        state_.reset(new State[instruments_]);
+        if (!p_.history.empty()) {
+            hist_time_.reset(new int64_t[instruments_ * history_]);
+            hist_value_.reset(new double[instruments_ * history_ * hist_fields_.size()]);
+            anchors_.reset(new uint64_t[instruments_ * p_.history.size()]);
+        }
+        asof_.resize(p_.history.size());
+        reset();
+    }
+
+    /**
+     * 对一条行情执行全部相关规则，触发的事件写入 out（最多 max 条，超出部分计入 overflow）。
+     * @return 写入的事件数
+     */
+    size_t on_tick(const Tick& t, AlertEvent* out, size_t max) {
+        if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= instruments_) return 0;
+        const size_t iid = static_cast<size_t>(t.instrument_id);
+        const int64_t ts = sim_time(t);
+        State& st = state_[iid];
+        load_fields(t, st);
+        if (!p_.history.empty()) load_history(iid, st, ts);
+        st.volume = t.volume;
+        st.seen = true;
+
+        size_t n = 0;
+        n += run_rules(global_, iid, ts, out + n, max - n);
+        n += run_rules(by_instrument_[iid], iid, ts, out + n, max - n);
+        ++ticks_;
+        return n;
+    }
+
+    void reset() {
+        const size_t rows = p_.rules.size() * instruments_;
+        for (size_t k = 0; k < rows; ++k) rule_state_[k] = RuleState{};
+        for (size_t i = 0; i < instruments_; ++i) state_[i] = State{};
+        if (anchors_) std::memset(anchors_.get(), 0, instruments_ * p_.history.size() * sizeof(uint64_t));
+        ticks_ = evaluations_ = fired_ = overflow_ = 0;
+    }
+
+    size_t rules() const { return p_.rules.size(); }
+    size_t instruments() const { return instruments_; }
+    uint64_t ticks() const { return ticks_; }
+    uint64_t evaluations() const { return evaluations_; }
+    uint64_t fired() const { return fired_; }
+    uint64_t overflow() const { return overflow_; }
+
+private:
+    static constexpr int64_t kNever = std::numeric_limits<int64_t>::min();
+
+    struct State {
+        bool seen = false;
+        int64_t volume = 0;
+        uint64_t hist = 0;
+    };
+
+    /// 规则求值的热数据；op 非 0 时条件为“字段 比较 常量”，直接比较而不经解释循环
+    struct Hot {
+        uint8_t op = 0;
+        uint8_t field = 0;
+        uint32_t cond_begin = 0, cond_end = 0;
+        double threshold = 0.0;
+        int64_t hold_us = 0;
+        int64_t cooldown_us = 0;
+    };
+
+    /// (合约, 规则) 状态：条件本轮开始成立的时间与上次触发时间
+    struct RuleState {
+        int64_t since = kNever;
+        int64_t last_fire = kNever;
+    };
+
+    static bool truthy(double v) { return v != 0.0 && v == v; }
+
+    bool test(const Hot& s) const {
+        const double v = fields_[s.field];
+        switch (s.op) {
+            case kOpLt: return v < s.threshold;
+            case kOpLe: return v <= s.threshold;
+            case kOpGt: return v > s.threshold;
+            case kOpGe: return v >= s.threshold;
+            case kOpEq: return v == s.threshold;
+            default: return v != s.threshold && v == v && s.threshold == s.threshold;
+        }
+    }
+
+    void validate() const {
+        const size_t n = p_.ops.size();
+        if (p_.args.size() != n) throw std::invalid_argument("alert program: ops/args size mismatch");
+        for (const AlertHistorySlot& s : p_.history)
+            if (s.field >= kAlertFieldCount || s.horizon_us <= 0)
+                throw std::invalid_argument("alert program: invalid history slot");
+        for (const AlertRule& r : p_.rules) {
+            if (r.cond_begin >= r.cond_end || r.cond_end > n || r.value_begin > r.value_end || r.value_end > n)
+                throw std::invalid_argument("alert program: rule code range out of bounds");
+            check_range(r.cond_begin, r.cond_end);
+            if (r.value_begin != r.value_end) check_range(r.value_begin, r.value_end);
+        }
+    }
+
+    /// 模拟执行一段代码：参数有效、栈不下溢、不超 kMaxStack、结束时恰好一个值
+    void check_range(uint32_t b, uint32_t e) const {
+        size_t depth = 0;
+        for (uint32_t pc = b; pc < e; ++pc) {
+            const uint8_t op = p_.ops[pc];
+            const int32_t a = p_.args[pc];
+            size_t pops = 0, pushes = 1;
+            switch (op) {
+                case kOpConst:
+                    if (a < 0 || static_cast<size_t>(a) >= p_.consts.size()) throw std::invalid_argument("alert program: bad const");
+                    pops = 0;
+                    break;
+                case kOpField:
+                    if (a < 0 || a >= kAlertFieldCount) throw std::invalid_argument("alert program: bad field");
+                    pops = 0;
+                    break;
+                case kOpAsOf:
+                    if (a < 0 || static_cast<size_t>(a) >= p_.history.size()) throw std::invalid_argument("alert program: bad history slot");
+                    pops = 0;
+                    break;
+                case kOpNeg:
+                case kOpAbs:
+                case kOpNot: pops = 1; break;
+                default:
+                    if (op >= kOpCount) throw std::invalid_argument("alert program: bad opcode");
+                    pops = 2;
+                    break;
+            }
+            if (depth < pops) throw std::invalid_argument("alert program: stack underflow");
+            depth = depth - pops + pushes;
+            if (depth > kMaxStack) throw std::invalid_argument("alert program: expression too deep");
+        }
+        if (depth != 1) throw std::invalid_argument("alert program: expression must leave one value");
+    }
+
+    void load_fields(const Tick& t, const State& st) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        double* f = fields_;
+        f[kAlertLast] = t.last_price;
+        f[kAlertVolume] = static_cast<double>(t.volume);
+        f[kAlertTurnover] = t.turnover;
+        f[kAlertOpenInterest] = t.open_interest;
+        f[kAlertBid] = t.bid_price_1;
+        f[kAlertBidVolume] = static_cast<double>(t.bid_volume_1);
+        f[kAlertAsk] = t.ask_price_1;
+        f[kAlertAskVolume] = static_cast<double>(t.ask_volume_1);
+        f[kAlertOpen] = t.open_price;
+        f[kAlertHigh] = t.high_price;
+        f[kAlertLow] = t.low_price;
+        f[kAlertPreClose] = t.pre_close;
+        f[kAlertPreSettlement] = t.pre_settlement;
+        const bool two_sided = t.bid_price_1 > 0 && t.ask_price_1 > 0;
+        f[kAlertMid] = two_sided ? 0.5 * (t.bid_price_1 + t.ask_price_1) : t.last_price;
+        f[kAlertSpread] = two_sided ? t.ask_price_1 - t.bid_price_1 : nan;
+        const double bv = static_cast<double>(t.bid_volume_1);
+        const double av = static_cast<double>(t.ask_volume_1);
+        f[kAlertImbalance] = bv + av > 0 ? (bv - av) / (bv + av) : nan;
+        // 累计量回退（换日）时以当前累计量计
+        f[kAlertVolumeDelta] =
+            st.seen ? static_cast<double>(t.volume >= st.volume ? t.volume - st.volume : t.volume) : nan;
+        f[kAlertTimeOfDay] = static_cast<double>(t.time_us) * 1e-6;
+    }
+
+    void load_history(size_t iid, State& st, int64_t ts) {
+        const size_t cols = hist_fields_.size();
+        const size_t mask = history_ - 1;
+        const size_t row = iid * history_ + (st.hist & mask);
+        hist_time_[row] = ts;
+        for (size_t c = 0; c < cols; ++c) hist_value_[row * cols + c] = fields_[hist_fields_[c]];
+        ++st.hist;
+        const int64_t* times = hist_time_.get() + iid * history_;
+        const uint64_t oldest = st.hist > history_ ? st.hist - history_ : 0;
+        for (size_t s = 0; s < p_.history.size(); ++s) {
+            uint64_t& a = anchors_[iid * p_.history.size() + s];
+            if (a < oldest) a = oldest;
+            const int64_t target = ts - p_.history[s].horizon_us;
+            while (a + 1 < st.hist && times[(a + 1) & mask] <= target) ++a;
+            asof_[s] = times[a & mask] <= target
+                           ? hist_value_[(iid * history_ + (a & mask)) * cols + slot_column_[s]]
+                           : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    /// 栈顶保存在寄存器 tos 中，stack 只存其下的操作数
+    double eval(uint32_t b, uint32_t e) const {
+        double stack[kMaxStack];
+        size_t sp = 0;
+        double tos = 0.0;
+        const uint8_t* ops = p_.ops.data();
+        const int32_t* args = p_.args.data();
+        const double* consts = p_.consts.data();
+        for (uint32_t pc = b; pc < e; ++pc) {
+            switch (ops[pc]) {
+                case kOpConst: stack[sp++] = tos; tos = consts[args[pc]]; break;
+                case kOpField: stack[sp++] = tos; tos = fields_[args[pc]]; break;
+                case kOpAsOf: stack[sp++] = tos; tos = asof_[static_cast<size_t>(args[pc])]; break;
+                case kOpAdd: tos = stack[--sp] + tos; break;
+                case kOpSub: tos = stack[--sp] - tos; break;
+                case kOpMul: tos = stack[--sp] * tos; break;
+                case kOpDiv: tos = stack[--sp] / tos; break;
+                case kOpNeg: tos = -tos; break;
+                case kOpAbs: tos = std::fabs(tos); break;
+                case kOpMin: tos = std::fmin(stack[--sp], tos); break;
+                case kOpMax: tos = std::fmax(stack[--sp], tos); break;
+                case kOpLt: tos = stack[--sp] < tos ? 1.0 : 0.0; break;
+                case kOpLe: tos = stack[--sp] <= tos ? 1.0 : 0.0; break;
+                case kOpGt: tos = stack[--sp] > tos ? 1.0 : 0.0; break;
+                case kOpGe: tos = stack[--sp] >= tos ? 1.0 : 0.0; break;
+                case kOpEq: tos = stack[--sp] == tos ? 1.0 : 0.0; break;
+                case kOpNe: {
+                    const double a = stack[--sp];
+                    tos = a != tos && a == a && tos == tos ? 1.0 : 0.0;
+                    break;
+                }
+                case kOpAnd: tos = truthy(stack[--sp]) && truthy(tos) ? 1.0 : 0.0; break;
+                case kOpOr: tos = truthy(stack[--sp]) || truthy(tos) ? 1.0 : 0.0; break;
+                case kOpNot: tos = truthy(tos) ? 0.0 : 1.0; break;
+            }
+        }
+        return tos;
+    }
+
+    size_t run_rules(const std::vector<uint32_t>& rules, size_t iid, int64_t ts, AlertEvent* out, size_t max) {
+        size_t n = 0;
+        RuleState* row = rule_state_.get() + iid * p_.rules.size();
+        evaluations_ += rules.size();
+        for (uint32_t r : rules) {
+            const Hot& h = hot_[r];
+            RuleState& st = row[r];
+            if (!(h.op ? test(h) : truthy(eval(h.cond_begin, h.cond_end)))) {
+                st.since = kNever;
+                continue;
+            }
+            if (st.since == kNever) st.since = ts;
+            // 本轮已触发（last_fire >= since），或尚未满 hold / cooldown
+            if (st.last_fire != kNever && (st.last_fire >= st.since || ts - st.last_fire < h.cooldown_us)) continue;
+            if (ts - st.since < h.hold_us) continue;
+            st.last_fire = ts;
+            ++fired_;
+            if (n >= max) {
+                ++overflow_;
+                continue;
+            }
+            const AlertRule& rule = p_.rules[r];
+            AlertEvent& e = out[n++];
+            e.rule = r;
+            e.instrument_id = static_cast<int32_t>(iid);
+            e.time = ts;
+            e.value = rule.value_begin != rule.value_end ? eval(rule.value_begin, rule.value_end)
+                                                          : std::numeric_limits<double>::quiet_NaN();
+        }
+        return n;
+    }
+
+    AlertProgram p_;
+    size_t instruments_;
+    size_t history_;
+    std::vector<Hot> hot_;
+    std::vector<uint32_t> global_;
+    std::vector<std::vector<uint32_t>> by_instrument_;
+    std::vector<uint8_t> hist_fields_;   ///< 历史表各列对应的字段
+    std::vector<size_t> slot_column_;    ///< 历史槽位 -> 历史表列
+    std::unique_ptr<RuleState[]> rule_state_;  ///< [合约][规则]，同一行情的规则状态连续
+    std::unique_ptr<State[]> state_;
+    std::unique_ptr<int64_t[]> hist_time_;
+    std::unique_ptr<double[]> hist_value_;
+    std::unique_ptr<uint64_t[]> anchors_;
+    std::vector<double> asof_;           ///< 本条行情各历史槽位的 as-of 值
+    double fields_[kAlertFieldCount] = {};
+    uint64_t ticks_ = 0;
+    uint64_t evaluations_ = 0;
+    uint64_t fired_ = 0;
+    uint64_t overflow_ = 0;
+};
+
+}  // namespace fq
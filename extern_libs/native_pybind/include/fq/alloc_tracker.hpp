@@ -0,0 +1,67 @@
+/**
+ * fq/alloc_tracker.hpp: 按线程的堆分配计数
+ *
+ * alloc_hook.cpp 替换全局 operator new/delete（检查程序另可替换 malloc 系列），
+ * 每次分配/释放只累加当前线程的计数器。热路径在预热后用 AllocScope 圈定一段代码，
+ * 断言其间分配次数为 0；未链接 alloc_hook.cpp 时计数恒为 0，alloc_tracking_enabled() 为 false。
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace fq {
+
+struct AllocStats {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+};
+
+namespace alloc_detail {
+
+/// 线程局部计数器（平凡类型，首次访问不触发分配）
+inline AllocStats& thread_stats() noexcept {
+    static thread_local AllocStats stats;
+    return stats;
+}
+
+inline std::atomic<bool>& hook_linked() noexcept {
+    static std::atomic<bool> linked{false};
+    return linked;
+}
+
+}  // namespace alloc_detail
+
+inline void record_alloc(size_t bytes) noexcept {
+    AllocStats& s = alloc_detail::thread_stats();
+    ++s.allocs;
+    s.bytes += bytes;
+}
+
+inline void record_free() noexcept { ++alloc_detail::thread_stats().frees; }
+
+/// 分配钩子是否已链接（构建时开启 FQ_ALLOC_TRACKING）
+inline bool alloc_tracking_enabled() noexcept {
+    return alloc_detail::hook_linked().load(std::memory_order_relaxed);
+}
+
+/// 当前线程累计的分配统计
+inline AllocStats thread_alloc_stats() noexcept { return alloc_detail::thread_stats(); }
+
+/// 圈定一段代码，统计其间当前线程的分配次数与字节数
+class AllocScope {
+public:
+    AllocScope() noexcept : start_(thread_alloc_stats()) {}
+
+    void restart() noexcept { start_ = thread_alloc_stats(); }
+
+    uint64_t allocations() const noexcept { return thread_alloc_stats().allocs - start_.allocs; }
+    uint64_t bytes() const noexcept { return thread_alloc_stats().bytes - start_.bytes; }
+
+private:
+    AllocStats start_;
+};
+
+}  // namespace fq
@@ -0,0 +1,390 @@
+/**
+ * fq/backtest.hpp: 回测用多合约时间归并与撮合模拟
+ *
+ * TickMerger 对多条各自按时间有序的 Tick 序列做 k 路归并（二叉堆，同一时刻按序列下标稳定），
+ * 按时间顺序逐条交出行情；FillSimulator 用录制的一档盘口模拟委托成交：
+ *   - 延迟模型：委托在 submit 后 latency_us 才到达交易所，之前的行情对其不可见
+ *   - 到达时可立即成交（市价或限价穿越对手价）按对手一档价成交（taker）
+ *   - 否则挂单排队：排在同价位已显示挂量之后，同价成交量（Δvolume × queue_fill_ratio）
+ *     消耗前方队列，队列耗尽后按挂单价成交（maker）；盘口量减少视为前方撤单；
+ *     对手价或成交价穿过挂单价时全部成交
+ * 委托存于预分配槽位、按合约串成链表，on_tick 只遍历该合约的在途委托，不做逐条分配。
+ * BacktestLoop 是回测主循环：TickMerger 归并 → FillSimulator 撮合 → 装入 TickBatch，
+ * 批次满时才回调一次调用方（与实盘批次分发相同的 TickBatch 接口），逐条处理不经过调用方。
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "fq/packed_tick.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+#include "fq/tick_batch.hpp"
+
+namespace fq {
+
+constexpr int64_t kUsPerDay = 86400LL * 1000000LL;
+constexpr size_t kSimFillsPerTick = 256;  ///< 单条行情最多触发的成交数
+
+/// 行情日期 + 当日微秒 -> 单调递增的回测时间戳（1970-01-01 起的微秒数，跨月连续）
+inline int64_t sim_time(uint32_t trade_date, int64_t time_us) {
+    return days_from_civil(trade_date / 10000, trade_date / 100 % 100, trade_date % 100) * kUsPerDay + time_us;
+}
+
+inline int64_t sim_time(const Tick& t) { return sim_time(t.trade_date, t.time_us); }
+
+struct TickSpan {
+    const Tick* data;
+    size_t size;
+    const int32_t* ids = nullptr;  ///< 可选：记录内 instrument_id -> 进程内 ID（如 .fqt 文件内合约下标）
+    size_t id_count = 0;
+};
+
+class TickMerger {
+public:
+    explicit TickMerger(std::vector<TickSpan> spans) : spans_(std::move(spans)), pos_(spans_.size(), 0) {
+        heap_.reserve(spans_.size());
+        reset();
+    }
+
+    /// 回到各序列开头（不重新分配）
+    void reset() {
+        heap_.clear();
+        for (size_t i = 0; i < spans_.size(); ++i) {
+            pos_[i] = 0;
+            if (spans_[i].size == 0) continue;
+            heap_.push_back(Entry{sim_time(spans_[i].data[0]), static_cast<uint32_t>(i)});
+            sift_up(heap_.size() - 1);
+        }
+    }
+
+    /// 下一条行情（全部取完返回 nullptr）
+    const Tick* next() {
+        if (heap_.empty()) return nullptr;
+        const uint32_t s = heap_[0].stream;
+        last_ = s;
+        const Tick* t = &spans_[s].data[pos_[s]];
+        if (++pos_[s] < spans_[s].size) {
+            heap_[0].key = sim_time(spans_[s].data[pos_[s]]);
+        } else {
+            heap_[0] = heap_.back();
+            heap_.pop_back();
+        }
+        if (!heap_.empty()) sift_down(0);
+        return t;
+    }
+
+    bool empty() const { return heap_.empty(); }
+    /// 上一次 next() 返回的行情所属序列
+    const TickSpan& last_span() const { return spans_[last_]; }
+
+private:
+    struct Entry {
+        int64_t key;
+        uint32_t stream;
+    };
+
+    static bool less(const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.stream < b.stream);
+    }
+
+    void sift_up(size_t i) {
+        while (i > 0) {
+            const size_t p = (i - 1) / 2;
+            if (!less(heap_[i], heap_[p])) break;
+            std::swap(heap_[i], heap_[p]);
+            i = p;
+        }
+    }
+
+    void sift_down(size_t i) {
+        const size_t n = heap_.size();
+        for (;;) {
+            size_t m = i;
+            const size_t l = 2 * i + 1, r = l + 1;
+            if (l < n && less(heap_[l], heap_[m])) m = l;
+            if (r < n && less(heap_[r], heap_[m])) m = r;
+            if (m == i) return;
+            std::swap(heap_[i], heap_[m]);
+            i = m;
+        }
+    }
+
+    std::vector<TickSpan> spans_;
+    std::vector<size_t> pos_;
+    std::vector<Entry> heap_;
+    size_t last_ = 0;
+};
+
+struct SimConfig {
+    int64_t latency_us = 0;         ///< 委托到达交易所的延迟
+    double queue_fill_ratio = 1.0;  ///< 同价成交量中消耗前方队列的比例（<1 更保守）
+    size_t max_orders = 65536;      ///< 同时在途委托上限（<= 2^24）
+};
+
+struct SimFill {
+    uint64_t order_id;
+    int32_t instrument_id;
+    int8_t side;   ///< 1 买 / -1 卖
+    bool maker;    ///< 挂单成交为 true，到达即成交为 false
+    double price;
+    int64_t quantity;
+    int64_t ts;    ///< sim_time
+};
+
+class FillSimulator {
+public:
+    explicit FillSimulator(const SimConfig& config = SimConfig(), size_t capacity = kMaxInstruments)
+        : config_(config),
+          capacity_(capacity == 0 ? 1 : capacity),
+          max_orders_(config.max_orders == 0 ? 1 : (config.max_orders > kSlotMask ? kSlotMask : config.max_orders)),
+          orders_(new Order[max_orders_]()),
+          books_(new Book[capacity_]()) {
+        for (size_t i = 0; i < max_orders_; ++i) orders_[i].next = static_cast<int32_t>(i + 1);
+        orders_[max_orders_ - 1].next = -1;
+        free_head_ = 0;
+    }
+
+    FillSimulator(const FillSimulator&) = delete;
+    FillSimulator& operator=(const FillSimulator&) = delete;
+
+    /// 下单：price <= 0 为市价；返回委托号，参数无效或槽位已满返回 0
+    uint64_t submit(int32_t instrument_id, int side, double price, int64_t quantity, int64_t ts) {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= capacity_) return 0;
+        if ((side != 1 && side != -1) || quantity <= 0 || free_head_ < 0) return 0;
+        const int32_t slot = free_head_;
+        Order& o = orders_[slot];
+        free_head_ = o.next;
+        o.id = (++seq_ << kSlotBits) | static_cast<uint64_t>(slot);
+        o.instrument_id = instrument_id;
+        o.side = static_cast<int8_t>(side);
+        o.state = kInFlight;
+        o.price = price;
+        o.remaining = quantity;
+        o.arrive_at = ts + config_.latency_us;
+        o.queue_ahead = kUnknownQueue;
+        o.prev_shown = -1;
+        o.next = -1;
+        Book& b = books_[instrument_id];
+        if (b.tail >= 0) orders_[b.tail].next = slot;
+        else b.head = slot;
+        b.tail = slot;
+        ++live_;
+        return o.id;
+    }
+
+    /// 撤单（在途或挂单中）；已成交/已撤/未知委托返回 false
+    bool cancel(uint64_t order_id) {
+        const uint64_t slot = order_id & kSlotMask;
+        if (slot >= max_orders_) return false;
+        Order& o = orders_[slot];
+        if (o.id != order_id || o.state == kDone) return false;
+        o.state = kDone;  // 下次遍历该合约时回收槽位
+        --live_;
+        return true;
+    }
+
+    /// 推进一条行情，成交写入 out（最多 cap 条），返回条数
+    size_t on_tick(const Tick& t, SimFill* out, size_t cap) {
+        if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= capacity_) return 0;
+        Book& b = books_[t.instrument_id];
+        const int64_t dv = b.seen && t.volume >= b.volume ? t.volume - b.volume : 0;
+        b.seen = true;
+        b.volume = t.volume;
+        if (b.head < 0) return 0;
+        const int64_t ts = sim_time(t);
+        size_t n = 0;
+        int32_t prev = -1;
+        for (int32_t slot = b.head; slot >= 0;) {
+            Order& o = orders_[slot];
+            const int32_t next = o.next;
+            if (o.state != kDone && n < cap && ts >= o.arrive_at) match(o, t, dv, ts, out, n);
+            if (o.state == kDone) {
+                // 摘链并归还槽位
+                if (prev >= 0) orders_[prev].next = next;
+                else b.head = next;
+                if (b.tail == slot) b.tail = prev;
+                o.next = free_head_;
+                free_head_ = slot;
+            } else {
+                prev = slot;
+            }
+            slot = next;
+        }
+        return n;
+    }
+
+    size_t live_orders() const { return live_; }
+    const SimConfig& config() const { return config_; }
+
+private:
+    static constexpr int kSlotBits = 24;
+    static constexpr uint64_t kSlotMask = (1ULL << kSlotBits) - 1;
+    static constexpr double kUnknownQueue = std::numeric_limits<double>::infinity();
+    enum State : uint8_t { kInFlight = 0, kResting = 1, kDone = 2 };
+
+    struct Order {
+        uint64_t id = 0;
+        int32_t instrument_id = 0;
+        int8_t side = 0;
+        State state = kDone;
+        double price = 0.0;
+        int64_t remaining = 0;
+        int64_t arrive_at = 0;
+        double queue_ahead = 0.0;
+        int64_t prev_shown = -1;  ///< 上一条行情本单价位的显示挂量，-1 为本单价位不是最优价
+        int32_t next = -1;
+    };
+
+    struct Book {
+        bool seen = false;
+        int64_t volume = 0;
+        int32_t head = -1;
+        int32_t tail = -1;
+    };
+
+    void fill(Order& o, double price, int64_t qty, bool maker, int64_t ts, SimFill* out, size_t& n) {
+        out[n++] = SimFill{o.id, o.instrument_id, o.side, maker, price, qty, ts};
+        o.remaining -= qty;
+        if (o.remaining <= 0) {
+            o.state = kDone;
+            --live_;
+        }
+    }
+
+    void match(Order& o, const Tick& t, int64_t dv, int64_t ts, SimFill* out, size_t& n) {
+        // 以买方视角比较：卖单把价格取负，买一/卖一对调
+        const double s = o.side;
+        const double own = s * o.price;
+        const double opp_px = o.side > 0 ? t.ask_price_1 : t.bid_price_1;
+        const double same_px = o.side > 0 ? t.bid_price_1 : t.ask_price_1;
+        const int64_t same_vol = o.side > 0 ? t.bid_volume_1 : t.ask_volume_1;
+
+        if (o.state == kInFlight) {
+            if (o.price <= 0) {
+                if (opp_px > 0) fill(o, opp_px, o.remaining, false, ts, out, n);
+                return;
+            }
+            if (opp_px > 0 && own >= s * opp_px) {
+                fill(o, opp_px, o.remaining, false, ts, out, n);
+                return;
+            }
+            o.state = kResting;
+            // 到达前的成交不消耗本单队列
+            if (same_px > 0 && o.price == same_px) {
+                o.queue_ahead = static_cast<double>(same_vol);
+                o.prev_shown = same_vol;
+            } else if (same_px <= 0 || own > s * same_px) {
+                o.queue_ahead = 0.0;
+            }
+            return;
+        }
+
+        if ((opp_px > 0 && s * opp_px <= own) || (dv > 0 && t.last_price > 0 && s * t.last_price < own)) {
+            fill(o, o.price, o.remaining, true, ts, out, n);
+            return;
+        }
+        const int64_t traded = dv > 0 && t.last_price == o.price ? dv : 0;
+        int64_t consumed = traded;
+        if (same_px > 0 && o.price == same_px) {
+            if (o.prev_shown < 0) {
+                // 首次（或重新）成为最优价：按显示挂量排队，显示量已反映本条的成交
+                const double shown = static_cast<double>(same_vol);
+                if (o.queue_ahead > shown) o.queue_ahead = shown;
+                consumed = 0;
+            } else {
+                // 显示挂量的减少中扣除本价位成交，剩余部分才是前方撤单；撤单可能来自本单之后，排队位置不低于 0
+                const int64_t cancels = o.prev_shown - same_vol - traded;
+                if (cancels > 0) o.queue_ahead = std::max(0.0, o.queue_ahead - static_cast<double>(cancels));
+            }
+            o.prev_shown = same_vol;
+        } else {
+            if (same_px > 0 && own > s * same_px) o.queue_ahead = 0.0;
+            o.prev_shown = -1;
+        }
+        if (consumed > 0 && o.queue_ahead != kUnknownQueue) {
+            o.queue_ahead -= static_cast<double>(consumed) * config_.queue_fill_ratio;
+            if (o.queue_ahead < 0) {
+                int64_t q = static_cast<int64_t>(std::llround(-o.queue_ahead));
+                if (q < 1) q = 1;
+                // 本单成交不超过本价位实际成交量
+                if (q > consumed) q = consumed;
+                if (q > o.remaining) q = o.remaining;
+                o.queue_ahead = 0.0;
+                fill(o, o.price, q, true, ts, out, n);
+            }
+        }
+    }
+
+    SimConfig config_;
+    size_t capacity_;
+    size_t max_orders_;
+    std::unique_ptr<Order[]> orders_;
+    std::unique_ptr<Book[]> books_;
+    int32_t free_head_ = -1;
+    uint64_t seq_ = 0;
+    size_t live_ = 0;
+};
+
+class BacktestLoop {
+public:
+    explicit BacktestLoop(FillSimulator& sim, size_t capacity = kMaxInstruments)
+        : sim_(sim), last_price_(capacity == 0 ? 1 : capacity, 0.0) {}
+
+    /// 回放到 merger 取尽：序列带 ids 时先把 instrument_id 换成进程内 ID；每条行情先撮合，
+    /// 成交逐笔交给 on_fill(const SimFill&)，再装入 batch；batch 满或回放结束时调用
+    /// on_batch(TickBatch&, int64_t now)（now 为批内最后一条的 sim_time），回调返回后清空批次
+    /// （批次代号递增，回调中取得的视图随之失效）。返回回放条数
+    template <typename OnFill, typename OnBatch>
+    size_t run(TickMerger& merger, TickBatch& batch, OnFill&& on_fill, OnBatch&& on_batch) {
+        size_t ticks = 0;
+        int64_t now = 0;
+        batch.clear();
+        while (const Tick* src = merger.next()) {
+            ++ticks;
+            Tick* t = batch.emplace();
+            *t = *src;
+            const TickSpan& span = merger.last_span();
+            if (span.ids) {
+                const size_t local = static_cast<size_t>(t->instrument_id);
+                t->instrument_id = t->instrument_id >= 0 && local < span.id_count ? span.ids[local] : -1;
+            }
+            if (t->last_price != 0.0 && t->instrument_id >= 0 &&
+                static_cast<size_t>(t->instrument_id) < last_price_.size())
+                last_price_[static_cast<size_t>(t->instrument_id)] = t->last_price;
+            const size_t n = sim_.on_tick(*t, fills_, kSimFillsPerTick);
+            for (size_t i = 0; i < n; ++i) on_fill(fills_[i]);
+            now = sim_time(*t);
+            if (batch.full()) {
+                on_batch(batch, now);
+                batch.clear();
+            }
+        }
+        if (batch.size() > 0) {
+            on_batch(batch, now);
+            batch.clear();
+        }
+        return ticks;
+    }
+
+    /// 合约最近一条非零成交价（未出现过为 0）
+    double last_price(int32_t instrument_id) const {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= last_price_.size()) return 0.0;
+        return last_price_[static_cast<size_t>(instrument_id)];
+    }
+
+    FillSimulator& simulator() { return sim_; }
+
+private:
+    FillSimulator& sim_;
+    std::vector<double> last_price_;
+    SimFill fills_[kSimFillsPerTick];
+};
+
+}  // namespace fq
@@ -0,0 +1,142 @@
+/**
+ * fq/cross_section.hpp: 固定时间网格上的全市场横截面矩阵
+ *
+ * 最新值表按字段分列（structure-of-arrays），以 instrument_id 为下标，每条行情只改写本合约的几个槽位；
+ * 行情时间越过网格点时，把各字段的整列 memcpy 到预分配块的下一行，得到 (时间 × 合约) 矩阵。
+ * 网格点 g 取时间 <= g 的最新值（as-of）；尚无数据的合约为 NaN。
+ * 相邻行情间隔超过 max_gap（午休、夜盘收盘）时只补一行，随后对齐到新时间，不生成大段重复行。
+ * 块写满后需要新行的行情被拒收（on_tick 返回 false，最新值表不变），
+ * 待调用方取走（持久化）并 clear() 后重新提交，保证每行都是该网格点的 as-of 截面。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "fq/backtest.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+enum CrossField : uint8_t {
+    kCrossLast = 0,
+    kCrossMid,
+    kCrossOpenInterest,
+    kCrossVolume,
+    kCrossBid,
+    kCrossAsk,
+    kCrossFieldCount,
+};
+
+inline const char* cross_field_name(size_t f) {
+    static const char* kNames[kCrossFieldCount] = {"last_price",  "mid_price",   "open_interest",
+                                                   "volume",      "bid_price_1", "ask_price_1"};
+    return f < kCrossFieldCount ? kNames[f] : "";
+}
+
+class CrossSection {
+public:
+    CrossSection(size_t instruments, size_t rows, int64_t interval_us, int64_t max_gap_us)
+        : instruments_(instruments == 0 ? 1 : instruments),
+          rows_(rows == 0 ? 1 : rows),
+          interval_us_(interval_us <= 0 ? 1 : interval_us),
+          max_gap_us_(max_gap_us <= 0 ? interval_us_ : max_gap_us),
+          values_(new double[kCrossFieldCount * instruments_]),
+          block_(new double[kCrossFieldCount * rows_ * instruments_]),
+          times_(new int64_t[rows_]) {
+        reset();
+    }
+
+    CrossSection(const CrossSection&) = delete;
+    CrossSection& operator=(const CrossSection&) = delete;
+
+    /// 推进到行情时间并写入最新值；块已满且需要新行时不处理并返回 false
+    bool on_tick(const Tick& t) {
+        const int64_t ts = sim_time(t);
+        advance_to(ts);
+        if (next_grid_ < ts && full()) return false;
+        update(t);
+        return true;
+    }
+
+    /// 写出所有早于 ts 的网格点（块满时停止），返回新增行数
+    size_t advance_to(int64_t ts) {
+        if (next_grid_ == kNoGrid) {
+            next_grid_ = align_up(ts);
+            return 0;
+        }
+        size_t added = 0;
+        while (next_grid_ < ts && filled_ < rows_) {
+            snapshot(next_grid_);
+            ++added;
+            next_grid_ += interval_us_;
+            if (ts - next_grid_ > max_gap_us_) next_grid_ = align_up(ts);
+        }
+        return added;
+    }
+
+    void update(const Tick& t) {
+        if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= instruments_) return;
+        const size_t i = static_cast<size_t>(t.instrument_id);
+        double* v = values_.get();
+        v[kCrossLast * instruments_ + i] = t.last_price;
+        v[kCrossMid * instruments_ + i] = t.bid_price_1 > 0 && t.ask_price_1 > 0
+                                              ? 0.5 * (t.bid_price_1 + t.ask_price_1)
+                                              : t.last_price;
+        v[kCrossOpenInterest * instruments_ + i] = t.open_interest;
+        v[kCrossVolume * instruments_ + i] = static_cast<double>(t.volume);
+        v[kCrossBid * instruments_ + i] = t.bid_price_1;
+        v[kCrossAsk * instruments_ + i] = t.ask_price_1;
+    }
+
+    /// 清空已写出的行（最新值表与网格进度保留）
+    void clear() { filled_ = 0; }
+
+    /// 清空全部状态
+    void reset() {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (size_t k = 0; k < kCrossFieldCount * instruments_; ++k) values_[k] = nan;
+        filled_ = 0;
+        next_grid_ = kNoGrid;
+    }
+
+    bool full() const { return filled_ >= rows_; }
+    size_t rows_filled() const { return filled_; }
+    size_t rows() const { return rows_; }
+    size_t instruments() const { return instruments_; }
+    int64_t interval_us() const { return interval_us_; }
+
+    /// 字段 f 的 (rows × instruments) 行主序矩阵
+    const double* field_block(size_t f) const { return block_.get() + f * rows_ * instruments_; }
+    /// 字段 f 的当前最新值（instruments 个）
+    const double* latest(size_t f) const { return values_.get() + f * instruments_; }
+    /// 各行的网格时间（sim_time）
+    const int64_t* times() const { return times_.get(); }
+
+private:
+    static constexpr int64_t kNoGrid = std::numeric_limits<int64_t>::min();
+
+    int64_t align_up(int64_t ts) const { return (ts + interval_us_ - 1) / interval_us_ * interval_us_; }
+
+    void snapshot(int64_t grid) {
+        const size_t bytes = instruments_ * sizeof(double);
+        for (size_t f = 0; f < kCrossFieldCount; ++f)
+            std::memcpy(block_.get() + (f * rows_ + filled_) * instruments_, values_.get() + f * instruments_, bytes);
+        times_[filled_++] = grid;
+    }
+
+    size_t instruments_;
+    size_t rows_;
+    int64_t interval_us_;
+    int64_t max_gap_us_;
+    std::unique_ptr<double[]> values_;
+    std::unique_ptr<double[]> block_;
+    std::unique_ptr<int64_t[]> times_;
+    size_t filled_ = 0;
+    int64_t next_grid_ = kNoGrid;
+};
+
+}  // namespace fq
@@ -0,0 +1,238 @@
+/**
+ * fq/csv_encoder.hpp: 与 FileStorage（csv.DictWriter）逐字节一致的 CSV 编码
+ *
+ * - 浮点按 Python repr 输出：std::to_chars 取最短可往返的有效数字，再按 repr 的规则排版
+ *   （小数点位置 <= -4 或 > 16 时用科学计数法，整数值补 ".0"，指数至少两位）
+ * - 文本按 csv.QUOTE_MINIMAL：含逗号、引号、\r、\n 时加引号，内部引号双写；行尾 "\r\n"
+ * - datetime 按 isoformat()：日期前缀 "YYYY-MM-DDT" 按交易日缓存，微秒为 0 时省略小数部分
+ * - CsvFileBuffers 按 (合约, 交易日) 把一批记录聚合到各自文件的缓冲，批间复用容量，
+ *   调用方每批每个文件只需一次 write；出现更晚的交易日后，更早交易日的缓冲在下一批开始时释放
+ * - kCsvNonPersistedFields 为行情行不落盘的列，Python 侧经 native_pybind.CSV_NON_PERSISTED_FIELDS 读取
+ */
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace fq {
+
+/// 行情行不落盘的列：进程内合约 ID 仅用于内存中的键，累计成交额仅供成交推断使用
+inline constexpr const char* kCsvNonPersistedFields[] = {"instrument_id", "turnover"};
+
+inline void csv_append_int(std::string& out, int64_t v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, static_cast<size_t>(r.ptr - buf));
+}
+
+/// 与 Python repr(float) 相同的文本
+inline void csv_append_float(std::string& out, double v) {
+    if (std::isnan(v)) {
+        out.append("nan");
+        return;
+    }
+    if (std::isinf(v)) {
+        out.append(v < 0 ? "-inf" : "inf");
+        return;
+    }
+    // 最短往返的科学计数形式 d[.ddd]e±XX，拆出有效数字与小数点位置
+    char sci[32];
+    const auto r = std::to_chars(sci, sci + sizeof(sci), v, std::chars_format::scientific);
+    const char* p = sci;
+    if (*p == '-') {
+        out.push_back('-');
+        ++p;
+    }
+    char digits[20];
+    int nd = 0;
+    for (; p < r.ptr && *p != 'e'; ++p)
+        if (*p != '.') digits[nd++] = *p;
+    int exp10 = 0;
+    std::from_chars(p + 1 + (p[1] == '+'), r.ptr, exp10);
+    const int decpt = exp10 + 1;
+
+    if (decpt <= -4 || decpt > 16) {
+        out.push_back(digits[0]);
+        if (nd > 1) {
+            out.push_back('.');
+            out.append(digits + 1, static_cast<size_t>(nd - 1));
+        }
+        out.push_back('e');
+        out.push_back(exp10 < 0 ? '-' : '+');
+        const int e = exp10 < 0 ? -exp10 : exp10;
+        if (e < 10) out.push_back('0');
+        csv_append_int(out, e);
+    } else if (decpt <= 0) {
+        out.append("0.");
+        out.append(static_cast<size_t>(-decpt), '0');
+        out.append(digits, static_cast<size_t>(nd));
+    } else if (decpt >= nd) {
+        out.append(digits, static_cast<size_t>(nd));
+        out.append(static_cast<size_t>(decpt - nd), '0');
+        out.append(".0");
+    } else {
+        out.append(digits, static_cast<size_t>(decpt));
+        out.push_back('.');
+        out.append(digits + decpt, static_cast<size_t>(nd - decpt));
+    }
+}
+
+/// 文本字段（QUOTE_MINIMAL）
+inline void csv_append_text(std::string& out, const char* s, size_t n) {
+    bool quote = false;
+    for (size_t i = 0; i < n && !quote; ++i)
+        quote = s[i] == ',' || s[i] == '"' || s[i] == '\r' || s[i] == '\n';
+    if (!quote) {
+        out.append(s, n);
+        return;
+    }
+    out.push_back('"');
+    for (size_t i = 0; i < n; ++i) {
+        if (s[i] == '"') out.push_back('"');
+        out.push_back(s[i]);
+    }
+    out.push_back('"');
+}
+
+/// datetime.isoformat()（无时区），日期前缀按交易日缓存
+class IsoDateTimeFormatter {
+public:
+    void append(std::string& out, int year, int month, int day, int hour, int minute, int second, int micros) {
+        const int32_t date = year * 10000 + month * 100 + day;
+        if (date != cached_date_) {
+            cached_date_ = date;
+            write_digits(prefix_, year, 4);
+            prefix_[4] = '-';
+            write_digits(prefix_ + 5, month, 2);
+            prefix_[7] = '-';
+            write_digits(prefix_ + 8, day, 2);
+            prefix_[10] = 'T';
+        }
+        char buf[26];
+        std::memcpy(buf, prefix_, 11);
+        write_digits(buf + 11, hour, 2);
+        buf[13] = ':';
+        write_digits(buf + 14, minute, 2);
+        buf[16] = ':';
+        write_digits(buf + 17, second, 2);
+        size_t n = 19;
+        if (micros != 0) {
+            buf[19] = '.';
+            write_digits(buf + 20, micros, 6);
+            n = 26;
+        }
+        out.append(buf, n);
+    }
+
+private:
+    static void write_digits(char* dst, int v, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            dst[i] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        }
+    }
+
+    int32_t cached_date_ = -1;
+    char prefix_[11] = {};
+};
+
+/// 按 (合约, 交易日) 聚合一批 CSV 行的文件缓冲
+class CsvFileBuffers {
+public:
+    struct File {
+        std::string key;     ///< 合约 + '\0' + 交易日
+        std::string path;
+        int32_t date = 0;
+        std::string header;  ///< 本批首行的表头（文件不存在时由调用方写入）
+        std::string body;
+        size_t rows = 0;
+        bool active = false;  ///< 本批已登记
+    };
+
+    explicit CsvFileBuffers(std::string base_path) : base_path_(std::move(base_path)) {}
+
+    /// 开始新一批：清空各文件缓冲（保留容量）；交易日前进后释放更早交易日的文件
+    void begin_batch() {
+        for (size_t idx : active_) {
+            files_[idx].header.clear();
+            files_[idx].body.clear();
+            files_[idx].rows = 0;
+            files_[idx].active = false;
+        }
+        active_.clear();
+        if (latest_date_ != swept_date_) {
+            swept_date_ = latest_date_;
+            evict_before(latest_date_);
+        }
+    }
+
+    /// 取合约某交易日的文件缓冲（路径同 FileStorage：<base>/<symbol>_<YYYYMMDD>.csv）
+    File& file(const char* symbol, size_t symbol_len, int32_t date) {
+        key_.assign(symbol, symbol_len);
+        key_.push_back('\0');
+        csv_append_int(key_, date);
+        auto it = index_.find(key_);
+        size_t idx;
+        if (it == index_.end()) {
+            idx = files_.size();
+            File f;
+            f.key = key_;
+            f.date = date;
+            f.path = base_path_;
+            if (!f.path.empty() && f.path.back() != '/') f.path.push_back('/');
+            f.path.append(symbol, symbol_len);
+            f.path.push_back('_');
+            csv_append_int(f.path, date);
+            f.path.append(".csv");
+            files_.push_back(std::move(f));
+            index_.emplace(key_, idx);
+        } else {
+            idx = it->second;
+        }
+        if (date > latest_date_) latest_date_ = date;
+        File& f = files_[idx];
+        if (!f.active) {
+            f.active = true;
+            active_.push_back(idx);
+        }
+        return f;
+    }
+
+    /// 本批涉及的文件下标（按首次出现顺序）
+    const std::vector<size_t>& active() const { return active_; }
+    File& at(size_t idx) { return files_[idx]; }
+    /// 当前保留的文件缓冲数
+    size_t size() const { return files_.size(); }
+
+private:
+    /// 只在批间（无活跃文件）调用：丢弃交易日早于 date 的文件并重建索引
+    void evict_before(int32_t date) {
+        size_t kept = 0;
+        for (size_t i = 0; i < files_.size(); ++i) {
+            if (files_[i].date < date) continue;
+            if (kept != i) files_[kept] = std::move(files_[i]);
+            ++kept;
+        }
+        if (kept == files_.size()) return;
+        files_.resize(kept);
+        index_.clear();
+        for (size_t i = 0; i < files_.size(); ++i) index_.emplace(files_[i].key, i);
+    }
+
+    std::string base_path_;
+    std::string key_;
+    std::vector<File> files_;
+    std::unordered_map<std::string, size_t> index_;
+    std::vector<size_t> active_;
+    int32_t latest_date_ = 0;
+    int32_t swept_date_ = 0;
+};
+
+}  // namespace fq
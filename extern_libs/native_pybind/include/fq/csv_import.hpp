@@ -0,0 +1,389 @@
+/**
+ * fq/csv_import.hpp: FileStorage CSV 归档 -> 行情日文件（.fqt）的批量导入
+ *
+ * - CsvTickParser 按表头把列映射到 fq::Tick 字段（未知列忽略），分隔符/引号/换行的定位用 SSE2
+ *   每次比较 16 字节，字段内无需逐字节判断；数值用 std::from_chars，时间按 isoformat 解析
+ * - 列数不符、数值或时间无法解析的行计入 rejected 并跳过；文件内时间乱序时稳定排序并计入 out_of_order
+ * - import_csv_day 以线程池并行解析同一天的各合约文件（每个文件一个任务，随取随做），
+ *   按时间 k 路归并（同时间按文件顺序），文件内合约 ID 按归并后首次出现分配，写出带索引的日文件；
+ *   与 Python build_day_file 的输出逐字节一致
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "fq/backtest.hpp"
+#include "fq/tick.hpp"
+#include "fq/tick_file.hpp"
+
+namespace fq {
+
+/// [p, end) 中第一个 ',' '"' '\r' '\n' 的位置，找不到返回 end
+inline const char* csv_find_special(const char* p, const char* end) {
+#if defined(__SSE2__)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, quote)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        const int mask = _mm_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(static_cast<unsigned>(mask));
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p)
+        if (*p == ',' || *p == '"' || *p == '\r' || *p == '\n') return p;
+    return end;
+}
+
+struct CsvImportStats {
+    uint64_t files = 0;
+    uint64_t failed_files = 0;  ///< 无法读取或表头不可用
+    uint64_t rows = 0;          ///< 成功导入的行
+    uint64_t rejected = 0;      ///< 校验失败跳过的行
+    uint64_t out_of_order = 0;  ///< 文件内时间回退的行（已排序）
+    uint64_t bytes = 0;         ///< 读取的 CSV 字节数
+
+    void add(const CsvImportStats& o) {
+        files += o.files;
+        failed_files += o.failed_files;
+        rows += o.rows;
+        rejected += o.rejected;
+        out_of_order += o.out_of_order;
+        bytes += o.bytes;
+    }
+};
+
+class CsvTickParser {
+public:
+    /// 解析整个文件内容，行情追加到 out（instrument_id = file_id）；表头缺少 datetime 时返回 false
+    bool parse(const char* data, size_t size, int32_t file_id, std::vector<Tick>& out, CsvImportStats& stats) {
+        const char* p = data;
+        const char* end = data + size;
+        if (!read_row(p, end) || !map_header()) return false;
+        const size_t first = out.size();
+        while (p < end) {
+            if (!read_row(p, end)) {
+                ++stats.rejected;
+                continue;
+            }
+            if (fields_.size() == 1 && fields_[0].size == 0) continue;  // 空行
+            Tick t{};
+            t.instrument_id = file_id;
+            if (fields_.size() != columns_.size() || !fill(t)) {
+                ++stats.rejected;
+                continue;
+            }
+            out.push_back(t);
+        }
+        stats.rows += out.size() - first;
+        // 按到达顺序追加的 CSV 可能个别乱序：稳定排序保持同时间的原顺序
+        const auto later = [](const Tick& a, const Tick& b) { return sim_time(a) < sim_time(b); };
+        for (size_t i = first + 1; i < out.size(); ++i)
+            if (later(out[i], out[i - 1])) ++stats.out_of_order;
+        if (stats.out_of_order) std::stable_sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(), later);
+        return true;
+    }
+
+private:
+    enum Column : uint8_t {
+        kIgnore,
+        kExchange,
+        kDatetime,
+        kLast,
+        kVolume,
+        kTurnover,
+        kOpenInterest,
+        kBid,
+        kBidVolume,
+        kAsk,
+        kAskVolume,
+        kOpen,
+        kHigh,
+        kLow,
+        kPreClose,
+        kPreSettlement,
+    };
+
+    struct Field {
+        const char* data;
+        size_t size;
+    };
+
+    /// 读一行到 fields_；带引号的字段反转义到 scratch_。格式错误（引号未闭合）返回 false
+    bool read_row(const char*& p, const char* end) {
+        fields_.clear();
+        scratch_.clear();
+        quoted_.clear();
+        while (true) {
+            if (p < end && *p == '"') {
+                // 引号字段：反转义到 scratch_，先记偏移（scratch_ 可能扩容）
+                const size_t off = scratch_.size();
+                ++p;
+                bool closed = false;
+                while (p < end) {
+                    if (*p == '"') {
+                        if (p + 1 < end && p[1] == '"') {
+                            scratch_.push_back('"');
+                            p += 2;
+                            continue;
+                        }
+                        ++p;
+                        closed = true;
+                        break;
+                    }
+                    scratch_.push_back(*p++);
+                }
+                if (!closed) {
+                    p = end;
+                    return false;
+                }
+                quoted_.push_back(fields_.size());
+                fields_.push_back(Field{nullptr, off});
+                if (p < end && *p != ',' && *p != '\r' && *p != '\n') {
+                    skip_line(p, end);
+                    return false;
+                }
+            } else {
+                const char* q = csv_find_special(p, end);
+                if (q < end && *q == '"') {
+                    skip_line(p, end);
+                    return false;
+                }
+                fields_.push_back(Field{p, static_cast<size_t>(q - p)});
+                p = q;
+            }
+            if (p >= end) break;
+            if (*p == ',') {
+                ++p;
+                continue;
+            }
+            if (*p == '\r') ++p;
+            if (p < end && *p == '\n') ++p;
+            break;
+        }
+        // scratch_ 定型后再回填引号字段的指针
+        for (size_t i = 0; i < quoted_.size(); ++i) {
+            Field& f = fields_[quoted_[i]];
+            const size_t off = f.size;
+            const size_t next = i + 1 < quoted_.size() ? fields_[quoted_[i + 1]].size : scratch_.size();
+            f.data = scratch_.data() + off;
+            f.size = next - off;
+        }
+        return true;
+    }
+
+    static void skip_line(const char*& p, const char* end) {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+
+    bool map_header() {
+        static const struct {
+            const char* name;
+            Column column;
+        } kNames[] = {
+            {"exchange", kExchange},          {"datetime", kDatetime},        {"last_price", kLast},
+            {"volume", kVolume},              {"turnover", kTurnover},        {"open_interest", kOpenInterest},
+            {"bid_price_1", kBid},            {"bid_volume_1", kBidVolume},   {"ask_price_1", kAsk},
+            {"ask_volume_1", kAskVolume},     {"open_price", kOpen},          {"high_price", kHigh},
+            {"low_price", kLow},              {"pre_close", kPreClose},       {"pre_settlement", kPreSettlement},
+        };
+        columns_.assign(fields_.size(), kIgnore);
+        bool has_datetime = false;
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            for (const auto& n : kNames) {
+                if (fields_[i].size == std::strlen(n.name) && std::memcmp(fields_[i].data, n.name, fields_[i].size) == 0) {
+                    columns_[i] = n.column;
+                    has_datetime |= n.column == kDatetime;
+                    break;
+                }
+            }
+        }
+        return has_datetime;
+    }
+
+    /// 与 Python float() 一致：空串为 0，允许前导 '+'
+    static bool parse_double(const Field& f, double& v) {
+        if (f.size == 0) {
+            v = 0.0;
+            return true;
+        }
+        const char* b = f.data;
+        const char* e = f.data + f.size;
+        if (*b == '+') ++b;
+        const auto r = std::from_chars(b, e, v);
+        return r.ec == std::errc() && r.ptr == e;
+    }
+
+    /// 与 FileStorage.load 的 int(float(v)) 一致（向零截断）
+    static bool parse_int(const Field& f, int64_t& v) {
+        double d = 0.0;
+        if (!parse_double(f, d) || !(d > -9.2e18 && d < 9.2e18)) return false;
+        v = static_cast<int64_t>(d);
+        return true;
+    }
+
+    static bool digits(const char* s, int n, int& v) {
+        v = 0;
+        for (int i = 0; i < n; ++i) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            v = v * 10 + (s[i] - '0');
+        }
+        return true;
+    }
+
+    /// YYYY-MM-DD[T ]HH:MM:SS[.ffffff]
+    static bool parse_datetime(const Field& f, Tick& t) {
+        const char* s = f.data;
+        if (f.size < 19 || s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') || s[13] != ':' ||
+            s[16] != ':')
+            return false;
+        int y, mo, d, h, mi, sec, us = 0;
+        if (!digits(s, 4, y) || !digits(s + 5, 2, mo) || !digits(s + 8, 2, d) || !digits(s + 11, 2, h) ||
+            !digits(s + 14, 2, mi) || !digits(s + 17, 2, sec))
+            return false;
+        if (f.size > 19) {
+            const int n = static_cast<int>(f.size) - 20;
+            if (s[19] != '.' || n < 1 || n > 6 || !digits(s + 20, n, us)) return false;
+            for (int i = n; i < 6; ++i) us *= 10;
+        }
+        if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || sec > 59) return false;
+        t.trade_date = static_cast<uint32_t>(y * 10000 + mo * 100 + d);
+        t.time_us = make_time_us(h, mi, sec, us);
+        return true;
+    }
+
+    bool fill(Tick& t) const {
+        bool has_time = false;
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            const Field& f = fields_[i];
+            bool ok = true;
+            switch (columns_[i]) {
+                case kIgnore: break;
+                case kExchange: t.exchange = exchange_from_name(f.data, f.size); break;
+                case kDatetime: ok = has_time = parse_datetime(f, t); break;
+                case kLast: ok = parse_double(f, t.last_price); break;
+                case kVolume: ok = parse_int(f, t.volume); break;
+                case kTurnover: ok = parse_double(f, t.turnover); break;
+                case kOpenInterest: ok = parse_double(f, t.open_interest); break;
+                case kBid: ok = parse_double(f, t.bid_price_1); break;
+                case kBidVolume: ok = parse_int(f, t.bid_volume_1); break;
+                case kAsk: ok = parse_double(f, t.ask_price_1); break;
+                case kAskVolume: ok = parse_int(f, t.ask_volume_1); break;
+                case kOpen: ok = parse_double(f, t.open_price); break;
+                case kHigh: ok = parse_double(f, t.high_price); break;
+                case kLow: ok = parse_double(f, t.low_price); break;
+                case kPreClose: ok = parse_double(f, t.pre_close); break;
+                case kPreSettlement: ok = parse_double(f, t.pre_settlement); break;
+            }
+            if (!ok) return false;
+        }
+        return has_time;
+    }
+
+    std::vector<Field> fields_;
+    std::vector<size_t> quoted_;
+    std::vector<Column> columns_;
+    std::string scratch_;
+};
+
+/// 整个文件读入 buf（复用容量）
+inline bool read_whole_file(const char* path, std::string& buf) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    buf.resize(static_cast<size_t>(st.st_size));
+    size_t done = 0;
+    while (done < buf.size()) {
+        const ssize_t n = ::read(fd, &buf[done], buf.size() - done);
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    buf.resize(done);
+    return true;
+}
+
+/// 并行导入同一天的各合约 CSV（paths 与 symbols 一一对应），写出 out_path；threads 为 0 时取硬件线程数
+inline bool import_csv_day(const std::vector<std::string>& paths, const std::vector<std::string>& symbols,
+                           const char* out_path, unsigned threads, CsvImportStats& stats) {
+    const size_t n = paths.size();
+    std::vector<std::vector<Tick>> per_file(n);
+    std::vector<CsvImportStats> per_stats(n);
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        CsvTickParser parser;
+        std::string buf;
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+            CsvImportStats& s = per_stats[i];
+            s.files = 1;
+            if (!read_whole_file(paths[i].c_str(), buf)) {
+                s.failed_files = 1;
+                continue;
+            }
+            s.bytes = buf.size();
+            if (!parser.parse(buf.data(), buf.size(), static_cast<int32_t>(i), per_file[i], s)) {
+                s.failed_files = 1;
+                per_file[i].clear();
+            }
+        }
+    };
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(n, 1)));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+    for (const CsvImportStats& s : per_stats) stats.add(s);
+
+    std::vector<TickSpan> spans;
+    size_t total = 0;
+    for (const std::vector<Tick>& v : per_file) {
+        spans.push_back(TickSpan{v.data(), v.size()});
+        total += v.size();
+    }
+    std::vector<Tick> merged;
+    merged.reserve(total);
+    std::vector<int32_t> file_ids(n, -1);
+    std::string names;
+    TickMerger merger(std::move(spans));
+    while (const Tick* t = merger.next()) {
+        int32_t& id = file_ids[static_cast<size_t>(t->instrument_id)];
+        if (id < 0) {
+            id = static_cast<int32_t>(names.size() / kTickFileSymbolLen);
+            const std::string& s = symbols[static_cast<size_t>(t->instrument_id)];
+            const size_t len = std::min(s.size(), kTickFileSymbolLen - 1);
+            names.append(s.data(), len);
+            names.append(kTickFileSymbolLen - len, '\0');
+        }
+        merged.push_back(*t);
+        merged.back().instrument_id = id;
+    }
+    return write_tick_file(out_path, merged.data(), merged.size(), names.data(), names.size() / kTickFileSymbolLen);
+}
+
+}  // namespace fq
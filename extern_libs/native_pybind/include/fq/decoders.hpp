@@ -0,0 +1,248 @@
+/**
+ * fq/decoders.hpp: 原始行情帧 -> fq::Tick 解码
+ *
+ * 结构体布局与 Python 侧保持一致：
+ * - NanoGfexL2MdType：src/api/gfex_exanic_api.py 中 _GFEX_L2_FMT（pack 1）
+ * - DCEL1_Quotation / CZCEL2_Quotation：src/api/zy_zmq_api.py 中的 ctypes 定义（自然对齐）
+ * 字段语义与 DataParser._parse_gfex_l2 / _parse_dce_l1 / _parse_czce_l1 相同。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+#pragma pack(push, 1)
+struct NanoGfexL2MdType {
+    uint32_t flag;
+    char contract_name[20];
+    double last_price;
+    uint32_t last_match_qty;
+    uint32_t match_total_qty;
+    double turn_over;
+    uint32_t open_interest;
+    int32_t open_interest_change;
+    char gen_time[16];
+    struct Level {
+        double px;
+        uint32_t vol;
+    } bid[5], ask[5];
+    int32_t buy_imply_qty[5];
+    int32_t sell_imply_qty[5];
+};
+#pragma pack(pop)
+static_assert(sizeof(NanoGfexL2MdType) == 232, "NanoGfexL2MdType must match _GFEX_L2_FMT");
+
+struct DCEL1Quotation {
+    int32_t LocalTimeStamp;
+    char QuotationFlag[4];
+    int32_t TradeDate;
+    int32_t Time;
+    char Symbol[130];
+    uint64_t RoutineNo;
+    char SecurityName[180];
+    double PreClosePrice;
+    double PreSettlePrice;
+    uint64_t PreTotalPosition;
+    double OpenPrice;
+    double PriceUpLimit;
+    double PriceDownLimit;
+    double LastPrice;
+    double AveragePrice;
+    double HighPrice;
+    double LowPrice;
+    double LifeHigh;
+    double LifeLow;
+    uint64_t LastMatchQty;
+    uint64_t TotalVolume;
+    double TotalAmount;
+    uint64_t TotalPosition;
+    int64_t InterestChg;
+    double BuyPrice01;
+    uint64_t BuyVolume01;
+    uint64_t BidImplyQty01;
+    double SellPrice01;
+    uint64_t SellVolume01;
+    uint64_t AskImplyQty01;
+    double ClosePrice;
+    double SettlePrice;
+    uint64_t BatchNo;
+};
+static_assert(sizeof(DCEL1Quotation) == 552, "DCEL1Quotation must match ctypes DCEL1_Quotation");
+
+struct CZCEL2Quotation {
+    int32_t LocalTimeStamp;
+    char QuotationFlag[4];
+    uint32_t TradeDate;
+    char Symbol[40];
+    int64_t Time;
+    int32_t PriceSize;
+    int32_t OpenPrice;
+    int32_t LastPrice;
+    int32_t AveragePrice;
+    int32_t HighPrice;
+    int32_t LowPrice;
+    int32_t LifeHigh;
+    int32_t LifeLow;
+    int32_t TotalVolume;
+    int64_t TotalAmount;
+    int32_t TotalPosition;
+    int32_t SettlePrice;
+    int32_t TotalBuyOrderVolume;
+    int32_t WtAvgBuyPrice;
+    int32_t TotalSellOrderVolume;
+    int32_t WtAvgSellPrice;
+    int32_t DeriveBidPrice;
+    int32_t DeriveAskPrice;
+    int32_t DeriveBidLot;
+    int32_t DeriveAskLot;
+};
+static_assert(sizeof(CZCEL2Quotation) == 152, "CZCEL2Quotation must match ctypes CZCEL2_Quotation");
+
+/// 本地日期 YYYYMMDD 与当日微秒（GFEX gen_time 只有时分秒，日期取本地当天）
+inline void local_now(uint32_t& date, int64_t& time_us) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    struct tm lt;
+    localtime_r(&ts.tv_sec, &lt);
+    date = static_cast<uint32_t>((lt.tm_year + 1900) * 10000 + (lt.tm_mon + 1) * 100 + lt.tm_mday);
+    time_us = make_time_us(lt.tm_hour, lt.tm_min, lt.tm_sec, static_cast<int>(ts.tv_nsec / 1000));
+}
+
+/// 解析 "HH:MM:SS" 或 "HH:MM:SS.f{1,6}"，失败返回 false
+inline bool parse_hms(const char* s, size_t n, int64_t& time_us) {
+    const void* nul = std::memchr(s, '\0', n);
+    if (nul) n = static_cast<size_t>(static_cast<const char*>(nul) - s);
+    if (n < 8 || s[2] != ':' || s[5] != ':') return false;
+    int v[6] = {0};
+    const size_t pos[6] = {0, 1, 3, 4, 6, 7};
+    for (int i = 0; i < 6; ++i) {
+        const char c = s[pos[i]];
+        if (c < '0' || c > '9') return false;
+        v[i] = c - '0';
+    }
+    int micros = 0;
+    if (n > 8) {
+        if (s[8] != '.') return false;
+        int digits = 0;
+        for (size_t i = 9; i < n && digits < 6; ++i, ++digits) {
+            const char c = s[i];
+            if (c < '0' || c > '9') break;
+            micros = micros * 10 + (c - '0');
+        }
+        if (digits == 0) return false;
+        for (; digits < 6; ++digits) micros *= 10;
+    }
+    const int hour = v[0] * 10 + v[1];
+    const int minute = v[2] * 10 + v[3];
+    const int second = v[4] * 10 + v[5];
+    if (hour > 23 || minute > 59 || second > 59) return false;
+    time_us = make_time_us(hour, minute, second, micros);
+    return true;
+}
+
+/// HHMMSSmmm 整数 -> 当日微秒
+inline int64_t hhmmssmmm_to_us(int64_t t) {
+    const int ms = static_cast<int>(t % 1000);
+    t /= 1000;
+    const int second = static_cast<int>(t % 100);
+    t /= 100;
+    const int minute = static_cast<int>(t % 100);
+    const int hour = static_cast<int>(t / 100);
+    return make_time_us(hour, minute, second, ms * 1000);
+}
+
+inline bool decode_gfex_l2(const char* buf, size_t n, SymbolTable& symbols, Tick& out) {
+    if (n < sizeof(NanoGfexL2MdType)) return false;
+    NanoGfexL2MdType md;
+    std::memcpy(&md, buf, sizeof(md));
+    out.instrument_id = symbols.intern(md.contract_name, sizeof(md.contract_name));
+    if (out.instrument_id == kInvalidInstrument) return false;
+    out.exchange = Exchange::kGFEX;
+    out.source = Source::kGFEX;
+    out.flags = 0;
+    out.reserved = 0;
+    int64_t now_us = 0;
+    local_now(out.trade_date, now_us);
+    if (!parse_hms(md.gen_time, sizeof(md.gen_time), out.time_us)) out.time_us = now_us;
+    out.last_price = md.last_price;
+    out.volume = md.match_total_qty;
+    out.turnover = md.turn_over;
+    out.open_interest = md.open_interest;
+    out.bid_price_1 = md.bid[0].px;
+    out.bid_volume_1 = md.bid[0].vol;
+    out.ask_price_1 = md.ask[0].px;
+    out.ask_volume_1 = md.ask[0].vol;
+    out.open_price = 0.0;
+    out.high_price = 0.0;
+    out.low_price = 0.0;
+    out.pre_close = 0.0;
+    out.pre_settlement = 0.0;
+    return true;
+}
+
+inline bool decode_dce_l1(const char* buf, size_t n, SymbolTable& symbols, Tick& out) {
+    if (n != sizeof(DCEL1Quotation)) return false;
+    DCEL1Quotation q;
+    std::memcpy(&q, buf, sizeof(q));
+    out.instrument_id = symbols.intern(q.Symbol, sizeof(q.Symbol));
+    if (out.instrument_id == kInvalidInstrument) return false;
+    out.exchange = Exchange::kDCE;
+    out.source = Source::kZhengyi;
+    out.flags = 0;
+    out.reserved = 0;
+    out.trade_date = static_cast<uint32_t>(q.TradeDate);
+    out.time_us = hhmmssmmm_to_us(q.Time);
+    out.last_price = q.LastPrice;
+    out.volume = static_cast<int64_t>(q.TotalVolume);
+    out.turnover = q.TotalAmount;
+    out.open_interest = static_cast<double>(q.TotalPosition);
+    out.bid_price_1 = q.BuyPrice01;
+    out.bid_volume_1 = static_cast<int64_t>(q.BuyVolume01);
+    out.ask_price_1 = q.SellPrice01;
+    out.ask_volume_1 = static_cast<int64_t>(q.SellVolume01);
+    out.open_price = q.OpenPrice;
+    out.high_price = q.HighPrice;
+    out.low_price = q.LowPrice;
+    out.pre_close = q.PreClosePrice;
+    out.pre_settlement = q.PreSettlePrice;
+    return true;
+}
+
+inline bool decode_czce_l1(const char* buf, size_t n, SymbolTable& symbols, Tick& out) {
+    if (n != sizeof(CZCEL2Quotation)) return false;
+    CZCEL2Quotation q;
+    std::memcpy(&q, buf, sizeof(q));
+    out.instrument_id = symbols.intern(q.Symbol, sizeof(q.Symbol));
+    if (out.instrument_id == kInvalidInstrument) return false;
+    double scale = 1.0;
+    for (int i = 0; i < q.PriceSize; ++i) scale *= 10.0;
+    out.exchange = Exchange::kCZCE;
+    out.source = Source::kZhengyi;
+    out.flags = 0;
+    out.reserved = 0;
+    out.trade_date = q.TradeDate;
+    out.time_us = hhmmssmmm_to_us(q.Time / 1000);
+    out.last_price = q.LastPrice / scale;
+    out.volume = q.TotalVolume;
+    out.turnover = static_cast<double>(q.TotalAmount);
+    out.open_interest = q.TotalPosition;
+    out.bid_price_1 = q.DeriveBidPrice ? q.DeriveBidPrice / scale : 0.0;
+    out.bid_volume_1 = q.DeriveBidLot;
+    out.ask_price_1 = q.DeriveAskPrice ? q.DeriveAskPrice / scale : 0.0;
+    out.ask_volume_1 = q.DeriveAskLot;
+    out.open_price = q.OpenPrice / scale;
+    out.high_price = q.HighPrice / scale;
+    out.low_price = q.LowPrice / scale;
+    out.pre_close = 0.0;
+    out.pre_settlement = q.SettlePrice / scale;
+    return true;
+}
+
+}  // namespace fq
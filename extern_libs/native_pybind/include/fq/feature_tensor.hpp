@@ -0,0 +1,381 @@
+/**
+ * fq/feature_tensor.hpp: 声明式逐笔特征提取 + 共享内存环形特征张量
+ *
+ * 特征列表由名称声明（见 parse_feature），每条行情按列表计算一行 float32 特征，写入 POSIX 共享内存中的
+ * 预分配环形张量；推理进程映射同一区域，按 write_seq 取连续行的 numpy 视图，无解析、无复制。
+ *
+ * 共享区布局（偏移均写在文件头，读取方无需重算）：
+ *   - 文件头 4096 字节：magic、version、特征数、容量（行，2 的幂）、write_seq（已提交行数）、
+ *     各数组偏移，以及以 '\n' 分隔的特征名
+ *   - times：int64[容量]，sim_time（1970-01-01 起的天数 * 86400e6 + 当日微秒）
+ *   - instrument_ids：int32[容量]
+ *   - values：float32[容量 × 特征数]，行主序
+ * 第 seq 行位于下标 seq % 容量。单写者：先写行再以 release 语义推进 write_seq；
+ * 第 write_seq 行的槽位（即第 write_seq - 容量 行）随时可能正在被改写，因此只有最近 容量 - 1 行可读：
+ * 读取方用完一段视图后若 write_seq - 容量 + 1 > 该段起始 seq，说明该段已被覆盖或正被改写，需丢弃。
+ * 写者启动时重建共享区（shm_unlink 后新建），已映射的读取方需重新打开。
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fq/backtest.hpp"
+#include "fq/spsc_ring.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+enum class FeatureKind : uint8_t {
+    kLastPrice,
+    kMidPrice,
+    kSpread,
+    kBidPrice,
+    kAskPrice,
+    kBidVolume,
+    kAskVolume,
+    kImbalance,       ///< (买量 - 卖量) / (买量 + 卖量)
+    kVolumeDelta,     ///< 与本合约上一条行情的成交量差
+    kOpenInterest,
+    kReturn,          ///< log(当前中间价 / horizon 前的 as-of 中间价)
+    kTimeOfDay,       ///< 当日秒数
+    kSessionElapsed,  ///< 距本合约时段开始（首条或空档后首条）的秒数
+};
+
+struct FeatureSpec {
+    FeatureKind kind;
+    int64_t horizon_us;  ///< 仅 kReturn
+};
+
+/**
+ * 解析特征名：last_price、mid_price、spread、bid_price_1、ask_price_1、bid_volume_1、ask_volume_1、
+ * imbalance、volume_delta、open_interest、time_of_day、session_elapsed，以及 return:<秒>（如 return:0.5）。
+ * @return 名称无效返回 false
+ */
+inline bool parse_feature(const std::string& name, FeatureSpec& spec) {
+    static const struct {
+        const char* name;
+        FeatureKind kind;
+    } kNames[] = {
+        {"last_price", FeatureKind::kLastPrice},     {"mid_price", FeatureKind::kMidPrice},
+        {"spread", FeatureKind::kSpread},            {"bid_price_1", FeatureKind::kBidPrice},
+        {"ask_price_1", FeatureKind::kAskPrice},     {"bid_volume_1", FeatureKind::kBidVolume},
+        {"ask_volume_1", FeatureKind::kAskVolume},   {"imbalance", FeatureKind::kImbalance},
+        {"volume_delta", FeatureKind::kVolumeDelta}, {"open_interest", FeatureKind::kOpenInterest},
+        {"time_of_day", FeatureKind::kTimeOfDay},    {"session_elapsed", FeatureKind::kSessionElapsed},
+    };
+    spec.horizon_us = 0;
+    for (const auto& n : kNames) {
+        if (name == n.name) {
+            spec.kind = n.kind;
+            return true;
+        }
+    }
+    static const char kReturnPrefix[] = "return:";
+    const size_t plen = sizeof(kReturnPrefix) - 1;
+    if (name.compare(0, plen, kReturnPrefix) != 0 || name.size() == plen) return false;
+    char* end = nullptr;
+    const double seconds = std::strtod(name.c_str() + plen, &end);
+    if (*end != '\0' || !(seconds > 0) || seconds > 86400.0) return false;
+    spec.kind = FeatureKind::kReturn;
+    spec.horizon_us = static_cast<int64_t>(std::llround(seconds * 1e6));
+    return spec.horizon_us > 0;
+}
+
+/**
+ * 逐合约状态的特征计算。return 特征按合约保存最近 history 条 (时间, 中间价)，
+ * 每个 horizon 的 as-of 游标只前进，单条行情摊还 O(1)；历史不足以覆盖 horizon 时为 NaN。
+ */
+class FeatureExtractor {
+public:
+    FeatureExtractor(std::vector<FeatureSpec> specs, size_t instruments, size_t history, int64_t session_gap_us)
+        : specs_(std::move(specs)),
+          instruments_(instruments == 0 ? 1 : instruments),
+          history_(next_pow2(history < 2 ? 2 : history)),
+          session_gap_us_(session_gap_us <= 0 ? 1 : session_gap_us),
+          state_(new State[instruments_]) {
+        for (const FeatureSpec& s : specs_)
+            if (s.kind == FeatureKind::kReturn) horizons_.push_back(s.horizon_us);
+        if (!horizons_.empty()) {
+            hist_time_.reset(new int64_t[instruments_ * history_]);
+            hist_mid_.reset(new double[instruments_ * history_]);
+            anchors_.reset(new uint64_t[instruments_ * horizons_.size()]);
+        }
+        reset();
+    }
+
+    size_t features() const { return specs_.size(); }
+    size_t instruments() const { return instruments_; }
+    const std::vector<FeatureSpec>& specs() const { return specs_; }
+
+    /// 合约是否在范围内（compute 只接受这些行情）
+    bool accepts(const Tick& t) const {
+        return t.instrument_id >= 0 && static_cast<size_t>(t.instrument_id) < instruments_;
+    }
+
+    /// 计算一行特征；合约超出范围返回 false（不写 out）
+    bool compute(const Tick& t, float* out) {
+        if (!accepts(t)) return false;
+        const size_t iid = static_cast<size_t>(t.instrument_id);
+        State& st = state_[iid];
+        const int64_t ts = sim_time(t);
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const bool two_sided = t.bid_price_1 > 0 && t.ask_price_1 > 0;
+        const double mid = two_sided ? 0.5 * (t.bid_price_1 + t.ask_price_1) : t.last_price;
+        if (st.count == 0 || ts - st.last_time > session_gap_us_) st.session_start = ts;
+        if (!horizons_.empty() && mid > 0) push_history(iid, st, ts, mid);
+
+        size_t h = 0;
+        for (size_t f = 0; f < specs_.size(); ++f) {
+            double v = nan;
+            switch (specs_[f].kind) {
+                case FeatureKind::kLastPrice: v = t.last_price; break;
+                case FeatureKind::kMidPrice: v = mid; break;
+                case FeatureKind::kSpread: v = two_sided ? t.ask_price_1 - t.bid_price_1 : nan; break;
+                case FeatureKind::kBidPrice: v = t.bid_price_1; break;
+                case FeatureKind::kAskPrice: v = t.ask_price_1; break;
+                case FeatureKind::kBidVolume: v = static_cast<double>(t.bid_volume_1); break;
+                case FeatureKind::kAskVolume: v = static_cast<double>(t.ask_volume_1); break;
+                case FeatureKind::kImbalance: {
+                    const double b = static_cast<double>(t.bid_volume_1);
+                    const double a = static_cast<double>(t.ask_volume_1);
+                    v = b + a > 0 ? (b - a) / (b + a) : nan;
+                    break;
+                }
+                case FeatureKind::kVolumeDelta:
+                    // 累计量回退（换日）时以当前累计量计
+                    if (st.count) v = static_cast<double>(t.volume >= st.volume ? t.volume - st.volume : t.volume);
+                    break;
+                case FeatureKind::kOpenInterest: v = t.open_interest; break;
+                case FeatureKind::kReturn: {
+                    const double base = mid > 0 ? as_of(iid, st, h, ts - specs_[f].horizon_us) : nan;
+                    v = base > 0 ? std::log(mid / base) : nan;
+                    ++h;
+                    break;
+                }
+                case FeatureKind::kTimeOfDay: v = static_cast<double>(t.time_us) * 1e-6; break;
+                case FeatureKind::kSessionElapsed: v = static_cast<double>(ts - st.session_start) * 1e-6; break;
+            }
+            out[f] = static_cast<float>(v);
+        }
+        st.volume = t.volume;
+        st.last_time = ts;
+        ++st.count;
+        return true;
+    }
+
+    void reset() {
+        for (size_t i = 0; i < instruments_; ++i) state_[i] = State{};
+        if (anchors_) std::memset(anchors_.get(), 0, instruments_ * horizons_.size() * sizeof(uint64_t));
+    }
+
+private:
+    struct State {
+        uint64_t count = 0;
+        uint64_t hist = 0;  ///< 已写入的历史条数（环形下标为 hist % history_）
+        int64_t volume = 0;
+        int64_t last_time = 0;
+        int64_t session_start = 0;
+    };
+
+    void push_history(size_t iid, State& st, int64_t ts, double mid) {
+        const size_t k = iid * history_ + (st.hist & (history_ - 1));
+        hist_time_[k] = ts;
+        hist_mid_[k] = mid;
+        ++st.hist;
+    }
+
+    /// 时间 <= target 的最近一条历史中间价（不含已被覆盖的部分）；没有返回 NaN
+    double as_of(size_t iid, const State& st, size_t h, int64_t target) {
+        if (st.hist == 0) return std::numeric_limits<double>::quiet_NaN();
+        uint64_t& a = anchors_[iid * horizons_.size() + h];
+        const uint64_t oldest = st.hist > history_ ? st.hist - history_ : 0;
+        if (a < oldest) a = oldest;
+        const int64_t* times = hist_time_.get() + iid * history_;
+        const size_t mask = history_ - 1;
+        while (a + 1 < st.hist && times[(a + 1) & mask] <= target) ++a;
+        if (times[a & mask] > target) return std::numeric_limits<double>::quiet_NaN();
+        return hist_mid_[iid * history_ + (a & mask)];
+    }
+
+    std::vector<FeatureSpec> specs_;
+    std::vector<int64_t> horizons_;
+    size_t instruments_;
+    size_t history_;
+    int64_t session_gap_us_;
+    std::unique_ptr<State[]> state_;
+    std::unique_ptr<int64_t[]> hist_time_;
+    std::unique_ptr<double[]> hist_mid_;
+    std::unique_ptr<uint64_t[]> anchors_;  ///< [合约][horizon] as-of 游标（历史序号）
+};
+
+constexpr char kFeatureMagic[8] = {'F', 'Q', 'F', 'E', 'A', 'T', '0', '1'};
+constexpr uint32_t kFeatureVersion = 1;
+constexpr size_t kFeatureHeaderBytes = 4096;
+
+struct FeatureTensorHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t features;
+    uint64_t capacity;        ///< 行数（2 的幂）
+    uint64_t write_seq;       ///< 已提交行数（原子访问）
+    uint64_t times_offset;    ///< int64[capacity]
+    uint64_t iids_offset;     ///< int32[capacity]
+    uint64_t values_offset;   ///< float32[capacity × features]
+    char pad[8];
+    char names[kFeatureHeaderBytes - 64];  ///< '\n' 分隔的特征名，零结尾
+};
+static_assert(sizeof(FeatureTensorHeader) == kFeatureHeaderBytes, "FeatureTensorHeader layout");
+static_assert(sizeof(std::atomic<uint64_t>) == 8, "atomic layout");
+
+/// 共享内存环形特征张量（写端）
+class FeatureTensor {
+public:
+    FeatureTensor() = default;
+    ~FeatureTensor() { close(); }
+    FeatureTensor(const FeatureTensor&) = delete;
+    FeatureTensor& operator=(const FeatureTensor&) = delete;
+
+    /**
+     * 重建名为 name 的共享内存区（shm_open，如 "/fq_features"）。
+     * @param names 特征名（写入文件头，总长不超过 4031 字节）
+     * @return 失败（权限、尺寸、名称过长）返回 false 且不持有映射
+     */
+    bool create(const std::string& name, const std::vector<std::string>& names, size_t capacity) {
+        close();
+        std::string joined;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (i) joined.push_back('\n');
+            joined += names[i];
+        }
+        if (names.empty() || joined.size() >= sizeof(FeatureTensorHeader::names)) return false;
+        const size_t cap = next_pow2(capacity < 2 ? 2 : capacity);
+        const size_t times_off = kFeatureHeaderBytes;
+        const size_t iids_off = times_off + align64(cap * sizeof(int64_t));
+        const size_t values_off = iids_off + align64(cap * sizeof(int32_t));
+        const size_t size = values_off + align64(cap * names.size() * sizeof(float));
+
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        base_ = static_cast<char*>(p);
+        size_ = size;
+        name_ = name;
+        capacity_ = cap;
+        mask_ = cap - 1;
+        features_ = names.size();
+        times_ = reinterpret_cast<int64_t*>(base_ + times_off);
+        iids_ = reinterpret_cast<int32_t*>(base_ + iids_off);
+        values_ = reinterpret_cast<float*>(base_ + values_off);
+
+        FeatureTensorHeader* h = header();
+        h->version = kFeatureVersion;
+        h->features = static_cast<uint32_t>(features_);
+        h->capacity = cap;
+        h->times_offset = times_off;
+        h->iids_offset = iids_off;
+        h->values_offset = values_off;
+        std::memcpy(h->names, joined.data(), joined.size());
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(h->magic, kFeatureMagic, sizeof(kFeatureMagic));
+        return true;
+    }
+
+    void close() {
+        if (base_) ::munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+        seq_ = 0;
+    }
+
+    /// 删除共享区名称（已映射的读取方不受影响）
+    bool unlink() { return !name_.empty() && ::shm_unlink(name_.c_str()) == 0; }
+
+    /// 取下一行特征值的写入位置（提交前对读取方不可见，读取方也不会把该槽位当作有效行）
+    float* row() { return values_ + (seq_ & mask_) * features_; }
+
+    /// 写入 row() 所在行的时间与合约并提交
+    void commit(int64_t time, int32_t iid) {
+        const size_t k = seq_ & mask_;
+        times_[k] = time;
+        iids_[k] = iid;
+        write_seq()->store(++seq_, std::memory_order_release);
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+    uint64_t seq() const { return seq_; }
+    size_t capacity() const { return capacity_; }
+    size_t features() const { return features_; }
+    const std::string& name() const { return name_; }
+
+private:
+    static size_t align64(size_t n) { return (n + 63) & ~static_cast<size_t>(63); }
+
+    FeatureTensorHeader* header() const { return reinterpret_cast<FeatureTensorHeader*>(base_); }
+    std::atomic<uint64_t>* write_seq() const {
+        return reinterpret_cast<std::atomic<uint64_t>*>(&header()->write_seq);
+    }
+
+    char* base_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    size_t features_ = 0;
+    uint64_t seq_ = 0;
+    int64_t* times_ = nullptr;
+    int32_t* iids_ = nullptr;
+    float* values_ = nullptr;
+};
+
+/// 特征提取 + 写入共享张量
+class FeatureTensorWriter {
+public:
+    FeatureTensorWriter(std::vector<FeatureSpec> specs, size_t instruments, size_t history, int64_t session_gap_us)
+        : extractor_(std::move(specs), instruments, history, session_gap_us) {}
+
+    bool open(const std::string& name, const std::vector<std::string>& names, size_t capacity) {
+        return names.size() == extractor_.features() && tensor_.create(name, names, capacity);
+    }
+
+    /// 计算并提交一行；合约超出范围或未打开时返回 false，且不触碰环形张量
+    bool on_tick(const Tick& t) {
+        if (!tensor_.is_open() || !extractor_.accepts(t)) return false;
+        extractor_.compute(t, tensor_.row());
+        tensor_.commit(sim_time(t), t.instrument_id);
+        return true;
+    }
+
+    FeatureExtractor& extractor() { return extractor_; }
+    FeatureTensor& tensor() { return tensor_; }
+
+private:
+    FeatureExtractor extractor_;
+    FeatureTensor tensor_;
+};
+
+}  // namespace fq
@@ -0,0 +1,255 @@
+/**
+ * fq/hot_standby.hpp: 主备采集进程间的共享内存状态镜像
+ *
+ * 主进程（leader）把每批落盘的行情登记到 POSIX 共享内存区：
+ *   - 文件头：纪元 epoch（每次接管 +1）、leader pid、心跳（CLOCK_MONOTONIC ns）、journal_seq（累计落盘条数）
+ *   - 合约槽位：按合约代码开放寻址（进程各自的 instrument_id 不通用），每槽保存该合约最近落盘的
+ *     一条行情（64 字节 PackedTick，即主进程的快照缓存），以 seqlock 保护，备进程读取不加锁、不阻塞主进程
+ * 备进程连接同样的行情源并照常清洗，但不落盘，只保留最近的数据；检测到 leader 心跳超时或进程已退出时，
+ * 以 CAS 递增 epoch 抢占 leader（多个备进程时只有一个成功），把键（sim_time, 累计成交量）晚于镜像中
+ * 该合约最近落盘键的数据补写，journal_seq 接续，既不缺口也不重复。镜像在每批落盘之后登记：
+ * leader 恰好在落盘与登记之间退出时，该批会被补写一次（宁可重复一批，不留缺口）。
+ * 槽位中 PackedTick::instrument_id 存槽位下标，读取方按槽位内的合约代码映射回本进程的合约 ID；
+ * 镜像只用于补写判定与最新行情查询，read() 还原的 Tick 不含成交额、开高低等冷字段。
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "fq/backtest.hpp"
+#include "fq/packed_tick.hpp"
+#include "fq/reorder_buffer.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+constexpr char kStandbyMagic[8] = {'F', 'Q', 'H', 'A', 'S', 'H', 'M', '1'};
+constexpr uint32_t kStandbyVersion = 2;
+
+struct StandbyHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slots;          ///< 合约槽位数（2 的幂）
+    uint64_t epoch;          ///< 每次接管 +1
+    int64_t leader_pid;      ///< 当前 leader，0 为无
+    int64_t heartbeat_ns;    ///< leader 最近心跳（CLOCK_MONOTONIC）
+    uint64_t journal_seq;    ///< 累计落盘条数
+    uint64_t symbols;        ///< 已登记合约数
+    char pad[72];
+};
+static_assert(sizeof(StandbyHeader) == 128, "StandbyHeader layout");
+
+struct StandbySlot {
+    uint32_t seq;            ///< seqlock：奇数表示写入中
+    uint32_t used;           ///< 合约代码已写入
+    char symbol[32];         ///< 零填充合约代码
+    char pad[24];
+    PackedTick tick;         ///< 最近落盘的一条（独占第二条缓存行）
+};
+static_assert(sizeof(StandbySlot) == 128, "StandbySlot layout");
+static_assert(sizeof(std::atomic<uint64_t>) == 8 && sizeof(std::atomic<uint32_t>) == 4, "atomic layout");
+
+inline int64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline ReorderKey tick_key(const Tick& t) { return ReorderKey{sim_time(t), t.volume}; }
+
+class StandbyRegion {
+public:
+    StandbyRegion() = default;
+    ~StandbyRegion() { close(); }
+    StandbyRegion(const StandbyRegion&) = delete;
+    StandbyRegion& operator=(const StandbyRegion&) = delete;
+
+    /**
+     * 打开（必要时创建）名为 name 的共享内存区（shm_open，如 "/fq_standby"）。
+     * 已存在时按其文件头的槽位数映射，slots 仅用于新建（向上取 2 的幂）。
+     * @return 失败（权限、尺寸或文件头不符）返回 false 且不持有映射
+     */
+    bool open(const std::string& name, size_t slots) {
+        close();
+        size_t n = 1;
+        while (n < slots) n <<= 1;
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        const bool created = fd >= 0;
+        if (!created) {
+            if (errno != EEXIST) return false;
+            fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+            if (fd < 0) return false;
+        }
+        size_t size = sizeof(StandbyHeader) + n * sizeof(StandbySlot);
+        if (created) {
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                return false;
+            }
+        } else {
+            // 创建方可能尚未 ftruncate / 写完文件头：短暂等待
+            struct stat st;
+            for (int i = 0; i < 1000; ++i) {
+                if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(StandbyHeader)) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(StandbyHeader)) {
+                ::close(fd);
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base_ = static_cast<char*>(p);
+        size_ = size;
+        name_ = name;
+        StandbyHeader* h = header();
+        if (created) {
+            h->version = kStandbyVersion;
+            h->slots = static_cast<uint32_t>(n);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(h->magic, kStandbyMagic, sizeof(kStandbyMagic));
+            return true;
+        }
+        for (int i = 0; i < 1000 && std::memcmp(h->magic, kStandbyMagic, sizeof(kStandbyMagic)) != 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const bool valid = std::memcmp(h->magic, kStandbyMagic, sizeof(kStandbyMagic)) == 0 &&
+                           h->version == kStandbyVersion && h->slots && (h->slots & (h->slots - 1)) == 0 &&
+                           sizeof(StandbyHeader) + h->slots * sizeof(StandbySlot) <= size_;
+        if (!valid) close();
+        return valid;
+    }
+
+    void close() {
+        if (base_) ::munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    /// 删除共享内存名（已映射的进程不受影响）
+    bool unlink() const { return !name_.empty() && ::shm_unlink(name_.c_str()) == 0; }
+
+    bool is_open() const { return base_ != nullptr; }
+    size_t slots() const { return base_ ? header()->slots : 0; }
+
+    uint64_t epoch() const { return u64(&header()->epoch).load(std::memory_order_acquire); }
+    int64_t leader_pid() const { return static_cast<int64_t>(u64(&header()->leader_pid).load(std::memory_order_acquire)); }
+    int64_t heartbeat_ns() const {
+        return static_cast<int64_t>(u64(&header()->heartbeat_ns).load(std::memory_order_acquire));
+    }
+    uint64_t journal_seq() const { return u64(&header()->journal_seq).load(std::memory_order_acquire); }
+    uint64_t symbols() const { return u64(&header()->symbols).load(std::memory_order_acquire); }
+
+    void heartbeat(int64_t now_ns) {
+        u64(&header()->heartbeat_ns).store(static_cast<uint64_t>(now_ns), std::memory_order_release);
+    }
+
+    /// leader 存活：心跳未超时且进程仍存在
+    bool leader_alive(int64_t now_ns, int64_t timeout_ns) const {
+        const int64_t pid = leader_pid();
+        if (pid <= 0 || now_ns - heartbeat_ns() > timeout_ns) return false;
+        return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+    }
+
+    /// 以 CAS 把 epoch 从 expected 递增并登记为 leader；其他进程抢先时返回 false
+    bool claim(uint64_t expected_epoch, int64_t pid, int64_t now_ns) {
+        if (!u64(&header()->epoch).compare_exchange_strong(expected_epoch, expected_epoch + 1,
+                                                           std::memory_order_acq_rel)) {
+            return false;
+        }
+        heartbeat(now_ns);
+        u64(&header()->leader_pid).store(static_cast<uint64_t>(pid), std::memory_order_release);
+        return true;
+    }
+
+    void advance_journal(uint64_t n) { u64(&header()->journal_seq).fetch_add(n, std::memory_order_acq_rel); }
+
+    /// 合约代码 -> 槽位下标；不存在时 create 为 true 则登记（仅 leader 调用），槽位满返回 -1
+    int32_t find_slot(const SymbolKey& key, bool create) {
+        const uint32_t mask = header()->slots - 1;
+        uint32_t i = static_cast<uint32_t>(hash_symbol(key)) & mask;
+        for (uint32_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask) {
+            StandbySlot& s = slot(i);
+            if (!u32(&s.used).load(std::memory_order_acquire)) {
+                if (!create) return -1;
+                std::memcpy(s.symbol, key.bytes, sizeof(s.symbol));
+                u32(&s.used).store(1, std::memory_order_release);
+                u64(&header()->symbols).fetch_add(1, std::memory_order_acq_rel);
+                return static_cast<int32_t>(i);
+            }
+            if (std::memcmp(s.symbol, key.bytes, sizeof(s.symbol)) == 0) return static_cast<int32_t>(i);
+        }
+        return -1;
+    }
+
+    /// 写入槽位的最近落盘行情（单写者）
+    void publish(int32_t i, const Tick& t) {
+        StandbySlot& s = slot(static_cast<uint32_t>(i));
+        std::atomic<uint32_t>& seq = u32(&s.seq);
+        const uint32_t v = seq.load(std::memory_order_relaxed);
+        seq.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        pack_tick(t, realtime_ns(), s.tick);
+        s.tick.instrument_id = i;
+        seq.store(v + 2, std::memory_order_release);
+    }
+
+    /// 一致地读取槽位行情；槽位尚无行情，或写者在写入中途退出（seq 长时间为奇数）返回 false
+    bool read(int32_t i, Tick& out) const {
+        const StandbySlot& s = slot(static_cast<uint32_t>(i));
+        const std::atomic<uint32_t>& seq = u32(&s.seq);
+        for (uint32_t spins = 0; spins < kReadSpins; ++spins) {
+            const uint32_t a = seq.load(std::memory_order_acquire);
+            if (a & 1u) continue;
+            const PackedTick p = s.tick;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == a) {
+                if (a == 0) return false;
+                unpack_tick(p, nullptr, out);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 槽位中的合约代码（零结尾）
+    const char* symbol(int32_t i) const { return slot(static_cast<uint32_t>(i)).symbol; }
+
+private:
+    static constexpr uint32_t kReadSpins = 1u << 20;
+
+    StandbyHeader* header() const { return reinterpret_cast<StandbyHeader*>(base_); }
+    StandbySlot& slot(uint32_t i) const {
+        return reinterpret_cast<StandbySlot*>(base_ + sizeof(StandbyHeader))[i];
+    }
+    static std::atomic<uint64_t>& u64(const void* p) {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(const_cast<void*>(p));
+    }
+    static std::atomic<uint32_t>& u32(const void* p) {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(const_cast<void*>(p));
+    }
+
+    char* base_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+};
+
+}  // namespace fq
@@ -0,0 +1,205 @@
+/**
+ * fq/packed_tick.hpp: 64 字节缓存行对齐的规范行情记录 + 5 档深度扩展记录
+ *
+ * fq::Tick（128 字节，两条缓存行）保留全部标准化字段，供解码槽位、日文件与 dict 物化使用；
+ * 原生侧跨线程 / 跨进程缓存的最新行情使用 PackedTick：一条缓存行放下合约、行情源、交易所、
+ * 交易所时间与接收时间（纳秒）、一档盘口与成交量 / 持仓量，价格为定点整数（× kPriceScale）。
+ * 其余字段（成交额、开高低、昨收、昨结）与 5 档深度放在伴随的 TickDepth 记录中，
+ * flags 含 kPackedHasDepth 时表示同一位置另有一条 TickDepth。
+ *
+ * pack_tick / unpack_tick 与 fq::Tick 互转：价格为 1e-4 的整数倍时往返无损（期货最小变动价位均满足），
+ * 交易所时间按 行情日期 + 当日微秒 精确往返；成交量 / 持仓量超过 uint32 时饱和并置 kPackedClamped。
+ *
+ * 目前使用 PackedTick 的只有 SnapshotTable（ws_fanout.hpp）与主备镜像槽位（hot_standby.hpp）。
+ * 以下组件未改用，原因是它们在生产路径上不搬运 fq::Tick：
+ *   - SpscRing<T> 是模板，生产代码中只实例化为 SpscRing<TxStamp>（udp_publisher.hpp）
+ *   - ReorderBuffer<T> 的绑定层负载是持有引用的 PyObject*（标准化 dict），放行后仍交给 Python
+ *   - PriorityLanes 只保存 instrument_id -> 通道映射与出队规划，行情本身在 Python 侧的通道队列中
+ *   - 分片工作线程在 Python 侧传递 dict（原生 ShardedPool 已移除，见 sharding.hpp）
+ * 待行情在原生侧端到端流转（解码 -> 重排 -> 分发不经过 dict）时，这些队列再换成 PackedTick。
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+
+#include "fq/tick.hpp"
+
+namespace fq {
+
+constexpr int64_t kPriceScale = 10000;                               ///< 定点价格精度 1e-4
+constexpr int64_t kNoPrice = std::numeric_limits<int64_t>::min();    ///< 无效价格（NaN / 超范围）
+constexpr size_t kDepthLevels = 5;
+
+/// PackedTick::flags 高位（低位保留 fq::Tick::flags）
+constexpr uint16_t kPackedHasDepth = 0x8000;  ///< 同一位置另有一条 TickDepth
+constexpr uint16_t kPackedClamped = 0x4000;   ///< 成交量 / 持仓量超出 uint32 已饱和
+constexpr uint16_t kPackedTickFlagsMask = 0x3FFF;
+
+struct alignas(64) PackedTick {
+    int32_t instrument_id;
+    Exchange exchange;
+    Source source;
+    uint16_t flags;
+    int64_t exchange_time_ns;  ///< 交易所时间：行情日期 + 当日时间（本地墙钟按 UTC 编码的纳秒）
+    int64_t receive_time_ns;   ///< 本进程接收时刻（CLOCK_REALTIME 纳秒），0 为未知
+    int64_t last_price;        ///< 定点价格（× kPriceScale），下同
+    int64_t bid_price_1;
+    int64_t ask_price_1;
+    uint32_t volume;           ///< 累计成交量
+    uint32_t open_interest;
+    uint32_t bid_volume_1;
+    uint32_t ask_volume_1;
+};
+static_assert(sizeof(PackedTick) == 64 && alignof(PackedTick) == 64, "PackedTick must be one cache line");
+
+/// 伴随记录：冷字段 + 5 档深度（第 1 档与 PackedTick 一致）
+struct alignas(64) TickDepth {
+    int32_t instrument_id;
+    uint8_t levels;            ///< 有效档数（0~5）
+    uint8_t reserved[3];
+    double turnover;           ///< 累计成交额
+    int64_t open_price;        ///< 定点价格，下同
+    int64_t high_price;
+    int64_t low_price;
+    int64_t pre_close;
+    int64_t pre_settlement;
+    int64_t bid_price[kDepthLevels];
+    int64_t ask_price[kDepthLevels];
+    uint32_t bid_volume[kDepthLevels];
+    uint32_t ask_volume[kDepthLevels];
+};
+static_assert(sizeof(TickDepth) == 192 && alignof(TickDepth) == 64, "TickDepth layout");
+
+inline int64_t to_fixed_price(double p) {
+    if (!(std::fabs(p) < 9.0e14)) return kNoPrice;
+    return static_cast<int64_t>(std::llround(p * static_cast<double>(kPriceScale)));
+}
+
+inline double from_fixed_price(int64_t v) {
+    if (v == kNoPrice) return std::numeric_limits<double>::quiet_NaN();
+    return static_cast<double>(v) / static_cast<double>(kPriceScale);
+}
+
+/// 1970-01-01 起的天数（proleptic Gregorian）
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+/// days_from_civil 的逆运算 -> YYYYMMDD
+inline uint32_t civil_from_days(int64_t z) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    return static_cast<uint32_t>(y * 10000 + m * 100 + d);
+}
+
+/// 行情日期 + 当日微秒 -> 交易所时间纳秒
+inline int64_t to_exchange_time_ns(uint32_t trade_date, int64_t time_us) {
+    const int64_t days = days_from_civil(trade_date / 10000, trade_date / 100 % 100, trade_date % 100);
+    return (days * 86400000000LL + time_us) * 1000;
+}
+
+/// 接收时间戳（CLOCK_REALTIME 纳秒）
+inline int64_t realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+namespace detail {
+inline uint32_t saturate_u32(int64_t v, uint16_t& flags) {
+    if (v < 0) v = 0;
+    if (v > static_cast<int64_t>(UINT32_MAX)) {
+        flags |= kPackedClamped;
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(v);
+}
+inline uint32_t saturate_u32(double v, uint16_t& flags) {
+    return saturate_u32(static_cast<int64_t>(std::isfinite(v) ? std::llround(v) : 0), flags);
+}
+}  // namespace detail
+
+/// fq::Tick -> PackedTick（depth 非空时同时写出伴随记录并置 kPackedHasDepth；只有一档数据时 levels 为 1）
+inline void pack_tick(const Tick& t, int64_t receive_time_ns, PackedTick& out, TickDepth* depth = nullptr) {
+    uint16_t flags = static_cast<uint16_t>(t.flags & kPackedTickFlagsMask);
+    out.instrument_id = t.instrument_id;
+    out.exchange = t.exchange;
+    out.source = t.source;
+    out.exchange_time_ns = to_exchange_time_ns(t.trade_date, t.time_us);
+    out.receive_time_ns = receive_time_ns;
+    out.last_price = to_fixed_price(t.last_price);
+    out.bid_price_1 = to_fixed_price(t.bid_price_1);
+    out.ask_price_1 = to_fixed_price(t.ask_price_1);
+    out.volume = detail::saturate_u32(t.volume, flags);
+    out.open_interest = detail::saturate_u32(t.open_interest, flags);
+    out.bid_volume_1 = detail::saturate_u32(t.bid_volume_1, flags);
+    out.ask_volume_1 = detail::saturate_u32(t.ask_volume_1, flags);
+    if (depth) {
+        flags |= kPackedHasDepth;
+        *depth = TickDepth{};
+        depth->instrument_id = t.instrument_id;
+        depth->levels = 1;
+        depth->turnover = t.turnover;
+        depth->open_price = to_fixed_price(t.open_price);
+        depth->high_price = to_fixed_price(t.high_price);
+        depth->low_price = to_fixed_price(t.low_price);
+        depth->pre_close = to_fixed_price(t.pre_close);
+        depth->pre_settlement = to_fixed_price(t.pre_settlement);
+        depth->bid_price[0] = out.bid_price_1;
+        depth->ask_price[0] = out.ask_price_1;
+        depth->bid_volume[0] = out.bid_volume_1;
+        depth->ask_volume[0] = out.ask_volume_1;
+    }
+    out.flags = flags;
+}
+
+/// PackedTick（+ 可选伴随记录）-> fq::Tick；无伴随记录时冷字段为 0
+inline void unpack_tick(const PackedTick& p, const TickDepth* depth, Tick& out) {
+    out = Tick{};
+    out.instrument_id = p.instrument_id;
+    out.exchange = p.exchange;
+    out.source = p.source;
+    out.flags = static_cast<uint16_t>(p.flags & kPackedTickFlagsMask);
+    int64_t us = p.exchange_time_ns / 1000;
+    int64_t days = us / 86400000000LL;
+    us -= days * 86400000000LL;
+    if (us < 0) {
+        us += 86400000000LL;
+        --days;
+    }
+    out.trade_date = civil_from_days(days);
+    out.time_us = us;
+    out.last_price = from_fixed_price(p.last_price);
+    out.volume = p.volume;
+    out.open_interest = p.open_interest;
+    out.bid_price_1 = from_fixed_price(p.bid_price_1);
+    out.bid_volume_1 = p.bid_volume_1;
+    out.ask_price_1 = from_fixed_price(p.ask_price_1);
+    out.ask_volume_1 = p.ask_volume_1;
+    if (depth && (p.flags & kPackedHasDepth)) {
+        out.turnover = depth->turnover;
+        out.open_price = from_fixed_price(depth->open_price);
+        out.high_price = from_fixed_price(depth->high_price);
+        out.low_price = from_fixed_price(depth->low_price);
+        out.pre_close = from_fixed_price(depth->pre_close);
+        out.pre_settlement = from_fixed_price(depth->pre_settlement);
+    }
+}
+
+}  // namespace fq
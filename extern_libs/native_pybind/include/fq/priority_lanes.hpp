@@ -0,0 +1,131 @@
+/**
+ * fq/priority_lanes.hpp: 合约优先级通道
+ *
+ * LaneMap 以 instrument_id 为下标记录合约所属通道：显式配置的合约直接命中，其余合约
+ * 首次出现时按品种前缀（合约代码开头的字母，小写）归类一次并缓存，未匹配归默认通道；
+ * LaneScheduler 根据各通道积压量分配一轮可取出的条数：
+ * - strict：按通道编号从小到大依次取尽
+ * - weighted：赤字轮询（DRR），各通道按权重分享本轮额度；仍有积压的通道未用完的额度留到下一轮，
+ *   通道取空即清零，空闲通道不积攒额度
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fq/symbol_table.hpp"
+
+namespace fq {
+
+class LaneMap {
+public:
+    explicit LaneMap(uint8_t default_lane = 0, const SymbolTable* symbols = &global_symbol_table())
+        : default_lane_(default_lane), symbols_(symbols) {}
+
+    void set_lane(int32_t instrument_id, uint8_t lane) {
+        if (instrument_id < 0) return;
+        const size_t idx = static_cast<size_t>(instrument_id);
+        if (idx >= lanes_.size()) lanes_.resize(idx + 1, kUnset);
+        lanes_[idx] = lane;
+    }
+
+    /// 按品种前缀配置通道（如 "rb"、"lc"），对尚未归类的合约生效
+    void add_product(const std::string& product, uint8_t lane) {
+        std::string p;
+        for (char c : product) p.push_back(static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+        products_.emplace_back(std::move(p), lane);
+    }
+
+    /// 合约所属通道（首次查询未配置的合约时按品种归类并缓存）
+    uint8_t lane_of(int32_t instrument_id) {
+        if (instrument_id < 0) return default_lane_;
+        const size_t idx = static_cast<size_t>(instrument_id);
+        if (idx < lanes_.size() && lanes_[idx] != kUnset) return lanes_[idx];
+        const uint8_t lane = classify_product(instrument_id);
+        set_lane(instrument_id, lane);
+        return lane;
+    }
+
+    uint8_t default_lane() const { return default_lane_; }
+
+private:
+    static constexpr uint8_t kUnset = 0xFF;
+
+    uint8_t classify_product(int32_t instrument_id) const {
+        const char* name = symbols_ ? symbols_->name(instrument_id) : nullptr;
+        if (!name || products_.empty()) return default_lane_;
+        std::string product;
+        for (const char* c = name; *c; ++c) {
+            const char ch = *c;
+            if (ch >= 'a' && ch <= 'z') product.push_back(ch);
+            else if (ch >= 'A' && ch <= 'Z') product.push_back(static_cast<char>(ch - 'A' + 'a'));
+            else break;
+        }
+        for (const auto& rule : products_)
+            if (rule.first == product) return rule.second;
+        return default_lane_;
+    }
+
+    std::vector<uint8_t> lanes_;
+    std::vector<std::pair<std::string, uint8_t>> products_;
+    uint8_t default_lane_;
+    const SymbolTable* symbols_;
+};
+
+class LaneScheduler {
+public:
+    LaneScheduler(std::vector<uint32_t> weights, bool strict)
+        : weights_(std::move(weights)), deficit_(weights_.size(), 0), strict_(strict), cursor_(0) {
+        for (uint32_t& w : weights_) w = std::max<uint32_t>(1, w);
+    }
+
+    /// 按积压量 backlog[i] 分配本轮额度 budget，结果写入 take[i]，返回总条数
+    size_t plan(const size_t* backlog, size_t* take, size_t budget) {
+        const size_t n = weights_.size();
+        std::fill(take, take + n, 0);
+        size_t total = 0;
+        if (strict_) {
+            for (size_t i = 0; i < n && total < budget; ++i) {
+                take[i] = std::min(backlog[i], budget - total);
+                total += take[i];
+            }
+            return total;
+        }
+        // DRR：每轮给非空通道加一份权重额度，直到额度用尽或所有通道取空
+        bool progressed = true;
+        while (total < budget && progressed) {
+            progressed = false;
+            for (size_t k = 0; k < n && total < budget; ++k) {
+                const size_t i = (cursor_ + k) % n;
+                const size_t left = backlog[i] - take[i];
+                if (left == 0) {
+                    deficit_[i] = 0;
+                    continue;
+                }
+                deficit_[i] += weights_[i];
+                const size_t give = std::min({static_cast<size_t>(deficit_[i]), left, budget - total});
+                take[i] += give;
+                deficit_[i] = give == left ? 0 : deficit_[i] - give;
+                total += give;
+                progressed = progressed || give > 0;
+            }
+        }
+        cursor_ = (cursor_ + 1) % (n == 0 ? 1 : n);
+        return total;
+    }
+
+    size_t lanes() const { return weights_.size(); }
+    bool strict() const { return strict_; }
+
+private:
+    std::vector<uint32_t> weights_;
+    std::vector<uint64_t> deficit_;
+    bool strict_;
+    size_t cursor_;
+};
+
+}  // namespace fq
@@ -0,0 +1,217 @@
+/**
+ * fq/reorder_buffer.hpp: 多源合流后按合约的有界延迟重排
+ *
+ * 多个采集器（多前置、多行情源、按流哈希分的接收队列）的数据按到达顺序拼接后，同一合约的行情
+ * 可能不按交易所时间到达。ReorderBuffer 对每个合约暂存至多 max_hold 的行情，按
+ * (交易所时间 sim_time, 累计成交量, 到达顺序) 依次放行：
+ *   - 每条行情到达时登记截止时间 arrival + max_hold（到达时间单调，截止时间构成 FIFO）
+ *   - poll(now) 弹出所有已到期的登记项，放行该合约中键不大于到期项的全部行情，
+ *     因此任一行情的停留不超过 max_hold，且同一合约的放行序列单调
+ *   - 键小于该合约最近放行键的行情（迟到）直接丢弃并计数：放行序列不回退，
+ *     下游 K 线、盘口与存储可以假定单调输入
+ *   - 暂存槽位或登记队列用满时提前弹出最早的登记项（计入 forced），不做逐条分配
+ * 负载类型 T 由调用方决定（原生流水线为 Tick，绑定层为持有引用的 PyObject*）。
+ * 暂存行情存于预分配槽位、按合约串成按键有序的单链表；按时间顺序到达时插入为 O(1)。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "fq/symbol_table.hpp"
+
+namespace fq {
+
+/// 重排键：交易所时间优先，同一时刻按累计成交量
+struct ReorderKey {
+    int64_t ts;
+    int64_t volume;
+
+    bool operator<(const ReorderKey& o) const { return ts < o.ts || (ts == o.ts && volume < o.volume); }
+    bool operator<=(const ReorderKey& o) const { return !(o < *this); }
+};
+
+struct ReorderStats {
+    uint64_t pushed = 0;     ///< 接收（不含迟到丢弃）
+    uint64_t released = 0;   ///< 已放行
+    uint64_t reordered = 0;  ///< 到达时早于本合约已暂存行情、被重排的条数
+    uint64_t late = 0;       ///< 迟到丢弃（早于本合约最近放行键）
+    uint64_t forced = 0;     ///< 槽位/登记队列用满而提前到期的登记项
+    uint64_t bypassed = 0;   ///< instrument_id 越界、未经重排直接放行
+};
+
+enum class ReorderResult : uint8_t { kHeld = 0, kLate = 1, kBypassed = 2 };
+
+template <typename T>
+class ReorderBuffer {
+public:
+    ReorderBuffer(int64_t max_hold_us, size_t capacity = 65536, size_t instruments = kMaxInstruments)
+        : max_hold_us_(max_hold_us < 0 ? 0 : max_hold_us),
+          capacity_(capacity == 0 ? 1 : capacity),
+          instruments_(instruments == 0 ? 1 : instruments),
+          slots_(new Slot[capacity_]),
+          fifo_(new Pending[capacity_]),
+          heads_(new int32_t[instruments_]),
+          tails_(new int32_t[instruments_]),
+          watermark_(new ReorderKey[instruments_]) {
+        reset();
+    }
+
+    ReorderBuffer(const ReorderBuffer&) = delete;
+    ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+    /// 暂存一条行情；槽位不足时先提前到期最早的登记项，被放行的行情交给 sink(T&)
+    template <typename Sink>
+    ReorderResult push(int32_t instrument_id, ReorderKey key, const T& item, int64_t now_us, Sink&& sink) {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= instruments_) {
+            ++stats_.bypassed;
+            T copy = item;
+            sink(copy);
+            return ReorderResult::kBypassed;
+        }
+        const size_t iid = static_cast<size_t>(instrument_id);
+        if (key < watermark_[iid]) {
+            ++stats_.late;
+            return ReorderResult::kLate;
+        }
+        while (free_ < 0 || fifo_size_ == capacity_) {
+            ++stats_.forced;
+            expire_front(sink);
+        }
+        const int32_t s = free_;
+        free_ = slots_[s].next;
+        slots_[s].key = key;
+        slots_[s].item = item;
+        insert(iid, s);
+        ++held_;
+        ++stats_.pushed;
+        fifo_[(fifo_head_ + fifo_size_) % capacity_] =
+            Pending{now_us + max_hold_us_, key, static_cast<int32_t>(instrument_id)};
+        ++fifo_size_;
+        return ReorderResult::kHeld;
+    }
+
+    /// 放行截止时间不晚于 now 的行情，返回放行条数
+    template <typename Sink>
+    size_t poll(int64_t now_us, Sink&& sink) {
+        const uint64_t before = stats_.released;
+        while (fifo_size_ && fifo_[fifo_head_].deadline <= now_us) expire_front(sink);
+        return static_cast<size_t>(stats_.released - before);
+    }
+
+    /// 放行全部暂存行情（停止/收盘时调用），返回放行条数
+    template <typename Sink>
+    size_t flush(Sink&& sink) {
+        const uint64_t before = stats_.released;
+        while (fifo_size_) expire_front(sink);
+        return static_cast<size_t>(stats_.released - before);
+    }
+
+    /// 清空全部状态与计数（不放行暂存行情）
+    void reset() {
+        for (size_t i = 0; i < capacity_; ++i) slots_[i].next = i + 1 < capacity_ ? static_cast<int32_t>(i + 1) : -1;
+        free_ = 0;
+        for (size_t i = 0; i < instruments_; ++i) {
+            heads_[i] = tails_[i] = -1;
+            watermark_[i] = kMinKey;
+        }
+        fifo_head_ = fifo_size_ = held_ = 0;
+        stats_ = ReorderStats{};
+    }
+
+    /// 最早一条登记项的截止时间（无暂存时为 int64 最大值），供调用方安排下一次 poll
+    int64_t next_deadline() const {
+        return fifo_size_ ? fifo_[fifo_head_].deadline : std::numeric_limits<int64_t>::max();
+    }
+
+    size_t held() const { return held_; }
+    size_t capacity() const { return capacity_; }
+    size_t instruments() const { return instruments_; }
+    int64_t max_hold_us() const { return max_hold_us_; }
+    const ReorderStats& stats() const { return stats_; }
+
+private:
+    static constexpr ReorderKey kMinKey{std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min()};
+
+    struct Slot {
+        ReorderKey key;
+        T item;
+        int32_t next;
+    };
+
+    struct Pending {
+        int64_t deadline;
+        ReorderKey key;
+        int32_t instrument_id;
+    };
+
+    /// 按键插入本合约链表；等键排在已有行情之后（保持到达顺序）
+    void insert(size_t iid, int32_t s) {
+        const ReorderKey& key = slots_[s].key;
+        slots_[s].next = -1;
+        const int32_t tail = tails_[iid];
+        if (tail < 0) {
+            heads_[iid] = tails_[iid] = s;
+            return;
+        }
+        if (slots_[tail].key <= key) {
+            slots_[tail].next = s;
+            tails_[iid] = s;
+            return;
+        }
+        ++stats_.reordered;
+        int32_t prev = -1;
+        int32_t cur = heads_[iid];
+        while (cur >= 0 && slots_[cur].key <= key) {
+            prev = cur;
+            cur = slots_[cur].next;
+        }
+        slots_[s].next = cur;
+        if (prev < 0) {
+            heads_[iid] = s;
+        } else {
+            slots_[prev].next = s;
+        }
+    }
+
+    /// 弹出最早的登记项，放行该合约中键不大于它的行情（可能已被更早的到期项放行）
+    template <typename Sink>
+    void expire_front(Sink& sink) {
+        const Pending p = fifo_[fifo_head_];
+        fifo_head_ = (fifo_head_ + 1) % capacity_;
+        --fifo_size_;
+        const size_t iid = static_cast<size_t>(p.instrument_id);
+        int32_t cur = heads_[iid];
+        while (cur >= 0 && slots_[cur].key <= p.key) {
+            Slot& slot = slots_[cur];
+            const int32_t next = slot.next;
+            watermark_[iid] = slot.key;
+            sink(slot.item);
+            slot.next = free_;
+            free_ = cur;
+            --held_;
+            ++stats_.released;
+            cur = next;
+        }
+        heads_[iid] = cur;
+        if (cur < 0) tails_[iid] = -1;
+    }
+
+    int64_t max_hold_us_;
+    size_t capacity_;
+    size_t instruments_;
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<Pending[]> fifo_;
+    std::unique_ptr<int32_t[]> heads_;
+    std::unique_ptr<int32_t[]> tails_;
+    std::unique_ptr<ReorderKey[]> watermark_;
+    int32_t free_ = -1;
+    size_t fifo_head_ = 0;
+    size_t fifo_size_ = 0;
+    size_t held_ = 0;
+    ReorderStats stats_;
+};
+
+}  // namespace fq
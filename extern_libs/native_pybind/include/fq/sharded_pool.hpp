@@ -0,0 +1,103 @@
+/**
+ * fq/sharded_pool.hpp: 按合约分片的工作线程池
+ *
+ * 每个工作线程独占一条 SpscRing，生产者按 shard_of(instrument_id)（见 sharding.hpp）投递，
+ * 同一合约始终落在同一线程上，因而严格保持单合约顺序；不同合约并行处理。
+ * 约束：submit 只能由一个生产者线程调用（各分片队列为 SPSC）。
+ * 工作线程空闲时按 WaitConfig 等待（默认 自旋 → yield → futex 休眠），submit 负责唤醒。
+ * 处理函数在工作线程上直接运行、不经 Python，行情分片落盘见 tick_writer.hpp 的 ShardedTickWriter。
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "fq/sharding.hpp"
+#include "fq/spsc_ring.hpp"
+#include "fq/wait_strategy.hpp"
+
+namespace fq {
+
+template <typename T>
+class ShardedPool {
+public:
+    using Handler = std::function<void(size_t shard, T& item)>;
+
+    ShardedPool(size_t workers, size_t ring_capacity, Handler handler, const WaitConfig& wait = WaitConfig())
+        : handler_(std::move(handler)) {
+        if (workers == 0) workers = 1;
+        for (size_t i = 0; i < workers; ++i) shards_.emplace_back(new Shard(ring_capacity, wait));
+        for (size_t i = 0; i < workers; ++i) shards_[i]->thread = std::thread([this, i] { run(i); });
+    }
+
+    ShardedPool(const ShardedPool&) = delete;
+    ShardedPool& operator=(const ShardedPool&) = delete;
+
+    ~ShardedPool() { stop(); }
+
+    /// 投递到指定分片；队列满时自旋让出直到有空位（背压）
+    void submit(size_t shard, T item) {
+        Shard& s = *shards_[shard % shards_.size()];
+        while (!s.ring.try_push(std::move(item))) std::this_thread::yield();
+        s.submitted.fetch_add(1, std::memory_order_relaxed);
+        s.wait.notify();
+    }
+
+    /// 等待所有已投递的元素处理完毕
+    void flush() const {
+        for (const auto& s : shards_) {
+            const uint64_t target = s->submitted.load(std::memory_order_relaxed);
+            while (s->processed.load(std::memory_order_acquire) < target) std::this_thread::yield();
+        }
+    }
+
+    void stop() {
+        if (stopping_.exchange(true)) return;
+        for (auto& s : shards_) s->wait.notify();
+        for (auto& s : shards_)
+            if (s->thread.joinable()) s->thread.join();
+    }
+
+    size_t workers() const { return shards_.size(); }
+    uint64_t processed(size_t shard) const { return shards_[shard]->processed.load(std::memory_order_relaxed); }
+    size_t backlog(size_t shard) const { return shards_[shard]->ring.size(); }
+    /// 分片空闲等待统计（仅在工作线程停止后读取才是一致快照）
+    const WaitStats& wait_stats(size_t shard) const { return shards_[shard]->wait.stats(); }
+
+private:
+    struct Shard {
+        Shard(size_t cap, const WaitConfig& wait_config) : ring(cap), wait(wait_config) {}
+        SpscRing<T> ring;
+        WaitStrategy wait;
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> processed{0};
+        std::thread thread;
+    };
+
+    void run(size_t i) {
+        Shard& s = *shards_[i];
+        T item;
+        for (;;) {
+            if (s.ring.try_pop(item)) {
+                s.wait.reset();
+                handler_(i, item);
+                s.processed.fetch_add(1, std::memory_order_release);
+                continue;
+            }
+            // 停止时先把队列中剩余元素处理完
+            if (stopping_.load(std::memory_order_acquire) && s.ring.empty()) return;
+            s.wait.idle();
+        }
+    }
+
+    Handler handler_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> stopping_{false};
+};
+
+}  // namespace fq
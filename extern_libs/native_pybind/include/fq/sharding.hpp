@@ -0,0 +1,21 @@
+/**
+ * fq/sharding.hpp: 按合约分片规则
+ *
+ * Python 侧分片处理器（src/processor/sharded_processor.py）与 shard_partition 绑定共用的分片函数，
+ * 同一合约始终落在同一分片上。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fq {
+
+/// 合约 ID -> 分片（乘法哈希，避免连续 ID 集中在少数分片）
+inline size_t shard_of(int32_t instrument_id, size_t shards) {
+    if (shards <= 1 || instrument_id < 0) return 0;
+    const uint64_t h = static_cast<uint64_t>(static_cast<uint32_t>(instrument_id)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>((h >> 32) % shards);
+}
+
+}  // namespace fq
@@ -0,0 +1,116 @@
+/**
+ * fq/soft_nic.hpp: ExaNIC RX/TX 的软件替身（单向帧环）
+ *
+ * 定长槽位的单生产者单消费者帧环：发送端经 TxOps（begin/end）或 transmit 写入，
+ * 接收端按 receive 取帧，语义与 exanic_begin_transmit_frame / exanic_receive_frame 一致。
+ * end 时以 CLOCK_MONOTONIC 记录发送时间戳，供无网卡环境下测试 TX 发布与时间戳路径。
+ * 环满时 begin 返回 nullptr 并计入 dropped（与网卡 TX 缓冲区不可用时的处理一致）。
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "fq/hot_standby.hpp"
+#include "fq/spsc_ring.hpp"
+#include "fq/tx_ops.hpp"
+
+namespace fq {
+
+class SoftFrameRing {
+public:
+    /// 单帧上限（与 exanic_pybind receive_frame 缺省 max_size 一致）
+    static constexpr size_t kMaxFrame = 2048;
+
+    explicit SoftFrameRing(size_t capacity = 1024)
+        : capacity_(next_pow2(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]) {}
+
+    SoftFrameRing(const SoftFrameRing&) = delete;
+    SoftFrameRing& operator=(const SoftFrameRing&) = delete;
+
+    /// 生产者：分配一帧；帧过大或环满返回 nullptr
+    char* begin(size_t frame_size) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (frame_size > kMaxFrame || tail - head_.load(std::memory_order_acquire) >= capacity_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return slots_[tail & mask_].data;
+    }
+
+    /// 生产者：提交 begin 分配的帧，记录发送时间戳
+    int end(size_t size) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& s = slots_[tail & mask_];
+        s.size = size;
+        // 时间戳严格递增，发布者据“时间戳变化”判定本帧已发出
+        const int64_t prev = last_tx_ns_.load(std::memory_order_relaxed);
+        const int64_t now = monotonic_ns();
+        const int64_t ts = now > prev ? now : prev + 1;
+        s.tx_ns = ts;
+        last_tx_ns_.store(ts, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+        return 0;
+    }
+
+    /// 生产者：整帧复制发送（注入 RX 帧时使用）；成功返回 0
+    int transmit(const char* frame, size_t size) {
+        char* p = begin(size);
+        if (!p) return -1;
+        std::memcpy(p, frame, size);
+        return end(size);
+    }
+
+    /**
+     * 消费者：取一帧复制到 buf。
+     * @return 帧长度；无帧返回 0；帧长超过 max_size 时丢弃该帧并返回 -1
+     */
+    int64_t receive(char* buf, size_t max_size, int64_t* tx_ns = nullptr) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return 0;
+        const Slot& s = slots_[head & mask_];
+        const int64_t n = s.size <= max_size ? static_cast<int64_t>(s.size) : -1;
+        if (n > 0) std::memcpy(buf, s.data, s.size);
+        if (tx_ns) *tx_ns = s.tx_ns;
+        head_.store(head + 1, std::memory_order_release);
+        return n;
+    }
+
+    int64_t last_tx_ns() const { return last_tx_ns_.load(std::memory_order_acquire); }
+    size_t pending() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return capacity_; }
+
+    /// 以本帧环为发送端的 TxOps（生命周期不超过本对象）
+    TxOps tx_ops() {
+        TxOps ops;
+        ops.ctx = this;
+        ops.begin = [](void* c, size_t n) { return static_cast<SoftFrameRing*>(c)->begin(n); };
+        ops.end = [](void* c, size_t n) { return static_cast<SoftFrameRing*>(c)->end(n); };
+        ops.abort = [](void*) {};
+        ops.last_tx_ns = [](void* c) { return static_cast<SoftFrameRing*>(c)->last_tx_ns(); };
+        return ops;
+    }
+
+private:
+    struct Slot {
+        size_t size;
+        int64_t tx_ns;
+        char data[kMaxFrame];
+    };
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    alignas(kCacheLine) std::atomic<int64_t> last_tx_ns_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace fq
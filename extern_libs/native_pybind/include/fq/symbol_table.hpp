@@ -0,0 +1,169 @@
+/**
+ * fq/symbol_table.hpp: 全局合约符号表
+ *
+ * 将各行情源定长、可能带 NUL/空格填充的原始合约字节（DCE Symbol[130]、
+ * GFEX contract_name[20]、CTP InstrumentID[81] 等）映射为稠密 int32 合约 ID。
+ * 所有原生记录、缓存、去重均以 ID 为键，字符串只在 Python/存储边界物化。
+ *
+ * 并发约定：查找无锁（slot 以 release 发布、acquire 读取），插入在互斥锁内
+ * 完成；表容量固定、条目只增不删，因此 name() 返回的指针在进程内始终有效。
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace fq {
+
+/// 合约代码最大长度（字节），超出视为非法输入
+constexpr size_t kMaxSymbolLen = 31;
+/// 全局符号表可容纳的合约数；各原生组件按该上限预分配以 ID 为下标的状态数组
+constexpr size_t kMaxInstruments = 65536;
+/// 非法/未登记合约 ID
+constexpr int32_t kInvalidInstrument = -1;
+
+/// 规范化后的合约键：零填充 32 字节，便于按 4 个 64 位字比较与哈希
+struct SymbolKey {
+    union {
+        char bytes[kMaxSymbolLen + 1];
+        uint64_t words[(kMaxSymbolLen + 1) / 8];
+    };
+    uint8_t len;
+};
+
+inline bool is_symbol_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * 规范化原始合约字节：遇 NUL 截断，去掉首尾空白。
+ *
+ * @return 成功返回 true；空串或超过 kMaxSymbolLen 返回 false
+ */
+inline bool normalize_symbol(const char* raw, size_t n, SymbolKey& key) {
+    const void* nul = std::memchr(raw, '\0', n);
+    if (nul) n = static_cast<size_t>(static_cast<const char*>(nul) - raw);
+    size_t begin = 0;
+    while (begin < n && is_symbol_space(raw[begin])) ++begin;
+    while (n > begin && is_symbol_space(raw[n - 1])) --n;
+    size_t len = n - begin;
+    if (len == 0 || len > kMaxSymbolLen) return false;
+    std::memset(key.words, 0, sizeof(key.words));
+    std::memcpy(key.bytes, raw + begin, len);
+    key.len = static_cast<uint8_t>(len);
+    return true;
+}
+
+/// 按 8 字节字混合的快速哈希（合约代码通常 <= 16 字节，1~2 轮即可）
+inline uint64_t hash_symbol(const SymbolKey& key) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ key.len;
+    const size_t nwords = (key.len + 7u) / 8u;
+    for (size_t i = 0; i < nwords; ++i) {
+        h ^= key.words[i];
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+class SymbolTable {
+public:
+    explicit SymbolTable(size_t capacity = kMaxInstruments)
+        : capacity_(capacity), size_(0) {
+        // 负载因子 <= 0.5，线性探测平均 1~2 次即可命中
+        size_t slots = 16;
+        while (slots < capacity * 2) slots <<= 1;
+        mask_ = slots - 1;
+        slots_.reset(new std::atomic<int32_t>[slots]);
+        for (size_t i = 0; i < slots; ++i) slots_[i].store(kInvalidInstrument, std::memory_order_relaxed);
+        entries_.reset(new Entry[capacity]);
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /// 查找或登记合约，返回稠密 ID；非法输入或表满返回 kInvalidInstrument
+    int32_t intern(const char* raw, size_t n) {
+        SymbolKey key;
+        if (!normalize_symbol(raw, n, key)) return kInvalidInstrument;
+        const uint64_t h = hash_symbol(key);
+        int32_t id = probe(key, h);
+        if (id != kInvalidInstrument) return id;
+
+        std::lock_guard<std::mutex> lock(mu_);
+        // 加锁后复查，避免并发登记同一合约
+        id = probe(key, h);
+        if (id != kInvalidInstrument) return id;
+        const int32_t next = size_.load(std::memory_order_relaxed);
+        if (static_cast<size_t>(next) >= capacity_) return kInvalidInstrument;
+        Entry& e = entries_[next];
+        e.key = key;
+        e.hash = h;
+        size_t i = h & mask_;
+        while (slots_[i].load(std::memory_order_relaxed) != kInvalidInstrument) i = (i + 1) & mask_;
+        slots_[i].store(next, std::memory_order_release);
+        size_.store(next + 1, std::memory_order_release);
+        return next;
+    }
+
+    /// 只查不登记
+    int32_t find(const char* raw, size_t n) const {
+        SymbolKey key;
+        if (!normalize_symbol(raw, n, key)) return kInvalidInstrument;
+        return probe(key, hash_symbol(key));
+    }
+
+    /// 合约 ID -> 规范化合约代码（NUL 结尾）；越界返回 nullptr
+    const char* name(int32_t id) const {
+        if (id < 0 || id >= size_.load(std::memory_order_acquire)) return nullptr;
+        return entries_[id].key.bytes;
+    }
+
+    size_t name_len(int32_t id) const {
+        if (id < 0 || id >= size_.load(std::memory_order_acquire)) return 0;
+        return entries_[id].key.len;
+    }
+
+    size_t size() const { return static_cast<size_t>(size_.load(std::memory_order_acquire)); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        SymbolKey key;
+        uint64_t hash;
+    };
+
+    int32_t probe(const SymbolKey& key, uint64_t h) const {
+        size_t i = h & mask_;
+        for (;;) {
+            const int32_t id = slots_[i].load(std::memory_order_acquire);
+            if (id == kInvalidInstrument) return kInvalidInstrument;
+            const Entry& e = entries_[id];
+            if (e.hash == h && e.key.len == key.len &&
+                e.key.words[0] == key.words[0] && e.key.words[1] == key.words[1] &&
+                e.key.words[2] == key.words[2] && e.key.words[3] == key.words[3]) {
+                return id;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<std::atomic<int32_t>[]> slots_;
+    std::unique_ptr<Entry[]> entries_;
+    std::atomic<int32_t> size_;
+    std::mutex mu_;
+};
+
+/// 进程级全局符号表：各行情源、原生阶段共享同一套合约 ID
+inline SymbolTable& global_symbol_table() {
+    static SymbolTable table(kMaxInstruments);
+    return table;
+}
+
+}  // namespace fq
@@ -0,0 +1,85 @@
+/**
+ * fq/tick.hpp: 原生标准化行情记录
+ *
+ * 与 Python 侧 FUTURES_BASE_FIELDS 一一对应的定长 POD，合约以 instrument_id
+ * （见 symbol_table.hpp）表示，时间拆为行情日期 + 当日微秒，避免逐条构造 datetime。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace fq {
+
+/// 交易所编码（与 Python 侧交易所字符串互转）
+enum class Exchange : uint8_t {
+    kUnknown = 0,
+    kSHFE = 1,
+    kDCE = 2,
+    kCZCE = 3,
+    kINE = 4,
+    kGFEX = 5,
+    kCFFEX = 6,
+};
+
+/// 行情源编码
+enum class Source : uint8_t {
+    kUnknown = 0,
+    kCTP = 1,
+    kZhengyi = 2,
+    kNSQ = 3,
+    kGFEX = 4,
+};
+
+inline const char* exchange_name(Exchange ex) {
+    switch (ex) {
+        case Exchange::kSHFE: return "SHFE";
+        case Exchange::kDCE: return "DCE";
+        case Exchange::kCZCE: return "CZCE";
+        case Exchange::kINE: return "INE";
+        case Exchange::kGFEX: return "GFEX";
+        case Exchange::kCFFEX: return "CFFEX";
+        default: return "";
+    }
+}
+
+inline Exchange exchange_from_name(const char* s, size_t n) {
+    static const Exchange kAll[] = {Exchange::kSHFE, Exchange::kDCE, Exchange::kCZCE,
+                                    Exchange::kINE, Exchange::kGFEX, Exchange::kCFFEX};
+    for (Exchange ex : kAll) {
+        const char* name = exchange_name(ex);
+        if (std::strlen(name) == n && std::memcmp(name, s, n) == 0) return ex;
+    }
+    return Exchange::kUnknown;
+}
+
+struct Tick {
+    int32_t instrument_id;
+    Exchange exchange;
+    Source source;
+    uint16_t flags;
+    uint32_t trade_date;  ///< 行情日期 YYYYMMDD
+    uint32_t reserved;
+    int64_t time_us;      ///< 当日时间（微秒）
+    double last_price;
+    int64_t volume;       ///< 累计成交量
+    double turnover;      ///< 累计成交额（未提供的源为 0）
+    double open_interest;
+    double bid_price_1;
+    int64_t bid_volume_1;
+    double ask_price_1;
+    int64_t ask_volume_1;
+    double open_price;
+    double high_price;
+    double low_price;
+    double pre_close;
+    double pre_settlement;
+};
+
+/// 由时分秒与微秒组装当日微秒数
+inline int64_t make_time_us(int hour, int minute, int second, int micros) {
+    return ((static_cast<int64_t>(hour) * 60 + minute) * 60 + second) * 1000000LL + micros;
+}
+
+}  // namespace fq
@@ -0,0 +1,70 @@
+/**
+ * fq/tick_batch.hpp: 定容行情批次
+ *
+ * 预分配 Tick 槽位，接收线程直接在槽位上解码，消费者按下标读取。
+ * generation 在 clear/swap 时递增，持有旧视图的一方可据此判断槽位已被复用。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "fq/tick.hpp"
+
+namespace fq {
+
+class TickBatch {
+public:
+    explicit TickBatch(size_t capacity = 4096)
+        : ticks_(new Tick[capacity == 0 ? 1 : capacity]),
+          size_(0),
+          capacity_(capacity == 0 ? 1 : capacity),
+          generation_(0) {}
+
+    TickBatch(const TickBatch&) = delete;
+    TickBatch& operator=(const TickBatch&) = delete;
+
+    /// 取下一个空槽位；批次已满返回 nullptr（由调用方计数丢弃）
+    Tick* emplace() {
+        if (size_ >= capacity_) return nullptr;
+        return &ticks_[size_++];
+    }
+
+    /// 撤销最近一次 emplace（解码失败时使用）
+    void pop_back() {
+        if (size_ > 0) --size_;
+    }
+
+    void clear() {
+        size_ = 0;
+        ++generation_;
+    }
+
+    /// 与另一批次交换内容（O(1)），用于接收线程与消费者之间的双缓冲
+    void swap(TickBatch& other) {
+        std::swap(ticks_, other.ticks_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        ++generation_;
+        ++other.generation_;
+    }
+
+    const Tick& operator[](size_t i) const { return ticks_[i]; }
+    Tick& operator[](size_t i) { return ticks_[i]; }
+    const Tick* data() const { return ticks_.get(); }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool full() const { return size_ >= capacity_; }
+    uint64_t generation() const { return generation_; }
+
+private:
+    std::unique_ptr<Tick[]> ticks_;
+    size_t size_;
+    size_t capacity_;
+    uint64_t generation_;
+};
+
+}  // namespace fq
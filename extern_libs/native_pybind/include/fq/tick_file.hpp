@@ -0,0 +1,189 @@
+/**
+ * fq/tick_file.hpp: 可内存映射的行情日文件（.fqt）
+ *
+ * 布局：64 字节文件头 | count 条 Tick（按时间有序，记录即 fq::Tick 内存布局）|
+ *       symbol_count 个 32 字节零填充合约代码（下标为文件内合约 ID）|
+ *       合约索引（可选，8 字节对齐）：symbol_count 个 {start, count}（uint64）+ count 个 uint32 记录下标，
+ *       按合约分组、组内按时间有序；单合约查询直接取下标，无需扫描全天
+ * 旧文件 index_offset 为 0（原填充字节），读取方按“无索引”处理。
+ * 文件内 instrument_id 为写入时分配的稠密 ID，与进程内符号表无关，读取方按合约段重新映射。
+ * 只读映射后各线程/fork 出的进程共享同一份页缓存，回测与参数扫描无需逐次加载。
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+constexpr char kTickFileMagic[8] = {'F', 'Q', 'T', 'I', 'C', 'K', '0', '1'};
+constexpr uint32_t kTickFileVersion = 1;
+constexpr size_t kTickFileSymbolLen = kMaxSymbolLen + 1;
+
+struct TickFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;     ///< sizeof(Tick)，读取时校验
+    uint64_t count;           ///< 行情条数
+    uint64_t symbols_offset;  ///< 合约段偏移
+    uint32_t symbol_count;
+    uint32_t reserved;
+    uint64_t index_offset;    ///< 合约索引偏移，0 为无索引
+    uint8_t pad[16];
+};
+
+struct TickFileIndexEntry {
+    uint64_t start;  ///< 在下标数组中的起点
+    uint64_t count;
+};
+
+static_assert(sizeof(TickFileHeader) == 64, "TickFileHeader must stay 64 bytes");
+static_assert(sizeof(Tick) == 128, "tick file records use the fq::Tick layout");
+
+/// 写出日文件（含合约索引）；names 为 symbol_count 个 32 字节零填充合约代码，
+/// ticks 的 instrument_id 为文件内合约 ID
+inline bool write_tick_file(const char* path, const Tick* ticks, size_t count, const char* names,
+                            size_t symbol_count) {
+    TickFileHeader h{};
+    std::memcpy(h.magic, kTickFileMagic, sizeof(h.magic));
+    h.version = kTickFileVersion;
+    h.record_size = sizeof(Tick);
+    h.count = count;
+    h.symbols_offset = sizeof(TickFileHeader) + count * sizeof(Tick);
+    h.symbol_count = static_cast<uint32_t>(symbol_count);
+    const uint64_t symbols_end = h.symbols_offset + symbol_count * kTickFileSymbolLen;
+    h.index_offset = (symbols_end + 7) & ~uint64_t{7};
+
+    // 按合约分组的记录下标（计数排序，组内保持时间顺序）；ID 越界的记录不进索引
+    std::vector<TickFileIndexEntry> entries(symbol_count, TickFileIndexEntry{0, 0});
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t id = ticks[i].instrument_id;
+        if (id >= 0 && static_cast<size_t>(id) < symbol_count) ++entries[static_cast<size_t>(id)].count;
+    }
+    uint64_t total = 0;
+    for (TickFileIndexEntry& e : entries) {
+        e.start = total;
+        total += e.count;
+    }
+    std::vector<uint32_t> rows(total);
+    std::vector<uint64_t> fill(symbol_count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t id = ticks[i].instrument_id;
+        if (id < 0 || static_cast<size_t>(id) >= symbol_count) continue;
+        const size_t s = static_cast<size_t>(id);
+        rows[entries[s].start + fill[s]++] = static_cast<uint32_t>(i);
+    }
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    static const char kZeros[8] = {};
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    if (ok && count) ok = std::fwrite(ticks, sizeof(Tick), count, f) == count;
+    if (ok && symbol_count) ok = std::fwrite(names, kTickFileSymbolLen, symbol_count, f) == symbol_count;
+    if (ok && h.index_offset > symbols_end)
+        ok = std::fwrite(kZeros, 1, h.index_offset - symbols_end, f) == h.index_offset - symbols_end;
+    if (ok && symbol_count)
+        ok = std::fwrite(entries.data(), sizeof(TickFileIndexEntry), symbol_count, f) == symbol_count;
+    if (ok && total) ok = std::fwrite(rows.data(), sizeof(uint32_t), total, f) == total;
+    return std::fclose(f) == 0 && ok;
+}
+
+/// 只读映射的日文件
+class MappedTickFile {
+public:
+    MappedTickFile() = default;
+    ~MappedTickFile() { close(); }
+    MappedTickFile(const MappedTickFile&) = delete;
+    MappedTickFile& operator=(const MappedTickFile&) = delete;
+
+    /// 映射并校验文件头；失败返回 false 且不持有映射
+    bool open(const char* path) {
+        close();
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base_ = static_cast<const char*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+        const TickFileHeader* h = header();
+        const bool valid = std::memcmp(h->magic, kTickFileMagic, sizeof(h->magic)) == 0 &&
+                           h->version == kTickFileVersion && h->record_size == sizeof(Tick) &&
+                           h->symbols_offset == sizeof(TickFileHeader) + h->count * sizeof(Tick) &&
+                           h->symbols_offset + h->symbol_count * kTickFileSymbolLen <= size_;
+        if (!valid) {
+            close();
+            return false;
+        }
+        if (h->index_offset != 0) {
+            const uint64_t entries_end = h->index_offset + h->symbol_count * sizeof(TickFileIndexEntry);
+            bool index_ok = h->index_offset % 8 == 0 && entries_end <= size_;
+            for (uint32_t s = 0; index_ok && s < h->symbol_count; ++s) {
+                const TickFileIndexEntry& e = index_entries()[s];
+                index_ok = e.start + e.count <= h->count &&
+                           entries_end + (e.start + e.count) * sizeof(uint32_t) <= size_;
+            }
+            if (!index_ok) {
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_) ::munmap(const_cast<char*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+    const TickFileHeader* header() const { return reinterpret_cast<const TickFileHeader*>(base_); }
+    const Tick* ticks() const { return reinterpret_cast<const Tick*>(base_ + sizeof(TickFileHeader)); }
+    size_t size() const { return base_ ? header()->count : 0; }
+    size_t symbol_count() const { return base_ ? header()->symbol_count : 0; }
+
+    bool has_index() const { return base_ && header()->index_offset != 0; }
+
+    /// 合约的记录下标（时间有序）；无索引或越界时返回 nullptr 且 n 为 0
+    const uint32_t* symbol_rows(int32_t file_id, size_t& n) const {
+        n = 0;
+        if (!has_index() || file_id < 0 || static_cast<size_t>(file_id) >= header()->symbol_count) return nullptr;
+        const TickFileIndexEntry& e = index_entries()[file_id];
+        n = static_cast<size_t>(e.count);
+        const char* rows = base_ + header()->index_offset + header()->symbol_count * sizeof(TickFileIndexEntry);
+        return reinterpret_cast<const uint32_t*>(rows) + e.start;
+    }
+
+    /// 文件内合约 ID -> 合约代码（零结尾），越界返回 nullptr
+    const char* symbol(int32_t file_id) const {
+        if (!base_ || file_id < 0 || static_cast<size_t>(file_id) >= header()->symbol_count) return nullptr;
+        return base_ + header()->symbols_offset + static_cast<size_t>(file_id) * kTickFileSymbolLen;
+    }
+
+private:
+    const TickFileIndexEntry* index_entries() const {
+        return reinterpret_cast<const TickFileIndexEntry*>(base_ + header()->index_offset);
+    }
+
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace fq
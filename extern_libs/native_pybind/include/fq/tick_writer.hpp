@@ -0,0 +1,305 @@
+/**
+ * fq/tick_writer.hpp: 分片工作线程上的原生 清洗 → CSV 落盘
+ *
+ * 对标准化行情与 Python 默认分片阶段（DataCleaner.clean → FileStorage.save）结果逐字节一致，
+ * 工作线程全程不经 Python：
+ * - TickDedup：按 (instrument_id, 日期, 当日微秒) 去重，last_price 为 0 的丢弃且不登记；
+ *   每批结束时已登记条数超过 max_seen 即清空（同 DataCleaner 的 max_seen_size）
+ * - CsvTickWriter：列为 kCsvTickColumns（DataParser 输出的键顺序去掉不落盘列），按 (合约, 日期)
+ *   聚合一批记录，文件不存在时先写表头，每批每个文件一次 open/write
+ * - ShardedTickWriter：ShardedPool 的每个分片各持一套 TickDedup + CsvTickWriter，
+ *   生产者每批在各分片的最后一条上打批次结束标记，分片据此结束去重批次并写出文件
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fq/csv_encoder.hpp"
+#include "fq/sharded_pool.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+/// 落盘列（DataParser 键顺序，去掉 kCsvNonPersistedFields）
+inline constexpr const char* kCsvTickColumns[] = {
+    "symbol", "exchange", "last_price", "volume", "open_interest", "datetime", "bid_price_1", "bid_volume_1",
+    "ask_price_1", "ask_volume_1", "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+};
+
+/// 开放寻址去重表：清空只递增代号，扩容后不再分配
+class TickDedup {
+public:
+    explicit TickDedup(size_t max_seen) : max_seen_(max_seen) { rehash(64); }
+
+    /// 首次出现返回 true 并登记
+    bool insert(int32_t instrument_id, uint32_t date, int64_t time_us) {
+        if ((size_ + 1) * 2 > slots_.size()) rehash(slots_.size() * 2);
+        return insert_slot(instrument_id, date, time_us);
+    }
+
+    /// 一批结束：超过上限则清空
+    void end_batch() {
+        if (size_ > max_seen_) clear();
+    }
+
+    void clear() {
+        size_ = 0;
+        if (++gen_ == 0) {
+            for (Slot& s : slots_) s.gen = 0;
+            gen_ = 1;
+        }
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    struct Slot {
+        int64_t time_us = 0;
+        uint32_t date = 0;
+        int32_t instrument_id = 0;
+        uint32_t gen = 0;  ///< 等于当前代号才是有效项
+    };
+
+    static uint64_t hash(int32_t instrument_id, uint32_t date, int64_t time_us) {
+        uint64_t h = static_cast<uint64_t>(time_us) ^ (static_cast<uint64_t>(date) << 32) ^
+                     (static_cast<uint64_t>(static_cast<uint32_t>(instrument_id)) * 0x9E3779B97F4A7C15ULL);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+        return h;
+    }
+
+    bool insert_slot(int32_t instrument_id, uint32_t date, int64_t time_us) {
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = hash(instrument_id, date, time_us) & mask;; i = (i + 1) & mask) {
+            Slot& s = slots_[i];
+            if (s.gen != gen_) {
+                s.time_us = time_us;
+                s.date = date;
+                s.instrument_id = instrument_id;
+                s.gen = gen_;
+                ++size_;
+                return true;
+            }
+            if (s.instrument_id == instrument_id && s.date == date && s.time_us == time_us) return false;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.assign(capacity, Slot());
+        const uint32_t old_gen = gen_;
+        gen_ = 1;
+        size_ = 0;
+        for (const Slot& s : old)
+            if (s.gen == old_gen) insert_slot(s.instrument_id, s.date, s.time_us);
+    }
+
+    std::vector<Slot> slots_;
+    size_t max_seen_;
+    size_t size_ = 0;
+    uint32_t gen_ = 1;
+};
+
+/// 单个分片的 CSV 落盘（路径与内容同 FileStorage）
+class CsvTickWriter {
+public:
+    CsvTickWriter(std::string base_path, const SymbolTable& symbols)
+        : files_(std::move(base_path)), symbols_(symbols) {
+        for (const char* col : kCsvTickColumns) {
+            if (!header_.empty()) header_.push_back(',');
+            header_.append(col);
+        }
+        header_.append("\r\n");
+        files_.begin_batch();
+    }
+
+    /// 编码一条到所属文件的本批缓冲
+    void append(const Tick& t) {
+        const char* symbol = symbols_.name(t.instrument_id);
+        const size_t symbol_len = symbols_.name_len(t.instrument_id);
+        if (!symbol) return;
+        CsvFileBuffers::File& f = files_.file(symbol, symbol_len, static_cast<int32_t>(t.trade_date));
+        std::string& out = f.body;
+        csv_append_text(out, symbol, symbol_len);
+        out.push_back(',');
+        const char* ex = exchange_name(t.exchange);
+        csv_append_text(out, ex, std::strlen(ex));
+        out.push_back(',');
+        csv_append_float(out, t.last_price);
+        out.push_back(',');
+        csv_append_int(out, t.volume);
+        out.push_back(',');
+        csv_append_float(out, t.open_interest);
+        out.push_back(',');
+        const int64_t secs = t.time_us / 1000000;
+        iso_.append(out, static_cast<int>(t.trade_date / 10000), static_cast<int>(t.trade_date / 100 % 100),
+                    static_cast<int>(t.trade_date % 100), static_cast<int>(secs / 3600),
+                    static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60),
+                    static_cast<int>(t.time_us % 1000000));
+        out.push_back(',');
+        csv_append_float(out, t.bid_price_1);
+        out.push_back(',');
+        csv_append_int(out, t.bid_volume_1);
+        out.push_back(',');
+        csv_append_float(out, t.ask_price_1);
+        out.push_back(',');
+        csv_append_int(out, t.ask_volume_1);
+        for (double v : {t.open_price, t.high_price, t.low_price, t.pre_close, t.pre_settlement}) {
+            out.push_back(',');
+            csv_append_float(out, v);
+        }
+        out.append("\r\n");
+        ++f.rows;
+    }
+
+    /// 写出本批各文件并开始下一批；返回写入失败的文件数（errno 见 last_errno）
+    size_t flush() {
+        size_t failed = 0;
+        for (size_t idx : files_.active()) {
+            CsvFileBuffers::File& f = files_.at(idx);
+            if (f.body.empty()) continue;
+            if (!write_file(f.path, f.body)) ++failed;
+        }
+        files_.begin_batch();
+        return failed;
+    }
+
+    int last_errno() const { return last_errno_; }
+    const std::string& header() const { return header_; }
+    size_t cached_files() const { return files_.size(); }
+
+private:
+    bool write_file(const std::string& path, const std::string& body) {
+        const bool exists = ::access(path.c_str(), F_OK) == 0;
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            last_errno_ = errno;
+            return false;
+        }
+        bool ok = (exists || write_all(fd, header_)) && write_all(fd, body);
+        if (!ok) last_errno_ = errno;
+        if (::close(fd) != 0 && ok) {
+            last_errno_ = errno;
+            ok = false;
+        }
+        return ok;
+    }
+
+    static bool write_all(int fd, const std::string& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    CsvFileBuffers files_;
+    const SymbolTable& symbols_;
+    IsoDateTimeFormatter iso_;
+    std::string header_;
+    int last_errno_ = 0;
+};
+
+/// 分片队列中的一条行情；batch_end 标记本批在该分片的最后一条
+struct ShardTick {
+    Tick tick;
+    bool batch_end;
+};
+
+/// 按合约分片的原生 清洗 → 落盘 工作线程池（submit 只能由单个生产者线程调用）
+class ShardedTickWriter {
+public:
+    ShardedTickWriter(size_t workers, const std::string& base_path, size_t max_seen, size_t ring_capacity,
+                      const SymbolTable& symbols = global_symbol_table(), const WaitConfig& wait = WaitConfig()) {
+        if (workers == 0) workers = 1;
+        for (size_t i = 0; i < workers; ++i) shards_.emplace_back(new Shard(base_path, max_seen, symbols));
+        last_.resize(workers);
+        pool_.reset(new ShardedPool<ShardTick>(
+            workers, ring_capacity, [this](size_t shard, ShardTick& item) { handle(shard, item); }, wait));
+    }
+
+    ShardedTickWriter(const ShardedTickWriter&) = delete;
+    ShardedTickWriter& operator=(const ShardedTickWriter&) = delete;
+
+    ~ShardedTickWriter() { stop(); }
+
+    /// 投递一批：按 shard_of 分到各分片，各分片的最后一条带批次结束标记；分片队列满时等待（背压）
+    void submit(const Tick* ticks, size_t n) {
+        const size_t workers = shards_.size();
+        for (size_t s = 0; s < workers; ++s) last_[s] = n;
+        for (size_t i = 0; i < n; ++i) last_[shard_of(ticks[i].instrument_id, workers)] = i;
+        for (size_t i = 0; i < n; ++i) {
+            const size_t s = shard_of(ticks[i].instrument_id, workers);
+            pool_->submit(s, ShardTick{ticks[i], last_[s] == i});
+        }
+    }
+
+    void flush() const { pool_->flush(); }
+    void stop() { pool_->stop(); }
+
+    size_t workers() const { return shards_.size(); }
+    /// 去重后写入的条数
+    uint64_t processed(size_t shard) const { return shards_[shard]->processed.load(std::memory_order_relaxed); }
+    /// 写入失败的文件次数
+    uint64_t errors(size_t shard) const { return shards_[shard]->errors.load(std::memory_order_relaxed); }
+    int last_errno(size_t shard) const { return shards_[shard]->last_errno.load(std::memory_order_relaxed); }
+    /// 分片队列中尚未处理的条数
+    size_t backlog(size_t shard) const { return pool_->backlog(shard); }
+
+private:
+    struct Shard {
+        Shard(const std::string& base_path, size_t max_seen, const SymbolTable& symbols)
+            : dedup(max_seen), writer(base_path, symbols) {}
+        TickDedup dedup;
+        CsvTickWriter writer;
+        size_t pending = 0;  ///< 本批已编码、尚未写出的条数
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<int> last_errno{0};
+    };
+
+    void handle(size_t shard, const ShardTick& item) {
+        Shard& s = *shards_[shard];
+        const Tick& t = item.tick;
+        if (t.last_price != 0.0 && s.dedup.insert(t.instrument_id, t.trade_date, t.time_us)) {
+            s.writer.append(t);
+            ++s.pending;
+        }
+        if (!item.batch_end) return;
+        s.dedup.end_batch();
+        const size_t failed = s.writer.flush();
+        if (failed) {
+            // 与 Python 分片一致：写入失败的批次计一次异常，不计入已处理
+            s.errors.fetch_add(1, std::memory_order_relaxed);
+            s.last_errno.store(s.writer.last_errno(), std::memory_order_relaxed);
+        } else {
+            s.processed.fetch_add(s.pending, std::memory_order_relaxed);
+        }
+        s.pending = 0;
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<size_t> last_;
+    std::unique_ptr<ShardedPool<ShardTick>> pool_;
+};
+
+}  // namespace fq
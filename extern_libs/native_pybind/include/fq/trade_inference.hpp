@@ -0,0 +1,219 @@
+/**
+ * fq/trade_inference.hpp: 由快照推断成交（Lee-Ready / 报价规则 + tick 规则）
+ *
+ * CTP/NSQ 等快照只给累计成交量与成交额。相邻两帧的差值即为区间成交：
+ *   数量 = Δvolume，VWAP = Δturnover / (Δvolume × 合约乘数)
+ * 主动方向按上一帧盘口判定：
+ *   VWAP >= 上一帧卖一 → 买方主动；<= 买一 → 卖方主动（报价规则）
+ *   盘口内按中间价比较（Lee-Ready）；恰在中间价时按 tick 规则与上一笔不同价比较，
+ *   平价沿用上一笔方向
+ * 累计量回退或交易所交易日变化时只重建基准；交易日见 exchange_trading_day（夜盘跨零点不算换日）。
+ * 状态按 instrument_id 存于定长数组，无哈希、无逐条分配；infer() 对整批连续处理。
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "fq/packed_tick.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+
+namespace fq {
+
+enum class TradeSide : int8_t { kUnknown = 0, kBuy = 1, kSell = -1 };
+enum class SideRule : uint8_t { kNone = 0, kQuote = 1, kMid = 2, kTick = 3 };
+
+struct InferredTrade {
+    int32_t instrument_id;
+    uint32_t trade_date;
+    int64_t time_us;
+    int64_t quantity;
+    double vwap;
+    double turnover;
+    double bid_price;   ///< 判定所用的上一帧买一
+    double ask_price;   ///< 判定所用的上一帧卖一
+    TradeSide side;
+    SideRule rule;
+};
+
+/// 单帧输入（与 Tick 字段对应，便于 dict 与批次两条路径共用）
+struct Snapshot {
+    int32_t instrument_id;
+    uint32_t trade_date;
+    int64_t time_us;
+    int64_t volume;      ///< 累计成交量
+    double turnover;     ///< 累计成交额，未知为 0
+    double last_price;
+    double bid_price_1;
+    double ask_price_1;
+};
+
+/// 自然日 + 当日时刻 -> 交易所交易日 YYYYMMDD：18:00 之后（夜盘）归下一自然日，
+/// 落在周六、周日的顺延到周一（不含节假日）；与 trade_inference.exchange_trading_day 一致
+inline uint32_t exchange_trading_day(uint32_t trade_date, int64_t time_us) {
+    int64_t days = days_from_civil(trade_date / 10000, trade_date / 100 % 100, trade_date % 100);
+    if (time_us >= 18LL * 3600 * 1000000) ++days;
+    const int64_t weekday = ((days + 3) % 7 + 7) % 7;  // 1970-01-01 为周四，周一为 0
+    if (weekday >= 5) days += 7 - weekday;
+    return civil_from_days(days);
+}
+
+inline Snapshot snapshot_of(const Tick& t) {
+    return Snapshot{t.instrument_id, t.trade_date, t.time_us, t.volume, t.turnover,
+                    t.last_price,    t.bid_price_1, t.ask_price_1};
+}
+
+class TradeInference {
+public:
+    explicit TradeInference(size_t capacity = kMaxInstruments)
+        : capacity_(capacity == 0 ? 1 : capacity), state_(new State[capacity_]()) {}
+
+    TradeInference(const TradeInference&) = delete;
+    TradeInference& operator=(const TradeInference&) = delete;
+
+    /// 指定合约乘数；未指定时由首笔成交的 Δturnover / (Δvolume × 最新价) 估计
+    void set_multiplier(int32_t instrument_id, double multiplier) {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= capacity_ || !(multiplier > 0)) return;
+        state_[instrument_id].multiplier = multiplier;
+    }
+
+    double multiplier(int32_t instrument_id) const {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= capacity_) return 0.0;
+        return state_[instrument_id].multiplier;
+    }
+
+    /// 处理一帧快照；区间内有成交时写入 out 并返回 true
+    bool on_snapshot(const Snapshot& s, InferredTrade& out) {
+        if (s.instrument_id < 0 || static_cast<size_t>(s.instrument_id) >= capacity_) return false;
+        State& st = state_[s.instrument_id];
+        const bool had_prev = st.valid;
+        const int64_t dv = s.volume - st.volume;
+        const double dt = s.turnover - st.turnover;
+        const double prev_bid = st.bid, prev_ask = st.ask;
+        // 累计量回退或交易日变化（换日、重连后重置）只重建基准
+        const uint32_t trading_day = exchange_trading_day(s.trade_date, s.time_us);
+        const bool reset = had_prev && (dv < 0 || trading_day != st.trading_day);
+        st.valid = true;
+        st.trading_day = trading_day;
+        st.volume = s.volume;
+        st.turnover = s.turnover;
+        if (s.bid_price_1 > 0) st.bid = s.bid_price_1;
+        if (s.ask_price_1 > 0) st.ask = s.ask_price_1;
+        if (!had_prev || reset || dv <= 0) return false;
+
+        double vwap = s.last_price;
+        if (dt > 0) {
+            if (!(st.multiplier > 0) && s.last_price > 0) {
+                const double est = dt / (static_cast<double>(dv) * s.last_price);
+                st.multiplier = est >= 0.5 ? std::round(est) : est;
+            }
+            if (st.multiplier > 0) vwap = dt / (static_cast<double>(dv) * st.multiplier);
+        }
+
+        out.instrument_id = s.instrument_id;
+        out.trade_date = s.trade_date;
+        out.time_us = s.time_us;
+        out.quantity = dv;
+        out.vwap = vwap;
+        out.turnover = dt > 0 ? dt : 0.0;
+        out.bid_price = prev_bid;
+        out.ask_price = prev_ask;
+        classify(st, vwap, prev_bid, prev_ask, out);
+        if (vwap != st.last_trade_price) {
+            st.prev_trade_price = st.last_trade_price;
+            st.last_trade_price = vwap;
+        }
+        st.last_side = out.side;
+        return true;
+    }
+
+    /// 批量处理，返回写入 out 的成交条数（out 至少 n 个槽位）
+    size_t infer(const Snapshot* snaps, size_t n, InferredTrade* out) {
+        size_t k = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (on_snapshot(snaps[i], out[k])) ++k;
+        return k;
+    }
+
+    size_t infer(const Tick* ticks, size_t n, InferredTrade* out) {
+        size_t k = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (on_snapshot(snapshot_of(ticks[i]), out[k])) ++k;
+        return k;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct State {
+        bool valid = false;
+        TradeSide last_side = TradeSide::kUnknown;
+        uint32_t trading_day = 0;  ///< 交易所交易日（非自然日）
+        int64_t volume = 0;
+        double turnover = 0.0;
+        double bid = 0.0;
+        double ask = 0.0;
+        double last_trade_price = 0.0;
+        double prev_trade_price = 0.0;
+        double multiplier = 0.0;
+    };
+
+    static void classify(const State& st, double px, double bid, double ask, InferredTrade& out) {
+        out.side = TradeSide::kUnknown;
+        out.rule = SideRule::kNone;
+        if (bid > 0 && ask > 0 && ask >= bid) {
+            if (px >= ask) {
+                out.side = TradeSide::kBuy;
+                out.rule = SideRule::kQuote;
+                return;
+            }
+            if (px <= bid) {
+                out.side = TradeSide::kSell;
+                out.rule = SideRule::kQuote;
+                return;
+            }
+            const double mid = 0.5 * (bid + ask);
+            if (px > mid) {
+                out.side = TradeSide::kBuy;
+                out.rule = SideRule::kMid;
+                return;
+            }
+            if (px < mid) {
+                out.side = TradeSide::kSell;
+                out.rule = SideRule::kMid;
+                return;
+            }
+        }
+        // tick 规则：与上一笔不同价的成交比较，平价沿用上一笔方向
+        const double ref = px != st.last_trade_price ? st.last_trade_price : st.prev_trade_price;
+        if (ref > 0 && px > ref) out.side = TradeSide::kBuy;
+        else if (ref > 0 && px < ref) out.side = TradeSide::kSell;
+        else out.side = st.last_side;
+        if (out.side != TradeSide::kUnknown) out.rule = SideRule::kTick;
+    }
+
+    size_t capacity_;
+    std::unique_ptr<State[]> state_;
+};
+
+inline const char* side_name(TradeSide side) {
+    switch (side) {
+        case TradeSide::kBuy: return "B";
+        case TradeSide::kSell: return "S";
+        default: return "";
+    }
+}
+
+inline const char* side_rule_name(SideRule rule) {
+    switch (rule) {
+        case SideRule::kQuote: return "quote";
+        case SideRule::kMid: return "mid";
+        case SideRule::kTick: return "tick";
+        default: return "";
+    }
+}
+
+}  // namespace fq
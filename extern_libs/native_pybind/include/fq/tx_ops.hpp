@@ -0,0 +1,30 @@
+/**
+ * fq/tx_ops.hpp: 原始以太网帧发送接口（跨扩展模块）
+ *
+ * 发送端（ExaNIC TX 缓冲区、软件帧环）以一组 C 函数指针 + 上下文描述，装在名为
+ * kTxOpsCapsule 的 PyCapsule 中在 exanic_pybind 与 native_pybind 之间传递，
+ * 发布者在解码线程内直接调用，不经 Python、不持 GIL。
+ * 本头文件同时被 exanic_pybind（C++11）包含，只使用 C++11 语法。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fq {
+
+constexpr const char kTxOpsCapsule[] = "fq.TxOps";
+
+struct TxOps {
+    void* ctx;
+    /// 在发送缓冲区中分配 frame_size 字节并返回写入位置；缓冲区不可用返回 nullptr
+    char* (*begin)(void* ctx, size_t frame_size);
+    /// 发送 begin 分配的帧（size 不超过申请值），成功返回 0
+    int (*end)(void* ctx, size_t size);
+    /// 放弃 begin 分配的帧
+    void (*abort)(void* ctx);
+    /// 最近一帧离开发送端的时间戳（ns；网卡为硬件时钟，软件帧环为 CLOCK_MONOTONIC），尚无帧为 0
+    int64_t (*last_tx_ns)(void* ctx);
+};
+
+}  // namespace fq
@@ -0,0 +1,314 @@
+/**
+ * fq/udp_publisher.hpp: 标准化行情的紧凑 UDP 帧编码与原始帧发布
+ *
+ * 帧结构：以太网（14）+ IPv4（20，无选项）+ UDP（8，校验和置 0）+ 载荷。
+ * 载荷：WireFrameHeader（16）+ count 条 WireTick（各 104 字节，小端定长，合约以代码传递，
+ * 接收方无需共享本进程的 instrument_id）。以太网 / IP / UDP 头在构造时按端点预先生成，
+ * 每帧只改写长度、IP 标识与 IP 头校验和。
+ * UdpTickPublisher 经 TxOps 直接写入发送缓冲区（ExaNIC TX 或软件帧环），在解码线程内调用；
+ * 每帧发送后有界自旋读取发送时间戳，变化即记为该帧时间戳，经 SPSC 环交给其他线程取走。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "fq/spsc_ring.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+#include "fq/tx_ops.hpp"
+
+namespace fq {
+
+constexpr uint32_t kWireMagic = 0x31545146;  ///< "FQT1"（小端）
+
+struct WireFrameHeader {
+    uint32_t magic;
+    uint16_t count;        ///< 本帧记录数
+    uint16_t record_size;  ///< sizeof(WireTick)，便于接收方兼容扩展
+    uint64_t seq;          ///< 帧序号（从 1 递增，接收方据此发现丢帧）
+};
+static_assert(sizeof(WireFrameHeader) == 16, "WireFrameHeader layout");
+
+struct WireTick {
+    char symbol[32];       ///< 零填充合约代码
+    uint32_t trade_date;
+    uint8_t exchange;
+    uint8_t source;
+    uint16_t flags;
+    int64_t time_us;
+    double last_price;
+    int64_t volume;
+    double turnover;
+    double open_interest;
+    double bid_price_1;
+    double ask_price_1;
+    uint32_t bid_volume_1;
+    uint32_t ask_volume_1;
+};
+static_assert(sizeof(WireTick) == 104, "WireTick layout");
+
+constexpr size_t kEthHeaderLen = 14;
+constexpr size_t kIpHeaderLen = 20;
+constexpr size_t kUdpHeaderLen = 8;
+constexpr size_t kTickFrameHeaderLen = kEthHeaderLen + kIpHeaderLen + kUdpHeaderLen;
+/// 单帧记录数上限（载荷不超过 1500 字节 MTU）
+constexpr size_t kMaxTicksPerFrame = (1500 - kIpHeaderLen - kUdpHeaderLen - sizeof(WireFrameHeader)) / sizeof(WireTick);
+
+inline size_t tick_frame_size(size_t count) {
+    return kTickFrameHeaderLen + sizeof(WireFrameHeader) + count * sizeof(WireTick);
+}
+
+/// 发送端点；IP 与端口为主机字节序
+struct UdpEndpoint {
+    uint8_t src_mac[6];
+    uint8_t dst_mac[6];
+    uint32_t src_ip;
+    uint32_t dst_ip;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t ttl;
+};
+
+/// 帧序号与发送时间戳
+struct TxStamp {
+    uint64_t seq;
+    int64_t tx_ns;
+};
+
+struct TxPublisherStats {
+    uint64_t frames = 0;
+    uint64_t ticks = 0;
+    uint64_t filtered = 0;   ///< 不在发布合约集合中
+    uint64_t errors = 0;     ///< 发送缓冲区不可用 / 提交失败（该帧的行情丢弃）
+    uint64_t stamped = 0;
+    uint64_t unstamped = 0;  ///< 自旋期间时间戳未更新
+    uint64_t stamp_overflow = 0;  ///< 时间戳环满，未被及时取走
+};
+
+inline void put_be16(char* p, uint16_t v) {
+    p[0] = static_cast<char>(v >> 8);
+    p[1] = static_cast<char>(v);
+}
+
+inline void put_be32(char* p, uint32_t v) {
+    put_be16(p, static_cast<uint16_t>(v >> 16));
+    put_be16(p + 2, static_cast<uint16_t>(v));
+}
+
+inline uint16_t get_be16(const char* p) {
+    return static_cast<uint16_t>((static_cast<uint8_t>(p[0]) << 8) | static_cast<uint8_t>(p[1]));
+}
+
+/// IPv4 头校验和（按 16 位大端字累加后取反）
+inline uint16_t ipv4_checksum(const char* header) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < kIpHeaderLen; i += 2) sum += get_be16(header + i);
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+inline void encode_wire_tick(const Tick& t, const char* symbol, size_t symbol_len, WireTick& w) {
+    std::memset(w.symbol, 0, sizeof(w.symbol));
+    std::memcpy(w.symbol, symbol, symbol_len < sizeof(w.symbol) ? symbol_len : sizeof(w.symbol) - 1);
+    w.trade_date = t.trade_date;
+    w.exchange = static_cast<uint8_t>(t.exchange);
+    w.source = static_cast<uint8_t>(t.source);
+    w.flags = t.flags;
+    w.time_us = t.time_us;
+    w.last_price = t.last_price;
+    w.volume = t.volume;
+    w.turnover = t.turnover;
+    w.open_interest = t.open_interest;
+    w.bid_price_1 = t.bid_price_1;
+    w.ask_price_1 = t.ask_price_1;
+    w.bid_volume_1 = static_cast<uint32_t>(t.bid_volume_1 < 0 ? 0 : t.bid_volume_1);
+    w.ask_volume_1 = static_cast<uint32_t>(t.ask_volume_1 < 0 ? 0 : t.ask_volume_1);
+}
+
+/**
+ * 解析一帧行情：校验以太网类型、IPv4/UDP、载荷魔数与长度后逐条回调 on_tick(const WireTick&)。
+ * @param dst_port 非 0 时只接受该目的端口
+ * @return 帧序号；非本协议帧返回 0
+ */
+template <typename F>
+uint64_t decode_tick_frame(const char* frame, size_t size, uint16_t dst_port, F&& on_tick) {
+    if (size < tick_frame_size(0) || get_be16(frame + 12) != 0x0800) return 0;
+    const char* ip = frame + kEthHeaderLen;
+    if (static_cast<uint8_t>(ip[0]) != 0x45 || static_cast<uint8_t>(ip[9]) != 17) return 0;
+    const char* udp = ip + kIpHeaderLen;
+    if (dst_port && get_be16(udp + 2) != dst_port) return 0;
+    WireFrameHeader h;
+    std::memcpy(&h, udp + kUdpHeaderLen, sizeof(h));
+    if (h.magic != kWireMagic || h.record_size != sizeof(WireTick) || size < tick_frame_size(h.count)) return 0;
+    const char* p = udp + kUdpHeaderLen + sizeof(h);
+    WireTick w;
+    for (uint16_t i = 0; i < h.count; ++i, p += sizeof(WireTick)) {
+        std::memcpy(&w, p, sizeof(w));
+        on_tick(w);
+    }
+    return h.seq;
+}
+
+class UdpTickPublisher {
+public:
+    /**
+     * @param ticks_per_frame 每帧最多打包的行情条数（1 为逐条发送，延迟最低）
+     * @param stamp_spins 每帧发送后读取时间戳的最多次数；0 不记录时间戳
+     * @param stamp_capacity 待取走时间戳的环容量
+     */
+    UdpTickPublisher(const TxOps& ops, const UdpEndpoint& endpoint, size_t ticks_per_frame = 1,
+                     size_t stamp_spins = 256, size_t stamp_capacity = 4096)
+        : ops_(ops),
+          ticks_per_frame_(ticks_per_frame == 0 ? 1
+                                                : (ticks_per_frame > kMaxTicksPerFrame ? kMaxTicksPerFrame
+                                                                                       : ticks_per_frame)),
+          stamp_spins_(stamp_spins),
+          stamps_(stamp_capacity),
+          dst_port_(endpoint.dst_port) {
+        build_template(endpoint);
+    }
+
+    UdpTickPublisher(const UdpTickPublisher&) = delete;
+    UdpTickPublisher& operator=(const UdpTickPublisher&) = delete;
+
+    /// 只发布 allow 过的合约；从未调用时发布全部
+    void allow(int32_t instrument_id) {
+        if (instrument_id < 0 || static_cast<size_t>(instrument_id) >= kMaxInstruments) return;
+        if (allowed_.empty()) allowed_.assign(kMaxInstruments, 0);
+        allowed_[static_cast<size_t>(instrument_id)] = 1;
+    }
+
+    /// 发布 ticks[0, n)，按 ticks_per_frame 打包；返回已发出的行情条数
+    size_t publish(const Tick* ticks, size_t n) {
+        const SymbolTable& table = global_symbol_table();
+        size_t sent = 0;
+        size_t i = 0;
+        while (i < n) {
+            // 先数出本帧可发布的条数（帧长须在 begin 前确定），再在同一区间内编码
+            size_t count = 0;
+            size_t end = i;
+            for (; end < n && count < ticks_per_frame_; ++end) {
+                if (publishable(ticks[end], table)) {
+                    ++count;
+                } else {
+                    ++stats_.filtered;
+                }
+            }
+            if (count == 0) {
+                i = end;
+                continue;
+            }
+            const size_t frame_size = tick_frame_size(count);
+            const int64_t before = stamp_spins_ ? ops_.last_tx_ns(ops_.ctx) : 0;
+            char* frame = ops_.begin(ops_.ctx, frame_size);
+            if (!frame) {
+                stats_.errors += count;
+                i = end;
+                continue;
+            }
+            const uint64_t seq = ++seq_;
+            fill_headers(frame, count, seq);
+            char* rec = frame + tick_frame_size(0);
+            WireTick w;
+            for (; i < end; ++i) {
+                const Tick& t = ticks[i];
+                if (!publishable(t, table)) continue;
+                encode_wire_tick(t, table.name(t.instrument_id), table.name_len(t.instrument_id), w);
+                std::memcpy(rec, &w, sizeof(w));
+                rec += sizeof(w);
+            }
+            if (ops_.end(ops_.ctx, frame_size) != 0) {
+                stats_.errors += count;
+                continue;
+            }
+            ++stats_.frames;
+            stats_.ticks += count;
+            sent += count;
+            if (stamp_spins_) record_stamp(seq, before);
+        }
+        return sent;
+    }
+
+    /// 取走一条发送时间戳（可在其他线程调用，单消费者）
+    bool pop_stamp(TxStamp& out) { return stamps_.try_pop(out); }
+
+    const TxPublisherStats& stats() const { return stats_; }
+    uint64_t seq() const { return seq_; }
+    size_t ticks_per_frame() const { return ticks_per_frame_; }
+    uint16_t dst_port() const { return dst_port_; }
+
+private:
+    bool allowed(int32_t instrument_id) const {
+        return allowed_.empty() || (instrument_id >= 0 && static_cast<size_t>(instrument_id) < allowed_.size() &&
+                                    allowed_[static_cast<size_t>(instrument_id)]);
+    }
+
+    bool publishable(const Tick& t, const SymbolTable& table) const {
+        return allowed(t.instrument_id) && table.name(t.instrument_id) != nullptr;
+    }
+
+    void build_template(const UdpEndpoint& ep) {
+        char* eth = header_;
+        std::memcpy(eth, ep.dst_mac, 6);
+        std::memcpy(eth + 6, ep.src_mac, 6);
+        put_be16(eth + 12, 0x0800);
+        char* ip = eth + kEthHeaderLen;
+        ip[0] = 0x45;
+        ip[1] = 0;
+        put_be16(ip + 6, 0x4000);  // DF，不分片
+        ip[8] = static_cast<char>(ep.ttl ? ep.ttl : 64);
+        ip[9] = 17;
+        put_be32(ip + 12, ep.src_ip);
+        put_be32(ip + 16, ep.dst_ip);
+        char* udp = ip + kIpHeaderLen;
+        put_be16(udp, ep.src_port);
+        put_be16(udp + 2, ep.dst_port);
+    }
+
+    void fill_headers(char* frame, size_t count, uint64_t seq) {
+        std::memcpy(frame, header_, kTickFrameHeaderLen);
+        const size_t payload = sizeof(WireFrameHeader) + count * sizeof(WireTick);
+        char* ip = frame + kEthHeaderLen;
+        put_be16(ip + 2, static_cast<uint16_t>(kIpHeaderLen + kUdpHeaderLen + payload));
+        put_be16(ip + 4, ip_id_++);
+        put_be16(ip + 10, ipv4_checksum(ip));
+        put_be16(ip + kIpHeaderLen + 4, static_cast<uint16_t>(kUdpHeaderLen + payload));
+        WireFrameHeader h;
+        h.magic = kWireMagic;
+        h.count = static_cast<uint16_t>(count);
+        h.record_size = static_cast<uint16_t>(sizeof(WireTick));
+        h.seq = seq;
+        std::memcpy(frame + kTickFrameHeaderLen, &h, sizeof(h));
+    }
+
+    void record_stamp(uint64_t seq, int64_t before) {
+        for (size_t spins = 0; spins < stamp_spins_; ++spins) {
+            const int64_t ts = ops_.last_tx_ns(ops_.ctx);
+            if (ts != before) {
+                if (stamps_.try_push(TxStamp{seq, ts})) {
+                    ++stats_.stamped;
+                } else {
+                    ++stats_.stamp_overflow;
+                }
+                return;
+            }
+        }
+        ++stats_.unstamped;
+    }
+
+    TxOps ops_;
+    size_t ticks_per_frame_;
+    size_t stamp_spins_;
+    SpscRing<TxStamp> stamps_;
+    uint16_t dst_port_;
+    uint16_t ip_id_ = 0;
+    uint64_t seq_ = 0;
+    char header_[kTickFrameHeaderLen] = {};
+    std::vector<uint8_t> allowed_;
+    TxPublisherStats stats_;
+};
+
+}  // namespace fq
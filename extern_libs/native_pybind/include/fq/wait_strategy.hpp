@@ -0,0 +1,183 @@
+/**
+ * fq/wait_strategy.hpp: 消费者循环的空闲等待策略
+ *
+ * 消费者每次未取到数据调用 idle()，取到数据调用 reset()；生产者可调用 notify()
+ * 唤醒处于休眠阶段的消费者。四种模式按延迟/CPU 取舍：
+ * - busy_spin：只自旋（PAUSE 指数退避），延迟最低，独占一个核
+ * - spin_yield：先自旋 spin_iters 次，之后每次 sched_yield
+ * - spin_park：自旋 → yield → futex 休眠（park_timeout 超时或 notify 唤醒）
+ * - timed_block：直接 futex 休眠 block_timeout（等价于原先的固定 sleep，可被 notify 提前唤醒）
+ * 各阶段耗时分别累计，便于评估 CPU 花在哪里。
+ */
+#pragma once
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace fq {
+
+/// 单次 CPU 自旋提示（x86 PAUSE / ARM YIELD），降低自旋时的功耗与超线程争用
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+enum class WaitMode : uint8_t {
+    kBusySpin = 0,
+    kSpinYield = 1,
+    kSpinPark = 2,
+    kTimedBlock = 3,
+};
+
+inline const char* wait_mode_name(WaitMode mode) {
+    switch (mode) {
+        case WaitMode::kBusySpin: return "busy_spin";
+        case WaitMode::kSpinYield: return "spin_yield";
+        case WaitMode::kSpinPark: return "spin_park";
+        default: return "timed_block";
+    }
+}
+
+/// 名称 -> 模式；未知名称返回 false
+inline bool wait_mode_from_name(const char* name, WaitMode& mode) {
+    static const WaitMode kAll[] = {WaitMode::kBusySpin, WaitMode::kSpinYield, WaitMode::kSpinPark,
+                                    WaitMode::kTimedBlock};
+    for (WaitMode m : kAll) {
+        if (std::strcmp(wait_mode_name(m), name) == 0) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct WaitConfig {
+    WaitMode mode = WaitMode::kSpinPark;
+    uint32_t spin_iters = 1000;             ///< 自旋阶段的 idle() 次数
+    uint32_t yield_iters = 100;             ///< spin_park 中 yield 阶段的 idle() 次数
+    uint32_t max_pause = 64;                ///< 单次 idle() 最多 PAUSE 次数（指数退避上限）
+    int64_t park_timeout_ns = 1000000;      ///< spin_park 休眠超时
+    int64_t block_timeout_ns = 100000;      ///< timed_block 休眠超时
+};
+
+struct WaitStats {
+    uint64_t spin_ns = 0;
+    uint64_t yield_ns = 0;
+    uint64_t park_ns = 0;
+    uint64_t spins = 0;    ///< 自旋阶段 idle() 次数
+    uint64_t yields = 0;
+    uint64_t parks = 0;
+    uint64_t wakeups = 0;  ///< 休眠被 notify 提前唤醒的次数
+};
+
+class WaitStrategy {
+public:
+    explicit WaitStrategy(const WaitConfig& config = WaitConfig()) : cfg_(config) {
+        cfg_.max_pause = std::max<uint32_t>(1, cfg_.max_pause);
+    }
+
+    WaitStrategy(const WaitStrategy&) = delete;
+    WaitStrategy& operator=(const WaitStrategy&) = delete;
+
+    /// 消费者：本轮未取到数据，按当前阶段等待一次
+    void idle() {
+        const uint64_t n = idle_count_++;
+        switch (cfg_.mode) {
+            case WaitMode::kBusySpin:
+                spin();
+                return;
+            case WaitMode::kSpinYield:
+                if (n < cfg_.spin_iters) spin();
+                else yield();
+                return;
+            case WaitMode::kSpinPark:
+                if (n < cfg_.spin_iters) spin();
+                else if (n < static_cast<uint64_t>(cfg_.spin_iters) + cfg_.yield_iters) yield();
+                else park(cfg_.park_timeout_ns);
+                return;
+            case WaitMode::kTimedBlock:
+                park(cfg_.block_timeout_ns);
+                return;
+        }
+    }
+
+    /// 消费者：取到数据，回到自旋阶段
+    void reset() {
+        idle_count_ = 0;
+        pause_ = 1;
+    }
+
+    /// 生产者：唤醒休眠中的消费者（无人休眠时只有一次原子加）。
+    /// 消费者检查队列与进入休眠之间到达的数据最多延迟一个超时周期。
+    void notify() {
+        seq_.fetch_add(1, std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_seq_cst) > 0) futex_wake(&seq_);
+    }
+
+    const WaitStats& stats() const { return stats_; }
+    const WaitConfig& config() const { return cfg_; }
+
+private:
+    static int64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    static void futex_wake(std::atomic<uint32_t>* word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+
+    void spin() {
+        const int64_t t0 = now_ns();
+        for (uint32_t i = 0; i < pause_; ++i) cpu_relax();
+        pause_ = std::min(pause_ * 2, cfg_.max_pause);
+        stats_.spin_ns += static_cast<uint64_t>(now_ns() - t0);
+        ++stats_.spins;
+    }
+
+    void yield() {
+        const int64_t t0 = now_ns();
+        sched_yield();
+        stats_.yield_ns += static_cast<uint64_t>(now_ns() - t0);
+        ++stats_.yields;
+    }
+
+    void park(int64_t timeout_ns) {
+        const uint32_t seen = seq_.load(std::memory_order_acquire);
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout_ns / 1000000000LL);
+        ts.tv_nsec = static_cast<long>(timeout_ns % 1000000000LL);
+        const int64_t t0 = now_ns();
+        parked_.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq_), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+        parked_.fetch_sub(1, std::memory_order_acq_rel);
+        stats_.park_ns += static_cast<uint64_t>(now_ns() - t0);
+        ++stats_.parks;
+        if (seq_.load(std::memory_order_acquire) != seen) ++stats_.wakeups;
+    }
+
+    WaitConfig cfg_;
+    WaitStats stats_;
+    uint64_t idle_count_ = 0;
+    uint32_t pause_ = 1;
+    alignas(64) std::atomic<uint32_t> seq_{0};
+    std::atomic<uint32_t> parked_{0};
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32-bit");
+
+}  // namespace fq
@@ -0,0 +1,838 @@
+/**
+ * fq/ws_fanout.hpp: 最新行情表 + epoll WebSocket 扇出（看板本地 / 局域网推送）
+ *
+ * SnapshotTable：按 instrument_id 的定长槽位，每槽为该合约最新一条 PackedTick（见 packed_tick.hpp）
+ * 加成交额，seqlock 保护（每合约单写者），每槽两条缓存行。
+ * 行情线程只做一次槽位写入（publish），与客户端个数、快慢无关，不分配内存、不触碰任何 socket。
+ *
+ * WsFanoutServer：独立线程上的非阻塞 epoll 循环，负责全部连接：
+ *   - RFC 6455 握手（GET 请求的查询参数可直接给出 symbols / rate / format），之后只收文本命令：
+ *       subscribe <合约...|*>、unsubscribe <合约...|*>、rate <Hz>、format json|binary
+ *     合约只在全局符号表中查找、不登记；尚未出现的合约记入该客户端的待解析列表（至多 kMaxPending 个），
+ *     符号表增长后重新查找，出现即转为订阅
+ *   - 每个客户端按自己的频率取一次表：只发送自上次发送后版本变化的已订阅合约（即按客户端合并），
+ *     合并为一条消息——json 为 {"seq":n,"ticks":[...]} 文本帧，binary 为 WireFrameHeader + WireTick
+ *     （与 udp_publisher.hpp 的载荷一致）二进制帧
+ *   - 上一条消息尚未被内核接收完（慢客户端）时跳过本轮（记入 conflated），下一轮直接发送届时的最新值；
+ *     因此每个客户端至多积压一条消息，慢客户端不会拖住任何其他线程
+ *   - pong / close / 错误回复等控制帧另计：未发出的控制帧超过 kMaxControlBacklog 字节
+ *     （只发 ping 不读的客户端）即断开，与数据帧同样有界
+ */
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fq/packed_tick.hpp"
+#include "fq/symbol_table.hpp"
+#include "fq/tick.hpp"
+#include "fq/udp_publisher.hpp"
+
+namespace fq {
+
+class SnapshotTable {
+public:
+    explicit SnapshotTable(size_t capacity = kMaxInstruments)
+        : capacity_(capacity == 0 ? 1 : capacity), slots_(new Slot[capacity_]) {}
+
+    SnapshotTable(const SnapshotTable&) = delete;
+    SnapshotTable& operator=(const SnapshotTable&) = delete;
+
+    /// 写入合约最新行情（同一合约单写者）；instrument_id 越界忽略。receive_time_ns 由调用方给出（可每批取一次）
+    void publish(const Tick& t, int64_t receive_time_ns = 0) {
+        if (t.instrument_id < 0 || static_cast<size_t>(t.instrument_id) >= capacity_) return;
+        Slot& s = slots_[static_cast<size_t>(t.instrument_id)];
+        const uint64_t v = s.seq.load(std::memory_order_relaxed);
+        s.seq.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.turnover = t.turnover;
+        pack_tick(t, receive_time_ns, s.tick);
+        s.seq.store(v + 2, std::memory_order_release);
+        int32_t hw = high_water_.load(std::memory_order_relaxed);
+        while (t.instrument_id >= hw &&
+               !high_water_.compare_exchange_weak(hw, t.instrument_id + 1, std::memory_order_release)) {
+        }
+    }
+
+    /// 槽位版本（写入次数），0 为尚无行情；读取方据此判断是否有更新
+    uint64_t version(int32_t iid) const {
+        if (iid < 0 || static_cast<size_t>(iid) >= capacity_) return 0;
+        return slots_[static_cast<size_t>(iid)].seq.load(std::memory_order_acquire) >> 1;
+    }
+
+    /// 一致地读取槽位行情及其版本；尚无行情或写入中途返回 false
+    bool read(int32_t iid, PackedTick& out, double& turnover, uint64_t& version) const {
+        if (iid < 0 || static_cast<size_t>(iid) >= capacity_) return false;
+        const Slot& s = slots_[static_cast<size_t>(iid)];
+        for (int spins = 0; spins < 1024; ++spins) {
+            const uint64_t a = s.seq.load(std::memory_order_acquire);
+            if (a & 1u) continue;
+            out = s.tick;
+            turnover = s.turnover;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) == a) {
+                version = a >> 1;
+                return a != 0;
+            }
+        }
+        return false;
+    }
+
+    /// 同上，展开为 fq::Tick（开高低等冷字段为 0）
+    bool read(int32_t iid, Tick& out, uint64_t& version) const {
+        PackedTick p;
+        double turnover;
+        if (!read(iid, p, turnover, version)) return false;
+        unpack_tick(p, nullptr, out);
+        out.turnover = turnover;
+        return true;
+    }
+
+    /// 已写入过的最大 instrument_id + 1
+    int32_t high_water() const { return high_water_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};  ///< seqlock：奇数表示写入中，seq / 2 为版本
+        double turnover = 0.0;         ///< PackedTick 不含成交额，与 seq 同一缓存行
+        PackedTick tick{};
+    };
+    static_assert(sizeof(Slot) == 128, "SnapshotTable slot is two cache lines");
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<int32_t> high_water_{0};
+};
+
+// ---------------------------------------------------------------------------------------------
+// WebSocket 握手与帧
+
+/// SHA-1（仅用于握手 Sec-WebSocket-Accept）
+inline void sha1(const void* data, size_t n, uint8_t out[20]) {
+    uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u};
+    auto rol = [](uint32_t x, int k) { return (x << k) | (x >> (32 - k)); };
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint64_t bits = static_cast<uint64_t>(n) * 8;
+    const size_t total = (n + 9 + 63) / 64 * 64;
+    uint8_t block[64];
+    for (size_t off = 0; off < total; off += 64) {
+        for (size_t i = 0; i < 64; ++i) {
+            const size_t k = off + i;
+            if (k < n) {
+                block[i] = p[k];
+            } else if (k == n) {
+                block[i] = 0x80;
+            } else if (k >= total - 8) {
+                block[i] = static_cast<uint8_t>(bits >> (8 * (total - 1 - k)));
+            } else {
+                block[i] = 0;
+            }
+        }
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+            w[i] = static_cast<uint32_t>(block[4 * i]) << 24 | static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+                   static_cast<uint32_t>(block[4 * i + 2]) << 8 | block[4 * i + 3];
+        for (int i = 16; i < 80; ++i) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d), k = 0x5A827999u;
+            } else if (i < 40) {
+                f = b ^ c ^ d, k = 0x6ED9EBA1u;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDCu;
+            } else {
+                f = b ^ c ^ d, k = 0xCA62C1D6u;
+            }
+            const uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d, d = c, c = rol(b, 30), b = a, a = t;
+        }
+        h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+    }
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 4; ++j) out[4 * i + j] = static_cast<uint8_t>(h[i] >> (24 - 8 * j));
+}
+
+inline std::string base64_encode(const uint8_t* p, size_t n) {
+    static const char kTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((n + 2) / 3 * 4);
+    for (size_t i = 0; i < n; i += 3) {
+        const uint32_t v = static_cast<uint32_t>(p[i]) << 16 | (i + 1 < n ? static_cast<uint32_t>(p[i + 1]) << 8 : 0) |
+                           (i + 2 < n ? p[i + 2] : 0);
+        out.push_back(kTable[v >> 18 & 63]);
+        out.push_back(kTable[v >> 12 & 63]);
+        out.push_back(i + 1 < n ? kTable[v >> 6 & 63] : '=');
+        out.push_back(i + 2 < n ? kTable[v & 63] : '=');
+    }
+    return out;
+}
+
+/// Sec-WebSocket-Accept = base64(sha1(key + GUID))
+inline std::string websocket_accept(const std::string& key) {
+    const std::string s = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    sha1(s.data(), s.size(), digest);
+    return base64_encode(digest, sizeof(digest));
+}
+
+enum WsOpcode : uint8_t { kWsText = 0x1, kWsBinary = 0x2, kWsClose = 0x8, kWsPing = 0x9, kWsPong = 0xA };
+
+/// 服务端帧头（FIN、不掩码），写入 out（至多 10 字节），返回长度
+inline size_t ws_frame_header(char* out, uint8_t opcode, uint64_t len) {
+    out[0] = static_cast<char>(0x80 | opcode);
+    if (len < 126) {
+        out[1] = static_cast<char>(len);
+        return 2;
+    }
+    if (len <= 0xFFFF) {
+        out[1] = 126;
+        put_be16(out + 2, static_cast<uint16_t>(len));
+        return 4;
+    }
+    out[1] = 127;
+    put_be32(out + 2, static_cast<uint32_t>(len >> 32));
+    put_be32(out + 6, static_cast<uint32_t>(len));
+    return 10;
+}
+
+/// 当日微秒 + 行情日期 -> "YYYY-MM-DDTHH:MM:SS.ffffff"（与 datetime.isoformat(timespec="microseconds") 一致）
+inline size_t format_iso_datetime(char* out, uint32_t trade_date, int64_t time_us) {
+    const int64_t sec = time_us / 1000000;
+    return static_cast<size_t>(std::snprintf(out, 32, "%04u-%02u-%02uT%02d:%02d:%02d.%06d", trade_date / 10000,
+                                             trade_date / 100 % 100, trade_date % 100, static_cast<int>(sec / 3600),
+                                             static_cast<int>(sec / 60 % 60), static_cast<int>(sec % 60),
+                                             static_cast<int>(time_us % 1000000)));
+}
+
+/// JSON 数值：%.15g，非有限值为 null（与 src/api/ws_fanout.py 一致）
+inline void json_append_double(std::string& out, double v) {
+    if (!std::isfinite(v)) {
+        out.append("null");
+        return;
+    }
+    char buf[32];
+    out.append(buf, static_cast<size_t>(std::snprintf(buf, sizeof(buf), "%.15g", v)));
+}
+
+inline void json_append_int(std::string& out, int64_t v) {
+    char buf[24];
+    out.append(buf, static_cast<size_t>(std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v))));
+}
+
+/// 单条行情的 JSON 对象，键顺序与 src/api/ws_fanout.py 一致
+inline void json_append_tick(std::string& out, const Tick& t, const char* symbol, size_t symbol_len) {
+    char dt[32];
+    const char* ex = exchange_name(t.exchange);
+    out.append("{\"symbol\":\"").append(symbol, symbol_len);
+    out.append("\",\"exchange\":\"").append(ex);
+    out.append("\",\"datetime\":\"").append(dt, format_iso_datetime(dt, t.trade_date, t.time_us));
+    out.append("\",\"last_price\":");
+    json_append_double(out, t.last_price);
+    out.append(",\"volume\":");
+    json_append_int(out, t.volume);
+    out.append(",\"turnover\":");
+    json_append_double(out, t.turnover);
+    out.append(",\"open_interest\":");
+    json_append_double(out, t.open_interest);
+    out.append(",\"bid_price_1\":");
+    json_append_double(out, t.bid_price_1);
+    out.append(",\"bid_volume_1\":");
+    json_append_int(out, t.bid_volume_1);
+    out.append(",\"ask_price_1\":");
+    json_append_double(out, t.ask_price_1);
+    out.append(",\"ask_volume_1\":");
+    json_append_int(out, t.ask_volume_1);
+    out.push_back('}');
+}
+
+// ---------------------------------------------------------------------------------------------
+
+struct WsFanoutOptions {
+    std::string host = "127.0.0.1";
+    uint16_t port = 8765;          ///< 0 为由系统分配（见 WsFanoutServer::port）
+    double default_rate = 4.0;     ///< 客户端未指定时的推送频率（Hz）
+    double max_rate = 50.0;        ///< 客户端可请求的最高频率
+    size_t max_clients = 256;
+    bool binary = false;           ///< 客户端未指定时的格式
+};
+
+struct WsFanoutStats {
+    uint64_t clients = 0;    ///< 当前连接数（已完成握手）
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;   ///< 超过 max_clients 或握手失败
+    uint64_t messages = 0;   ///< 推送的更新消息数
+    uint64_t ticks = 0;      ///< 推送的行情条数（合并后）
+    uint64_t bytes = 0;
+    uint64_t conflated = 0;  ///< 因上一条消息未发完而跳过的轮次
+};
+
+class WsFanoutServer {
+public:
+    WsFanoutServer(const SnapshotTable& table, WsFanoutOptions options)
+        : table_(table), opt_(std::move(options)) {
+        if (!(opt_.max_rate > 0)) opt_.max_rate = 50.0;
+        opt_.default_rate = clamp_rate(opt_.default_rate);
+    }
+
+    ~WsFanoutServer() { stop(); }
+
+    WsFanoutServer(const WsFanoutServer&) = delete;
+    WsFanoutServer& operator=(const WsFanoutServer&) = delete;
+
+    /// 监听并启动服务线程；失败返回 false 并写入 error
+    bool start(std::string* error = nullptr) {
+        if (thread_.joinable()) return true;
+        auto fail = [&](const char* what) {
+            if (error) *error = std::string(what) + ": " + std::strerror(errno);
+            close_fds();
+            return false;
+        };
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) return fail("socket");
+        const int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(opt_.port);
+        if (::inet_pton(AF_INET, opt_.host.c_str(), &addr.sin_addr) != 1) {
+            errno = EINVAL;
+            return fail("invalid host");
+        }
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return fail("bind");
+        if (::listen(listen_fd_, 128) != 0) return fail("listen");
+        socklen_t len = sizeof(addr);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wake_fd_ < 0) return fail("epoll");
+        add_fd(listen_fd_, EPOLLIN);
+        add_fd(wake_fd_, EPOLLIN);
+        stop_.store(false, std::memory_order_relaxed);
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    /// 停止服务线程并关闭全部连接（可重复调用）
+    void stop() {
+        if (thread_.joinable()) {
+            stop_.store(true, std::memory_order_release);
+            const uint64_t one = 1;
+            (void)!::write(wake_fd_, &one, sizeof(one));
+            thread_.join();
+        }
+        close_fds();
+    }
+
+    bool running() const { return thread_.joinable(); }
+    uint16_t port() const { return port_; }
+
+    WsFanoutStats stats() const {
+        WsFanoutStats s;
+        s.clients = clients_.load(std::memory_order_relaxed);
+        s.accepted = accepted_.load(std::memory_order_relaxed);
+        s.rejected = rejected_.load(std::memory_order_relaxed);
+        s.messages = messages_.load(std::memory_order_relaxed);
+        s.ticks = ticks_.load(std::memory_order_relaxed);
+        s.bytes = bytes_.load(std::memory_order_relaxed);
+        s.conflated = conflated_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kMaxRequest = 8192;   ///< 握手请求上限
+    static constexpr size_t kMaxCommand = 4096;   ///< 客户端单条消息上限
+    static constexpr size_t kMaxPending = 256;    ///< 每客户端待解析合约上限
+    static constexpr size_t kMaxControlBacklog = 4 * kMaxCommand;  ///< 每客户端未发出的控制帧字节上限
+
+    struct Client {
+        int fd = -1;
+        bool open = false;     ///< 已完成握手
+        bool binary = false;
+        bool all = false;      ///< subscribe *
+        int64_t interval_ns = 0;
+        int64_t next_due = 0;
+        uint64_t seq = 0;
+        std::string in;
+        std::string out;       ///< 未被内核接收的剩余字节（至多一条消息 + 控制帧）
+        size_t out_off = 0;
+        size_t control = 0;    ///< out 中尚未发出的控制帧字节数（out 清空时归零）
+        bool overflow = false; ///< 控制帧积压超过 kMaxControlBacklog，待断开
+        std::vector<int32_t> iids;      ///< 显式订阅
+        std::vector<uint64_t> sent;     ///< 与 iids 对应的已发送版本
+        std::vector<uint64_t> all_sent; ///< subscribe * 时按 instrument_id 的已发送版本
+        std::vector<std::string> pending;  ///< 订阅时符号表中尚无的合约（规范化代码）
+        size_t pending_checked = 0;        ///< 上次解析 pending 时的符号表大小
+    };
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    double clamp_rate(double hz) const {
+        if (!(hz > 0)) return opt_.default_rate > 0 ? opt_.default_rate : 4.0;
+        return hz > opt_.max_rate ? opt_.max_rate : hz;
+    }
+
+    void add_fd(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void mod_fd(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    void close_fds() {
+        for (auto& kv : clients_by_fd_) ::close(kv.first);
+        clients_by_fd_.clear();
+        clients_.store(0, std::memory_order_relaxed);
+        for (int* fd : {&listen_fd_, &epoll_fd_, &wake_fd_}) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    void run() {
+        epoll_event events[64];
+        while (!stop_.load(std::memory_order_acquire)) {
+            const int n = ::epoll_wait(epoll_fd_, events, 64, next_timeout_ms());
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[i].data.fd;
+                if (fd == wake_fd_) continue;
+                if (fd == listen_fd_) {
+                    accept_all();
+                    continue;
+                }
+                auto it = clients_by_fd_.find(fd);
+                if (it == clients_by_fd_.end()) continue;
+                Client& c = *it->second;
+                bool ok = true;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) ok = false;
+                if (ok && (events[i].events & EPOLLOUT)) ok = flush(c);
+                if (ok && (events[i].events & EPOLLIN)) ok = on_readable(c);
+                if (!ok) drop(fd);
+            }
+            send_due();
+        }
+    }
+
+    int next_timeout_ms() const {
+        int64_t earliest = -1;
+        for (const auto& kv : clients_by_fd_) {
+            const Client& c = *kv.second;
+            if (c.open && (earliest < 0 || c.next_due < earliest)) earliest = c.next_due;
+        }
+        if (earliest < 0) return 100;
+        const int64_t wait = earliest - now_ns();
+        if (wait <= 0) return 0;
+        const int64_t ms = (wait + 999999) / 1000000;
+        return ms > 100 ? 100 : static_cast<int>(ms);
+    }
+
+    void accept_all() {
+        for (;;) {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            if (clients_by_fd_.size() >= opt_.max_clients) {
+                ::close(fd);
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::unique_ptr<Client> c(new Client);
+            c->fd = fd;
+            c->binary = opt_.binary;
+            c->interval_ns = static_cast<int64_t>(1e9 / opt_.default_rate);
+            clients_by_fd_.emplace(fd, std::move(c));
+            add_fd(fd, EPOLLIN);
+            accepted_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void drop(int fd) {
+        auto it = clients_by_fd_.find(fd);
+        if (it == clients_by_fd_.end()) return;
+        if (it->second->open) clients_.fetch_sub(1, std::memory_order_relaxed);
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        clients_by_fd_.erase(it);
+    }
+
+    bool on_readable(Client& c) {
+        char buf[4096];
+        for (;;) {
+            const ssize_t n = ::recv(c.fd, buf, sizeof(buf), 0);
+            if (n == 0) return false;
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                return false;
+            }
+            c.in.append(buf, static_cast<size_t>(n));
+            // 已握手的连接边收边解析，连续的小帧不会累积到上限；只发不收的客户端由控制帧积压上限断开
+            if (c.open && !parse_frames(c)) return false;
+            if (c.in.size() > kMaxRequest + kMaxCommand) return false;
+        }
+        return c.open ? parse_frames(c) : handshake(c);
+    }
+
+    // ---- 握手 ----
+
+    static std::string lower(std::string s) {
+        for (char& ch : s)
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+        return s;
+    }
+
+    static std::string url_decode(const std::string& s) {
+        std::string out;
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '%' && i + 2 < s.size()) {
+                out.push_back(static_cast<char>(std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16)));
+                i += 2;
+            } else {
+                out.push_back(s[i] == '+' ? ' ' : s[i]);
+            }
+        }
+        return out;
+    }
+
+    bool handshake(Client& c) {
+        const size_t end = c.in.find("\r\n\r\n");
+        if (end == std::string::npos) return c.in.size() <= kMaxRequest;
+        const std::string request = c.in.substr(0, end);
+        c.in.erase(0, end + 4);
+        std::string key;
+        size_t pos = request.find("\r\n");
+        const std::string line = request.substr(0, pos);
+        while (pos != std::string::npos) {
+            const size_t next = request.find("\r\n", pos + 2);
+            const std::string header = request.substr(pos + 2, next == std::string::npos ? std::string::npos : next - pos - 2);
+            const size_t colon = header.find(':');
+            if (colon != std::string::npos && lower(header.substr(0, colon)) == "sec-websocket-key") {
+                key = header.substr(colon + 1);
+                key.erase(0, key.find_first_not_of(" \t"));
+                key.erase(key.find_last_not_of(" \t") + 1);
+            }
+            pos = next;
+        }
+        if (line.compare(0, 4, "GET ") != 0 || key.empty()) {
+            const char kBad[] = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            (void)!::send(c.fd, kBad, sizeof(kBad) - 1, MSG_NOSIGNAL);
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        c.out.append("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: ");
+        c.out.append(websocket_accept(key)).append("\r\n\r\n");
+        c.open = true;
+        clients_.fetch_add(1, std::memory_order_relaxed);
+        // 查询参数与命令等价：/?symbols=rb2505,cu2505&rate=10&format=binary
+        const size_t target_end = line.find(' ', 4);
+        const std::string target = line.substr(4, target_end == std::string::npos ? std::string::npos : target_end - 4);
+        const size_t q = target.find('?');
+        if (q != std::string::npos) {
+            std::string query = target.substr(q + 1);
+            size_t i = 0;
+            while (i <= query.size()) {
+                size_t amp = query.find('&', i);
+                if (amp == std::string::npos) amp = query.size();
+                const std::string kv = query.substr(i, amp - i);
+                const size_t eq = kv.find('=');
+                if (eq != std::string::npos) {
+                    const std::string k = kv.substr(0, eq), v = url_decode(kv.substr(eq + 1));
+                    if (k == "symbols") command(c, "subscribe " + v);
+                    if (k == "rate") command(c, "rate " + v);
+                    if (k == "format") command(c, "format " + v);
+                }
+                i = amp + 1;
+            }
+        }
+        c.next_due = now_ns();
+        if (c.overflow || !flush(c)) return false;
+        return c.in.empty() || parse_frames(c);
+    }
+
+    // ---- 客户端帧与命令 ----
+
+    bool parse_frames(Client& c) {
+        size_t off = 0;
+        while (c.in.size() - off >= 2) {
+            const uint8_t b0 = static_cast<uint8_t>(c.in[off]), b1 = static_cast<uint8_t>(c.in[off + 1]);
+            if (!(b1 & 0x80) || !(b0 & 0x80)) return false;  // 客户端帧必须掩码；不支持分片
+            uint64_t len = b1 & 0x7F;
+            size_t hdr = 2;
+            if (len == 126) {
+                if (c.in.size() - off < 4) break;
+                len = get_be16(c.in.data() + off + 2);
+                hdr = 4;
+            } else if (len == 127) {
+                return false;
+            }
+            if (len > kMaxCommand) return false;
+            if (c.in.size() - off < hdr + 4 + len) break;
+            const char* mask = c.in.data() + off + hdr;
+            std::string payload(c.in.data() + off + hdr + 4, static_cast<size_t>(len));
+            for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+            off += hdr + 4 + static_cast<size_t>(len);
+            switch (b0 & 0x0F) {
+                case kWsText:
+                case kWsBinary:
+                    command(c, payload);
+                    break;
+                case kWsPing:
+                    queue_frame(c, kWsPong, payload.data(), payload.size());
+                    break;
+                case kWsClose:
+                    if (queue_frame(c, kWsClose, payload.data(), payload.size() < 2 ? payload.size() : 2)) flush(c);
+                    return false;
+                default:
+                    break;
+            }
+            if (c.overflow) return false;  // 只发不收的客户端：控制帧积压有界，超过即断开
+        }
+        c.in.erase(0, off);
+        return flush(c);
+    }
+
+    void command(Client& c, const std::string& text) {
+        std::vector<std::string> tok;
+        std::string cur;
+        for (char ch : text) {
+            if (ch == ' ' || ch == ',' || ch == '\t' || ch == '\r' || ch == '\n') {
+                if (!cur.empty()) tok.push_back(cur), cur.clear();
+            } else {
+                cur.push_back(ch);
+            }
+        }
+        if (!cur.empty()) tok.push_back(cur);
+        if (tok.empty()) return;
+        const std::string& op = tok[0];
+        if (op == "subscribe" || op == "unsubscribe") {
+            const bool add = op == "subscribe";
+            for (size_t i = 1; i < tok.size(); ++i) {
+                if (tok[i] == "*") {
+                    c.all = add;
+                    c.all_sent.clear();
+                    if (!add) c.iids.clear(), c.sent.clear(), c.pending.clear();
+                    continue;
+                }
+                SymbolKey key{};
+                if (!normalize_symbol(tok[i].data(), tok[i].size(), key)) continue;
+                // 客户端给出的名字只查不登记，避免任意连接填满全局符号表
+                const int32_t iid = global_symbol_table().find(key.bytes, key.len);
+                if (iid != kInvalidInstrument) {
+                    set_subscribed(c, iid, add);
+                    continue;
+                }
+                const std::string name(key.bytes, key.len);
+                size_t k = 0;
+                while (k < c.pending.size() && c.pending[k] != name) ++k;
+                if (add && k == c.pending.size()) {
+                    if (c.pending.size() >= kMaxPending) {
+                        const std::string err = "{\"error\":\"too many pending symbols\"}";
+                        queue_frame(c, kWsText, err.data(), err.size());
+                        break;
+                    }
+                    c.pending.push_back(name);
+                } else if (!add && k < c.pending.size()) {
+                    c.pending.erase(c.pending.begin() + static_cast<std::ptrdiff_t>(k));
+                }
+            }
+        } else if (op == "rate" && tok.size() == 2) {
+            c.interval_ns = static_cast<int64_t>(1e9 / clamp_rate(std::atof(tok[1].c_str())));
+            c.next_due = now_ns();
+        } else if (op == "format" && tok.size() == 2 && (tok[1] == "json" || tok[1] == "binary")) {
+            c.binary = tok[1] == "binary";
+        } else {
+            const std::string err = "{\"error\":\"unknown command\"}";
+            queue_frame(c, kWsText, err.data(), err.size());
+        }
+    }
+
+    void set_subscribed(Client& c, int32_t iid, bool add) {
+        size_t k = 0;
+        while (k < c.iids.size() && c.iids[k] != iid) ++k;
+        if (add && k == c.iids.size()) {
+            c.iids.push_back(iid);
+            c.sent.push_back(0);  // 下一轮发送当前快照
+        } else if (!add && k < c.iids.size()) {
+            c.iids.erase(c.iids.begin() + static_cast<std::ptrdiff_t>(k));
+            c.sent.erase(c.sent.begin() + static_cast<std::ptrdiff_t>(k));
+        }
+    }
+
+    /// 符号表自上次检查后有新合约时，把已出现的待解析合约转为订阅
+    void resolve_pending(Client& c) {
+        const size_t size = global_symbol_table().size();
+        if (size == c.pending_checked) return;
+        c.pending_checked = size;
+        for (size_t k = 0; k < c.pending.size();) {
+            const int32_t iid = global_symbol_table().find(c.pending[k].data(), c.pending[k].size());
+            if (iid == kInvalidInstrument) {
+                ++k;
+                continue;
+            }
+            set_subscribed(c, iid, true);
+            c.pending[k] = std::move(c.pending.back());
+            c.pending.pop_back();
+        }
+    }
+
+    /// 追加一条控制 / 回复帧；积压超过 kMaxControlBacklog 时不追加、标记断开，返回 false
+    bool queue_frame(Client& c, uint8_t opcode, const char* data, size_t n) {
+        char hdr[10];
+        const size_t h = ws_frame_header(hdr, opcode, n);
+        if (c.control + h + n > kMaxControlBacklog) {
+            c.overflow = true;
+            return false;
+        }
+        c.out.append(hdr, h);
+        c.out.append(data, n);
+        c.control += h + n;
+        return true;
+    }
+
+    /// 尽量写出 out；返回 false 表示连接已断开
+    bool flush(Client& c) {
+        while (c.out_off < c.out.size()) {
+            const ssize_t n = ::send(c.fd, c.out.data() + c.out_off, c.out.size() - c.out_off, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            c.out_off += static_cast<size_t>(n);
+        }
+        const bool pending = c.out_off < c.out.size();
+        if (!pending) {
+            c.out.clear();
+            c.out_off = 0;
+            c.control = 0;
+        }
+        mod_fd(c.fd, pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+        return true;
+    }
+
+    // ---- 定时推送 ----
+
+    void send_due() {
+        const int64_t now = now_ns();
+        std::vector<int> dead;
+        for (auto& kv : clients_by_fd_) {
+            Client& c = *kv.second;
+            if (!c.open || now < c.next_due) continue;
+            c.next_due = now + c.interval_ns;
+            if (c.out_off < c.out.size()) {
+                conflated_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (build(c) && !flush(c)) dead.push_back(c.fd);
+        }
+        for (int fd : dead) drop(fd);
+    }
+
+    /// 收集版本变化的已订阅合约，编码为一条消息追加到 out；无变化返回 false
+    bool build(Client& c) {
+        body_.clear();
+        size_t count = 0;
+        auto take = [&](int32_t iid, uint64_t& sent) {
+            const uint64_t v = table_.version(iid);
+            if (v == 0 || v == sent) return;
+            Tick t;
+            uint64_t version;
+            if (!table_.read(iid, t, version)) return;
+            sent = version;
+            const char* name = global_symbol_table().name(iid);
+            const size_t name_len = global_symbol_table().name_len(iid);
+            if (!name) return;
+            if (c.binary) {
+                WireTick w;
+                encode_wire_tick(t, name, name_len, w);
+                body_.append(reinterpret_cast<const char*>(&w), sizeof(w));
+            } else {
+                if (count) body_.push_back(',');
+                json_append_tick(body_, t, name, name_len);
+            }
+            ++count;
+        };
+        if (c.all) {
+            const int32_t hw = table_.high_water();
+            if (c.all_sent.size() < static_cast<size_t>(hw)) c.all_sent.resize(static_cast<size_t>(hw), 0);
+            for (int32_t iid = 0; iid < hw; ++iid) take(iid, c.all_sent[static_cast<size_t>(iid)]);
+        } else {
+            if (!c.pending.empty()) resolve_pending(c);
+            for (size_t k = 0; k < c.iids.size(); ++k) take(c.iids[k], c.sent[k]);
+        }
+        if (count == 0) return false;
+        ++c.seq;
+        if (c.binary) {
+            // 单条消息的 count 为 16 位；超出时按 WireFrameHeader 拆成多条
+            for (size_t first = 0; first < count; first += 0xFFFF) {
+                const size_t n = count - first < 0xFFFF ? count - first : 0xFFFF;
+                WireFrameHeader h{kWireMagic, static_cast<uint16_t>(n), static_cast<uint16_t>(sizeof(WireTick)),
+                                  c.seq};
+                char hdr[10];
+                c.out.append(hdr, ws_frame_header(hdr, kWsBinary, sizeof(h) + n * sizeof(WireTick)));
+                c.out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+                c.out.append(body_, first * sizeof(WireTick), n * sizeof(WireTick));
+            }
+        } else {
+            std::string head = "{\"seq\":";
+            json_append_int(head, static_cast<int64_t>(c.seq));
+            head.append(",\"ticks\":[");
+            char hdr[10];
+            c.out.append(hdr, ws_frame_header(hdr, kWsText, head.size() + body_.size() + 2));
+            c.out.append(head).append(body_).append("]}");
+        }
+        messages_.fetch_add(1, std::memory_order_relaxed);
+        ticks_.fetch_add(count, std::memory_order_relaxed);
+        bytes_.fetch_add(c.out.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    const SnapshotTable& table_;
+    WsFanoutOptions opt_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+    std::unordered_map<int, std::unique_ptr<Client>> clients_by_fd_;  ///< 只在服务线程访问
+    std::string body_;
+    std::atomic<uint64_t> clients_{0}, accepted_{0}, rejected_{0}, messages_{0}, ticks_{0}, bytes_{0}, conflated_{0};
+};
+
+}  // namespace fq
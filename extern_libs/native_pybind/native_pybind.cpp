@@ -0,0 +1,36 @@
+/**
+ * native_pybind: 行情热路径原生组件的 pybind11 封装（仅 Linux）
+ *
+ * 核心实现位于 include/fq/（header-only，不依赖 Python），各组件的绑定位于
+ * bindings/bind_<组件>.cpp，在此统一注册。Python 侧通过
+ * src/utils/native_loader.py 按需加载，未编译时各模块回退到纯 Python 实现。
+ */
+#include <pybind11/pybind11.h>
+
+#include "bindings/bind_common.hpp"
+
+namespace py = pybind11;
+
+PYBIND11_MODULE(native_pybind, m) {
+    m.doc() = "Native hot-path components for futures_quant_framework (Linux only)";
+
+    fq::bindings::bind_symbol_table(m);
+    fq::bindings::bind_tick_batch(m);
+    fq::bindings::bind_adaptive_batcher(m);
+    fq::bindings::bind_priority_lanes(m);
+    fq::bindings::bind_sharding(m);
+    fq::bindings::bind_wait_strategy(m);
+    fq::bindings::bind_alloc_tracker(m);
+    fq::bindings::bind_trade_inference(m);
+    fq::bindings::bind_backtest(m);
+    fq::bindings::bind_cross_section(m);
+    fq::bindings::bind_csv_encoder(m);
+    fq::bindings::bind_csv_import(m);
+    fq::bindings::bind_reorder_buffer(m);
+    fq::bindings::bind_hot_standby(m);
+    fq::bindings::bind_udp_publisher(m);
+    fq::bindings::bind_ewm_covariance(m);
+    fq::bindings::bind_feature_tensor(m);
+    fq::bindings::bind_alert_engine(m);
+    fq::bindings::bind_ws_fanout(m);
+}
@@ -6,6 +6,7 @@ import os
 import sys
 import threading
 from typing import Optional, Callable, List
+from src.collector.readiness import CONNECTED, LOGGED_IN, SUBSCRIBED, SourceReadiness
 from src.utils import futures_logger
 
 
@@ -52,9 +53,15 @@ class CtpSpiWrapper:
         self.is_logged_in = False
         self.subscribe_symbols = []
 
+    @property
+    def readiness(self) -> Optional[SourceReadiness]:
+        return getattr(self.api_instance, "readiness", None)
+
     def OnFrontConnected(self):
         """前置连接成功回调，自动执行登录（参考 Rust 版本的 on_front_connected）"""
         futures_logger.info("CTP 前置连接成功，开始登录...")
+        if self.readiness is not None:
+            self.readiness.mark(CONNECTED)
         if self.api_instance:
             self.api_instance.login()
 
@@ -62,6 +69,9 @@ class CtpSpiWrapper:
         """前置连接断开回调"""
         futures_logger.warning(f"CTP 前置连接断开, 原因: {nReason}")
         self.is_logged_in = False
+        # API 自动重连，重连后的登录/订阅回报重新推进就绪状态
+        if self.readiness is not None:
+            self.readiness.reset()
 
     def OnRspUserLogin(self, pRspUserLogin, pRspInfo, nRequestID, bIsLast):
         """登录响应回调，登录成功后自动订阅（参考 Rust 版本的 on_rsp_user_login）"""
@@ -80,6 +90,8 @@ class CtpSpiWrapper:
                 )
             else:
                 futures_logger.info("CTP 登录成功")
+            if self.readiness is not None:
+                self.readiness.mark(LOGGED_IN)
             
             # 登录成功后自动订阅（参考 Rust 版本逻辑）
             if self.api_instance:
@@ -89,10 +101,14 @@ class CtpSpiWrapper:
                     self.api_instance.subscribe(symbols_to_subscribe)
                 else:
                     futures_logger.warning("订阅列表为空，无法自动订阅")
+                    if self.readiness is not None:
+                        self.readiness.mark(SUBSCRIBED)
         else:
             error_msg = pRspInfo.ErrorMsg if pRspInfo else "Unknown Error"
             error_id = pRspInfo.ErrorID if pRspInfo else -1
             futures_logger.error(f"CTP 登录失败 - ErrorID: {error_id}, ErrorMsg: {error_msg}")
+            if self.readiness is not None:
+                self.readiness.fail(f"登录失败 ErrorID={error_id}: {error_msg}")
 
     def OnRspSubMarketData(self, pSpecificInstrument, pRspInfo, nRequestID, bIsLast):
         """订阅行情响应回调"""
@@ -100,6 +116,8 @@ class CtpSpiWrapper:
             instrument_id = getattr(pSpecificInstrument, 'InstrumentID', '') if pSpecificInstrument else '未知合约'
             if pRspInfo.ErrorID == 0:
                 futures_logger.info(f"订阅成功: {instrument_id}")
+                if self.readiness is not None:
+                    self.readiness.mark(SUBSCRIBED)
             else:
                 futures_logger.warning(
                     f"订阅失败 - InstrumentID: {instrument_id}, "
@@ -108,6 +126,8 @@ class CtpSpiWrapper:
         else:
             instrument_id = getattr(pSpecificInstrument, 'InstrumentID', '') if pSpecificInstrument else ''
             futures_logger.info(f"订阅响应: {instrument_id} (无错误信息)")
+            if self.readiness is not None:
+                self.readiness.mark(SUBSCRIBED)
 
     def OnRtnDepthMarketData(self, pDepthMarketData):
         """行情数据推送回调"""
@@ -144,7 +164,8 @@ class CtpMarketApi:
                  subscribe_symbols: Optional[List[str]] = None,
                  broker_id: Optional[str] = None,
                  investor_id: Optional[str] = None,
-                 password: Optional[str] = None):
+                 password: Optional[str] = None,
+                 readiness: Optional[SourceReadiness] = None):
         self.front_address = front_address
         self.flow_path = flow_path
         self.subscribe_symbols = subscribe_symbols or []
@@ -153,6 +174,8 @@ class CtpMarketApi:
         self.investor_id = investor_id
         self.password = password
         self.use_anonymous_login = not (broker_id and investor_id and password)
+        # 就绪状态（连接/登录/订阅回报推进），由采集器传入用于并行拉起时的事件等待
+        self.readiness = readiness or SourceReadiness("ctp")
         # 仅在拿到配置或环境后，再注入 pybind 路径并尝试导入
         if pybind_path:
             setup_ctp_path(pybind_path)
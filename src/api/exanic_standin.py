@@ -0,0 +1,161 @@
+# -*- coding: utf-8 -*-
+"""ExaNIC 软件替身（RX/TX），无网卡时联调与测试用
+
+模块级函数与 exanic_pybind 一致（acquire_handle / acquire_rx_buffer / receive_frame /
+acquire_tx_buffer / transmit_frame / get_tx_timestamp / tx_ops / release_* / get_last_error），
+GfexExanicApi 配置 standin: true 时以本模块代替 exanic_pybind，其余代码路径不变。
+
+每个 (设备名, 端口) 对应一条“线缆”，两端各一个单向帧环：
+- rx：对端（测试或回放程序）inject() 注入的帧，由 receive_frame 读出
+- tx：transmit_frame / 原生发布者写入的帧，由对端 capture() 读出；发送时间戳为 CLOCK_MONOTONIC ns
+native_pybind 可用时帧环为 fq::SoftFrameRing（tx_ops() 可交给原生 UdpTickPublisher），
+否则为下面等价的纯 Python 实现（tx_ops() 返回 None，发布者回退纯 Python）。
+"""
+import threading
+import time
+from collections import deque
+from typing import Deque, Dict, List, Optional, Tuple
+
+from src.utils.native_loader import get_native_pybind
+
+MAX_FRAME = 2048
+
+
+class SoftFrameRing:
+    """纯 Python 单向帧环，与 native_pybind.SoftFrameRing 接口一致。"""
+
+    def __init__(self, capacity: int = 1024):
+        n = 2
+        while n < capacity:
+            n <<= 1
+        self.capacity = n
+        self._frames: Deque[bytes] = deque()
+        self._last_tx_ns = 0
+        self.dropped = 0
+
+    def transmit_frame(self, frame: bytes) -> int:
+        if len(frame) > MAX_FRAME or len(self._frames) >= self.capacity:
+            self.dropped += 1
+            return -1
+        # 时间戳严格递增，发布者据“时间戳变化”判定本帧已发出
+        self._last_tx_ns = max(time.monotonic_ns(), self._last_tx_ns + 1)
+        self._frames.append(bytes(frame))
+        return 0
+
+    def receive_frame(self, max_size: int = 2048) -> bytes:
+        if not self._frames:
+            return b""
+        frame = self._frames.popleft()
+        return frame if len(frame) <= max_size else b""
+
+    def get_tx_timestamp(self) -> int:
+        return self._last_tx_ns
+
+    def tx_ops(self):
+        return None
+
+    @property
+    def pending(self) -> int:
+        return len(self._frames)
+
+
+def new_frame_ring(capacity: int = 1024, native: bool = True):
+    """创建帧环：native_pybind 可用时返回原生帧环，否则返回纯 Python 实现。"""
+    m = get_native_pybind()
+    if native and m is not None and hasattr(m, "SoftFrameRing"):
+        return m.SoftFrameRing(capacity)
+    return SoftFrameRing(capacity)
+
+
+class StandinPort:
+    """一条替身线缆：rx 由对端注入，tx 由本端发送。"""
+
+    def __init__(self, capacity: int):
+        self.rx = new_frame_ring(capacity)
+        self.tx = new_frame_ring(capacity)
+
+    def inject(self, frame: bytes) -> bool:
+        """对端发来一帧（进入本端 RX）。"""
+        return self.rx.transmit_frame(frame) == 0
+
+    def capture(self, max_frames: int = 0) -> List[bytes]:
+        """取走本端已发送的帧（对端收到的帧）。"""
+        out = []
+        while not max_frames or len(out) < max_frames:
+            frame = self.tx.receive_frame(MAX_FRAME)
+            if not frame:
+                break
+            out.append(frame)
+        return out
+
+
+class _Device:
+    def __init__(self, name: str):
+        self.name = name
+
+
+_lock = threading.Lock()
+_ports: Dict[Tuple[str, int], StandinPort] = {}
+RING_CAPACITY = 4096
+
+
+def port(device_name: str, port_number: int) -> StandinPort:
+    """取（必要时创建）设备端口对应的替身线缆，供测试注入 / 抓取帧。"""
+    key = (device_name, int(port_number))
+    with _lock:
+        p = _ports.get(key)
+        if p is None:
+            p = _ports[key] = StandinPort(RING_CAPACITY)
+        return p
+
+
+def reset() -> None:
+    """丢弃全部替身线缆（测试间隔离）。"""
+    with _lock:
+        _ports.clear()
+
+
+# --- 与 exanic_pybind 一致的模块级接口 ---
+
+def acquire_handle(device_name: str) -> Optional[_Device]:
+    return _Device(device_name)
+
+
+def acquire_rx_buffer(handle: _Device, port_number: int, buffer_number: int):
+    return port(handle.name, port_number).rx
+
+
+def receive_frame(rx_handle, max_size: int = 2048) -> bytes:
+    return rx_handle.receive_frame(max_size)
+
+
+def release_rx_buffer(rx_handle) -> None:
+    pass
+
+
+def acquire_tx_buffer(handle: _Device, port_number: int, requested_size: int = 0):
+    return port(handle.name, port_number).tx
+
+
+def transmit_frame(tx_handle, frame: bytes) -> int:
+    return tx_handle.transmit_frame(frame)
+
+
+def get_tx_timestamp(tx_handle) -> int:
+    return tx_handle.get_tx_timestamp()
+
+
+def tx_ops(tx_handle):
+    return tx_handle.tx_ops()
+
+
+def release_tx_buffer(tx_handle) -> None:
+    pass
+
+
+def release_handle(handle: _Device) -> None:
+    pass
+
+
+def get_last_error() -> str:
+    return ""
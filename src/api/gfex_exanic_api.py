@@ -4,7 +4,10 @@
 通过 exanic_pybind 调用 ExaNIC C SDK（pybind11 封装），本模块为 Python 侧封装：
 连接、接收线程、L2 帧解析（NanoGfexL2MdType）与回调。
 
-- 仅支持 Linux（依赖 /dev/exanic*、mmap、ioctl）
+- 仅支持 Linux（依赖 /dev/exanic*、mmap、ioctl）；standin=True 时改用软件替身
+  src/api/exanic_standin.py（接口与 exanic_pybind 一致），无网卡时联调与测试
+- 配置 tx_publisher 时在接收线程内把解码后的行情编码为紧凑 UDP 帧写入同一网卡的 TX 缓冲区
+  （见 src/api/tx_publisher.py），记录发送时间戳
 - 数据结构与 hs-future-gfex-api/src/bridge/gf_bridge.hpp 中的 NanoGfexL2MdType 一致（pack 1）
 """
 
@@ -15,10 +18,15 @@ import sys
 import platform
 import struct
 import threading
-import time
 from typing import Callable, Optional, Dict, Any
 
+from src.api.tx_publisher import TxBuffer, create_tx_publisher
+from src.processor.symbol_table import get_symbol_table
+from src.processor.tick_view import new_tick_batch
 from src.utils import futures_logger, MarketSourceError
+from src.utils.alloc_tracker import create_alloc_guard
+from src.utils.profiler import register_current_thread, unregister_current_thread
+from src.utils.wait_strategy import create_wait_strategy
 
 # 延迟导入 exanic_pybind，便于非 Linux 或未编译时给出明确错误
 _exanic_pybind = None
@@ -74,11 +82,13 @@ def _parse_nano_l2_raw(buf: bytes) -> Optional[Dict[str, Any]]:
         return None
     try:
         t = struct.unpack(_GFEX_L2_FMT, buf[:NANO_GFEX_L2_SIZE])
-        contract_name = t[1].decode("utf-8", errors="ignore").strip("\x00").strip()
+        # 定长 20 字节合约名按原始字节查符号表，每个合约只解码一次
+        instrument_id, contract_name = get_symbol_table().resolve(t[1])
         gen_time = t[8].decode("utf-8", errors="ignore").strip("\x00").strip()
         return {
             "flag": t[0],
             "contract_name": contract_name,
+            "instrument_id": instrument_id,
             "last_price": t[2],
             "last_match_qty": t[3],
             "match_total_qty": t[4],
@@ -112,8 +122,15 @@ class GfexExanicApi:
         buffer_number: int = 0,
         pybind_path: Optional[str] = None,
         frame_buffer_size: int = 2048,
+        tick_batch_capacity: int = 0,
+        wait_strategy: Optional[Dict[str, Any]] = None,
+        alloc_guard: Optional[Dict[str, Any]] = None,
+        standin: bool = False,
+        tx_publisher: Optional[Dict[str, Any]] = None,
     ):
-        _ensure_linux()
+        self._standin = bool(standin)
+        if not self._standin:
+            _ensure_linux()
         self.nic_name = nic_name
         self.port_number = port_number
         self.buffer_number = buffer_number
@@ -125,11 +142,31 @@ class GfexExanicApi:
         self._callback: Optional[Callable[[Dict[str, Any]], None]] = None
         self._thread: Optional[threading.Thread] = None
         self._running = False
+        # 批次模式（tick_batch_capacity > 0）：接收线程直接把帧解码进 TickBatch，
+        # 消费者通过 swap_batch() 双缓冲取走，不再逐帧构造 dict 与回调
+        self._batch_capacity = int(tick_batch_capacity or 0)
+        self._batch = None
+        self._spare_batch = None
+        self._batch_lock = threading.Lock()
+        self.dropped_frames = 0
+        # 无帧时的等待策略，默认 timed_block 100µs（与原先固定 sleep 一致）
+        self._wait = create_wait_strategy(wait_strategy, defaults={"mode": "timed_block", "block_timeout": 0.0001})
+        # 批次模式下可选的热路径分配守卫（需 native_pybind 以 FQ_ALLOC_TRACKING=ON 构建），在接收线程中创建
+        self._alloc_guard_config = alloc_guard
+        self._alloc_guard = None
+        # TX 发布（tx_publisher.enable）：接收线程解码后直接写 TX 缓冲区
+        self._tx_config = tx_publisher if tx_publisher and tx_publisher.get("enable") else None
+        self._tx_cap = None
+        self._publisher = None
 
     def _load_pybind(self):
         """按需将 pybind_path / 环境路径加入 sys.path 并加载 exanic_pybind。"""
         if self._api is not None:
             return self._api
+        if self._standin:
+            from src.api import exanic_standin
+            self._api = exanic_standin
+            return self._api
         search_paths = []
         if self._pybind_path:
             search_paths.append(os.path.abspath(self._pybind_path))
@@ -143,16 +180,24 @@ class GfexExanicApi:
         self._api = _get_exanic_pybind()
         return self._api
 
-    def connect(self, callback: Callable[[Dict[str, Any]], None]) -> bool:
-        """打开网卡、申请 RX 缓冲区并启动接收线程，收到一帧即调用 callback。
+    @property
+    def batch_mode(self) -> bool:
+        """是否以 TickBatch 批次模式接收。"""
+        return self._batch_capacity > 0
+
+    def connect(self, callback: Optional[Callable[[Dict[str, Any]], None]] = None) -> bool:
+        """打开网卡、申请 RX 缓冲区并启动接收线程。
+
+        非批次模式下收到一帧即调用 callback；批次模式下帧写入内部批次，由 swap_batch() 取走。
 
         Args:
-            callback: 接收 {"type": "GFEX_L2", "data": dict} 的回调。
+            callback: 接收 {"type": "GFEX_L2", "data": dict} 的回调（批次模式下可为 None）。
 
         Returns:
             成功返回 True，否则 False。
         """
-        _ensure_linux()
+        if not self._standin:
+            _ensure_linux()
         api = self._load_pybind()
         nic = api.acquire_handle(self.nic_name)
         if nic is None:
@@ -168,40 +213,161 @@ class GfexExanicApi:
             futures_logger.error(f"exanic_acquire_rx_buffer 失败: {msg}")
             return False
         self._rx_cap = rx
+        if self._tx_config is not None and not self._open_tx(api, nic):
+            self.close()
+            return False
         self._callback = callback
+        if self.batch_mode:
+            self._batch = new_tick_batch(self._batch_capacity)
+            self._spare_batch = new_tick_batch(self._batch_capacity)
         self._running = True
         self._thread = threading.Thread(target=self._receive_loop, daemon=True)
         self._thread.start()
         futures_logger.info("GFEX ExaNIC 已连接并启动接收线程")
         return True
 
+    def _open_tx(self, api, nic) -> bool:
+        """申请 TX 缓冲区并创建发布者（配置无效时抛出 ConfigError）。"""
+        cfg = self._tx_config
+        port = int(cfg.get("port_number", self.port_number))
+        tx = api.acquire_tx_buffer(nic, port, int(cfg.get("buffer_size", 0) or 0))
+        if tx is None:
+            msg = api.get_last_error() or "unknown"
+            futures_logger.error(f"exanic_acquire_tx_buffer 失败: {msg}")
+            return False
+        self._tx_cap = tx
+        try:
+            self._publisher = create_tx_publisher(TxBuffer(api, tx), cfg)
+        except Exception:
+            self.close()
+            raise
+        futures_logger.info(
+            f"GFEX ExaNIC TX 发布已启用: 端口 {port} -> {cfg.get('dst_ip')}:{cfg.get('dst_port')}"
+            f"（{type(self._publisher).__module__}）"
+        )
+        return True
+
     def _receive_loop(self) -> None:
         api = self._api
         rx = self._rx_cap
         if not api or rx is None:
             return
+        register_current_thread("gfex-rx", "GFEX")
+        try:
+            self._receive_frames(api, rx)
+        finally:
+            unregister_current_thread()
+
+    def _receive_frames(self, api, rx) -> None:
+        wait = self._wait
+        publisher = self._publisher
+        parse_gfex_l2 = None
+        if publisher is not None and self._batch is None:
+            from src.processor.data_parser import DataParser
+            parse_gfex_l2 = DataParser._parse_gfex_l2
+        guard = None
+        if self._batch is not None:
+            guard = self._alloc_guard = create_alloc_guard("GFEX 接收线程", self._alloc_guard_config)
         while self._running:
             raw = api.receive_frame(rx, self._frame_buffer_size)
             if not raw:
-                time.sleep(0.0001)
+                wait.idle()
                 continue
-            if len(raw) >= NANO_GFEX_L2_SIZE:
+            wait.reset()
+            if len(raw) < NANO_GFEX_L2_SIZE:
+                continue
+            if self._batch is not None:
+                with self._batch_lock:
+                    start = len(self._batch)
+                    if guard is not None:
+                        guard.begin()
+                    appended = self._batch.append_gfex_l2(raw)
+                    if guard is not None:
+                        guard.end()
+                    if appended:
+                        if publisher is not None:
+                            publisher.publish_batch(self._batch, start)
+                    elif self._batch.full:
+                        self.dropped_frames += 1
+            else:
                 data = _parse_nano_l2_raw(raw)
-                if data and self._callback:
-                    self._callback({"type": "GFEX_L2", "data": data})
+                if data and parse_gfex_l2 is not None:
+                    std = parse_gfex_l2(data)
+                    if std:
+                        publisher.publish([std])
+                callback = self._callback  # close() 可能同时清空
+                if data and callback:
+                    callback({"type": "GFEX_L2", "data": data})
+
+    def swap_batch(self):
+        """取走当前已接收的批次（双缓冲交换）。
+
+        返回的批次及其 TickView 在下一次 swap_batch() 之前有效；批次模式未启用时返回 None。
+        """
+        if self._batch is None:
+            return None
+        with self._batch_lock:
+            self._batch.swap(self._spare_batch)
+            self._batch.clear()
+        return self._spare_batch
+
+    def wait_stats(self) -> Dict[str, Any]:
+        """接收线程空闲等待统计（自旋 / 让出 / 休眠耗时与次数）。"""
+        return self._wait.stats()
+
+    def alloc_stats(self) -> Optional[Dict[str, Any]]:
+        """接收线程热路径分配守卫统计；未启用守卫时返回 None。"""
+        return self._alloc_guard.stats() if self._alloc_guard is not None else None
+
+    def tx_timestamps(self):
+        """取走 TX 发布已记录的 (帧序号, 发送时间戳 ns)；未启用 TX 发布时返回空列表。"""
+        return self._publisher.tx_timestamps() if self._publisher is not None else []
+
+    def tx_metrics(self) -> Optional[Dict[str, Any]]:
+        """TX 发布统计（帧数、条数、过滤、发送失败、时间戳）；未启用时返回 None。"""
+        return self._publisher.metrics() if self._publisher is not None else None
 
     def close(self) -> None:
-        """停止接收线程并释放 ExaNIC 句柄与 RX 缓冲区。"""
+        """停止接收线程并释放 ExaNIC 句柄与 RX/TX 缓冲区。
+
+        接收线程在 2 秒内未退出时（仍在使用 RX 缓冲区与发布者），释放推迟到该线程实际退出之后。
+        """
         self._running = False
-        if self._thread and self._thread.is_alive():
-            self._thread.join(timeout=2.0)
-        api = self._api
-        if api and self._rx_cap is not None:
-            api.release_rx_buffer(self._rx_cap)
-            self._rx_cap = None
-        if api and self._nic_cap is not None:
-            api.release_handle(self._nic_cap)
-            self._nic_cap = None
+        self._wait.notify()
+        thread = self._thread
+        if thread and thread.is_alive():
+            thread.join(timeout=2.0)
+        futures_logger.info(f"GFEX ExaNIC 接收线程等待统计: {self.wait_stats()}")
+        if self._alloc_guard is not None:
+            futures_logger.info(f"GFEX ExaNIC 接收线程分配守卫: {self.alloc_stats()}")
+        if self._publisher is not None:
+            futures_logger.info(f"GFEX ExaNIC TX 发布统计: {self.tx_metrics()}")
+        handles = (self._api, self._tx_cap, self._rx_cap, self._nic_cap)
+        self._publisher = self._tx_cap = self._rx_cap = self._nic_cap = None
         self._api = None
         self._callback = None
+        if thread is not None and thread.is_alive():
+            futures_logger.warning("GFEX ExaNIC 接收线程 2 秒内未退出，待其退出后再释放缓冲区与句柄")
+            threading.Thread(target=self._release_after, args=(thread, handles), daemon=True).start()
+            return
+        self._release(handles)
         futures_logger.info("GFEX ExaNIC 已关闭")
+
+    @classmethod
+    def _release_after(cls, thread: threading.Thread, handles) -> None:
+        thread.join()
+        cls._release(handles)
+        futures_logger.info("GFEX ExaNIC 接收线程已退出，缓冲区与句柄已释放")
+
+    @staticmethod
+    def _release(handles) -> None:
+        # 原生发布者的 tx_ops 持有 TX 端口引用，release_tx_buffer 后端口在发布者释放前仍然有效
+        api, tx_cap, rx_cap, nic_cap = handles
+        if not api:
+            return
+        if tx_cap is not None:
+            api.release_tx_buffer(tx_cap)
+        if rx_cap is not None:
+            api.release_rx_buffer(rx_cap)
+        if nic_cap is not None:
+            api.release_handle(nic_cap)
@@ -12,10 +12,10 @@ import os
 import sys
 import platform
 import threading
-import time
 from pathlib import Path
 from typing import Callable, Optional, Dict, Any, List, Tuple
 
+from src.collector.readiness import CONNECTED, LOGGED_IN, SUBSCRIBED, SourceReadiness
 from src.utils import futures_logger, MarketSourceError
 
 # 项目根目录，用于解析配置中的相对路径（与 main_config 中 sdk_config_path / log_path 约定一致）
@@ -147,6 +147,9 @@ class NsqMarketApi:
         markets: str = "dce",
         pybind_path: Optional[str] = None,
         project_root: Optional[Path] = None,
+        readiness: Optional[SourceReadiness] = None,
+        connect_timeout: float = 60.0,
+        login_timeout: float = 30.0,
     ):
         self.config_path = config_path
         self.username = username
@@ -161,6 +164,10 @@ class NsqMarketApi:
         self._api: Any = None
         self._join_thread: Optional[threading.Thread] = None
         self.is_connected: bool = False
+        # 就绪状态由 SPI 回调推进（连接 → 登录 → 订阅回报），不做固定时长等待
+        self.readiness = readiness or SourceReadiness("nsq_dce_net_api")
+        self.connect_timeout = connect_timeout
+        self.login_timeout = login_timeout
 
     @staticmethod
     def _ensure_linux():
@@ -174,22 +181,25 @@ class NsqMarketApi:
         """初始化连接并注册回调（Linux only）。
 
         参考 init_api：NewNsqApiExt(flow_path, sdk_config_path) -> RegisterSpi -> Init("")
-        -> 等待连接与登录 -> 按 markets 订阅交易所全市场 -> Join 在后台线程运行。
+        -> 等待连接与登录回报 -> 按 markets 订阅交易所全市场 -> Join 在后台线程运行。
+        订阅回报异步到达，全部交易所回报后 readiness 到达 subscribed。
 
         Args:
             callback: 行情数据回调，接收 {"type": "NSQ_DEPTH", "data": ...}。
 
         Returns:
-            True 表示初始化且订阅成功（含 stub 模式）；False 表示 Init 失败或连接/登录超时。
+            True 表示初始化且订阅请求已发送（含 stub 模式）；False 表示 Init 失败、登录失败或连接/登录超时。
         """
         self._ensure_linux()
         self._callback = callback
         self.is_connected = True
+        readiness = self.readiness
 
         try:
             m = _get_nsq_pybind(self.pybind_path)
         except Exception as e:
             futures_logger.warning("nsq_pybind 导入失败，使用 stub NSQ API：%s", e)
+            readiness.mark(SUBSCRIBED)
             return True
 
         flow_path = _resolve_path(self.log_path, self.project_root) or "./log/"
@@ -206,22 +216,46 @@ class NsqMarketApi:
         login_req.AccountID = (self.username or "").strip()
         login_req.Password = (self.password or "").strip()
 
-        connected_evt = threading.Event()
-        logged_in_evt = threading.Event()
+        markets = _parse_markets(self.markets)
+        if not markets:
+            markets = [("dce", "F2"), ("shfe", "F3"), ("ine", "F5")]
+            futures_logger.info("NSQ markets 为空，默认订阅 dce,shfe,ine")
+        # 订阅回报计数：[待回报数, 成功数, 已发送订阅数]；全部交易所回报后到达 subscribed
+        pending = [0, 0, 0]
+        pending_lock = threading.Lock()
+
+        def on_subscribe_ack(ok: bool) -> None:
+            with pending_lock:
+                if pending[0] <= 0:
+                    # 不在等待中的回报（如断线前的迟到回报）不计入，计数不会变负
+                    return
+                pending[0] -= 1
+                pending[1] += ok
+                done, any_ok = pending[0] == 0, pending[1] > 0
+            if done:
+                if any_ok:
+                    readiness.mark(SUBSCRIBED)
+                else:
+                    readiness.fail("全部交易所订阅失败")
 
         class _ConnSpi(m.CHSNsqSpi):
-            def __init__(self, ap, req, cb, evt_conn, evt_login):
+            def __init__(self, ap, req, cb):
                 super().__init__()
                 self._ap = ap
                 self._req = req
                 self._cb = cb
-                self._evt_conn = evt_conn
-                self._evt_login = evt_login
 
             def OnFrontConnected(self):
-                self._evt_conn.set()
+                readiness.mark(CONNECTED)
                 self._ap.ReqUserLogin(self._req, 0)
 
+            def OnFrontDisconnected(self, nReason):
+                futures_logger.warning("NSQ 前置连接断开: %s", nReason)
+                # SDK 自动重连并按已发送的订阅重新回报：回报重新计数，全部到达后再次进入 subscribed
+                with pending_lock:
+                    pending[0], pending[1] = pending[2], 0
+                readiness.reset()
+
             def OnRspUserLogin(self, pRspUserLogin, pRspInfo, nRequestID, bIsLast):
                 err = 0
                 if pRspInfo is not None:
@@ -229,13 +263,25 @@ class NsqMarketApi:
                 if err != 0:
                     msg = getattr(pRspInfo, "ErrorMsg", "") or self._ap.GetApiErrorMsg(err)
                     futures_logger.error("NSQ ReqUserLogin 失败: ErrorID=%s, %s", err, msg)
-                self._evt_login.set()
+                    readiness.fail(f"登录失败 ErrorID={err}: {msg}")
+                else:
+                    readiness.mark(LOGGED_IN)
+
+            def OnRspFutuDepthMarketDataSubscribe(self, pRspInfo, nRequestID, bIsLast):
+                if not bIsLast:
+                    return
+                err = 0
+                if pRspInfo is not None:
+                    err = getattr(pRspInfo, "ErrorID", 0) or 0
+                if err != 0:
+                    futures_logger.warning("NSQ 订阅回报失败: ErrorID=%s, %s", err, getattr(pRspInfo, "ErrorMsg", ""))
+                on_subscribe_ack(err == 0)
 
             def OnRtnFutuDepthMarketData(self, pData):
                 if self._cb and pData is not None:
                     self._cb({"type": "NSQ_DEPTH", "data": _depth_field_to_dict(pData)})
 
-        spi = _ConnSpi(api, login_req, self._callback, connected_evt, logged_in_evt)
+        spi = _ConnSpi(api, login_req, self._callback)
         api.RegisterSpi(spi)
         api.RegisterFront("")
         ret = api.Init("")
@@ -244,29 +290,35 @@ class NsqMarketApi:
             self._api = None
             return False
 
-        time.sleep(3)
-        if not connected_evt.wait(timeout=60):
-            futures_logger.error("NSQ 连接超时（60s）")
+        # 回调到达即返回，超时只作为上限
+        if not readiness.wait(CONNECTED, timeout=self.connect_timeout):
+            futures_logger.error("NSQ 连接超时（%ss）", self.connect_timeout)
             self._api = None
             return False
-        if not logged_in_evt.wait(timeout=30):
-            futures_logger.error("NSQ 登录超时（30s）: %s", api.GetApiErrorMsg(0))
+        if not readiness.wait(LOGGED_IN, timeout=self.login_timeout):
+            if readiness.error is None:
+                futures_logger.error("NSQ 登录超时（%ss）: %s", self.login_timeout, api.GetApiErrorMsg(0))
             self._api = None
             return False
 
-        time.sleep(2)
-        markets = _parse_markets(self.markets)
-        if not markets:
-            markets = [("dce", "F2"), ("shfe", "F3"), ("ine", "F5")]
-            futures_logger.info("NSQ markets 为空，默认订阅 dce,shfe,ine")
+        sent = 0
+        with pending_lock:
+            pending[0] = len(markets)
         for name, ex in markets:
             r = api.SubscribeMarket(ex, 0)
             if r != 0:
                 futures_logger.warning("NSQ SubscribeMarket(%s/%s) 失败: %s", name, ex, api.GetApiErrorMsg(r))
+                on_subscribe_ack(False)
             else:
-                futures_logger.info("NSQ 已订阅交易所: %s (%s)", name, ex)
+                sent += 1
+                with pending_lock:
+                    pending[2] = sent
+                futures_logger.info("NSQ 已发送交易所订阅: %s (%s)", name, ex)
+        if not sent:
+            self._api = None
+            return False
 
-        futures_logger.info("NSQ API 连接与订阅已完成")
+        futures_logger.info("NSQ API 连接与订阅请求已完成")
         return True
 
     def emit_depth_market_data(self, data: Dict[str, Any]) -> None:
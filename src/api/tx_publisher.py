@@ -0,0 +1,302 @@
+# -*- coding: utf-8 -*-
+"""行情 TX 发布模块（紧凑 UDP 帧，本地一跳转发给下游策略机）
+
+把标准化行情编码为原始以太网帧（以太网 + IPv4 + UDP，校验和置 0）直接写入发送端：
+- 载荷：帧头 <IHHQ（魔数 "FQT1"、条数、单条长度、帧序号）+ count 条 104 字节定长记录
+  （合约代码、交易日、交易所、当日微秒、最新价、累计量/额、持仓、买一/卖一价量），小端
+- 发送端为 ExaNIC TX 缓冲区（exanic_pybind.acquire_tx_buffer）或软件替身
+  （src/api/exanic_standin.py），二者接口一致：transmit_frame / get_tx_timestamp / tx_ops
+- 每帧发送后有界自旋读取发送时间戳（网卡为硬件时钟，替身为 CLOCK_MONOTONIC），
+  tx_timestamps() 取走 (帧序号, 时间戳 ns)
+- symbols 给出时只发布其中的合约
+
+native_pybind 可用且发送端提供 tx_ops() 时使用 fq::UdpTickPublisher（在解码线程内经 C 函数表
+直接写 TX 缓冲区，批次模式下直接读 TickBatch 槽位），否则使用等价的纯 Python 实现。
+decode_tick_frame() 供下游与测试解析帧；encode_wire_tick / decode_wire_payload 另供 WebSocket 二进制推送
+（src/api/ws_fanout.py）复用同一记录格式。
+"""
+import ipaddress
+import struct
+from collections import deque
+from datetime import datetime, timedelta
+from typing import Any, Deque, Dict, Iterable, List, Optional, Tuple
+
+from src.processor.symbol_table import get_symbol_table
+from src.storage.tick_file import EXCHANGES
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+
+WIRE_MAGIC = 0x31545146  # "FQT1"
+_ETH = struct.Struct("!6s6sH")
+_IP = struct.Struct("!BBHHHBBH4s4s")
+_UDP = struct.Struct("!HHHH")
+_FRAME_HEADER = struct.Struct("<IHHQ")
+_WIRE_TICK = struct.Struct("<32sIBBHqdqddddII")
+HEADER_LEN = _ETH.size + _IP.size + _UDP.size + _FRAME_HEADER.size
+MAX_TICKS_PER_FRAME = (1500 - _IP.size - _UDP.size - _FRAME_HEADER.size) // _WIRE_TICK.size
+_EXCHANGE_CODES = {name: code for code, name in enumerate(EXCHANGES)}
+
+DEFAULT_TX_CONFIG = {
+    "dst_ip": "239.1.1.1",
+    "dst_port": 30001,
+    "dst_mac": "",
+    "src_ip": "0.0.0.0",
+    "src_port": 0,
+    "src_mac": "00:00:00:00:00:00",
+    "ticks_per_frame": 1,
+    "symbols": None,
+    "stamp_spins": 256,
+    "stamp_capacity": 4096,
+    "ttl": 64,
+}
+
+
+def _parse_mac(mac: str) -> bytes:
+    parts = mac.split(":")
+    if len(parts) != 6:
+        raise ValueError(f"invalid MAC address: {mac}")
+    return bytes(int(p, 16) for p in parts)
+
+
+def _ipv4_checksum(header: bytes) -> int:
+    total = sum(struct.unpack("!10H", header))
+    while total >> 16:
+        total = (total & 0xFFFF) + (total >> 16)
+    return ~total & 0xFFFF
+
+
+def encode_wire_tick(data: Dict) -> Optional[bytes]:
+    """行情 dict -> 104 字节定长记录（与 fq::WireTick 一致）；缺少合约或时间返回 None。"""
+    symbol = data.get("symbol")
+    dt = data.get("datetime")
+    if not symbol or not isinstance(dt, datetime):
+        return None
+    time_us = ((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1_000_000 + dt.microsecond
+    return _WIRE_TICK.pack(
+        symbol.encode("utf-8")[:31],
+        dt.year * 10000 + dt.month * 100 + dt.day,
+        _EXCHANGE_CODES.get(data.get("exchange") or "", 0), 0, 0,
+        time_us,
+        float(data.get("last_price") or 0.0),
+        int(data.get("volume") or 0),
+        float(data.get("turnover") or 0.0),
+        float(data.get("open_interest") or 0.0),
+        float(data.get("bid_price_1") or 0.0),
+        float(data.get("ask_price_1") or 0.0),
+        max(0, int(data.get("bid_volume_1") or 0)),
+        max(0, int(data.get("ask_volume_1") or 0)),
+    )
+
+
+class UdpTickPublisher:
+    """纯 Python 行情 TX 发布者，与 native_pybind.UdpTickPublisher 接口一致。"""
+
+    def __init__(
+        self,
+        tx,
+        dst_ip: str,
+        dst_port: int,
+        dst_mac: str = "",
+        src_ip: str = "0.0.0.0",
+        src_port: int = 0,
+        src_mac: str = "00:00:00:00:00:00",
+        ticks_per_frame: int = 1,
+        symbols: Optional[Iterable[str]] = None,
+        stamp_spins: int = 256,
+        stamp_capacity: int = 4096,
+        ttl: int = 64,
+    ):
+        self._tx = tx
+        dst = ipaddress.IPv4Address(dst_ip)
+        src = ipaddress.IPv4Address(src_ip)
+        if dst_mac:
+            dmac = _parse_mac(dst_mac)
+        elif dst.is_multicast:
+            # 组播：01:00:5e + IP 低 23 位
+            raw = dst.packed
+            dmac = bytes((0x01, 0x00, 0x5E, raw[1] & 0x7F, raw[2], raw[3]))
+        else:
+            raise ValueError(f"dst_mac is required for unicast dst_ip {dst_ip}")
+        self._eth = _ETH.pack(dmac, _parse_mac(src_mac), 0x0800)
+        self._src_ip = src.packed
+        self._dst_ip = dst.packed
+        self._dst_port = int(dst_port)
+        self._src_port = int(src_port) or self._dst_port
+        self._ttl = int(ttl) or 64
+        tpf = int(ticks_per_frame)
+        self.ticks_per_frame = min(max(1, tpf), MAX_TICKS_PER_FRAME)
+        self._symbols = set(symbols) if symbols is not None else None
+        self._stamp_spins = int(stamp_spins)
+        self._stamps: Deque[Tuple[int, int]] = deque()
+        self._stamp_capacity = max(2, int(stamp_capacity))
+        self._ip_id = 0
+        self.seq = 0
+        self._stats = {
+            "frames": 0, "ticks": 0, "filtered": 0, "errors": 0,
+            "stamped": 0, "unstamped": 0, "stamp_overflow": 0,
+        }
+
+    def _encode(self, data: Dict) -> Optional[bytes]:
+        if self._symbols is not None and data.get("symbol") not in self._symbols:
+            return None
+        return encode_wire_tick(data)
+
+    def _frame(self, records: List[bytes], seq: int) -> bytes:
+        payload = _FRAME_HEADER.pack(WIRE_MAGIC, len(records), _WIRE_TICK.size, seq) + b"".join(records)
+        udp_len = _UDP.size + len(payload)
+        ip_id = self._ip_id
+        self._ip_id = (ip_id + 1) & 0xFFFF
+        ip = _IP.pack(0x45, 0, _IP.size + udp_len, ip_id, 0x4000, self._ttl, 17, 0, self._src_ip, self._dst_ip)
+        ip = ip[:10] + struct.pack("!H", _ipv4_checksum(ip)) + ip[12:]
+        return self._eth + ip + _UDP.pack(self._src_port, self._dst_port, udp_len, 0) + payload
+
+    def _send(self, records: List[bytes]) -> int:
+        before = self._tx.get_tx_timestamp() if self._stamp_spins else 0
+        seq = self.seq + 1
+        if self._tx.transmit_frame(self._frame(records, seq)) != 0:
+            self._stats["errors"] += len(records)
+            return 0
+        self.seq = seq
+        self._stats["frames"] += 1
+        self._stats["ticks"] += len(records)
+        if self._stamp_spins:
+            self._record_stamp(seq, before)
+        return len(records)
+
+    def _record_stamp(self, seq: int, before: int) -> None:
+        for _ in range(self._stamp_spins):
+            ts = self._tx.get_tx_timestamp()
+            if ts != before:
+                if len(self._stamps) >= self._stamp_capacity:
+                    self._stats["stamp_overflow"] += 1
+                else:
+                    self._stamps.append((seq, ts))
+                    self._stats["stamped"] += 1
+                return
+        self._stats["unstamped"] += 1
+
+    def publish(self, data_list: List[Dict]) -> int:
+        """发布标准化行情 dict，按 ticks_per_frame 打包，返回已发出的条数。"""
+        sent = 0
+        records: List[bytes] = []
+        for data in data_list:
+            rec = self._encode(data) if isinstance(data, dict) else None
+            if rec is None:
+                self._stats["filtered"] += 1
+                continue
+            records.append(rec)
+            if len(records) == self.ticks_per_frame:
+                sent += self._send(records)
+                records = []
+        if records:
+            sent += self._send(records)
+        return sent
+
+    def publish_batch(self, batch, start: int = 0) -> int:
+        """发布 batch[start:]。"""
+        return self.publish([batch[i].to_dict() for i in range(start, len(batch))])
+
+    def tx_timestamps(self) -> List[Tuple[int, int]]:
+        """取走已记录的 (帧序号, 发送时间戳 ns)。"""
+        out = list(self._stamps)
+        self._stamps.clear()
+        return out
+
+    def metrics(self) -> Dict[str, int]:
+        return dict(self._stats, seq=self.seq)
+
+
+def decode_tick_frame(frame: bytes, dst_port: int = 0) -> Tuple[int, List[Dict]]:
+    """解析一帧发布的行情，返回 (帧序号, [行情 dict])；非本协议帧返回 (0, [])。"""
+    if len(frame) < HEADER_LEN or _ETH.unpack_from(frame)[2] != 0x0800:
+        return 0, []
+    ip = _IP.unpack_from(frame, _ETH.size)
+    if ip[0] != 0x45 or ip[6] != 17:
+        return 0, []
+    udp = _UDP.unpack_from(frame, _ETH.size + _IP.size)
+    if dst_port and udp[1] != dst_port:
+        return 0, []
+    return decode_wire_payload(frame[HEADER_LEN - _FRAME_HEADER.size:])
+
+
+def decode_wire_payload(payload: bytes) -> Tuple[int, List[Dict]]:
+    """解析载荷（帧头 <IHHQ + 定长记录，UDP 帧与 WebSocket 二进制消息共用），返回 (序号, [行情 dict])；
+    非本协议载荷返回 (0, [])。"""
+    if len(payload) < _FRAME_HEADER.size:
+        return 0, []
+    magic, count, size, seq = _FRAME_HEADER.unpack_from(payload)
+    if magic != WIRE_MAGIC or size != _WIRE_TICK.size or len(payload) < _FRAME_HEADER.size + count * size:
+        return 0, []
+    table = get_symbol_table()
+    ticks = []
+    for i in range(count):
+        (sym, trade_date, ex, _source, _flags, time_us, last_price, volume, turnover, open_interest,
+         bid1, ask1, bid_vol1, ask_vol1) = _WIRE_TICK.unpack_from(payload, _FRAME_HEADER.size + i * size)
+        symbol = sym.rstrip(b"\x00").decode("utf-8", errors="ignore")
+        ticks.append({
+            "symbol": symbol,
+            "instrument_id": table.intern(symbol),
+            "exchange": EXCHANGES[ex] if ex < len(EXCHANGES) else "",
+            "last_price": last_price,
+            "volume": volume,
+            "turnover": turnover,
+            "open_interest": open_interest,
+            "datetime": datetime(trade_date // 10000, trade_date // 100 % 100, trade_date % 100)
+            + timedelta(microseconds=time_us),
+            "bid_price_1": bid1,
+            "bid_volume_1": bid_vol1,
+            "ask_price_1": ask1,
+            "ask_volume_1": ask_vol1,
+            "open_price": 0.0,
+            "high_price": 0.0,
+            "low_price": 0.0,
+            "pre_close": 0.0,
+            "pre_settlement": 0.0,
+        })
+    return seq, ticks
+
+
+class TxBuffer:
+    """exanic_pybind（或软件替身模块）的 TX 句柄适配为发布者所需的发送端接口。"""
+
+    def __init__(self, api, handle):
+        self._api = api
+        self._handle = handle
+
+    def transmit_frame(self, frame: bytes) -> int:
+        return self._api.transmit_frame(self._handle, frame)
+
+    def get_tx_timestamp(self) -> int:
+        return self._api.get_tx_timestamp(self._handle)
+
+    def tx_ops(self):
+        return self._api.tx_ops(self._handle) if hasattr(self._api, "tx_ops") else None
+
+
+def create_tx_publisher(tx, tx_config: Optional[Dict[str, Any]] = None, native: bool = True):
+    """按 tx_publisher 配置创建发布者（native 优先）。
+
+    Args:
+        tx: 发送端（TxBuffer、SoftFrameRing 等，需 transmit_frame / get_tx_timestamp，
+            原生发布者另需 tx_ops() 返回 "fq.TxOps" capsule）。
+        tx_config: 配置段，未给出的参数取 DEFAULT_TX_CONFIG。
+        native: native_pybind 可用时是否使用原生实现。
+    """
+    cfg = dict(DEFAULT_TX_CONFIG)
+    for key in DEFAULT_TX_CONFIG:
+        if tx_config and tx_config.get(key) is not None:
+            cfg[key] = tx_config[key]
+    for key in ("dst_port", "src_port", "ticks_per_frame", "stamp_spins", "stamp_capacity", "ttl"):
+        cfg[key] = int(cfg[key])
+    if cfg["symbols"] is not None:
+        cfg["symbols"] = [str(s) for s in cfg["symbols"]]
+    m = get_native_pybind()
+    cls = UdpTickPublisher
+    if native and m is not None and hasattr(m, "UdpTickPublisher"):
+        ops = getattr(tx, "tx_ops", None)
+        if ops is not None and ops() is not None:
+            cls = m.UdpTickPublisher
+    try:
+        return cls(tx, **cfg)
+    except ValueError as e:
+        raise ConfigError(f"tx_publisher 配置无效: {e}") from e
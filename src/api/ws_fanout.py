@@ -0,0 +1,553 @@
+# -*- coding: utf-8 -*-
+"""看板 WebSocket 推送模块（本机 / 局域网，无外部服务）
+
+看板此前轮询文件或 Redis，延迟以秒计且负载高。本模块在采集进程内提供 WebSocket 服务：
+- 最新行情表：每合约一个槽位，保存最新一条行情与版本号；行情线程（流水线 ws_fanout 阶段）只写表，
+  与客户端个数、快慢无关
+- 服务线程：单线程非阻塞事件循环（native 为 epoll）处理全部连接；每个客户端按自己的频率取一次表，
+  只发送自上次发送后有更新的已订阅合约，合并为一条消息；上一条消息还没写完（慢客户端）时跳过本轮，
+  下一轮直接发届时的最新值，每个客户端至多积压一条消息；pong / close / 错误回复等控制帧另计，
+  未发出的控制帧超过 MAX_CONTROL_BACKLOG 字节（只发 ping 不读的客户端）即断开
+
+协议（RFC 6455，连接 ws://host:port/，查询参数可直接给出 symbols、rate、format）：
+- 客户端文本命令：subscribe <合约...|*>、unsubscribe <合约...|*>、rate <Hz>、format json|binary；
+  合约之间可用空格或逗号分隔，未知命令回 {"error":"unknown command"}；
+  合约只在全局符号表中查找、不登记，尚未出现的合约记入该客户端的待解析列表（至多 MAX_PENDING 个，
+  超出回 {"error":"too many pending symbols"}），合约出现后自动转为订阅
+- json 更新：{"seq":n,"ticks":[{symbol, exchange, datetime, last_price, volume, turnover, open_interest,
+  bid_price_1, bid_volume_1, ask_price_1, ask_volume_1}, ...]}，浮点按 %.15g，非有限值为 null
+- binary 更新：帧头 <IHHQ（魔数 "FQT1"、条数、单条长度、seq）+ 104 字节定长记录，与 TX 发布的 UDP 载荷一致，
+  可用 src.api.tx_publisher.decode_wire_payload 解析
+
+native_pybind 可用时使用 fq::SnapshotTable + fq::WsFanoutServer（行情表写入为一次 seqlock 槽位写），
+否则使用等价的纯 Python 实现（selectors + 线程）。两者消息内容一致。
+"""
+import base64
+import hashlib
+import math
+import selectors
+import socket
+import struct
+import threading
+import time
+from typing import Any, Dict, List, Optional, Tuple
+from urllib.parse import parse_qsl, urlsplit
+
+from src.api.tx_publisher import WIRE_MAGIC, _FRAME_HEADER, _WIRE_TICK, encode_wire_tick
+from src.processor.symbol_table import MAX_SYMBOL_LEN, get_symbol_table, normalize_symbol
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+OP_TEXT, OP_BINARY, OP_CLOSE, OP_PING, OP_PONG = 0x1, 0x2, 0x8, 0x9, 0xA
+MAX_REQUEST = 8192
+MAX_COMMAND = 4096
+MAX_PENDING = 256  # 每客户端待解析合约上限
+MAX_CONTROL_BACKLOG = 4 * MAX_COMMAND  # 每客户端未发出的控制帧（pong / close / 错误回复）字节上限，超过即断开
+FORMATS = ("json", "binary")
+
+DEFAULT_WS_CONFIG = {
+    "host": "127.0.0.1",
+    "port": 8765,
+    "capacity": 65536,
+    "rate": 4.0,
+    "max_rate": 50.0,
+    "max_clients": 256,
+    "format": "json",
+}
+
+
+def websocket_accept(key: str) -> str:
+    """Sec-WebSocket-Accept = base64(sha1(key + GUID))"""
+    return base64.b64encode(hashlib.sha1((key + WS_GUID).encode("ascii")).digest()).decode("ascii")
+
+
+def ws_frame(opcode: int, payload: bytes) -> bytes:
+    """服务端帧（FIN、不掩码）。"""
+    n = len(payload)
+    if n < 126:
+        head = struct.pack("!BB", 0x80 | opcode, n)
+    elif n <= 0xFFFF:
+        head = struct.pack("!BBH", 0x80 | opcode, 126, n)
+    else:
+        head = struct.pack("!BBQ", 0x80 | opcode, 127, n)
+    return head + payload
+
+
+def _json_float(v: Any) -> str:
+    v = float(v or 0.0)
+    return "%.15g" % v if math.isfinite(v) else "null"
+
+
+def json_tick(data: Dict, symbol: str) -> str:
+    """单条行情的 JSON 对象，键顺序与数值格式与 fq::json_append_tick 一致。"""
+    dt = data["datetime"]
+    return (
+        f'{{"symbol":"{symbol}","exchange":"{data.get("exchange") or ""}",'
+        f'"datetime":"{dt.isoformat(timespec="microseconds")}",'
+        f'"last_price":{_json_float(data.get("last_price"))},"volume":{int(data.get("volume") or 0)},'
+        f'"turnover":{_json_float(data.get("turnover"))},"open_interest":{_json_float(data.get("open_interest"))},'
+        f'"bid_price_1":{_json_float(data.get("bid_price_1"))},"bid_volume_1":{int(data.get("bid_volume_1") or 0)},'
+        f'"ask_price_1":{_json_float(data.get("ask_price_1"))},"ask_volume_1":{int(data.get("ask_volume_1") or 0)}}}'
+    )
+
+
+class _Client:
+    __slots__ = ("sock", "open", "binary", "all", "interval", "next_due", "seq", "inbuf", "out", "control", "overflow",
+                 "subs", "all_sent", "pending", "pending_checked")
+
+    def __init__(self, sock: socket.socket, binary: bool, interval: float):
+        self.sock = sock
+        self.open = False
+        self.binary = binary
+        self.all = False
+        self.interval = interval
+        self.next_due = 0.0
+        self.seq = 0
+        self.inbuf = b""
+        self.out = b""
+        self.control = 0        # out 中尚未发出的控制帧字节数（out 清空时归零）
+        self.overflow = False   # 控制帧积压超过 MAX_CONTROL_BACKLOG，待断开
+        self.subs: Dict[int, int] = {}      # instrument_id -> 已发送版本
+        self.all_sent: Dict[int, int] = {}  # subscribe * 时的已发送版本
+        self.pending: List[str] = []        # 订阅时符号表中尚无的合约
+        self.pending_checked = 0            # 上次解析 pending 时的符号表大小
+
+
+class WsFanoutServer:
+    """纯 Python WebSocket 扇出服务（与 native_pybind.WsFanoutServer 接口、消息一致）。"""
+
+    def __init__(self, host: str = "127.0.0.1", port: int = 8765, capacity: int = 65536, rate: float = 4.0,
+                 max_rate: float = 50.0, max_clients: int = 256, format: str = "json"):
+        if format not in FORMATS:
+            raise ValueError(f"unknown format: {format}")
+        self.host = host
+        self._port = int(port)
+        self.capacity = max(1, int(capacity))
+        self.max_rate = float(max_rate) if max_rate > 0 else 50.0
+        self.rate = self._clamp_rate(float(rate), 4.0)
+        self.max_clients = int(max_clients)
+        self.binary = format == "binary"
+        # 最新行情表：instrument_id -> (版本, 行情 dict)；整体替换元组，读取方无需加锁
+        self._table: Dict[int, Tuple[int, Dict]] = {}
+        self._thread: Optional[threading.Thread] = None
+        self._stop = threading.Event()
+        self._listen: Optional[socket.socket] = None
+        self._selector: Optional[selectors.BaseSelector] = None
+        self._wake_r: Optional[socket.socket] = None
+        self._wake_w: Optional[socket.socket] = None
+        self._clients: Dict[int, _Client] = {}
+        self._stats = {"clients": 0, "accepted": 0, "rejected": 0, "messages": 0, "ticks": 0, "bytes": 0,
+                       "conflated": 0}
+
+    # ---- 行情线程 ----
+
+    def publish(self, data_list: List[Dict], start: int = 0) -> int:
+        """写入最新行情表，返回写入条数。"""
+        table = self._table
+        n = 0
+        for i in range(start, len(data_list)):
+            data = data_list[i]
+            iid = data.get("instrument_id")
+            if not isinstance(iid, int) or not 0 <= iid < self.capacity or data.get("datetime") is None:
+                continue
+            prev = table.get(iid)
+            table[iid] = ((prev[0] if prev else 0) + 1, data)
+            n += 1
+        return n
+
+    # ---- 生命周期 ----
+
+    @property
+    def port(self) -> int:
+        return self._port
+
+    @property
+    def running(self) -> bool:
+        return self._thread is not None
+
+    def start(self) -> None:
+        if self._thread is not None:
+            return
+        try:
+            listen = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            listen.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            listen.bind((self.host, self._port))
+            listen.listen(128)
+        except OSError as e:
+            raise RuntimeError(f"bind {self.host}:{self._port}: {e}") from e
+        listen.setblocking(False)
+        self._port = listen.getsockname()[1]
+        self._listen = listen
+        self._selector = selectors.DefaultSelector()
+        self._selector.register(listen, selectors.EVENT_READ)
+        self._wake_r, self._wake_w = socket.socketpair()
+        self._wake_r.setblocking(False)
+        self._selector.register(self._wake_r, selectors.EVENT_READ)
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._run, name="ws-fanout", daemon=True)
+        self._thread.start()
+
+    def stop(self) -> None:
+        if self._thread is None:
+            return
+        self._stop.set()
+        try:
+            self._wake_w.send(b"x")
+        except OSError:
+            pass
+        self._thread.join()
+        self._thread = None
+        for c in list(self._clients.values()):
+            c.sock.close()
+        self._clients.clear()
+        self._stats["clients"] = 0
+        for s in (self._listen, self._wake_r, self._wake_w):
+            s.close()
+        self._selector.close()
+
+    def stats(self) -> Dict[str, int]:
+        return dict(self._stats)
+
+    # ---- 服务线程 ----
+
+    def _clamp_rate(self, hz: float, default: float) -> float:
+        if not hz > 0:
+            return default
+        return min(hz, self.max_rate)
+
+    def _run(self) -> None:
+        while not self._stop.is_set():
+            for key, mask in self._selector.select(self._next_timeout()):
+                sock = key.fileobj
+                if sock is self._wake_r:
+                    continue
+                if sock is self._listen:
+                    self._accept()
+                    continue
+                c = self._clients.get(sock.fileno())
+                if c is None:
+                    continue
+                ok = True
+                if mask & selectors.EVENT_WRITE:
+                    ok = self._flush(c)
+                if ok and mask & selectors.EVENT_READ:
+                    ok = self._on_readable(c)
+                if not ok:
+                    self._drop(c)
+            self._send_due()
+
+    def _next_timeout(self) -> float:
+        due = [c.next_due for c in self._clients.values() if c.open]
+        if not due:
+            return 0.1
+        return min(0.1, max(0.0, min(due) - time.monotonic()))
+
+    def _accept(self) -> None:
+        while True:
+            try:
+                sock, _ = self._listen.accept()
+            except (BlockingIOError, InterruptedError):
+                return
+            if len(self._clients) >= self.max_clients:
+                sock.close()
+                self._stats["rejected"] += 1
+                continue
+            sock.setblocking(False)
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            c = _Client(sock, self.binary, 1.0 / self.rate)
+            self._clients[sock.fileno()] = c
+            self._selector.register(sock, selectors.EVENT_READ)
+            self._stats["accepted"] += 1
+
+    def _drop(self, c: _Client) -> None:
+        if self._clients.pop(c.sock.fileno(), None) is None:
+            return
+        if c.open:
+            self._stats["clients"] -= 1
+        self._selector.unregister(c.sock)
+        c.sock.close()
+
+    def _on_readable(self, c: _Client) -> bool:
+        while True:
+            try:
+                data = c.sock.recv(4096)
+            except (BlockingIOError, InterruptedError):
+                break
+            except OSError:
+                return False
+            if not data:
+                return False
+            c.inbuf += data
+            # 已握手的连接边收边解析，连续的小帧不会累积到上限；只发不收的客户端由控制帧积压上限断开
+            if c.open and not self._parse_frames(c):
+                return False
+            if len(c.inbuf) > MAX_REQUEST + MAX_COMMAND:
+                return False
+        return self._parse_frames(c) if c.open else self._handshake(c)
+
+    def _handshake(self, c: _Client) -> bool:
+        end = c.inbuf.find(b"\r\n\r\n")
+        if end < 0:
+            return len(c.inbuf) <= MAX_REQUEST
+        request = c.inbuf[:end].decode("latin-1")
+        c.inbuf = c.inbuf[end + 4:]
+        lines = request.split("\r\n")
+        key = ""
+        for header in lines[1:]:
+            name, sep, value = header.partition(":")
+            if sep and name.strip().lower() == "sec-websocket-key":
+                key = value.strip()
+        parts = lines[0].split(" ")
+        if parts[0] != "GET" or len(parts) < 2 or not key:
+            try:
+                c.sock.send(b"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n")
+            except OSError:
+                pass
+            self._stats["rejected"] += 1
+            return False
+        c.out += (
+            "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            f"Sec-WebSocket-Accept: {websocket_accept(key)}\r\n\r\n"
+        ).encode("ascii")
+        c.open = True
+        self._stats["clients"] += 1
+        # 查询参数与命令等价：/?symbols=rb2505,cu2505&rate=10&format=binary
+        for k, v in parse_qsl(urlsplit(parts[1]).query):
+            if k == "symbols":
+                self._command(c, "subscribe " + v)
+            elif k in ("rate", "format"):
+                self._command(c, f"{k} {v}")
+        c.next_due = time.monotonic()
+        if c.overflow or not self._flush(c):
+            return False
+        return not c.inbuf or self._parse_frames(c)
+
+    def _parse_frames(self, c: _Client) -> bool:
+        buf = c.inbuf
+        off = 0
+        while len(buf) - off >= 2:
+            b0, b1 = buf[off], buf[off + 1]
+            if not b1 & 0x80 or not b0 & 0x80:
+                return False  # 客户端帧必须掩码；不支持分片
+            n = b1 & 0x7F
+            hdr = 2
+            if n == 126:
+                if len(buf) - off < 4:
+                    break
+                n = struct.unpack_from("!H", buf, off + 2)[0]
+                hdr = 4
+            elif n == 127:
+                return False
+            if n > MAX_COMMAND:
+                return False
+            if len(buf) - off < hdr + 4 + n:
+                break
+            mask = buf[off + hdr:off + hdr + 4]
+            payload = bytes(b ^ mask[i & 3] for i, b in enumerate(buf[off + hdr + 4:off + hdr + 4 + n]))
+            off += hdr + 4 + n
+            op = b0 & 0x0F
+            if op in (OP_TEXT, OP_BINARY):
+                self._command(c, payload.decode("utf-8", errors="replace"))
+            elif op == OP_PING:
+                self._queue_control(c, OP_PONG, payload)
+            elif op == OP_CLOSE:
+                if self._queue_control(c, OP_CLOSE, payload[:2]):
+                    self._flush(c)
+                return False
+            if c.overflow:
+                return False  # 只发不收的客户端：与数据帧一样至多积压有限字节，超过即断开
+        c.inbuf = buf[off:]
+        return self._flush(c)
+
+    def _command(self, c: _Client, text: str) -> None:
+        tok = text.replace(",", " ").split()
+        if not tok:
+            return
+        op = tok[0]
+        if op in ("subscribe", "unsubscribe"):
+            add = op == "subscribe"
+            table = get_symbol_table()
+            for sym in tok[1:]:
+                if sym == "*":
+                    c.all = add
+                    c.all_sent = {}
+                    if not add:
+                        c.subs = {}
+                        c.pending = []
+                    continue
+                name = normalize_symbol(sym)
+                if not name or len(name.encode("utf-8")) > MAX_SYMBOL_LEN:
+                    continue
+                # 客户端给出的名字只查不登记，避免任意连接填满全局符号表
+                iid = table.find(name)
+                if iid >= 0:
+                    if add:
+                        c.subs.setdefault(iid, 0)  # 下一轮发送当前快照
+                    else:
+                        c.subs.pop(iid, None)
+                elif not add:
+                    if name in c.pending:
+                        c.pending.remove(name)
+                elif name not in c.pending:
+                    if len(c.pending) >= MAX_PENDING:
+                        self._queue_control(c, OP_TEXT, b'{"error":"too many pending symbols"}')
+                        break
+                    c.pending.append(name)
+        elif op == "rate" and len(tok) == 2:
+            try:
+                hz = float(tok[1])
+            except ValueError:
+                hz = 0.0
+            c.interval = 1.0 / self._clamp_rate(hz, self.rate)
+            c.next_due = time.monotonic()
+        elif op == "format" and len(tok) == 2 and tok[1] in FORMATS:
+            c.binary = tok[1] == "binary"
+        else:
+            self._queue_control(c, OP_TEXT, b'{"error":"unknown command"}')
+
+    @staticmethod
+    def _queue_control(c: _Client, op: int, payload: bytes) -> bool:
+        """追加一条控制 / 回复帧；积压超过 MAX_CONTROL_BACKLOG 时不追加、标记断开，返回 False"""
+        frame = ws_frame(op, payload)
+        if c.control + len(frame) > MAX_CONTROL_BACKLOG:
+            c.overflow = True
+            return False
+        c.out += frame
+        c.control += len(frame)
+        return True
+
+    def _flush(self, c: _Client) -> bool:
+        if c.out:
+            try:
+                n = c.sock.send(c.out)
+            except (BlockingIOError, InterruptedError):
+                n = 0
+            except OSError:
+                return False
+            c.out = c.out[n:]
+            if not c.out:
+                c.control = 0
+        self._selector.modify(c.sock, selectors.EVENT_READ | (selectors.EVENT_WRITE if c.out else 0))
+        return True
+
+    def _send_due(self) -> None:
+        now = time.monotonic()
+        dead = []
+        for c in self._clients.values():
+            if not c.open or now < c.next_due:
+                continue
+            c.next_due = now + c.interval
+            if c.out:
+                self._stats["conflated"] += 1
+                continue
+            if self._build(c) and not self._flush(c):
+                dead.append(c)
+        for c in dead:
+            self._drop(c)
+
+    def _build(self, c: _Client) -> bool:
+        table = self._table
+        names = get_symbol_table()
+        items = []
+        if c.all:
+            targets = sorted(table)
+            sent = c.all_sent
+        else:
+            if c.pending:
+                self._resolve_pending(c, names)
+            targets = list(c.subs)
+            sent = c.subs
+        for iid in targets:
+            entry = table.get(iid)
+            if entry is None or entry[0] == sent.get(iid, 0):
+                continue
+            sent[iid] = entry[0]
+            symbol = names.name(iid) or entry[1].get("symbol")
+            if c.binary:
+                rec = encode_wire_tick(dict(entry[1], symbol=symbol))
+                if rec is not None:
+                    items.append(rec)
+            else:
+                items.append(json_tick(entry[1], symbol))
+        if not items:
+            return False
+        c.seq += 1
+        if c.binary:
+            for first in range(0, len(items), 0xFFFF):
+                chunk = items[first:first + 0xFFFF]
+                c.out += ws_frame(
+                    OP_BINARY, _FRAME_HEADER.pack(WIRE_MAGIC, len(chunk), _WIRE_TICK.size, c.seq) + b"".join(chunk)
+                )
+        else:
+            c.out += ws_frame(OP_TEXT, f'{{"seq":{c.seq},"ticks":[{",".join(items)}]}}'.encode("utf-8"))
+        self._stats["messages"] += 1
+        self._stats["ticks"] += len(items)
+        self._stats["bytes"] += len(c.out)
+        return True
+
+
+    @staticmethod
+    def _resolve_pending(c: _Client, names) -> None:
+        """符号表自上次检查后有新合约时，把已出现的待解析合约转为订阅。"""
+        size = len(names)
+        if size == c.pending_checked:
+            return
+        c.pending_checked = size
+        still = []
+        for name in c.pending:
+            iid = names.find(name)
+            if iid >= 0:
+                c.subs.setdefault(iid, 0)
+            else:
+                still.append(name)
+        c.pending = still
+
+
+class WsFanoutStage:
+    """流水线阶段：写入最新行情表，数据透传；关闭时停止服务。"""
+
+    def __init__(self, server):
+        self.server = server
+
+    def __call__(self, data_list: List[Dict]) -> List[Dict]:
+        self.server.publish(data_list)
+        return data_list
+
+    def close(self) -> None:
+        futures_logger.info(f"WebSocket 推送已停止: {self.server.stats()}")
+        self.server.stop()
+
+
+def create_ws_fanout(cfg: Optional[Dict[str, Any]] = None, start: bool = True):
+    """按配置创建并启动 WebSocket 扇出服务（native 优先）。
+
+    Args:
+        cfg: 可选 host、port（0 为系统分配）、capacity（合约数）、rate（默认推送频率 Hz）、max_rate、
+            max_clients、format（客户端未指定时的格式）与 native（默认 True），缺省见 DEFAULT_WS_CONFIG。
+        start: 是否立即监听并启动服务线程。
+
+    Raises:
+        ConfigError: 格式或参数无效时抛出。
+        StorageError: 端口无法监听时抛出。
+    """
+    cfg = dict(DEFAULT_WS_CONFIG, **(cfg or {}))
+    if cfg["format"] not in FORMATS:
+        raise ConfigError(f"ws_fanout.format 应为 {FORMATS} 之一，当前为 {cfg['format']!r}")
+    args = (
+        str(cfg["host"]), int(cfg["port"]), int(cfg["capacity"]), float(cfg["rate"]),
+        float(cfg["max_rate"]), int(cfg["max_clients"]), str(cfg["format"]),
+    )
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "WsFanoutServer"):
+        server = m.WsFanoutServer(*args)
+    else:
+        server = WsFanoutServer(*args)
+    if start:
+        try:
+            server.start()
+        except RuntimeError as e:
+            raise StorageError(f"WebSocket 推送无法监听 {args[0]}:{args[1]}: {e}") from e
+        futures_logger.info(f"WebSocket 推送: ws://{args[0]}:{server.port}/，默认 {args[3]} Hz，格式 {args[6]}")
+    return server
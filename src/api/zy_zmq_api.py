@@ -5,8 +5,9 @@
 import ctypes
 import zmq
 import asyncio
-from typing import Optional, Callable
+from typing import Any, Dict, Optional, Callable
 from src.utils import futures_logger
+from src.utils.wait_strategy import AsyncWaitStrategy, create_async_wait_strategy
 
 # 常量定义
 LEVEL_FIVE = 5
@@ -130,12 +131,16 @@ class ZYZmqApi:
         poll_timeout_ms: int = 100,
         receive_sleep_interval: float = 0.01,
         error_retry_interval: float = 1.0,
+        wait_strategy: Optional[Dict[str, Any]] = None,
     ):
         self.dce_address = dce_address
         self.czce_address = czce_address
         self.poll_timeout_ms = poll_timeout_ms
         self.receive_sleep_interval = receive_sleep_interval
         self.error_retry_interval = error_retry_interval
+        # 各交易所接收协程的空闲等待策略；未配置时 timed_block receive_sleep_interval（与原先一致）
+        self._wait_config = wait_strategy
+        self._waits: Dict[str, AsyncWaitStrategy] = {}
         self.context = zmq.Context()
         self.dce_sub = None
         self.czce_sub = None
@@ -174,6 +179,8 @@ class ZYZmqApi:
         if self.czce_sub:
             self.czce_sub.close()
         self.context.term()
+        if self._waits:
+            futures_logger.info(f"ZMQ 接收等待统计: {self.wait_stats()}")
         futures_logger.info("ZMQ 连接已关闭")
 
     async def start_receiving(self, callback: Callable) -> None:
@@ -193,19 +200,28 @@ class ZYZmqApi:
     async def _receive_loop(self, socket, exchange, callback) -> None:
         """单交易所接收循环：轮询 socket，解析后回调。"""
         futures_logger.info(f"开始接收 {exchange} 行情...")
+        wait = create_async_wait_strategy(
+            self._wait_config, defaults={"mode": "timed_block", "block_timeout": self.receive_sleep_interval}
+        )
+        self._waits[exchange] = wait
         while self.is_running:
             try:
                 if socket.poll(timeout=self.poll_timeout_ms):
+                    wait.reset()
                     data = socket.recv()
                     parsed_data = self._parse_raw_data(data, exchange)
                     if parsed_data:
                         callback(parsed_data)
                 else:
-                    await asyncio.sleep(self.receive_sleep_interval)
+                    await wait.idle()
             except Exception as e:
                 futures_logger.error(f"{exchange} 接收循环异常: {e}")
                 await asyncio.sleep(self.error_retry_interval)
 
+    def wait_stats(self) -> Dict[str, Dict[str, Any]]:
+        """各交易所接收协程的空闲等待统计。"""
+        return {exchange: wait.stats() for exchange, wait in self._waits.items()}
+
     def _parse_raw_data(self, data: bytes, exchange: str) -> Optional[dict]:
         """解析 DCE/CZCE 原始字节为统一结构（含 type、data）。"""
         try:
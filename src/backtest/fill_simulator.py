@@ -0,0 +1,199 @@
+# -*- coding: utf-8 -*-
+"""回测撮合模拟模块
+
+用录制的一档盘口模拟委托成交（与 fq::FillSimulator 一致）：
+- 延迟模型：委托在下单后 latency 秒才到达交易所，之前的行情对其不可见
+- 到达时可立即成交（市价，或限价穿越对手价）按对手一档价成交（taker）
+- 否则挂单排队：排在同价位已显示挂量之后；同价成交量（Δvolume × queue_fill_ratio）消耗前方队列，
+  队列耗尽后按挂单价成交（maker）；本价位显示挂量的减少扣除同价成交后的部分视为前方撤单；
+  对手价或成交价穿过挂单价时全部成交
+
+成交以 dict 返回：order_id、instrument_id、side（1 买 / -1 卖）、price、volume、ts、liquidity。
+"""
+import math
+from typing import Any, Dict, List, Optional
+
+from src.utils.native_loader import get_native_pybind
+
+US_PER_DAY = 86400 * 1000000
+_EPOCH_ORDINAL = 719163  # date(1970, 1, 1).toordinal()
+
+_IN_FLIGHT = 0
+_RESTING = 1
+_DONE = 2
+
+
+def sim_time(dt) -> int:
+    """datetime -> 单调递增的回测时间戳（1970-01-01 起的微秒数，按日期天数计，跨月连续，与 fq::sim_time 一致）。"""
+    days = dt.toordinal() - _EPOCH_ORDINAL
+    time_us = ((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1000000 + dt.microsecond
+    return days * US_PER_DAY + time_us
+
+
+class _Order:
+    __slots__ = ("id", "instrument_id", "side", "state", "price", "remaining", "arrive_at", "queue_ahead",
+                 "prev_shown")
+
+    def __init__(self, order_id, instrument_id, side, price, remaining, arrive_at):
+        self.id = order_id
+        self.instrument_id = instrument_id
+        self.side = side
+        self.state = _IN_FLIGHT
+        self.price = price
+        self.remaining = remaining
+        self.arrive_at = arrive_at
+        self.queue_ahead = math.inf
+        # 上一条行情本单价位的显示挂量；None 表示本单价位不是最优价
+        self.prev_shown: Optional[int] = None
+
+
+class FillSimulator:
+    """一档盘口撮合模拟（纯 Python 实现）。"""
+
+    def __init__(self, latency: float = 0.0, queue_fill_ratio: float = 1.0, max_orders: int = 65536):
+        """初始化撮合模拟。
+
+        Args:
+            latency: 委托到达交易所的延迟（秒）。
+            queue_fill_ratio: 同价成交量中消耗前方队列的比例（<1 更保守）。
+            max_orders: 同时在途委托上限。
+        """
+        self.latency_us = int(round(float(latency) * 1e6))
+        self.queue_fill_ratio = float(queue_fill_ratio)
+        self.max_orders = int(max_orders)
+        self._books: Dict[int, List[_Order]] = {}
+        self._orders: Dict[int, _Order] = {}
+        self._volumes: Dict[int, int] = {}
+        self._seq = 0
+
+    def submit(self, instrument_id: int, side: int, price: float, volume: int, ts: int) -> int:
+        """下单：price <= 0 为市价；返回委托号，参数无效或在途委托已满返回 0。"""
+        if instrument_id is None or instrument_id < 0 or side not in (1, -1) or volume <= 0:
+            return 0
+        if len(self._orders) >= self.max_orders:
+            return 0
+        self._seq += 1
+        order = _Order(self._seq, instrument_id, side, float(price), int(volume), ts + self.latency_us)
+        self._orders[order.id] = order
+        self._books.setdefault(instrument_id, []).append(order)
+        return order.id
+
+    def cancel(self, order_id: int) -> bool:
+        """撤单（在途或挂单中）；已成交/已撤/未知委托返回 False。"""
+        order = self._orders.pop(order_id, None)
+        if order is None:
+            return False
+        order.state = _DONE
+        return True
+
+    def live_orders(self) -> int:
+        return len(self._orders)
+
+    def on_tick(self, data: Dict) -> List[Dict]:
+        """推进一条行情，返回本条行情触发的成交。"""
+        iid = data.get("instrument_id")
+        if iid is None or iid < 0:
+            return []
+        volume = int(data.get("volume") or 0)
+        prev = self._volumes.get(iid)
+        dv = volume - prev if prev is not None and volume >= prev else 0
+        self._volumes[iid] = volume
+        book = self._books.get(iid)
+        if not book:
+            return []
+        ts = sim_time(data["datetime"])
+        fills: List[Dict] = []
+        for order in book:
+            if order.state != _DONE and ts >= order.arrive_at:
+                self._match(order, data, dv, ts, fills)
+        if any(o.state == _DONE for o in book):
+            self._books[iid] = [o for o in book if o.state != _DONE]
+        return fills
+
+    def _fill(self, order: _Order, price: float, qty: int, maker: bool, ts: int, fills: List[Dict]) -> None:
+        fills.append({
+            "order_id": order.id,
+            "instrument_id": order.instrument_id,
+            "side": order.side,
+            "price": price,
+            "volume": qty,
+            "ts": ts,
+            "liquidity": "maker" if maker else "taker",
+        })
+        order.remaining -= qty
+        if order.remaining <= 0:
+            order.state = _DONE
+            self._orders.pop(order.id, None)
+
+    def _match(self, order: _Order, data: Dict, dv: int, ts: int, fills: List[Dict]) -> None:
+        # 以买方视角比较：卖单把价格取负，买一/卖一对调
+        s = order.side
+        own = s * order.price
+        bid = float(data.get("bid_price_1") or 0.0)
+        ask = float(data.get("ask_price_1") or 0.0)
+        opp_px, same_px = (ask, bid) if s > 0 else (bid, ask)
+        same_vol = int(data.get("bid_volume_1" if s > 0 else "ask_volume_1") or 0)
+        last = float(data.get("last_price") or 0.0)
+
+        if order.state == _IN_FLIGHT:
+            if order.price <= 0:
+                if opp_px > 0:
+                    self._fill(order, opp_px, order.remaining, False, ts, fills)
+                return
+            if opp_px > 0 and own >= s * opp_px:
+                self._fill(order, opp_px, order.remaining, False, ts, fills)
+                return
+            order.state = _RESTING
+            # 到达前的成交不消耗本单队列
+            if same_px > 0 and order.price == same_px:
+                order.queue_ahead = float(same_vol)
+                order.prev_shown = same_vol
+            elif same_px <= 0 or own > s * same_px:
+                order.queue_ahead = 0.0
+            return
+
+        if (opp_px > 0 and s * opp_px <= own) or (dv > 0 and last > 0 and s * last < own):
+            self._fill(order, order.price, order.remaining, True, ts, fills)
+            return
+        traded = dv if dv > 0 and last == order.price else 0
+        consumed = traded
+        if same_px > 0 and order.price == same_px:
+            if order.prev_shown is None:
+                # 首次（或重新）成为最优价：按显示挂量排队，显示量已反映本条的成交
+                order.queue_ahead = min(order.queue_ahead, float(same_vol))
+                consumed = 0
+            else:
+                # 显示挂量的减少中扣除本价位成交，剩余部分才是前方撤单；撤单可能来自本单之后，排队位置不低于 0
+                cancels = order.prev_shown - same_vol - traded
+                if cancels > 0:
+                    order.queue_ahead = max(0.0, order.queue_ahead - cancels)
+            order.prev_shown = same_vol
+        else:
+            if same_px > 0 and own > s * same_px:
+                order.queue_ahead = 0.0
+            order.prev_shown = None
+        if consumed > 0 and order.queue_ahead != math.inf:
+            order.queue_ahead -= consumed * self.queue_fill_ratio
+            if order.queue_ahead < 0:
+                # 本单成交不超过本价位实际成交量
+                qty = min(order.remaining, consumed, max(1, int(math.floor(-order.queue_ahead + 0.5))))
+                order.queue_ahead = 0.0
+                self._fill(order, order.price, qty, True, ts, fills)
+
+
+def create_fill_simulator(cfg: Optional[Dict[str, Any]] = None):
+    """按 backtest 配置创建撮合模拟（native 优先）。
+
+    Args:
+        cfg: 可选 latency（秒）、queue_fill_ratio、max_orders、native（默认 True）。
+    """
+    cfg = cfg or {}
+    kwargs = {
+        "latency": float(cfg.get("latency", 0.0)),
+        "queue_fill_ratio": float(cfg.get("queue_fill_ratio", 1.0)),
+        "max_orders": int(cfg.get("max_orders", 65536)),
+    }
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "FillSimulator"):
+        return m.FillSimulator(**kwargs)
+    return FillSimulator(**kwargs)
@@ -0,0 +1,138 @@
+# -*- coding: utf-8 -*-
+"""并行参数扫描模块
+
+同一天数据上跑成百上千组参数时，逐次加载数据会让磁盘成为瓶颈：
+- 行情日文件（.fqt，见 src/storage/tick_file）只读 mmap 一次，各工作进程/线程共享同一份页缓存；
+  每次回测经 BacktestEngine.run_tick_files 回放：native_pybind 可用时原生循环直接读映射记录，
+  否则从映射按块（REPLAY_CHUNK 条）流式物化为 dict，工作者不持有整日 dict 副本，
+  内存占用不随工作者数成倍增长（代价是每组参数重新做一次记录 → dict 转换）
+- 参数组合放入共享任务队列，空闲的工作者随取随跑（chunksize=1 的动态调度），
+  慢组合不会拖住其他工作者
+- 结果按组合顺序汇总为列式结果（参数列 + 指标列，numpy 数组），可保存为 .npz 或转 DataFrame
+
+process 模式（默认，fork 子进程）可随核数线性扩展。thread 模式受 GIL 约束：回测引擎、dict 物化与
+策略回调都是 Python 代码，多个线程实际上串行执行，总吞吐与单线程相当；只有策略主要耗时在释放 GIL 的
+原生代码中时才值得使用。
+"""
+import itertools
+import multiprocessing
+import os
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, List, Optional
+
+import numpy as np
+
+from src.backtest.engine import BacktestEngine, load_strategy
+from src.storage.tick_file import TickFile
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError
+
+SWEEP_MODES = ("process", "thread")
+METRIC_COLUMNS = ("pnl", "fills", "orders", "ticks", "elapsed")
+REPLAY_CHUNK = 65536  # 回退路径每次从映射物化的记录数，限制单个工作者的峰值内存
+
+# 工作者状态：日文件映射与回测配置（每个进程一份，线程间共享）
+_worker: Dict[str, Any] = {}
+
+
+def expand_grid(grid: Dict[str, List[Any]]) -> List[Dict[str, Any]]:
+    """参数网格 -> 组合列表（按键的声明顺序做笛卡尔积）。"""
+    keys = list(grid)
+    return [dict(zip(keys, values)) for values in itertools.product(*(grid[k] for k in keys))]
+
+
+def _init_worker(paths: List[str], strategy: str, base_config: Dict[str, Any]) -> None:
+    _worker["files"] = [TickFile(p) for p in paths]
+    _worker["strategy"] = strategy
+    _worker["base"] = base_config
+
+
+def _run_one(task):
+    index, params = task
+    cfg = dict(_worker["base"])
+    cfg.update(params)
+    engine = BacktestEngine(load_strategy(_worker["strategy"], cfg), cfg)
+    result = engine.run_tick_files(_worker["files"], chunk=REPLAY_CHUNK)
+    return index, {k: result[k] for k in METRIC_COLUMNS}
+
+
+class SweepResult:
+    """列式扫描结果：每列一个 numpy 数组，行为参数组合。"""
+
+    def __init__(self, params: List[Dict[str, Any]], metrics: List[Dict[str, Any]], elapsed: float):
+        self.columns: Dict[str, np.ndarray] = {}
+        for key in (params[0] if params else {}):
+            self.columns[key] = np.asarray([p[key] for p in params])
+        for key in METRIC_COLUMNS:
+            self.columns[key] = np.asarray([m[key] for m in metrics])
+        self.elapsed = elapsed
+
+    def __len__(self) -> int:
+        return len(self.columns.get("pnl", ()))
+
+    def best(self, metric: str = "pnl") -> int:
+        """指标最大的组合下标。"""
+        return int(np.argmax(self.columns[metric]))
+
+    def save(self, path: str) -> None:
+        """保存为 .npz（列名即数组名）。"""
+        np.savez(path, **self.columns)
+
+    def to_frame(self):
+        import pandas as pd
+
+        return pd.DataFrame(self.columns)
+
+
+class ParameterSweep:
+    """在共享的行情日文件上并行回测多组参数。"""
+
+    def __init__(
+        self,
+        strategy: str,
+        data_files: List[str],
+        base_config: Optional[Dict[str, Any]] = None,
+        workers: int = 0,
+        mode: str = "process",
+    ):
+        """初始化参数扫描。
+
+        Args:
+            strategy: 策略工厂 "模块:函数"，以合并了参数的回测配置调用。
+            data_files: 行情日文件路径（多日按时间归并回放）。
+            base_config: backtest 基础配置，参数组合覆盖其同名键。
+            workers: 工作者数，0 为 CPU 核数。
+            mode: process（fork 子进程）或 thread。
+        """
+        if mode not in SWEEP_MODES:
+            raise ConfigError(f"未知的扫描模式: {mode}，可选 {', '.join(SWEEP_MODES)}")
+        self.strategy = strategy
+        self.data_files = list(data_files)
+        self.base_config = dict(base_config or {})
+        self.workers = int(workers) or os.cpu_count() or 1
+        self.mode = mode
+
+    def run(self, grid: Dict[str, List[Any]]) -> SweepResult:
+        """按参数网格运行全部组合，返回按组合顺序排列的列式结果。"""
+        combos = expand_grid(grid)
+        tasks = list(enumerate(combos))
+        metrics: List[Optional[Dict[str, Any]]] = [None] * len(combos)
+        workers = max(1, min(self.workers, len(combos)))
+        init_args = (self.data_files, self.strategy, self.base_config)
+        t0 = time.perf_counter()
+        if self.mode == "thread":
+            _init_worker(*init_args)
+            with ThreadPoolExecutor(max_workers=workers) as pool:
+                for index, m in pool.map(_run_one, tasks):
+                    metrics[index] = m
+        else:
+            ctx = multiprocessing.get_context("fork")
+            with ctx.Pool(workers, initializer=_init_worker, initargs=init_args) as pool:
+                for index, m in pool.imap_unordered(_run_one, tasks, chunksize=1):
+                    metrics[index] = m
+        elapsed = time.perf_counter() - t0
+        futures_logger.info(
+            f"参数扫描完成: {len(combos)} 组参数，{workers} 个{self.mode}工作者，耗时 {elapsed:.2f} 秒"
+        )
+        return SweepResult(combos, metrics, elapsed)
@@ -0,0 +1,124 @@
+# -*- coding: utf-8 -*-
+"""自适应攒批控制器模块
+
+dispatch_loop 不再按固定 dispatch_interval 轮询，而是由控制器根据到达速率决定：
+- 空闲（速率 < idle_rate）：有数据立即刷新，轮询间隔 max_poll_interval
+- 繁忙：目标批大小 = 速率 × max_latency（上限 max_batch），最早一条等待不超过 max_latency
+
+native_pybind 可用时使用 fq::AdaptiveBatcher，否则使用等价的纯 Python 实现。
+当前工作点（速率、目标批大小、最近批大小/延迟）通过 metrics() 暴露。
+"""
+import math
+from typing import Any, Dict, Optional
+
+from src.utils.native_loader import get_native_pybind
+
+DEFAULT_DISPATCHER_CONFIG = {
+    "max_latency": 0.02,
+    "max_batch": 4096,
+    "min_poll_interval": 0.0005,
+    "max_poll_interval": 0.005,
+    "idle_rate": 200.0,
+    "rate_window": 0.5,
+}
+
+
+class AdaptiveBatcher:
+    """纯 Python 自适应攒批控制器，与 native_pybind.AdaptiveBatcher 接口一致（时间单位：秒）。"""
+
+    def __init__(
+        self,
+        max_latency: float = 0.02,
+        max_batch: int = 4096,
+        min_poll_interval: float = 0.0005,
+        max_poll_interval: float = 0.005,
+        idle_rate: float = 200.0,
+        rate_window: float = 0.5,
+    ):
+        self.max_latency = float(max_latency)
+        self.max_batch = max(1, int(max_batch))
+        self.min_poll_interval = max(0.0, float(min_poll_interval))
+        self.max_poll_interval = max(self.min_poll_interval, float(max_poll_interval))
+        self.idle_rate = float(idle_rate)
+        self.rate_window = max(1e-6, float(rate_window))
+        self._last_observe: Optional[float] = None
+        self._pending_arrivals = 0
+        self._m: Dict[str, Any] = {
+            "arrival_rate": 0.0,
+            "target_batch": 1,
+            "batching": False,
+            "flushes": 0,
+            "flushed": 0,
+            "last_batch": 0,
+            "last_delay": 0.0,
+            "max_delay": 0.0,
+        }
+
+    def observe(self, n: int, now: float) -> None:
+        """记录一次轮询收到的条数。"""
+        if self._last_observe is None:
+            self._last_observe = now
+            self._pending_arrivals = n
+            return
+        self._pending_arrivals += n
+        dt = now - self._last_observe
+        if dt <= 0:
+            return
+        a = 1.0 - math.exp(-dt / self.rate_window)
+        m = self._m
+        m["arrival_rate"] += a * (self._pending_arrivals / dt - m["arrival_rate"])
+        self._pending_arrivals = 0
+        self._last_observe = now
+        m["batching"] = m["arrival_rate"] >= self.idle_rate
+        if m["batching"]:
+            m["target_batch"] = int(min(self.max_batch, max(1.0, math.floor(m["arrival_rate"] * self.max_latency))))
+        else:
+            m["target_batch"] = 1
+
+    def should_flush(self, pending: int, oldest: float, now: float) -> bool:
+        """积压 pending 条、最早一条到达于 oldest 时是否应刷新。"""
+        if pending <= 0:
+            return False
+        if pending >= self._m["target_batch"] or pending >= self.max_batch:
+            return True
+        return now - oldest >= self.max_latency
+
+    def next_poll_interval(self, pending: int, oldest: float, now: float) -> float:
+        """距下一次轮询应等待的时间（秒）。"""
+        if pending <= 0:
+            return self.min_poll_interval if self._m["batching"] else self.max_poll_interval
+        remaining = oldest + self.max_latency - now
+        return min(self.max_poll_interval, max(self.min_poll_interval, remaining))
+
+    def on_flush(self, n: int, oldest: float, now: float) -> None:
+        """记录一次刷新。"""
+        delay = max(0.0, now - oldest)
+        m = self._m
+        m["flushes"] += 1
+        m["flushed"] += n
+        m["last_batch"] = n
+        m["last_delay"] = delay
+        m["max_delay"] = max(m["max_delay"], delay)
+
+    def metrics(self) -> Dict[str, Any]:
+        """当前工作点与刷新统计。"""
+        return dict(self._m)
+
+
+def create_batcher(dispatcher_config: Optional[Dict[str, Any]] = None):
+    """按 collect.dispatcher 配置创建控制器（native 优先）。
+
+    Args:
+        dispatcher_config: 配置段，未给出的参数取 DEFAULT_DISPATCHER_CONFIG。
+    """
+    cfg = dict(DEFAULT_DISPATCHER_CONFIG)
+    for key in DEFAULT_DISPATCHER_CONFIG:
+        if dispatcher_config and dispatcher_config.get(key) is not None:
+            cfg[key] = dispatcher_config[key]
+    cfg["max_batch"] = int(cfg["max_batch"])
+    for key in ("max_latency", "min_poll_interval", "max_poll_interval", "idle_rate", "rate_window"):
+        cfg[key] = float(cfg[key])
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "AdaptiveBatcher"):
+        return m.AdaptiveBatcher(**cfg)
+    return AdaptiveBatcher(**cfg)
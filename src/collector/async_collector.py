@@ -3,13 +3,21 @@
 负责管理多个具体的行情采集器（如 ZYZmqCollector, CTPCollector），实现并发采集
 """
 import asyncio
-from typing import List, Dict
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import List, Dict, Optional
+from src.collector.adaptive_batcher import create_batcher
 from src.collector.base_collector import BaseFuturesCollector
+from src.collector.priority_lanes import PriorityLanes
+from src.collector.readiness import SourceReadiness, wait_all
+from src.collector.reorder_buffer import create_reorder_buffer
 from src.collector.zy_collector import ZYZmqCollector
 from src.collector.ctp_collector import CTPCollector
 from src.collector.nsq_collector import NSQCollector
 from src.collector.gfex_collector import GfexCollector
 from src.utils import futures_logger
+from src.utils.exceptions import FuturesBaseError
+from src.utils.profiler import register_current_thread
 
 class AsyncFuturesCollector(BaseFuturesCollector):
     """异步行情采集器（分发器）。"""
@@ -20,6 +28,25 @@ class AsyncFuturesCollector(BaseFuturesCollector):
         self._running = True
         _cfg = collect_config or {}
         self._dispatch_interval = float(_cfg.get("dispatch_interval", _cfg.get("interval", 0.1)))
+        # 分发模式：adaptive（按到达速率自适应攒批）/ fixed（固定 dispatch_interval 轮询）
+        _dispatcher_cfg = _cfg.get("dispatcher") or {}
+        self._dispatch_mode = str(_dispatcher_cfg.get("mode", "adaptive")).lower()
+        self._metrics_log_interval = float(_dispatcher_cfg.get("metrics_log_interval", 60))
+        self._batcher = create_batcher(_dispatcher_cfg) if self._dispatch_mode == "adaptive" else None
+        # 优先级通道（collect.priority）：旁路通道每轮最先分发，其余通道按策略出队，每轮至多 max_batch 条。
+        # 分流在各源完整解析与重排之后进行，只影响交给回调的先后，不缩短高优先级合约的解析/重排延迟
+        _priority_cfg = _cfg.get("priority") or {}
+        self._lanes = PriorityLanes(_priority_cfg) if _priority_cfg.get("enable") else None
+        self._lane_budget = int(_dispatcher_cfg.get("max_batch", 4096))
+        # 按合约重排（collect.reorder）：多个子采集器合流后按交易所时间/累计成交量放行，迟到的丢弃
+        _reorder_cfg = _cfg.get("reorder") or {}
+        self._reorder = create_reorder_buffer(_reorder_cfg) if _reorder_cfg.get("enable") else None
+        # 启动（collect.startup）：各行情源并行拉起，按回调事件等待就绪，timeout 为整体上限
+        _startup_cfg = _cfg.get("startup") or {}
+        self._parallel_startup = bool(_startup_cfg.get("parallel", True))
+        self._startup_timeout = float(_startup_cfg.get("timeout", 90))
+        self._startup_t0: Optional[float] = None
+        self._startup_elapsed: Dict[str, float] = {}
         self._init_sub_collectors()
 
     def _init_sub_collectors(self):
@@ -38,14 +65,58 @@ class AsyncFuturesCollector(BaseFuturesCollector):
         if self.market_sources.get("hs_future_gfex_api", {}).get("enable") or self.market_sources.get("gfex", {}).get("enable"):
             self.collectors.append(GfexCollector(self.market_sources))
 
+    def _readiness(self) -> List[SourceReadiness]:
+        return [
+            r for r in (getattr(c, "readiness", None) for c in self.collectors) if isinstance(r, SourceReadiness)
+        ]
+
+    def _init_one(self, collector: BaseFuturesCollector) -> bool:
+        readiness = getattr(collector, "readiness", None)
+        if isinstance(readiness, SourceReadiness):
+            readiness.begin()
+        try:
+            ok = bool(collector.init_connections())
+        except Exception as e:
+            futures_logger.error(f"采集器 {collector.__class__.__name__} 连接异常: {e}", exc_info=True)
+            ok = False
+        if not ok:
+            futures_logger.error(f"采集器 {collector.__class__.__name__} 连接失败")
+            if isinstance(readiness, SourceReadiness):
+                readiness.fail("init_connections 失败")
+        return ok
+
     def init_connections(self) -> bool:
-        """初始化所有子采集器的连接"""
-        all_success = True
-        for collector in self.collectors:
-            if not collector.init_connections():
-                futures_logger.error(f"采集器 {collector.__class__.__name__} 连接失败")
-                all_success = False
-        return all_success
+        """初始化所有子采集器的连接（collect.startup.parallel 时各源在独立线程并行拉起，
+        总耗时取决于最慢的一次握手而非各源之和）"""
+        start = self._startup_t0 = time.monotonic()
+        if self._parallel_startup and len(self.collectors) > 1:
+            with ThreadPoolExecutor(max_workers=len(self.collectors), thread_name_prefix="source-init") as pool:
+                results = list(pool.map(self._init_one, self.collectors))
+        else:
+            results = [self._init_one(c) for c in self.collectors]
+        self._startup_elapsed["init"] = time.monotonic() - start
+        return all(results)
+
+    def wait_ready(self, timeout: Optional[float] = None) -> bool:
+        """等待全部行情源到达 subscribed（由连接/登录/订阅回报推进，不做固定时长等待）。
+
+        Args:
+            timeout: 整体等待上限（秒），默认 collect.startup.timeout。
+
+        Returns:
+            全部就绪返回 True；任一源失败或超时返回 False（时间线见 startup_metrics()）。
+        """
+        ok = wait_all(self._readiness(), timeout=self._startup_timeout if timeout is None else timeout)
+        if self._startup_t0 is not None:
+            self._startup_elapsed["ready"] = time.monotonic() - self._startup_t0
+        return ok
+
+    def startup_metrics(self) -> Dict:
+        """启动时间线：各行情源各阶段相对拉起时刻的耗时（秒）、状态与重连次数，
+        以及并行拉起（init）与等待就绪（ready）的总耗时"""
+        out: Dict = {k: round(v, 6) for k, v in self._startup_elapsed.items()}
+        out["sources"] = {r.name: r.timeline() for r in self._readiness()}
+        return out
 
     def subscribe_market(self) -> bool:
         """订阅所有子采集器的行情"""
@@ -56,12 +127,32 @@ class AsyncFuturesCollector(BaseFuturesCollector):
         return all_success
 
     def collect_data(self) -> List[Dict]:
-        """汇总所有子采集器的数据"""
+        """汇总所有子采集器的数据（启用重排时返回本轮放行的数据，同一合约按交易所时间有序）"""
         all_data = []
         for collector in self.collectors:
             all_data.extend(collector.collect_data())
+        if self._reorder is not None:
+            return self._reorder.push(all_data)
         return all_data
 
+    def dispatch_metrics(self) -> Optional[Dict]:
+        """自适应分发的当前工作点（到达速率、目标批大小、最近批大小/延迟等）；fixed 模式返回 None"""
+        if self._batcher is None:
+            return None
+        return self._batcher.metrics()
+
+    def lane_metrics(self) -> Optional[Dict]:
+        """各优先级通道的积压与出入队计数；未启用优先级通道返回 None"""
+        if self._lanes is None:
+            return None
+        return self._lanes.metrics()
+
+    def reorder_metrics(self) -> Optional[Dict]:
+        """重排缓冲的暂存、重排、迟到丢弃计数；未启用重排返回 None"""
+        if self._reorder is None:
+            return None
+        return self._reorder.metrics()
+
     def stop(self) -> None:
         """停止采集器运行"""
         self._running = False
@@ -75,42 +166,132 @@ class AsyncFuturesCollector(BaseFuturesCollector):
         for collector in self.collectors:
             collector.close_connections()
 
-    async def run_forever(self, on_data_callback):
+    @property
+    def batch_dispatch(self) -> bool:
+        """是否按 TickBatch 分发：所有子采集器均为批次模式，且未启用按 dict 工作的重排与优先级通道"""
+        if not self.collectors or self._reorder is not None or self._lanes is not None:
+            return False
+        return all(getattr(getattr(c, "api", None), "batch_mode", False) for c in self.collectors)
+
+    def collect_batches(self) -> List:
+        """按子采集器采集 TickBatch 批次（跳过空批次）"""
+        batches = []
+        for collector in self.collectors:
+            batch = collector.collect_batch()
+            if batch is not None and len(batch):
+                batches.append(batch)
+        return batches
+
+    async def run_forever(self, on_data_callback, on_batch_callback=None):
         """
         启动异步任务运行所有采集器
         
         CTP 采集器使用回调机制，数据通过回调放入队列，这里定期从队列中取数据
         ZY ZMQ 采集器使用异步接收，需要启动异步任务
+
+        Args:
+            on_data_callback: 接收标准化 dict 列表的回调；为 None 时只走批次回调。
+            on_batch_callback: 可选，接收 TickBatch 的回调（惰性视图，批次在下一轮分发前有效）。
+                同时给出两者时，dict 回调收到的是同一批次物化后的结果。
         """
         tasks = []
+        # 分发循环与 ZMQ 接收协程共用事件循环线程
+        register_current_thread("dispatch", "ASYNC")
         
         # ZY ZMQ 采集器使用异步接收
         for collector in self.collectors:
             if isinstance(collector, ZYZmqCollector):
                 tasks.append(collector.api.start_receiving(collector.on_data_received))
         
+        async def dispatch_batches() -> int:
+            # 批次在下一次 swap 前有效，不跨轮询累积，每轮收到即分发
+            total = 0
+            for batch in self.collect_batches():
+                total += len(batch)
+                await on_batch_callback(batch)
+                if on_data_callback is not None:
+                    await on_data_callback(batch.to_dicts())
+            return total
+
+        async def collect_prioritized() -> List[Dict]:
+            # 未启用优先级通道时原样返回；启用时旁路通道立即交给回调，其余通道按策略出队
+            data = self.collect_data()
+            lanes = self._lanes
+            if lanes is None:
+                return data
+            lanes.push(data)
+            urgent = lanes.drain_bypass()
+            if urgent:
+                await on_data_callback(urgent)
+            return lanes.drain(self._lane_budget)
+
+        def lanes_backlogged() -> bool:
+            return self._lanes is not None and self._lanes.backlog() > 0
+
         # 数据分发循环（从所有采集器的队列中取数据）
         # 这是核心的数据处理循环，定期从队列中取出数据并处理
         async def dispatch_loop():
-            loop_count = 0
-            futures_logger.info("数据分发循环开始运行")
+            batcher = self._batcher
+            pending: List[Dict] = []
+            oldest = 0.0
+            last_metrics_log = time.monotonic()
+            futures_logger.info(f"数据分发循环开始运行，模式: {self._dispatch_mode}")
             try:
                 while self._running:
                     try:
-                        # 从所有采集器的队列中采集数据
-                        data = self.collect_data()
-                        if data:
-                            futures_logger.debug(f"分发 {len(data)} 条数据到回调")
-                            await on_data_callback(data)
-                        
-                        # CTP 回调是同步的，需按配置间隔检查队列
-                        await asyncio.sleep(self._dispatch_interval)
+                        if batcher is None:
+                            if on_batch_callback is not None:
+                                await dispatch_batches()
+                            else:
+                                # 从所有采集器的队列中采集数据
+                                data = await collect_prioritized()
+                                if data:
+                                    futures_logger.debug(f"分发 {len(data)} 条数据到回调")
+                                    await on_data_callback(data)
+                            # CTP 回调是同步的，需按配置间隔检查队列；通道仍有积压时立即继续
+                            await asyncio.sleep(0 if lanes_backlogged() else self._dispatch_interval)
+                            continue
+
+                        now = time.monotonic()
+                        if on_batch_callback is not None:
+                            n = await dispatch_batches()
+                            batcher.observe(n, now)
+                            if n:
+                                batcher.on_flush(n, now, time.monotonic())
+                        else:
+                            data = await collect_prioritized()
+                            batcher.observe(len(data), now)
+                            if data:
+                                if not pending:
+                                    oldest = now
+                                pending.extend(data)
+                            if batcher.should_flush(len(pending), oldest, now):
+                                out, pending = pending, []
+                                batcher.on_flush(len(out), oldest, now)
+                                futures_logger.debug(f"分发 {len(out)} 条数据到回调")
+                                await on_data_callback(out)
+
+                        now = time.monotonic()
+                        if now - last_metrics_log >= self._metrics_log_interval:
+                            last_metrics_log = now
+                            futures_logger.info(f"自适应分发工作点: {batcher.metrics()}")
+                        interval = batcher.next_poll_interval(len(pending), oldest, now)
+                        await asyncio.sleep(0 if lanes_backlogged() else interval)
                     except asyncio.CancelledError:
                         futures_logger.info("数据分发循环被取消")
                         raise
-                    except Exception as e:
+                    except (Exception, FuturesBaseError) as e:
+                        # 业务异常（FuturesBaseError 派生自 BaseException）同样只记录，不终止分发循环
                         futures_logger.error(f"数据分发循环异常: {e}", exc_info=True)
                         await asyncio.sleep(self._dispatch_interval)
+                # 停止时把已攒的数据与通道积压刷出
+                if self._lanes is not None:
+                    pending.extend(self._lanes.drain_bypass())
+                    pending.extend(self._lanes.drain(self._lanes.backlog()))
+                if self._reorder is not None:
+                    pending.extend(self._reorder.flush())
+                if pending and on_data_callback is not None:
+                    await on_data_callback(pending)
             except asyncio.CancelledError:
                 futures_logger.info("数据分发循环已取消")
                 raise
@@ -128,8 +309,10 @@ class AsyncFuturesCollector(BaseFuturesCollector):
             results = await asyncio.gather(*tasks, return_exceptions=True)
             # 检查是否有异常
             for i, result in enumerate(results):
-                if isinstance(result, Exception):
-                    futures_logger.error(f"异步任务 {i} 异常: {result}", exc_info=True)
+                if isinstance(result, asyncio.CancelledError):
+                    continue
+                if isinstance(result, BaseException):
+                    futures_logger.error(f"异步任务 {i} 异常: {result}", exc_info=result)
         except KeyboardInterrupt:
             futures_logger.info("收到中断信号，正在退出...")
             self.stop()
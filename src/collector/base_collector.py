@@ -24,6 +24,8 @@ class BaseFuturesCollector(ABC):
         futures_logger.info(f"初始化采集器，启用行情源：{self.enabled_sources}")
         if not self.enabled_sources:
             raise MarketSourceError("未启用任何行情源，请检查配置文件")
+        # collect_batch 默认实现中无法装入批次（缺合约/datetime 或字段类型不符）而丢弃的条数
+        self.batch_dropped = 0
 
     @abstractmethod
     def init_connections(self) -> bool:
@@ -52,6 +54,34 @@ class BaseFuturesCollector(ABC):
         """
         pass
 
+    def collect_batch(self):
+        """以 TickBatch 形式采集行情（惰性视图，供热路径消费者）。
+
+        默认实现把 collect_data() 的结果装入批次；能直接在批次槽位上解码原始帧的
+        采集器（如 GFEX 批次模式）应覆盖本方法以避免逐条构造 dict。
+
+        Returns:
+            TickBatch（native_pybind 或纯 Python 实现），可能为空。
+        """
+        from src.processor.tick_view import new_tick_batch
+        data_list = self.collect_data()
+        batch = new_tick_batch(max(1, len(data_list)))
+        dropped = 0
+        for data in data_list:
+            try:
+                ok = batch.append_dict(data)
+            except (TypeError, ValueError, RuntimeError):
+                # 原生批次字段类型转换失败时抛 RuntimeError（pybind11 cast_error）
+                ok = False
+            if not ok:
+                dropped += 1
+        if dropped:
+            self.batch_dropped += dropped
+            futures_logger.warning(
+                f"{self.__class__.__name__} 有 {dropped} 条行情无法装入批次，已丢弃（累计 {self.batch_dropped}）"
+            )
+        return batch
+
     @abstractmethod
     def close_connections(self) -> None:
         """关闭所有行情源连接，释放资源。"""
@@ -5,10 +5,12 @@
 import queue
 from typing import List, Dict
 from src.collector.base_collector import BaseFuturesCollector
+from src.collector.readiness import SourceReadiness
 from src.api.ctp_api import CtpMarketApi
 from src.processor.data_parser import DataParser
 from src.utils import futures_logger
 from src.utils.exceptions import DataParseError
+from src.utils.profiler import register_current_thread
 
 class CTPCollector(BaseFuturesCollector):
     """CTP 行情采集器"""
@@ -20,6 +22,7 @@ class CTPCollector(BaseFuturesCollector):
         broker_id = ctp_config.get("broker_id", "")
         investor_id = ctp_config.get("investor_id", "")
         password = ctp_config.get("password", "")
+        self.readiness = SourceReadiness("ctp")
         self.api = CtpMarketApi(
             front_address=ctp_config.get("host", ""),
             flow_path=ctp_config.get("flow_path", "./flow/"),
@@ -27,7 +30,8 @@ class CTPCollector(BaseFuturesCollector):
             subscribe_symbols=ctp_config.get("subscribe_codes", []),
             broker_id=broker_id if broker_id else None,
             investor_id=investor_id if investor_id else None,
-            password=password if password else None
+            password=password if password else None,
+            readiness=self.readiness,
         )
         self.subscribe_codes = ctp_config.get("subscribe_codes", [])
         self.data_queue = queue.Queue()
@@ -43,6 +47,9 @@ class CTPCollector(BaseFuturesCollector):
         注意：如果 auto_subscribe=True，订阅会在登录成功后自动执行
         这里主要检查订阅状态，如果还未订阅则手动订阅
         """
+        # 已收到订阅回报则无需重复订阅
+        if self.readiness.reached():
+            return True
         # 如果已经登录，可以手动订阅（如果自动订阅失败）
         if self.api.is_logged_in:
             return self.api.subscribe(self.subscribe_codes)
@@ -89,6 +96,7 @@ class CTPCollector(BaseFuturesCollector):
 
     def on_data_received(self, raw_msg: Dict):
         """数据接收回调"""
+        register_current_thread("ctp-md", "CTP")
         try:
             futures_logger.debug(f"CTP 数据接收回调: {raw_msg.get('type', 'unknown')}")
             self.data_queue.put(raw_msg)
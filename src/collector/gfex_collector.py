@@ -3,12 +3,15 @@
 
 与 CTP/正瀛/NSQ 采集器结构一致：使用 GfexExanicApi（exanic_pybind 调用 ExaNIC C SDK）
 接收 L2 帧，入队后由 collect_data 经 DataParser 标准化输出。
+配置 tick_batch_capacity > 0 时启用批次模式：帧在接收线程中直接解码进 TickBatch，
+collect_batch() 返回惰性视图批次，collect_data() 则物化为 dict 兼容旧回调。
 """
 
 import queue
 from typing import List, Dict
 
 from src.collector.base_collector import BaseFuturesCollector
+from src.collector.readiness import SUBSCRIBED, SourceReadiness
 from src.api.gfex_exanic_api import GfexExanicApi
 from src.processor.data_parser import DataParser
 from src.utils import futures_logger
@@ -21,18 +24,27 @@ class GfexCollector(BaseFuturesCollector):
     def __init__(self, market_sources: Dict):
         super().__init__(market_sources)
         cfg = market_sources.get("hs_future_gfex_api", {}) or market_sources.get("gfex", {})
+        self.readiness = SourceReadiness("gfex")
         self.api = GfexExanicApi(
             nic_name=cfg.get("nic_name", "exanic0"),
             port_number=int(cfg.get("port_number", 1)),
             buffer_number=int(cfg.get("buffer_number", 0)),
             pybind_path=cfg.get("pybind_path"),
             frame_buffer_size=int(cfg.get("frame_buffer_size", 2048)),
+            tick_batch_capacity=int(cfg.get("tick_batch_capacity", 0) or 0),
+            wait_strategy=cfg.get("wait_strategy"),
+            alloc_guard=cfg.get("alloc_guard"),
+            standin=bool(cfg.get("standin", False)),
+            tx_publisher=cfg.get("tx_publisher"),
         )
         self.data_queue: queue.Queue = queue.Queue()
 
     def init_connections(self) -> bool:
-        """初始化 ExaNIC 连接并启动接收线程"""
-        return self.api.connect(self.on_data_received)
+        """初始化 ExaNIC 连接并启动接收线程（网卡直连，接收线程启动即就绪）"""
+        ok = self.api.connect(self.on_data_received)
+        if ok:
+            self.readiness.mark(SUBSCRIBED)
+        return ok
 
     def subscribe_market(self) -> bool:
         """GFEX 由网卡直连，无单独订阅"""
@@ -41,6 +53,9 @@ class GfexCollector(BaseFuturesCollector):
 
     def collect_data(self) -> List[Dict]:
         """从队列取原始消息，经 DataParser 标准化后返回"""
+        if self.api.batch_mode:
+            batch = self.api.swap_batch()
+            return batch.to_dicts() if batch is not None else []
         data_list: List[Dict] = []
         while not self.data_queue.empty():
             try:
@@ -56,6 +71,14 @@ class GfexCollector(BaseFuturesCollector):
                 futures_logger.error(f"GFEX 数据解析异常: {e}", exc_info=True)
         return data_list
 
+    def collect_batch(self):
+        """批次模式下直接交出接收线程填充的 TickBatch（下次调用前有效）"""
+        if self.api.batch_mode:
+            batch = self.api.swap_batch()
+            if batch is not None:
+                return batch
+        return super().collect_batch()
+
     def close_connections(self) -> None:
         self.api.close()
 
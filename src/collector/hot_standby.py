@@ -0,0 +1,472 @@
+# -*- coding: utf-8 -*-
+"""主备热备模块
+
+单个 main.py 进程退出后，重启、重连与登录（NSQ 还有固定等待）期间的行情会丢失。热备模式下第二个实例
+连接同样的行情源、照常清洗（去重窗口与主进程一致），但不落盘，只保留最近的数据；主进程的落盘位置
+经共享内存镜像（与 fq/hot_standby.hpp 布局一致，/dev/shm/<name>）：
+- 文件头：epoch（每次接管 +1）、leader pid、心跳（CLOCK_MONOTONIC ns）、journal_seq（累计落盘条数）
+- 合约槽位：按合约代码开放寻址，每槽为该合约最近落盘的一条（主进程的快照缓存），seqlock 保护
+备进程每 heartbeat_interval 检查一次：leader 心跳超过 failover_timeout 或进程已不存在时，以 epoch
+比较交换抢占 leader，把保留数据中键（交易所时间, 累计成交量）晚于镜像位置的补写，随后作为主进程继续，
+journal_seq 接续。镜像在每批落盘之后登记，leader 恰在两者之间退出时该批会补写一次（宁可重复一批，不留缺口）。
+备进程平时按镜像位置裁剪保留数据，接管时只需处理主进程尚未落盘的尾部。
+leader 的心跳由独立线程发送（事件循环内同步的清洗 / 落盘不会拖慢心跳）；leader 每次落盘前核对共享区 epoch，
+发现已被接管（自身曾停顿超过 failover_timeout）即退为备进程、停止落盘，不与新 leader 同时写入。
+failover_timeout 须明显大于正常的批处理耗时（不小于 MIN_FAILOVER_TIMEOUT 与 10 个心跳间隔）。
+
+native_pybind 可用时使用 fq::StandbyRegion（原子 CAS 抢占），否则使用基于 mmap + numpy 的等价实现
+（抢占以文件锁互斥；两种实现可读写同一共享区，但混用时抢占互斥不成立，多备进程请使用同一实现）。
+"""
+import asyncio
+import fcntl
+import mmap
+import os
+import threading
+import time
+from collections import deque
+from datetime import datetime
+from typing import Any, Awaitable, Callable, Deque, Dict, List, Optional
+
+import numpy as np
+
+from src.processor.symbol_table import MAX_SYMBOL_LEN, get_symbol_table, normalize_symbol
+from src.storage.tick_file import PACKED_TICK_DTYPE, exchange_time_ns, fill_packed_record, packed_record_to_dict
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError, FuturesBaseError, StorageError
+from src.utils.native_loader import get_native_pybind
+
+SHM_DIR = "/dev/shm"
+MAGIC = b"FQHASHM1"
+VERSION = 2
+ROLES = ("primary", "standby")
+
+HEADER_DTYPE = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("slots", "<u4"),
+    ("epoch", "<u8"),
+    ("leader_pid", "<i8"),
+    ("heartbeat_ns", "<i8"),
+    ("journal_seq", "<u8"),
+    ("symbols", "<u8"),
+    ("pad", "V72"),
+])
+SLOT_DTYPE = np.dtype([
+    ("seq", "<u4"),
+    ("used", "<u4"),
+    ("symbol", "S32"),
+    ("pad", "V24"),
+    ("tick", PACKED_TICK_DTYPE),
+])
+assert HEADER_DTYPE.itemsize == 128 and SLOT_DTYPE.itemsize == 128
+
+DEFAULT_HA_CONFIG = {
+    "role": "primary",
+    "name": "/fq_standby",
+    "slots": 8192,
+    "heartbeat_interval": 0.005,
+    "failover_timeout": 0.5,
+    "retention": 200000,
+}
+MIN_FAILOVER_TIMEOUT = 0.2
+
+_MASK64 = (1 << 64) - 1
+_READ_SPINS = 1 << 16
+
+
+def symbol_hash(symbol: str) -> int:
+    """与 fq::hash_symbol 一致的合约代码哈希（零填充 32 字节，按 8 字节字混合）。"""
+    raw = symbol.encode("utf-8")
+    padded = raw.ljust(MAX_SYMBOL_LEN + 1, b"\x00")
+    h = 0x9E3779B97F4A7C15 ^ len(raw)
+    for i in range((len(raw) + 7) // 8):
+        h ^= int.from_bytes(padded[i * 8:i * 8 + 8], "little")
+        h = (h * 0xBF58476D1CE4E5B9) & _MASK64
+        h ^= h >> 31
+    return h
+
+
+def _tick_key(data: Dict):
+    return exchange_time_ns(data["datetime"]), data.get("volume") or 0
+
+
+def _record_key(rec):
+    return int(rec["exchange_time_ns"]), int(rec["volume"])
+
+
+def _check_timeouts(heartbeat_interval, failover_timeout):
+    """校验心跳间隔与接管超时：超时过短时一次正常的批处理停顿就会触发误接管。"""
+    heartbeat_interval = max(0.0005, float(heartbeat_interval))
+    failover_timeout = float(failover_timeout)
+    if failover_timeout < max(MIN_FAILOVER_TIMEOUT, 10 * heartbeat_interval):
+        raise ConfigError(
+            f"ha.failover_timeout={failover_timeout} 过短：须不小于 {MIN_FAILOVER_TIMEOUT} 秒且不小于 10 个心跳间隔"
+        )
+    return heartbeat_interval, failover_timeout
+
+
+class StandbyRegion:
+    """纯 Python 共享内存区（与 native_pybind.StandbyRegion 接口、布局一致；时间单位为秒）。"""
+
+    def __init__(self, name: str, slots: int = 8192):
+        n = 1
+        while n < slots:
+            n <<= 1
+        self._path = os.path.join(SHM_DIR, name.lstrip("/"))
+        try:
+            fd = os.open(self._path, os.O_RDWR | os.O_CREAT | os.O_EXCL, 0o600)
+            created = True
+        except FileExistsError:
+            fd = os.open(self._path, os.O_RDWR)
+            created = False
+        except OSError as e:
+            raise StorageError(f"打开热备共享内存失败: {self._path}: {e}") from e
+        try:
+            size = HEADER_DTYPE.itemsize + n * SLOT_DTYPE.itemsize
+            if created:
+                os.ftruncate(fd, size)
+            else:
+                for _ in range(1000):
+                    if os.fstat(fd).st_size >= HEADER_DTYPE.itemsize:
+                        break
+                    time.sleep(0.001)
+                size = os.fstat(fd).st_size
+            self._mm = mmap.mmap(fd, size)
+        finally:
+            self._fd = fd
+        self._header = np.frombuffer(self._mm, dtype=HEADER_DTYPE, count=1)
+        if created:
+            self._header["version"] = VERSION
+            self._header["slots"] = n
+            self._header["magic"] = MAGIC
+        else:
+            for _ in range(1000):
+                if self._header["magic"][0] == MAGIC:
+                    break
+                time.sleep(0.001)
+            n = int(self._header["slots"][0])
+            if (self._header["magic"][0] != MAGIC or self._header["version"][0] != VERSION or n == 0
+                    or n & (n - 1) or HEADER_DTYPE.itemsize + n * SLOT_DTYPE.itemsize > size):
+                self.close()
+                raise StorageError(f"热备共享内存格式不符: {self._path}")
+        self._slots = np.frombuffer(self._mm, dtype=SLOT_DTYPE, count=n, offset=HEADER_DTYPE.itemsize)
+        self._slot_of: Dict[str, int] = {}
+
+    def _find_slot(self, symbol: str, create: bool) -> int:
+        slot = self._slot_of.get(symbol)
+        if slot is not None:
+            return slot
+        raw = symbol.encode("utf-8")
+        if not raw or len(raw) > MAX_SYMBOL_LEN:
+            return -1
+        mask = len(self._slots) - 1
+        i = symbol_hash(symbol) & 0xFFFFFFFF & mask
+        for _ in range(mask + 1):
+            s = self._slots[i]
+            if not s["used"]:
+                if not create:
+                    return -1
+                s["symbol"] = raw
+                s["used"] = 1
+                self._header["symbols"] += 1
+                self._slot_of[symbol] = i
+                return i
+            if s["symbol"] == raw:
+                self._slot_of[symbol] = i
+                return i
+            i = (i + 1) & mask
+        return -1
+
+    def _read(self, i: int):
+        s = self._slots[i]
+        for _ in range(_READ_SPINS):
+            a = int(s["seq"])
+            if a & 1:
+                continue
+            rec = s["tick"].copy()
+            if int(s["seq"]) == a:
+                return rec if a else None
+        return None
+
+    def publish(self, data_list: List[Dict]) -> int:
+        n = 0
+        for data in data_list:
+            symbol = normalize_symbol(data.get("symbol") or "")
+            if not isinstance(data.get("datetime"), datetime):
+                continue
+            i = self._find_slot(symbol, True)
+            if i < 0:
+                continue
+            s = self._slots[i]
+            s["seq"] += 1
+            fill_packed_record(s["tick"], data, i, time.time_ns())
+            s["seq"] += 1
+            n += 1
+        self._header["journal_seq"] += n
+        return n
+
+    def unpersisted(self, data_list: List[Dict]) -> List[Dict]:
+        out = []
+        for data in data_list:
+            if isinstance(data.get("datetime"), datetime):
+                i = self._find_slot(normalize_symbol(data.get("symbol") or ""), False)
+                rec = self._read(i) if i >= 0 else None
+                if rec is not None and _tick_key(data) <= _record_key(rec):
+                    continue
+            out.append(data)
+        return out
+
+    def last(self, symbol: str) -> Optional[Dict]:
+        symbol = normalize_symbol(symbol)
+        i = self._find_slot(symbol, False)
+        rec = self._read(i) if i >= 0 else None
+        if rec is None:
+            return None
+        return packed_record_to_dict(rec, symbol, get_symbol_table().intern(symbol))
+
+    def heartbeat(self, now: Optional[float] = None) -> None:
+        self._header["heartbeat_ns"] = time.monotonic_ns() if now is None else int(round(now * 1e9))
+
+    def leader_alive(self, timeout: float, now: Optional[float] = None) -> bool:
+        pid = int(self._header["leader_pid"][0])
+        now_ns = time.monotonic_ns() if now is None else int(round(now * 1e9))
+        if pid <= 0 or now_ns - int(self._header["heartbeat_ns"][0]) > int(round(timeout * 1e9)):
+            return False
+        try:
+            os.kill(pid, 0)
+        except ProcessLookupError:
+            return False
+        except PermissionError:
+            pass
+        return True
+
+    def claim(self, expected_epoch: int, pid: int, now: Optional[float] = None) -> bool:
+        fcntl.flock(self._fd, fcntl.LOCK_EX)
+        try:
+            if int(self._header["epoch"][0]) != expected_epoch:
+                return False
+            self._header["epoch"] = expected_epoch + 1
+            self.heartbeat(now)
+            self._header["leader_pid"] = pid
+            return True
+        finally:
+            fcntl.flock(self._fd, fcntl.LOCK_UN)
+
+    def unlink(self) -> bool:
+        try:
+            os.unlink(self._path)
+            return True
+        except OSError:
+            return False
+
+    def close(self) -> None:
+        self._header = self._slots = None
+        if self._mm is not None:
+            self._mm.close()
+            self._mm = None
+        if self._fd >= 0:
+            os.close(self._fd)
+            self._fd = -1
+
+    @property
+    def epoch(self) -> int:
+        return int(self._header["epoch"][0])
+
+    @property
+    def leader_pid(self) -> int:
+        return int(self._header["leader_pid"][0])
+
+    @property
+    def journal_seq(self) -> int:
+        return int(self._header["journal_seq"][0])
+
+    @property
+    def symbols(self) -> int:
+        return int(self._header["symbols"][0])
+
+    @property
+    def slots(self) -> int:
+        return len(self._slots)
+
+
+def create_standby_region(name: str, slots: int = 8192, native: bool = True):
+    """打开（必要时创建）热备共享内存区（native 优先）。
+
+    Raises:
+        StorageError: 共享内存无法创建、映射或格式不符时抛出。
+    """
+    m = get_native_pybind()
+    if native and m is not None and hasattr(m, "StandbyRegion"):
+        try:
+            return m.StandbyRegion(name, slots)
+        except RuntimeError as e:
+            raise StorageError(f"打开热备共享内存失败: {name}: {e}") from e
+    return StandbyRegion(name, slots)
+
+
+class HotStandby:
+    """主备角色控制：主进程登记落盘位置并发心跳，备进程保留尾部数据并在 leader 失联时接管。"""
+
+    def __init__(
+        self,
+        region,
+        role: str = "primary",
+        heartbeat_interval: float = 0.005,
+        failover_timeout: float = 0.5,
+        retention: int = 200000,
+    ):
+        if role not in ROLES:
+            raise ConfigError(f"ha.role 只能是 {'/'.join(ROLES)}: {role}")
+        self.region = region
+        self.role = role
+        self.heartbeat_interval, self.failover_timeout = _check_timeouts(heartbeat_interval, failover_timeout)
+        self._pid = os.getpid()
+        self._leader = False
+        self._epoch = 0
+        self._running = True
+        self._heartbeat_thread: Optional[threading.Thread] = None
+        self._tail: Deque[Dict] = deque(maxlen=max(1, int(retention)))
+        self._last_heartbeat = 0.0
+        self.promoted_at: Optional[float] = None
+
+    @classmethod
+    def from_config(cls, ha_config: Optional[Dict[str, Any]], role: Optional[str] = None) -> Optional["HotStandby"]:
+        """按 ha 配置创建；未启用返回 None。role 非空时覆盖配置中的角色。"""
+        if not ha_config or not ha_config.get("enable"):
+            return None
+        cfg = dict(DEFAULT_HA_CONFIG)
+        cfg.update({k: v for k, v in ha_config.items() if k in DEFAULT_HA_CONFIG and v is not None})
+        _check_timeouts(cfg["heartbeat_interval"], cfg["failover_timeout"])
+        region = create_standby_region(str(cfg["name"]), int(cfg["slots"]), bool(ha_config.get("native", True)))
+        return cls(
+            region,
+            role or str(cfg["role"]).lower(),
+            float(cfg["heartbeat_interval"]),
+            float(cfg["failover_timeout"]),
+            int(cfg["retention"]),
+        )
+
+    @property
+    def is_leader(self) -> bool:
+        """是否仍为 leader；共享区 epoch 已不是自己登记时的值（已被接管）时退为备进程。"""
+        if self._leader and self.region.epoch != self._epoch:
+            self._step_down()
+        return self._leader
+
+    def _become_leader(self, epoch: int) -> None:
+        self._epoch = epoch
+        self._leader = True
+        self.role = "primary"
+
+    def _step_down(self) -> None:
+        if not self._leader:
+            return
+        self._leader = False
+        self.role = "standby"
+        futures_logger.error(
+            f"已被接管（epoch {self._epoch} -> {self.region.epoch}，leader pid={self.region.leader_pid}），"
+            f"停止落盘并退为备进程"
+        )
+
+    def start(self) -> None:
+        """主进程登记为 leader（已有存活的 leader 时拒绝启动）；备进程只记录当前状态。
+
+        Raises:
+            ConfigError: 以 primary 启动但共享区已有存活的 leader 时抛出。
+        """
+        if self.role == "standby":
+            futures_logger.info(
+                f"热备进程就绪：leader pid={self.region.leader_pid}，epoch={self.region.epoch}，"
+                f"journal_seq={self.region.journal_seq}"
+            )
+            return
+        if self.region.leader_alive(self.failover_timeout) and self.region.leader_pid != self._pid:
+            raise ConfigError(f"热备共享区已有存活的 leader（pid={self.region.leader_pid}），请以 standby 启动")
+        epoch = self.region.epoch
+        if not self.region.claim(epoch, self._pid):
+            raise ConfigError("登记 leader 失败：共享区 epoch 被并发修改")
+        self._become_leader(epoch + 1)
+        self.region.heartbeat()
+        futures_logger.info(f"以主进程运行：epoch={self.region.epoch}，journal_seq={self.region.journal_seq}")
+
+    def on_persisted(self, data_list: List[Dict]) -> None:
+        """leader 在每批落盘之后调用：登记各合约最近落盘行情与 journal 位置。"""
+        if data_list and self.is_leader:
+            self.region.publish(data_list)
+
+    def on_standby_data(self, data_list: List[Dict]) -> None:
+        """备进程保留清洗后的数据，直到被 leader 的落盘位置覆盖。"""
+        if not self._leader and data_list:
+            self._tail.extend(data_list)
+
+    def _prune(self, chunk: int = 1024) -> None:
+        # 从最旧的一段开始剔除已被镜像位置覆盖的数据；遇到未覆盖的数据即停止
+        tail = self._tail
+        while tail:
+            head = [tail.popleft() for _ in range(min(chunk, len(tail)))]
+            keep = self.region.unpersisted(head)
+            if keep:
+                tail.extendleft(reversed(keep))
+                break
+
+    def poll(self, now: Optional[float] = None) -> Optional[List[Dict]]:
+        """leader 按间隔发心跳；备进程裁剪保留数据并检测 leader。接管成功时返回需补写的数据，否则返回 None。"""
+        now = time.monotonic() if now is None else now
+        if self.is_leader:
+            if self._heartbeat_thread is None and now - self._last_heartbeat >= self.heartbeat_interval:
+                self.region.heartbeat(now)
+                self._last_heartbeat = now
+            return None
+        self._prune()
+        if self.region.leader_alive(self.failover_timeout, now):
+            return None
+        epoch = self.region.epoch
+        if not self.region.claim(epoch, self._pid, now):
+            return None
+        gap = self.region.unpersisted(list(self._tail))
+        self._tail.clear()
+        self._become_leader(epoch + 1)
+        self._last_heartbeat = now
+        self.promoted_at = now
+        futures_logger.warning(
+            f"leader 失联，已接管为主进程：epoch={epoch + 1}，journal_seq={self.region.journal_seq}，补写 {len(gap)} 条"
+        )
+        return gap
+
+    def start_heartbeat(self) -> None:
+        """启动独立的心跳线程：作为 leader 期间（含接管之后）按间隔发心跳，不受事件循环停顿影响。"""
+        if self._heartbeat_thread is not None:
+            return
+        self._heartbeat_thread = threading.Thread(target=self._heartbeat_loop, name="ha-heartbeat", daemon=True)
+        self._heartbeat_thread.start()
+
+    def _heartbeat_loop(self) -> None:
+        while self._running:
+            # 先核对 epoch：被接管后不能再刷新新 leader 的心跳
+            if self.is_leader:
+                self.region.heartbeat()
+            time.sleep(self.heartbeat_interval)
+
+    async def run(self, on_promote: Callable[[List[Dict]], Awaitable[None]]) -> None:
+        """心跳/监测循环；接管时先把补写数据交给 on_promote（由其落盘并调用 on_persisted）。"""
+        while self._running:
+            gap = self.poll()
+            if gap is not None:
+                try:
+                    await on_promote(gap)
+                except (Exception, FuturesBaseError) as e:
+                    # 已接管：回调失败不能结束监测循环，否则心跳继续宣告本进程为 leader 而无人处理
+                    futures_logger.error(f"接管回调异常: {e}", exc_info=True)
+            await asyncio.sleep(self.heartbeat_interval)
+
+    def stop(self) -> None:
+        self._running = False
+
+    def close(self) -> None:
+        """停止循环；leader 正常退出时把心跳置零，备进程无需等待超时即可接管。"""
+        self.stop()
+        if self._heartbeat_thread is not None:
+            self._heartbeat_thread.join()
+        if self.is_leader:
+            self.region.heartbeat(0.0)
+        self.region.close()
@@ -10,9 +10,11 @@ import queue
 from typing import List, Dict
 
 from src.collector.base_collector import BaseFuturesCollector
+from src.collector.readiness import SourceReadiness
 from src.api.nsq_api import NsqMarketApi
 from src.processor.data_parser import DataParser
 from src.utils import futures_logger
+from src.utils.profiler import register_current_thread
 from src.utils.exceptions import DataParseError
 
 
@@ -22,6 +24,7 @@ class NSQCollector(BaseFuturesCollector):
     def __init__(self, market_sources: Dict):
         super().__init__(market_sources)
         nsq_cfg = market_sources.get("nsq_dce_net_api", {})
+        self.readiness = SourceReadiness("nsq_dce_net_api")
         self.api = NsqMarketApi(
             config_path=nsq_cfg.get("config_path"),
             username=nsq_cfg.get("username"),
@@ -30,6 +33,9 @@ class NSQCollector(BaseFuturesCollector):
             log_path=nsq_cfg.get("log_path"),
             markets=nsq_cfg.get("markets", "dce"),
             pybind_path=nsq_cfg.get("pybind_path"),
+            readiness=self.readiness,
+            connect_timeout=float(nsq_cfg.get("connect_timeout", 60)),
+            login_timeout=float(nsq_cfg.get("login_timeout", 30)),
         )
         self.data_queue: queue.Queue = queue.Queue()
 
@@ -64,5 +70,6 @@ class NSQCollector(BaseFuturesCollector):
 
     def on_data_received(self, raw_msg: Dict):
         """数据接收回调：入队"""
+        register_current_thread("nsq-md", "NSQ")
         self.data_queue.put(raw_msg)
 
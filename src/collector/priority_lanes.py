@@ -0,0 +1,209 @@
+# -*- coding: utf-8 -*-
+"""合约优先级通道模块
+
+按 main_config.yaml 的 collect.priority 把合约划分为若干优先级类别，每个类别一条通道：
+- 类别按配置顺序排列，越靠前优先级越高；未匹配的合约归入最后的 default 通道
+- bypass_batching 的通道不参与自适应攒批，每轮分发时最先交给回调
+- 其余通道按 strict（严格优先级）或 weighted（按 weight 的赤字轮询）出队；weighted 下仍有积压的
+  通道未用完的额度留到下一轮，通道取空即清零
+
+分流点在分发循环：行情此时已由各源完整解析，启用 collect.reorder 时也已经过重排，
+因此通道只决定解析完成后交给回调的先后，高优先级合约的解析与重排暂存延迟不会因此缩短。
+
+合约归类以 instrument_id 为键：symbols 中的合约直接登记，products 中的品种在合约
+首次出现时按合约代码开头字母归类一次并缓存。native_pybind 可用时由 fq::LaneMap /
+fq::LaneScheduler 完成分流与出队规划，否则使用等价的纯 Python 实现。
+"""
+import re
+from collections import deque
+from typing import Any, Deque, Dict, List, Optional
+
+from src.processor.symbol_table import get_symbol_table
+from src.utils import futures_logger
+from src.utils.native_loader import get_native_pybind
+
+DEFAULT_LANE_NAME = "default"
+_PRODUCT_RE = re.compile(r"^[A-Za-z]+")
+
+
+class _LaneMap:
+    """纯 Python 合约 -> 通道映射（与 fq::LaneMap 语义一致）。"""
+
+    def __init__(self, default_lane: int, symbol_table):
+        self._default = default_lane
+        self._symbols = symbol_table
+        self._lanes: List[Optional[int]] = []
+        self._products: Dict[str, int] = {}
+
+    def set_lane(self, instrument_id: int, lane: int) -> None:
+        if instrument_id < 0:
+            return
+        if instrument_id >= len(self._lanes):
+            self._lanes.extend([None] * (instrument_id + 1 - len(self._lanes)))
+        self._lanes[instrument_id] = lane
+
+    def add_product(self, product: str, lane: int) -> None:
+        self._products.setdefault(product.lower(), lane)
+
+    def lane_of(self, instrument_id: int) -> int:
+        if instrument_id is None or instrument_id < 0:
+            return self._default
+        if instrument_id < len(self._lanes):
+            lane = self._lanes[instrument_id]
+            if lane is not None:
+                return lane
+        lane = self._default
+        name = self._symbols.name(instrument_id) if self._products else None
+        if name:
+            m = _PRODUCT_RE.match(name)
+            if m:
+                lane = self._products.get(m.group(0).lower(), self._default)
+        self.set_lane(instrument_id, lane)
+        return lane
+
+
+class _LaneScheduler:
+    """纯 Python 出队规划（与 fq::LaneScheduler 语义一致）。"""
+
+    def __init__(self, weights: List[int], strict: bool):
+        self._weights = [max(1, int(w)) for w in weights]
+        self._deficit = [0] * len(self._weights)
+        self._strict = strict
+        self._cursor = 0
+
+    def plan(self, backlog: List[int], budget: int) -> List[int]:
+        n = len(self._weights)
+        take = [0] * n
+        total = 0
+        if self._strict:
+            for i in range(n):
+                if total >= budget:
+                    break
+                take[i] = min(backlog[i], budget - total)
+                total += take[i]
+            return take
+        progressed = True
+        while total < budget and progressed:
+            progressed = False
+            for k in range(n):
+                if total >= budget:
+                    break
+                i = (self._cursor + k) % n
+                left = backlog[i] - take[i]
+                if left == 0:
+                    self._deficit[i] = 0
+                    continue
+                self._deficit[i] += self._weights[i]
+                give = min(self._deficit[i], left, budget - total)
+                take[i] += give
+                self._deficit[i] = 0 if give == left else self._deficit[i] - give
+                total += give
+                progressed = progressed or give > 0
+        self._cursor = (self._cursor + 1) % max(1, n)
+        return take
+
+
+class PriorityLanes:
+    """优先级通道：分流、旁路通道直出、其余通道按策略出队。"""
+
+    def __init__(self, priority_config: Dict[str, Any], symbol_table=None, native: Optional[bool] = None):
+        """初始化通道。
+
+        Args:
+            priority_config: collect.priority 配置段（drain、classes、default_weight）。
+            symbol_table: 合约符号表，默认使用全局符号表。
+            native: 为 False 时强制使用纯 Python 实现；None 表示自动选择。
+        """
+        cfg = priority_config or {}
+        symbols = symbol_table if symbol_table is not None else get_symbol_table()
+        classes = [c for c in (cfg.get("classes") or []) if c.get("name") != DEFAULT_LANE_NAME]
+        self.names: List[str] = [str(c.get("name", f"lane{i}")) for i, c in enumerate(classes)]
+        self.names.append(DEFAULT_LANE_NAME)
+        weights = [int(c.get("weight", 1)) for c in classes] + [int(cfg.get("default_weight", 1))]
+        self.bypass: List[bool] = [bool(c.get("bypass_batching", False)) for c in classes] + [False]
+        self.strict = str(cfg.get("drain", "strict")).lower() != "weighted"
+        default_lane = len(self.names) - 1
+
+        m = get_native_pybind() if native is not False else None
+        if m is not None and hasattr(m, "PriorityLanes") and getattr(symbols, "is_native", False):
+            self._native = m.PriorityLanes(weights, self.strict, default_lane)
+            self._map = self._native
+        else:
+            self._native = None
+            self._map = _LaneMap(default_lane, symbols)
+            self._scheduler = _LaneScheduler(weights, self.strict)
+
+        for lane, c in enumerate(classes):
+            for symbol in c.get("symbols") or []:
+                iid = symbols.intern(symbol)
+                if iid >= 0:
+                    self._map.set_lane(iid, lane)
+            for product in c.get("products") or []:
+                self._map.add_product(str(product), lane)
+
+        self._queues: List[Deque[Dict]] = [deque() for _ in self.names]
+        self._pushed = [0] * len(self.names)
+        self._drained = [0] * len(self.names)
+        futures_logger.info(
+            f"优先级通道: {self.names}，出队策略: {'strict' if self.strict else 'weighted'}，"
+            f"旁路攒批: {[n for n, b in zip(self.names, self.bypass) if b]}"
+        )
+
+    def lane_of(self, instrument_id: int) -> int:
+        """合约 ID -> 通道编号（0 为最高优先级）。"""
+        return self._map.lane_of(instrument_id)
+
+    def push(self, data_list: List[Dict]) -> None:
+        """把一批标准化行情分流到各通道。"""
+        if not data_list:
+            return
+        if self._native is not None:
+            parts = self._native.partition(data_list)
+            for lane, part in enumerate(parts):
+                if part:
+                    self._queues[lane].extend(part)
+                    self._pushed[lane] += len(part)
+            return
+        lane_of = self._map.lane_of
+        queues = self._queues
+        for data in data_list:
+            lane = lane_of(data.get("instrument_id", -1))
+            queues[lane].append(data)
+            self._pushed[lane] += 1
+
+    def drain_bypass(self) -> List[Dict]:
+        """取出全部旁路通道的积压（按优先级顺序）。"""
+        out: List[Dict] = []
+        for lane, bypass in enumerate(self.bypass):
+            if bypass and self._queues[lane]:
+                q = self._queues[lane]
+                self._drained[lane] += len(q)
+                out.extend(q)
+                q.clear()
+        return out
+
+    def drain(self, budget: int) -> List[Dict]:
+        """按出队策略从非旁路通道取出至多 budget 条。"""
+        backlog = [0 if b else len(q) for q, b in zip(self._queues, self.bypass)]
+        if not any(backlog):
+            return []
+        planner = self._native if self._native is not None else self._scheduler
+        take = planner.plan(backlog, int(budget))
+        out: List[Dict] = []
+        for lane, n in enumerate(take):
+            q = self._queues[lane]
+            for _ in range(n):
+                out.append(q.popleft())
+            self._drained[lane] += n
+        return out
+
+    def backlog(self) -> int:
+        """各通道积压总条数。"""
+        return sum(len(q) for q in self._queues)
+
+    def metrics(self) -> Dict[str, Dict[str, int]]:
+        """各通道积压、入队与出队计数。"""
+        return {
+            name: {"backlog": len(q), "pushed": p, "drained": d}
+            for name, q, p, d in zip(self.names, self._queues, self._pushed, self._drained)
+        }
@@ -0,0 +1,96 @@
+# -*- coding: utf-8 -*-
+"""行情源就绪状态与启动时间线
+
+每个子采集器持有一个 SourceReadiness，由行情 API 的回调按阶段推进：
+connected（前置连接）→ logged_in（登录成功）→ subscribed（订阅回报），失败时记录原因。
+AsyncFuturesCollector 并行拉起各行情源后按同一截止时间等待全部就绪（见 wait_all），
+启动耗时由最慢的一次网络握手决定，而不是各源固定等待时长之和；各阶段相对拉起时刻的
+耗时即启动时间线（timeline），断线重连时重新计时并累计 restarts。
+"""
+import threading
+import time
+from typing import Dict, Iterable, Optional
+
+CONNECTED = "connected"
+LOGGED_IN = "logged_in"
+SUBSCRIBED = "subscribed"
+STAGES = (CONNECTED, LOGGED_IN, SUBSCRIBED)
+
+
+class SourceReadiness:
+    """单个行情源的就绪状态（线程安全，回调线程推进、启动线程等待）。"""
+
+    def __init__(self, name: str):
+        self.name = name
+        self._cond = threading.Condition()
+        self._start = time.monotonic()
+        self._reached: Dict[str, float] = {}
+        self.error: Optional[str] = None
+        self.restarts = 0
+
+    def begin(self) -> None:
+        """开始拉起（清空状态并以当前时刻为时间线起点）。"""
+        with self._cond:
+            self._start = time.monotonic()
+            self._reached = {}
+            self.error = None
+
+    def mark(self, stage: str) -> None:
+        """到达某阶段；之前尚未记录的阶段视为同时到达（如无单独连接回报的源直接标记 subscribed）。"""
+        with self._cond:
+            elapsed = time.monotonic() - self._start
+            for s in STAGES[:STAGES.index(stage) + 1]:
+                self._reached.setdefault(s, elapsed)
+            self._cond.notify_all()
+
+    def fail(self, reason: str) -> None:
+        """拉起失败（等待方立即返回）。"""
+        with self._cond:
+            self.error = reason
+            self._cond.notify_all()
+
+    def reset(self) -> None:
+        """断线：回到初始状态并重新计时，等待 API 自动重连推进。"""
+        with self._cond:
+            if self._reached:
+                self.restarts += 1
+            self._start = time.monotonic()
+            self._reached = {}
+            self.error = None
+
+    def reached(self, stage: str = SUBSCRIBED) -> bool:
+        with self._cond:
+            return stage in self._reached
+
+    def wait(self, stage: str = SUBSCRIBED, timeout: Optional[float] = None) -> bool:
+        """等待到达某阶段；失败或超时返回 False。"""
+        with self._cond:
+            self._cond.wait_for(lambda: stage in self._reached or self.error is not None, timeout)
+            return stage in self._reached
+
+    @property
+    def state(self) -> str:
+        with self._cond:
+            if self.error is not None:
+                return "failed"
+            for s in reversed(STAGES):
+                if s in self._reached:
+                    return s
+            return "pending"
+
+    def timeline(self) -> Dict:
+        """各阶段相对拉起时刻的耗时（秒），以及当前状态、失败原因与重连次数。"""
+        with self._cond:
+            out = {s: round(self._reached[s], 6) for s in STAGES if s in self._reached}
+        out.update(state=self.state, error=self.error, restarts=self.restarts)
+        return out
+
+
+def wait_all(sources: Iterable[SourceReadiness], stage: str = SUBSCRIBED, timeout: Optional[float] = None) -> bool:
+    """按同一截止时间等待全部行情源到达某阶段，总等待不超过 timeout；任一失败或超时返回 False。"""
+    deadline = None if timeout is None else time.monotonic() + timeout
+    ok = True
+    for src in sources:
+        remaining = None if deadline is None else max(0.0, deadline - time.monotonic())
+        ok = src.wait(stage, remaining) and ok
+    return ok
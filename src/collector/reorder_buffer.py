@@ -0,0 +1,150 @@
+# -*- coding: utf-8 -*-
+"""按合约的有界延迟重排模块
+
+多个子采集器（多前置、多行情源、按流哈希分的接收队列）的数据在 collect_data 中按采集器拼接，
+同一合约的行情可能不按交易所时间到达清洗与存储。重排缓冲对每个合约暂存至多 max_hold 的行情，
+按 (交易所时间, 累计成交量, 到达顺序) 放行：
+- 每条行情到达时登记截止时间 到达时间 + max_hold；到期时放行该合约中键不大于它的全部行情，
+  任一行情的停留不超过 max_hold，同一合约的放行序列单调
+- 键早于该合约最近放行键的行情视为迟到，直接丢弃并计入 late，放行序列不回退；
+  下游 K 线、盘口与存储因此可以假定单调输入
+- 暂存条数达到 capacity 时提前放行最早的登记项（计入 forced）
+- 缺少合约或 datetime 的记录不参与重排，原样放行（计入 bypassed）
+
+native_pybind 可用时使用 fq::ReorderBuffer（预分配槽位 + 按合约有序链表，暂存 dict 引用），
+否则使用等价的纯 Python 实现。时间单位为秒（time.monotonic()）。
+"""
+import bisect
+import itertools
+import time
+from collections import deque
+from datetime import datetime
+from typing import Any, Deque, Dict, List, Optional, Tuple
+
+from src.utils.native_loader import get_native_pybind
+
+DEFAULT_REORDER_CONFIG = {
+    "max_hold": 0.0002,
+    "capacity": 65536,
+}
+
+
+class ReorderBuffer:
+    """纯 Python 重排缓冲，与 native_pybind.ReorderBuffer 接口一致。"""
+
+    def __init__(self, max_hold: float = 0.0002, capacity: int = 65536):
+        self.max_hold = max(0.0, float(max_hold))
+        self.capacity = max(1, int(capacity))
+        # 合约 -> 按 (键, 到达序号) 有序的 [(键, 到达序号, dict)]
+        self._held: Dict[Any, List[Tuple[Tuple, int, Dict]]] = {}
+        self._watermark: Dict[Any, Tuple] = {}
+        # 登记项 (截止时间, 合约, 键)，到达时间单调，因此按截止时间有序
+        self._pending: Deque[Tuple[float, Any, Tuple]] = deque()
+        self._seq = itertools.count()
+        self._count = 0
+        self._stats = {"pushed": 0, "released": 0, "reordered": 0, "late": 0, "forced": 0, "bypassed": 0}
+
+    @staticmethod
+    def _key_of(data: Dict) -> Optional[Tuple[Any, Tuple]]:
+        inst = data.get("instrument_id")
+        if inst is None:
+            inst = data.get("symbol")
+        dt = data.get("datetime")
+        if inst is None or not isinstance(dt, datetime):
+            return None
+        return inst, (dt, data.get("volume") or 0)
+
+    def _expire_front(self, out: List[Dict]) -> None:
+        _, inst, key = self._pending.popleft()
+        held = self._held.get(inst)
+        if not held:
+            return
+        n = 0
+        while n < len(held) and held[n][0] <= key:
+            n += 1
+        if not n:
+            return
+        self._watermark[inst] = held[n - 1][0]
+        out.extend(item for _, _, item in held[:n])
+        del held[:n]
+        self._count -= n
+        self._stats["released"] += n
+
+    def push(self, data_list: List[Dict], now: Optional[float] = None) -> List[Dict]:
+        """暂存一批标准化行情，返回截至 now 应放行的行情（迟到的丢弃）。"""
+        now = time.monotonic() if now is None else now
+        out: List[Dict] = []
+        stats = self._stats
+        for data in data_list:
+            entry = self._key_of(data) if isinstance(data, dict) else None
+            if entry is None:
+                stats["bypassed"] += 1
+                out.append(data)
+                continue
+            inst, key = entry
+            mark = self._watermark.get(inst)
+            if mark is not None and key < mark:
+                stats["late"] += 1
+                continue
+            while self._count >= self.capacity or len(self._pending) >= self.capacity:
+                stats["forced"] += 1
+                self._expire_front(out)
+            held = self._held.setdefault(inst, [])
+            item = (key, next(self._seq), data)
+            if held and key < held[-1][0]:
+                stats["reordered"] += 1
+                bisect.insort(held, item, key=lambda e: (e[0], e[1]))
+            else:
+                held.append(item)
+            self._count += 1
+            stats["pushed"] += 1
+            self._pending.append((now + self.max_hold, inst, key))
+        self._poll_into(now, out)
+        return out
+
+    def _poll_into(self, now: float, out: List[Dict]) -> None:
+        while self._pending and self._pending[0][0] <= now:
+            self._expire_front(out)
+
+    def poll(self, now: Optional[float] = None) -> List[Dict]:
+        """放行停留已到 max_hold 的行情。"""
+        out: List[Dict] = []
+        self._poll_into(time.monotonic() if now is None else now, out)
+        return out
+
+    def flush(self) -> List[Dict]:
+        """按序放行全部暂存行情（停止时调用）。"""
+        out: List[Dict] = []
+        while self._pending:
+            self._expire_front(out)
+        return out
+
+    def next_deadline(self) -> Optional[float]:
+        """最早一条登记项的截止时间（无暂存时为 None）。"""
+        return self._pending[0][0] if self._count else None
+
+    @property
+    def held(self) -> int:
+        return self._count
+
+    def metrics(self) -> Dict[str, int]:
+        return dict(self._stats, held=self._count)
+
+
+def create_reorder_buffer(reorder_config: Optional[Dict[str, Any]] = None, native: bool = True):
+    """按 collect.reorder 配置创建重排缓冲（native 优先）。
+
+    Args:
+        reorder_config: 配置段，未给出的参数取 DEFAULT_REORDER_CONFIG。
+        native: native_pybind 可用时是否使用原生实现。
+    """
+    cfg = dict(DEFAULT_REORDER_CONFIG)
+    for key in DEFAULT_REORDER_CONFIG:
+        if reorder_config and reorder_config.get(key) is not None:
+            cfg[key] = reorder_config[key]
+    cfg["max_hold"] = float(cfg["max_hold"])
+    cfg["capacity"] = int(cfg["capacity"])
+    m = get_native_pybind()
+    if native and m is not None and hasattr(m, "ReorderBuffer"):
+        return m.ReorderBuffer(**cfg)
+    return ReorderBuffer(**cfg)
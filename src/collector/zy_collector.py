@@ -5,6 +5,7 @@
 import queue
 from typing import List, Dict
 from src.collector.base_collector import BaseFuturesCollector
+from src.collector.readiness import SUBSCRIBED, SourceReadiness
 from src.api.zy_zmq_api import ZYZmqApi
 from src.processor.data_parser import DataParser
 from src.utils import futures_logger
@@ -16,18 +17,23 @@ class ZYZmqCollector(BaseFuturesCollector):
     def __init__(self, market_sources: Dict):
         super().__init__(market_sources)
         zy_config = market_sources.get("zhengyi_zmq", {})
+        self.readiness = SourceReadiness("zhengyi_zmq")
         self.api = ZYZmqApi(
             dce_address=zy_config.get("dce_address", ""),
             czce_address=zy_config.get("czce_address", ""),
             poll_timeout_ms=int(zy_config.get("poll_timeout_ms", 100)),
             receive_sleep_interval=float(zy_config.get("receive_sleep_interval", 0.01)),
             error_retry_interval=float(zy_config.get("error_retry_interval", 1.0)),
+            wait_strategy=zy_config.get("wait_strategy"),
         )
         self.data_queue = queue.Queue()
 
     def init_connections(self) -> bool:
-        """初始化 ZMQ 连接"""
-        return self.api.connect()
+        """初始化 ZMQ 连接（SUB 全量订阅随连接建立，无单独回报）"""
+        ok = self.api.connect()
+        if ok:
+            self.readiness.mark(SUBSCRIBED)
+        return ok
 
     def subscribe_market(self) -> bool:
         """订阅行情"""
@@ -23,9 +23,14 @@ import yaml
 import asyncio
 import argparse
 import signal
-from src.utils import futures_logger, MarketSourceError, DataCleanError, StorageError
+from src.utils import futures_logger, MarketSourceError, DataCleanError, StorageError, ConfigError, FuturesBaseError
+from src.utils.native_loader import configure_native
+from src.utils.profiler import install_profiler
 from src.collector.async_collector import AsyncFuturesCollector
+from src.collector.hot_standby import HotStandby
 from src.processor.data_cleaner import DataCleaner
+from src.processor.pipeline import Pipeline
+from src.processor.sharded_processor import create_sharded_processor
 from src.storage.file_storage import FileStorage
 
 CONFIG_FILE = Path(__file__).parent / "config" / "main_config.yaml"
@@ -66,28 +71,41 @@ async def process_data_callback(data_list, cleaner, storage):
         data_list: 标准化行情列表。
         cleaner: DataCleaner 实例。
         storage: FileStorage 实例。
+
+    Returns:
+        已写入存储的行情列表（清洗或写入失败时为空）。
     """
     try:
         cleaned_data = cleaner.clean(data_list)
         if cleaned_data:
             futures_logger.debug(f"处理 {len(cleaned_data)} 条清洗后的数据")
             storage.save(cleaned_data)
+        return cleaned_data
     except DataCleanError as e:
         futures_logger.warning(f"数据清洗异常，跳过本批: {e}")
     except StorageError as e:
         futures_logger.error(f"存储写入失败: {e}", exc_info=True)
     except Exception as e:
         futures_logger.error(f"数据处理回调异常: {e}", exc_info=True)
+    return []
 
-async def main_async(config_file: Path = None) -> None:
+async def main_async(config_file: Path = None, profile_seconds: float = None, standby: bool = False) -> None:
     """异步主循环：加载配置、初始化采集/清洗/存储并进入分发循环。
 
     Args:
         config_file: 配置文件路径，用于集成测试时指定不同配置；默认使用 main_config.yaml。
+        profile_seconds: 可选，启动后立即采样分析的时长（秒）。
+        standby: 以热备进程启动（覆盖 ha.role，需 ha.enable）。
     """
     global _collector_instance
     
     config = load_config(config_file)
+    # 原生组件须在解析器/采集器首次使用符号表前完成配置
+    configure_native(config.get("native"))
+    # 采样分析：注册信号触发（kill -USR2 <pid> 开始/结束），结果写到 profiler.output_dir
+    profiler = install_profiler(config.get("profiler"), asyncio.get_running_loop())
+    if profiler is not None and profile_seconds:
+        profiler.start(profile_seconds)
     
     market_sources = config["market_sources"]
     
@@ -102,15 +120,61 @@ async def main_async(config_file: Path = None) -> None:
     cleaner = DataCleaner(processor_config.get("clean", {}))
     storage_config = config.get("storage", {}).get("file", {})
     storage = FileStorage(base_path=storage_config.get("base_path", "data/market_data"))
+    # 主备热备（ha.enable）：仅支持事件循环内串行 清洗→存储，落盘位置经共享内存镜像给备进程
+    try:
+        ha = HotStandby.from_config(config.get("ha"), "standby" if standby else None)
+        serial = not config.get("pipeline", {}).get("enable") and int(processor_config.get("workers", 0) or 0) <= 0
+        if ha is not None and not serial:
+            raise ConfigError("ha 热备不能与 pipeline 或 processor.workers 同时启用")
+        if ha is not None:
+            ha.start()
+            # 登记为 leader 后立即开始心跳（独立线程），不等行情源拉起完成
+            ha.start_heartbeat()
+    except (ConfigError, StorageError) as e:
+        futures_logger.critical(f"热备初始化失败: {e}")
+        raise SystemExit(1)
+    # pipeline.enable 时按配置的 DAG 处理；否则 processor.workers > 0 时按合约分片到工作线程
+    # 并行 清洗 → 存储（单合约保持顺序）；两者都未启用时在事件循环内串行处理
+    pipeline = Pipeline.from_config(config).start() if config.get("pipeline", {}).get("enable") else None
+    sharded = None
+    if pipeline is None and int(processor_config.get("workers", 0) or 0) > 0:
+        sharded = create_sharded_processor(
+            processor_config, storage_config.get("base_path", "data/market_data")
+        )
     
+    # 接管时主进程尚未落盘的数据；补写失败时保留，在下一批落盘前重试
+    unsaved_gap = []
+
+    def save_gap():
+        if not unsaved_gap:
+            return
+        try:
+            storage.save(unsaved_gap)
+        except (Exception, FuturesBaseError) as e:
+            futures_logger.error(f"接管补写 {len(unsaved_gap)} 条失败，随下一批重试: {e}", exc_info=True)
+            return
+        ha.on_persisted(list(unsaved_gap))
+        unsaved_gap.clear()
+
+    async def on_promote(gap):
+        # 接管：补写主进程尚未落盘的数据，journal 位置随之接续
+        unsaved_gap.extend(gap)
+        save_gap()
+
+    # 备进程的监测循环同样从启动起运行，拉起行情源期间 leader 失联也能接管
+    ha_task = asyncio.ensure_future(ha.run(on_promote)) if ha is not None else None
     try:
-        if collector.init_connections():
-            futures_logger.info("连接初始化完成，等待登录和订阅...")
-            # 等待一小段时间，让连接建立和登录完成（CTP 使用回调机制）
-            await asyncio.sleep(2)
+        # 各行情源并行拉起；连接/登录阻塞在线程池中进行，事件循环保持响应（信号处理）
+        loop = asyncio.get_running_loop()
+        if await loop.run_in_executor(None, collector.init_connections):
+            futures_logger.info("连接初始化完成，等待登录和订阅回报...")
+            # 按连接 → 登录 → 订阅回报事件等待就绪（CTP/NSQ 使用回调机制），collect.startup.timeout 为上限
+            if not await loop.run_in_executor(None, collector.wait_ready):
+                futures_logger.warning(f"部分行情源未就绪，继续运行: {collector.startup_metrics()['sources']}")
             
             # 再次尝试订阅（如果自动订阅失败）
             collector.subscribe_market()
+            futures_logger.info(f"启动时间线: {collector.startup_metrics()}")
             
             futures_logger.info("系统初始化完成，进入主运行循环...")
             futures_logger.info("按 Ctrl+C 退出程序")
@@ -120,13 +184,35 @@ async def main_async(config_file: Path = None) -> None:
             async def data_callback(data_list):
                 try:
                     futures_logger.debug(f"数据回调被调用，收到 {len(data_list)} 条数据")
-                    await process_data_callback(data_list, cleaner, storage)
+                    if pipeline is not None:
+                        pipeline.submit(data_list)
+                    elif sharded is not None:
+                        sharded.submit(data_list)
+                    elif ha is not None and not ha.is_leader:
+                        # 备进程照常清洗（去重窗口与主进程一致），只保留不落盘
+                        try:
+                            ha.on_standby_data(cleaner.clean(data_list))
+                        except DataCleanError as e:
+                            futures_logger.warning(f"数据清洗异常，跳过本批: {e}")
+                    else:
+                        save_gap()
+                        stored = await process_data_callback(data_list, cleaner, storage)
+                        if ha is not None:
+                            ha.on_persisted(stored)
                 except Exception as e:
                     futures_logger.error(f"数据回调处理异常: {e}", exc_info=True)
             
+            async def batch_callback(batch):
+                # 批次在下一轮分发前有效；下游（清洗/分片/流水线）按 dict 处理，每批只物化一次
+                await data_callback(batch.to_dicts())
+
             # 启动主循环，这会启动 dispatch_loop 来定期从队列中取数据
+            # 行情源全部为批次模式（如 GFEX tick_batch_capacity > 0）时按 TickBatch 分发，帧在接收线程解码
             futures_logger.info("正在启动数据采集和分发循环...")
-            await collector.run_forever(data_callback)
+            if collector.batch_dispatch:
+                await collector.run_forever(None, batch_callback)
+            else:
+                await collector.run_forever(data_callback)
             futures_logger.info("数据采集和分发循环已退出")
         else:
             futures_logger.error("系统初始化失败，请检查配置和网络连接")
@@ -135,7 +221,15 @@ async def main_async(config_file: Path = None) -> None:
     except Exception as e:
         futures_logger.error(f"运行异常：{e}", exc_info=True)
     finally:
+        if ha_task is not None:
+            ha_task.cancel()
         collector.close_connections()
+        if pipeline is not None:
+            pipeline.close()
+        if sharded is not None:
+            sharded.close()
+        if ha is not None:
+            ha.close()
         futures_logger.info("程序已退出，资源已释放")
 
 def signal_handler(sig, frame) -> None:
@@ -160,11 +254,24 @@ if __name__ == "__main__":
         help='配置文件路径（默认: src/config/main_config.yaml）'
     )
     
+    parser.add_argument(
+        '--profile',
+        type=float,
+        metavar='SECONDS',
+        help='启动后立即对登记的行情/处理线程采样分析指定秒数，输出 folded-stack 文件'
+    )
+    
+    parser.add_argument(
+        '--standby',
+        action='store_true',
+        help='以热备进程启动（需 ha.enable）：镜像主进程状态，主进程失联时接管'
+    )
+    
     args = parser.parse_args()
     config_file = Path(args.config) if args.config else None
     
     try:
-        asyncio.run(main_async(config_file))
+        asyncio.run(main_async(config_file, args.profile, args.standby))
     except KeyboardInterrupt:
         pass
     except SystemExit:
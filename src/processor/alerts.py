@@ -0,0 +1,606 @@
+# -*- coding: utf-8 -*-
+"""行情告警规则模块
+
+“价差大于 3 跳持续 5 秒”“10 秒内涨跌 1%”这类监控规则此前散落在各处对 DataParser 输出 dict 的 Python 循环里。
+本模块提供一个小型表达式语言，在配置加载时把全部规则编译为一段扁平栈式字节码，由流水线 alerts 阶段逐条行情求值：
+
+    spread > 3 * tick for 5s
+    abs(pct(last_price, 10s)) >= 1%
+    imbalance > 0.8 and bid_volume_1 > 200
+
+- 字段见 FIELDS（别名 last/bid/ask/mid），含派生的 mid_price、spread、imbalance、volume_delta、time_of_day（秒）
+- 运算：+ - * /、比较（< <= > >= == !=）、and/or/not；NaN 参与比较为假，条件以“非 0 且非 NaN”为真
+- 函数：abs(x)、min(a, b)、max(a, b)、ago(字段, 时长)（时长之前的 as-of 值）、
+  delta(字段, 时长) = 字段 - ago、pct(字段, 时长) = 字段 / ago - 1
+- 字面量：数字，可带时长单位（us/ms/s/m/h，值为秒）或 %（值除以 100）；规则的 vars 定义命名常量（如 tick: 1.0）
+- 末尾 for <时长> 要求条件连续成立该时长（按行情时间）后才触发，条件转假后重新计时；cooldown（秒）限制两次触发的间隔
+
+规则配置（alerts 阶段的 rules 列表）：name、when（条件）、可选 value（事件取值表达式）、for（也可写在 when 末尾）、
+cooldown、vars、symbols（只作用于这些合约，默认全部）。常量子表达式在编译期折叠。
+
+native_pybind 可用时使用 fq::AlertEngine 执行字节码，否则使用等价的纯 Python 解释器；
+两者输出的告警事件 dict 键与取值一致。
+"""
+import math
+import re
+from bisect import bisect_right
+from collections import deque
+from typing import Any, Deque, Dict, List, NamedTuple, Optional, Tuple
+
+from src.backtest.fill_simulator import sim_time
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+
+# 字段顺序与 fq::AlertField 一致
+FIELDS = (
+    "last_price", "volume", "turnover", "open_interest", "bid_price_1", "bid_volume_1", "ask_price_1",
+    "ask_volume_1", "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+    "mid_price", "spread", "imbalance", "volume_delta", "time_of_day",
+)
+FIELD_INDEX = {name: i for i, name in enumerate(FIELDS)}
+FIELD_ALIASES = {"last": "last_price", "bid": "bid_price_1", "ask": "ask_price_1", "mid": "mid_price"}
+
+# 操作码与 fq::AlertOp 一致
+(OP_CONST, OP_FIELD, OP_ASOF, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_NEG, OP_ABS, OP_MIN, OP_MAX,
+ OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE, OP_AND, OP_OR, OP_NOT) = range(20)
+
+MAX_STACK = 64
+
+_BINARY_OPS = {
+    "+": OP_ADD, "-": OP_SUB, "*": OP_MUL, "/": OP_DIV, "min": OP_MIN, "max": OP_MAX,
+    "<": OP_LT, "<=": OP_LE, ">": OP_GT, ">=": OP_GE, "==": OP_EQ, "!=": OP_NE, "and": OP_AND, "or": OP_OR,
+}
+_UNARY_OPS = {"neg": OP_NEG, "abs": OP_ABS, "not": OP_NOT}
+_KEYWORDS = ("and", "or", "not", "for")
+_UNITS = {"us": 1e-6, "ms": 1e-3, "s": 1.0, "m": 60.0, "h": 3600.0, "%": 0.01}
+
+_TOKEN_RE = re.compile(
+    r"\s*(?:(?P<num>(?:\d+\.?\d*|\.\d+)(?:[eE][+-]?\d+)?)(?P<unit>us|ms|s|m|h|%)?(?![A-Za-z0-9_])"
+    r"|(?P<name>[A-Za-z_][A-Za-z0-9_]*)|(?P<op><=|>=|==|!=|[-+*/<>(),]))"
+)
+
+
+def _truthy(v: float) -> bool:
+    return v != 0.0 and v == v
+
+
+def _div(a: float, b: float) -> float:
+    if b != 0.0:
+        return a / b
+    if a != a or a == 0.0:
+        return math.nan
+    return math.copysign(math.inf, a) * math.copysign(1.0, b)
+
+
+def _fmin(a: float, b: float) -> float:
+    if a != a:
+        return b
+    return a if b != b or a <= b else b
+
+
+def _fmax(a: float, b: float) -> float:
+    if a != a:
+        return b
+    return a if b != b or a >= b else b
+
+
+def _apply(op: int, a: float, b: float = 0.0) -> float:
+    """单条算术/逻辑指令（与 fq::AlertEngine 语义一致，编译期常量折叠共用）。"""
+    if op == OP_ADD:
+        return a + b
+    if op == OP_SUB:
+        return a - b
+    if op == OP_MUL:
+        return a * b
+    if op == OP_DIV:
+        return _div(a, b)
+    if op == OP_NEG:
+        return -a
+    if op == OP_ABS:
+        return abs(a)
+    if op == OP_MIN:
+        return _fmin(a, b)
+    if op == OP_MAX:
+        return _fmax(a, b)
+    if op == OP_LT:
+        return 1.0 if a < b else 0.0
+    if op == OP_LE:
+        return 1.0 if a <= b else 0.0
+    if op == OP_GT:
+        return 1.0 if a > b else 0.0
+    if op == OP_GE:
+        return 1.0 if a >= b else 0.0
+    if op == OP_EQ:
+        return 1.0 if a == b else 0.0
+    if op == OP_NE:
+        return 1.0 if a != b and a == a and b == b else 0.0
+    if op == OP_AND:
+        return 1.0 if _truthy(a) and _truthy(b) else 0.0
+    if op == OP_OR:
+        return 1.0 if _truthy(a) or _truthy(b) else 0.0
+    return 0.0 if _truthy(a) else 1.0  # OP_NOT
+
+
+class CompiledRules(NamedTuple):
+    """编译结果，按位置传给 AlertEngine（native 与纯 Python 构造参数一致）。"""
+    names: List[str]
+    ops: List[int]
+    args: List[int]
+    consts: List[float]
+    # 每条规则 (cond_begin, cond_end, value_begin, value_end, hold_us, cooldown_us, scope)
+    rules: List[Tuple[int, int, int, int, int, int, List[int]]]
+    # 历史槽位 (字段, horizon_us)
+    history: List[Tuple[int, int]]
+
+
+class _Parser:
+    """递归下降解析为 AST：('const', v) / ('field', i) / ('asof', 字段, horizon_us) / (op, 子节点...)"""
+
+    def __init__(self, text: str, variables: Dict[str, float]):
+        self.text = text
+        self.variables = variables
+        self.tokens: List[Tuple[str, Any]] = []
+        pos = 0
+        text = text.rstrip()
+        while pos < len(text):
+            m = _TOKEN_RE.match(text, pos)
+            if m is None or m.end() == pos:
+                raise self.error(f"无法识别的字符 {text[pos:].lstrip()[:1]!r}")
+            pos = m.end()
+            if m.group("num") is not None:
+                unit = m.group("unit")
+                self.tokens.append(("num", (float(m.group("num")) * _UNITS.get(unit, 1.0), unit)))
+            elif m.group("name") is not None:
+                self.tokens.append(("name", m.group("name")))
+            else:
+                self.tokens.append(("op", m.group("op")))
+        self.pos = 0
+
+    def error(self, msg: str) -> ConfigError:
+        return ConfigError(f"告警表达式 {self.text!r}: {msg}")
+
+    def peek(self, kind: str, value: Any = None) -> bool:
+        if self.pos >= len(self.tokens):
+            return False
+        k, v = self.tokens[self.pos]
+        return k == kind and (value is None or v == value)
+
+    def expect(self, kind: str, value: Any = None) -> Any:
+        if not self.peek(kind, value):
+            got = self.tokens[self.pos][1] if self.pos < len(self.tokens) else "结尾"
+            raise self.error(f"期望 {value or kind}，得到 {got!r}")
+        self.pos += 1
+        return self.tokens[self.pos - 1][1]
+
+    def parse_rule(self) -> Tuple[tuple, Optional[float]]:
+        """expr [for 时长]，返回 (AST, 持续秒数或 None)。"""
+        node = self.parse_or()
+        hold = None
+        if self.peek("name", "for"):
+            self.pos += 1
+            hold = self.duration()
+        if self.pos != len(self.tokens):
+            raise self.error(f"多余的 {self.tokens[self.pos][1]!r}")
+        return node, hold
+
+    def parse_expr(self) -> tuple:
+        node = self.parse_or()
+        if self.pos != len(self.tokens):
+            raise self.error(f"多余的 {self.tokens[self.pos][1]!r}")
+        return node
+
+    def duration(self) -> float:
+        value, unit = self.expect("num")
+        if unit == "%" or value < 0:
+            raise self.error("时长应为非负数，可带 us/ms/s/m/h 单位")
+        return value
+
+    def parse_or(self) -> tuple:
+        node = self.parse_and()
+        while self.peek("name", "or"):
+            self.pos += 1
+            node = ("or", node, self.parse_and())
+        return node
+
+    def parse_and(self) -> tuple:
+        node = self.parse_not()
+        while self.peek("name", "and"):
+            self.pos += 1
+            node = ("and", node, self.parse_not())
+        return node
+
+    def parse_not(self) -> tuple:
+        if self.peek("name", "not"):
+            self.pos += 1
+            return ("not", self.parse_not())
+        return self.parse_cmp()
+
+    def parse_cmp(self) -> tuple:
+        node = self.parse_sum()
+        for op in ("<=", ">=", "==", "!=", "<", ">"):
+            if self.peek("op", op):
+                self.pos += 1
+                return (op, node, self.parse_sum())
+        return node
+
+    def parse_sum(self) -> tuple:
+        node = self.parse_prod()
+        while self.peek("op", "+") or self.peek("op", "-"):
+            op = self.expect("op")
+            node = (op, node, self.parse_prod())
+        return node
+
+    def parse_prod(self) -> tuple:
+        node = self.parse_unary()
+        while self.peek("op", "*") or self.peek("op", "/"):
+            op = self.expect("op")
+            node = (op, node, self.parse_unary())
+        return node
+
+    def parse_unary(self) -> tuple:
+        if self.peek("op", "-"):
+            self.pos += 1
+            return ("neg", self.parse_unary())
+        if self.peek("op", "+"):
+            self.pos += 1
+            return self.parse_unary()
+        return self.parse_atom()
+
+    def parse_atom(self) -> tuple:
+        if self.peek("num"):
+            return ("const", self.expect("num")[0])
+        if self.peek("op", "("):
+            self.pos += 1
+            node = self.parse_or()
+            self.expect("op", ")")
+            return node
+        name = self.expect("name")
+        if name in _KEYWORDS:
+            raise self.error(f"关键字 {name} 不能出现在此处（作为操作数时需加括号）")
+        if self.peek("op", "("):
+            return self.call(name)
+        if name in self.variables:
+            return ("const", float(self.variables[name]))
+        return ("field", self.field(name))
+
+    def field(self, name: str) -> int:
+        name = FIELD_ALIASES.get(name, name)
+        if name not in FIELD_INDEX:
+            raise self.error(f"未知的字段或变量 {name!r}（字段见 FIELDS）")
+        return FIELD_INDEX[name]
+
+    def call(self, name: str) -> tuple:
+        self.expect("op", "(")
+        if name in ("ago", "delta", "pct"):
+            field = self.field(self.expect("name"))
+            self.expect("op", ",")
+            horizon_us = int(round(self.duration() * 1e6))
+            self.expect("op", ")")
+            if horizon_us <= 0:
+                raise self.error(f"{name}() 的时长须大于 0")
+            asof = ("asof", field, horizon_us)
+            if name == "ago":
+                return asof
+            if name == "delta":
+                return ("-", ("field", field), asof)
+            return ("-", ("/", ("field", field), asof), ("const", 1.0))
+        args = [self.parse_or()]
+        while self.peek("op", ","):
+            self.pos += 1
+            args.append(self.parse_or())
+        self.expect("op", ")")
+        if name == "abs" and len(args) == 1:
+            return ("abs", args[0])
+        if name in ("min", "max") and len(args) >= 2:
+            node = args[0]
+            for a in args[1:]:
+                node = (name, node, a)
+            return node
+        raise self.error(f"未知的函数或参数个数不符: {name}()")
+
+
+class _Emitter:
+    """AST -> 字节码（常量折叠、常量与历史槽位去重、栈深检查）。"""
+
+    def __init__(self):
+        self.ops: List[int] = []
+        self.args: List[int] = []
+        self.consts: List[float] = []
+        self.history: List[Tuple[int, int]] = []
+        self._const_index: Dict[Any, int] = {}
+        self._slot_index: Dict[Tuple[int, int], int] = {}
+
+    @staticmethod
+    def fold(node: tuple) -> tuple:
+        kind = node[0]
+        if kind in ("const", "field", "asof"):
+            return node
+        children = [_Emitter.fold(c) for c in node[1:]]
+        if all(c[0] == "const" for c in children):
+            op = _UNARY_OPS.get(kind, _BINARY_OPS.get(kind))
+            return ("const", _apply(op, *(c[1] for c in children)))
+        return (kind, *children)
+
+    def emit(self, node: tuple, text: str) -> Tuple[int, int]:
+        begin = len(self.ops)
+        depth = self._emit(self.fold(node))
+        if depth > MAX_STACK:
+            raise ConfigError(f"告警表达式 {text!r} 嵌套过深（栈深 {depth} > {MAX_STACK}）")
+        return begin, len(self.ops)
+
+    def _emit(self, node: tuple) -> int:
+        """生成 node 的代码，返回所需栈深。"""
+        kind = node[0]
+        if kind == "const":
+            key = (node[1], math.copysign(1.0, node[1])) if node[1] == node[1] else "nan"
+            if key not in self._const_index:
+                self._const_index[key] = len(self.consts)
+                self.consts.append(float(node[1]))
+            self._op(OP_CONST, self._const_index[key])
+            return 1
+        if kind == "field":
+            self._op(OP_FIELD, node[1])
+            return 1
+        if kind == "asof":
+            key = (node[1], node[2])
+            if key not in self._slot_index:
+                self._slot_index[key] = len(self.history)
+                self.history.append(key)
+            self._op(OP_ASOF, self._slot_index[key])
+            return 1
+        if kind in _UNARY_OPS:
+            depth = self._emit(node[1])
+            self._op(_UNARY_OPS[kind])
+            return depth
+        left = self._emit(node[1])
+        right = self._emit(node[2])
+        self._op(_BINARY_OPS[kind])
+        return max(left, right + 1)
+
+    def _op(self, op: int, arg: int = 0) -> None:
+        self.ops.append(op)
+        self.args.append(arg)
+
+
+def compile_rules(rules: List[Dict[str, Any]], symbol_table=None) -> CompiledRules:
+    """把规则配置编译为一段共享字节码。
+
+    Args:
+        rules: 规则配置列表（name、when，可选 value、for、cooldown、vars、symbols）。
+        symbol_table: symbols 登记所用符号表，默认全局符号表。
+
+    Raises:
+        ConfigError: 规则为空、名称重复或表达式无效时抛出。
+    """
+    if not rules:
+        raise ConfigError("alerts 阶段需要至少一条规则（rules）")
+    if symbol_table is None:
+        from src.processor.symbol_table import get_symbol_table
+        symbol_table = get_symbol_table()
+    emitter = _Emitter()
+    names: List[str] = []
+    compiled = []
+    for i, rule in enumerate(rules):
+        name = str(rule.get("name") or f"rule{i}")
+        if name in names:
+            raise ConfigError(f"告警规则名重复: {name!r}")
+        when = rule.get("when")
+        if not when or not isinstance(when, str):
+            raise ConfigError(f"告警规则 {name} 缺少 when 条件表达式")
+        variables = dict(rule.get("vars") or {})
+        for var in variables:
+            if FIELD_ALIASES.get(var, var) in FIELD_INDEX:
+                raise ConfigError(f"告警规则 {name} 的变量 {var!r} 与字段同名")
+        node, hold = _Parser(when, variables).parse_rule()
+        if hold is None:
+            hold = float(rule.get("for", 0.0))
+        cond = emitter.emit(node, when)
+        value = (cond[1], cond[1])
+        if rule.get("value"):
+            value = emitter.emit(_Parser(str(rule["value"]), variables).parse_expr(), str(rule["value"]))
+        scope = sorted({symbol_table.intern(s) for s in rule.get("symbols") or []})
+        compiled.append((
+            cond[0], cond[1], value[0], value[1],
+            int(round(max(0.0, hold) * 1e6)), int(round(max(0.0, float(rule.get("cooldown", 0.0))) * 1e6)),
+            scope,
+        ))
+        names.append(name)
+    return CompiledRules(names, emitter.ops, emitter.args, emitter.consts, compiled, emitter.history)
+
+
+def _next_pow2(n: int) -> int:
+    p = 1
+    while p < n:
+        p <<= 1
+    return p
+
+
+class _State:
+    __slots__ = ("seen", "volume", "hist_t", "hist_v")
+
+    def __init__(self, history: int):
+        self.seen = False
+        self.volume = 0
+        self.hist_t: Deque[int] = deque(maxlen=history)
+        self.hist_v: Deque[List[float]] = deque(maxlen=history)
+
+
+class AlertEngine:
+    """纯 Python 字节码解释器（与 native_pybind.AlertEngine 构造参数、接口与事件一致）。"""
+
+    def __init__(self, names, ops, args, consts, rules, history, instruments: int = 1024, history_size: int = 256):
+        self.names = list(names)
+        self._ops = list(ops)
+        self._args = list(args)
+        self._consts = list(consts)
+        self._rules = [tuple(r) for r in rules]
+        self._slots = [tuple(s) for s in history]
+        self.instruments = max(1, int(instruments))
+        self._history = _next_pow2(max(2, int(history_size)))
+        self._global: List[int] = []
+        self._by_instrument: Dict[int, List[int]] = {}
+        for r, rule in enumerate(self._rules):
+            if not rule[6]:
+                self._global.append(r)
+            for iid in rule[6]:
+                if 0 <= iid < self.instruments:
+                    self._by_instrument.setdefault(iid, []).append(r)
+        self.reset()
+
+    @property
+    def rules(self) -> int:
+        return len(self._rules)
+
+    def reset(self) -> None:
+        self._states: Dict[int, _State] = {}
+        self._since: Dict[Tuple[int, int], int] = {}
+        self._last_fire: Dict[Tuple[int, int], int] = {}
+        self.ticks = self.evaluations = self.fired = self.overflow = 0
+
+    def evaluate(self, data_list: List[Dict], start: int = 0) -> List[Dict]:
+        """对 start 起的每条行情执行相关规则，返回触发的告警事件 dict 列表。"""
+        events: List[Dict] = []
+        for data in data_list[start:]:
+            iid = data.get("instrument_id")
+            dt = data.get("datetime")
+            if not isinstance(iid, int) or not 0 <= iid < self.instruments or dt is None:
+                continue
+            st = self._states.get(iid)
+            if st is None:
+                st = self._states[iid] = _State(self._history)
+            ts = sim_time(dt)
+            fields = self._fields(data, st, dt)
+            asof = self._asof(st, ts, fields) if self._slots else []
+            st.volume = int(data.get("volume") or 0)
+            st.seen = True
+            for r in self._global + self._by_instrument.get(iid, []):
+                value = self._fire(r, iid, ts, fields, asof)
+                if value is not None:
+                    events.append(self._event(data, iid, r, value))
+            self.ticks += 1
+        return events
+
+    def _fields(self, data: Dict, st: _State, dt) -> List[float]:
+        nan = math.nan
+        f = [float(data.get(name) or 0.0) for name in FIELDS[:13]]
+        last, bid, ask = f[0], f[4], f[6]
+        bid_vol, ask_vol = f[5], f[7]
+        two_sided = bid > 0 and ask > 0
+        volume = int(data.get("volume") or 0)
+        f.append(0.5 * (bid + ask) if two_sided else last)
+        f.append(ask - bid if two_sided else nan)
+        f.append((bid_vol - ask_vol) / (bid_vol + ask_vol) if bid_vol + ask_vol > 0 else nan)
+        # 累计量回退（换日）时以当前累计量计
+        f.append(float(volume - st.volume if volume >= st.volume else volume) if st.seen else nan)
+        f.append(dt.hour * 3600 + dt.minute * 60 + dt.second + dt.microsecond * 1e-6)
+        return f
+
+    def _asof(self, st: _State, ts: int, fields: List[float]) -> List[float]:
+        st.hist_t.append(ts)
+        st.hist_v.append(fields)
+        out = []
+        for field, horizon in self._slots:
+            k = bisect_right(st.hist_t, ts - horizon)
+            out.append(st.hist_v[k - 1][field] if k > 0 else math.nan)
+        return out
+
+    def _eval(self, begin: int, end: int, fields: List[float], asof: List[float]) -> float:
+        stack: List[float] = []
+        for pc in range(begin, end):
+            op, arg = self._ops[pc], self._args[pc]
+            if op == OP_CONST:
+                stack.append(self._consts[arg])
+            elif op == OP_FIELD:
+                stack.append(fields[arg])
+            elif op == OP_ASOF:
+                stack.append(asof[arg])
+            elif op in (OP_NEG, OP_ABS, OP_NOT):
+                stack[-1] = _apply(op, stack[-1])
+            else:
+                b = stack.pop()
+                stack[-1] = _apply(op, stack[-1], b)
+        return stack[0]
+
+    def _fire(self, r: int, iid: int, ts: int, fields: List[float], asof: List[float]) -> Optional[float]:
+        cond_begin, cond_end, value_begin, value_end, hold_us, cooldown_us, _ = self._rules[r]
+        key = (r, iid)
+        self.evaluations += 1
+        if not _truthy(self._eval(cond_begin, cond_end, fields, asof)):
+            self._since.pop(key, None)
+            return None
+        since = self._since.setdefault(key, ts)
+        last = self._last_fire.get(key)
+        # 本轮已触发，或尚未满 hold / cooldown
+        if last is not None and (last >= since or ts - last < cooldown_us):
+            return None
+        if ts - since < hold_us:
+            return None
+        self._last_fire[key] = ts
+        self.fired += 1
+        return self._eval(value_begin, value_end, fields, asof) if value_begin != value_end else math.nan
+
+    def _event(self, data: Dict, iid: int, r: int, value: float) -> Dict:
+        # 键顺序与 native_pybind.AlertEngine 一致
+        return {
+            "symbol": data.get("symbol"),
+            "instrument_id": iid,
+            "exchange": data.get("exchange"),
+            "datetime": data.get("datetime"),
+            "event": "alert",
+            "rule": self.names[r],
+            "value": value,
+            "last_price": float(data.get("last_price") or 0.0),
+            "bid_price_1": float(data.get("bid_price_1") or 0.0),
+            "ask_price_1": float(data.get("ask_price_1") or 0.0),
+        }
+
+
+class AlertStage:
+    """流水线阶段：对行情求值告警规则，输出告警事件 dict。"""
+
+    def __init__(self, engine, log: bool = True):
+        self.engine = engine
+        self.log = log
+
+    def __call__(self, data_list: List[Dict]) -> List[Dict]:
+        events = self.engine.evaluate(data_list)
+        if self.log:
+            for e in events:
+                futures_logger.warning(
+                    f"告警 {e['rule']}: {e['symbol']} {e['datetime']} value={e['value']} last={e['last_price']}"
+                )
+        return events
+
+    def close(self) -> None:
+        futures_logger.info(
+            f"告警阶段: {self.engine.ticks} 条行情，{self.engine.evaluations} 次规则求值，触发 {self.engine.fired} 次"
+        )
+
+
+def create_alert_engine(cfg: Optional[Dict[str, Any]] = None):
+    """按配置编译规则并创建告警引擎（native 优先）。
+
+    Args:
+        cfg: rules（规则列表），可选 instruments、history（每合约保留的行情条数，需覆盖最长的 ago/delta/pct 时长）
+            与 native（默认 True）。
+
+    Raises:
+        ConfigError: 规则无效时抛出。
+    """
+    cfg = cfg or {}
+    program = compile_rules(list(cfg.get("rules") or []))
+    instruments = int(cfg.get("instruments", 1024))
+    history = int(cfg.get("history", 256))
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "AlertEngine"):
+        try:
+            engine = m.AlertEngine(*program, instruments=instruments, history_size=history)
+        except ValueError as e:
+            raise ConfigError(str(e)) from e
+    else:
+        engine = AlertEngine(*program, instruments=instruments, history_size=history)
+    futures_logger.info(
+        f"告警引擎: {len(program.names)} 条规则，{len(program.ops)} 条指令，{len(program.history)} 个历史槽位"
+    )
+    return engine
@@ -0,0 +1,308 @@
+# -*- coding: utf-8 -*-
+"""跨合约指数加权协方差 / 相关系数模块
+
+风控与配对策略需要数百个合约的实时相关矩阵；每分钟用 pandas 重算既慢又滞后。本模块在流水线中增量维护：
+- 与横截面矩阵相同的固定时间网格：中间价最新值表以 instrument_id 为下标（双边有报价取中间价，否则最新价）
+- 行情时间越过网格点时，以各合约相邻网格点中间价的对数收益做一次指数加权秩 1 更新
+  （d = r - mean；mean += alpha·d；cov = (1 - alpha)·(cov + alpha·d·dᵀ)，alpha 由半衰期换算）
+- 尚无两个有效中间价的合约收益记 0、不计观测数；观测数不足 min_periods 的合约读出为 NaN
+- 相邻行情间隔超过 max_gap（午休、收盘）时只更新一次，跨空档的收益不计入
+- cov(i, j) / corr(i, j) 为 O(1) 读取；snapshot() 返回稠密矩阵
+- instrument_id 不小于 instruments 的行情不进入矩阵（仍推进网格），条数计入 dropped；
+  流水线阶段发现新增丢弃时告警，快照元数据中记录累计丢弃数
+
+流水线 covariance 阶段每 snapshot_every 次网格更新取一次全矩阵快照（stage.latest），
+配置 output_dir 时同时持久化为 <output_dir>/<prefix>_<网格时间>.npy 与 .json（合约代码，下标即行列）。
+
+native_pybind 可用时使用 fq::EwmCovariance（分块上三角 + SIMD 秩 1 更新），否则使用等价的 numpy 实现。
+"""
+import json
+import math
+import os
+from datetime import datetime
+from typing import Any, Dict, List, Optional
+
+import numpy as np
+
+from src.backtest.fill_simulator import sim_time
+from src.processor.cross_section import sim_times_to_datetime64
+from src.utils import futures_logger
+from src.utils.exceptions import StorageError
+from src.utils.native_loader import get_native_pybind
+
+
+def ewm_alpha_from_halflife(halflife_steps: float) -> float:
+    """半衰期（网格步数）对应的衰减系数 alpha = 1 - 2^(-1/halflife)。"""
+    if not halflife_steps > 0:
+        return 1.0
+    return 1.0 - math.exp(-math.log(2.0) / halflife_steps)
+
+
+class EwmCovariance:
+    """固定时间网格上的指数加权协方差矩阵（与 fq::EwmCovariance 一致）。"""
+
+    def __init__(self, instruments: int = 512, interval: float = 1.0, halflife: float = 300.0,
+                 max_gap: float = 60.0, min_periods: int = 2):
+        """初始化。
+
+        Args:
+            instruments: 合约数（instrument_id 上限）。
+            interval: 网格间隔（秒）。
+            halflife: 半衰期（秒）。
+            max_gap: 超过该间隔（秒）的行情空档只更新一次。
+            min_periods: 两合约观测数均不少于该值时才返回数值。
+        """
+        self.instruments = max(1, int(instruments))
+        self.interval_us = max(1, int(round(interval * 1e6)))
+        self.max_gap_us = int(round(max_gap * 1e6)) if max_gap > 0 else self.interval_us
+        alpha = ewm_alpha_from_halflife(halflife / interval if interval > 0 else halflife)
+        self.alpha = alpha if 0 < alpha <= 1 else 1.0
+        self.min_periods = int(min_periods)
+        n = self.instruments
+        self._cov = np.empty((n, n))
+        self._mid = np.empty(n)
+        self._base = np.empty(n)
+        self._mean = np.empty(n)
+        self._nobs = np.empty(n, dtype=np.int64)
+        self.reset()
+
+    def update(self, data_list: List[Dict], start: int = 0) -> int:
+        """从 start 起处理一批标准化行情，返回完成的网格更新次数。"""
+        steps = 0
+        for i in range(start, len(data_list)):
+            data = data_list[i]
+            iid = data.get("instrument_id")
+            dt = data.get("datetime")
+            if not isinstance(iid, int) or iid < 0 or dt is None:
+                continue
+            steps += self._advance_to(sim_time(dt))
+            if iid >= self.instruments:
+                self.dropped += 1
+                continue
+            last = float(data.get("last_price") or 0.0)
+            bid = float(data.get("bid_price_1") or 0.0)
+            ask = float(data.get("ask_price_1") or 0.0)
+            self._mid[iid] = 0.5 * (bid + ask) if bid > 0 and ask > 0 else last
+        return steps
+
+    def _advance_to(self, ts: int) -> int:
+        if self._next_grid is None:
+            self._next_grid = self._align_up(ts)
+            return 0
+        steps = 0
+        while self._next_grid < ts:
+            self._step(self._next_grid)
+            steps += 1
+            self._next_grid += self.interval_us
+            if ts - self._next_grid > self.max_gap_us:
+                self._next_grid = self._align_up(ts)
+                self._rebase = True
+        return steps
+
+    def _align_up(self, ts: int) -> int:
+        return -(-ts // self.interval_us) * self.interval_us
+
+    def _step(self, grid: int) -> None:
+        self.last_grid = grid
+        rebase, self._rebase = self._rebase, False
+        mid, base = self._mid, self._base
+        with np.errstate(invalid="ignore", divide="ignore"):
+            valid = (mid > 0) & (base > 0)
+            if rebase:
+                valid[:] = False
+            d = np.zeros(self.instruments)
+            d[valid] = np.log(mid[valid] / base[valid]) - self._mean[valid]
+        self._mean += self.alpha * d
+        self._nobs += valid
+        has_mid = mid > 0
+        base[has_mid] = mid[has_mid]
+        if rebase:
+            return
+        self.steps += 1
+        a = self.alpha
+        self._cov *= 1.0 - a
+        self._cov += (a * (1.0 - a)) * np.outer(d, d)
+
+    def _ready(self, i: int, j: int) -> bool:
+        n = self.instruments
+        return 0 <= i < n and 0 <= j < n and min(self._nobs[i], self._nobs[j]) >= self.min_periods
+
+    def cov(self, i: int, j: int) -> float:
+        """协方差；越界或观测不足返回 NaN。"""
+        return float(self._cov[i, j]) if self._ready(i, j) else math.nan
+
+    def corr(self, i: int, j: int) -> float:
+        """相关系数；方差为 0 时返回 NaN。"""
+        if not self._ready(i, j):
+            return math.nan
+        vi, vj = self._cov[i, i], self._cov[j, j]
+        if not (vi > 0 and vj > 0):
+            return math.nan
+        return 1.0 if i == j else float(self._cov[i, j] / math.sqrt(vi * vj))
+
+    def snapshot(self, correlation: bool = False, n: int = 0) -> np.ndarray:
+        """前 n 个合约（0 为全部）的稠密协方差 / 相关系数矩阵（副本），观测不足的行列为 NaN。"""
+        if n <= 0 or n > self.instruments:
+            n = self.instruments
+        out = self._cov[:n, :n].copy()
+        if correlation:
+            sd = np.sqrt(np.diag(out))
+            with np.errstate(invalid="ignore", divide="ignore"):
+                sd[~(sd > 0)] = np.nan
+                out /= np.outer(sd, sd)
+            np.fill_diagonal(out, np.where(np.isnan(sd), np.nan, 1.0))
+        bad = self._nobs[:n] < self.min_periods
+        out[bad, :] = np.nan
+        out[:, bad] = np.nan
+        return out
+
+    def mids(self) -> np.ndarray:
+        """当前中间价最新值（合约个）视图。"""
+        return self._mid
+
+    def mean(self, i: int) -> float:
+        return float(self._mean[i]) if 0 <= i < self.instruments else math.nan
+
+    def nobs(self, i: int) -> int:
+        return int(self._nobs[i]) if 0 <= i < self.instruments else 0
+
+    def reset(self) -> None:
+        """清空全部状态。"""
+        self._cov.fill(0.0)
+        self._mid.fill(np.nan)
+        self._base.fill(np.nan)
+        self._mean.fill(0.0)
+        self._nobs.fill(0)
+        self._next_grid: Optional[int] = None
+        self._rebase = False
+        self.last_grid: Optional[int] = None
+        self.steps = 0
+        self.dropped = 0
+
+
+class CovarianceStage:
+    """流水线阶段：更新协方差矩阵，定期取全矩阵快照并可选落盘。"""
+
+    def __init__(self, engine, snapshot_every: int = 60, correlation: bool = True,
+                 output_dir: Optional[str] = None, prefix: str = "covariance"):
+        """初始化。
+
+        Args:
+            engine: EwmCovariance（原生或 numpy 实现）。
+            snapshot_every: 每多少次网格更新取一次快照，0 为仅在关闭时。
+            correlation: 快照为相关系数（否则为协方差）。
+            output_dir: 快照落盘目录，为空时只保留在内存（latest）。
+        """
+        self.engine = engine
+        self.snapshot_every = int(snapshot_every)
+        self.correlation = bool(correlation)
+        self.output_dir = output_dir
+        self.prefix = prefix
+        self.latest: Optional[Dict[str, Any]] = None
+        self.files: List[str] = []
+        self._pending = 0
+        self._dropped_reported = 0
+
+    def __call__(self, data_list: List[Dict]) -> List[Dict]:
+        self._pending += self.engine.update(data_list)
+        if not self._dropped_reported and self.engine.dropped:
+            self._report_dropped()
+        if self.snapshot_every > 0 and self._pending >= self.snapshot_every:
+            self.take_snapshot()
+        return data_list
+
+    def _report_dropped(self) -> None:
+        """首次出现时立即告警，之后随快照汇总，避免逐批刷日志。"""
+        dropped = int(self.engine.dropped)
+        futures_logger.warning(
+            f"协方差矩阵合约数 {self.engine.instruments} 不足：新增 {dropped - self._dropped_reported} 条、"
+            f"累计 {dropped} 条 instrument_id 超出上限的行情未计入，请调大 instruments"
+        )
+        self._dropped_reported = dropped
+
+    def take_snapshot(self) -> Optional[Dict[str, Any]]:
+        """取当前全矩阵快照（latest），配置了 output_dir 时落盘；尚无网格更新返回 None。"""
+        if self.engine.last_grid is None:
+            return None
+        from src.processor.symbol_table import get_symbol_table
+
+        table = get_symbol_table()
+        n = min(self.engine.instruments, len(table)) or self.engine.instruments
+        time = sim_times_to_datetime64(np.array([self.engine.last_grid]))[0]
+        self.latest = {
+            "time": time,
+            "matrix": self.engine.snapshot(self.correlation, n),
+            "symbols": [table.name(i) for i in range(min(n, len(table)))],
+            "kind": "correlation" if self.correlation else "covariance",
+            "dropped": int(self.engine.dropped),
+        }
+        self._pending = 0
+        if self.engine.dropped > self._dropped_reported:
+            self._report_dropped()
+        if self.output_dir:
+            self._persist(self.latest)
+        return self.latest
+
+    def _persist(self, snap: Dict[str, Any]) -> str:
+        stem = os.path.join(
+            self.output_dir, f"{self.prefix}_{snap['time'].astype(datetime).strftime('%Y%m%d_%H%M%S_%f')}"
+        )
+        meta = {
+            "kind": snap["kind"],
+            "symbols": snap["symbols"],
+            "time": str(snap["time"]),
+            "interval_us": int(self.engine.interval_us),
+            "alpha": float(self.engine.alpha),
+            "steps": int(self.engine.steps),
+            "dropped": snap["dropped"],
+        }
+        try:
+            os.makedirs(self.output_dir, exist_ok=True)
+            np.save(stem + ".npy", snap["matrix"])
+            with open(stem + ".json", "w", encoding="utf-8") as f:
+                json.dump(meta, f, ensure_ascii=False)
+        except OSError as e:
+            raise StorageError(f"写入协方差快照失败: {stem}: {e}") from e
+        self.files.append(stem)
+        futures_logger.debug(f"协方差快照已保存: {stem}.npy，{snap['matrix'].shape[0]} 合约")
+        return stem
+
+    def close(self) -> None:
+        """关闭时补取一次快照（自上次快照后有新的网格更新时）。"""
+        if self._pending:
+            self.take_snapshot()
+
+
+def load_covariance(stem: str) -> Dict[str, Any]:
+    """读取 CovarianceStage 落盘的快照。
+
+    Returns:
+        {"matrix": (合约, 合约) 矩阵, "kind", "symbols", "time", "interval_us", "alpha", "steps", "dropped"}
+    """
+    try:
+        with open(stem + ".json", encoding="utf-8") as f:
+            meta = json.load(f)
+        meta["matrix"] = np.load(stem + ".npy")
+    except (OSError, ValueError) as e:
+        raise StorageError(f"读取协方差快照失败: {stem}: {e}") from e
+    return meta
+
+
+def create_ewm_covariance(cfg: Optional[Dict[str, Any]] = None):
+    """按配置创建协方差引擎（native 优先）。
+
+    Args:
+        cfg: 可选 instruments、interval（秒）、halflife（秒）、max_gap（秒）、min_periods 与 native（默认 True）。
+    """
+    cfg = cfg or {}
+    args = (
+        int(cfg.get("instruments", 512)),
+        float(cfg.get("interval", 1.0)),
+        float(cfg.get("halflife", 300.0)),
+        float(cfg.get("max_gap", 60.0)),
+        int(cfg.get("min_periods", 2)),
+    )
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "EwmCovariance"):
+        return m.EwmCovariance(*args)
+    return EwmCovariance(*args)
@@ -0,0 +1,242 @@
+# -*- coding: utf-8 -*-
+"""横截面快照矩阵模块
+
+研究常需要“所有合约每 500ms 的中间价/最新价/持仓量”这类稠密矩阵；
+从逐合约的 FileStorage CSV 构建需要对数百个文件做 as-of 连接。本模块在流水线中直接生成：
+- 按字段分列的最新值表以 instrument_id 为下标，每条行情只改写本合约的槽位
+- 行情时间越过网格点时，把最新值表整列拷贝到预分配的 (时间 × 合约) 块的下一行（as-of，无数据为 NaN）
+- 相邻行情间隔超过 max_gap（午休、夜盘收盘）时只补一行，随后对齐到新时间
+- 块写满后需要新行的行情被拒收，落盘并清空后从该条继续，保证每行都是该网格点的 as-of 截面
+- 块写满或流水线关闭时持久化为 .npy（可 np.load(mmap_mode="r") 映射），直接写出块的已填部分，不另行拷贝
+- 块在创建时一次分配 字段数 × rows × instruments × 8 字节：默认 1024 合约 × 1200 行（0.5 秒网格 10 分钟）
+  约 59 MB；合约更多或块更长时按需调大
+
+持久化文件（stem 为 <output_dir>/<prefix>_<首行时间>）：
+- <stem>.npy：float64，形状 (字段, 行, 合约)，字段顺序见 FIELDS
+- <stem>_times.npy：各行网格时间，datetime64[us]
+- <stem>.json：字段名、合约代码（下标即列）与网格间隔
+
+native_pybind 可用时使用 fq::CrossSection，否则使用等价的 numpy 实现。
+"""
+import json
+import os
+from datetime import datetime
+from typing import Any, Dict, List, Optional
+
+import numpy as np
+
+from src.backtest.fill_simulator import sim_time
+from src.utils import futures_logger
+from src.utils.exceptions import StorageError
+from src.utils.native_loader import get_native_pybind
+
+# 与 fq::CrossField 顺序一致
+FIELDS = ("last_price", "mid_price", "open_interest", "volume", "bid_price_1", "ask_price_1")
+_FIELD_INDEX = {name: i for i, name in enumerate(FIELDS)}
+# 默认块大小（与原生绑定一致）：6 字段 × 1200 行 × 1024 合约 × 8 字节 ≈ 59 MB
+DEFAULT_INSTRUMENTS = 1024
+DEFAULT_ROWS = 1200
+
+
+class CrossSection:
+    """固定时间网格上的横截面矩阵（与 fq::CrossSection 一致）。"""
+
+    def __init__(self, instruments: int = DEFAULT_INSTRUMENTS, rows: int = DEFAULT_ROWS, interval: float = 0.5,
+                 max_gap: float = 60.0):
+        """初始化。
+
+        Args:
+            instruments: 合约列数（instrument_id 上限）。
+            rows: 每块行数。
+            interval: 网格间隔（秒）。
+            max_gap: 超过该间隔（秒）的行情空档只补一行。
+        """
+        self.instruments = max(1, int(instruments))
+        self.rows = max(1, int(rows))
+        self.interval_us = max(1, int(round(interval * 1e6)))
+        self.max_gap_us = int(round(max_gap * 1e6)) if max_gap > 0 else self.interval_us
+        self._values = np.empty((len(FIELDS), self.instruments))
+        self._block = np.empty((len(FIELDS), self.rows, self.instruments))
+        self._times = np.empty(self.rows, dtype=np.int64)
+        self.reset()
+
+    @property
+    def full(self) -> bool:
+        return self._filled >= self.rows
+
+    @property
+    def rows_filled(self) -> int:
+        return self._filled
+
+    def update(self, data_list: List[Dict], start: int = 0) -> int:
+        """从 start 起处理一批标准化行情。
+
+        Returns:
+            因块已满而未处理的第一条行情的下标；全部处理完时为 len(data_list)。
+        """
+        for i in range(start, len(data_list)):
+            data = data_list[i]
+            iid = data.get("instrument_id")
+            dt = data.get("datetime")
+            if not isinstance(iid, int) or iid < 0 or dt is None:
+                continue
+            ts = sim_time(dt)
+            self._advance_to(ts)
+            if self._next_grid < ts and self.full:
+                return i
+            if iid >= self.instruments:
+                continue
+            last = float(data.get("last_price") or 0.0)
+            bid = float(data.get("bid_price_1") or 0.0)
+            ask = float(data.get("ask_price_1") or 0.0)
+            v = self._values
+            v[0, iid] = last
+            v[1, iid] = 0.5 * (bid + ask) if bid > 0 and ask > 0 else last
+            v[2, iid] = float(data.get("open_interest") or 0.0)
+            v[3, iid] = float(data.get("volume") or 0)
+            v[4, iid] = bid
+            v[5, iid] = ask
+        return len(data_list)
+
+    def _advance_to(self, ts: int) -> None:
+        if self._next_grid is None:
+            self._next_grid = self._align_up(ts)
+            return
+        while self._next_grid < ts and self._filled < self.rows:
+            self._block[:, self._filled, :] = self._values
+            self._times[self._filled] = self._next_grid
+            self._filled += 1
+            self._next_grid += self.interval_us
+            if ts - self._next_grid > self.max_gap_us:
+                self._next_grid = self._align_up(ts)
+
+    def _align_up(self, ts: int) -> int:
+        return -(-ts // self.interval_us) * self.interval_us
+
+    def matrix(self, field: str) -> np.ndarray:
+        """某字段已写出部分的 (行 × 合约) 视图。"""
+        if field not in _FIELD_INDEX:
+            raise KeyError(f"unknown cross-section field: {field}")
+        return self._block[_FIELD_INDEX[field], : self._filled]
+
+    def block(self) -> np.ndarray:
+        """全部字段已写出部分的 (字段 × 行 × 合约) 视图。"""
+        return self._block[:, : self._filled]
+
+    def latest(self, field: str) -> np.ndarray:
+        """某字段的当前最新值（合约个）视图。"""
+        if field not in _FIELD_INDEX:
+            raise KeyError(f"unknown cross-section field: {field}")
+        return self._values[_FIELD_INDEX[field]]
+
+    def times(self) -> np.ndarray:
+        """各行的网格时间（sim_time：1970-01-01 起的天数 × 86400e6 + 当日微秒）。"""
+        return self._times[: self._filled]
+
+    def clear(self) -> None:
+        """清空已写出的行（最新值表与网格进度保留）。"""
+        self._filled = 0
+
+    def reset(self) -> None:
+        """清空全部状态。"""
+        self._values.fill(np.nan)
+        self._filled = 0
+        self._next_grid: Optional[int] = None
+
+
+def sim_times_to_datetime64(times: np.ndarray) -> np.ndarray:
+    """sim_time 数组 -> datetime64[us]（sim_time 即 1970-01-01 起的微秒数）。"""
+    return np.asarray(times, dtype=np.int64).astype("datetime64[us]")
+
+
+class CrossSectionWriter:
+    """流水线阶段：更新横截面矩阵，块写满或关闭时落盘。"""
+
+    def __init__(self, engine, output_dir: str, prefix: str = "cross_section"):
+        self.engine = engine
+        self.output_dir = output_dir
+        self.prefix = prefix
+        self.files: List[str] = []
+
+    def __call__(self, data_list: List[Dict]) -> List[Dict]:
+        i = self.engine.update(data_list)
+        while i < len(data_list):
+            self.persist()
+            i = self.engine.update(data_list, i)
+        if self.engine.full:
+            self.persist()
+        return data_list
+
+    def persist(self) -> Optional[str]:
+        """把已写出的行写成 .npy + 时间 + 元数据，清空块并返回 stem；无数据返回 None。"""
+        rows = self.engine.rows_filled
+        if rows == 0:
+            return None
+        from src.processor.symbol_table import get_symbol_table
+
+        times = sim_times_to_datetime64(self.engine.times())
+        stem = os.path.join(
+            self.output_dir, f"{self.prefix}_{times[0].astype(datetime).strftime('%Y%m%d_%H%M%S_%f')}"
+        )
+        block = self.engine.block()  # 视图，np.save 直接写出，不另行拷贝整块
+        table = get_symbol_table()
+        symbols = [table.name(i) for i in range(min(block.shape[2], len(table)))]
+        meta = {
+            "fields": list(FIELDS),
+            "symbols": symbols,
+            "interval_us": int(self.engine.interval_us),
+            "shape": list(block.shape),
+        }
+        try:
+            os.makedirs(self.output_dir, exist_ok=True)
+            np.save(stem + ".npy", block)
+            np.save(stem + "_times.npy", times)
+            with open(stem + ".json", "w", encoding="utf-8") as f:
+                json.dump(meta, f, ensure_ascii=False)
+        except OSError as e:
+            raise StorageError(f"写入横截面矩阵失败: {stem}: {e}") from e
+        self.engine.clear()
+        self.files.append(stem)
+        futures_logger.info(f"横截面矩阵已保存: {stem}.npy，{rows} 行 × {block.shape[2]} 合约")
+        return stem
+
+    def close(self) -> None:
+        """落盘未写满的块。"""
+        self.persist()
+
+
+def load_cross_section(stem: str) -> Dict[str, Any]:
+    """映射读取 persist 写出的矩阵。
+
+    Returns:
+        {"data": (字段, 行, 合约) 只读映射, "times": datetime64[us], "fields", "symbols", "interval_us"}
+    """
+    try:
+        with open(stem + ".json", encoding="utf-8") as f:
+            meta = json.load(f)
+        data = np.load(stem + ".npy", mmap_mode="r")
+        times = np.load(stem + "_times.npy")
+    except (OSError, ValueError) as e:
+        raise StorageError(f"读取横截面矩阵失败: {stem}: {e}") from e
+    meta["data"] = data
+    meta["times"] = times
+    return meta
+
+
+def create_cross_section(cfg: Optional[Dict[str, Any]] = None):
+    """按配置创建横截面矩阵（native 优先）。
+
+    Args:
+        cfg: 可选 instruments、rows、interval（秒）、max_gap（秒）与 native（默认 True）。
+    """
+    cfg = cfg or {}
+    args = (
+        int(cfg.get("instruments", DEFAULT_INSTRUMENTS)),
+        int(cfg.get("rows", DEFAULT_ROWS)),
+        float(cfg.get("interval", 0.5)),
+        float(cfg.get("max_gap", 60.0)),
+    )
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "CrossSection"):
+        return m.CrossSection(*args)
+    return CrossSection(*args)
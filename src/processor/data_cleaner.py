@@ -9,7 +9,11 @@ from src.utils import futures_logger, DataCleanError
 
 
 class DataCleaner:
-    """行情数据清洗器：去重、必选字段校验。"""
+    """行情数据清洗器：去重、必选字段校验。
+
+    去重键优先使用解析阶段分配的 instrument_id（int），避免逐条对合约字符串重复哈希；
+    无合约 ID 的记录（如外部注入）回退为合约代码。
+    """
 
     def __init__(self, clean_config: Dict[str, Any] = None):
         """初始化清洗器。
@@ -36,7 +40,10 @@ class DataCleaner:
         cleaned_list = []
         for data in data_list:
             try:
-                key = (data["symbol"], data["datetime"])
+                instrument_id = data.get("instrument_id")
+                if instrument_id is None or instrument_id < 0:
+                    instrument_id = data["symbol"]
+                key = (instrument_id, data["datetime"])
             except KeyError as e:
                 raise DataCleanError(f"清洗数据缺少必选字段: {e}") from e
             if key in self.seen_data:
@@ -7,6 +7,7 @@ import re
 from typing import Dict, Optional
 from src.api.zy_zmq_api import DCEL1_Quotation, CZCEL2_Quotation
 from src.api.ctp_api import CThostFtdcDepthMarketDataField
+from src.processor.symbol_table import get_symbol_table
 from src.utils.exceptions import DataParseError
 
 # 合约品种代码 -> 交易所（用于 CTP ExchangeID 为空时补全）
@@ -98,16 +99,18 @@ class DataParser:
     @staticmethod
     def _parse_dce_l1(obj: DCEL1_Quotation) -> Dict:
         """解析大商所 L1"""
-        symbol = obj.Symbol.decode('gbk').strip()
+        instrument_id, symbol = get_symbol_table().resolve(obj.Symbol)
         time_str = str(obj.Time).zfill(9)
         date_str = str(obj.TradeDate)
         dt = datetime.datetime.strptime(f"{date_str}{time_str}", "%Y%m%d%H%M%S%f")
         
         return {
             "symbol": symbol,
+            "instrument_id": instrument_id,
             "exchange": "DCE",
             "last_price": obj.LastPrice,
             "volume": int(obj.TotalVolume),
+            "turnover": float(obj.TotalAmount),
             "open_interest": float(obj.TotalPosition),
             "datetime": dt,
             "bid_price_1": obj.BuyPrice01,
@@ -124,7 +127,7 @@ class DataParser:
     @staticmethod
     def _parse_czce_l1(obj: CZCEL2_Quotation) -> Dict:
         """解析郑商所 L1"""
-        symbol = obj.Symbol.decode('gbk').strip()
+        instrument_id, symbol = get_symbol_table().resolve(obj.Symbol)
         time_val = obj.Time // 1000
         time_str = str(time_val).zfill(9)
         date_str = str(obj.TradeDate)
@@ -133,9 +136,11 @@ class DataParser:
         
         return {
             "symbol": symbol,
+            "instrument_id": instrument_id,
             "exchange": "CZCE",
             "last_price": obj.LastPrice / scale,
             "volume": int(obj.TotalVolume),
+            "turnover": float(obj.TotalAmount),
             "open_interest": float(obj.TotalPosition),
             "datetime": dt,
             "bid_price_1": obj.DeriveBidPrice / scale if obj.DeriveBidPrice else 0.0,
@@ -155,7 +160,8 @@ class DataParser:
         from src.utils import futures_logger
 
         try:
-            symbol = str(obj.InstrumentID).strip() if hasattr(obj, "InstrumentID") and obj.InstrumentID else ""
+            raw_symbol = str(obj.InstrumentID) if hasattr(obj, "InstrumentID") and obj.InstrumentID else ""
+            instrument_id, symbol = get_symbol_table().resolve(raw_symbol)
             time_str = str(obj.UpdateTime) if hasattr(obj, "UpdateTime") and obj.UpdateTime else "00:00:00"
             date_str = str(obj.ActionDay) if hasattr(obj, "ActionDay") and obj.ActionDay else ""
             ms = int(obj.UpdateMillisec) if hasattr(obj, "UpdateMillisec") else 0
@@ -177,9 +183,11 @@ class DataParser:
 
             result = {
                 "symbol": symbol,
+                "instrument_id": instrument_id,
                 "exchange": exchange,
                 "last_price": float(obj.LastPrice) if hasattr(obj, "LastPrice") and obj.LastPrice else 0.0,
                 "volume": int(obj.Volume) if hasattr(obj, "Volume") and obj.Volume else 0,
+                "turnover": float(obj.Turnover) if hasattr(obj, "Turnover") and obj.Turnover else 0.0,
                 "open_interest": float(obj.OpenInterest) if hasattr(obj, "OpenInterest") and obj.OpenInterest else 0.0,
                 "datetime": dt,
                 "bid_price_1": float(obj.BidPrice1) if hasattr(obj, "BidPrice1") and obj.BidPrice1 else 0.0,
@@ -232,10 +240,12 @@ class DataParser:
             return getattr(obj, name, default)
 
         try:
-            symbol = _get("InstrumentID", "") or _get("instrument_id", "")
+            raw_symbol = _get("InstrumentID", "") or _get("instrument_id", "")
+            instrument_id, symbol = get_symbol_table().resolve(str(raw_symbol))
             exchange = _get("ExchangeID", "") or _get("exchange_id", "")
             last_price = float(_get("LastPrice", 0.0) or 0.0)
             volume = int(_get("TradeVolume", 0) or 0)
+            turnover = float(_get("Turnover", 0.0) or 0.0)
             open_interest = float(_get("OpenInterest", 0.0) or 0.0)
 
             # bid/ask 1（兼容数组或独立字段）
@@ -285,10 +295,12 @@ class DataParser:
                 dt = datetime.datetime.now()
 
             return {
-                "symbol": str(symbol).strip(),
+                "symbol": symbol,
+                "instrument_id": instrument_id,
                 "exchange": str(exchange).strip(),
                 "last_price": last_price,
                 "volume": volume,
+                "turnover": turnover,
                 "open_interest": open_interest,
                 "datetime": dt,
                 "bid_price_1": bid_price_1,
@@ -316,9 +328,14 @@ class DataParser:
             return getattr(obj, name, default)
 
         try:
-            symbol = (_get("contract_name") or "").strip()
+            instrument_id = _get("instrument_id")
+            if instrument_id is None:
+                instrument_id, symbol = get_symbol_table().resolve(_get("contract_name") or "")
+            else:
+                symbol = _get("contract_name") or ""
             last_price = float(_get("last_price", 0.0) or 0.0)
             volume = int(_get("match_total_qty", 0) or 0)
+            turnover = float(_get("turn_over", 0.0) or 0.0)
             open_interest = float(_get("open_interest", 0) or 0)
             bid_price_1 = float(_get("bid1_px", 0.0) or 0.0)
             bid_volume_1 = int(_get("bid1_vol", 0) or 0)
@@ -340,9 +357,11 @@ class DataParser:
 
             return {
                 "symbol": symbol,
+                "instrument_id": instrument_id,
                 "exchange": "GFEX",
                 "last_price": last_price,
                 "volume": volume,
+                "turnover": turnover,
                 "open_interest": open_interest,
                 "datetime": dt,
                 "bid_price_1": bid_price_1,
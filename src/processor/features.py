@@ -0,0 +1,430 @@
+# -*- coding: utf-8 -*-
+"""逐笔特征张量导出模块
+
+机器学习模型消费逐笔特征（盘口、失衡、多周期收益、时段内时间），此前每个消费方都从
+FUTURES_BASE_FIELDS dict 在 Python 里重建。本模块按声明式特征列表在流水线中统一计算：
+- 每条行情按列表计算一行 float32 特征，写入共享内存（/dev/shm/<name>）中的预分配环形张量
+- 推理进程以 FeatureTensorReader 映射同一区域，按 write_seq 取连续行的 numpy 视图，无解析、无复制
+
+特征名（与 fq::parse_feature 一致）：last_price、mid_price、spread、bid_price_1、ask_price_1、
+bid_volume_1、ask_volume_1、imbalance、volume_delta、open_interest、time_of_day、session_elapsed，
+以及 return:<秒>（中间价对数收益，如 return:0.5、return:60）。中间价在双边有报价时取 (bid+ask)/2，否则为最新价；
+无法计算的特征（首条行情的 volume_delta、历史不足的 return 等）为 NaN。
+
+共享区布局与 fq/feature_tensor.hpp 一致：4096 字节文件头（magic、特征数、容量、write_seq、数组偏移、特征名），
+随后为 times（int64 sim_time）、instrument_ids（int32）、values（float32，容量 × 特征数）三段环形数组，
+第 seq 行位于 seq % 容量。单写者，写者启动时重建共享区，读取方需重新打开。
+第 write_seq 行的槽位随时可能正被写者改写，读取方只把最近 容量 - 1 行视为有效。
+
+native_pybind 可用时使用 fq::FeatureTensorWriter，否则使用等价的纯 Python 实现；读取方始终为 numpy 视图。
+"""
+import math
+import mmap
+import os
+import time
+from bisect import bisect_right
+from collections import deque
+from typing import Any, Deque, Dict, List, NamedTuple, Optional, Tuple
+
+import numpy as np
+
+from src.backtest.fill_simulator import US_PER_DAY, sim_time
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+
+SHM_DIR = "/dev/shm"
+MAGIC = b"FQFEAT01"
+VERSION = 1
+HEADER_BYTES = 4096
+
+HEADER_DTYPE = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("features", "<u4"),
+    ("capacity", "<u8"),
+    ("write_seq", "<u8"),
+    ("times_offset", "<u8"),
+    ("iids_offset", "<u8"),
+    ("values_offset", "<u8"),
+    ("pad", "V8"),
+    ("names", f"S{HEADER_BYTES - 64}"),
+])
+assert HEADER_DTYPE.itemsize == HEADER_BYTES
+
+SIMPLE_FEATURES = (
+    "last_price", "mid_price", "spread", "bid_price_1", "ask_price_1", "bid_volume_1", "ask_volume_1",
+    "imbalance", "volume_delta", "open_interest", "time_of_day", "session_elapsed",
+)
+RETURN_PREFIX = "return:"
+
+DEFAULT_FEATURES = [
+    "mid_price", "spread", "imbalance", "bid_volume_1", "ask_volume_1", "volume_delta",
+    "return:1", "return:10", "return:60", "time_of_day", "session_elapsed",
+]
+
+
+def parse_feature(name: str) -> Tuple[str, int]:
+    """解析特征名，返回 (类别, horizon 微秒)；return 以外的 horizon 为 0。
+
+    Raises:
+        ConfigError: 特征名无效时抛出。
+    """
+    if name in SIMPLE_FEATURES:
+        return name, 0
+    if name.startswith(RETURN_PREFIX):
+        try:
+            seconds = float(name[len(RETURN_PREFIX):])
+        except ValueError:
+            seconds = 0.0
+        horizon = int(round(seconds * 1e6)) if 0 < seconds <= 86400 else 0
+        if horizon > 0:
+            return "return", horizon
+    raise ConfigError(f"未知的特征: {name!r}（可选 {list(SIMPLE_FEATURES)} 或 return:<秒>）")
+
+
+def _next_pow2(n: int) -> int:
+    p = 2
+    while p < n:
+        p <<= 1
+    return p
+
+
+def _align64(n: int) -> int:
+    return (n + 63) & ~63
+
+
+def _shm_path(name: str) -> str:
+    return os.path.join(SHM_DIR, name.lstrip("/"))
+
+
+class _State:
+    __slots__ = ("count", "volume", "last_time", "session_start", "hist_t", "hist_mid")
+
+    def __init__(self, history: int):
+        self.count = 0
+        self.volume = 0
+        self.last_time = 0
+        self.session_start = 0
+        self.hist_t: Deque[int] = deque(maxlen=history)
+        self.hist_mid: Deque[float] = deque(maxlen=history)
+
+
+class FeatureExtractor:
+    """逐合约状态的特征计算（与 fq::FeatureExtractor 一致）。"""
+
+    def __init__(self, features: List[str], instruments: int = 1024, history: int = 512,
+                 session_gap: float = 600.0):
+        self.names = list(features)
+        self.specs = [parse_feature(n) for n in self.names]
+        self.instruments = max(1, int(instruments))
+        self.history = _next_pow2(int(history))
+        self.session_gap_us = max(1, int(round(session_gap * 1e6)))
+        self._states: Dict[int, _State] = {}
+
+    def compute(self, data: Dict) -> Optional[Tuple[int, List[float]]]:
+        """计算一行特征，返回 (sim_time, 特征)；合约超出范围或无时间返回 None。"""
+        iid = data.get("instrument_id")
+        dt = data.get("datetime")
+        if not isinstance(iid, int) or not 0 <= iid < self.instruments or dt is None:
+            return None
+        st = self._states.get(iid)
+        if st is None:
+            st = self._states[iid] = _State(self.history)
+        ts = sim_time(dt)
+        last = float(data.get("last_price") or 0.0)
+        bid = float(data.get("bid_price_1") or 0.0)
+        ask = float(data.get("ask_price_1") or 0.0)
+        bid_vol = float(data.get("bid_volume_1") or 0)
+        ask_vol = float(data.get("ask_volume_1") or 0)
+        volume = int(data.get("volume") or 0)
+        two_sided = bid > 0 and ask > 0
+        mid = 0.5 * (bid + ask) if two_sided else last
+        if st.count == 0 or ts - st.last_time > self.session_gap_us:
+            st.session_start = ts
+        if mid > 0:
+            st.hist_t.append(ts)
+            st.hist_mid.append(mid)
+
+        nan = float("nan")
+        row = []
+        for kind, horizon in self.specs:
+            if kind == "last_price":
+                v = last
+            elif kind == "mid_price":
+                v = mid
+            elif kind == "spread":
+                v = ask - bid if two_sided else nan
+            elif kind == "bid_price_1":
+                v = bid
+            elif kind == "ask_price_1":
+                v = ask
+            elif kind == "bid_volume_1":
+                v = bid_vol
+            elif kind == "ask_volume_1":
+                v = ask_vol
+            elif kind == "imbalance":
+                v = (bid_vol - ask_vol) / (bid_vol + ask_vol) if bid_vol + ask_vol > 0 else nan
+            elif kind == "volume_delta":
+                # 累计量回退（换日）时以当前累计量计
+                v = float(volume - st.volume if volume >= st.volume else volume) if st.count else nan
+            elif kind == "open_interest":
+                v = float(data.get("open_interest") or 0.0)
+            elif kind == "return":
+                v = nan
+                if mid > 0:
+                    k = bisect_right(st.hist_t, ts - horizon)
+                    if k > 0:
+                        base = st.hist_mid[k - 1]
+                        v = math.log(mid / base) if base > 0 else nan
+            elif kind == "time_of_day":
+                v = (ts % US_PER_DAY) * 1e-6
+            else:  # session_elapsed
+                v = (ts - st.session_start) * 1e-6
+            row.append(v)
+        st.volume = volume
+        st.last_time = ts
+        st.count += 1
+        return ts, row
+
+    def reset(self) -> None:
+        self._states.clear()
+
+
+class FeatureTensorWriter:
+    """纯 Python 特征张量写端（与 native_pybind.FeatureTensorWriter 接口、布局一致）。"""
+
+    def __init__(self, features: List[str], name: str = "/fq_features", capacity: int = 65536,
+                 instruments: int = 1024, history: int = 512, session_gap: float = 600.0):
+        self._extractor = FeatureExtractor(features, instruments, history, session_gap)
+        joined = "\n".join(self._extractor.names).encode("utf-8")
+        if not joined or len(joined) >= HEADER_DTYPE["names"].itemsize:
+            raise ConfigError("特征列表为空或特征名总长超出文件头")
+        self.name = name
+        self.capacity = _next_pow2(int(capacity))
+        self.features = list(self._extractor.names)
+        f = len(self.features)
+        times_off = HEADER_BYTES
+        iids_off = times_off + _align64(self.capacity * 8)
+        values_off = iids_off + _align64(self.capacity * 4)
+        size = values_off + _align64(self.capacity * f * 4)
+        self._path = _shm_path(name)
+        try:
+            try:
+                os.unlink(self._path)
+            except FileNotFoundError:
+                pass
+            fd = os.open(self._path, os.O_RDWR | os.O_CREAT | os.O_EXCL, 0o600)
+            try:
+                os.ftruncate(fd, size)
+                self._mm = mmap.mmap(fd, size)
+            finally:
+                os.close(fd)
+        except OSError as e:
+            raise StorageError(f"创建特征张量共享内存失败: {self._path}: {e}") from e
+        self._header = np.frombuffer(self._mm, dtype=HEADER_DTYPE, count=1)
+        self._times = np.frombuffer(self._mm, dtype="<i8", count=self.capacity, offset=times_off)
+        self._iids = np.frombuffer(self._mm, dtype="<i4", count=self.capacity, offset=iids_off)
+        self._values = np.frombuffer(self._mm, dtype="<f4", count=self.capacity * f, offset=values_off).reshape(
+            self.capacity, f)
+        h = self._header
+        h["version"] = VERSION
+        h["features"] = f
+        h["capacity"] = self.capacity
+        h["times_offset"] = times_off
+        h["iids_offset"] = iids_off
+        h["values_offset"] = values_off
+        h["names"] = joined
+        h["magic"] = MAGIC
+        self.seq = 0
+
+    def update(self, data_list: List[Dict], start: int = 0) -> int:
+        """从 start 起逐条计算特征并提交，返回写入行数。"""
+        mask = self.capacity - 1
+        n = 0
+        for i in range(start, len(data_list)):
+            out = self._extractor.compute(data_list[i])
+            if out is None:
+                continue
+            k = self.seq & mask
+            self._times[k] = out[0]
+            self._iids[k] = data_list[i]["instrument_id"]
+            self._values[k] = out[1]
+            self.seq += 1
+            self._header["write_seq"] = self.seq
+            n += 1
+        return n
+
+    def unlink(self) -> bool:
+        try:
+            os.unlink(self._path)
+            return True
+        except OSError:
+            return False
+
+    def close(self) -> None:
+        self._header = self._times = self._iids = self._values = None
+        if self._mm is not None:
+            self._mm.close()
+            self._mm = None
+
+
+class FeatureBatch(NamedTuple):
+    """一段连续行：seq 为首行序号，其余为共享区中的 numpy 视图（不复制）。"""
+
+    seq: int
+    values: np.ndarray          # float32 (行, 特征)
+    instrument_ids: np.ndarray  # int32 (行,)
+    times: np.ndarray           # int64 sim_time (行,)
+
+
+class FeatureTensorReader:
+    """特征张量读取端：映射写者的共享区，按序号取连续行的 numpy 视图。"""
+
+    def __init__(self, name: str = "/fq_features", timeout: float = 1.0, from_start: bool = False):
+        """打开共享区。
+
+        Args:
+            name: 写者的共享区名称。
+            timeout: 等待写者创建共享区的秒数。
+            from_start: 从仍保留在环中的最早一行开始读（否则只读打开之后提交的行）。
+
+        Raises:
+            StorageError: 共享区不存在、格式不符时抛出。
+        """
+        self._path = _shm_path(name)
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                fd = os.open(self._path, os.O_RDONLY)
+                break
+            except FileNotFoundError as e:
+                if time.monotonic() >= deadline:
+                    raise StorageError(f"特征张量共享内存不存在: {self._path}") from e
+                time.sleep(0.001)
+        try:
+            self._mm = mmap.mmap(fd, 0, prot=mmap.PROT_READ)
+        except (OSError, ValueError) as e:
+            raise StorageError(f"映射特征张量共享内存失败: {self._path}: {e}") from e
+        finally:
+            os.close(fd)
+        h = np.frombuffer(self._mm, dtype=HEADER_DTYPE, count=1)
+        while h["magic"][0] != MAGIC and time.monotonic() < deadline:
+            time.sleep(0.001)
+        if h["magic"][0] != MAGIC or h["version"][0] != VERSION:
+            self.close()
+            raise StorageError(f"特征张量共享内存格式不符: {self._path}")
+        self._header = h
+        self.capacity = int(h["capacity"][0])
+        self.features = h["names"][0].decode("utf-8").split("\n")
+        f = int(h["features"][0])
+        self._times = np.frombuffer(self._mm, dtype="<i8", count=self.capacity, offset=int(h["times_offset"][0]))
+        self._iids = np.frombuffer(self._mm, dtype="<i4", count=self.capacity, offset=int(h["iids_offset"][0]))
+        self._values = np.frombuffer(
+            self._mm, dtype="<f4", count=self.capacity * f, offset=int(h["values_offset"][0])).reshape(
+            self.capacity, f)
+        ws = self.write_seq
+        self.cursor = self._oldest(ws) if from_start else ws
+        self.lost = 0
+
+    @property
+    def write_seq(self) -> int:
+        return int(self._header["write_seq"][0])
+
+    def read(self, max_rows: int = 0) -> FeatureBatch:
+        """取游标之后已提交的连续行（到环尾为止，max_rows 为 0 时不限），并推进游标。
+
+        读取落后超过 capacity - 1 行时跳到最早仍有效的一行并计入 lost。返回的视图在写者再写入
+        capacity - 1 行后可能正被改写，使用后可用 valid() 确认。
+        """
+        ws = self.write_seq
+        oldest = self._oldest(ws)
+        if self.cursor < oldest:
+            self.lost += oldest - self.cursor
+            self.cursor = oldest
+        start = self.cursor
+        k = start % self.capacity
+        n = min(ws - start, self.capacity - k)
+        if max_rows > 0:
+            n = min(n, max_rows)
+        self.cursor = start + n
+        return FeatureBatch(start, self._values[k:k + n], self._iids[k:k + n], self._times[k:k + n])
+
+    def valid(self, batch: FeatureBatch) -> bool:
+        """批次视图是否仍未被写者覆盖（也未处于正在改写的槽位）。"""
+        return self._oldest(self.write_seq) <= batch.seq
+
+    def _oldest(self, ws: int) -> int:
+        # 第 ws 行的槽位（第 ws - capacity 行）可能正被改写，不算有效
+        return max(0, ws - self.capacity + 1)
+
+    def column(self, name: str) -> int:
+        """特征名对应的列下标。"""
+        try:
+            return self.features.index(name)
+        except ValueError:
+            raise KeyError(f"unknown feature: {name}") from None
+
+    def close(self) -> None:
+        self._header = self._times = self._iids = self._values = None
+        if self._mm is not None:
+            try:
+                self._mm.close()
+            except BufferError:
+                # 仍有调用方持有视图时保留映射，随对象回收释放
+                pass
+            self._mm = None
+
+
+class FeatureStage:
+    """流水线阶段：计算特征写入共享张量，数据透传。"""
+
+    def __init__(self, writer, unlink_on_close: bool = False):
+        self.writer = writer
+        self.unlink_on_close = unlink_on_close
+
+    def __call__(self, data_list: List[Dict]) -> List[Dict]:
+        self.writer.update(data_list)
+        return data_list
+
+    def close(self) -> None:
+        if self.unlink_on_close:
+            self.writer.unlink()
+        self.writer.close()
+
+
+def create_feature_writer(cfg: Optional[Dict[str, Any]] = None):
+    """按配置创建特征张量写端（native 优先）。
+
+    Args:
+        cfg: 可选 features（特征名列表）、shm（共享区名称）、capacity（行）、instruments、
+            history（每合约保留的中间价条数，供 return 特征）、session_gap（秒）与 native（默认 True）。
+
+    Raises:
+        ConfigError: 特征名无效时抛出。
+        StorageError: 共享内存无法创建时抛出。
+    """
+    cfg = cfg or {}
+    features = list(cfg.get("features") or DEFAULT_FEATURES)
+    for name in features:
+        parse_feature(name)
+    args = (
+        features,
+        str(cfg.get("shm", "/fq_features")),
+        int(cfg.get("capacity", 65536)),
+        int(cfg.get("instruments", 1024)),
+        int(cfg.get("history", 512)),
+        float(cfg.get("session_gap", 600.0)),
+    )
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "FeatureTensorWriter"):
+        try:
+            writer = m.FeatureTensorWriter(*args)
+        except ValueError as e:
+            raise ConfigError(str(e)) from e
+        except RuntimeError as e:
+            raise StorageError(f"创建特征张量共享内存失败: {args[1]}: {e}") from e
+    else:
+        writer = FeatureTensorWriter(*args)
+    futures_logger.info(f"特征张量: {args[1]}，{len(features)} 列 × {writer.capacity} 行")
+    return writer
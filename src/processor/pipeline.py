@@ -0,0 +1,386 @@
+# -*- coding: utf-8 -*-
+"""可配置处理流水线模块
+
+将 main.py 中写死的 清洗 → 存储 链路改为在 main_config.yaml 的 pipeline 段声明的有向无环图：
+- 隐含的 source 节点为分发循环交来的标准化行情
+- 每个阶段声明 type、inputs（上游阶段名）与 threads：
+  0 为在上游线程内联执行；1 为独占线程；>1 为按 instrument_id 分片的线程池（单合约有序）。
+  这些都是普通 Python 线程，受 GIL 约束：阶段之间只有文件写入等释放 GIL 的阻塞调用能重叠，
+  纯 Python 计算不会因增加 threads 而按核数扩展；threads 的作用是隔离慢阶段（背压、积压统计）
+- 有多个上游的内联阶段可能被不同线程同时调用，由阶段锁串行执行（连同向下游的交付），
+  DataCleaner 去重表等非线程安全状态无需自行加锁
+- 内联阶段与线程阶段的异常处理一致（见 sharded_processor.run_stages）：异常记录并计入 errors，
+  本批在该阶段丢弃，不会传到上游线程或分发循环
+- 阶段之间通过有界队列连接（queue_size，满时上游阻塞形成背压），多上游的阶段自动汇合，
+  多下游的阶段自动扇出；扇出时除最后一条边外每条边交付一份浅拷贝（新列表 + 每条 dict 的副本），
+  下游原地修改行情不会影响兄弟分支
+- 范围：边是 queue.Queue、阶段由 Python 线程驱动；cross_section/covariance/features/alerts/
+  ws_fanout/trades 等阶段在 native_pybind 可用时调用原生引擎，但阶段之间不经原生无锁环形队列，
+  行情在边上仍以 dict 列表传递
+- 每个阶段自动统计输入/输出条数、异常次数、积压与累计处理耗时
+
+内置阶段类型见 STAGE_TYPES；自定义阶段用 type: python 并以 callable: "模块:函数" 指定，
+函数签名为 f(stage_config, shard) -> stage(data_list) -> data_list。
+trades 阶段由行情快照推断成交（见 trade_inference），其下游收到的是成交 dict；
+alerts 阶段按编译后的规则求值（见 alerts），其下游收到的是告警事件 dict；
+构建时按 STAGE_TYPES 校验每条边的数据类型。
+阶段对象若有 close() 方法，流水线关闭时在该阶段处理完剩余数据后调用（用于落盘未写满的缓冲）。
+"""
+import importlib
+import threading
+import time
+from typing import Any, Callable, Dict, List, Optional
+
+from src.api.ws_fanout import WsFanoutStage, create_ws_fanout
+from src.processor.alerts import AlertStage, create_alert_engine
+from src.processor.covariance import CovarianceStage, create_ewm_covariance
+from src.processor.cross_section import CrossSectionWriter, create_cross_section
+from src.processor.data_cleaner import DataCleaner
+from src.processor.features import FeatureStage, create_feature_writer
+from src.processor.sharded_processor import ShardedProcessor, Stage, run_stages
+from src.processor.trade_inference import create_trade_inference
+from src.storage.file_storage import FileStorage
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError
+
+SOURCE = "source"
+# 边的数据类型：ticks 为标准化行情 dict 列表；trades 为推断成交 dict 列表；alerts 为告警事件 dict 列表；
+# none 表示汇点，不可作为下游输入；same 表示与上游类型相同（透传类阶段）
+TICKS = "ticks"
+TRADES = "trades"
+ALERTS = "alerts"
+NONE = "none"
+SAME = "same"
+
+
+def _clean_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    return DataCleaner(cfg.get("clean", cfg)).clean
+
+
+def _file_storage_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    storage = FileStorage(base_path=cfg.get("base_path", "data/market_data"))
+
+    def save(data_list: List[Dict]) -> List[Dict]:
+        storage.save(data_list)
+        return data_list
+    return save
+
+
+def _filter_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    symbols = set(cfg.get("symbols") or [])
+    exchanges = set(cfg.get("exchanges") or [])
+
+    def keep(data_list: List[Dict]) -> List[Dict]:
+        return [
+            d for d in data_list
+            if (not symbols or d.get("symbol") in symbols) and (not exchanges or d.get("exchange") in exchanges)
+        ]
+    return keep
+
+
+def _fanout_factory(_cfg: Dict[str, Any], _shard: int) -> Stage:
+    return lambda data_list: data_list
+
+
+def _trades_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 推断状态按合约保存，多线程时依赖分片保证同一合约落在同一线程
+    return create_trade_inference(cfg).infer
+
+
+def _alerts_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 规则状态按 (规则, 合约) 保存，多线程时每个分片各自编译一份，依赖分片保证同一合约落在同一线程
+    return AlertStage(create_alert_engine(cfg), log=bool(cfg.get("log", True)))
+
+
+def _cross_section_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 横截面覆盖全部合约，只能单线程（threads 为 0 或 1），构建时已校验
+    return CrossSectionWriter(
+        create_cross_section(cfg),
+        cfg.get("output_dir", "data/cross_section"),
+        prefix=cfg.get("prefix", "cross_section"),
+    )
+
+
+def _covariance_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 协方差覆盖全部合约，与 cross_section 同样只能单线程
+    return CovarianceStage(
+        create_ewm_covariance(cfg),
+        snapshot_every=int(cfg.get("snapshot_every", 60)),
+        correlation=bool(cfg.get("correlation", True)),
+        output_dir=cfg.get("output_dir"),
+        prefix=cfg.get("prefix", "covariance"),
+    )
+
+
+def _features_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 单写者共享张量且按合约保存特征状态，只能单线程
+    return FeatureStage(create_feature_writer(cfg), unlink_on_close=bool(cfg.get("unlink_on_close", False)))
+
+
+def _ws_fanout_factory(cfg: Dict[str, Any], _shard: int) -> Stage:
+    # 只写最新行情表（每合约单写者），服务监听一个端口，只能单线程
+    return WsFanoutStage(create_ws_fanout(cfg))
+
+
+def _python_factory(cfg: Dict[str, Any], shard: int) -> Stage:
+    target = cfg.get("callable")
+    if not target or ":" not in target:
+        raise ConfigError(f"python 阶段需要 callable: '模块:函数'，当前为 {target!r}")
+    module_name, func_name = target.split(":", 1)
+    factory = getattr(importlib.import_module(module_name), func_name)
+    return factory(cfg, shard)
+
+
+# type -> (阶段工厂, 输出类型, 接受的输入类型)；存储类阶段透传数据，便于串接下游
+STAGE_TYPES: Dict[str, Any] = {
+    "clean": (_clean_factory, TICKS, (TICKS,)),
+    "trades": (_trades_factory, TRADES, (TICKS,)),
+    "alerts": (_alerts_factory, ALERTS, (TICKS,)),
+    "cross_section": (_cross_section_factory, SAME, (TICKS,)),
+    "covariance": (_covariance_factory, SAME, (TICKS,)),
+    "features": (_features_factory, SAME, (TICKS,)),
+    "ws_fanout": (_ws_fanout_factory, SAME, (TICKS,)),
+    "file_storage": (_file_storage_factory, SAME, (TICKS, TRADES)),
+    "filter": (_filter_factory, SAME, (TICKS, TRADES, ALERTS)),
+    "fanout": (_fanout_factory, SAME, (TICKS, TRADES, ALERTS)),
+    "python": (_python_factory, SAME, (TICKS, TRADES, ALERTS)),
+}
+
+
+def _fan_out(nodes: List["_StageNode"], data_list: List[Dict]) -> None:
+    """把一批数据交给多个下游：最后一条边沿用原批次，其余各得一份浅拷贝。"""
+    last = len(nodes) - 1
+    for i, node in enumerate(nodes):
+        node.submit(data_list if i == last else [dict(d) for d in data_list])
+
+
+class _StageNode:
+    """流水线中的一个阶段：执行体 + 下游列表 + 统计。"""
+
+    def __init__(self, name: str, cfg: Dict[str, Any]):
+        self.name = name
+        self.cfg = cfg
+        self.threads = int(cfg.get("threads", 1))
+        self.downstream: List["_StageNode"] = []
+        self.in_count = 0
+        self.out_count = 0
+        self.busy_seconds = 0.0
+        self.inline_errors = 0
+        self._stats_lock = threading.Lock()
+        self._submit_lock = threading.Lock()
+        # 内联且有多个上游时由 Pipeline 设置：串行执行本阶段及其向下游的交付
+        self._serial: Optional[threading.Lock] = None
+        self._pool: Optional[ShardedProcessor] = None
+        self._inline: Optional[Stage] = None
+        self._stages: List[Any] = []
+
+    def start(self) -> None:
+        factory = STAGE_TYPES[self.cfg["type"]][0]
+
+        def stage_factory(shard: int) -> Stage:
+            stage = factory(self.cfg, shard)
+            self._stages.append(stage)
+            return self._timed(stage)
+        if self.threads <= 0:
+            self._inline = stage_factory(0)
+            return
+        self._pool = ShardedProcessor(
+            self.threads,
+            [stage_factory],
+            queue_size=int(self.cfg.get("queue_size", 0)),
+            merge_callback=self._emit if self.downstream else None,
+            name=f"stage-{self.name}",
+        )
+
+    def _timed(self, stage: Stage) -> Stage:
+        def run(data_list: List[Dict]) -> Optional[List[Dict]]:
+            t0 = time.perf_counter()
+            out = stage(data_list)
+            dt = time.perf_counter() - t0
+            with self._stats_lock:
+                self.busy_seconds += dt
+                self.out_count += len(out) if out else 0
+            return out
+        return run
+
+    def submit(self, data_list: List[Dict]) -> None:
+        with self._stats_lock:
+            self.in_count += len(data_list)
+        if self._inline is not None:
+            if self._serial is None:
+                self._run_inline(data_list)
+            else:
+                with self._serial:
+                    self._run_inline(data_list)
+            return
+        # 多个上游可能在不同线程提交，分片处理器的 submit 需串行
+        with self._submit_lock:
+            self._pool.submit(data_list)
+
+    def _run_inline(self, data_list: List[Dict]) -> None:
+        out = run_stages([self._inline], data_list, f"阶段 {self.name}")
+        if out is None:
+            with self._stats_lock:
+                self.inline_errors += 1
+        elif out:
+            self._emit(out)
+
+    def _emit(self, data_list: List[Dict]) -> None:
+        _fan_out(self.downstream, data_list)
+
+    def flush(self) -> None:
+        if self._pool is not None:
+            self._pool.flush()
+
+    def close(self) -> None:
+        if self._pool is not None:
+            self._pool.close()
+        for stage in self._stages:
+            close = getattr(stage, "close", None)
+            if callable(close):
+                close()
+
+    def metrics(self) -> Dict[str, Any]:
+        m = {
+            "in": self.in_count,
+            "out": self.out_count,
+            "busy_seconds": round(self.busy_seconds, 6),
+            "threads": self.threads,
+        }
+        if self._pool is not None:
+            pm = self._pool.metrics()
+            m["backlog"] = sum(pm["backlog"])
+            m["errors"] = sum(pm["errors"])
+        else:
+            m["errors"] = self.inline_errors
+        return m
+
+
+class Pipeline:
+    """按配置构建的处理流水线（DAG）。"""
+
+    def __init__(self, stages: List[Dict[str, Any]]):
+        """校验并构建流水线（不启动线程，需调用 start）。
+
+        Args:
+            stages: 阶段配置列表，每项含 name、type、inputs，可选 threads、queue_size 及阶段参数。
+
+        Raises:
+            ConfigError: 阶段名重复、类型未知、引用不存在的上游、上游为汇点或存在环时抛出。
+        """
+        if not stages:
+            raise ConfigError("pipeline.stages 不能为空")
+        self._nodes: Dict[str, _StageNode] = {}
+        for cfg in stages:
+            name = cfg.get("name")
+            if not name or name == SOURCE or name in self._nodes:
+                raise ConfigError(f"流水线阶段名无效或重复: {name!r}")
+            if cfg.get("type") not in STAGE_TYPES:
+                raise ConfigError(f"未知的流水线阶段类型: {cfg.get('type')!r}（可选 {sorted(STAGE_TYPES)}）")
+            if cfg["type"] in ("cross_section", "covariance", "features", "ws_fanout") and int(cfg.get("threads", 1)) > 1:
+                raise ConfigError(f"{cfg['type']} 阶段 {name} 覆盖全部合约，threads 不能大于 1")
+            self._nodes[name] = _StageNode(name, cfg)
+        self._roots: List[_StageNode] = []
+        for node in self._nodes.values():
+            inputs = node.cfg.get("inputs") or [SOURCE]
+            for upstream in inputs:
+                if upstream == SOURCE:
+                    self._roots.append(node)
+                elif upstream not in self._nodes:
+                    raise ConfigError(f"阶段 {node.name} 引用了不存在的上游: {upstream!r}")
+                else:
+                    self._nodes[upstream].downstream.append(node)
+            # 多个上游可能在不同线程交付（汇合），内联阶段需串行；单上游时调用方已是串行的
+            # （source 为分发循环，线程阶段经合并器按序交付，内联上游在自身锁内交付）
+            if node.threads <= 0 and len(set(inputs)) > 1:
+                node._serial = threading.Lock()
+        self._order = self._topological_order()
+        self._check_edge_types()
+        self._started = False
+
+    @classmethod
+    def from_config(cls, config: Dict[str, Any]) -> "Pipeline":
+        """按主配置构建流水线；file_storage 阶段未给出 base_path 时取 storage.file.base_path。"""
+        base_path = config.get("storage", {}).get("file", {}).get("base_path", "data/market_data")
+        clean_config = config.get("processor", {}).get("clean", {})
+        stages = []
+        for stage in config.get("pipeline", {}).get("stages") or []:
+            stage = dict(stage)
+            if stage.get("type") == "file_storage":
+                stage.setdefault("base_path", base_path)
+            if stage.get("type") == "clean":
+                stage.setdefault("clean", clean_config)
+            stages.append(stage)
+        return cls(stages)
+
+    def _topological_order(self) -> List[_StageNode]:
+        indegree = {name: 0 for name in self._nodes}
+        for node in self._nodes.values():
+            for d in node.downstream:
+                indegree[d.name] += 1
+        ready = [n for n in self._nodes.values() if indegree[n.name] == 0]
+        order: List[_StageNode] = []
+        while ready:
+            node = ready.pop(0)
+            order.append(node)
+            for d in node.downstream:
+                indegree[d.name] -= 1
+                if indegree[d.name] == 0:
+                    ready.append(d)
+        if len(order) != len(self._nodes):
+            raise ConfigError("流水线存在环，请检查 inputs 配置")
+        return order
+
+    def _check_edge_types(self) -> None:
+        """按拓扑序推导各阶段输出类型，校验每条边的类型被下游接受。"""
+        out_types: Dict[str, str] = {}
+        for node in self._order:
+            _, out_type, accepts = STAGE_TYPES[node.cfg["type"]]
+            in_types = set()
+            for upstream in node.cfg.get("inputs") or [SOURCE]:
+                in_type = TICKS if upstream == SOURCE else out_types[upstream]
+                if in_type not in accepts:
+                    raise ConfigError(
+                        f"阶段 {node.name}（{node.cfg['type']}）不接受上游 {upstream} 输出的 {in_type} 数据"
+                    )
+                in_types.add(in_type)
+            if out_type == SAME:
+                if len(in_types) > 1:
+                    raise ConfigError(f"阶段 {node.name} 的上游数据类型不一致: {sorted(in_types)}")
+                out_type = in_types.pop()
+            out_types[node.name] = out_type
+
+    def start(self) -> "Pipeline":
+        """自下游向上游启动各阶段线程。"""
+        if not self._started:
+            for node in reversed(self._order):
+                node.start()
+            self._started = True
+            futures_logger.info(
+                "流水线已启动: " + ", ".join(
+                    f"{n.name}({n.cfg['type']}, threads={n.threads}) <- {n.cfg.get('inputs') or [SOURCE]}"
+                    for n in self._order
+                )
+            )
+        return self
+
+    def submit(self, data_list: List[Dict]) -> None:
+        """把一批标准化行情交给 source 的所有下游阶段。"""
+        if not data_list:
+            return
+        _fan_out(self._roots, data_list)
+
+    def flush(self) -> None:
+        """按拓扑序等待各阶段处理完已提交的数据。"""
+        for node in self._order:
+            node.flush()
+
+    def close(self) -> None:
+        """按拓扑序处理完剩余数据后停止各阶段。"""
+        for node in self._order:
+            node.close()
+        futures_logger.info(f"流水线已停止，阶段统计: {self.metrics()}")
+
+    def metrics(self) -> Dict[str, Dict[str, Any]]:
+        """各阶段的输入/输出条数、积压、异常次数与累计处理耗时。"""
+        return {node.name: node.metrics() for node in self._order}
@@ -0,0 +1,268 @@
+# -*- coding: utf-8 -*-
+"""按合约分片的并行处理模块
+
+分发循环收到的行情按 instrument_id 哈希分到 N 个工作线程，每个线程独占一条队列
+和一套处理阶段（默认 清洗 → 存储），同一合约始终由同一线程按到达顺序处理：
+- 单合约严格有序；各阶段是 Python 代码，工作线程是普通 Python 线程，受 GIL 约束：
+  清洗等纯 Python 计算仍然串行执行，只有文件写入等释放 GIL 的阻塞调用能与其他分片重叠，
+  因此增加 workers 主要缩短分发循环被存储 I/O 阻塞的时间，而不会让 CPU 计算按核数扩展
+- 各线程持有独立的 DataCleaner 去重状态与 FileStorage 路径缓存，无需加锁
+- 需要全局流的消费者可注册 merge_callback：按提交批次顺序汇总各分片的处理结果
+
+分片规则与原生 fq::shard_of（fq/sharding.hpp）一致；native_pybind 可用时由 shard_partition 完成分流。
+
+create_sharded_processor() 在 native_pybind 可用且无 merge_callback 时改用原生 ShardedTickWriter
+（fq/tick_writer.hpp）：分发循环持 GIL 只做 dict → Tick 转换，各分片经 SpscRing 交给原生工作线程，
+去重与 CSV 落盘全程不经 Python，可随核数扩展；落盘内容与本模块默认 清洗 → 存储 阶段逐字节一致。
+原生实现逐条拒收无法转换的 dict（计入 metrics()["rejected"]），Python 实现则整批计一次异常。
+"""
+import os
+import queue
+import threading
+from typing import Any, Callable, Dict, List, Optional
+
+from src.processor.data_cleaner import DataCleaner
+from src.storage.file_storage import FileStorage
+from src.utils import futures_logger
+from src.utils.exceptions import DataCleanError, FuturesBaseError, StorageError
+from src.utils.native_loader import get_native_pybind
+from src.utils.profiler import register_current_thread, unregister_current_thread
+
+Stage = Callable[[List[Dict]], Optional[List[Dict]]]
+StageFactory = Callable[[int], Stage]
+
+_GOLDEN = 0x9E3779B97F4A7C15
+_MASK64 = (1 << 64) - 1
+_STOP = object()
+
+
+def shard_of(instrument_id: Optional[int], shards: int) -> int:
+    """合约 ID -> 分片编号（与 fq::shard_of 一致）。"""
+    if shards <= 1 or instrument_id is None or instrument_id < 0:
+        return 0
+    return (((instrument_id & 0xFFFFFFFF) * _GOLDEN & _MASK64) >> 32) % shards
+
+
+def _partition(data_list: List[Dict], shards: int) -> List[List[Dict]]:
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "shard_partition"):
+        return m.shard_partition(data_list, shards)
+    parts: List[List[Dict]] = [[] for _ in range(shards)]
+    for data in data_list:
+        parts[shard_of(data.get("instrument_id"), shards)].append(data)
+    return parts
+
+
+def run_stages(stages: List[Stage], data: List[Dict], where: str) -> Optional[List[Dict]]:
+    """依次执行处理阶段；阶段返回空值时终止。
+
+    异常（含继承 BaseException 的业务异常）在此记录并吞掉，返回 None 表示本批丢弃，
+    调用方据此计数，异常不会传到分发循环。
+    """
+    try:
+        for stage in stages:
+            data = stage(data)
+            if not data:
+                return data
+        return data
+    except DataCleanError as e:
+        futures_logger.warning(f"{where} 数据清洗异常，跳过本批: {e}")
+    except StorageError as e:
+        futures_logger.error(f"{where} 存储写入失败: {e}", exc_info=True)
+    except (Exception, FuturesBaseError) as e:
+        futures_logger.error(f"{where} 处理异常: {e}", exc_info=True)
+    return None
+
+
+class _Merger:
+    """按提交批次顺序汇总各分片结果，交给 merge_callback。"""
+
+    def __init__(self, callback: Callable[[List[Dict]], None]):
+        self._callback = callback
+        self._lock = threading.Lock()
+        self._pending: Dict[int, List[Any]] = {}  # seq -> [剩余分片数, {shard: 结果}]
+        self._next_seq = 1
+
+    def expect(self, seq: int, parts: int) -> None:
+        with self._lock:
+            self._pending[seq] = [parts, {}]
+            self._emit_ready()
+
+    def deliver(self, seq: int, shard: int, data: List[Dict]) -> None:
+        with self._lock:
+            entry = self._pending[seq]
+            entry[0] -= 1
+            if data:
+                entry[1][shard] = data
+            self._emit_ready()
+
+    def _emit_ready(self) -> None:
+        while True:
+            entry = self._pending.get(self._next_seq)
+            if entry is None or entry[0] > 0:
+                return
+            del self._pending[self._next_seq]
+            self._next_seq += 1
+            merged = [d for shard in sorted(entry[1]) for d in entry[1][shard]]
+            if merged:
+                try:
+                    self._callback(merged)
+                except Exception as e:
+                    futures_logger.error(f"合并阶段回调异常: {e}", exc_info=True)
+
+
+class ShardedProcessor:
+    """按合约分片的并行处理器。"""
+
+    def __init__(
+        self,
+        workers: int,
+        stage_factories: List[StageFactory],
+        queue_size: int = 0,
+        merge_callback: Optional[Callable[[List[Dict]], None]] = None,
+        name: str = "shard",
+    ):
+        """初始化并启动工作线程。
+
+        Args:
+            workers: 工作线程数（分片数）。
+            stage_factories: 处理阶段工厂列表，按分片编号各创建一套阶段；阶段返回空值时本批在该分片终止。
+            queue_size: 每个分片队列的最大批次数，0 为不限（满时 submit 阻塞，形成背压）。
+            merge_callback: 可选，按提交顺序接收各批次在所有分片处理后的结果。
+            name: 线程名前缀（线程名为 "<name>-worker-<分片>"，同时用于采样分析的线程登记）。
+        """
+        self.workers = max(1, int(workers))
+        self._queues = [queue.Queue(maxsize=queue_size) for _ in range(self.workers)]
+        self._stages = [[factory(i) for factory in stage_factories] for i in range(self.workers)]
+        self._merger = _Merger(merge_callback) if merge_callback else None
+        self._seq = 0
+        self._processed = [0] * self.workers
+        self._errors = [0] * self.workers
+        self._threads = [
+            threading.Thread(target=self._run, args=(i,), name=f"{name}-worker-{i}", daemon=True)
+            for i in range(self.workers)
+        ]
+        for t in self._threads:
+            t.start()
+        futures_logger.info(f"分片处理器已启动，工作线程数: {self.workers}")
+
+    @classmethod
+    def from_config(
+        cls,
+        processor_config: Dict[str, Any],
+        storage_base_path: str,
+        merge_callback: Optional[Callable[[List[Dict]], None]] = None,
+    ) -> "ShardedProcessor":
+        """按 processor 配置创建默认的 清洗 → 存储 分片处理器。"""
+        clean_config = processor_config.get("clean", {})
+
+        def clean_stage(_shard: int) -> Stage:
+            return DataCleaner(clean_config).clean
+
+        def storage_stage(_shard: int) -> Stage:
+            storage = FileStorage(base_path=storage_base_path)
+
+            def save(data_list: List[Dict]) -> List[Dict]:
+                storage.save(data_list)
+                return data_list
+            return save
+
+        return cls(
+            int(processor_config.get("workers", 1)),
+            [clean_stage, storage_stage],
+            queue_size=int(processor_config.get("worker_queue_size", 0)),
+            merge_callback=merge_callback,
+        )
+
+    def submit(self, data_list: List[Dict]) -> None:
+        """按合约分片投递一批行情（仅由分发循环单线程调用）。"""
+        if not data_list:
+            return
+        parts = _partition(data_list, self.workers)
+        self._seq += 1
+        seq = self._seq
+        targets = [i for i, part in enumerate(parts) if part]
+        if self._merger is not None:
+            self._merger.expect(seq, len(targets))
+        for i in targets:
+            self._queues[i].put((seq, parts[i]))
+
+    def flush(self) -> None:
+        """等待已投递的批次全部处理完毕。"""
+        for q in self._queues:
+            q.join()
+
+    def close(self) -> None:
+        """处理完剩余批次后停止工作线程。"""
+        for q in self._queues:
+            q.put(_STOP)
+        for t in self._threads:
+            t.join()
+        futures_logger.info(f"分片处理器已停止，各分片处理条数: {self._processed}")
+
+    def metrics(self) -> Dict[str, List[int]]:
+        """各分片积压批次数、已处理条数与异常次数。"""
+        return {
+            "backlog": [q.qsize() for q in self._queues],
+            "processed": list(self._processed),
+            "errors": list(self._errors),
+        }
+
+    def _run(self, shard: int) -> None:
+        register_current_thread(threading.current_thread().name, "PROCESSOR")
+        try:
+            self._consume(shard)
+        finally:
+            unregister_current_thread()
+
+    def _consume(self, shard: int) -> None:
+        q = self._queues[shard]
+        stages = self._stages[shard]
+        while True:
+            item = q.get()
+            try:
+                if item is _STOP:
+                    return
+                seq, data = item
+                data = run_stages(stages, data, f"分片 {shard}")
+                if data is None:
+                    self._errors[shard] += 1
+                elif data:
+                    self._processed[shard] += len(data)
+                if self._merger is not None:
+                    self._merger.deliver(seq, shard, data or [])
+            finally:
+                q.task_done()
+
+
+def create_sharded_processor(
+    processor_config: Dict[str, Any],
+    storage_base_path: str,
+    merge_callback: Optional[Callable[[List[Dict]], None]] = None,
+    native: Optional[bool] = None,
+):
+    """按 processor 配置创建默认 清洗 → 存储 分片处理器。
+
+    Args:
+        processor_config: processor 配置段（workers、worker_ring_size、worker_queue_size、clean）。
+        storage_base_path: CSV 根目录。
+        merge_callback: 需要全局流时传入；原生实现不回调 Python，此时总是使用 Python 实现。
+        native: 为 False 时强制使用 Python 实现；None 表示自动选择。
+
+    Returns:
+        native_pybind.ShardedTickWriter 或 ShardedProcessor（均提供 submit/flush/close/metrics）。
+    """
+    if native is not False and merge_callback is None:
+        m = get_native_pybind()
+        if m is not None and hasattr(m, "ShardedTickWriter"):
+            os.makedirs(storage_base_path, exist_ok=True)
+            workers = max(1, int(processor_config.get("workers", 1)))
+            writer = m.ShardedTickWriter(
+                workers,
+                storage_base_path,
+                max_seen_size=int((processor_config.get("clean") or {}).get("max_seen_size", 10000)),
+                ring_size=int(processor_config.get("worker_ring_size", 16384)),
+            )
+            futures_logger.info(f"原生分片落盘已启动，工作线程数: {workers}")
+            return writer
+    return ShardedProcessor.from_config(processor_config, storage_base_path, merge_callback)
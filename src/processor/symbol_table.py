@@ -0,0 +1,142 @@
+# -*- coding: utf-8 -*-
+"""合约符号表模块
+
+将各源定长原始合约字节（DCE/CZCE Symbol、GFEX contract_name 等）映射为稠密 int32
+合约 ID，解析/清洗/存储均以 ID 为键，合约字符串每个合约只解码一次。
+
+优先使用 native_pybind 的全局符号表（原生阶段与 Python 共享同一套 ID），
+未编译时回退为等价的纯 Python 实现。
+"""
+from typing import Any, Dict, List, Optional, Tuple, Union
+
+from src.utils.native_loader import get_native_pybind
+
+# 与 fq::kMaxSymbolLen / fq::kInvalidInstrument 保持一致
+MAX_SYMBOL_LEN = 31
+INVALID_INSTRUMENT = -1
+
+RawSymbol = Union[bytes, str]
+
+
+def normalize_symbol(raw: RawSymbol) -> str:
+    """规范化原始合约：遇 NUL 截断、按 GBK 解码并去掉首尾空白。
+
+    Args:
+        raw: 原始合约字节或字符串。
+
+    Returns:
+        规范化合约代码，可能为空串。
+    """
+    if isinstance(raw, (bytes, bytearray)):
+        nul = raw.find(b"\x00")
+        if nul >= 0:
+            raw = raw[:nul]
+        return bytes(raw).decode("gbk", errors="ignore").strip()
+    nul = raw.find("\x00")
+    if nul >= 0:
+        raw = raw[:nul]
+    return raw.strip()
+
+
+class SymbolTable:
+    """合约符号表：原始合约 -> (合约 ID, 合约代码)。"""
+
+    def __init__(self, native_table: Any = None, max_raw_cache: int = 262144):
+        """初始化符号表。
+
+        Args:
+            native_table: native_pybind.SymbolTable 实例；为 None 时使用纯 Python 实现。
+            max_raw_cache: 原始字节 -> 结果缓存的上限，防止异常输入无限增长。
+        """
+        self._native = native_table
+        self._max_raw_cache = max_raw_cache
+        # 原始字节/字符串 -> (id, name)，命中时无需解码与哈希规范化
+        self._raw_cache: Dict[RawSymbol, Tuple[int, str]] = {}
+        # 合约 ID -> 合约代码（Python 侧物化的字符串，按 ID 下标）
+        self._names: List[Optional[str]] = []
+        self._ids: Dict[str, int] = {}
+
+    @property
+    def is_native(self) -> bool:
+        """是否由 native_pybind 全局符号表支撑。"""
+        return self._native is not None
+
+    def resolve(self, raw: RawSymbol) -> Tuple[int, str]:
+        """解析原始合约，返回合约 ID 与规范化合约代码。
+
+        Args:
+            raw: 原始合约字节（定长、可能含 NUL 填充）或字符串。
+
+        Returns:
+            (instrument_id, symbol)；空串或超长合约的 ID 为 INVALID_INSTRUMENT。
+        """
+        hit = self._raw_cache.get(raw)
+        if hit is not None:
+            return hit
+        symbol = normalize_symbol(raw)
+        iid = self._intern_symbol(symbol)
+        if len(self._raw_cache) >= self._max_raw_cache:
+            self._raw_cache.clear()
+        result = (iid, symbol)
+        self._raw_cache[raw] = result
+        return result
+
+    def intern(self, raw: RawSymbol) -> int:
+        """查找或登记合约，返回合约 ID。"""
+        return self.resolve(raw)[0]
+
+    def find(self, symbol: str) -> int:
+        """只查不登记，未登记返回 INVALID_INSTRUMENT。"""
+        symbol = normalize_symbol(symbol)
+        if self._native is not None:
+            return self._native.find(symbol)
+        return self._ids.get(symbol, INVALID_INSTRUMENT)
+
+    def name(self, instrument_id: int) -> Optional[str]:
+        """合约 ID -> 合约代码，未知 ID 返回 None。"""
+        if 0 <= instrument_id < len(self._names):
+            cached = self._names[instrument_id]
+            if cached is not None:
+                return cached
+        if self._native is None:
+            return None
+        symbol = self._native.name(instrument_id)
+        if symbol is not None:
+            self._remember(instrument_id, symbol)
+        return symbol
+
+    def __len__(self) -> int:
+        if self._native is not None:
+            return len(self._native)
+        return len(self._ids)
+
+    def _intern_symbol(self, symbol: str) -> int:
+        if not symbol or len(symbol.encode("utf-8")) > MAX_SYMBOL_LEN:
+            return INVALID_INSTRUMENT
+        if self._native is not None:
+            iid = self._native.intern(symbol)
+        else:
+            iid = self._ids.get(symbol)
+            if iid is None:
+                iid = len(self._ids)
+                self._ids[symbol] = iid
+        if iid != INVALID_INSTRUMENT:
+            self._remember(iid, symbol)
+        return iid
+
+    def _remember(self, iid: int, symbol: str) -> None:
+        if iid >= len(self._names):
+            self._names.extend([None] * (iid + 1 - len(self._names)))
+        self._names[iid] = symbol
+
+
+_global_symbol_table: Optional[SymbolTable] = None
+
+
+def get_symbol_table() -> SymbolTable:
+    """获取进程级全局符号表（首次调用时按 native 配置决定实现）。"""
+    global _global_symbol_table
+    if _global_symbol_table is None:
+        native = get_native_pybind()
+        _global_symbol_table = SymbolTable(native.global_symbol_table() if native else None)
+    return _global_symbol_table
@@ -0,0 +1,153 @@
+# -*- coding: utf-8 -*-
+"""行情批次与惰性视图模块
+
+TickBatch 为定容行情批次，TickView 为批次中某一槽位的只读视图：
+- 属性访问（view.last_price 等）按需取值，热路径消费者只为读到的字段付费
+- 迭代批次时复用同一个视图对象（游标语义），无逐条分配；需要保留某条行情时
+  使用 batch[i] 或 view.to_dict()
+- to_dicts() / to_dict() 物化为 FUTURES_BASE_FIELDS dict，供既有 on_data_callback 使用
+
+native_pybind 可用时由原生批次直接在槽位上解码原始帧；否则回退为下面的纯 Python
+实现（内部仍为 dict，接口一致）。
+"""
+import ctypes
+import datetime
+from typing import Any, Dict, Iterator, List, Optional
+
+from src.utils.native_loader import get_native_pybind
+
+DEFAULT_BATCH_CAPACITY = 4096
+
+
+class StaleTickViewError(ValueError):
+    """视图所属批次已被 clear/swap，槽位可能已被复用。"""
+
+
+class TickView:
+    """纯 Python 行情视图：批次 + 下标 + generation。"""
+
+    __slots__ = ("_batch", "_index", "_generation")
+
+    def __init__(self, batch: "TickBatch", index: int):
+        self._batch = batch
+        self._index = index
+        self._generation = batch.generation
+
+    def _row(self) -> Dict[str, Any]:
+        batch = self._batch
+        if batch.generation != self._generation or self._index >= len(batch):
+            raise StaleTickViewError("TickView is stale: its batch has been cleared or swapped")
+        return batch._rows[self._index]
+
+    def __getattr__(self, name: str) -> Any:
+        if name.startswith("_"):
+            raise AttributeError(name)
+        try:
+            return self._row()[name]
+        except KeyError:
+            raise AttributeError(name) from None
+
+    def to_dict(self) -> Dict[str, Any]:
+        """物化为 FUTURES_BASE_FIELDS dict（副本）。"""
+        return dict(self._row())
+
+    def __repr__(self) -> str:
+        row = self._row()
+        return f"<TickView {row.get('symbol')} {row.get('last_price')} @{self._index}>"
+
+
+class TickBatch:
+    """纯 Python 定容行情批次，与 native_pybind.TickBatch 接口一致。"""
+
+    def __init__(self, capacity: int = DEFAULT_BATCH_CAPACITY):
+        self._capacity = max(1, int(capacity))
+        self._rows: List[Dict[str, Any]] = []
+        self.generation = 0
+
+    @property
+    def capacity(self) -> int:
+        return self._capacity
+
+    @property
+    def full(self) -> bool:
+        return len(self._rows) >= self._capacity
+
+    def __len__(self) -> int:
+        return len(self._rows)
+
+    def __getitem__(self, index: int) -> TickView:
+        n = len(self._rows)
+        if index < 0:
+            index += n
+        if index < 0 or index >= n:
+            raise IndexError("TickBatch index out of range")
+        return TickView(self, index)
+
+    def __iter__(self) -> Iterator[TickView]:
+        view = TickView(self, 0)
+        for i in range(len(self._rows)):
+            view._index = i
+            yield view
+
+    def append_dict(self, data: Dict[str, Any]) -> bool:
+        """追加一条已标准化的行情 dict；批次已满或缺少合约/datetime 时返回 False（与原生批次一致）。"""
+        if self.full or not data or not isinstance(data.get("datetime"), datetime.datetime):
+            return False
+        if data.get("instrument_id") is None and not data.get("symbol"):
+            return False
+        self._rows.append(data)
+        return True
+
+    def append_gfex_l2(self, raw: bytes) -> bool:
+        """解析一帧 NanoGfexL2MdType 并追加，已满或解析失败返回 False。"""
+        if self.full:
+            return False
+        from src.api.gfex_exanic_api import _parse_nano_l2_raw
+        from src.processor.data_parser import DataParser
+        frame = _parse_nano_l2_raw(raw)
+        return self.append_dict(DataParser._parse_gfex_l2(frame)) if frame else False
+
+    def append_dce_l1(self, raw: bytes) -> bool:
+        """解析一条 DCEL1_Quotation 并追加。"""
+        from src.api.zy_zmq_api import DCEL1_Quotation
+        from src.processor.data_parser import DataParser
+        if self.full or len(raw) != ctypes.sizeof(DCEL1_Quotation):
+            return False
+        return self.append_dict(DataParser._parse_dce_l1(DCEL1_Quotation.from_buffer_copy(raw)))
+
+    def append_czce_l1(self, raw: bytes) -> bool:
+        """解析一条 CZCEL2_Quotation 并追加。"""
+        from src.api.zy_zmq_api import CZCEL2_Quotation
+        from src.processor.data_parser import DataParser
+        if self.full or len(raw) != ctypes.sizeof(CZCEL2_Quotation):
+            return False
+        return self.append_dict(DataParser._parse_czce_l1(CZCEL2_Quotation.from_buffer_copy(raw)))
+
+    def to_dicts(self) -> List[Dict[str, Any]]:
+        """物化全部行情为 dict 列表。"""
+        return [dict(row) for row in self._rows]
+
+    def clear(self) -> None:
+        self._rows = []
+        self.generation += 1
+
+    def swap(self, other: "TickBatch") -> None:
+        """与另一批次交换内容（双缓冲），两边 generation 均递增。"""
+        self._rows, other._rows = other._rows, self._rows
+        self._capacity, other._capacity = other._capacity, self._capacity
+        self.generation += 1
+        other.generation += 1
+
+
+def new_tick_batch(capacity: int = DEFAULT_BATCH_CAPACITY, native: Optional[bool] = None):
+    """创建行情批次：native_pybind 可用时返回原生批次，否则返回纯 Python 实现。
+
+    Args:
+        capacity: 批次容量（条）。
+        native: 为 False 时强制使用纯 Python 实现；None 表示自动选择。
+    """
+    if native is not False:
+        m = get_native_pybind()
+        if m is not None and hasattr(m, "TickBatch"):
+            return m.TickBatch(capacity)
+    return TickBatch(capacity)
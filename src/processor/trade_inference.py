@@ -0,0 +1,221 @@
+# -*- coding: utf-8 -*-
+"""快照成交推断模块
+
+CTP/NSQ 等 L1 快照只给累计成交量（volume）与累计成交额（turnover），不给逐笔成交。
+相邻两帧的差值即为区间成交：
+- 数量 = Δvolume，成交均价 VWAP = Δturnover / (Δvolume × 合约乘数)
+- 主动方向按上一帧盘口判定：VWAP >= 卖一为买方主动，<= 买一为卖方主动（报价规则）；
+  盘口内与中间价比较（Lee-Ready）；恰在中间价或无盘口时按 tick 规则与上一笔不同价的成交比较，
+  平价沿用上一笔方向
+- 累计量回退或交易日变化（换日、重连）时只重建基准，不产生成交；交易日按交易所口径
+  （exchange_trading_day：夜盘归下一交易日），夜盘跨零点不算换日
+
+合约乘数可按品种在配置中给出（multipliers: {rb: 10}），未给出时由首笔成交估计。
+native_pybind 可用时使用 fq::TradeInference，否则使用等价的纯 Python 实现；
+两者输出的成交 dict 键与取值一致。
+"""
+import re
+from datetime import date, datetime, time, timedelta
+from typing import Any, Dict, List, Optional
+
+from src.utils.native_loader import get_native_pybind
+
+SIDE_BUY = "B"
+SIDE_SELL = "S"
+SIDE_UNKNOWN = ""
+
+_PRODUCT_RE = re.compile(r"^[A-Za-z]+")
+_NIGHT_START = time(18, 0)
+
+
+def exchange_trading_day(dt: datetime) -> date:
+    """行情时间 -> 交易所交易日：18:00 之后（夜盘）归下一自然日，落在周六、周日的顺延到周一（不含节假日）。
+
+    周五夜盘、跨零点后的周六凌晨与下周一日盘同属一个交易日，累计成交量连续。
+    """
+    day = dt.date()
+    if dt.time() >= _NIGHT_START:
+        day += timedelta(days=1)
+    weekday = day.weekday()
+    if weekday >= 5:
+        day += timedelta(days=7 - weekday)
+    return day
+
+
+def product_of(symbol: str) -> str:
+    """合约代码 -> 品种代码（rb2501 -> rb）。"""
+    m = _PRODUCT_RE.match(symbol or "")
+    return m.group(0) if m else ""
+
+
+class _State:
+    __slots__ = (
+        "trade_date", "volume", "turnover", "bid", "ask",
+        "last_trade_price", "prev_trade_price", "last_side", "multiplier",
+    )
+
+    def __init__(self, multiplier: float = 0.0):
+        self.trade_date = None
+        self.volume = 0
+        self.turnover = 0.0
+        self.bid = 0.0
+        self.ask = 0.0
+        self.last_trade_price = 0.0
+        self.prev_trade_price = 0.0
+        self.last_side = SIDE_UNKNOWN
+        self.multiplier = multiplier
+
+
+class TradeInference:
+    """按合约连续处理快照并推断区间成交（与 fq::TradeInference 一致）。"""
+
+    def __init__(self, capacity: int = 65536):
+        self.capacity = capacity
+        self._states: Dict[Any, _State] = {}
+        self._multipliers: Dict[Any, float] = {}
+
+    def set_multiplier(self, instrument_id: int, multiplier: float) -> None:
+        """指定合约乘数。"""
+        if multiplier > 0:
+            self._multipliers[instrument_id] = float(multiplier)
+            state = self._states.get(instrument_id)
+            if state is not None:
+                state.multiplier = float(multiplier)
+
+    def multiplier(self, instrument_id: int) -> float:
+        """已指定或已估计的合约乘数，未知为 0。"""
+        state = self._states.get(instrument_id)
+        if state is not None:
+            return state.multiplier
+        return self._multipliers.get(instrument_id, 0.0)
+
+    def infer(self, data_list: List[Dict]) -> List[Dict]:
+        """处理一批标准化行情，返回推断出的成交 dict 列表。"""
+        trades = []
+        for data in data_list:
+            trade = self._on_snapshot(data)
+            if trade is not None:
+                trades.append(trade)
+        return trades
+
+    def _on_snapshot(self, data: Dict) -> Optional[Dict]:
+        key = data.get("instrument_id")
+        if not isinstance(key, int) or key < 0:
+            key = data.get("symbol")
+        dt = data.get("datetime")
+        if key is None or dt is None:
+            return None
+        state = self._states.get(key)
+        had_prev = state is not None
+        if state is None:
+            state = self._states[key] = _State(self._multipliers.get(key, 0.0))
+        volume = int(data.get("volume") or 0)
+        turnover = float(data.get("turnover") or 0.0)
+        last_price = float(data.get("last_price") or 0.0)
+        dv = volume - state.volume
+        dturn = turnover - state.turnover
+        prev_bid, prev_ask = state.bid, state.ask
+        trade_date = exchange_trading_day(dt)
+        reset = had_prev and (dv < 0 or trade_date != state.trade_date)
+        state.trade_date = trade_date
+        state.volume = volume
+        state.turnover = turnover
+        bid = float(data.get("bid_price_1") or 0.0)
+        ask = float(data.get("ask_price_1") or 0.0)
+        if bid > 0:
+            state.bid = bid
+        if ask > 0:
+            state.ask = ask
+        if not had_prev or reset or dv <= 0:
+            return None
+
+        vwap = last_price
+        if dturn > 0:
+            if not state.multiplier > 0 and last_price > 0:
+                est = dturn / (dv * last_price)
+                state.multiplier = float(round(est)) if est >= 0.5 else est
+            if state.multiplier > 0:
+                vwap = dturn / (dv * state.multiplier)
+
+        side, rule = self._classify(state, vwap, prev_bid, prev_ask)
+        if vwap != state.last_trade_price:
+            state.prev_trade_price = state.last_trade_price
+            state.last_trade_price = vwap
+        state.last_side = side
+        return {
+            "symbol": data.get("symbol"),
+            "instrument_id": data.get("instrument_id"),
+            "exchange": data.get("exchange"),
+            "datetime": dt,
+            "event": "trade",
+            "price": vwap,
+            "volume": dv,
+            "turnover": dturn if dturn > 0 else 0.0,
+            "side": side,
+            "rule": rule,
+            "bid_price_1": prev_bid,
+            "ask_price_1": prev_ask,
+        }
+
+    @staticmethod
+    def _classify(state: _State, px: float, bid: float, ask: float):
+        if bid > 0 and ask > 0 and ask >= bid:
+            if px >= ask:
+                return SIDE_BUY, "quote"
+            if px <= bid:
+                return SIDE_SELL, "quote"
+            mid = 0.5 * (bid + ask)
+            if px > mid:
+                return SIDE_BUY, "mid"
+            if px < mid:
+                return SIDE_SELL, "mid"
+        ref = state.last_trade_price if px != state.last_trade_price else state.prev_trade_price
+        if ref > 0 and px > ref:
+            side = SIDE_BUY
+        elif ref > 0 and px < ref:
+            side = SIDE_SELL
+        else:
+            side = state.last_side
+        return side, ("tick" if side else "")
+
+
+class _ProductMultipliers:
+    """按品种配置的乘数在首次见到合约时下发给推断器（instrument_id 在运行时才分配）。"""
+
+    def __init__(self, engine, multipliers: Dict[str, float]):
+        self._engine = engine
+        self._multipliers = {str(k).lower(): float(v) for k, v in (multipliers or {}).items() if v}
+        self._seen = set()
+
+    def infer(self, data_list: List[Dict]) -> List[Dict]:
+        if self._multipliers:
+            for data in data_list:
+                iid = data.get("instrument_id")
+                if iid is None or iid in self._seen:
+                    continue
+                self._seen.add(iid)
+                mult = self._multipliers.get(product_of(data.get("symbol", "")).lower())
+                if mult and isinstance(iid, int) and iid >= 0:
+                    self._engine.set_multiplier(iid, mult)
+        return self._engine.infer(data_list)
+
+    def __getattr__(self, name):
+        return getattr(self._engine, name)
+
+
+def create_trade_inference(cfg: Optional[Dict[str, Any]] = None):
+    """按配置创建成交推断器（native 优先）。
+
+    Args:
+        cfg: 可选 multipliers（品种 -> 合约乘数）与 native（默认 True）。
+
+    Returns:
+        带 infer(data_list) -> List[Dict] 的推断器。
+    """
+    cfg = cfg or {}
+    m = get_native_pybind()
+    if cfg.get("native", True) and m is not None and hasattr(m, "TradeInference"):
+        engine = m.TradeInference()
+    else:
+        engine = TradeInference()
+    return _ProductMultipliers(engine, cfg.get("multipliers") or {})
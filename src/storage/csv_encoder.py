@@ -0,0 +1,96 @@
+# -*- coding: utf-8 -*-
+"""批量 CSV 编码模块
+
+FileStorage 原先逐条 open + csv.DictWriter + datetime.isoformat()，CSV 模式下 CPU 是瓶颈。
+编码器把一批标准化行情按 (合约, 交易日) 聚合到各文件的缓冲，返回 [(路径, 表头, 行)]，
+FileStorage 每批每个文件只打开、写入一次：
+- 输出与 csv.DictWriter 逐字节一致：列为各条记录自身的键（行情行去掉 NON_PERSISTED_FIELDS；
+  带 event 键的成交 / 告警等事件行原样保留，其 turnover 为区间成交额），
+  float 按 repr，其余按 str，None 为空，QUOTE_MINIMAL，行尾 \\r\\n；datetime 列为 isoformat()
+- 表头为该文件本批首条记录的键，仅在文件不存在时由调用方写入
+- 按 (合约, 交易日) 缓存的路径 / 文件缓冲在出现更晚的交易日后丢弃，长时间运行不随天数增长
+
+native_pybind 可用时使用 CsvEncoder（std::to_chars 最短往返浮点 + 按交易日缓存的日期前缀），
+否则使用基于 csv 模块的等价实现。
+"""
+import csv
+import io
+import os
+from datetime import datetime
+from typing import Any, Dict, List, Tuple
+
+from src.utils.native_loader import get_native_pybind
+
+# 进程内合约 ID 仅用于内存中的键；累计成交额仅供成交推断使用。二者在行情行中均不落盘，保持 CSV 列不变。
+# 以 fq::kCsvNonPersistedFields 为准（见 non_persisted_fields），此处仅为未编译原生模块时的同值回退
+NON_PERSISTED_FIELDS = ("instrument_id", "turnover")
+
+
+def non_persisted_fields() -> Tuple[str, ...]:
+    """行情行不落盘的列：native_pybind 可用时取其 CSV_NON_PERSISTED_FIELDS，否则为 NON_PERSISTED_FIELDS。"""
+    m = get_native_pybind()
+    return tuple(getattr(m, "CSV_NON_PERSISTED_FIELDS", NON_PERSISTED_FIELDS))
+
+
+def persisted_row(data: Dict, non_persisted: Tuple[str, ...] = NON_PERSISTED_FIELDS) -> Dict:
+    """落盘的列：行情行去掉 non_persisted，事件行（含 event 键）保留全部列。"""
+    if "event" in data:
+        return dict(data)
+    return {k: v for k, v in data.items() if k not in non_persisted}
+
+
+class CsvEncoder:
+    """基于 csv 模块的批量编码器（与原生 CsvEncoder 输出一致）。"""
+
+    def __init__(self, base_path: str):
+        self.base_path = base_path
+        self._non_persisted = non_persisted_fields()
+        # (合约代码, 交易日) -> 文件路径，避免逐条格式化日期与拼接路径；出现更晚的交易日时丢弃更早的
+        self._path_cache: Dict[Tuple[Any, Any], str] = {}
+        self._latest_day = None
+
+    @property
+    def cached_files(self) -> int:
+        """当前缓存的 (合约, 交易日) 文件数。"""
+        return len(self._path_cache)
+
+    def _file_path(self, symbol: Any, dt: datetime) -> str:
+        day = dt.date()
+        cache_key = (symbol, day)
+        file_path = self._path_cache.get(cache_key)
+        if file_path is None:
+            if self._latest_day is None or day > self._latest_day:
+                self._latest_day = day
+                self._path_cache = {k: v for k, v in self._path_cache.items() if k[1] >= day}
+            file_path = os.path.join(self.base_path, f"{symbol}_{dt.strftime('%Y%m%d')}.csv")
+            self._path_cache[cache_key] = file_path
+        return file_path
+
+    def encode(self, data_list: List[Dict]) -> List[Tuple[str, bytes, bytes]]:
+        """编码一批标准化行情，返回 [(文件路径, 表头, 行)]（按文件首次出现顺序）。"""
+        files: Dict[str, Tuple[str, io.StringIO, Any]] = {}
+        for data in data_list:
+            if isinstance(data.get("datetime"), str):
+                data["datetime"] = datetime.fromisoformat(data["datetime"])
+            file_path = self._file_path(data.get("symbol", "unknown"), data["datetime"])
+            row = persisted_row(data, self._non_persisted)
+            row["datetime"] = data["datetime"].isoformat()
+            entry = files.get(file_path)
+            if entry is None:
+                header = io.StringIO()
+                csv.writer(header).writerow(row.keys())
+                body = io.StringIO()
+                entry = files[file_path] = (header.getvalue(), body, csv.writer(body))
+            entry[2].writerow(row.values())
+        return [
+            (path, header.encode("utf-8"), body.getvalue().encode("utf-8"))
+            for path, (header, body, _) in files.items()
+        ]
+
+
+def create_csv_encoder(base_path: str, native: bool = True):
+    """创建 CSV 编码器（native 优先）。"""
+    m = get_native_pybind()
+    if native and m is not None and hasattr(m, "CsvEncoder"):
+        return m.CsvEncoder(base_path)
+    return CsvEncoder(base_path)
@@ -0,0 +1,119 @@
+# -*- coding: utf-8 -*-
+"""CSV 归档批量导入模块
+
+把 FileStorage 写出的 <base>/<合约>_<YYYYMMDD>.csv 历史归档按交易日转为带合约索引的行情日文件
+（<dst>/<YYYYMMDD>.fqt，见 tick_file），研究与回测读取历史数据与新数据一样走 mmap + numpy。
+- 原生实现（native_pybind.import_csv_day）在释放 GIL 的线程池上每个文件一个任务并行解析
+  （SSE2 定位分隔符，std::from_chars 解析数值），按时间归并后写出，输出与 build_day_file 逐字节一致
+- 纯 Python 实现按交易日分派到 fork 子进程，每个进程调用 build_day_file
+- 原生导入时列数不符、数值或时间无法解析的行被跳过并计入 rejected，文件内时间乱序的行稳定排序并计入
+  out_of_order；纯 Python 实现同样排序，但遇到无法解析的行抛出 StorageError
+
+命令行：python -m src.storage.csv_import <CSV 目录> <输出目录> [--workers N] [--dates 20250129 ...]
+"""
+import argparse
+import multiprocessing
+import os
+import re
+import time
+from collections import defaultdict
+from typing import Any, Dict, List, Optional
+
+from src.storage.tick_file import build_day_file
+from src.utils import futures_logger
+from src.utils.exceptions import StorageError
+from src.utils.native_loader import get_native_pybind
+
+_CSV_NAME = re.compile(r"^(?P<symbol>.+)_(?P<date>\d{8})\.csv$")
+STAT_KEYS = ("files", "failed_files", "rows", "rejected", "out_of_order", "bytes")
+
+
+def scan_archive(src_dir: str) -> Dict[str, List[str]]:
+    """交易日 -> 该日的合约列表（按合约代码排序，与 FileStorage.load_day 一致）。"""
+    days: Dict[str, List[str]] = defaultdict(list)
+    try:
+        names = os.listdir(src_dir)
+    except OSError as e:
+        raise StorageError(f"读取 CSV 目录失败: {src_dir}: {e}") from e
+    for name in names:
+        m = _CSV_NAME.match(name)
+        if m:
+            days[m.group("date")].append(m.group("symbol"))
+    return {date: sorted(symbols) for date, symbols in sorted(days.items())}
+
+
+def _import_day_python(args) -> Dict[str, Any]:
+    src_dir, date, symbols, out_path = args
+    paths = [os.path.join(src_dir, f"{s}_{date}.csv") for s in symbols]
+    rows = build_day_file(src_dir, date, out_path, symbols)
+    return {"files": len(paths), "rows": rows, "bytes": sum(os.path.getsize(p) for p in paths)}
+
+
+def import_archive(
+    src_dir: str,
+    dst_dir: str,
+    workers: int = 0,
+    dates: Optional[List[str]] = None,
+    native: bool = True,
+) -> Dict[str, Any]:
+    """导入 CSV 归档，返回汇总统计（files、rows、rejected、out_of_order、bytes、days、elapsed、mb_per_s）。
+
+    Args:
+        src_dir: FileStorage 的 base_path。
+        dst_dir: 日文件输出目录。
+        workers: 解析线程（原生）或进程（纯 Python）数，0 为 CPU 核数。
+        dates: 只导入这些交易日（YYYYMMDD），默认全部。
+        native: native_pybind 可用时是否使用原生导入。
+
+    Raises:
+        StorageError: 目录不可读或日文件写出失败时抛出。
+    """
+    days = scan_archive(src_dir)
+    if dates is not None:
+        wanted = set(dates)
+        days = {d: s for d, s in days.items() if d in wanted}
+    os.makedirs(dst_dir, exist_ok=True)
+    workers = int(workers) or os.cpu_count() or 1
+    totals: Dict[str, Any] = {k: 0 for k in STAT_KEYS}
+    m = get_native_pybind()
+    t0 = time.perf_counter()
+    tasks = [(src_dir, date, symbols, os.path.join(dst_dir, f"{date}.fqt")) for date, symbols in days.items()]
+    if native and m is not None and hasattr(m, "import_csv_day"):
+        for _, date, symbols, out_path in tasks:
+            paths = [os.path.join(src_dir, f"{s}_{date}.csv") for s in symbols]
+            try:
+                stats = m.import_csv_day(paths, symbols, out_path, workers)
+            except RuntimeError as e:
+                raise StorageError(f"导入 {date} 失败: {e}") from e
+            for k in STAT_KEYS:
+                totals[k] += stats.get(k, 0)
+    elif tasks:
+        ctx = multiprocessing.get_context("fork")
+        with ctx.Pool(max(1, min(workers, len(tasks)))) as pool:
+            for stats in pool.imap_unordered(_import_day_python, tasks):
+                for k, v in stats.items():
+                    totals[k] += v
+    elapsed = time.perf_counter() - t0
+    totals["days"] = len(tasks)
+    totals["elapsed"] = elapsed
+    totals["mb_per_s"] = totals["bytes"] / 1e6 / elapsed if elapsed > 0 else 0.0
+    futures_logger.info(
+        f"CSV 归档导入完成: {len(tasks)} 个交易日，{totals['files']} 个文件，{totals['rows']} 行"
+        f"（跳过 {totals['rejected']}），{totals['mb_per_s']:.1f} MB/s"
+    )
+    return totals
+
+
+def main(argv: Optional[List[str]] = None) -> None:
+    parser = argparse.ArgumentParser(description="FileStorage CSV 归档 -> 行情日文件（.fqt）")
+    parser.add_argument("src_dir", help="CSV 目录（storage.file.base_path）")
+    parser.add_argument("dst_dir", help="日文件输出目录")
+    parser.add_argument("--workers", type=int, default=0, help="并行度，0 为 CPU 核数")
+    parser.add_argument("--dates", nargs="*", default=None, help="只导入这些交易日（YYYYMMDD）")
+    parser.add_argument("--python", action="store_true", help="不使用原生导入")
+    args = parser.parse_args(argv)
+    import_archive(args.src_dir, args.dst_dir, args.workers, args.dates, native=not args.python)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,28 +1,38 @@
 # -*- coding: utf-8 -*-
 """文件存储模块。
 
-按天按合约将标准化行情写入本地 CSV，路径与格式由配置决定。
+按天按合约将标准化行情写入本地 CSV，路径与格式由配置决定；
+每批按文件聚合编码（见 csv_encoder），每个文件只打开、写入一次；
+load()/load_day() 按相同布局读回（回测使用）。
 """
 import os
 import csv
-from typing import List, Dict
+from datetime import datetime
+from typing import Any, Dict, List, Optional
 
+from src.storage.csv_encoder import create_csv_encoder
 from src.utils import futures_logger
 from src.utils.exceptions import StorageError
 
+# 读回时按整数解析的列，其余除 symbol/exchange/datetime 外按浮点解析
+_INT_FIELDS = ("volume", "bid_volume_1", "ask_volume_1")
+_STR_FIELDS = ("symbol", "exchange")
+
 
 class FileStorage:
     """本地文件存储实现：按天按合约追加 CSV。"""
 
-    def __init__(self, base_path: str = "data/market_data"):
+    def __init__(self, base_path: str = "data/market_data", native: bool = True):
         """初始化存储目录。
 
         Args:
             base_path: 存储根目录（相对项目根或绝对路径）。
+            native: native_pybind 可用时是否使用原生 CSV 编码器。
         """
         self.base_path = base_path
         if not os.path.exists(base_path):
             os.makedirs(base_path)
+        self._encoder = create_csv_encoder(base_path, native=native)
 
     def save(self, data_list: List[Dict]) -> None:
         """将标准化行情按天按合约追加写入 CSV。
@@ -35,28 +45,71 @@ class FileStorage:
         """
         if not data_list:
             return
-        for data in data_list:
+        try:
+            chunks = self._encoder.encode(data_list)
+        except Exception as e:
+            futures_logger.error(f"保存数据失败: {e}", exc_info=True)
+            raise StorageError(f"保存数据失败: {e}") from e
+        for file_path, header, body in chunks:
             try:
-                if isinstance(data.get("datetime"), str):
-                    from datetime import datetime
-                    data["datetime"] = datetime.fromisoformat(data["datetime"])
-                date_str = data["datetime"].strftime("%Y%m%d")
-                symbol = data.get("symbol", "unknown")
-                file_path = os.path.join(self.base_path, f"{symbol}_{date_str}.csv")
                 file_exists = os.path.exists(file_path)
-                with open(file_path, "a", newline="", encoding="utf-8") as f:
-                    writer = csv.DictWriter(f, fieldnames=data.keys())
-                    if not file_exists:
-                        writer.writeheader()
-                    save_data = data.copy()
-                    save_data["datetime"] = data["datetime"].isoformat()
-                    writer.writerow(save_data)
-                futures_logger.debug(
-                    f"已保存数据到: {file_path} - {symbol}, 价格: {data.get('last_price', 0)}"
-                )
+                with open(file_path, "ab") as f:
+                    f.write(body if file_exists else header + body)
+                futures_logger.debug(f"已保存数据到: {file_path} - {len(body)} 字节")
             except OSError as e:
                 futures_logger.error(f"保存数据失败: {e}", exc_info=True)
                 raise StorageError(f"文件写入失败: {e}") from e
-            except Exception as e:
-                futures_logger.error(f"保存数据失败: {e}", exc_info=True)
-                raise StorageError(f"保存数据失败: {e}") from e
+
+    def load(self, symbol: str, trade_date: str) -> List[Dict]:
+        """读回某合约某日的 CSV，恢复字段类型并分配 instrument_id（按写入顺序返回）。
+
+        Args:
+            symbol: 合约代码。
+            trade_date: 日期 YYYYMMDD（与文件名一致）。
+
+        Returns:
+            标准化行情字典列表；文件不存在返回空列表。
+        """
+        from src.processor.symbol_table import get_symbol_table
+
+        file_path = os.path.join(self.base_path, f"{symbol}_{trade_date}.csv")
+        if not os.path.exists(file_path):
+            return []
+        instrument_id = get_symbol_table().intern(symbol)
+        rows: List[Dict] = []
+        try:
+            with open(file_path, newline="", encoding="utf-8") as f:
+                for row in csv.DictReader(f):
+                    data: Dict[str, Any] = {}
+                    for k, v in row.items():
+                        if k in _STR_FIELDS:
+                            data[k] = v
+                        elif k == "datetime":
+                            data[k] = datetime.fromisoformat(v)
+                        elif k in _INT_FIELDS:
+                            data[k] = int(float(v or 0))
+                        else:
+                            data[k] = float(v or 0.0)
+                    data["instrument_id"] = instrument_id
+                    rows.append(data)
+        except (OSError, ValueError) as e:
+            raise StorageError(f"读取行情文件失败: {file_path}: {e}") from e
+        return rows
+
+    def load_day(self, trade_date: str, symbols: Optional[List[str]] = None) -> Dict[str, List[Dict]]:
+        """读回某日全部（或指定）合约的行情：合约代码 -> 按时间有序的行情列表。
+
+        文件按写入顺序追加，乱序到达（多源、重连补发）的行情在文件中也是乱序的，
+        这里按 datetime 稳定排序，同一时刻保持写入顺序。
+        """
+        if symbols is None:
+            suffix = f"_{trade_date}.csv"
+            symbols = sorted(
+                name[: -len(suffix)] for name in os.listdir(self.base_path) if name.endswith(suffix)
+            )
+        day = {}
+        for symbol in symbols:
+            rows = self.load(symbol, trade_date)
+            rows.sort(key=lambda d: d["datetime"])
+            day[symbol] = rows
+        return day
@@ -0,0 +1,674 @@
+# -*- coding: utf-8 -*-
+"""存储后端基准与对比
+
+在同一份行情上依次运行各存储后端的写入与读取，输出对比报告，作为更换落盘格式前的依据：
+- 行情来源：按品种最小变动价位、交易时段与 500ms 快照节奏生成的多合约交易日（generate_day），
+  或 FileStorage 目录中的录制数据（load_replay）
+- 后端：FileStorage CSV（纯 Python / 原生编码器）、Parquet（需 pyarrow）、二进制 journal
+  （每批追加 TICK_DTYPE 记录，收盘时建索引转为 .fqt）以及 .fqt / CSV 的压缩归档（gzip、xz，zstd 需 zstandard）
+- 写入：同样的批大小逐批写入全新目录，统计墙钟吞吐、每条 CPU 时间（进程级，含原生线程）与每条落盘字节；
+  fsync 模式下每批写完对涉及的文件 fsync，再跑一遍得到 fsync 吞吐与相对降幅（Parquet 未满的行组只在内存中，
+  fsync 只覆盖已写出的行组，报告中标注为不可比）
+- 读取：四种查询形态各取 repeat 次中的最快一次——replay（全天按时间物化为 dict）、symbol（单合约全天）、
+  window（全部合约的一段时间窗，各后端都按完整时间戳 [start, end) 判定，跨零点一致）、column（全天 last_price 单列扫描）；cold 模式下每次读取前对文件
+  fsync + POSIX_FADV_DONTNEED 丢弃页缓存（无需 root）。各后端的结果行数互相校验
+
+命令行：python -m src.storage.storage_bench [--symbols 20] [--ticks 10000] [--batch 256] [--dir /data/bench]
+        [--replay CSV目录 --date 20250129] [--backends csv_python fqt ...] [--cold] [--out report.md] [--json r.json]
+"""
+import argparse
+import gzip
+import heapq
+import importlib
+import importlib.util
+import json
+import lzma
+import os
+import shutil
+import tempfile
+import time
+from datetime import datetime, timedelta
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+import numpy as np
+
+from src.processor.symbol_table import get_symbol_table
+from src.storage.file_storage import FileStorage
+from src.storage.tick_file import TICK_DTYPE, TickFile, records_from_dicts, write_records
+from src.utils import futures_logger
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+
+# (品种, 交易所, 最小变动价位, 基准价, 合约乘数)
+PRODUCTS = (
+    ("rb", "SHFE", 1.0, 3500.0, 10),
+    ("cu", "SHFE", 10.0, 75000.0, 5),
+    ("au", "SHFE", 0.02, 620.0, 1000),
+    ("sc", "INE", 0.1, 550.0, 1000),
+    ("i", "DCE", 0.5, 800.0, 100),
+    ("m", "DCE", 1.0, 3000.0, 10),
+    ("SR", "CZCE", 1.0, 6000.0, 10),
+    ("TA", "CZCE", 2.0, 5800.0, 5),
+    ("si", "GFEX", 5.0, 11000.0, 5),
+    ("IF", "CFFEX", 0.2, 3900.0, 300),
+)
+CONTRACT_MONTHS = ("2505", "2509", "2601", "2507")
+# 交易时段（时, 分）起止；夜盘按同一自然日编码，保证每合约每日一个文件
+COMMODITY_SESSIONS = (((9, 0), (10, 15)), ((10, 30), (11, 30)), ((13, 30), (15, 0)), ((21, 0), (23, 0)))
+CFFEX_SESSIONS = (((9, 30), (11, 30)), ((13, 0), (15, 0)))
+SNAPSHOT_US = 500000
+QUERY_SHAPES = ("replay", "symbol", "window", "column")
+WINDOW_US = 5 * 60 * 1000000
+DEFAULT_BACKENDS = ("csv_python", "csv_native", "parquet", "fqt", "fqt.gz", "fqt.xz", "fqt.zst", "csv.gz")
+
+
+def _contract(product: str, exchange: str, month: str) -> str:
+    return product + (month[1:] if exchange == "CZCE" else month)
+
+
+def _session_slots(exchange: str) -> np.ndarray:
+    """交易时段内每个 500ms 快照位置相对当日 0 点的微秒数。"""
+    sessions = CFFEX_SESSIONS if exchange == "CFFEX" else COMMODITY_SESSIONS
+    parts = [
+        np.arange((h0 * 60 + m0) * 60 * 1000000, (h1 * 60 + m1) * 60 * 1000000, SNAPSHOT_US, dtype=np.int64)
+        for (h0, m0), (h1, m1) in sessions
+    ]
+    return np.concatenate(parts)
+
+
+def generate_day(symbols: int = 20, ticks: int = 10000, trade_date: str = "20250129", seed: int = 1) -> List[Dict]:
+    """生成一个多合约交易日的标准化行情（按时间归并，键顺序与 DataParser 一致）。
+
+    Args:
+        symbols: 合约数（按 PRODUCTS × CONTRACT_MONTHS 依次取）。
+        ticks: 每合约行情条数（不超过交易时段内的快照位置数）。
+        trade_date: 行情日期 YYYYMMDD。
+        seed: 随机种子，相同参数生成相同数据。
+
+    Raises:
+        ConfigError: 合约数超出可生成范围或参数非正时抛出。
+    """
+    if symbols <= 0 or ticks <= 0 or symbols > len(PRODUCTS) * len(CONTRACT_MONTHS):
+        raise ConfigError(f"无法生成 {symbols} 个合约 × {ticks} 条行情")
+    rng = np.random.default_rng(seed)
+    day = datetime.strptime(trade_date, "%Y%m%d")
+    table = get_symbol_table()
+    streams = []
+    for k in range(symbols):
+        product, exchange, tick_size, base, multiplier = PRODUCTS[k % len(PRODUCTS)]
+        symbol = _contract(product, exchange, CONTRACT_MONTHS[k // len(PRODUCTS)])
+        slots = _session_slots(exchange)
+        n = min(ticks, len(slots))
+        times = np.sort(rng.choice(slots, n, replace=False)) + rng.integers(0, SNAPSHOT_US // 1000, n) * 1000
+        steps = rng.choice((-1, 0, 0, 0, 1), n).cumsum()
+        last = base + tick_size * steps
+        volume = rng.geometric(0.15, n).cumsum()
+        turnover = (np.diff(volume, prepend=0) * last * multiplier).cumsum()
+        oi = 100000 + rng.integers(-20, 21, n).cumsum()
+        bid = last - tick_size * (rng.random(n) < 0.5)
+        rows = []
+        high = low = float(last[0])
+        instrument_id = table.intern(symbol)
+        pre_close = base + tick_size * int(rng.integers(-20, 21))
+        for i in range(n):
+            price = float(last[i])
+            high, low = max(high, price), min(low, price)
+            rows.append({
+                "symbol": symbol,
+                "instrument_id": instrument_id,
+                "exchange": exchange,
+                "last_price": round(price, 4),
+                "volume": int(volume[i]),
+                "turnover": float(turnover[i]),
+                "open_interest": float(oi[i]),
+                "datetime": day + timedelta(microseconds=int(times[i])),
+                "bid_price_1": round(float(bid[i]), 4),
+                "bid_volume_1": int(rng.integers(1, 300)),
+                "ask_price_1": round(float(bid[i]) + tick_size, 4),
+                "ask_volume_1": int(rng.integers(1, 300)),
+                "open_price": round(float(last[0]), 4),
+                "high_price": round(high, 4),
+                "low_price": round(low, 4),
+                "pre_close": round(pre_close, 4),
+                "pre_settlement": round(pre_close + tick_size, 4),
+            })
+        streams.append(rows)
+    return list(heapq.merge(*streams, key=lambda d: d["datetime"]))
+
+
+def load_replay(base_path: str, trade_date: str) -> List[Dict]:
+    """读取 FileStorage 目录中某日的录制行情（按时间归并）。"""
+    day = FileStorage(base_path=base_path).load_day(trade_date)
+    return list(heapq.merge(*(sorted(r, key=lambda d: d["datetime"]) for r in day.values() if r),
+                            key=lambda d: d["datetime"]))
+
+
+def _sync_paths(paths) -> None:
+    for path in paths:
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+
+
+def _dir_files(path: str) -> List[str]:
+    return [os.path.join(root, name) for root, _, names in os.walk(path) for name in names]
+
+
+def drop_page_cache(path: str) -> None:
+    """写回并丢弃目录下文件的页缓存，使下一次读取从磁盘开始。"""
+    for file_path in _dir_files(path):
+        fd = os.open(file_path, os.O_RDONLY)
+        try:
+            os.fsync(fd)
+            os.posix_fadvise(fd, 0, 0, os.POSIX_FADV_DONTNEED)
+        finally:
+            os.close(fd)
+
+
+class StorageBackend:
+    """后端接口：open -> write（逐批）-> close 写出一天；四种查询读回同一天并返回行数（column 返回均值）。"""
+
+    name = ""
+    # 每批 fsync 是否让该批全部落盘；否则 fsync 吞吐与其他后端不可比
+    fsync_comparable = True
+
+    def unavailable(self) -> Optional[str]:
+        """不可用时返回原因（依赖缺失等）。"""
+        return None
+
+    def open(self, path: str, trade_date: str, fsync: bool) -> None:
+        self.path, self.trade_date, self.fsync = path, trade_date, fsync
+
+    def write(self, batch: List[Dict]) -> None:
+        raise NotImplementedError
+
+    def close(self) -> None:
+        pass
+
+    def replay(self) -> int:
+        raise NotImplementedError
+
+    def symbol(self, symbol: str) -> int:
+        raise NotImplementedError
+
+    def window(self, start: datetime, end: datetime) -> int:
+        """时间戳落在 [start, end) 内的行数（完整日期 + 时间，非当日时刻）。"""
+        raise NotImplementedError
+
+    def column(self) -> float:
+        raise NotImplementedError
+
+
+def _time_us(dt: datetime) -> int:
+    return ((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1000000 + dt.microsecond
+
+
+def _sorted_position(records: np.ndarray, dt: datetime) -> int:
+    """按 (trade_date, time_us) 有序的记录中第一条不早于 dt 的下标。"""
+    dates = records["trade_date"]
+    day = dt.year * 10000 + dt.month * 100 + dt.day
+    lo, hi = np.searchsorted(dates, day, "left"), np.searchsorted(dates, day, "right")
+    return int(lo + np.searchsorted(records["time_us"][lo:hi], _time_us(dt)))
+
+
+class CsvBackend(StorageBackend):
+    """FileStorage：每合约每日一个 CSV，逐批追加；读回走 FileStorage.load / load_day。"""
+
+    def __init__(self, native: bool):
+        self.native = native
+        self.name = "csv_native" if native else "csv_python"
+
+    def unavailable(self) -> Optional[str]:
+        m = get_native_pybind()
+        if self.native and (m is None or not hasattr(m, "CsvEncoder")):
+            return "native_pybind.CsvEncoder 不可用"
+        return None
+
+    def open(self, path: str, trade_date: str, fsync: bool) -> None:
+        super().open(path, trade_date, fsync)
+        self.storage = FileStorage(base_path=path, native=self.native)
+        self._paths: Dict[str, str] = {}
+
+    def write(self, batch: List[Dict]) -> None:
+        self.storage.save(batch)
+        if self.fsync:
+            touched = set()
+            for d in batch:
+                symbol = d["symbol"]
+                path = self._paths.get(symbol)
+                if path is None:
+                    path = self._paths[symbol] = os.path.join(self.path, f"{symbol}_{self.trade_date}.csv")
+                touched.add(path)
+            _sync_paths(touched)
+
+    def _day(self) -> Dict[str, List[Dict]]:
+        return FileStorage(base_path=self.path, native=False).load_day(self.trade_date)
+
+    def replay(self) -> int:
+        return sum(1 for _ in heapq.merge(*self._day().values(), key=lambda d: d["datetime"]))
+
+    def symbol(self, symbol: str) -> int:
+        return len(FileStorage(base_path=self.path, native=False).load(symbol, self.trade_date))
+
+    def window(self, start: datetime, end: datetime) -> int:
+        return sum(start <= d["datetime"] < end for rows in self._day().values() for d in rows)
+
+    def column(self) -> float:
+        prices = [d["last_price"] for rows in self._day().values() for d in rows]
+        return float(np.mean(prices)) if prices else 0.0
+
+
+class JournalBackend(StorageBackend):
+    """二进制 journal：每批按列填充 TICK_DTYPE 记录后追加到当日 journal，收盘时建合约索引写成 .fqt 并删除 journal。"""
+
+    name = "fqt"
+
+    def open(self, path: str, trade_date: str, fsync: bool) -> None:
+        super().open(path, trade_date, fsync)
+        os.makedirs(path, exist_ok=True)
+        self._journal_path = os.path.join(path, f"{trade_date}.journal")
+        self._journal = open(self._journal_path, "ab")
+        self._file_ids: Dict[str, int] = {}
+        self.day_path = os.path.join(path, f"{trade_date}.fqt")
+
+    def write(self, batch: List[Dict]) -> None:
+        self._journal.write(records_from_dicts(batch, self._file_ids).tobytes())
+        if self.fsync:
+            self._journal.flush()
+            os.fsync(self._journal.fileno())
+
+    def close(self) -> None:
+        self._journal.close()
+        records = np.fromfile(self._journal_path, dtype=TICK_DTYPE)
+        order = np.lexsort((records["time_us"], records["trade_date"]))
+        write_records(self.day_path, records[order], list(self._file_ids))
+        if self.fsync:
+            _sync_paths([self.day_path])
+        os.remove(self._journal_path)
+
+    def _read(self, fn: Callable[[TickFile], Any]):
+        tf = TickFile(os.path.join(self.path, f"{self.trade_date}.fqt"))
+        try:
+            return fn(tf)
+        finally:
+            tf.close()
+
+    def replay(self) -> int:
+        return self._read(lambda tf: sum(1 for _ in tf.iter_dicts()))
+
+    def symbol(self, symbol: str) -> int:
+        return self._read(lambda tf: len(tf.select(symbol)))
+
+    def window(self, start: datetime, end: datetime) -> int:
+        return self._read(lambda tf: _sorted_position(tf.records, end) - _sorted_position(tf.records, start))
+
+    def column(self) -> float:
+        return self._read(lambda tf: float(tf.records["last_price"].mean()) if len(tf) else 0.0)
+
+
+def _zstd_codec():
+    zstd = importlib.import_module("zstandard")
+    return (lambda src, dst: zstd.ZstdCompressor(level=3).copy_stream(src, dst),
+            lambda src, dst: zstd.ZstdDecompressor().copy_stream(src, dst))
+
+
+def _stream_codec(module, **kw):
+    def compress(src, dst):
+        with module.open(dst, "wb", **kw) as out:
+            shutil.copyfileobj(src, out, 1 << 20)
+
+    def decompress(src, dst):
+        with module.open(src, "rb") as inp:
+            shutil.copyfileobj(inp, dst, 1 << 20)
+    return compress, decompress
+
+
+# 压缩归档编码：后缀 -> (依赖模块, 编解码器工厂)
+CODECS: Dict[str, Tuple[Optional[str], Callable]] = {
+    "gz": (None, lambda: _stream_codec(gzip, compresslevel=6)),
+    "xz": (None, lambda: _stream_codec(lzma, preset=6)),
+    "zst": ("zstandard", _zstd_codec),
+}
+
+
+class ArchiveBackend(StorageBackend):
+    """压缩归档：内层后端写完一天后逐文件压缩并删除原文件；读取时先解压到临时目录再交给内层后端。"""
+
+    def __init__(self, inner: StorageBackend, codec: str):
+        self.inner, self.codec = inner, codec
+        self.name = f"{'csv' if isinstance(inner, CsvBackend) else inner.name}.{codec}"
+
+    def unavailable(self) -> Optional[str]:
+        module = CODECS[self.codec][0]
+        if module is not None and importlib.util.find_spec(module) is None:
+            return f"{module} 未安装"
+        return self.inner.unavailable()
+
+    def open(self, path: str, trade_date: str, fsync: bool) -> None:
+        super().open(path, trade_date, fsync)
+        self._compress, self._decompress = CODECS[self.codec][1]()
+        self.inner.open(os.path.join(path, "raw"), trade_date, fsync)
+
+    def write(self, batch: List[Dict]) -> None:
+        self.inner.write(batch)
+
+    def close(self) -> None:
+        self.inner.close()
+        raw = self.inner.path
+        for name in sorted(os.listdir(raw)):
+            dst_path = os.path.join(self.path, f"{name}.{self.codec}")
+            with open(os.path.join(raw, name), "rb") as src, open(dst_path, "wb") as dst:
+                self._compress(src, dst)
+                if self.fsync:
+                    dst.flush()
+                    os.fsync(dst.fileno())
+        shutil.rmtree(raw)
+
+    def _query(self, fn: Callable[[StorageBackend], Any]):
+        scratch = tempfile.mkdtemp(prefix="unpack_", dir=self.path)
+        try:
+            suffix = "." + self.codec
+            for name in os.listdir(self.path):
+                if name.endswith(suffix):
+                    with open(os.path.join(self.path, name), "rb") as src, \
+                            open(os.path.join(scratch, name[: -len(suffix)]), "wb") as dst:
+                        self._decompress(src, dst)
+            self.inner.path = scratch
+            return fn(self.inner)
+        finally:
+            shutil.rmtree(scratch)
+
+    def replay(self) -> int:
+        return self._query(lambda b: b.replay())
+
+    def symbol(self, symbol: str) -> int:
+        return self._query(lambda b: b.symbol(symbol))
+
+    def window(self, start: datetime, end: datetime) -> int:
+        return self._query(lambda b: b.window(start, end))
+
+    def column(self) -> float:
+        return self._query(lambda b: b.column())
+
+
+class ParquetBackend(StorageBackend):
+    """Parquet：流式写入，每累计 row_group 行写一个行组；查询按列裁剪、按谓词下推过滤。"""
+
+    name = "parquet"
+    fsync_comparable = False  # 未满的行组在内存中，每批 fsync 只覆盖已写出的行组
+    _COLUMNS = (
+        "symbol", "exchange", "last_price", "volume", "turnover", "open_interest", "datetime",
+        "bid_price_1", "bid_volume_1", "ask_price_1", "ask_volume_1",
+        "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+    )
+
+    def __init__(self, row_group: int = 65536, compression: str = "snappy"):
+        self.row_group, self.compression = row_group, compression
+
+    def unavailable(self) -> Optional[str]:
+        if importlib.util.find_spec("pyarrow") is None:
+            return "pyarrow 未安装"
+        return None
+
+    def open(self, path: str, trade_date: str, fsync: bool) -> None:
+        super().open(path, trade_date, fsync)
+        self._pa = importlib.import_module("pyarrow")
+        self._pq = importlib.import_module("pyarrow.parquet")
+        os.makedirs(path, exist_ok=True)
+        self.day_path = os.path.join(path, f"{trade_date}.parquet")
+        self._writer = None
+        self._pending: List[Dict] = []
+
+    def _flush(self) -> None:
+        if not self._pending:
+            return
+        table = self._pa.Table.from_pylist(self._pending)
+        if self._writer is None:
+            self._writer = self._pq.ParquetWriter(self.day_path, table.schema, compression=self.compression)
+        self._writer.write_table(table)
+        self._pending = []
+
+    def write(self, batch: List[Dict]) -> None:
+        self._pending.extend({k: d.get(k) for k in self._COLUMNS} for d in batch)
+        if len(self._pending) >= self.row_group:
+            self._flush()
+        if self.fsync and self._writer is not None:
+            # 未满的行组只在内存中：fsync 的对象是已写出的行组
+            _sync_paths([self.day_path])
+
+    def close(self) -> None:
+        self._flush()
+        if self._writer is not None:
+            self._writer.close()
+            if self.fsync:
+                _sync_paths([self.day_path])
+
+    def _read(self, **kw):
+        return self._pq.read_table(os.path.join(self.path, f"{self.trade_date}.parquet"), **kw)
+
+    def replay(self) -> int:
+        return sum(1 for _ in self._read().to_pylist())
+
+    def symbol(self, symbol: str) -> int:
+        return self._read(filters=[("symbol", "=", symbol)]).num_rows
+
+    def window(self, start: datetime, end: datetime) -> int:
+        return self._read(columns=["datetime"], filters=[("datetime", ">=", start), ("datetime", "<", end)]).num_rows
+
+    def column(self) -> float:
+        prices = self._read(columns=["last_price"]).column("last_price").to_numpy()
+        return float(prices.mean()) if len(prices) else 0.0
+
+
+def create_backend(name: str) -> StorageBackend:
+    """按名称创建后端：csv_python / csv_native / parquet / fqt / fqt.<codec> / csv.<codec>。
+
+    Raises:
+        ConfigError: 未知后端或压缩编码时抛出。
+    """
+    if name in ("csv_python", "csv_native"):
+        return CsvBackend(native=name == "csv_native")
+    if name == "parquet":
+        return ParquetBackend()
+    if name == "fqt":
+        return JournalBackend()
+    base, _, codec = name.partition(".")
+    if codec in CODECS and base in ("fqt", "csv"):
+        if base == "csv":
+            # CSV 归档优先用原生编码器，不可用时退回纯 Python（两者输出一致）
+            inner = CsvBackend(native=True)
+            return ArchiveBackend(inner if inner.unavailable() is None else CsvBackend(native=False), codec)
+        return ArchiveBackend(JournalBackend(), codec)
+    raise ConfigError(f"未知存储后端: {name}")
+
+
+def _write_pass(backend: StorageBackend, ticks: List[Dict], batch: int, path: str, trade_date: str,
+                fsync: bool) -> Dict[str, float]:
+    wall, cpu = time.perf_counter(), time.process_time()
+    backend.open(path, trade_date, fsync)
+    for i in range(0, len(ticks), batch):
+        backend.write(ticks[i:i + batch])
+    backend.close()
+    wall, cpu = time.perf_counter() - wall, time.process_time() - cpu
+    return {"seconds": wall, "cpu": cpu, "bytes": sum(os.path.getsize(p) for p in _dir_files(path))}
+
+
+def run_benchmark(
+    ticks: List[Dict],
+    backends=DEFAULT_BACKENDS,
+    work_dir: Optional[str] = None,
+    batch: int = 256,
+    fsync: bool = True,
+    repeat: int = 3,
+    cold: bool = False,
+) -> Dict[str, Any]:
+    """在同一份行情上运行各后端的写入与读取，返回报告（见 format_report）。
+
+    Args:
+        ticks: 按时间有序的标准化行情（同一交易日）。
+        backends: 后端名称列表，不可用的后端记录原因后跳过。
+        work_dir: 工作目录（应位于待测磁盘上，不存在时创建），默认系统临时目录；每个后端使用其下全新的子目录，结束后删除。
+        batch: 每批条数（与采集落盘的批大小一致）。
+        fsync: 是否额外跑一遍每批 fsync 的写入。
+        repeat: 每种查询重复次数，取最快一次。
+        cold: 每次读取前丢弃页缓存。
+
+    Raises:
+        ConfigError: 行情为空、批大小非正或后端名称未知时抛出。
+    """
+    if not ticks or batch <= 0:
+        raise ConfigError("基准需要非空行情与正的批大小")
+    first = ticks[0]["datetime"]
+    trade_date = first.strftime("%Y%m%d")
+    symbols = sorted({d["symbol"] for d in ticks})
+    counts = {s: 0 for s in symbols}
+    for d in ticks:
+        counts[d["symbol"]] += 1
+    probe = max(symbols, key=lambda s: counts[s])
+    mid = ticks[len(ticks) // 2]["datetime"]
+    window = (mid, mid + timedelta(microseconds=WINDOW_US))
+    created = [create_backend(name) for name in backends]
+    if work_dir:
+        os.makedirs(work_dir, exist_ok=True)
+    root = tempfile.mkdtemp(prefix="fq_storage_bench_", dir=work_dir)
+    report: Dict[str, Any] = {
+        "ticks": len(ticks), "symbols": len(symbols), "trade_date": trade_date, "batch": batch,
+        "fsync": fsync, "cold": cold, "repeat": repeat, "work_dir": root, "results": [],
+    }
+    try:
+        for backend in created:
+            result: Dict[str, Any] = {"backend": backend.name}
+            report["results"].append(result)
+            reason = backend.unavailable()
+            if reason:
+                result["skipped"] = reason
+                futures_logger.info(f"存储基准跳过 {backend.name}: {reason}")
+                continue
+            path = os.path.join(root, backend.name)
+            try:
+                if fsync:
+                    synced = _write_pass(backend, ticks, batch, path + ".fsync", trade_date, True)
+                    shutil.rmtree(path + ".fsync")
+                    result["fsync_ticks_per_s"] = len(ticks) / synced["seconds"]
+                    result["fsync_comparable"] = backend.fsync_comparable
+                write = _write_pass(backend, ticks, batch, path, trade_date, False)
+                result["write_ticks_per_s"] = len(ticks) / write["seconds"]
+                result["cpu_us_per_tick"] = write["cpu"] / len(ticks) * 1e6
+                result["bytes_per_tick"] = write["bytes"] / len(ticks)
+                if fsync:
+                    result["fsync_slowdown"] = result["write_ticks_per_s"] / result["fsync_ticks_per_s"]
+                queries = {
+                    "replay": backend.replay,
+                    "symbol": lambda: backend.symbol(probe),
+                    "window": lambda: backend.window(*window),
+                    "column": backend.column,
+                }
+                for shape in QUERY_SHAPES:
+                    best, value = float("inf"), None
+                    for _ in range(max(1, repeat)):
+                        if cold:
+                            drop_page_cache(path)
+                        start = time.perf_counter()
+                        value = queries[shape]()
+                        best = min(best, time.perf_counter() - start)
+                    result[f"{shape}_ms"] = best * 1e3
+                    result[f"{shape}_result"] = value
+            except (StorageError, OSError, ImportError) as e:
+                result["error"] = str(e)
+                futures_logger.error(f"存储基准 {backend.name} 失败: {e}")
+            finally:
+                shutil.rmtree(path, ignore_errors=True)
+                shutil.rmtree(path + ".fsync", ignore_errors=True)
+        report["mismatches"] = _check_results(report["results"])
+    finally:
+        shutil.rmtree(root, ignore_errors=True)
+    return report
+
+
+def _check_results(results: List[Dict]) -> List[str]:
+    """各后端查询结果互相校验，返回不一致的描述。"""
+    out = []
+    done = [r for r in results if "replay_result" in r]
+    for shape in QUERY_SHAPES:
+        values = {r["backend"]: r[f"{shape}_result"] for r in done}
+        if values and max(values.values()) - min(values.values()) > 1e-6 * max(1.0, abs(max(values.values()))):
+            out.append(f"{shape}: {values}")
+    return out
+
+
+def format_report(report: Dict[str, Any]) -> str:
+    """Markdown 对比报告。"""
+    lines = [
+        f"# 存储后端对比（{report['trade_date']}，{report['symbols']} 个合约，{report['ticks']} 条，"
+        f"批 {report['batch']}，{'冷' if report['cold'] else '热'}缓存读取）",
+        "",
+        "| 后端 | 写入 条/s | CPU µs/条 | 字节/条 | fsync 条/s | fsync 降幅 | replay ms | symbol ms | window ms | column ms |",
+        "|---|---:|---:|---:|---:|---:|---:|---:|---:|---:|",
+    ]
+
+    def cell(r, key, fmt, unit=""):
+        return format(r[key], fmt) + unit if key in r else "-"
+
+    def fsync_cell(r, key, fmt, unit=""):
+        text = cell(r, key, fmt, unit)
+        return text + "†" if key in r and not r.get("fsync_comparable", True) else text
+
+    for r in report["results"]:
+        if "skipped" in r or "error" in r:
+            lines.append(f"| {r['backend']} | {'跳过' if 'skipped' in r else '失败'}：{r.get('skipped') or r.get('error')} |"
+                         + " |" * 9)
+            continue
+        lines.append(
+            f"| {r['backend']} | {cell(r, 'write_ticks_per_s', ',.0f')} | {cell(r, 'cpu_us_per_tick', '.2f')} "
+            f"| {cell(r, 'bytes_per_tick', '.1f')} | {fsync_cell(r, 'fsync_ticks_per_s', ',.0f')} "
+            f"| {fsync_cell(r, 'fsync_slowdown', '.2f', 'x')}"
+            + "".join(f" | {cell(r, f'{shape}_ms', '.1f')}" for shape in QUERY_SHAPES) + " |"
+        )
+    lines.append("")
+    lines.append("查询：replay 全天按时间物化为 dict；symbol 成交最活跃合约全天；window 中间一条行情的时间戳起 5 分钟全部合约；"
+                 "column 全天 last_price 均值。")
+    if any(not r.get("fsync_comparable", True) for r in report["results"] if "fsync_ticks_per_s" in r):
+        lines.append("")
+        lines.append("† 不可比：未满的行组只在内存中，每批 fsync 只覆盖已写出的行组，并非每批落盘。")
+    if report.get("mismatches"):
+        lines.append("")
+        lines.append("**结果不一致**：" + "；".join(report["mismatches"]))
+    return "\n".join(lines) + "\n"
+
+
+def main(argv: Optional[List[str]] = None) -> None:
+    parser = argparse.ArgumentParser(description="存储后端写入 / 读取基准与对比报告")
+    parser.add_argument("--symbols", type=int, default=20, help="生成的合约数")
+    parser.add_argument("--ticks", type=int, default=10000, help="每合约行情条数")
+    parser.add_argument("--date", default="20250129", help="交易日 YYYYMMDD")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--replay", default=None, help="使用 FileStorage 目录中 --date 当日的录制数据代替生成数据")
+    parser.add_argument("--backends", nargs="*", default=list(DEFAULT_BACKENDS), help="参与对比的后端")
+    parser.add_argument("--batch", type=int, default=256, help="每批写入条数")
+    parser.add_argument("--repeat", type=int, default=3, help="每种查询重复次数（取最快）")
+    parser.add_argument("--dir", default=None, help="工作目录（位于待测磁盘），默认系统临时目录")
+    parser.add_argument("--no-fsync", action="store_true", help="不测每批 fsync 的写入")
+    parser.add_argument("--cold", action="store_true", help="每次读取前丢弃页缓存")
+    parser.add_argument("--out", default=None, help="Markdown 报告输出路径（默认打印）")
+    parser.add_argument("--json", default=None, help="JSON 结果输出路径")
+    args = parser.parse_args(argv)
+    if args.replay:
+        ticks = load_replay(args.replay, args.date)
+    else:
+        ticks = generate_day(args.symbols, args.ticks, args.date, args.seed)
+    report = run_benchmark(ticks, args.backends, args.dir, args.batch, not args.no_fsync, args.repeat, args.cold)
+    text = format_report(report)
+    if args.out:
+        with open(args.out, "w", encoding="utf-8") as f:
+            f.write(text)
+    else:
+        print(text)
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as f:
+            json.dump(report, f, ensure_ascii=False, indent=2)
+
+
+if __name__ == "__main__":
+    main()
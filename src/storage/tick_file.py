@@ -0,0 +1,387 @@
+# -*- coding: utf-8 -*-
+"""可内存映射的行情日文件模块（.fqt）
+
+与 fq/tick_file.hpp 格式一致：64 字节文件头 + 按时间有序的定长记录（fq::Tick 内存布局，128 字节）
++ 32 字节零填充合约代码段（下标为文件内合约 ID）+ 合约索引（每合约 {start, count} + uint32 记录下标，
+组内按时间有序；旧文件无索引时按 instrument_id 列扫描）。
+TickFile 以只读 mmap 打开，记录通过 numpy 结构化数组零拷贝访问；多线程或 fork 出的子进程
+共享同一份页缓存，参数扫描等需要反复回放同一天数据的场景只需加载一次。
+
+PACKED_TICK_DTYPE / TICK_DEPTH_DTYPE 与 fq/packed_tick.hpp 一致：在线程 / 进程之间搬运与缓存最新行情时
+使用的 64 字节（一条缓存行）规范记录与伴随的冷字段 + 5 档深度记录，价格为定点整数（× PRICE_SCALE）。
+"""
+import heapq
+import math
+import mmap
+import os
+import struct
+from datetime import datetime, timedelta
+from typing import Dict, Iterable, Iterator, List, Optional
+
+import numpy as np
+
+from src.utils.exceptions import StorageError
+
+MAGIC = b"FQTICK01"
+VERSION = 1
+HEADER = struct.Struct("<8sIIQQIIQ16x")
+INDEX_ENTRY_DTYPE = np.dtype([("start", "<u8"), ("count", "<u8")])
+SYMBOL_LEN = 32
+
+# 与 fq::Exchange 枚举值一致
+EXCHANGES = ("", "SHFE", "DCE", "CZCE", "INE", "GFEX", "CFFEX")
+_EXCHANGE_CODES = {name: code for code, name in enumerate(EXCHANGES)}
+
+TICK_DTYPE = np.dtype([
+    ("instrument_id", "<i4"),
+    ("exchange", "u1"),
+    ("source", "u1"),
+    ("flags", "<u2"),
+    ("trade_date", "<u4"),
+    ("reserved", "<u4"),
+    ("time_us", "<i8"),
+    ("last_price", "<f8"),
+    ("volume", "<i8"),
+    ("turnover", "<f8"),
+    ("open_interest", "<f8"),
+    ("bid_price_1", "<f8"),
+    ("bid_volume_1", "<i8"),
+    ("ask_price_1", "<f8"),
+    ("ask_volume_1", "<i8"),
+    ("open_price", "<f8"),
+    ("high_price", "<f8"),
+    ("low_price", "<f8"),
+    ("pre_close", "<f8"),
+    ("pre_settlement", "<f8"),
+])
+assert HEADER.size == 64 and TICK_DTYPE.itemsize == 128
+
+PRICE_SCALE = 10000
+NO_PRICE = -(1 << 63)
+DEPTH_LEVELS = 5
+PACKED_HAS_DEPTH = 0x8000
+PACKED_CLAMPED = 0x4000
+_U32_MAX = (1 << 32) - 1
+_EPOCH = datetime(1970, 1, 1)
+
+PACKED_TICK_DTYPE = np.dtype([
+    ("instrument_id", "<i4"),
+    ("exchange", "u1"),
+    ("source", "u1"),
+    ("flags", "<u2"),
+    ("exchange_time_ns", "<i8"),
+    ("receive_time_ns", "<i8"),
+    ("last_price", "<i8"),
+    ("bid_price_1", "<i8"),
+    ("ask_price_1", "<i8"),
+    ("volume", "<u4"),
+    ("open_interest", "<u4"),
+    ("bid_volume_1", "<u4"),
+    ("ask_volume_1", "<u4"),
+])
+TICK_DEPTH_DTYPE = np.dtype([
+    ("instrument_id", "<i4"),
+    ("levels", "u1"),
+    ("reserved", "V3"),
+    ("turnover", "<f8"),
+    ("open_price", "<i8"),
+    ("high_price", "<i8"),
+    ("low_price", "<i8"),
+    ("pre_close", "<i8"),
+    ("pre_settlement", "<i8"),
+    ("bid_price", "<i8", (DEPTH_LEVELS,)),
+    ("ask_price", "<i8", (DEPTH_LEVELS,)),
+    ("bid_volume", "<u4", (DEPTH_LEVELS,)),
+    ("ask_volume", "<u4", (DEPTH_LEVELS,)),
+    ("pad", "V16"),
+])
+assert PACKED_TICK_DTYPE.itemsize == 64 and TICK_DEPTH_DTYPE.itemsize == 192
+
+# 记录中直接对应标准化行情字段的数值列（按 DataParser 输出顺序）
+_VALUE_FIELDS = (
+    "last_price", "volume", "turnover", "open_interest",
+    "bid_price_1", "bid_volume_1", "ask_price_1", "ask_volume_1",
+    "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+)
+
+
+def fill_record(rec, data: Dict, instrument_id: int) -> None:
+    """标准化行情 dict -> 一条 TICK_DTYPE 记录（就地写入）。"""
+    dt = data["datetime"]
+    rec["instrument_id"] = instrument_id
+    rec["exchange"] = _EXCHANGE_CODES.get(data.get("exchange", ""), 0)
+    rec["trade_date"] = dt.year * 10000 + dt.month * 100 + dt.day
+    rec["time_us"] = ((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1000000 + dt.microsecond
+    for field in _VALUE_FIELDS:
+        rec[field] = data.get(field) or 0
+
+
+def record_to_dict(rec, symbol: str, instrument_id: int) -> Dict:
+    """一条 TICK_DTYPE 记录 -> 标准化行情 dict（键顺序与 DataParser 一致）。"""
+    trade_date = int(rec["trade_date"])
+    ex = int(rec["exchange"])
+    out = {
+        "symbol": symbol,
+        "instrument_id": instrument_id,
+        "exchange": EXCHANGES[ex] if ex < len(EXCHANGES) else "",
+    }
+    for field in _VALUE_FIELDS[:4]:
+        out[field] = rec[field].item()
+    out["datetime"] = datetime(trade_date // 10000, trade_date // 100 % 100, trade_date % 100) + timedelta(
+        microseconds=int(rec["time_us"])
+    )
+    for field in _VALUE_FIELDS[4:]:
+        out[field] = rec[field].item()
+    return out
+
+
+def to_fixed_price(price) -> int:
+    """价格 -> 定点整数（与 fq::to_fixed_price 一致：四舍五入，NaN / 超范围为 NO_PRICE）。"""
+    if not abs(price) < 9.0e14:
+        return NO_PRICE
+    x = price * PRICE_SCALE
+    return int(math.copysign(math.floor(abs(x) + 0.5), x))
+
+
+def from_fixed_price(value: int) -> float:
+    return float("nan") if value == NO_PRICE else value / PRICE_SCALE
+
+
+def exchange_time_ns(dt: datetime) -> int:
+    """行情时间 -> 交易所时间纳秒（本地墙钟按 UTC 编码，与 fq::to_exchange_time_ns 一致）。"""
+    delta = dt - _EPOCH
+    return ((delta.days * 86400 + delta.seconds) * 1000000 + delta.microseconds) * 1000
+
+
+def _saturate(value, flags: int):
+    v = int(round(value)) if value == value else 0
+    if v > _U32_MAX:
+        return _U32_MAX, flags | PACKED_CLAMPED
+    return max(v, 0), flags
+
+
+def fill_packed_record(rec, data: Dict, instrument_id: int, receive_time_ns: int = 0, depth=None) -> None:
+    """标准化行情 dict -> 一条 PACKED_TICK_DTYPE 记录（depth 非空时同时写出 TICK_DEPTH_DTYPE 伴随记录）。"""
+    flags = 0
+    rec["instrument_id"] = instrument_id
+    rec["exchange"] = _EXCHANGE_CODES.get(data.get("exchange", ""), 0)
+    rec["exchange_time_ns"] = exchange_time_ns(data["datetime"])
+    rec["receive_time_ns"] = receive_time_ns
+    for field in ("last_price", "bid_price_1", "ask_price_1"):
+        rec[field] = to_fixed_price(data.get(field) or 0)
+    for field in ("volume", "open_interest", "bid_volume_1", "ask_volume_1"):
+        rec[field], flags = _saturate(data.get(field) or 0, flags)
+    if depth is not None:
+        flags |= PACKED_HAS_DEPTH
+        for field in ("bid_price", "ask_price", "bid_volume", "ask_volume"):
+            depth[field] = 0
+        depth["instrument_id"] = instrument_id
+        depth["levels"] = 1
+        depth["turnover"] = data.get("turnover") or 0
+        for field in ("open_price", "high_price", "low_price", "pre_close", "pre_settlement"):
+            depth[field] = to_fixed_price(data.get(field) or 0)
+        depth["bid_price"][0], depth["ask_price"][0] = rec["bid_price_1"], rec["ask_price_1"]
+        depth["bid_volume"][0], depth["ask_volume"][0] = rec["bid_volume_1"], rec["ask_volume_1"]
+    rec["flags"] = flags
+
+
+def packed_record_to_dict(rec, symbol: str, instrument_id: int, depth=None) -> Dict:
+    """一条 PACKED_TICK_DTYPE 记录（+ 可选伴随记录）-> 标准化行情 dict；无伴随记录时冷字段为 0。"""
+    ex = int(rec["exchange"])
+    has_depth = depth is not None and int(rec["flags"]) & PACKED_HAS_DEPTH
+    out = {
+        "symbol": symbol,
+        "instrument_id": instrument_id,
+        "exchange": EXCHANGES[ex] if ex < len(EXCHANGES) else "",
+        "last_price": from_fixed_price(int(rec["last_price"])),
+        "volume": int(rec["volume"]),
+        "turnover": float(depth["turnover"]) if has_depth else 0.0,
+        "open_interest": float(rec["open_interest"]),
+        "datetime": _EPOCH + timedelta(microseconds=int(rec["exchange_time_ns"]) // 1000),
+        "bid_price_1": from_fixed_price(int(rec["bid_price_1"])),
+        "bid_volume_1": int(rec["bid_volume_1"]),
+        "ask_price_1": from_fixed_price(int(rec["ask_price_1"])),
+        "ask_volume_1": int(rec["ask_volume_1"]),
+    }
+    for field in _VALUE_FIELDS[8:]:
+        out[field] = from_fixed_price(int(depth[field])) if has_depth else 0.0
+    return out
+
+
+def write_tick_file(path: str, streams: Iterable[Iterable[Dict]]) -> int:
+    """把多合约标准化行情按时间归并后写成日文件，返回写入条数。
+
+    Args:
+        path: 输出路径（.fqt）。
+        streams: 每个合约一条按时间有序的行情流。
+    """
+    rows = list(heapq.merge(*streams, key=lambda d: d["datetime"]))
+    file_ids: Dict[str, int] = {}
+    records = records_from_dicts(rows, file_ids)
+    return write_records(path, records, list(file_ids))
+
+
+def records_from_dicts(rows: List[Dict], file_ids: Dict[str, int]) -> np.ndarray:
+    """一批标准化行情 dict -> TICK_DTYPE 数组（按列填充，结果与逐条 fill_record 一致）。
+
+    Args:
+        rows: 标准化行情列表。
+        file_ids: 合约代码 -> 文件内合约 ID，新合约按出现顺序追加登记（就地更新）。
+    """
+    records = np.zeros(len(rows), dtype=TICK_DTYPE)
+    if not rows:
+        return records
+    records["instrument_id"] = [file_ids.setdefault(d.get("symbol", ""), len(file_ids)) for d in rows]
+    records["exchange"] = [_EXCHANGE_CODES.get(d.get("exchange", ""), 0) for d in rows]
+    dts = [d["datetime"] for d in rows]
+    records["trade_date"] = [dt.year * 10000 + dt.month * 100 + dt.day for dt in dts]
+    records["time_us"] = [((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1000000 + dt.microsecond for dt in dts]
+    for field in _VALUE_FIELDS:
+        records[field] = [d.get(field) or 0 for d in rows]
+    return records
+
+
+def write_records(path: str, records: np.ndarray, symbols: List[str]) -> int:
+    """把按时间有序的 TICK_DTYPE 记录（instrument_id 为 symbols 下标）连同合约段与索引写成日文件。"""
+    names = b"".join(s.encode("utf-8")[: SYMBOL_LEN - 1].ljust(SYMBOL_LEN, b"\x00") for s in symbols)
+    symbols_offset = HEADER.size + records.nbytes
+    symbols_end = symbols_offset + len(names)
+    index_offset = (symbols_end + 7) & ~7
+    # 稳定排序：按合约分组、组内保持时间顺序
+    order = np.argsort(records["instrument_id"], kind="stable").astype("<u4")
+    entries = np.zeros(len(symbols), dtype=INDEX_ENTRY_DTYPE)
+    entries["count"] = np.bincount(records["instrument_id"], minlength=len(symbols))
+    entries["start"][1:] = np.cumsum(entries["count"])[:-1]
+    header = HEADER.pack(MAGIC, VERSION, TICK_DTYPE.itemsize, len(records),
+                         symbols_offset, len(symbols), 0, index_offset)
+    try:
+        os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(header)
+            f.write(records.tobytes())
+            f.write(names)
+            f.write(b"\x00" * (index_offset - symbols_end))
+            f.write(entries.tobytes())
+            f.write(order.tobytes())
+    except OSError as e:
+        raise StorageError(f"写入行情日文件失败: {path}: {e}") from e
+    return len(records)
+
+
+def build_day_file(base_path: str, trade_date: str, path: str, symbols: Optional[List[str]] = None) -> int:
+    """把 FileStorage 目录下某日的 CSV 转为行情日文件，返回写入条数。"""
+    from src.storage.file_storage import FileStorage
+
+    day = FileStorage(base_path=base_path).load_day(trade_date, symbols)
+    # CSV 按到达顺序追加，个别行情可能乱序；稳定排序后再归并
+    return write_tick_file(path, [sorted(rows, key=lambda d: d["datetime"]) for rows in day.values() if rows])
+
+
+class TickFile:
+    """只读映射的行情日文件。"""
+
+    def __init__(self, path: str):
+        """映射并校验文件。
+
+        Raises:
+            StorageError: 文件不存在、格式或版本不符时抛出。
+        """
+        self.path = path
+        try:
+            with open(path, "rb") as f:
+                self._mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        except (OSError, ValueError) as e:
+            raise StorageError(f"打开行情日文件失败: {path}: {e}") from e
+        if len(self._mm) < HEADER.size:
+            raise StorageError(f"行情日文件过短: {path}")
+        magic, version, record_size, count, symbols_offset, symbol_count, _, index_offset = \
+            HEADER.unpack_from(self._mm, 0)
+        if (magic != MAGIC or version != VERSION or record_size != TICK_DTYPE.itemsize
+                or symbols_offset != HEADER.size + count * record_size
+                or symbols_offset + symbol_count * SYMBOL_LEN > len(self._mm)):
+            raise StorageError(f"行情日文件格式不符: {path}")
+        self._index: Optional[np.ndarray] = None
+        self._index_rows: Optional[np.ndarray] = None
+        if index_offset:
+            rows_offset = index_offset + symbol_count * INDEX_ENTRY_DTYPE.itemsize
+            if index_offset % 8 or rows_offset + count * 4 > len(self._mm):
+                raise StorageError(f"行情日文件索引越界: {path}")
+            self._index = np.frombuffer(self._mm, dtype=INDEX_ENTRY_DTYPE, count=symbol_count, offset=index_offset)
+            self._index_rows = np.frombuffer(self._mm, dtype="<u4", count=count, offset=rows_offset)
+        # 零拷贝视图，只读
+        self.records = np.frombuffer(self._mm, dtype=TICK_DTYPE, count=count, offset=HEADER.size)
+        self.symbols: List[str] = [
+            self._mm[symbols_offset + i * SYMBOL_LEN: symbols_offset + (i + 1) * SYMBOL_LEN]
+            .split(b"\x00", 1)[0].decode("utf-8")
+            for i in range(symbol_count)
+        ]
+        self._instrument_ids: Optional[List[int]] = None
+
+    def __len__(self) -> int:
+        return len(self.records)
+
+    @property
+    def instrument_ids(self) -> List[int]:
+        """文件内合约 ID -> 进程内 instrument_id（首次访问时登记到全局符号表）。"""
+        if self._instrument_ids is None:
+            from src.processor.symbol_table import get_symbol_table
+
+            table = get_symbol_table()
+            self._instrument_ids = [table.intern(s) for s in self.symbols]
+        return self._instrument_ids
+
+    @property
+    def has_index(self) -> bool:
+        return self._index is not None
+
+    def rows_of(self, symbol: str) -> np.ndarray:
+        """某合约的记录下标（时间有序）；有索引时为零拷贝视图，否则扫描 instrument_id 列。"""
+        try:
+            fid = self.symbols.index(symbol)
+        except ValueError:
+            return np.empty(0, dtype="<u4")
+        if self._index is not None:
+            entry = self._index[fid]
+            return self._index_rows[int(entry["start"]): int(entry["start"]) + int(entry["count"])]
+        return np.flatnonzero(self.records["instrument_id"] == fid).astype("<u4")
+
+    def select(self, symbol: str) -> np.ndarray:
+        """某合约的全部记录（结构化数组副本）。"""
+        return self.records[self.rows_of(symbol)]
+
+    def iter_dicts(self, start: int = 0, stop: Optional[int] = None) -> Iterator[Dict]:
+        """按时间顺序物化为标准化行情 dict（键顺序与 DataParser 一致）。"""
+        ids = self.instrument_ids
+        symbols = self.symbols
+        day_cache: Dict[int, datetime] = {}
+        names = ("instrument_id", "exchange", "trade_date", "time_us") + _VALUE_FIELDS
+        columns = [self.records[name][start:stop].tolist() for name in names]
+        for fid, ex, trade_date, time_us, last, vol, turn, oi, bp, bv, ap, av, op, hp, lp, pc, ps in zip(*columns):
+            day = day_cache.get(trade_date)
+            if day is None:
+                day = day_cache[trade_date] = datetime(trade_date // 10000, trade_date // 100 % 100, trade_date % 100)
+            yield {
+                "symbol": symbols[fid],
+                "instrument_id": ids[fid],
+                "exchange": EXCHANGES[ex] if ex < len(EXCHANGES) else "",
+                "last_price": last,
+                "volume": vol,
+                "turnover": turn,
+                "open_interest": oi,
+                "datetime": day + timedelta(microseconds=time_us),
+                "bid_price_1": bp,
+                "bid_volume_1": bv,
+                "ask_price_1": ap,
+                "ask_volume_1": av,
+                "open_price": op,
+                "high_price": hp,
+                "low_price": lp,
+                "pre_close": pc,
+                "pre_settlement": ps,
+            }
+
+    def close(self) -> None:
+        self.records = None
+        self._index = None
+        self._index_rows = None
+        self._mm.close()
@@ -2,7 +2,7 @@
 from .logger import get_futures_logger, futures_logger
 from .exceptions import (
     FuturesBaseError, MarketSourceError, DataParseError,
-    DataCleanError, StorageError, CollectError
+    DataCleanError, StorageError, CollectError, ConfigError, AllocationError
 )
 from .common_tools import (
     dt2timestamp, timestamp2dt, parse_futures_code,
@@ -12,7 +12,7 @@ from .common_tools import (
 __all__ = [
     "get_futures_logger", "futures_logger",
     "FuturesBaseError", "MarketSourceError", "DataParseError",
-    "DataCleanError", "StorageError", "CollectError",
+    "DataCleanError", "StorageError", "CollectError", "ConfigError", "AllocationError",
     "dt2timestamp", "timestamp2dt", "parse_futures_code",
     "check_data_validity", "FUTURES_BASE_FIELDS"
 ]
\ No newline at end of file
@@ -0,0 +1,123 @@
+# -*- coding: utf-8 -*-
+"""热路径分配守卫模块
+
+native_pybind 以 FQ_ALLOC_TRACKING=ON 构建时，全局 operator new/delete 被替换为按线程计数的版本。
+行情线程在每次热路径调用前后执行 begin()/end()，预热 warmup 次之后出现的任何原生堆分配都记为违例：
+- strict=False：计数并在首次违例时告警，stats() 供巡检/验收读取
+- strict=True：立即抛出 AllocationError（用于压测与验收环境）
+
+pybind11 每次调用分发本身有少量固定分配（参数数组），构造时校准单次分发的分配数，
+按 calls_per_iteration（begin/end 之间的原生调用次数）扣除，只有超出部分计为违例。
+未启用计数（未编译、未开启构建选项或非 Linux）时守卫为空操作，available 为 False。
+Python 对象（dict/list 等）的分配不在统计范围内。
+"""
+from typing import Any, Dict, Optional
+
+from src.utils.exceptions import AllocationError
+from src.utils.logger import futures_logger
+from src.utils.native_loader import get_native_pybind
+
+_CALIBRATE_ROUNDS = 16
+
+
+def alloc_tracking_enabled(native=None) -> bool:
+    """native_pybind 是否以分配计数模式构建。"""
+    m = native if native is not None else get_native_pybind()
+    return bool(m is not None and hasattr(m, "alloc_tracking_enabled") and m.alloc_tracking_enabled())
+
+
+class AllocationGuard:
+    """单个行情线程的热路径分配守卫（begin/end 须在同一线程调用）。"""
+
+    def __init__(
+        self,
+        name: str,
+        warmup: int = 10000,
+        strict: bool = False,
+        calls_per_iteration: int = 1,
+        native=None,
+    ):
+        """初始化守卫。
+
+        Args:
+            name: 线程/热路径名称，用于日志。
+            warmup: 预热次数，期间的分配（首次登记合约、缓存扩容等）不计违例。
+            strict: 违例时是否抛出 AllocationError。
+            calls_per_iteration: begin/end 之间的原生调用次数，用于扣除调用分发的固定分配。
+            native: 可选，指定原生模块（默认 get_native_pybind()）。
+        """
+        m = native if native is not None else get_native_pybind()
+        self.name = name
+        self.warmup = max(0, int(warmup))
+        self.strict = bool(strict)
+        self.available = alloc_tracking_enabled(m)
+        self._scope = m.AllocScope() if self.available else None
+        self._baseline = self._calibrate(max(0, int(calls_per_iteration))) if self.available else 0
+        self.iterations = 0
+        self.violations = 0
+        self.leaked_allocs = 0
+
+    def _calibrate(self, calls: int) -> int:
+        """空 begin()/end() 的分配数 + calls 次调用分发的分配数（取多轮最小值）。"""
+        scope = self._scope
+        empty = per_call = None
+        for _ in range(_CALIBRATE_ROUNDS):
+            scope.restart()
+            n0 = scope.allocations()
+            scope.restart()
+            scope.allocations()
+            n1 = scope.allocations()
+            empty = n0 if empty is None else min(empty, n0)
+            per_call = n1 - n0 if per_call is None else min(per_call, n1 - n0)
+        return max(0, empty) + max(0, per_call) * calls
+
+    def begin(self) -> None:
+        """热路径调用前。"""
+        if self._scope is not None:
+            self._scope.restart()
+
+    def end(self) -> None:
+        """热路径调用后：预热结束后出现分配即记违例。"""
+        scope = self._scope
+        if scope is None:
+            return
+        n = scope.allocations() - self._baseline
+        self.iterations += 1
+        if n <= 0 or self.iterations <= self.warmup:
+            return
+        self.violations += 1
+        self.leaked_allocs += n
+        if self.strict:
+            raise AllocationError(f"{self.name} 预热后第 {self.iterations} 次调用出现 {n} 次堆分配")
+        if self.violations == 1:
+            futures_logger.warning(f"{self.name} 预热后出现堆分配: 第 {self.iterations} 次调用 {n} 次")
+
+    def assert_steady(self) -> None:
+        """断言预热后零分配，否则抛出 AllocationError。"""
+        if self.violations:
+            raise AllocationError(
+                f"{self.name} 预热后出现 {self.violations} 次违例，共 {self.leaked_allocs} 次堆分配"
+            )
+
+    def stats(self) -> Dict[str, Any]:
+        """守卫统计。"""
+        return {
+            "name": self.name,
+            "available": self.available,
+            "iterations": self.iterations,
+            "steady": self.iterations > self.warmup,
+            "violations": self.violations,
+            "leaked_allocs": self.leaked_allocs,
+        }
+
+
+def create_alloc_guard(name: str, guard_config: Optional[Dict[str, Any]] = None) -> Optional[AllocationGuard]:
+    """按 alloc_guard 配置段创建守卫；未启用时返回 None（热路径不做任何额外调用）。"""
+    cfg = guard_config or {}
+    if not cfg.get("enable", False):
+        return None
+    guard = AllocationGuard(name, warmup=int(cfg.get("warmup", 10000)), strict=bool(cfg.get("strict", False)))
+    if not guard.available:
+        futures_logger.warning(f"{name} 已配置分配守卫，但 native_pybind 未以 FQ_ALLOC_TRACKING=ON 构建，守卫不生效")
+        return None
+    return guard
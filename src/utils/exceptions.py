@@ -30,4 +30,12 @@ class StorageError(FuturesBaseError):
 
 class CollectError(FuturesBaseError):
     """行情采集异常：如采集超时、重试失败、网络断开等"""
-    pass
\ No newline at end of file
+    pass
+
+class ConfigError(FuturesBaseError):
+    """配置异常：如流水线拓扑非法、阶段类型未知、必填项缺失等"""
+    pass
+
+class AllocationError(FuturesBaseError):
+    """热路径分配异常：预热后的行情线程上出现了堆分配"""
+    pass
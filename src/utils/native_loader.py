@@ -0,0 +1,74 @@
+# -*- coding: utf-8 -*-
+"""native_pybind 加载模块
+
+native_pybind（extern_libs/native_pybind）提供符号表、批量记录等热路径原生组件。
+各业务模块通过 get_native_pybind() 取得模块；未编译、未启用或非 Linux 时返回 None，
+调用方回退到纯 Python 实现，保证框架在任何环境下都可运行。
+"""
+import os
+import platform
+import sys
+from typing import Any, Dict, Optional
+
+from .logger import futures_logger
+
+_native_pybind = None
+_native_checked = False
+_native_enabled = True
+_native_pybind_path: Optional[str] = None
+
+
+def configure_native(native_config: Optional[Dict[str, Any]] = None) -> None:
+    """按 main_config.yaml 的 native 配置设置加载行为（需在首次使用前调用）。
+
+    Args:
+        native_config: native 配置段，含 enable（是否启用原生组件）与 pybind_path。
+    """
+    global _native_enabled, _native_pybind_path, _native_checked, _native_pybind
+    cfg = native_config or {}
+    _native_enabled = bool(cfg.get("enable", True))
+    _native_pybind_path = cfg.get("pybind_path")
+    # 配置变化后允许重新探测
+    _native_checked = False
+    _native_pybind = None
+
+
+def get_native_pybind():
+    """按需加载 native_pybind，支持配置项 pybind_path 与环境变量 NATIVE_PYBIND_PATH。
+
+    Returns:
+        native_pybind 模块；未启用、非 Linux 或未编译时返回 None。
+    """
+    global _native_pybind, _native_checked
+    if _native_checked:
+        return _native_pybind
+    _native_checked = True
+    if not _native_enabled:
+        futures_logger.info("native_pybind 已在配置中禁用，使用纯 Python 实现")
+        return None
+    if platform.system().lower() != "linux":
+        futures_logger.debug("native_pybind 仅支持 Linux，使用纯 Python 实现")
+        return None
+
+    search_paths = []
+    if _native_pybind_path:
+        search_paths.append(os.path.abspath(_native_pybind_path))
+    env_path = os.getenv("NATIVE_PYBIND_PATH")
+    if env_path:
+        search_paths.append(os.path.abspath(env_path))
+    for path in search_paths:
+        if path and os.path.exists(path) and path not in sys.path:
+            sys.path.insert(0, path)
+            futures_logger.debug(f"已添加 native_pybind 搜索路径: {path}")
+
+    try:
+        import native_pybind as m
+        _native_pybind = m
+        futures_logger.info("native_pybind 导入成功，启用原生热路径组件")
+    except ImportError:
+        futures_logger.info(
+            "未找到 native_pybind，使用纯 Python 实现。如需原生组件请编译 "
+            "extern_libs/native_pybind 并配置 native.pybind_path 或 NATIVE_PYBIND_PATH。"
+        )
+        _native_pybind = None
+    return _native_pybind
@@ -0,0 +1,275 @@
+# -*- coding: utf-8 -*-
+"""内置采样分析器模块
+
+生产环境延迟回退时，无需挂外部工具即可查看行情/处理线程在做什么：
+- 热点线程（CTP/NSQ 回调线程、GFEX 接收线程、分发循环、分片工作线程等）启动时调用
+  register_current_thread(name, source) 登记
+- 收到触发信号（默认 SIGUSR2）或调用 start() 后，采样线程按 hz 频率读取登记线程的
+  当前调用栈（sys._current_frames），按 "来源;线程;调用栈" 聚合计数
+- 到达 duration 或再次收到信号时结束，输出 folded-stack 文件（每行 "栈 次数"），
+  可直接交给 flamegraph.pl / speedscope 生成火焰图
+- 信号处理函数只置位请求标志，开始/结束与写文件在控制线程 fq-profiler-ctl 上执行，
+  不在事件循环线程上 join 采样线程或做文件 IO
+
+未启动采样时除线程登记外没有任何开销；采样开销与 hz × 登记线程数成正比。
+"""
+import asyncio
+import os
+import signal
+import sys
+import threading
+import time
+from collections import Counter
+from typing import Any, Dict, Optional, Tuple
+
+from src.utils.logger import futures_logger
+
+DEFAULT_PROFILER_CONFIG = {
+    "enable": True,
+    "signal": "SIGUSR2",
+    "hz": 99,
+    "duration": 30.0,
+    "output_dir": "./logs/profile/",
+    "include_lines": False,
+}
+
+_registry: Dict[int, Tuple[str, str]] = {}
+# 可重入：信号处理函数可能在主线程持锁期间触发
+_registry_lock = threading.RLock()
+
+
+def register_current_thread(name: str, source: str) -> None:
+    """登记当前线程为热点线程（重复登记只更新名称）。"""
+    ident = threading.get_ident()
+    if _registry.get(ident) == (name, source):
+        return
+    with _registry_lock:
+        _registry[ident] = (name, source)
+
+
+def unregister_current_thread() -> None:
+    """线程退出前注销登记。"""
+    with _registry_lock:
+        _registry.pop(threading.get_ident(), None)
+
+
+def registered_threads() -> Dict[int, Tuple[str, str]]:
+    """已登记线程快照：ident -> (名称, 来源)。"""
+    with _registry_lock:
+        return dict(_registry)
+
+
+def _frame_label(frame, include_lines: bool) -> str:
+    code = frame.f_code
+    filename = os.path.basename(code.co_filename)
+    if include_lines:
+        return f"{code.co_name} ({filename}:{frame.f_lineno})"
+    return f"{code.co_name} ({filename})"
+
+
+class SamplingProfiler:
+    """登记线程的调用栈采样器。"""
+
+    def __init__(self, hz: float = 99, include_lines: bool = False, output_dir: str = "./logs/profile/"):
+        """初始化采样器。
+
+        Args:
+            hz: 采样频率（次/秒）。
+            include_lines: 栈帧是否带行号（更精确，但栈更分散）。
+            output_dir: dump() 未指定路径时的输出目录。
+        """
+        self.interval = 1.0 / max(1.0, float(hz))
+        self.include_lines = bool(include_lines)
+        self.output_dir = output_dir
+        self._stacks: Counter = Counter()
+        self._lock = threading.RLock()
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+        self._auto_dump = False
+        self.samples = 0
+        self.started_at: Optional[float] = None
+        self.last_dump: Optional[str] = None
+
+    @property
+    def running(self) -> bool:
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self, duration: Optional[float] = None, auto_dump: bool = True) -> bool:
+        """开始采样（清空上一轮结果）。
+
+        Args:
+            duration: 采样时长（秒），None 为直到 stop()。
+            auto_dump: 到达 duration 时是否自动写出 folded-stack 文件。
+
+        Returns:
+            已在采样中返回 False。
+        """
+        if self.running:
+            return False
+        with self._lock:
+            self._stacks.clear()
+        self.samples = 0
+        self.started_at = time.time()
+        self._auto_dump = auto_dump
+        self._stop.clear()
+        self._thread = threading.Thread(
+            target=self._run, args=(duration,), name="fq-profiler", daemon=True
+        )
+        self._thread.start()
+        futures_logger.info(
+            f"采样分析已开始: {1.0 / self.interval:.0f} Hz，时长 {duration or '不限'} 秒，"
+            f"登记线程 {len(registered_threads())} 个"
+        )
+        return True
+
+    def stop(self) -> None:
+        """停止采样（保留结果供 folded()/dump() 读取）。"""
+        self._stop.set()
+        thread = self._thread
+        if thread is not None and thread is not threading.current_thread():
+            thread.join()
+
+    def folded(self) -> Dict[str, int]:
+        """聚合结果：folded 栈 -> 采样次数。"""
+        with self._lock:
+            return dict(self._stacks)
+
+    def dump(self, path: Optional[str] = None) -> str:
+        """写出 folded-stack 文件（按次数降序），返回文件路径。"""
+        if path is None:
+            stamp = time.strftime("%Y%m%d_%H%M%S", time.localtime(self.started_at or time.time()))
+            path = os.path.join(self.output_dir, f"profile_{stamp}_{os.getpid()}.folded")
+        os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+        stacks = self.folded()
+        with open(path, "w", encoding="utf-8") as f:
+            for stack, count in sorted(stacks.items(), key=lambda kv: -kv[1]):
+                f.write(f"{stack} {count}\n")
+        self.last_dump = path
+        futures_logger.info(f"采样分析结果已写出: {path}（{self.samples} 次采样，{len(stacks)} 个不同栈）")
+        return path
+
+    def sample_once(self) -> int:
+        """采样一次所有登记线程，返回采到的线程数。"""
+        frames = sys._current_frames()
+        taken = 0
+        me = threading.get_ident()
+        local: Counter = Counter()
+        for ident, (name, source) in registered_threads().items():
+            frame = frames.get(ident)
+            if frame is None or ident == me:
+                continue
+            stack = []
+            while frame is not None:
+                stack.append(_frame_label(frame, self.include_lines))
+                frame = frame.f_back
+            stack.append(name.replace(";", ":"))
+            stack.append(source.replace(";", ":"))
+            stack.reverse()
+            local[";".join(stack)] += 1
+            taken += 1
+        with self._lock:
+            self._stacks.update(local)
+        self.samples += 1
+        return taken
+
+    def _run(self, duration: Optional[float]) -> None:
+        deadline = None if duration is None else time.monotonic() + float(duration)
+        next_at = time.monotonic()
+        while not self._stop.is_set():
+            self.sample_once()
+            if deadline is not None and time.monotonic() >= deadline:
+                if self._auto_dump:
+                    self.dump()
+                break
+            next_at += self.interval
+            delay = next_at - time.monotonic()
+            if delay < 0:
+                # 落后时不补采，避免采样线程占满 GIL
+                next_at = time.monotonic()
+                delay = 0
+            self._stop.wait(delay)
+
+
+_profiler: Optional[SamplingProfiler] = None
+_profiler_config: Dict[str, Any] = dict(DEFAULT_PROFILER_CONFIG)
+_toggle_requested = threading.Event()
+_control_thread: Optional[threading.Thread] = None
+
+
+def get_profiler() -> SamplingProfiler:
+    """进程级采样器（按最近一次 install_profiler 的配置创建）。"""
+    global _profiler
+    if _profiler is None:
+        _profiler = SamplingProfiler(
+            hz=float(_profiler_config["hz"]),
+            include_lines=bool(_profiler_config["include_lines"]),
+            output_dir=str(_profiler_config["output_dir"]),
+        )
+    return _profiler
+
+
+def toggle_profiling() -> bool:
+    """控制命令：未在采样则按配置时长开始，正在采样则提前结束并写出结果。返回当前是否在采样。"""
+    profiler = get_profiler()
+    if profiler.running:
+        profiler.stop()
+        profiler.dump()
+        return False
+    return profiler.start(float(_profiler_config["duration"] or 0) or None)
+
+
+def request_toggle() -> None:
+    """信号触发入口：只置位请求标志，由控制线程执行 toggle_profiling()。"""
+    _toggle_requested.set()
+
+
+def _control_loop() -> None:
+    while True:
+        _toggle_requested.wait()
+        _toggle_requested.clear()
+        try:
+            toggle_profiling()
+        except Exception as e:
+            futures_logger.error(f"采样分析开始/结束失败: {e}", exc_info=True)
+
+
+def _ensure_control_thread() -> None:
+    global _control_thread
+    if _control_thread is None or not _control_thread.is_alive():
+        _control_thread = threading.Thread(target=_control_loop, name="fq-profiler-ctl", daemon=True)
+        _control_thread.start()
+
+
+def install_profiler(profiler_config: Optional[Dict[str, Any]] = None,
+                     loop: Optional[asyncio.AbstractEventLoop] = None) -> Optional[SamplingProfiler]:
+    """按 profiler 配置创建采样器并注册信号触发（需在主线程调用）。
+
+    Args:
+        profiler_config: profiler 配置段。
+        loop: 主事件循环；给出时经 loop.add_signal_handler 注册，否则用 signal.signal。
+            两种方式下处理函数都只置位标志，开始/结束由控制线程执行。
+
+    Returns:
+        未启用时返回 None。
+    """
+    global _profiler, _profiler_config
+    cfg = dict(DEFAULT_PROFILER_CONFIG)
+    cfg.update({k: v for k, v in (profiler_config or {}).items() if v is not None})
+    _profiler_config = cfg
+    _profiler = None
+    if not cfg.get("enable", True):
+        return None
+    profiler = get_profiler()
+    sig_name = str(cfg.get("signal") or "")
+    if sig_name:
+        signum = getattr(signal, sig_name, None)
+        if signum is None:
+            futures_logger.warning(f"当前平台不支持信号 {sig_name}，采样分析仅可通过 toggle_profiling() 触发")
+        else:
+            _ensure_control_thread()
+            if loop is not None:
+                loop.add_signal_handler(signum, request_toggle)
+            else:
+                signal.signal(signum, lambda _sig, _frame: request_toggle())
+            futures_logger.info(f"采样分析已就绪：kill -{sig_name.replace('SIG', '')} {os.getpid()} 开始/结束采样")
+    return profiler
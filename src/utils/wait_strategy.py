@@ -0,0 +1,188 @@
+# -*- coding: utf-8 -*-
+"""消费者循环空闲等待策略模块
+
+各接收/消费循环在未取到数据时调用 idle()，取到数据时调用 reset()，等待方式按配置选择：
+- busy_spin：只自旋，延迟最低，独占一个核
+- spin_yield：先自旋 spin_iters 次，之后每次让出 CPU
+- spin_park：自旋 → 让出 → 休眠（park_timeout 超时或 notify() 唤醒）
+- timed_block：直接休眠 block_timeout（等价于原先的固定 sleep，可被 notify() 提前唤醒）
+
+native_pybind 可用时使用 fq::WaitStrategy（PAUSE 指数退避 + futex 休眠，idle() 期间释放 GIL），
+否则使用等价的纯 Python 实现。stats() 分别统计自旋、让出与休眠耗时（秒）。
+asyncio 协程中的接收循环不能阻塞事件循环，使用 AsyncWaitStrategy（阶段相同，等待改为 asyncio.sleep）。
+"""
+import asyncio
+import threading
+import time
+from typing import Any, Dict, Optional
+
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+
+WAIT_MODES = ("busy_spin", "spin_yield", "spin_park", "timed_block")
+
+DEFAULT_WAIT_CONFIG = {
+    "mode": "timed_block",
+    "spin_iters": 1000,
+    "yield_iters": 100,
+    "max_pause": 64,
+    "park_timeout": 0.001,
+    "block_timeout": 0.0001,
+}
+
+
+class _WaitPhases:
+    """按模式与连续空闲次数决定本次等待阶段（spin / yield / park），两种实现共用。"""
+
+    def __init__(self, mode: str, spin_iters: int, yield_iters: int, park_timeout: float, block_timeout: float):
+        if mode not in WAIT_MODES:
+            raise ConfigError(f"未知的等待策略: {mode}，可选 {', '.join(WAIT_MODES)}")
+        self.mode = mode
+        self.spin_iters = max(0, int(spin_iters))
+        self.yield_iters = max(0, int(yield_iters))
+        self.park_timeout = max(0.0, float(park_timeout))
+        self.block_timeout = max(0.0, float(block_timeout))
+        self._idle_count = 0
+        self._stats: Dict[str, Any] = {
+            "mode": mode,
+            "spin_time": 0.0,
+            "yield_time": 0.0,
+            "park_time": 0.0,
+            "spins": 0,
+            "yields": 0,
+            "parks": 0,
+            "wakeups": 0,
+        }
+
+    def _next_phase(self):
+        """返回 (阶段, 休眠超时)，并推进空闲计数。"""
+        n = self._idle_count
+        self._idle_count += 1
+        if self.mode == "busy_spin":
+            return "spin", 0.0
+        if self.mode == "timed_block":
+            return "park", self.block_timeout
+        if n < self.spin_iters:
+            return "spin", 0.0
+        if self.mode == "spin_yield" or n < self.spin_iters + self.yield_iters:
+            return "yield", 0.0
+        return "park", self.park_timeout
+
+    def _account(self, phase: str, elapsed: float) -> None:
+        s = self._stats
+        if phase == "spin":
+            s["spin_time"] += elapsed
+            s["spins"] += 1
+        elif phase == "yield":
+            s["yield_time"] += elapsed
+            s["yields"] += 1
+        else:
+            s["park_time"] += elapsed
+            s["parks"] += 1
+
+    def reset(self) -> None:
+        """取到数据，回到自旋阶段。"""
+        self._idle_count = 0
+
+    def stats(self) -> Dict[str, Any]:
+        """自旋 / 让出 / 休眠耗时（秒）与各阶段次数。"""
+        return dict(self._stats)
+
+
+class WaitStrategy(_WaitPhases):
+    """纯 Python 等待策略，与 native_pybind.WaitStrategy 接口一致（时间单位：秒）。
+
+    Python 无法发出 PAUSE 指令，自旋阶段 idle() 立即返回，由调用方的轮询循环构成自旋。
+    """
+
+    def __init__(
+        self,
+        mode: str = "spin_park",
+        spin_iters: int = 1000,
+        yield_iters: int = 100,
+        max_pause: int = 64,
+        park_timeout: float = 0.001,
+        block_timeout: float = 0.0001,
+    ):
+        super().__init__(mode, spin_iters, yield_iters, park_timeout, block_timeout)
+        self.max_pause = max(1, int(max_pause))
+        self._event = threading.Event()
+
+    def idle(self) -> None:
+        """本轮未取到数据，按当前阶段等待一次。"""
+        phase, timeout = self._next_phase()
+        t0 = time.perf_counter()
+        if phase == "yield":
+            time.sleep(0)
+        elif phase == "park":
+            if self._event.wait(timeout):
+                self._event.clear()
+                self._stats["wakeups"] += 1
+        self._account(phase, time.perf_counter() - t0)
+
+    def notify(self) -> None:
+        """唤醒休眠中的消费者。"""
+        self._event.set()
+
+
+class AsyncWaitStrategy(_WaitPhases):
+    """asyncio 接收循环用的等待策略：自旋/让出阶段 await asyncio.sleep(0)，休眠阶段 await asyncio.sleep(超时)。"""
+
+    def __init__(
+        self,
+        mode: str = "timed_block",
+        spin_iters: int = 1000,
+        yield_iters: int = 100,
+        park_timeout: float = 0.001,
+        block_timeout: float = 0.01,
+        **_ignored: Any,
+    ):
+        super().__init__(mode, spin_iters, yield_iters, park_timeout, block_timeout)
+
+    async def idle(self) -> None:
+        """本轮未取到数据，按当前阶段让出事件循环一次。"""
+        phase, timeout = self._next_phase()
+        t0 = time.perf_counter()
+        await asyncio.sleep(timeout if phase == "park" else 0)
+        self._account(phase, time.perf_counter() - t0)
+
+
+def _normalize(wait_config: Optional[Dict[str, Any]], defaults: Optional[Dict[str, Any]]) -> Dict[str, Any]:
+    cfg = dict(DEFAULT_WAIT_CONFIG)
+    for source in (defaults, wait_config):
+        for key in DEFAULT_WAIT_CONFIG:
+            if source and source.get(key) is not None:
+                cfg[key] = source[key]
+    cfg["mode"] = str(cfg["mode"])
+    if cfg["mode"] not in WAIT_MODES:
+        raise ConfigError(f"未知的等待策略: {cfg['mode']}，可选 {', '.join(WAIT_MODES)}")
+    for key in ("spin_iters", "yield_iters", "max_pause"):
+        cfg[key] = int(cfg[key])
+    for key in ("park_timeout", "block_timeout"):
+        cfg[key] = float(cfg[key])
+    return cfg
+
+
+def create_wait_strategy(
+    wait_config: Optional[Dict[str, Any]] = None,
+    defaults: Optional[Dict[str, Any]] = None,
+):
+    """按 wait_strategy 配置段创建线程循环用的等待策略（native 优先）。
+
+    Args:
+        wait_config: 配置段（mode、spin_iters、yield_iters、max_pause、park_timeout、block_timeout）。
+        defaults: 调用方的默认值（如保持原先固定 sleep 的 block_timeout），优先级低于 wait_config。
+    """
+    cfg = _normalize(wait_config, defaults)
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "WaitStrategy"):
+        return m.WaitStrategy(**cfg)
+    return WaitStrategy(**cfg)
+
+
+def create_async_wait_strategy(
+    wait_config: Optional[Dict[str, Any]] = None,
+    defaults: Optional[Dict[str, Any]] = None,
+) -> AsyncWaitStrategy:
+    """按 wait_strategy 配置段创建 asyncio 接收循环用的等待策略。"""
+    return AsyncWaitStrategy(**_normalize(wait_config, defaults))
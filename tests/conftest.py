@@ -1,11 +1,43 @@
 # -*- coding: utf-8 -*-
 """pytest 共享配置与 fixture
-统一添加项目根目录到 sys.path，供所有测试模块导入 src
+统一添加项目根目录到 sys.path，供所有测试模块导入 src；
+提供各测试模块共用的标准化行情构造函数 make_tick（from tests.conftest import make_tick）
 """
+import datetime
 import sys
 from pathlib import Path
+from typing import Any, Dict
 
 # 添加项目根目录到 Python 路径
 project_root = Path(__file__).parent.parent
 if str(project_root) not in sys.path:
     sys.path.insert(0, str(project_root))
+
+BASE_TIME = datetime.datetime(2025, 1, 29, 9, 30, 0)
+
+# DataParser 输出的标准化字段顺序
+_FIELD_ORDER = (
+    "symbol", "instrument_id", "exchange", "last_price", "volume", "turnover", "open_interest", "datetime",
+    "bid_price_1", "bid_volume_1", "ask_price_1", "ask_volume_1",
+    "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+)
+
+
+def make_tick(symbol: str = "rb2505", ms: int = 0, **fields: Any) -> Dict[str, Any]:
+    """构造一条标准化行情 dict。
+
+    Args:
+        symbol: 合约代码。
+        ms: 相对 BASE_TIME 的毫秒偏移（fields 中给出 datetime 时忽略）。
+        fields: 其余字段；exchange 默认 SHFE。只包含给出的字段，标准字段按 DataParser 顺序排列，
+            非标准字段（如 seq）追加在后。
+
+    Returns:
+        行情 dict。
+    """
+    fields["symbol"] = symbol
+    fields.setdefault("exchange", "SHFE")
+    fields.setdefault("datetime", BASE_TIME + datetime.timedelta(milliseconds=ms))
+    tick = {k: fields.pop(k) for k in _FIELD_ORDER if k in fields}
+    tick.update(fields)
+    return tick
@@ -0,0 +1,111 @@
+# -*- coding: utf-8 -*-
+"""自适应攒批控制器单元测试
+测试 AdaptiveBatcher（纯 Python 实现）的空闲/繁忙切换、刷新条件、轮询间隔，
+以及 AsyncFuturesCollector 自适应分发循环
+"""
+import asyncio
+
+import pytest
+
+from src.collector.adaptive_batcher import AdaptiveBatcher, create_batcher
+from src.collector.async_collector import AsyncFuturesCollector
+
+
+def _drive(batcher, rate, seconds=2.0, step=0.001):
+    """按固定速率模拟到达，返回结束时刻"""
+    now = 0.0
+    per_step = rate * step
+    acc = 0.0
+    while now < seconds:
+        now += step
+        acc += per_step
+        n = int(acc)
+        acc -= n
+        batcher.observe(n, now)
+    return now
+
+
+class TestAdaptiveBatcher:
+    """AdaptiveBatcher 单元测试"""
+
+    @pytest.fixture
+    def batcher(self):
+        return AdaptiveBatcher(max_latency=0.02, max_batch=1000, idle_rate=200.0, rate_window=0.1)
+
+    def test_idle_flushes_immediately(self, batcher):
+        """测试低速率时目标批大小为 1，有数据即刷新"""
+        now = _drive(batcher, rate=50)
+        m = batcher.metrics()
+        assert not m["batching"]
+        assert m["target_batch"] == 1
+        assert batcher.should_flush(1, now, now)
+        assert batcher.next_poll_interval(0, 0.0, now) == batcher.max_poll_interval
+
+    def test_busy_grows_batch(self, batcher):
+        """测试高速率时按延迟预算攒批"""
+        now = _drive(batcher, rate=20000)
+        m = batcher.metrics()
+        assert m["batching"]
+        assert m["arrival_rate"] == pytest.approx(20000, rel=0.05)
+        assert 350 <= m["target_batch"] <= 400
+        assert not batcher.should_flush(10, now, now)
+        assert batcher.should_flush(m["target_batch"], now, now)
+        assert batcher.next_poll_interval(0, 0.0, now) == batcher.min_poll_interval
+
+    def test_target_capped_by_max_batch(self, batcher):
+        """测试目标批大小不超过 max_batch"""
+        _drive(batcher, rate=200000, seconds=1.0)
+        assert batcher.metrics()["target_batch"] == 1000
+
+    def test_latency_budget_forces_flush(self, batcher):
+        """测试最早一条等待超过 max_latency 时强制刷新"""
+        now = _drive(batcher, rate=20000)
+        assert not batcher.should_flush(5, now - 0.01, now)
+        assert batcher.should_flush(5, now - 0.02, now)
+
+    def test_poll_interval_tracks_deadline(self, batcher):
+        """测试有积压时轮询间隔不超过剩余预算且有下限"""
+        now = _drive(batcher, rate=20000)
+        assert batcher.next_poll_interval(5, now - 0.0199, now) == batcher.min_poll_interval
+        assert batcher.next_poll_interval(5, now - 0.019, now) == pytest.approx(0.001)
+        assert batcher.next_poll_interval(5, now, now) == batcher.max_poll_interval
+
+    def test_on_flush_metrics(self, batcher):
+        """测试刷新统计"""
+        batcher.on_flush(10, 1.0, 1.004)
+        batcher.on_flush(5, 2.0, 2.001)
+        m = batcher.metrics()
+        assert m["flushes"] == 2 and m["flushed"] == 15
+        assert m["last_batch"] == 5
+        assert m["max_delay"] == pytest.approx(0.004)
+
+    def test_create_batcher_defaults(self):
+        """测试配置缺省项回退为默认值"""
+        b = create_batcher({"max_latency": 0.05})
+        assert b.metrics()["target_batch"] == 1
+        assert b.should_flush(1, 0.0, 0.0)
+
+
+class TestAdaptiveDispatch:
+    """AsyncFuturesCollector 自适应分发循环"""
+
+    def test_fixed_mode_has_no_metrics(self):
+        """测试 fixed 模式不创建控制器"""
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {"dispatcher": {"mode": "fixed"}})
+        assert collector.dispatch_metrics() is None
+
+    def test_adaptive_dispatch_delivers_all(self):
+        """测试自适应分发循环把所有数据交给回调并记录工作点"""
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {"dispatcher": {"mode": "adaptive"}})
+        rounds = [[{"i": 0}], [], [{"i": 1}, {"i": 2}], []]
+        collector.collect_data = lambda: rounds.pop(0) if rounds else []
+        received = []
+
+        async def on_data(data_list):
+            received.extend(data_list)
+            if len(received) >= 3:
+                collector.stop()
+
+        asyncio.run(collector.run_forever(on_data))
+        assert [d["i"] for d in received] == [0, 1, 2]
+        assert collector.dispatch_metrics()["flushed"] == 3
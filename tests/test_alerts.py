@@ -0,0 +1,173 @@
+# -*- coding: utf-8 -*-
+"""行情告警规则单元测试
+测试表达式编译（运算优先级、时长与百分比字面量、常量折叠、变量、错误报告），
+AlertEngine（纯 Python 实现，原生可用时同样覆盖）的持续时长、冷却与重新计时、as-of 涨跌幅、
+NaN 比较、合约作用域与事件取值，以及流水线 alerts 阶段与边类型校验
+"""
+import math
+
+import pytest
+
+from src.processor.alerts import (
+    FIELD_INDEX, OP_CONST, OP_FIELD, OP_GT, AlertEngine, compile_rules, create_alert_engine,
+)
+from src.processor.pipeline import Pipeline
+from src.processor.symbol_table import get_symbol_table
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+
+def _tick(ms, symbol, last, bid=0.0, ask=0.0, bid_vol=1, ask_vol=1):
+    return make_tick(symbol, ms, instrument_id=get_symbol_table().intern(symbol), last_price=last, volume=1,
+                     bid_price_1=bid, bid_volume_1=bid_vol, ask_price_1=ask, ask_volume_1=ask_vol)
+
+
+def _engines():
+    engines = [AlertEngine]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "AlertEngine"):
+        engines.append(m.AlertEngine)
+    return engines
+
+
+def _engine(engine_cls, rules, history=64):
+    return engine_cls(*compile_rules(rules), instruments=4096, history_size=history)
+
+
+class TestCompiler:
+    """表达式编译"""
+
+    def test_constant_folding(self):
+        program = compile_rules([{"name": "wide", "when": "spread > 3 * tick for 5s", "vars": {"tick": 0.5}}])
+        assert program.ops == [OP_FIELD, OP_CONST, OP_GT]
+        assert program.args[0] == FIELD_INDEX["spread"] and program.consts == [1.5]
+        assert program.rules[0][:6] == (0, 3, 3, 3, 5000000, 0)
+
+    def test_literals_and_history(self):
+        program = compile_rules([
+            {"name": "a", "when": "abs(pct(last, 10s)) >= 1% and delta(mid, 500ms) > 0"},
+            {"name": "b", "when": "ago(last, 10s) > 0", "for": 2, "cooldown": 60},
+        ])
+        assert 0.01 in program.consts
+        # 相同 (字段, 时长) 共用一个历史槽位
+        assert program.history == [(FIELD_INDEX["last_price"], 10000000), (FIELD_INDEX["mid_price"], 500000)]
+        assert program.rules[1][4:6] == (2000000, 60000000)
+
+    @pytest.mark.parametrize("when", [
+        "spred > 1", "spread >", "spread > 1 for", "spread > 1 for 1%", "foo(spread)",
+        "pct(last, 0s) > 0", "spread > 1 spread", "spread > $",
+    ])
+    def test_invalid(self, when):
+        with pytest.raises(ConfigError):
+            compile_rules([{"name": "r", "when": when}])
+
+    def test_invalid_rules(self):
+        with pytest.raises(ConfigError):
+            compile_rules([])
+        with pytest.raises(ConfigError):
+            compile_rules([{"name": "r", "when": "spread > 1"}, {"name": "r", "when": "spread > 2"}])
+        with pytest.raises(ConfigError):
+            compile_rules([{"name": "r", "when": "spread > last", "vars": {"last": 1.0}}])
+        # 右结合嵌套 70 层超出栈深上限
+        when = "last"
+        for _ in range(70):
+            when = f"last - ({when})"
+        with pytest.raises(ConfigError):
+            compile_rules([{"name": "r", "when": when + " > 0"}])
+
+
+@pytest.mark.parametrize("engine_cls", _engines())
+class TestAlertEngine:
+    """规则求值与触发"""
+
+    def test_hold_and_rearm(self, engine_cls):
+        e = _engine(engine_cls, [{"name": "wide", "when": "spread > 3 * tick for 2s", "vars": {"tick": 1.0},
+                                  "value": "spread / tick"}])
+        ticks = [_tick(ms, "al2503", 100.0, 100.0, 100.0 + spread) for ms, spread in [
+            (0, 4.0), (1000, 5.0), (2000, 4.0), (2500, 4.0),  # 持续满 2 秒触发一次
+            (3000, 1.0), (3500, 4.0), (5400, 4.0), (5600, 6.0),  # 转假后重新计时
+        ]]
+        events = e.evaluate(ticks)
+        assert [(ev["datetime"], ev["value"]) for ev in events] == [
+            (ticks[2]["datetime"], 4.0), (ticks[7]["datetime"], 6.0),
+        ]
+        ev = events[0]
+        assert list(ev) == [
+            "symbol", "instrument_id", "exchange", "datetime", "event", "rule", "value",
+            "last_price", "bid_price_1", "ask_price_1",
+        ]
+        assert ev["symbol"] == "al2503" and ev["event"] == "alert" and ev["rule"] == "wide"
+        assert e.ticks == 8 and e.evaluations == 8 and e.fired == 2
+
+    def test_cooldown(self, engine_cls):
+        e = _engine(engine_cls, [{"name": "high", "when": "last > 100", "cooldown": 10}])
+        prices = [(0, 101.0), (1000, 99.0), (2000, 101.0), (11000, 99.0), (12000, 101.0)]
+        events = e.evaluate([_tick(ms, "al2504", px) for ms, px in prices])
+        assert [ev["last_price"] for ev in events] == [101.0, 101.0]
+        assert [ev["datetime"].second for ev in events] == [0, 12]
+        assert math.isnan(events[0]["value"])
+
+    def test_pct_move(self, engine_cls):
+        e = _engine(engine_cls, [{"name": "move", "when": "abs(pct(last, 10s)) >= 1%", "value": "pct(last, 10s)"}])
+        ticks = [_tick(ms, "cu2505", px) for ms, px in [
+            (0, 100.0), (5000, 100.5), (9000, 101.5), (11000, 101.2), (12000, 100.0), (16000, 98.9),
+        ]]
+        events = e.evaluate(ticks)
+        # 11 秒时 10 秒前的 as-of 价为 100.0（+1.2%）；16 秒时为 100.5（-1.59%）
+        assert [ev["datetime"] for ev in events] == [ticks[3]["datetime"], ticks[5]["datetime"]]
+        assert events[0]["value"] == pytest.approx(0.012)
+        assert events[1]["value"] == pytest.approx(98.9 / 100.5 - 1)
+
+    def test_nan_and_scope(self, engine_cls):
+        e = _engine(engine_cls, [
+            {"name": "one_sided", "when": "not (spread >= 0)"},
+            {"name": "ne", "when": "spread != 1"},
+            {"name": "scoped", "when": "imbalance > 0.5", "symbols": ["zn2505"], "value": "bid_volume_1"},
+        ])
+        events = e.evaluate([
+            _tick(0, "zn2505", 10.0, 0.0, 10.0, bid_vol=9),  # 单边报价：spread 为 NaN
+            _tick(0, "pb2505", 10.0, 9.0, 11.0, bid_vol=9),
+        ])
+        assert [(ev["symbol"], ev["rule"]) for ev in events] == [
+            ("zn2505", "one_sided"), ("zn2505", "scoped"), ("pb2505", "ne"),
+        ]
+        assert events[1]["value"] == 9.0
+        e.reset()
+        assert e.ticks == 0 and e.fired == 0
+
+
+class TestAlertStage:
+    """配置与流水线阶段"""
+
+    def test_pipeline_stage(self):
+        received = []
+        pipeline = Pipeline([
+            {"name": "alerts", "type": "alerts", "threads": 0, "native": False, "log": False,
+             "rules": [{"name": "wide", "when": "spread > 2"}]},
+            {"name": "wide_only", "type": "filter", "inputs": ["alerts"], "threads": 0, "symbols": ["ni2505"]},
+            {"name": "sink", "type": "python", "inputs": ["wide_only"], "threads": 0,
+             "callable": "tests.test_alerts:collect_factory", "received": received},
+        ]).start()
+        pipeline.submit([_tick(i, "ni2505" if i % 2 else "sn2505", 10.0, 10.0, 13.0) for i in range(4)])
+        pipeline.close()
+        assert [(ev["symbol"], ev["rule"]) for ev in received] == [("ni2505", "wide")]
+        assert pipeline.metrics()["alerts"]["out"] == 2
+
+    def test_edge_types(self):
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "alerts", "type": "alerts", "rules": [{"name": "r", "when": "last > 0"}]},
+                {"name": "trades", "type": "trades", "inputs": ["alerts"]},
+            ])
+        with pytest.raises(ConfigError):
+            create_alert_engine({"rules": [{"name": "r", "when": "last >"}]})
+
+
+def collect_factory(cfg, _shard):
+    received = cfg["received"]
+
+    def collect(data_list):
+        received.extend(data_list)
+        return data_list
+    return collect
@@ -0,0 +1,102 @@
+# -*- coding: utf-8 -*-
+"""热路径分配守卫单元测试
+使用模拟的原生计数模块，测试 AllocationGuard 的校准、预热豁免、违例统计与 strict 模式
+"""
+import pytest
+
+from src.utils.alloc_tracker import AllocationGuard, alloc_tracking_enabled, create_alloc_guard
+from src.utils.exceptions import AllocationError
+
+DISPATCH = 2  # 模拟每次原生调用分发的固定分配数
+
+
+class FakeNative:
+    """模拟 FQ_ALLOC_TRACKING 构建的 native_pybind：每次调用计入固定分发分配"""
+
+    def __init__(self, enabled=True):
+        self.enabled = enabled
+        self.counter = 0
+
+    def alloc_tracking_enabled(self):
+        return self.enabled
+
+    def call(self, allocs=0):
+        """模拟一次热路径调用：分发开销 + 函数体内分配"""
+        self.counter += DISPATCH + allocs
+
+    def AllocScope(self):
+        native = self
+
+        class Scope:
+            def __init__(self):
+                self.start = 0
+
+            def restart(self):
+                native.counter += DISPATCH
+                self.start = native.counter
+
+            def allocations(self):
+                native.counter += DISPATCH
+                return native.counter - self.start
+        return Scope()
+
+
+class TestAllocationGuard:
+    """分配守卫"""
+
+    def test_unavailable_is_noop(self):
+        native = FakeNative(enabled=False)
+        assert not alloc_tracking_enabled(native)
+        guard = AllocationGuard("feed", warmup=0, strict=True, native=native)
+        guard.begin()
+        native.call(allocs=5)
+        guard.end()
+        assert guard.stats()["available"] is False
+        assert guard.violations == 0
+
+    def test_dispatch_overhead_calibrated(self):
+        native = FakeNative()
+        guard = AllocationGuard("feed", warmup=0, native=native)
+        for _ in range(100):
+            guard.begin()
+            native.call()
+            guard.end()
+        guard.assert_steady()
+        assert guard.stats()["iterations"] == 100
+
+    def test_warmup_exempt_then_violation(self):
+        native = FakeNative()
+        guard = AllocationGuard("feed", warmup=3, native=native)
+        for i in range(6):
+            guard.begin()
+            native.call(allocs=1 if i in (0, 4) else 0)
+            guard.end()
+        s = guard.stats()
+        assert s["steady"] and s["violations"] == 1 and s["leaked_allocs"] == 1
+        with pytest.raises(AllocationError):
+            guard.assert_steady()
+
+    def test_strict_raises(self):
+        native = FakeNative()
+        guard = AllocationGuard("feed", warmup=0, strict=True, native=native)
+        guard.begin()
+        native.call(allocs=2)
+        with pytest.raises(AllocationError):
+            guard.end()
+
+    def test_calls_per_iteration(self):
+        native = FakeNative()
+        guard = AllocationGuard("feed", warmup=0, calls_per_iteration=3, native=native)
+        guard.begin()
+        for _ in range(3):
+            native.call()
+        guard.end()
+        assert guard.violations == 0
+
+
+class TestFactory:
+    """配置工厂"""
+
+    def test_disabled_returns_none(self):
+        assert create_alloc_guard("feed", None) is None
+        assert create_alloc_guard("feed", {"enable": False}) is None
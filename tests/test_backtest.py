@@ -0,0 +1,165 @@
+# -*- coding: utf-8 -*-
+"""回测引擎单元测试
+测试 FillSimulator 的延迟、对手价成交、排队位置与撤单，以及 BacktestEngine 的多合约归并回放、
+持仓盈亏、从 FileStorage 读回录制行情与回放行情日文件
+"""
+import datetime
+
+from src.backtest.engine import BacktestEngine, merge_ticks
+from src.backtest.fill_simulator import FillSimulator, sim_time
+from src.storage.file_storage import FileStorage
+from src.storage.tick_file import TickFile, write_tick_file
+from tests.conftest import make_tick
+
+
+def _tick(ms, volume, last, bid=100.0, ask=101.0, bid_vol=10, ask_vol=10, iid=1, symbol="rb2505"):
+    return make_tick(symbol, ms, instrument_id=iid, last_price=last, volume=volume, open_interest=0.0,
+                     bid_price_1=bid, bid_volume_1=bid_vol, ask_price_1=ask, ask_volume_1=ask_vol)
+
+
+def _ts(ms):
+    return sim_time(datetime.datetime(2025, 1, 29, 9, 30, 0) + datetime.timedelta(milliseconds=ms))
+
+
+class TestFillSimulator:
+    """撮合模拟"""
+
+    def test_latency_hides_earlier_ticks(self):
+        """委托到达前的行情不触发成交，到达后按对手价成交"""
+        sim = FillSimulator(latency=0.1)
+        sim.on_tick(_tick(0, 0, 100.5))
+        oid = sim.submit(1, 1, 0.0, 2, _ts(0))
+        assert sim.on_tick(_tick(50, 0, 100.5)) == []
+        fills = sim.on_tick(_tick(100, 0, 100.5, ask=102.0))
+        assert [(f["order_id"], f["price"], f["volume"], f["liquidity"]) for f in fills] == [(oid, 102.0, 2, "taker")]
+        assert sim.live_orders() == 0
+
+    def test_queue_position(self):
+        """挂在买一之后：同价成交先消耗前方 10 手，再轮到本单"""
+        sim = FillSimulator()
+        sim.on_tick(_tick(0, 0, 100.5))
+        sim.submit(1, 1, 100.0, 3, _ts(0))
+        assert sim.on_tick(_tick(1, 0, 100.5)) == []          # 到达，排在 10 手之后
+        assert sim.on_tick(_tick(2, 8, 100.0)) == []          # 前方剩 2
+        fills = sim.on_tick(_tick(3, 12, 100.0))              # 消耗 4，本单成交 2
+        assert [(f["volume"], f["liquidity"]) for f in fills] == [(2, "maker")]
+        fills = sim.on_tick(_tick(4, 13, 100.0))
+        assert [f["volume"] for f in fills] == [1]
+
+    def test_cancels_ahead_shrink_queue(self):
+        sim = FillSimulator()
+        sim.on_tick(_tick(0, 0, 100.5))
+        sim.submit(1, 1, 100.0, 1, _ts(0))
+        sim.on_tick(_tick(1, 0, 100.5))
+        sim.on_tick(_tick(2, 0, 100.5, bid_vol=1))            # 前方撤到 1 手
+        assert [f["volume"] for f in sim.on_tick(_tick(3, 2, 100.0, bid_vol=1))] == [1]
+
+    def test_shrinking_display_not_double_counted(self):
+        """显示挂量随成交减少：减少的部分是成交而不是撤单，前方 10 手要成交满 10 手才轮到本单"""
+        sim = FillSimulator()
+        sim.on_tick(_tick(0, 0, 100.5))
+        sim.submit(1, 1, 100.0, 2, _ts(0))
+        sim.on_tick(_tick(1, 0, 100.5))                          # 到达，排在 10 手之后
+        assert sim.on_tick(_tick(2, 5, 100.0, bid_vol=5)) == []  # 成交 5，显示降到 5：前方剩 5
+        assert sim.on_tick(_tick(3, 6, 100.0, bid_vol=4)) == []  # 前方剩 4
+        assert sim.on_tick(_tick(4, 8, 100.0, bid_vol=1)) == []  # 成交 2 且撤 1：前方剩 1
+        fills = sim.on_tick(_tick(5, 10, 100.0, bid_vol=1))       # 成交 2，本单成交 1
+        assert [(f["volume"], f["liquidity"]) for f in fills] == [(1, "maker")]
+
+    def test_grow_then_cancel_does_not_overfill(self):
+        """挂量先在本单之后增加再撤回：撤单不能把前方排队扣成负数，成交 1 手只能成交 1 手"""
+        sim = FillSimulator()
+        sim.on_tick(_tick(0, 0, 100.5))
+        sim.submit(1, 1, 100.0, 5, _ts(0))
+        sim.on_tick(_tick(1, 0, 100.5))                           # 到达，排在 10 手之后
+        assert sim.on_tick(_tick(2, 0, 100.5, bid_vol=30)) == []  # 本单之后新增 20
+        assert sim.on_tick(_tick(3, 0, 100.5, bid_vol=5)) == []   # 撤 25：前方至多撤光
+        fills = sim.on_tick(_tick(4, 1, 100.0, bid_vol=5))
+        assert [(f["volume"], f["liquidity"]) for f in fills] == [(1, "maker")]
+        assert sim.live_orders() == 1
+
+    def test_trade_through_fills_all(self):
+        sim = FillSimulator()
+        sim.on_tick(_tick(0, 0, 100.5))
+        sim.submit(1, -1, 101.0, 5, _ts(0))
+        sim.on_tick(_tick(1, 0, 100.5))
+        fills = sim.on_tick(_tick(2, 0, 101.5, bid=101.0, ask=102.0))
+        assert [(f["side"], f["price"], f["volume"]) for f in fills] == [(-1, 101.0, 5)]
+
+    def test_cancel(self):
+        sim = FillSimulator()
+        oid = sim.submit(1, 1, 0.0, 1, _ts(0))
+        assert sim.cancel(oid) and not sim.cancel(oid)
+        assert sim.on_tick(_tick(1, 0, 100.5)) == []
+        assert sim.submit(1, 2, 100.0, 1, _ts(0)) == 0
+
+
+class _BuyOnce:
+    def __init__(self):
+        self.seen = []
+        self.filled = []
+
+    def on_ticks(self, data_list, ctx):
+        self.seen.extend(d["symbol"] for d in data_list)
+        if len(self.seen) == 1:
+            ctx.buy(data_list[0], 1)
+
+    def on_fill(self, fill, ctx):
+        self.filled.append(fill)
+
+
+class TestBacktestEngine:
+    """回测引擎"""
+
+    def test_merge_order(self):
+        a = [_tick(0, 0, 1, symbol="a"), _tick(2, 0, 1, symbol="a")]
+        b = [_tick(1, 0, 1, symbol="b"), _tick(2, 0, 1, symbol="b")]
+        assert [d["symbol"] for d in merge_ticks([a, b])] == ["a", "b", "a", "b"]
+
+    def test_run_pnl(self):
+        strategy = _BuyOnce()
+        engine = BacktestEngine(strategy, {"native": False, "multipliers": {"rb": 10}})
+        result = engine.run([
+            [_tick(0, 0, 100.5), _tick(2, 0, 103.0, bid=103.0, ask=104.0)],
+            [_tick(1, 0, 50.0, iid=2, symbol="au2506")],
+        ])
+        assert strategy.seen == ["rb2505", "au2506", "rb2505"]
+        # 市价买入在下一条 rb 行情按卖一 104 成交，以最新价 103 计盈亏
+        assert len(strategy.filled) == 1 and strategy.filled[0]["price"] == 104.0
+        assert result["ticks"] == 3 and result["fills"] == 1
+        assert result["positions"]["rb2505"]["position"] == 1
+        assert result["pnl"] == -10.0
+
+    def test_run_day_from_storage(self, tmp_path):
+        storage = FileStorage(base_path=str(tmp_path))
+        storage.save([_tick(0, 0, 100.5), _tick(5, 3, 101.0)])
+        storage.save([_tick(1, 7, 50.0, iid=2, symbol="au2506")])
+        loaded = storage.load("rb2505", "20250129")
+        assert loaded[1]["volume"] == 3 and isinstance(loaded[1]["volume"], int)
+        assert loaded[1]["datetime"] == _tick(5, 3, 101.0)["datetime"]
+        strategy = _BuyOnce()
+        result = BacktestEngine(strategy, {"native": False}).run_day(str(tmp_path), "20250129")
+        assert sorted(strategy.seen) == ["au2506", "rb2505", "rb2505"]
+        assert result["ticks"] == 3
+
+    def test_load_day_sorts_late_rows(self, tmp_path):
+        """乱序追加的行情读回时按时间排序，同一时刻保持写入顺序"""
+        storage = FileStorage(base_path=str(tmp_path))
+        storage.save([_tick(0, 0, 100.0), _tick(20, 2, 100.2), _tick(10, 1, 100.1), _tick(20, 3, 100.3)])
+        day = storage.load_day("20250129")
+        assert [d["volume"] for d in day["rb2505"]] == [0, 1, 2, 3]
+
+    def test_run_tick_files(self, tmp_path):
+        """日文件回放（纯 Python 回退路径）与 dict 回放一致，可按合约过滤"""
+        rb = [_tick(0, 0, 100.5), _tick(2, 0, 103.0, bid=103.0, ask=104.0)]
+        au = [_tick(1, 0, 50.0, iid=2, symbol="au2506")]
+        path = str(tmp_path / "20250129.fqt")
+        write_tick_file(path, [rb, au])
+        cfg = {"native": False, "multipliers": {"rb": 10}}
+        strategy = _BuyOnce()
+        result = BacktestEngine(strategy, cfg).run_tick_files([TickFile(path)], chunk=1)
+        assert strategy.seen == ["rb2505", "au2506", "rb2505"]
+        assert result["fills"] == 1 and result["pnl"] == -10.0
+        strategy = _BuyOnce()
+        result = BacktestEngine(strategy, cfg).run_tick_files([TickFile(path)], symbols=["au2506"])
+        assert strategy.seen == ["au2506"] and result["ticks"] == 1
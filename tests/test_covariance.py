@@ -0,0 +1,149 @@
+# -*- coding: utf-8 -*-
+"""跨合约指数加权协方差单元测试
+测试 EwmCovariance（numpy 实现，原生可用时同样覆盖）与逐步朴素公式一致、相关系数与快照、
+观测不足为 NaN、空档不计跨档收益，以及流水线 covariance 阶段的定期快照与落盘读回
+"""
+import math
+
+import numpy as np
+import pytest
+
+from src.processor.covariance import EwmCovariance, ewm_alpha_from_halflife, load_covariance
+from src.processor.pipeline import Pipeline
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+
+def _tick(ms, iid, last, bid=0.0, ask=0.0):
+    return make_tick(f"x{iid}", ms, instrument_id=iid, last_price=last, volume=1, bid_price_1=bid, ask_price_1=ask)
+
+
+def _engines():
+    engines = [EwmCovariance]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "EwmCovariance"):
+        engines.append(m.EwmCovariance)
+    return engines
+
+
+def _random_walk(n, steps, seed=7):
+    """每个网格步（1 秒）每个合约一条行情；合约 1 与合约 0 强相关"""
+    rng = np.random.default_rng(seed)
+    px = np.full(n, 100.0)
+    ticks, grid_px = [], []
+    for s in range(steps):
+        shock = rng.normal(0.0, 1e-3, n)
+        shock[1] = 0.9 * shock[0] + 0.1 * shock[1]
+        px = px * np.exp(shock)
+        grid_px.append(px.copy())
+        ticks += [_tick(s * 1000 + 100 + i, i, float(px[i])) for i in range(n)]
+    return ticks, np.array(grid_px)
+
+
+def _reference(grid_px, alpha):
+    n = grid_px.shape[1]
+    mean, cov = np.zeros(n), np.zeros((n, n))
+    for prev, cur in zip(grid_px[:-1], grid_px[1:]):
+        d = np.log(cur / prev) - mean
+        mean += alpha * d
+        cov = (1 - alpha) * (cov + alpha * np.outer(d, d))
+    return cov
+
+
+@pytest.mark.parametrize("engine_cls", _engines())
+class TestEwmCovariance:
+    """指数加权协方差"""
+
+    def test_matches_reference(self, engine_cls):
+        ticks, grid_px = _random_walk(11, 80)
+        e = engine_cls(instruments=11, interval=1.0, halflife=20.0)
+        # 最后一批行情触发第 80 个网格点之前的全部更新
+        assert e.update(ticks + [_tick(80 * 1000 + 100, 0, float(grid_px[-1, 0]))]) == 80
+        ref = _reference(grid_px, ewm_alpha_from_halflife(20.0))
+        np.testing.assert_allclose(e.snapshot(), ref, rtol=1e-9, atol=1e-18)
+        assert e.cov(3, 7) == pytest.approx(ref[3, 7], rel=1e-9)
+        assert e.cov(7, 3) == e.cov(3, 7)
+        assert e.corr(0, 1) > 0.9 and e.corr(2, 2) == 1.0
+        corr = e.snapshot(correlation=True, n=4)
+        assert corr.shape == (4, 4)
+        assert corr[0, 1] == pytest.approx(e.corr(0, 1), rel=1e-12)
+        assert e.nobs(0) == 79 and e.steps == 80
+
+    def test_min_periods_and_mid(self, engine_cls):
+        e = engine_cls(instruments=3, interval=1.0, halflife=5.0, min_periods=2)
+        # 合约 0 有双边报价取中间价；合约 2 始终无行情
+        e.update([_tick(100, 0, 1.0, 99.0, 101.0), _tick(200, 1, 50.0)])
+        assert e.mids()[0] == 100.0 and math.isnan(e.mids()[2])
+        e.update([_tick(1100, 0, 1.0, 100.0, 102.0), _tick(1200, 1, 51.0), _tick(2100, 0, 1.0, 99.0, 101.0)])
+        assert e.nobs(0) == 1 and math.isnan(e.cov(0, 1))
+        e.update([_tick(2200, 1, 50.0), _tick(3100, 0, 1.0, 100.0, 102.0)])
+        assert e.nobs(0) == 2 and e.corr(0, 1) == pytest.approx(1.0)
+        snap = e.snapshot()
+        assert np.isnan(snap[2]).all() and np.isnan(snap[:, 2]).all()
+        assert math.isnan(e.cov(0, 5))
+
+    def test_gap_skips_return(self, engine_cls):
+        """超过 max_gap 的空档后，下一个网格点只作为收益基准"""
+        e = engine_cls(instruments=1, interval=1.0, halflife=5.0, max_gap=10.0, min_periods=1)
+        e.update([_tick(100, 0, 100.0), _tick(1100, 0, 101.0), _tick(2100, 0, 101.0)])
+        var = e.cov(0, 0)
+        assert e.nobs(0) == 1 and var > 0
+        # 午休后跳空 20%：跨档收益不计入，方差只衰减
+        e.update([_tick(600000, 0, 120.0), _tick(601100, 0, 120.0), _tick(602100, 0, 120.0)])
+        assert e.nobs(0) == 4
+        assert e.cov(0, 0) < var
+
+    def test_out_of_range_counted(self, engine_cls):
+        """instrument_id 超出上限的行情不计入矩阵但推进网格，并计数"""
+        e = engine_cls(instruments=2, interval=1.0, min_periods=1)
+        e.update([_tick(100, 0, 100.0), _tick(200, 5, 1.0), _tick(1100, 0, 101.0), _tick(2100, 7, 1.0)])
+        assert e.dropped == 2 and e.steps == 2 and e.nobs(0) == 1
+        e.reset()
+        assert e.dropped == 0
+
+    def test_reset(self, engine_cls):
+        ticks, _ = _random_walk(3, 5)
+        e = engine_cls(instruments=3)
+        e.update(ticks)
+        e.reset()
+        assert e.steps == 0 and e.last_grid is None and e.nobs(0) == 0
+
+
+class TestCovarianceStage:
+    """流水线 covariance 阶段"""
+
+    def test_snapshots_persisted(self, tmp_path):
+        out = tmp_path / "cov"
+        pipeline = Pipeline([{
+            "name": "cov", "type": "covariance", "threads": 0, "native": False,
+            "instruments": 4, "interval": 1.0, "halflife": 10.0, "snapshot_every": 10, "output_dir": str(out),
+        }]).start()
+        ticks, _ = _random_walk(4, 25)
+        pipeline.submit(ticks[:60])
+        pipeline.submit(ticks[60:])
+        pipeline.close()
+        stems = sorted(str(p)[:-5] for p in out.glob("*.json"))
+        # 第二批后满 10 次更新取一次快照，关闭时补取剩余更新
+        assert len(stems) == 2
+        snap = load_covariance(stems[-1])
+        assert snap["kind"] == "correlation" and snap["steps"] == 24
+        assert snap["matrix"].shape[0] == snap["matrix"].shape[1] <= 4
+        assert snap["matrix"][0, 1] > 0.9
+
+    def test_dropped_reported(self, tmp_path):
+        """合约数不足时快照元数据记录累计丢弃数"""
+        out = tmp_path / "cov"
+        pipeline = Pipeline([{
+            "name": "cov", "type": "covariance", "threads": 0, "native": False,
+            "instruments": 2, "interval": 1.0, "snapshot_every": 0, "output_dir": str(out),
+        }]).start()
+        ticks, _ = _random_walk(4, 5)
+        pipeline.submit(ticks)
+        pipeline.close()
+        snap = load_covariance(sorted(str(p)[:-5] for p in out.glob("*.json"))[-1])
+        assert snap["dropped"] == 10
+
+    def test_threads_rejected(self):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "cov", "type": "covariance", "threads": 2}])
@@ -0,0 +1,119 @@
+# -*- coding: utf-8 -*-
+"""横截面快照矩阵单元测试
+测试 CrossSection 的 as-of 网格快照、空档对齐、块满拒收与清空续写、整块视图，
+以及流水线 cross_section 阶段的落盘、关闭时写出未满块与映射读回
+"""
+import datetime
+import math
+
+import numpy as np
+import pytest
+
+from src.processor.cross_section import CrossSection, load_cross_section, sim_times_to_datetime64
+from src.processor.pipeline import Pipeline
+from src.utils.exceptions import ConfigError
+from tests.conftest import make_tick
+
+
+def _tick(ms, iid, last, bid=0.0, ask=0.0, oi=0.0):
+    return make_tick(f"x{iid}", ms, instrument_id=iid, last_price=last, volume=1, open_interest=oi,
+                     bid_price_1=bid, ask_price_1=ask)
+
+
+class TestCrossSection:
+    """横截面矩阵"""
+
+    def test_as_of_rows(self):
+        """网格点取此前最新值，尚无数据的合约为 NaN"""
+        cs = CrossSection(instruments=3, rows=8, interval=0.5)
+        data = [_tick(100, 0, 1.0, 0.5, 1.5), _tick(300, 1, 2.0), _tick(1200, 0, 3.0)]
+        assert cs.update(data) == 3
+        assert cs.rows_filled == 2
+        last = cs.matrix("last_price")
+        assert last[0, :2].tolist() == [1.0, 2.0] and math.isnan(last[0, 2])
+        assert last[1, :2].tolist() == [1.0, 2.0]
+        assert cs.matrix("mid_price")[0, :2].tolist() == [1.0, 2.0]
+        # 9:30:00.5 与 9:30:01.0 两个网格点
+        assert (cs.times() % 86400000000).tolist() == [34200500000, 34201000000]
+        assert cs.latest("last_price")[0] == 3.0
+
+    def test_gap_aligns(self):
+        """超过 max_gap 的空档只补一行，随后对齐到新时间"""
+        cs = CrossSection(instruments=1, rows=8, interval=0.5, max_gap=2.0)
+        cs.update([_tick(100, 0, 1.0), _tick(60000, 0, 2.0), _tick(60600, 0, 3.0)])
+        assert (cs.times() % 86400000000 - 34200000000).tolist() == [500000, 60000000, 60500000]
+        assert cs.matrix("last_price")[:, 0].tolist() == [1.0, 2.0, 2.0]
+
+    def test_month_end_rollover(self):
+        """跨月午夜网格连续，不会被当成长空档，时间可还原为 datetime64"""
+        cs = CrossSection(instruments=1, rows=8, interval=0.5, max_gap=2.0)
+        t0 = datetime.datetime(2024, 1, 31, 23, 59, 59, 700000)
+        cs.update([
+            {"instrument_id": 0, "last_price": 1.0, "datetime": t0},
+            {"instrument_id": 0, "last_price": 2.0, "datetime": t0 + datetime.timedelta(seconds=1)},
+        ])
+        assert np.diff(cs.times()).tolist() == [500000]
+        assert sim_times_to_datetime64(cs.times()).tolist() == [
+            datetime.datetime(2024, 2, 1, 0, 0, 0), datetime.datetime(2024, 2, 1, 0, 0, 0, 500000)]
+
+    def test_full_block_rejects(self):
+        """块满后需要新行的行情不处理，清空后从该条续写"""
+        cs = CrossSection(instruments=1, rows=2, interval=0.5)
+        data = [_tick(100, 0, 1.0), _tick(1200, 0, 2.0), _tick(1700, 0, 3.0)]
+        assert cs.update(data) == 2
+        assert cs.full and cs.latest("last_price")[0] == 2.0
+        cs.clear()
+        assert cs.update(data, 2) == 3
+        assert cs.rows_filled == 1 and cs.matrix("last_price")[0, 0] == 2.0
+
+    def test_block_is_view(self):
+        """block() 为全部字段已填行的视图（persist 直接写出，不另行拷贝），默认块大小有界"""
+        cs = CrossSection(instruments=2, rows=4, interval=0.5)
+        cs.update([_tick(100, 0, 1.0), _tick(700, 1, 2.0), _tick(1300, 0, 3.0)])
+        block = cs.block()
+        assert block.shape == (6, cs.rows_filled, 2) and np.shares_memory(block, cs.matrix("last_price"))
+        np.testing.assert_array_equal(block[0], cs.matrix("last_price"))
+        np.testing.assert_array_equal(block[5], cs.matrix("ask_price_1"))
+        assert CrossSection()._block.nbytes < 64 * 2 ** 20
+
+    def test_unknown_field(self):
+        with pytest.raises(KeyError):
+            CrossSection(instruments=1).matrix("foo")
+
+
+class TestCrossSectionStage:
+    """流水线 cross_section 阶段"""
+
+    def test_persist_and_load(self, tmp_path):
+        out = tmp_path / "xs"
+        pipeline = Pipeline([{
+            "name": "xs", "type": "cross_section", "threads": 0, "native": False,
+            "instruments": 2, "rows": 2, "interval": 0.5, "output_dir": str(out),
+        }]).start()
+        pipeline.submit([_tick(i * 300, i % 2, 100.0 + i) for i in range(12)])
+        pipeline.close()
+        stems = sorted(str(p)[:-5] for p in out.glob("*.json"))
+        # 12 条行情覆盖 9:30:00.0 ~ 9:30:03.3，网格点 0.0 ~ 3.0 共 7 个：三个满块 + 关闭时写出 1 行
+        assert len(stems) == 4
+        first = load_cross_section(stems[0])
+        assert first["data"].shape == (6, 2, 2)
+        assert isinstance(first["data"], np.memmap)
+        assert first["fields"][0] == "last_price"
+        assert first["times"].tolist() == [
+            datetime.datetime(2025, 1, 29, 9, 30), datetime.datetime(2025, 1, 29, 9, 30, 0, 500000)
+        ]
+        last = first["data"][0]
+        assert last[0, 0] == 100.0 and math.isnan(last[0, 1])
+        assert last[1].tolist() == [100.0, 101.0]
+        assert load_cross_section(stems[3])["data"].shape[1] == 1
+
+    def test_threads_rejected(self, tmp_path):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "xs", "type": "cross_section", "threads": 4, "output_dir": str(tmp_path)}])
+
+    def test_rejects_trades(self, tmp_path):
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "t", "type": "trades"},
+                {"name": "xs", "type": "cross_section", "inputs": ["t"], "output_dir": str(tmp_path)},
+            ])
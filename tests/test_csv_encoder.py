@@ -0,0 +1,119 @@
+# -*- coding: utf-8 -*-
+"""批量 CSV 编码单元测试
+测试编码结果与逐条 csv.DictWriter 写出的文件逐字节一致（表头、浮点 repr、引号、None、
+微秒为 0 的时间）、事件行保留 turnover，按文件聚合与首次出现顺序，以及 FileStorage 跨批追加只写一次表头
+"""
+import csv
+import datetime
+import os
+
+import pytest
+
+from src.storage.csv_encoder import NON_PERSISTED_FIELDS, CsvEncoder, create_csv_encoder
+from src.storage.file_storage import FileStorage
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+
+def _tick(i, symbol="rb2505", day=29):
+    return make_tick(
+        symbol,
+        instrument_id=3,
+        last_price=3500.0 + i * 0.1,
+        volume=100 + i,
+        turnover=1e9,
+        open_interest=1.5e-5 if i == 1 else 12345678901234567.0,
+        datetime=datetime.datetime(2025, 1, day, 9, 30, i, 0 if i == 0 else i * 1000),
+        bid_price_1=None,
+        ask_price_1=float("nan") if i == 2 else 3501.0,
+        note='a,"b"\n' if i == 1 else "",
+    )
+
+
+def _legacy_save(base_path, data_list):
+    """改造前 FileStorage.save 的逐条写法，作为逐字节对照"""
+    for data in data_list:
+        dt = data["datetime"]
+        path = os.path.join(base_path, f"{data.get('symbol', 'unknown')}_{dt.strftime('%Y%m%d')}.csv")
+        exists = os.path.exists(path)
+        row = {k: v for k, v in data.items() if k not in NON_PERSISTED_FIELDS}
+        row["datetime"] = dt.isoformat()
+        with open(path, "a", newline="", encoding="utf-8") as f:
+            writer = csv.DictWriter(f, fieldnames=row.keys())
+            if not exists:
+                writer.writeheader()
+            writer.writerow(row)
+
+
+def _encoders():
+    encoders = [CsvEncoder]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "CsvEncoder"):
+        encoders.append(m.CsvEncoder)
+    return encoders
+
+
+class TestCsvEncoder:
+    """批量编码"""
+
+    @pytest.mark.parametrize("encoder_cls", _encoders())
+    def test_matches_dict_writer(self, tmp_path, encoder_cls):
+        data = [_tick(i) for i in range(3)] + [_tick(0, "au2506"), _tick(4, day=30)]
+        legacy_dir = tmp_path / "legacy"
+        legacy_dir.mkdir()
+        _legacy_save(str(legacy_dir), data)
+
+        chunks = encoder_cls(str(tmp_path)).encode(data)
+        assert [os.path.basename(p) for p, _, _ in chunks] == [
+            "rb2505_20250129.csv", "au2506_20250129.csv", "rb2505_20250130.csv",
+        ]
+        for path, header, body in chunks:
+            expected = (legacy_dir / os.path.basename(path)).read_bytes()
+            assert header + body == expected
+        assert chunks[0][1].startswith(b"symbol,exchange,last_price,volume,open_interest,datetime,")
+
+    @pytest.mark.parametrize("encoder_cls", _encoders())
+    def test_event_rows_keep_turnover(self, tmp_path, encoder_cls):
+        """只对行情行去掉不落盘字段；成交事件行的 turnover 是区间成交额，原样保留"""
+        dt = datetime.datetime(2025, 1, 29, 9, 30)
+        trade = {"symbol": "rb2505", "instrument_id": 3, "datetime": dt, "event": "trade", "price": 3500.0,
+                 "volume": 2, "turnover": 70000.0, "side": "B"}
+        (_, tick_header, _), = encoder_cls(str(tmp_path)).encode([_tick(0)])
+        (_, header, body), = encoder_cls(str(tmp_path)).encode([trade])
+        assert b"turnover" not in tick_header and b"instrument_id" not in tick_header
+        assert header == b"symbol,instrument_id,datetime,event,price,volume,turnover,side\r\n"
+        assert body == b"rb2505,3,2025-01-29T09:30:00,trade,3500.0,2,70000.0,B\r\n"
+        assert trade["datetime"] is dt
+
+    @pytest.mark.parametrize("encoder_cls", _encoders())
+    def test_cache_evicted_on_new_day(self, tmp_path, encoder_cls):
+        """出现更晚的交易日后，更早交易日的 (合约, 交易日) 缓存不再保留"""
+        enc = encoder_cls(str(tmp_path))
+        enc.encode([_tick(0, "rb2505", 29), _tick(0, "au2506", 29)])
+        assert enc.cached_files == 2
+        enc.encode([_tick(1, "rb2505", 30), _tick(1, "au2506", 30)])
+        enc.encode([_tick(2, "rb2505", 30), _tick(2, "au2506", 30)])
+        assert enc.cached_files == 2
+
+    def test_string_datetime(self, tmp_path):
+        data = [dict(_tick(0), datetime="2025-01-29T09:30:00.500000")]
+        _, _, body = CsvEncoder(str(tmp_path)).encode(data)[0]
+        assert b",2025-01-29T09:30:00.500000," in body
+        assert isinstance(data[0]["datetime"], datetime.datetime)
+
+    def test_create_python(self, tmp_path):
+        assert isinstance(create_csv_encoder(str(tmp_path), native=False), CsvEncoder)
+
+
+class TestFileStorageBatches:
+    """FileStorage 跨批追加"""
+
+    def test_header_once(self, tmp_path):
+        storage = FileStorage(base_path=str(tmp_path), native=False)
+        storage.save([_tick(0), _tick(1)])
+        storage.save([_tick(2)])
+        legacy_dir = tmp_path / "legacy"
+        legacy_dir.mkdir()
+        _legacy_save(str(legacy_dir), [_tick(i) for i in range(3)])
+        name = "rb2505_20250129.csv"
+        assert (tmp_path / name).read_bytes() == (legacy_dir / name).read_bytes()
@@ -0,0 +1,88 @@
+# -*- coding: utf-8 -*-
+"""CSV 归档导入单元测试
+测试归档扫描、按交易日导出带合约索引的日文件（乱序行稳定排序）、索引查询与无索引旧文件的回退，
+以及原生导入（可用时）与纯 Python 导入的输出逐字节一致
+"""
+import datetime
+import os
+
+import pytest
+
+from src.storage.csv_import import import_archive, scan_archive
+from src.storage.file_storage import FileStorage
+from src.storage.tick_file import HEADER, TickFile
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+
+def _tick(symbol, day, sec, last):
+    return make_tick(symbol, instrument_id=0, last_price=last, volume=sec, open_interest=10.0,
+                     datetime=datetime.datetime(2025, 1, day, 9, 30, sec),
+                     bid_price_1=last - 1, bid_volume_1=2, ask_price_1=last + 1, ask_volume_1=3)
+
+
+@pytest.fixture
+def archive(tmp_path):
+    src = str(tmp_path / "csv")
+    storage = FileStorage(base_path=src, native=False)
+    for day in (29, 30):
+        storage.save([_tick("rb2505", day, s, 100.0 + s) for s in (0, 2, 1, 3)])  # 第 3 条乱序
+        storage.save([_tick("au2506", day, s, 500.0 + s) for s in (1, 2)])
+    return src
+
+
+class TestCsvImport:
+    """CSV 归档导入"""
+
+    def test_scan(self, archive):
+        assert scan_archive(archive) == {
+            "20250129": ["au2506", "rb2505"],
+            "20250130": ["au2506", "rb2505"],
+        }
+
+    def test_import_python(self, archive, tmp_path):
+        dst = str(tmp_path / "fqt")
+        stats = import_archive(archive, dst, workers=2, native=False)
+        assert stats["days"] == 2 and stats["files"] == 4 and stats["rows"] == 12
+        f = TickFile(os.path.join(dst, "20250129.fqt"))
+        assert f.has_index and len(f) == 6
+        # 按时间归并，同一时间按合约代码顺序（au 在前）
+        assert f.records["time_us"].tolist() == sorted(f.records["time_us"].tolist())
+        assert [f.symbols[i] for i in f.records["instrument_id"]][:3] == ["rb2505", "au2506", "rb2505"]
+        rb = f.select("rb2505")
+        assert rb["last_price"].tolist() == [100.0, 101.0, 102.0, 103.0]
+        assert f.rows_of("au2506").tolist() == [1, 3]
+        assert len(f.rows_of("cu2505")) == 0
+        f.close()
+
+    def test_dates_filter(self, archive, tmp_path):
+        dst = tmp_path / "fqt"
+        import_archive(archive, str(dst), dates=["20250130"], native=False)
+        assert sorted(os.listdir(dst)) == ["20250130.fqt"]
+
+    def test_legacy_file_without_index(self, archive, tmp_path):
+        """index_offset 为 0 的旧文件按 instrument_id 列扫描"""
+        dst = str(tmp_path / "fqt")
+        import_archive(archive, dst, dates=["20250129"], native=False)
+        path = os.path.join(dst, "20250129.fqt")
+        with open(path, "r+b") as fp:
+            fields = list(HEADER.unpack(fp.read(HEADER.size)))
+            fields[-1] = 0
+            fp.seek(0)
+            fp.write(HEADER.pack(*fields))
+        f = TickFile(path)
+        assert not f.has_index
+        assert f.rows_of("au2506").tolist() == [1, 3]
+        f.close()
+
+    @pytest.mark.skipif(
+        get_native_pybind() is None or not hasattr(get_native_pybind(), "import_csv_day"),
+        reason="native_pybind 未编译",
+    )
+    def test_native_matches_python(self, archive, tmp_path):
+        py_dst, native_dst = tmp_path / "py", tmp_path / "native"
+        import_archive(archive, str(py_dst), native=False)
+        stats = import_archive(archive, str(native_dst), workers=2)
+        assert stats["out_of_order"] == 2 and stats["rejected"] == 0
+        for name in os.listdir(py_dst):
+            assert (py_dst / name).read_bytes() == (native_dst / name).read_bytes()
@@ -0,0 +1,152 @@
+# -*- coding: utf-8 -*-
+"""逐笔特征张量单元测试
+测试特征名解析、各特征取值（中间价、价差、失衡、成交量差、多周期收益、时段时间），
+共享内存写端（纯 Python 实现，原生可用时同样覆盖）与读取端的零复制视图、环绕、落后丢弃与覆盖检测，
+以及流水线 features 阶段
+"""
+import math
+import os
+
+import numpy as np
+import pytest
+
+from src.processor.features import (
+    FeatureExtractor, FeatureTensorReader, FeatureTensorWriter, create_feature_writer, parse_feature,
+)
+from src.processor.pipeline import Pipeline
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+_SHM = f"/fq_test_features_{os.getpid()}"
+
+
+def _tick(ms, iid, bid, ask, bid_vol=1, ask_vol=1, volume=0, last=0.0):
+    return make_tick(f"x{iid}", ms, instrument_id=iid, last_price=last or bid, volume=volume, open_interest=5.0,
+                     bid_price_1=bid, bid_volume_1=bid_vol, ask_price_1=ask, ask_volume_1=ask_vol)
+
+
+def _writers():
+    writers = [FeatureTensorWriter]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "FeatureTensorWriter"):
+        writers.append(m.FeatureTensorWriter)
+    return writers
+
+
+@pytest.fixture
+def shm_name():
+    yield _SHM
+    try:
+        os.unlink("/dev/shm" + _SHM)
+    except FileNotFoundError:
+        pass
+
+
+class TestFeatureExtractor:
+    """特征计算"""
+
+    def test_parse(self):
+        assert parse_feature("imbalance") == ("imbalance", 0)
+        assert parse_feature("return:0.5") == ("return", 500000)
+        for bad in ("return:", "return:0", "return:abc", "foo"):
+            with pytest.raises(ConfigError):
+                parse_feature(bad)
+
+    def test_values(self):
+        ex = FeatureExtractor(
+            ["mid_price", "spread", "imbalance", "volume_delta", "return:1", "time_of_day", "session_elapsed"],
+            instruments=4, session_gap=60.0,
+        )
+        _, row = ex.compute(_tick(0, 1, 100.0, 101.0, bid_vol=3, ask_vol=1, volume=10))
+        assert row[:3] == [100.5, 1.0, 0.5]
+        assert math.isnan(row[3]) and math.isnan(row[4])  # 首条无成交量差、无 1 秒前中间价
+        assert row[5] == 34200.0 and row[6] == 0.0
+        _, row = ex.compute(_tick(500, 1, 101.0, 102.0, volume=14))
+        assert row[3] == 4.0 and math.isnan(row[4])
+        _, row = ex.compute(_tick(1200, 1, 102.0, 103.0, volume=15))
+        # 1.2 秒前的 as-of 中间价为 0 秒时的 100.5
+        assert row[4] == pytest.approx(math.log(102.5 / 100.5))
+        assert row[6] == pytest.approx(1.2)
+        # 单边报价取最新价；空档后时段重新计时
+        _, row = ex.compute(_tick(120000, 1, 0.0, 103.0, volume=2, last=102.0))
+        assert row[0] == 102.0 and math.isnan(row[1]) and row[3] == 2.0 and row[6] == 0.0
+        assert ex.compute(_tick(0, 9, 1.0, 2.0)) is None
+
+
+@pytest.mark.parametrize("writer_cls", _writers())
+class TestFeatureTensor:
+    """共享内存写端与读取端"""
+
+    def test_roundtrip(self, writer_cls, shm_name):
+        w = writer_cls(["mid_price", "imbalance", "return:1"], shm_name, capacity=8, instruments=4)
+        r = FeatureTensorReader(shm_name)
+        assert r.features == ["mid_price", "imbalance", "return:1"] and r.capacity == 8
+        assert w.update([_tick(i * 400, i % 2, 100.0 + i, 101.0 + i, bid_vol=2, ask_vol=2) for i in range(5)]) == 5
+        batch = r.read()
+        assert batch.seq == 0 and batch.values.shape == (5, 3) and batch.values.dtype == np.float32
+        assert batch.instrument_ids.tolist() == [0, 1, 0, 1, 0]
+        assert batch.values[:, 0].tolist() == [100.5, 101.5, 102.5, 103.5, 104.5]
+        assert batch.values[4, 2] == pytest.approx(math.log(104.5 / 100.5))
+        assert not batch.values.flags.owndata and not batch.values.flags.writeable  # 共享区只读视图
+        assert r.valid(batch) and r.write_seq == w.seq == 5
+        w.close()
+        r.close()
+
+    def test_wrap_and_lag(self, writer_cls, shm_name):
+        w = writer_cls(["mid_price"], shm_name, capacity=4, instruments=1)
+        r = FeatureTensorReader(shm_name)
+        w.update([_tick(i, 0, 100.0 + i, 101.0 + i) for i in range(3)])
+        first = r.read(2)
+        assert first.seq == 0 and len(first.times) == 2
+        w.update([_tick(10 + i, 0, 200.0 + i, 201.0 + i) for i in range(3)])
+        # 只有最近 3 行有效：第 0、1 行已覆盖，第 2 行的槽位即将改写；读取落后 1 行被跳过
+        assert not r.valid(first)
+        batch = r.read()
+        assert r.lost == 1 and batch.seq == 3 and len(batch.times) == 1  # 到环尾为止
+        rest = r.read()
+        assert rest.seq == 4 and rest.values[:, 0].tolist() == [201.5, 202.5]
+        assert len(r.read().times) == 0 and r.valid(rest)
+        w.close()
+        r.close()
+
+    def test_rejected_tick_leaves_ring(self, writer_cls, shm_name):
+        """超出范围的合约不提交也不改写环形张量；正被改写的槽位不算有效行"""
+        w = writer_cls(["mid_price"], shm_name, capacity=4, instruments=2)
+        assert w.update([_tick(i, i % 2, 100.0 + i, 101.0 + i) for i in range(4)]) == 4
+        assert w.update([_tick(9, 7, 1.0, 2.0)]) == 0
+        r = FeatureTensorReader(shm_name, from_start=True)
+        batch = r.read()
+        assert r.write_seq == w.seq == 4 and batch.seq == 1
+        assert batch.values[:, 0].tolist() == [101.5, 102.5, 103.5]
+        assert batch.instrument_ids.tolist() == [1, 0, 1] and r.valid(batch)
+        w.close()
+        r.close()
+
+
+class TestFeatureConfig:
+    """配置与流水线阶段"""
+
+    def test_invalid_feature(self, shm_name):
+        with pytest.raises(ConfigError):
+            create_feature_writer({"features": ["mid_price", "foo"], "shm": shm_name})
+
+    def test_reader_missing(self):
+        with pytest.raises(StorageError):
+            FeatureTensorReader("/fq_test_features_missing", timeout=0.01)
+
+    def test_pipeline_stage(self, shm_name):
+        pipeline = Pipeline([{
+            "name": "features", "type": "features", "threads": 0, "native": False, "shm": shm_name,
+            "features": ["mid_price", "spread"], "capacity": 16, "instruments": 4,
+        }]).start()
+        reader = FeatureTensorReader(shm_name)
+        pipeline.submit([_tick(i, i % 3, 10.0, 10.5) for i in range(6)])
+        pipeline.close()
+        batch = reader.read()
+        assert len(batch.times) == 6 and batch.values[:, 1].tolist() == [0.5] * 6
+        reader.close()
+
+    def test_threads_rejected(self, shm_name):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "f", "type": "features", "threads": 2, "shm": shm_name}])
@@ -0,0 +1,178 @@
+# -*- coding: utf-8 -*-
+"""主备热备单元测试
+测试共享内存区（纯 Python 实现，原生可用时同样覆盖）的合约槽位登记、快照读取、journal 位置与 epoch 抢占，
+以及 HotStandby 备进程按镜像位置裁剪保留数据、心跳超时接管并只补写主进程尚未落盘的数据
+"""
+import asyncio
+import datetime
+import os
+import sys
+import time
+
+import pytest
+
+from src.collector.hot_standby import HotStandby, StandbyRegion, symbol_hash
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith("linux"), reason="仅 Linux（/dev/shm）")
+
+
+def _tick(symbol, sec, volume):
+    return make_tick(symbol, sec * 1000, last_price=100.0 + sec, volume=volume)
+
+
+def _regions():
+    regions = [StandbyRegion]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "StandbyRegion"):
+        regions.append(m.StandbyRegion)
+    return regions
+
+
+@pytest.fixture
+def shm_name(request):
+    name = f"/fq_test_{os.getpid()}_{request.node.name}".replace("[", "_").replace("]", "")[:60]
+    yield name
+    try:
+        os.unlink(os.path.join("/dev/shm", name.lstrip("/")))
+    except OSError:
+        pass
+
+
+@pytest.mark.parametrize("region_cls", _regions())
+class TestStandbyRegion:
+    """共享内存区"""
+
+    def test_publish_and_mirror(self, region_cls, shm_name):
+        leader = region_cls(shm_name, 100)
+        mirror = region_cls(shm_name, 8)
+        assert leader.slots == mirror.slots == 128
+        assert leader.publish([_tick("rb2505", 1, 10), _tick("au2506", 1, 5), _tick("rb2505", 2, 12)]) == 3
+        assert mirror.journal_seq == 3 and mirror.symbols == 2
+        last = mirror.last("rb2505")
+        assert last["volume"] == 12 and last["last_price"] == 102.0
+        assert last["datetime"] == datetime.datetime(2025, 1, 29, 9, 30, 2)
+        assert mirror.last("cu2505") is None
+        # 键不晚于镜像位置的视为已落盘
+        tail = [_tick("rb2505", 2, 12), _tick("rb2505", 3, 15), _tick("au2506", 1, 5), _tick("cu2505", 1, 1)]
+        assert [(t["symbol"], t["volume"]) for t in mirror.unpersisted(tail)] == [("rb2505", 15), ("cu2505", 1)]
+        leader.close()
+        mirror.close()
+
+    def test_claim_epoch(self, region_cls, shm_name):
+        a = region_cls(shm_name)
+        b = region_cls(shm_name)
+        assert a.claim(0, os.getpid(), now=10.0)
+        assert not b.claim(0, os.getpid(), now=10.0)
+        assert b.epoch == 1 and b.leader_pid == os.getpid()
+        assert b.leader_alive(0.05, now=10.01)
+        assert not b.leader_alive(0.05, now=10.1)
+        a.close()
+        b.close()
+
+
+class TestHotStandby:
+    """主备切换"""
+
+    def test_symbol_hash_matches_native(self):
+        # 与 fq::hash_symbol 的结果一致（C++ 侧同一输入的输出）
+        assert symbol_hash("rb2505") == 15114761425200508868
+
+    def test_failover_without_gap_or_duplicate(self, shm_name):
+        primary = HotStandby(StandbyRegion(shm_name), "primary", heartbeat_interval=0.005, failover_timeout=0.5)
+        standby = HotStandby(StandbyRegion(shm_name), "standby", heartbeat_interval=0.005, failover_timeout=0.5)
+        primary.start()
+        standby.start()
+        assert primary.is_leader and not standby.is_leader
+        assert primary.poll(now=100.0) is None
+
+        feed = [_tick("rb2505", s, s * 10) for s in range(1, 6)]
+        # 备进程已收到全部 5 条，主进程只落盘了前 3 条
+        standby.on_standby_data(feed)
+        primary.on_persisted(feed[:3])
+        assert standby.poll(now=100.1) is None
+        assert not standby.is_leader
+
+        # 主进程失联：心跳超时后接管，只补写未落盘的 2 条
+        gap = standby.poll(now=100.6)
+        assert [t["volume"] for t in gap] == [40, 50]
+        assert standby.is_leader and standby.region.epoch == 2
+        standby.on_persisted(gap)
+        assert standby.region.journal_seq == 5
+        # 停顿后恢复的原主进程发现 epoch 已变：退位，不再登记落盘位置，也不再刷新心跳
+        assert not primary.is_leader and primary.role == "standby"
+        primary.on_persisted([_tick("rb2505", 6, 60)])
+        assert primary.poll(now=100.7) is None
+        assert standby.region.journal_seq == 5 and standby.region.leader_pid == standby._pid
+        primary.region.close()
+        standby.close()
+
+    def test_run_survives_failed_promote(self, shm_name):
+        """接管回调抛出业务异常（StorageError 继承 BaseException）时监测循环不退出"""
+        primary = HotStandby(StandbyRegion(shm_name), "primary", heartbeat_interval=0.005, failover_timeout=0.2)
+        standby = HotStandby(StandbyRegion(shm_name), "standby", heartbeat_interval=0.005, failover_timeout=0.2)
+        primary.start()
+        standby.start()
+        standby.on_standby_data([_tick("rb2505", 1, 10)])
+        gaps = []
+
+        async def on_promote(gap):
+            gaps.append(gap)
+            raise StorageError("磁盘已满")
+
+        async def scenario():
+            task = asyncio.ensure_future(standby.run(on_promote))
+            deadline = time.time() + 3.0
+            while not gaps and time.time() < deadline:
+                await asyncio.sleep(0.01)
+            await asyncio.sleep(0.05)
+            alive = not task.done()
+            standby.stop()
+            await task
+            return alive
+
+        assert asyncio.run(scenario())
+        assert standby.is_leader and [t["volume"] for t in gaps[0]] == [10]
+        primary.region.close()
+        standby.close()
+
+    def test_heartbeat_thread_survives_loop_stall(self, shm_name):
+        primary = HotStandby(StandbyRegion(shm_name), "primary", heartbeat_interval=0.005, failover_timeout=0.2)
+        watcher = StandbyRegion(shm_name)
+        primary.start()
+        primary.start_heartbeat()
+        time.sleep(0.3)  # 事件循环停顿（同步清洗 / 落盘）期间不调用 poll()
+        assert watcher.leader_alive(0.05)
+        primary.close()
+        # 正常退出把心跳置零，备进程无需等待超时
+        assert not watcher.leader_alive(0.2)
+        watcher.close()
+
+    def test_failover_timeout_validation(self, shm_name):
+        region = StandbyRegion(shm_name)
+        with pytest.raises(ConfigError):
+            HotStandby(region, "primary", failover_timeout=0.05)
+        with pytest.raises(ConfigError):
+            HotStandby(region, "primary", heartbeat_interval=0.1, failover_timeout=0.5)
+        region.close()
+        with pytest.raises(ConfigError):
+            HotStandby.from_config({"enable": True, "name": shm_name, "failover_timeout": 0.01})
+
+    def test_primary_refuses_live_leader(self, shm_name):
+        first = HotStandby(StandbyRegion(shm_name), "primary")
+        first.start()
+        second = HotStandby(StandbyRegion(shm_name), "primary")
+        second._pid = first._pid + 1  # 模拟另一个进程
+        with pytest.raises(ConfigError):
+            second.start()
+        first.close()
+        second.region.close()
+
+    def test_invalid_role(self, shm_name):
+        with pytest.raises(ConfigError):
+            HotStandby(StandbyRegion(shm_name), "observer")
+
+    def test_disabled(self):
+        assert HotStandby.from_config({"enable": False}) is None
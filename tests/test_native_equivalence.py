@@ -0,0 +1,328 @@
+# -*- coding: utf-8 -*-
+"""原生与纯 Python 实现一致性测试
+native_pybind 可导入时，对同一段随机行情分别运行两套实现并逐项比较输出：撮合模拟的委托号与成交、
+成交推断、横截面矩阵、协方差、重排缓冲、分片与分片落盘、CSV 编码与日文件导入、特征张量、告警事件与 WebSocket 推送消息。
+未编译原生模块时整体跳过
+"""
+import os
+import random
+
+import numpy as np
+import pytest
+
+from src.api.ws_fanout import WsFanoutServer
+from src.backtest.engine import BacktestEngine
+from src.backtest.fill_simulator import FillSimulator, sim_time
+from src.collector.reorder_buffer import ReorderBuffer
+from src.processor.alerts import AlertEngine, compile_rules
+from src.processor.covariance import EwmCovariance
+from src.processor.cross_section import FIELDS, CrossSection
+from src.processor.features import DEFAULT_FEATURES, FeatureTensorReader, FeatureTensorWriter
+from src.processor.sharded_processor import ShardedProcessor, shard_of
+from src.processor.symbol_table import get_symbol_table
+from src.processor.trade_inference import TradeInference
+from src.storage.csv_encoder import NON_PERSISTED_FIELDS, CsvEncoder, non_persisted_fields
+from src.storage.tick_file import TickFile, build_day_file, write_tick_file
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+from tests.test_ws_fanout import _Client, _wait
+
+get_native_pybind()  # 按配置与 NATIVE_PYBIND_PATH 把模块目录加入 sys.path
+native = pytest.importorskip("native_pybind")
+
+INSTRUMENTS = 4
+
+
+def _symbol(i):
+    return f"eq{chr(ord('a') + i)}2505"
+
+
+def _stream(n=600, seed=11, iids=None):
+    """n 条随机游走行情：报价跳动、偶发单边/空盘口、累计成交量与成交额递增，时间间隔 1~400 毫秒"""
+    rng = random.Random(seed)
+    iids = iids or list(range(INSTRUMENTS))
+    mid = [100.0 + 10 * i for i in range(INSTRUMENTS)]
+    volume = [0] * INSTRUMENTS
+    turnover = [0.0] * INSTRUMENTS
+    ticks, ms = [], 0
+    for _ in range(n):
+        ms += rng.randint(1, 400)
+        i = rng.randrange(INSTRUMENTS)
+        mid[i] += rng.choice((-1.0, -0.5, 0.0, 0.0, 0.5, 1.0))
+        last = mid[i] + rng.choice((-0.5, 0.5))
+        dv = rng.choice((0, 0, 1, 2, 5, 12))
+        volume[i] += dv
+        turnover[i] += dv * last * 10
+        bid, ask = mid[i] - 0.5, mid[i] + 0.5
+        side = rng.random()
+        if side < 0.03:
+            bid = 0.0
+        elif side < 0.06:
+            ask = 0.0
+        ticks.append(make_tick(
+            _symbol(i), ms, instrument_id=iids[i], last_price=last, volume=volume[i], turnover=turnover[i],
+            open_interest=1000.0 + volume[i], bid_price_1=bid, bid_volume_1=rng.randint(1, 30),
+            ask_price_1=ask, ask_volume_1=rng.randint(1, 30),
+        ))
+    return ticks
+
+
+def _interned():
+    table = get_symbol_table()
+    return [table.intern(_symbol(i)) for i in range(INSTRUMENTS)]
+
+
+class TestBacktestEquivalence:
+    """撮合与成交推断"""
+
+    def test_fill_simulator(self):
+        py = FillSimulator(latency=0.05, queue_fill_ratio=0.5, max_orders=16)
+        nat = native.FillSimulator(latency=0.05, queue_fill_ratio=0.5, max_orders=16)
+        rng = random.Random(3)
+        submitted = []
+        for k, tick in enumerate(_stream()):
+            assert py.on_tick(tick) == nat.on_tick(tick)
+            if k % 5 == 0:
+                side = rng.choice((1, -1))
+                price = rng.choice((0.0, tick["bid_price_1"], tick["ask_price_1"], tick["last_price"] - side))
+                args = (tick["instrument_id"], side, price, rng.randint(1, 6), sim_time(tick["datetime"]))
+                oid = py.submit(*args)
+                assert nat.submit(*args) == oid
+                submitted.append(oid)
+            if k % 13 == 0 and submitted:
+                oid = submitted[rng.randrange(len(submitted))]
+                assert py.cancel(oid) == nat.cancel(oid)
+            assert py.live_orders() == nat.live_orders()
+
+    def test_trade_inference(self):
+        py, nat = TradeInference(), native.TradeInference()
+        for i in range(INSTRUMENTS):
+            py.set_multiplier(i, 10)
+            nat.set_multiplier(i, 10)
+        ticks = _stream()
+        for k in range(0, len(ticks), 97):
+            assert py.infer(ticks[k:k + 97]) == nat.infer(ticks[k:k + 97])
+
+
+class _EveryNth:
+    """每 3 批按批内最后一条轮流挂买一/卖一限价单；on_batch 版本读取 TickView 属性"""
+
+    def __init__(self, use_batch):
+        self.batches = 0
+        self.seen = 0
+        self.fills = []
+        if use_batch:
+            self.on_batch = self._on_batch
+
+    def _decide(self, last, bid, ask, ctx):
+        self.batches += 1
+        if self.batches % 3 == 0:
+            if self.batches % 2:
+                ctx.buy(last, 2, bid)
+            else:
+                ctx.sell(last, 1, ask)
+
+    def on_ticks(self, data_list, ctx):
+        self.seen += len(data_list)
+        last = data_list[-1]
+        self._decide(last, last["bid_price_1"], last["ask_price_1"], ctx)
+
+    def _on_batch(self, batch, ctx):
+        self.seen += len(batch)
+        last = batch[len(batch) - 1]
+        self._decide(last, last.bid_price_1, last.ask_price_1, ctx)
+
+    def on_fill(self, fill, ctx):
+        self.fills.append(fill)
+
+
+class TestBacktestLoopEquivalence:
+    """原生回放循环与纯 Python 回放"""
+
+    @pytest.mark.parametrize("use_batch", [False, True])
+    def test_run_tick_files(self, tmp_path, use_batch):
+        """日文件回放：原生 BacktestLoop（on_ticks / on_batch 策略）与纯 Python 引擎的成交与盈亏一致"""
+        ticks = _stream(n=3000)
+        path = str(tmp_path / "day.fqt")
+        write_tick_file(path, [[t for t in ticks if t["symbol"] == _symbol(i)] for i in range(INSTRUMENTS)])
+        cfg = {"latency": 0.01, "batch_size": 16, "multipliers": {"eqa": 10}}
+        py_strategy, nat_strategy = _EveryNth(False), _EveryNth(use_batch)
+        py = BacktestEngine(py_strategy, dict(cfg, native=False)).run_tick_files([TickFile(path)], chunk=256)
+        engine = BacktestEngine(nat_strategy, cfg)
+        assert engine._native_loop() is not None
+        nat = engine.run_tick_files([TickFile(path)])
+        assert nat_strategy.seen == py_strategy.seen == len(ticks)
+        assert nat_strategy.fills == py_strategy.fills and py_strategy.fills
+        for key in ("ticks", "orders", "fills", "positions", "pnl"):
+            assert nat[key] == py[key]
+
+
+class TestProcessorEquivalence:
+    """横截面、协方差、特征与告警"""
+
+    def test_cross_section(self):
+        py, nat = CrossSection(INSTRUMENTS, 64, 0.5, 5.0), native.CrossSection(INSTRUMENTS, 64, 0.5, 5.0)
+        ticks = _stream()
+        pos = 0
+        while pos < len(ticks):
+            pos_py = py.update(ticks, pos)
+            assert nat.update(ticks, pos) == pos_py
+            assert py.rows_filled == nat.rows_filled and py.full == nat.full
+            np.testing.assert_array_equal(py.times(), nat.times())
+            np.testing.assert_array_equal(py.block(), nat.block())
+            for field in FIELDS:
+                np.testing.assert_array_equal(py.matrix(field), nat.matrix(field))
+                np.testing.assert_array_equal(py.latest(field), nat.latest(field))
+            if py.full:
+                py.clear()
+                nat.clear()
+            pos = pos_py
+
+    def test_ewm_covariance(self):
+        args = (INSTRUMENTS, 1.0, 20.0, 5.0, 2)
+        py, nat = EwmCovariance(*args), native.EwmCovariance(*args)
+        ticks = _stream()
+        for k in range(0, len(ticks), 128):
+            assert py.update(ticks[k:k + 128]) == nat.update(ticks[k:k + 128])
+        np.testing.assert_array_equal(py.mids(), nat.mids())
+        for i in range(INSTRUMENTS):
+            assert py.nobs(i) == nat.nobs(i)
+        for correlation in (False, True):
+            np.testing.assert_allclose(py.snapshot(correlation), nat.snapshot(correlation), rtol=1e-12)
+
+    def test_feature_tensor(self):
+        names = [f"/fq_test_equiv_py_{os.getpid()}", f"/fq_test_equiv_nat_{os.getpid()}"]
+        features = DEFAULT_FEATURES + ["return:0.5"]
+        writers = [cls(features, name, capacity=1024, instruments=INSTRUMENTS, session_gap=20.0)
+                   for cls, name in zip((FeatureTensorWriter, native.FeatureTensorWriter), names)]
+        readers = [FeatureTensorReader(name, from_start=True) for name in names]
+        try:
+            ticks = _stream()
+            assert writers[0].update(ticks) == writers[1].update(ticks)
+            py, nat = (r.read() for r in readers)
+            assert py.seq == nat.seq and len(py.times) > 0
+            np.testing.assert_array_equal(py.times, nat.times)
+            np.testing.assert_array_equal(py.instrument_ids, nat.instrument_ids)
+            np.testing.assert_array_equal(py.values, nat.values)
+        finally:
+            for r in readers:
+                r.close()
+            for w in writers:
+                w.close()
+                w.unlink()
+
+    def test_alert_engine(self):
+        program = compile_rules([
+            {"name": "wide", "when": "spread > 0.5 for 1s", "value": "spread", "cooldown": 2},
+            {"name": "jump", "when": "abs(pct(last, 5s)) >= 1% or delta(mid, 500ms) > 1", "value": "last"},
+            {"name": "back", "when": "last < ago(last, 2s) and imbalance > 0.3", "value": "imbalance", "for": 0.3},
+            {"name": "one", "when": "mid > 0", "value": "mid", "symbols": [_symbol(1)]},
+        ])
+        py = AlertEngine(*program, instruments=4096, history_size=128)
+        nat = native.AlertEngine(*program, instruments=4096, history_size=128)
+        ticks = _stream(iids=_interned())
+        for k in range(0, len(ticks), 50):
+            chunk = ticks[k:k + 50]
+            events = py.evaluate(chunk)
+            assert all(e["value"] == e["value"] for e in events)  # 无 NaN，== 才能逐项比较
+            assert nat.evaluate(chunk) == events
+        assert (py.ticks, py.evaluations, py.fired) == (nat.ticks, nat.evaluations, nat.fired)
+
+
+class TestCollectorEquivalence:
+    """重排缓冲与分片"""
+
+    def test_reorder_buffer(self):
+        py, nat = ReorderBuffer(max_hold=0.5, capacity=64), native.ReorderBuffer(max_hold=0.5, capacity=64)
+        rng = random.Random(5)
+        ticks = _stream()
+        now = 1000.0
+        for k in range(0, len(ticks), 16):
+            chunk = ticks[k:k + 16]
+            rng.shuffle(chunk)
+            now += 0.1
+            assert py.push(chunk, now=now) == nat.push(chunk, now=now)
+            assert py.held == nat.held and py.next_deadline() == pytest.approx(nat.next_deadline())
+            now += 0.2
+            assert py.poll(now=now) == nat.poll(now=now)
+        assert py.flush() == nat.flush()
+        assert py.metrics() == nat.metrics()
+
+    def test_sharding(self):
+        for shards in (1, 2, 3, 8):
+            for iid in (0, 1, 7, 4095, 123456, 2 ** 31 - 1):
+                assert native.shard_of(iid, shards) == shard_of(iid, shards)
+        ticks = _stream() + [make_tick("noid2505"), make_tick("neg2505", instrument_id=-1)]
+        parts = native.shard_partition(ticks, 3)
+        assert parts == [[t for t in ticks if shard_of(t.get("instrument_id"), 3) == s] for s in range(3)]
+
+
+class TestStorageEquivalence:
+    """CSV 编码与日文件导入"""
+
+    def test_csv_encoder(self, tmp_path):
+        assert non_persisted_fields() == native.CSV_NON_PERSISTED_FIELDS == NON_PERSISTED_FIELDS
+        ticks = _stream()
+        ticks[7]["datetime"] = ticks[7]["datetime"].isoformat()
+        py = CsvEncoder(str(tmp_path)).encode([dict(t) for t in ticks])
+        assert native.CsvEncoder(str(tmp_path)).encode([dict(t) for t in ticks]) == py
+
+    def test_sharded_tick_writer(self, tmp_path):
+        """原生分片落盘与 Python 默认 清洗 → 存储 分片阶段逐字节一致（含重复、零价与去重表清空）"""
+        ticks = _stream(n=1500)
+        ticks += [dict(t) for t in ticks[::7]] + [dict(t, last_price=0.0) for t in ticks[:20]]
+        random.Random(2).shuffle(ticks)
+        batches = [ticks[k:k + 37] for k in range(0, len(ticks), 37)]
+        (tmp_path / "py").mkdir()
+        (tmp_path / "nat").mkdir()
+        py = ShardedProcessor.from_config({"workers": 3, "clean": {"max_seen_size": 100}}, str(tmp_path / "py"))
+        nat = native.ShardedTickWriter(3, str(tmp_path / "nat"), max_seen_size=100, ring_size=64)
+        for batch in batches:
+            py.submit([dict(t) for t in batch])
+            nat.submit([dict(t) for t in batch])
+        py.close()
+        nat.close()
+        assert sum(nat.metrics()["processed"]) == sum(py.metrics()["processed"]) > 0
+        names = sorted(os.listdir(tmp_path / "py"))
+        assert names == sorted(os.listdir(tmp_path / "nat"))
+        for name in names:
+            assert (tmp_path / "nat" / name).read_bytes() == (tmp_path / "py" / name).read_bytes()
+
+    def test_import_csv_day(self, tmp_path):
+        src = tmp_path / "csv"
+        src.mkdir()
+        for path, header, body in CsvEncoder(str(src)).encode(_stream()):
+            with open(path, "wb") as f:
+                f.write(header + body)
+        symbols = sorted(_symbol(i) for i in range(INSTRUMENTS))
+        rows = build_day_file(str(src), "20250129", str(tmp_path / "py.fqt"), symbols)
+        paths = [str(src / f"{s}_20250129.csv") for s in symbols]
+        stats = native.import_csv_day(paths, symbols, str(tmp_path / "nat.fqt"), 2)
+        assert stats["rows"] == rows
+        assert (tmp_path / "nat.fqt").read_bytes() == (tmp_path / "py.fqt").read_bytes()
+
+
+class TestWsFanoutEquivalence:
+    """推送消息逐字节一致"""
+
+    def test_json_messages(self):
+        iids = _interned()
+        servers = [cls(port=0, rate=50.0, max_rate=100.0, max_clients=2)
+                   for cls in (WsFanoutServer, native.WsFanoutServer)]
+        clients = []
+        try:
+            for srv in servers:
+                srv.start()
+                clients.append(_Client(srv.port, "/?symbols=" + ",".join(_symbol(i) for i in range(INSTRUMENTS))))
+                _wait(lambda: srv.stats()["clients"] == 1)
+            for tick in _stream(n=20, iids=iids):
+                payloads = []
+                for srv, c in zip(servers, clients):
+                    srv.publish([tick])
+                    payloads.append(c.recv())
+                assert payloads[0] == payloads[1]
+        finally:
+            for c in clients:
+                c.close()
+            for srv in servers:
+                srv.stop()
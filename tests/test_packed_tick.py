@@ -0,0 +1,90 @@
+# -*- coding: utf-8 -*-
+"""64 字节规范行情记录单元测试
+测试 PACKED_TICK_DTYPE / TICK_DEPTH_DTYPE 布局与 fq/packed_tick.hpp 一致、定点价格与交易所时间往返、
+NaN 价格与成交量饱和，以及主备镜像槽位改用 64 字节记录后的布局
+"""
+import datetime
+import math
+
+import numpy as np
+
+from src.collector.hot_standby import SLOT_DTYPE
+from src.storage.tick_file import (
+    NO_PRICE, PACKED_CLAMPED, PACKED_HAS_DEPTH, PACKED_TICK_DTYPE, TICK_DEPTH_DTYPE, exchange_time_ns,
+    fill_packed_record, from_fixed_price, packed_record_to_dict, to_fixed_price,
+)
+from tests.conftest import make_tick
+
+
+def _tick(**kw):
+    fields = {
+        "last_price": 3512.0,
+        "volume": 120345,
+        "turnover": 4.2e9,
+        "open_interest": 1850000.0,
+        "datetime": datetime.datetime(2025, 1, 29, 21, 0, 3, 500000),
+        "bid_price_1": 3511.0,
+        "bid_volume_1": 31,
+        "ask_price_1": 3513.0,
+        "ask_volume_1": 7,
+        "open_price": 3490.0,
+        "high_price": 3520.0,
+        "low_price": 3488.0,
+        "pre_close": 3495.0,
+        "pre_settlement": 3497.0,
+    }
+    fields.update(kw)
+    return make_tick(**fields)
+
+
+class TestLayout:
+    """布局"""
+
+    def test_sizes_and_offsets(self):
+        assert PACKED_TICK_DTYPE.itemsize == 64 and TICK_DEPTH_DTYPE.itemsize == 192
+        offsets = {name: PACKED_TICK_DTYPE.fields[name][1] for name in PACKED_TICK_DTYPE.names}
+        assert offsets["exchange_time_ns"] == 8 and offsets["last_price"] == 24 and offsets["volume"] == 48
+        assert TICK_DEPTH_DTYPE.fields["bid_price"][1] == 56 and TICK_DEPTH_DTYPE.fields["ask_volume"][1] == 156
+        # 主备镜像槽位：第一条缓存行放 seqlock 与合约代码，第二条放行情
+        assert SLOT_DTYPE.itemsize == 128 and SLOT_DTYPE.fields["tick"][1] == 64
+
+
+class TestPackedRecord:
+    """dict 与 64 字节记录互转"""
+
+    def test_roundtrip_with_depth(self):
+        rec = np.zeros(1, dtype=PACKED_TICK_DTYPE)
+        depth = np.zeros(1, dtype=TICK_DEPTH_DTYPE)
+        tick = _tick()
+        fill_packed_record(rec[0], tick, 7, 1738155603000000123, depth[0])
+        assert int(rec[0]["flags"]) == PACKED_HAS_DEPTH
+        assert int(rec[0]["receive_time_ns"]) == 1738155603000000123
+        assert int(rec[0]["last_price"]) == 35120000
+        assert int(depth[0]["levels"]) == 1 and int(depth[0]["bid_volume"][0]) == 31
+        out = packed_record_to_dict(rec[0], "rb2505", 7, depth[0])
+        assert out == dict(tick, instrument_id=7)
+
+    def test_without_depth_drops_cold_fields(self):
+        rec = np.zeros(1, dtype=PACKED_TICK_DTYPE)
+        fill_packed_record(rec[0], _tick(), 7)
+        out = packed_record_to_dict(rec[0], "rb2505", 7)
+        assert out["last_price"] == 3512.0 and out["ask_volume_1"] == 7
+        assert out["turnover"] == 0.0 and out["open_price"] == 0.0
+
+    def test_fixed_price(self):
+        for price in (0.0, 0.2, 3512.5, 81234.0, -12.35, 0.0001):
+            assert from_fixed_price(to_fixed_price(price)) == price
+        assert to_fixed_price(float("nan")) == NO_PRICE and to_fixed_price(1e300) == NO_PRICE
+        assert math.isnan(from_fixed_price(NO_PRICE))
+
+    def test_nan_price_and_clamp(self):
+        rec = np.zeros(1, dtype=PACKED_TICK_DTYPE)
+        fill_packed_record(rec[0], _tick(ask_price_1=float("nan"), volume=5_000_000_000), 1)
+        assert int(rec[0]["flags"]) & PACKED_CLAMPED
+        out = packed_record_to_dict(rec[0], "rb2505", 1)
+        assert math.isnan(out["ask_price_1"]) and out["volume"] == 2 ** 32 - 1
+
+    def test_exchange_time(self):
+        # 与 fq::to_exchange_time_ns 一致：日期 + 当日时间按 UTC 编码
+        dt = datetime.datetime(2025, 1, 29, 9, 30, 0, 250)
+        assert exchange_time_ns(dt) == ((20117 * 86400 + 34200) * 1000000 + 250) * 1000
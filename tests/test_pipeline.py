@@ -0,0 +1,182 @@
+# -*- coding: utf-8 -*-
+"""处理流水线单元测试
+测试 Pipeline 的拓扑校验、内联/线程阶段、扇出与汇合、阶段指标及按主配置构建
+"""
+import datetime
+import os
+import sys
+import threading
+import time
+import types
+
+import pytest
+
+from src.processor.pipeline import Pipeline
+from src.utils.exceptions import ConfigError, DataCleanError
+from tests.conftest import make_tick
+
+
+def _tick(iid, seq, symbol=None, price=100.0):
+    return make_tick(symbol or f"s{iid}", instrument_id=iid, last_price=price,
+                     datetime=datetime.datetime(2025, 1, 29, 9, 30, 0, seq))
+
+
+@pytest.fixture
+def sink_module():
+    """注册一个收集结果的 python 阶段模块"""
+    mod = types.ModuleType("fq_test_sink")
+    mod.received = {}
+
+    def make_stage(cfg, shard):
+        bucket = mod.received.setdefault(cfg["name"], [])
+
+        def stage(data_list):
+            bucket.extend(data_list)
+            return data_list
+        return stage
+
+    mod.make_stage = make_stage
+    sys.modules["fq_test_sink"] = mod
+    yield mod
+    del sys.modules["fq_test_sink"]
+
+
+class TestPipelineValidation:
+    """拓扑校验"""
+
+    def test_empty(self):
+        with pytest.raises(ConfigError):
+            Pipeline([])
+
+    def test_unknown_type(self):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "a", "type": "nope"}])
+
+    def test_unknown_input(self):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "a", "type": "clean", "inputs": ["missing"]}])
+
+    def test_cycle(self):
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "a", "type": "fanout", "inputs": ["b"]},
+                {"name": "b", "type": "fanout", "inputs": ["a"]},
+            ])
+
+    def test_duplicate_name(self):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "a", "type": "clean"}, {"name": "a", "type": "clean"}])
+
+
+class TestPipelineRun:
+    """流水线运行"""
+
+    def test_fanout_and_join(self, sink_module):
+        """测试 clean 扇出到两个分支，分支汇合到同一汇点"""
+        pipe = Pipeline([
+            {"name": "clean", "type": "clean", "inputs": ["source"], "threads": 2},
+            {"name": "rb_only", "type": "filter", "symbols": ["rb2505"], "inputs": ["clean"], "threads": 0},
+            {"name": "all", "type": "fanout", "inputs": ["clean"], "threads": 1},
+            {"name": "sink", "type": "python", "callable": "fq_test_sink:make_stage",
+             "inputs": ["rb_only", "all"], "threads": 1},
+        ]).start()
+        pipe.submit([_tick(1, 0, "rb2505"), _tick(2, 0, "au2506"), _tick(1, 0, "rb2505")])
+        pipe.flush()
+        pipe.close()
+        symbols = sorted(d["symbol"] for d in sink_module.received["sink"])
+        # 去重后 rb2505 1 条 + au2506 1 条，rb2505 经两条分支各到达一次
+        assert symbols == ["au2506", "rb2505", "rb2505"]
+        m = pipe.metrics()
+        assert m["clean"]["in"] == 3 and m["clean"]["out"] == 2
+        assert m["rb_only"]["out"] == 1
+        assert m["sink"]["in"] == 3
+        assert m["sink"]["errors"] == 0
+
+    def test_inline_stage_errors_contained(self, sink_module):
+        """内联阶段抛出业务异常（BaseException 子类）时与线程阶段一样记录计数，不传到提交方"""
+        def make_bad(cfg, shard):
+            def stage(data_list):
+                if any(d["instrument_id"] == 9 for d in data_list):
+                    raise DataCleanError("bad tick")
+                return data_list
+            return stage
+        sink_module.make_bad = make_bad
+        pipe = Pipeline([
+            {"name": "bad", "type": "python", "callable": "fq_test_sink:make_bad", "threads": 0},
+            {"name": "sink", "type": "python", "callable": "fq_test_sink:make_stage",
+             "inputs": ["bad"], "threads": 0},
+        ]).start()
+        pipe.submit([_tick(9, 0)])
+        pipe.submit([_tick(1, 0)])
+        pipe.close()
+        assert [d["instrument_id"] for d in sink_module.received["sink"]] == [1]
+        m = pipe.metrics()
+        assert m["bad"]["errors"] == 1 and m["sink"]["errors"] == 0
+
+    def test_inline_join_serialized(self, sink_module):
+        """内联汇合阶段的两个线程上游同时交付时串行执行（阶段内无并发）"""
+        state = {"active": 0, "max": 0}
+        lock = threading.Lock()
+
+        def make_probe(cfg, shard):
+            def stage(data_list):
+                with lock:
+                    state["active"] += 1
+                    state["max"] = max(state["max"], state["active"])
+                time.sleep(0.002)
+                with lock:
+                    state["active"] -= 1
+                return data_list
+            return stage
+        sink_module.make_probe = make_probe
+        pipe = Pipeline([
+            {"name": "a", "type": "fanout", "threads": 1},
+            {"name": "b", "type": "fanout", "threads": 1},
+            {"name": "join", "type": "python", "callable": "fq_test_sink:make_probe",
+             "inputs": ["a", "b"], "threads": 0},
+            {"name": "sink", "type": "python", "callable": "fq_test_sink:make_stage",
+             "inputs": ["join"], "threads": 0},
+        ]).start()
+        for seq in range(40):
+            pipe.submit([_tick(1, seq)])
+        pipe.close()
+        assert state["max"] == 1
+        assert len(sink_module.received["sink"]) == 80
+
+    def test_fanout_edges_isolated(self, sink_module):
+        """扇出的各条边各自持有批次，一个分支原地修改行情不影响兄弟分支"""
+        def make_mutator(cfg, shard):
+            def stage(data_list):
+                for d in data_list:
+                    d["last_price"] = 0.0
+                data_list.clear()
+                return data_list
+            return stage
+        sink_module.make_mutator = make_mutator
+        pipe = Pipeline([
+            {"name": "mutate", "type": "python", "callable": "fq_test_sink:make_mutator", "threads": 0},
+            {"name": "clean", "type": "fanout", "threads": 0},
+            {"name": "left", "type": "python", "callable": "fq_test_sink:make_mutator",
+             "inputs": ["clean"], "threads": 0},
+            {"name": "right", "type": "python", "callable": "fq_test_sink:make_stage",
+             "inputs": ["clean"], "threads": 0},
+        ]).start()
+        pipe.submit([_tick(1, 0, price=101.0), _tick(2, 0, price=102.0)])
+        pipe.close()
+        assert [d["last_price"] for d in sink_module.received["right"]] == [101.0, 102.0]
+
+    def test_from_config_writes_files(self, tmp_path):
+        """测试按主配置构建 clean → file_storage 并落盘"""
+        config = {
+            "storage": {"file": {"base_path": str(tmp_path)}},
+            "processor": {"clean": {"max_seen_size": 100}},
+            "pipeline": {"enable": True, "stages": [
+                {"name": "clean", "type": "clean", "inputs": ["source"], "threads": 1},
+                {"name": "store", "type": "file_storage", "inputs": ["clean"], "threads": 2},
+            ]},
+        }
+        pipe = Pipeline.from_config(config).start()
+        pipe.submit([_tick(1, 0, "rb2505"), _tick(2, 0, "au2506"), _tick(3, 0, "m2505", price=0)])
+        pipe.close()
+        assert sorted(os.listdir(tmp_path)) == ["au2506_20250129.csv", "rb2505_20250129.csv"]
+        assert pipe.metrics()["store"]["out"] == 2
@@ -0,0 +1,113 @@
+# -*- coding: utf-8 -*-
+"""合约优先级通道单元测试
+测试 PriorityLanes（纯 Python 实现）的合约/品种归类、旁路通道、strict/weighted 出队，
+以及 AsyncFuturesCollector 按优先级分发
+"""
+import asyncio
+
+import pytest
+
+from src.collector.async_collector import AsyncFuturesCollector
+from src.collector.priority_lanes import PriorityLanes, _LaneScheduler
+from src.processor.symbol_table import SymbolTable
+
+
+def _config(drain="strict", bypass=True):
+    return {
+        "enable": True,
+        "drain": drain,
+        "default_weight": 1,
+        "classes": [
+            {"name": "traded", "symbols": ["rb2505"], "weight": 3, "bypass_batching": bypass},
+            {"name": "metals", "products": ["au"], "weight": 1},
+        ],
+    }
+
+
+def _ticks(table, symbols):
+    return [{"symbol": s, "instrument_id": table.intern(s), "seq": i} for i, s in enumerate(symbols)]
+
+
+class TestPriorityLanes:
+    """PriorityLanes 单元测试"""
+
+    @pytest.fixture
+    def table(self):
+        return SymbolTable()
+
+    def test_classification(self, table):
+        """测试显式合约、品种前缀与默认通道归类"""
+        lanes = PriorityLanes(_config(), symbol_table=table, native=False)
+        assert lanes.names == ["traded", "metals", "default"]
+        assert lanes.lane_of(table.intern("rb2505")) == 0
+        assert lanes.lane_of(table.intern("au2506")) == 1
+        assert lanes.lane_of(table.intern("m2505")) == 2
+        assert lanes.lane_of(-1) == 2
+
+    def test_bypass_lane_drained_first(self, table):
+        """测试旁路通道整体取出，不受出队额度限制"""
+        lanes = PriorityLanes(_config(), symbol_table=table, native=False)
+        lanes.push(_ticks(table, ["m2505", "rb2505", "au2506", "rb2505"]))
+        urgent = lanes.drain_bypass()
+        assert [t["symbol"] for t in urgent] == ["rb2505", "rb2505"]
+        assert lanes.backlog() == 2
+
+    def test_strict_drain(self, table):
+        """测试 strict 策略先取尽高优先级通道"""
+        lanes = PriorityLanes(_config(bypass=False), symbol_table=table, native=False)
+        lanes.push(_ticks(table, ["m2505"] * 3 + ["au2506"] * 2 + ["rb2505"] * 2))
+        out = lanes.drain(4)
+        assert [t["symbol"] for t in out] == ["rb2505", "rb2505", "au2506", "au2506"]
+        assert lanes.backlog() == 3
+
+    def test_weighted_drain(self, table):
+        """测试 weighted 策略按权重分享额度且各通道内保持顺序"""
+        lanes = PriorityLanes(_config(drain="weighted", bypass=False), symbol_table=table, native=False)
+        lanes.push(_ticks(table, ["m2505"] * 10 + ["rb2505"] * 10))
+        out = lanes.drain(8)
+        symbols = [t["symbol"] for t in out]
+        assert symbols.count("rb2505") == 6
+        assert symbols.count("m2505") == 2
+        seqs = [t["seq"] for t in out if t["symbol"] == "m2505"]
+        assert seqs == sorted(seqs)
+
+    def test_weighted_deficit_reset_on_empty(self):
+        """测试通道取空后剩余额度清零，下次有积压时不带入上一轮的余额"""
+        scheduler = _LaneScheduler([4, 1], strict=False)
+        assert scheduler.plan([2, 10], 3) == [2, 1]
+        assert scheduler.plan([8, 8], 6) == [4, 2]
+
+    def test_metrics(self, table):
+        """测试通道计数"""
+        lanes = PriorityLanes(_config(), symbol_table=table, native=False)
+        lanes.push(_ticks(table, ["rb2505", "m2505"]))
+        lanes.drain_bypass()
+        m = lanes.metrics()
+        assert m["traded"] == {"backlog": 0, "pushed": 1, "drained": 1}
+        assert m["default"]["backlog"] == 1
+
+
+class TestPriorityDispatch:
+    """AsyncFuturesCollector 优先级分发"""
+
+    def test_bypass_reaches_callback_first(self):
+        """测试旁路通道的行情先于同轮其他行情交给回调"""
+        from src.processor.symbol_table import get_symbol_table
+        table = get_symbol_table()
+        collector = AsyncFuturesCollector(
+            {"ctp": {"enable": True}},
+            {"dispatcher": {"mode": "fixed"}, "dispatch_interval": 0, "priority": _config()},
+        )
+        rounds = [_ticks(table, ["m2505", "m2505", "rb2505"])]
+        collector.collect_data = lambda: rounds.pop(0) if rounds else []
+        calls = []
+
+        async def on_data(data_list):
+            calls.append([t["symbol"] for t in data_list])
+            if sum(len(c) for c in calls) >= 3:
+                collector.stop()
+
+        asyncio.run(collector.run_forever(on_data))
+        assert calls[0] == ["rb2505"]
+        assert calls[1] == ["m2505", "m2505"]
+        assert collector.lane_metrics()["traded"]["drained"] == 1
@@ -0,0 +1,119 @@
+# -*- coding: utf-8 -*-
+"""采样分析器单元测试
+测试线程登记、folded 栈格式、定时采样自动写出、控制命令开始/结束以及信号触发在控制线程上执行
+"""
+import asyncio
+import os
+import signal
+import threading
+import time
+
+import pytest
+
+from src.utils import profiler as prof
+from src.utils.profiler import SamplingProfiler, register_current_thread, registered_threads, unregister_current_thread
+
+
+def _hot_function(stop):
+    while not stop.is_set():
+        stop.wait(0.001)
+
+
+@pytest.fixture
+def hot_thread():
+    """启动一个登记为 GFEX/gfex-rx 的热点线程"""
+    stop = threading.Event()
+    ready = threading.Event()
+
+    def run():
+        register_current_thread("gfex-rx", "GFEX")
+        ready.set()
+        try:
+            _hot_function(stop)
+        finally:
+            unregister_current_thread()
+
+    t = threading.Thread(target=run, daemon=True)
+    t.start()
+    ready.wait(1.0)
+    yield t
+    stop.set()
+    t.join()
+
+
+class TestRegistry:
+    """线程登记"""
+
+    def test_register_and_unregister(self):
+        register_current_thread("main-test", "TEST")
+        ident = threading.get_ident()
+        assert registered_threads()[ident] == ("main-test", "TEST")
+        unregister_current_thread()
+        assert ident not in registered_threads()
+
+
+class TestSampling:
+    """采样与输出"""
+
+    def test_folded_stack_format(self, hot_thread):
+        p = SamplingProfiler(hz=1000)
+        for _ in range(5):
+            assert p.sample_once() >= 1
+        stacks = p.folded()
+        ours = [s for s in stacks if s.startswith("GFEX;gfex-rx;")]
+        assert ours and sum(stacks[s] for s in ours) == 5
+        assert any("_hot_function (test_profiler.py)" in s for s in ours)
+
+    def test_timed_run_auto_dump(self, hot_thread, tmp_path):
+        p = SamplingProfiler(hz=500, output_dir=str(tmp_path))
+        assert p.start(duration=0.05)
+        assert not p.start(duration=0.05)  # 采样中不可重复开始
+        deadline = time.time() + 2.0
+        while p.running and time.time() < deadline:
+            time.sleep(0.01)
+        assert not p.running
+        assert p.last_dump is not None and p.samples > 0
+        lines = open(p.last_dump, encoding="utf-8").read().splitlines()
+        assert lines and all(line.rsplit(" ", 1)[1].isdigit() for line in lines)
+        assert any(line.startswith("GFEX;gfex-rx;") for line in lines)
+
+
+class TestControl:
+    """控制命令"""
+
+    def test_toggle(self, hot_thread, tmp_path):
+        p = prof.install_profiler({"signal": "", "hz": 500, "duration": 0, "output_dir": str(tmp_path)})
+        assert p is prof.get_profiler()
+        assert prof.toggle_profiling() is True
+        time.sleep(0.03)
+        assert prof.toggle_profiling() is False
+        assert p.last_dump and p.last_dump.startswith(str(tmp_path))
+        assert prof.install_profiler({"enable": False}) is None
+
+    def test_signal_toggles_off_loop_thread(self, hot_thread, tmp_path):
+        """事件循环上的 SIGUSR2 只置位标志：停止与写文件在控制线程上执行，不阻塞事件循环"""
+        loop = asyncio.new_event_loop()
+        dumped_on = []
+        try:
+            p = prof.install_profiler({"hz": 500, "duration": 0, "output_dir": str(tmp_path)}, loop)
+            dump = p.dump
+            p.dump = lambda path=None: dumped_on.append(threading.current_thread().name) or dump(path)
+
+            async def drive():
+                os.kill(os.getpid(), signal.SIGUSR2)
+                for _ in range(200):
+                    await asyncio.sleep(0.005)
+                    if p.running:
+                        break
+                assert p.running
+                os.kill(os.getpid(), signal.SIGUSR2)
+                for _ in range(200):
+                    await asyncio.sleep(0.005)
+                    if dumped_on:
+                        break
+
+            loop.run_until_complete(drive())
+            assert dumped_on == ["fq-profiler-ctl"] and not p.running
+        finally:
+            loop.remove_signal_handler(signal.SIGUSR2)
+            loop.close()
@@ -0,0 +1,182 @@
+# -*- coding: utf-8 -*-
+"""行情源并行拉起单元测试
+测试 SourceReadiness 的阶段推进、失败与断线重新计时，wait_all 共用截止时间，
+CTP 回调推进就绪状态，NSQ 订阅回报在重连后重新计数，以及 AsyncFuturesCollector 并行拉起、按事件等待就绪与启动时间线
+"""
+import threading
+import time
+from types import SimpleNamespace
+from unittest.mock import Mock, patch
+
+from src.api.ctp_api import CtpSpiWrapper
+from src.api.nsq_api import NsqMarketApi
+from src.collector.async_collector import AsyncFuturesCollector
+from src.collector.readiness import CONNECTED, LOGGED_IN, SUBSCRIBED, SourceReadiness, wait_all
+
+
+class TestSourceReadiness:
+    """就绪状态"""
+
+    def test_mark_and_timeline(self):
+        r = SourceReadiness("src")
+        assert r.state == "pending" and not r.reached(CONNECTED)
+        r.mark(LOGGED_IN)
+        assert r.reached(CONNECTED) and r.state == LOGGED_IN and not r.reached()
+        r.mark(SUBSCRIBED)
+        timeline = r.timeline()
+        assert timeline[CONNECTED] == timeline[LOGGED_IN] <= timeline[SUBSCRIBED]
+        assert timeline["state"] == SUBSCRIBED and timeline["error"] is None and timeline["restarts"] == 0
+
+    def test_wait_is_event_driven(self):
+        r = SourceReadiness("src")
+        threading.Timer(0.05, r.mark, args=(SUBSCRIBED,)).start()
+        start = time.monotonic()
+        assert r.wait(timeout=5)
+        assert time.monotonic() - start < 1.0
+
+    def test_fail_and_reset(self):
+        r = SourceReadiness("src")
+        r.mark(CONNECTED)
+        r.fail("登录失败")
+        start = time.monotonic()
+        assert not r.wait(timeout=5)
+        assert time.monotonic() - start < 1.0
+        assert r.state == "failed" and r.timeline()["error"] == "登录失败"
+        r.reset()
+        assert r.state == "pending" and r.restarts == 1
+
+    def test_wait_all_shared_deadline(self):
+        sources = [SourceReadiness(f"s{i}") for i in range(4)]
+        start = time.monotonic()
+        assert not wait_all(sources, timeout=0.2)
+        assert time.monotonic() - start < 0.6
+
+
+class TestCtpReadiness:
+    """CTP 回调推进就绪状态"""
+
+    def test_callbacks(self):
+        api = Mock(subscribe_symbols=["rb2505"], readiness=SourceReadiness("ctp"))
+        w = CtpSpiWrapper(api, Mock())
+        w.OnFrontConnected()
+        assert api.readiness.state == CONNECTED
+        w.OnRspUserLogin(None, SimpleNamespace(ErrorID=0, ErrorMsg=""), 1, True)
+        assert api.readiness.state == LOGGED_IN
+        api.subscribe.assert_called_once_with(["rb2505"])
+        w.OnRspSubMarketData(SimpleNamespace(InstrumentID="rb2505"), SimpleNamespace(ErrorID=0, ErrorMsg=""), 1, True)
+        assert api.readiness.reached()
+        w.OnFrontDisconnected(4097)
+        assert api.readiness.state == "pending" and api.readiness.restarts == 1
+        w.OnRspUserLogin(None, SimpleNamespace(ErrorID=3, ErrorMsg="bad"), 1, True)
+        assert api.readiness.state == "failed"
+
+
+class _FakeNsqApi:
+    """nsq_pybind.CHSNsqApi 替身：回调在调用线程内同步触发，SubscribeMarket 只记录不回报"""
+
+    def __init__(self, flow_path=None, sdk_cfg_file_path=None):
+        self.spi = None
+        self.subscribed = []
+
+    def RegisterSpi(self, spi):
+        self.spi = spi
+
+    def RegisterFront(self, front):
+        pass
+
+    def Init(self, arg):
+        self.spi.OnFrontConnected()
+        return 0
+
+    def ReqUserLogin(self, req, request_id):
+        self.spi.OnRspUserLogin(None, None, request_id, True)
+
+    def SubscribeMarket(self, exchange, request_id):
+        self.subscribed.append(exchange)
+        return 0
+
+    def GetApiErrorMsg(self, err):
+        return ""
+
+    def ack_all(self):
+        for _ in self.subscribed:
+            self.spi.OnRspFutuDepthMarketDataSubscribe(SimpleNamespace(ErrorID=0, ErrorMsg=""), 0, True)
+
+
+class TestNsqReadiness:
+    """NSQ 订阅回报计数"""
+
+    def test_reconnect_resets_pending_acks(self):
+        module = SimpleNamespace(CHSNsqApi=_FakeNsqApi, CHSNsqSpi=object, CHSNsqReqUserLoginField=SimpleNamespace)
+        api = NsqMarketApi(markets="dce,shfe", readiness=SourceReadiness("nsq"))
+        with patch("src.api.nsq_api._get_nsq_pybind", return_value=module):
+            assert api.connect(lambda msg: None)
+        fake = api._api
+        assert api.readiness.state == LOGGED_IN and len(fake.subscribed) == 2
+        fake.ack_all()
+        assert api.readiness.reached()
+        # 盘中断线重连：SDK 按已发送的订阅重新回报，全部回报后再次进入 subscribed
+        fake.spi.OnFrontDisconnected(4097)
+        assert api.readiness.state == "pending"
+        fake.spi.OnFrontConnected()
+        fake.spi.OnRspUserLogin(None, None, 0, True)
+        fake.spi.OnRspFutuDepthMarketDataSubscribe(None, 0, True)
+        assert api.readiness.state == LOGGED_IN
+        fake.spi.OnRspFutuDepthMarketDataSubscribe(None, 0, True)
+        assert api.readiness.reached()
+        # 多余的迟到回报不会把计数扣成负数
+        fake.spi.OnRspFutuDepthMarketDataSubscribe(None, 0, True)
+        fake.spi.OnFrontDisconnected(4097)
+        fake.spi.OnFrontConnected()
+        fake.spi.OnRspUserLogin(None, None, 0, True)
+        fake.ack_all()
+        assert api.readiness.reached()
+
+
+class _SlowSource:
+    """拉起耗时 delay 秒，之后 ack 秒到达订阅回报"""
+
+    def __init__(self, name, delay, ack, ok=True):
+        self.readiness = SourceReadiness(name)
+        self.delay, self.ack, self.ok = delay, ack, ok
+
+    def init_connections(self):
+        time.sleep(self.delay)
+        if self.ok:
+            self.readiness.mark(CONNECTED)
+            threading.Timer(self.ack, self.readiness.mark, args=(SUBSCRIBED,)).start()
+        return self.ok
+
+
+class TestParallelStartup:
+    """并行拉起与启动时间线"""
+
+    def _collector(self, sources, startup=None):
+        market_sources = {"ctp": {"enable": True}, "zhengyi_zmq": {"enable": True}}
+        with patch("src.collector.async_collector.ZYZmqCollector", return_value=sources[0]), \
+                patch("src.collector.async_collector.CTPCollector", return_value=sources[1]):
+            return AsyncFuturesCollector(market_sources, {"startup": startup or {}})
+
+    def test_parallel_bring_up(self):
+        collector = self._collector([_SlowSource("zy", 0.3, 0.1), _SlowSource("ctp", 0.3, 0.2)])
+        start = time.monotonic()
+        assert collector.init_connections()
+        assert time.monotonic() - start < 0.55
+        assert collector.wait_ready(timeout=5)
+        metrics = collector.startup_metrics()
+        assert metrics["init"] < 0.55 and metrics["init"] <= metrics["ready"] < 1.0
+        assert metrics["sources"]["ctp"]["state"] == SUBSCRIBED
+        assert metrics["sources"]["ctp"][SUBSCRIBED] >= metrics["sources"]["ctp"][CONNECTED]
+
+    def test_sequential_and_failure(self):
+        collector = self._collector(
+            [_SlowSource("zy", 0.1, 0.0), _SlowSource("ctp", 0.1, 0.0, ok=False)], {"parallel": False},
+        )
+        start = time.monotonic()
+        assert not collector.init_connections()
+        assert time.monotonic() - start >= 0.2
+        # 失败的源不会拖到超时
+        start = time.monotonic()
+        assert not collector.wait_ready(timeout=5)
+        assert time.monotonic() - start < 1.0
+        assert collector.startup_metrics()["sources"]["ctp"]["state"] == "failed"
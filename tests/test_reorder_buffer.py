@@ -0,0 +1,106 @@
+# -*- coding: utf-8 -*-
+"""多源重排单元测试
+测试 ReorderBuffer（纯 Python 实现，原生可用时同样覆盖）的按键放行、max_hold 到期、迟到丢弃、
+容量用满提前放行、缺字段原样放行，以及 AsyncFuturesCollector 合流后按合约重排
+"""
+import datetime
+
+import pytest
+
+from src.collector.async_collector import AsyncFuturesCollector
+from src.collector.reorder_buffer import ReorderBuffer, create_reorder_buffer
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+HOLD = 0.0002
+
+
+def _tick(symbol, sec, volume, iid=None):
+    return make_tick(symbol, sec * 1000, volume=volume,
+                     instrument_id=iid if iid is not None else {"rb2505": 1, "au2506": 2}[symbol])
+
+
+def _buffers():
+    buffers = [ReorderBuffer]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "ReorderBuffer"):
+        buffers.append(m.ReorderBuffer)
+    return buffers
+
+
+@pytest.mark.parametrize("buffer_cls", _buffers())
+class TestReorderBuffer:
+    """按合约有界延迟重排"""
+
+    def test_release_in_key_order(self, buffer_cls):
+        buf = buffer_cls(max_hold=HOLD)
+        a = [_tick("rb2505", 2, 20), _tick("au2506", 1, 5), _tick("rb2505", 1, 10), _tick("rb2505", 2, 15)]
+        assert buf.push(a, now=100.0) == []
+        assert buf.held == 4
+        assert buf.next_deadline() == pytest.approx(100.0 + HOLD)
+        assert buf.poll(now=100.0 + HOLD / 2) == []
+        out = buf.poll(now=100.0 + HOLD)
+        rb = [(t["datetime"].second, t["volume"]) for t in out if t["symbol"] == "rb2505"]
+        assert rb == [(1, 10), (2, 15), (2, 20)]
+        assert len(out) == 4 and buf.held == 0
+        m = buf.metrics()
+        assert m["pushed"] == 4 and m["released"] == 4 and m["reordered"] == 2
+
+    def test_expiry_releases_smaller_keys(self, buffer_cls):
+        """到期项放行同合约中键不大于它的全部行情，后到的小键不必再等满 max_hold"""
+        buf = buffer_cls(max_hold=HOLD)
+        buf.push([_tick("rb2505", 5, 50)], now=1.0)
+        out = buf.push([_tick("rb2505", 4, 40), _tick("rb2505", 6, 60)], now=1.0 + HOLD)
+        assert [t["volume"] for t in out] == [40, 50]
+        assert [t["volume"] for t in buf.flush()] == [60]
+
+    def test_late_dropped(self, buffer_cls):
+        buf = buffer_cls(max_hold=HOLD)
+        buf.push([_tick("rb2505", 5, 50)], now=1.0)
+        assert len(buf.poll(now=2.0)) == 1
+        # 早于已放行键的迟到数据丢弃；同键与更晚的照常接收
+        out = buf.push([_tick("rb2505", 4, 40), _tick("rb2505", 5, 50), _tick("au2506", 1, 1)], now=3.0)
+        assert out == []
+        assert buf.metrics()["late"] == 1 and buf.held == 2
+
+    def test_capacity_forces_release(self, buffer_cls):
+        buf = buffer_cls(max_hold=10.0, capacity=2)
+        out = buf.push([_tick("rb2505", s, s) for s in (1, 3, 2)], now=1.0)
+        assert [t["volume"] for t in out] == [1]
+        assert buf.metrics()["forced"] == 1 and buf.held == 2
+        assert [t["volume"] for t in buf.flush()] == [2, 3]
+
+    def test_bypass_without_datetime(self, buffer_cls):
+        buf = buffer_cls(max_hold=HOLD)
+        item = {"symbol": "rb2505", "instrument_id": 1, "datetime": "2025-01-29T09:30:00"}
+        assert buf.push([item], now=1.0) == [item]
+        assert buf.metrics()["bypassed"] == 1
+
+
+class TestCollectorReorder:
+    """AsyncFuturesCollector 合流重排"""
+
+    class _Source:
+        def __init__(self, rounds):
+            self.rounds = rounds
+
+        def collect_data(self):
+            return self.rounds.pop(0) if self.rounds else []
+
+    def test_merged_sources_ordered(self):
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {"reorder": {"enable": True, "max_hold": 0}})
+        collector.collectors = [
+            self._Source([[_tick("rb2505", 2, 20)]]),
+            self._Source([[_tick("rb2505", 1, 10)]]),
+        ]
+        out = collector.collect_data()
+        assert [t["volume"] for t in out] == [10, 20]
+        assert collector.reorder_metrics()["reordered"] == 1
+
+    def test_disabled_by_default(self):
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {})
+        assert collector.reorder_metrics() is None
+
+    def test_create_python(self):
+        buf = create_reorder_buffer({"max_hold": 0.001}, native=False)
+        assert isinstance(buf, ReorderBuffer) and buf.max_hold == 0.001
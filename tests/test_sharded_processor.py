@@ -0,0 +1,139 @@
+# -*- coding: utf-8 -*-
+"""分片并行处理单元测试
+测试 ShardedProcessor 的分片规则、单合约顺序、合并阶段批次顺序与默认 清洗 → 存储 阶段，
+以及 create_sharded_processor 的原生/Python 选择
+"""
+import datetime
+import os
+import threading
+import types
+
+from src.processor import sharded_processor
+from src.processor.sharded_processor import ShardedProcessor, create_sharded_processor, shard_of
+from tests.conftest import make_tick
+
+
+def _tick(iid, seq, symbol=None):
+    return make_tick(symbol or f"s{iid}", instrument_id=iid, last_price=100.0 + seq,
+                     datetime=datetime.datetime(2025, 1, 29, 9, 30, 0, seq), seq=seq)
+
+
+class TestShardOf:
+    """shard_of 单元测试"""
+
+    def test_range_and_stability(self):
+        """测试分片编号范围与确定性"""
+        for iid in range(200):
+            s = shard_of(iid, 4)
+            assert 0 <= s < 4
+            assert shard_of(iid, 4) == s
+        assert shard_of(-1, 4) == 0
+        assert shard_of(123, 1) == 0
+
+    def test_spread(self):
+        """测试连续合约 ID 分散到所有分片"""
+        assert {shard_of(i, 4) for i in range(64)} == {0, 1, 2, 3}
+
+
+class TestShardedProcessor:
+    """ShardedProcessor 单元测试"""
+
+    def test_per_symbol_order(self):
+        """测试同一合约在同一线程上按提交顺序处理"""
+        seen = {}
+        lock = threading.Lock()
+
+        def record(shard):
+            def stage(data_list):
+                with lock:
+                    for d in data_list:
+                        seen.setdefault(d["instrument_id"], []).append((shard, d["seq"]))
+                return data_list
+            return stage
+
+        proc = ShardedProcessor(4, [record])
+        for batch in range(20):
+            proc.submit([_tick(iid, batch * 10 + iid) for iid in range(8)])
+        proc.flush()
+        proc.close()
+        for iid, events in seen.items():
+            assert len({shard for shard, _ in events}) == 1
+            seqs = [seq for _, seq in events]
+            assert seqs == sorted(seqs) and len(seqs) == 20
+        assert sum(proc.metrics()["processed"]) == 160
+
+    def test_merge_preserves_batch_order(self):
+        """测试合并阶段按提交批次顺序输出"""
+        merged = []
+        proc = ShardedProcessor(3, [lambda shard: (lambda data: data)], merge_callback=merged.append)
+        for batch in range(10):
+            proc.submit([_tick(iid, batch) for iid in range(6)])
+        proc.flush()
+        proc.close()
+        assert [b[0]["seq"] for b in merged] == list(range(10))
+        assert all(len(b) == 6 for b in merged)
+
+    def test_stage_error_isolated(self):
+        """测试单批异常只计入该分片且不阻塞后续批次"""
+        calls = []
+
+        def flaky(shard):
+            def stage(data_list):
+                calls.append(len(data_list))
+                if len(calls) == 1:
+                    raise RuntimeError("boom")
+                return data_list
+            return stage
+
+        proc = ShardedProcessor(1, [flaky])
+        proc.submit([_tick(1, 0)])
+        proc.submit([_tick(1, 1)])
+        proc.close()
+        assert proc.metrics()["errors"] == [1]
+        assert proc.metrics()["processed"] == [1]
+
+    def test_from_config_cleans_and_stores(self, tmp_path):
+        """测试默认 清洗 → 存储 阶段：去重后按合约写入 CSV"""
+        proc = ShardedProcessor.from_config({"workers": 2, "clean": {}}, str(tmp_path))
+        dup = _tick(1, 0, "rb2505")
+        proc.submit([dup, dict(dup), _tick(2, 0, "au2506")])
+        proc.close()
+        files = sorted(os.listdir(tmp_path))
+        assert files == ["au2506_20250129.csv", "rb2505_20250129.csv"]
+        with open(tmp_path / "rb2505_20250129.csv", encoding="utf-8") as f:
+            assert len(f.readlines()) == 2  # 表头 + 去重后 1 行
+
+
+class TestCreateShardedProcessor:
+    """create_sharded_processor 选择原生或 Python 实现"""
+
+    def test_prefers_native_writer(self, tmp_path, monkeypatch):
+        """测试原生模块可用时以配置参数创建 ShardedTickWriter 并建好目录"""
+        created = []
+
+        def writer(workers, base_path, max_seen_size, ring_size):
+            created.append((workers, base_path, max_seen_size, ring_size))
+            return created
+
+        monkeypatch.setattr(sharded_processor, "get_native_pybind",
+                            lambda: types.SimpleNamespace(ShardedTickWriter=writer))
+        base = str(tmp_path / "csv")
+        cfg = {"workers": 3, "worker_ring_size": 256, "clean": {"max_seen_size": 7}}
+        assert create_sharded_processor(cfg, base) is created
+        assert created == [(3, base, 7, 256)]
+        assert os.path.isdir(base)
+
+    def test_python_fallback(self, tmp_path, monkeypatch):
+        """测试强制 Python、需要合并回调或原生模块不可用时回退为 ShardedProcessor"""
+        monkeypatch.setattr(sharded_processor, "get_native_pybind",
+                            lambda: types.SimpleNamespace(ShardedTickWriter=None))
+        cfg = {"workers": 1, "clean": {}}
+        procs = [
+            create_sharded_processor(cfg, str(tmp_path), native=False),
+            create_sharded_processor(cfg, str(tmp_path), merge_callback=lambda data: None),
+        ]
+        monkeypatch.setattr(sharded_processor, "get_native_pybind", lambda: None)
+        procs.append(create_sharded_processor(cfg, str(tmp_path)))
+        for proc in procs:
+            assert isinstance(proc, ShardedProcessor)
+            proc.close()
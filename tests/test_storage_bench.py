@@ -0,0 +1,129 @@
+# -*- coding: utf-8 -*-
+"""存储后端基准单元测试
+测试生成的多合约交易日（时段、价位、累计量、可复现）、按列填充记录与逐条填充一致、各后端写入后
+四种查询结果一致、时间窗按完整时间戳跨零点、依赖缺失的后端跳过、压缩归档更小、对比报告与命令行输出
+"""
+import datetime
+import json
+import os
+
+import numpy as np
+import pytest
+
+from src.storage.storage_bench import (
+    PRODUCTS, create_backend, format_report, generate_day, load_replay, main, run_benchmark,
+)
+from src.storage.file_storage import FileStorage
+from src.storage.tick_file import TICK_DTYPE, fill_record, records_from_dicts
+from src.utils.exceptions import ConfigError
+
+_BACKENDS = ("csv_python", "csv_native", "parquet", "fqt", "fqt.gz", "fqt.xz", "fqt.zst", "csv.gz")
+
+
+@pytest.fixture(scope="module")
+def day():
+    return generate_day(symbols=12, ticks=300, seed=7)
+
+
+class TestGenerateDay:
+    """行情生成"""
+
+    def test_shape(self, day):
+        assert len(day) == 12 * 300
+        assert all(a["datetime"] <= b["datetime"] for a, b in zip(day, day[1:]))
+        sizes = {p: size for p, _, size, _, _ in PRODUCTS}
+        last = {}
+        for d in day:
+            product = d["symbol"].rstrip("0123456789")
+            assert d["datetime"].hour in (9, 10, 11, 13, 14, 21, 22)
+            assert abs(d["last_price"] / sizes[product] - round(d["last_price"] / sizes[product])) < 1e-6
+            assert d["ask_price_1"] > d["bid_price_1"]
+            assert d["volume"] > last.get(d["symbol"], 0)
+            last[d["symbol"]] = d["volume"]
+        assert any(s.startswith("SR5") for s in last) and "IF2509" not in last
+
+    def test_reproducible(self, day):
+        assert generate_day(symbols=12, ticks=300, seed=7) == day
+        with pytest.raises(ConfigError):
+            generate_day(symbols=1000)
+
+    def test_records_from_dicts(self, day):
+        ids = {}
+        records = records_from_dicts(day, ids)
+        expected = np.zeros(len(day), dtype=TICK_DTYPE)
+        for i, d in enumerate(day):
+            fill_record(expected[i], d, ids[d["symbol"]])
+        assert records.tobytes() == expected.tobytes()
+
+    def test_replay_source(self, day, tmp_path):
+        FileStorage(base_path=str(tmp_path), native=False).save(day)
+        replay = load_replay(str(tmp_path), "20250129")
+        keys = ("symbol", "datetime", "last_price", "volume", "ask_volume_1")
+        assert [[d[k] for k in keys] for d in replay] == [[d[k] for k in keys] for d in day]
+
+
+class TestRunBenchmark:
+    """写入、查询与报告"""
+
+    def test_results_agree(self, day, tmp_path):
+        report = run_benchmark(day, _BACKENDS, str(tmp_path), batch=64, repeat=1, cold=True)
+        assert report["ticks"] == len(day) and report["symbols"] == 12
+        results = {r["backend"]: r for r in report["results"]}
+        assert list(results) == list(_BACKENDS)
+        done = [r for r in results.values() if "skipped" not in r]
+        assert {"csv_python", "fqt", "fqt.gz", "fqt.xz", "csv.gz"} <= {r["backend"] for r in done}
+        for r in done:
+            assert "error" not in r
+            assert r["replay_result"] == len(day) and r["symbol_result"] == 300
+            assert r["write_ticks_per_s"] > 0 and r["fsync_ticks_per_s"] > 0 and r["cpu_us_per_tick"] > 0
+        assert report["mismatches"] == []
+        assert results["fqt.gz"]["bytes_per_tick"] < results["fqt"]["bytes_per_tick"]
+        # 工作目录用后删除
+        assert os.listdir(tmp_path) == []
+
+    def test_window_across_midnight(self, tmp_path):
+        """时间窗按完整时间戳判定：跨零点的窗口包含前一日尾部与次日开头"""
+        start = datetime.datetime(2025, 1, 29, 23, 50)
+        ticks = [dict(t, datetime=start + datetime.timedelta(seconds=30 * i))
+                 for i, t in enumerate(generate_day(symbols=1, ticks=40, seed=3))]
+        backend = create_backend("fqt")
+        backend.open(str(tmp_path / "fqt"), "20250129", False)
+        backend.write(ticks)
+        backend.close()
+        lo, hi = datetime.datetime(2025, 1, 29, 23, 59), datetime.datetime(2025, 1, 30, 0, 1)
+        assert backend.window(lo, hi) == sum(lo <= t["datetime"] < hi for t in ticks) == 4
+        csv = create_backend("csv_python")
+        csv.open(str(tmp_path / "csv"), "20250129", False)
+        csv.write(ticks)
+        assert csv.window(lo, hi) == 2  # 按自然日分文件：只读回 0129 当日的部分
+
+    def test_parquet_fsync_flagged(self):
+        report = {"trade_date": "20250129", "symbols": 1, "ticks": 1, "batch": 1, "cold": False, "results": [
+            {"backend": "parquet", "write_ticks_per_s": 10.0, "fsync_ticks_per_s": 5.0, "fsync_slowdown": 2.0,
+             "fsync_comparable": False},
+            {"backend": "fqt", "write_ticks_per_s": 10.0, "fsync_ticks_per_s": 5.0, "fsync_slowdown": 2.0,
+             "fsync_comparable": True},
+        ]}
+        text = format_report(report)
+        assert "| 5† | 2.00x† |" in text and "| 5 | 2.00x |" in text and "† 不可比" in text
+
+    def test_skipped_and_report(self, day, tmp_path):
+        # 工作目录不存在时自动创建
+        report = run_benchmark(day[:500], ("fqt", "parquet"), str(tmp_path / "new" / "dir"), fsync=False, repeat=1)
+        fqt, parquet = report["results"]
+        assert "fsync_ticks_per_s" not in fqt
+        text = format_report(report)
+        assert "| fqt |" in text and "| parquet |" in text
+        if "skipped" in parquet:
+            assert "跳过" in text
+        with pytest.raises(ConfigError):
+            create_backend("fqt.rar")
+        with pytest.raises(ConfigError):
+            run_benchmark([], ("fqt",))
+
+    def test_cli(self, tmp_path):
+        out, js = tmp_path / "report.md", tmp_path / "report.json"
+        main(["--symbols", "3", "--ticks", "50", "--backends", "fqt", "csv_python", "--repeat", "1",
+              "--dir", str(tmp_path), "--out", str(out), "--json", str(js)])
+        assert "存储后端对比" in out.read_text(encoding="utf-8")
+        assert [r["backend"] for r in json.loads(js.read_text(encoding="utf-8"))["results"]] == ["fqt", "csv_python"]
@@ -0,0 +1,110 @@
+# -*- coding: utf-8 -*-
+"""参数扫描单元测试
+测试行情日文件的写出/映射读回、参数网格展开，以及线程/进程两种模式的并行扫描与列式结果
+"""
+import datetime
+
+import numpy as np
+import pytest
+
+from src.backtest import sweep as sweep_module
+from src.backtest.sweep import ParameterSweep, expand_grid
+from src.storage.tick_file import TickFile, write_tick_file
+from src.utils.exceptions import ConfigError, StorageError
+from tests.conftest import make_tick
+
+
+def _tick(ms, symbol, last, volume=0):
+    return make_tick(symbol, ms, instrument_id=0, last_price=last, volume=volume, turnover=0.0, open_interest=10.0,
+                     bid_price_1=last - 0.5, bid_volume_1=5, ask_price_1=last + 0.5, ask_volume_1=5)
+
+
+class ThresholdStrategy:
+    """rb 最新价高于 threshold 时市价买入 size 手（仅一次）"""
+
+    def __init__(self, cfg):
+        self.threshold = cfg["threshold"]
+        self.size = cfg.get("size", 1)
+        self.done = False
+
+    def on_ticks(self, data_list, ctx):
+        for d in data_list:
+            if not self.done and d["symbol"] == "rb2505" and d["last_price"] > self.threshold:
+                ctx.buy(d, self.size)
+                self.done = True
+
+
+def make_strategy(cfg):
+    return ThresholdStrategy(cfg)
+
+
+@pytest.fixture
+def day_file(tmp_path):
+    path = str(tmp_path / "20250129.fqt")
+    rb = [_tick(i * 10, "rb2505", 100.0 + i) for i in range(10)]
+    au = [_tick(i * 10 + 5, "au2506", 500.0) for i in range(5)]
+    assert write_tick_file(path, [rb, au]) == 15
+    return path
+
+
+class TestTickFile:
+    """行情日文件"""
+
+    def test_roundtrip(self, day_file):
+        f = TickFile(day_file)
+        assert len(f) == 15 and f.symbols == ["rb2505", "au2506"]
+        rows = list(f.iter_dicts())
+        assert [r["symbol"] for r in rows[:3]] == ["rb2505", "au2506", "rb2505"]
+        assert rows[2]["datetime"] == _tick(10, "rb2505", 101.0)["datetime"]
+        assert rows[2]["last_price"] == 101.0 and rows[2]["bid_volume_1"] == 5
+        assert rows[0]["exchange"] == "SHFE"
+        # 零拷贝只读视图
+        assert not f.records.flags.writeable
+        assert f.records["last_price"][2] == 101.0
+
+    def test_bad_file(self, tmp_path):
+        bad = tmp_path / "bad.fqt"
+        bad.write_bytes(b"x" * 100)
+        with pytest.raises(StorageError):
+            TickFile(str(bad))
+
+
+class TestParameterSweep:
+    """参数扫描"""
+
+    def test_expand_grid(self):
+        assert expand_grid({"a": [1, 2], "b": ["x"]}) == [{"a": 1, "b": "x"}, {"a": 2, "b": "x"}]
+
+    def test_bad_mode(self, day_file):
+        with pytest.raises(ConfigError):
+            ParameterSweep("tests.test_sweep:make_strategy", [day_file], mode="gpu")
+
+    @pytest.mark.parametrize("mode", ["thread", "process"])
+    def test_sweep(self, day_file, tmp_path, mode):
+        sweep = ParameterSweep(
+            "tests.test_sweep:make_strategy", [day_file],
+            base_config={"native": False, "multipliers": {"rb": 10}}, workers=2, mode=mode,
+        )
+        result = sweep.run({"threshold": [100.0, 104.0, 1000.0], "size": [1, 2]})
+        assert len(result) == 6
+        assert list(result.columns["threshold"][:2]) == [100.0, 100.0]
+        assert list(result.columns["ticks"]) == [15] * 6
+        # threshold=1000 从不下单
+        assert list(result.columns["orders"][-2:]) == [0, 0]
+        # 越早买入（阈值越低）盈利越多，同阈值下手数越大盈利越多
+        # 101 时下单、下一条按卖一 102.5 成交，收于 109：(109 - 102.5) × 10 × 手数
+        assert list(result.columns["pnl"][:2]) == [65.0, 130.0]
+        assert result.best() == 1
+        out = str(tmp_path / "sweep.npz")
+        result.save(out)
+        assert np.load(out)["pnl"].shape == (6,)
+
+    def test_chunked_replay(self, day_file, monkeypatch):
+        """按块流式物化跨块边界时结果与整块一致"""
+        monkeypatch.setattr(sweep_module, "REPLAY_CHUNK", 4)
+        sweep = ParameterSweep(
+            "tests.test_sweep:make_strategy", [day_file, day_file],
+            base_config={"native": False, "multipliers": {"rb": 10}}, workers=2, mode="thread",
+        )
+        result = sweep.run({"threshold": [100.0], "size": [1, 2]})
+        assert list(result.columns["ticks"]) == [30, 30]
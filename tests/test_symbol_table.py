@@ -0,0 +1,104 @@
+# -*- coding: utf-8 -*-
+"""合约符号表单元测试
+测试 SymbolTable 规范化、稠密 ID 分配、缓存及与解析/清洗模块的配合
+"""
+import datetime
+from unittest.mock import MagicMock
+
+import pytest
+
+from src.processor.symbol_table import (
+    SymbolTable,
+    normalize_symbol,
+    INVALID_INSTRUMENT,
+    MAX_SYMBOL_LEN,
+)
+from src.processor.data_cleaner import DataCleaner
+
+
+class TestNormalizeSymbol:
+    """normalize_symbol 单元测试"""
+
+    def test_bytes_nul_padding(self):
+        """测试定长 NUL 填充字节被截断"""
+        assert normalize_symbol(b"lc2505\x00\x00\x00garbage") == "lc2505"
+
+    def test_bytes_space_padding(self):
+        """测试首尾空白被去除"""
+        assert normalize_symbol(b"  y2605   ") == "y2605"
+
+    def test_str_input(self):
+        """测试字符串输入"""
+        assert normalize_symbol("rb2505\x00") == "rb2505"
+
+
+class TestSymbolTable:
+    """SymbolTable（纯 Python 实现）单元测试"""
+
+    @pytest.fixture
+    def table(self):
+        return SymbolTable()
+
+    def test_dense_ids(self, table):
+        """测试 ID 从 0 开始稠密分配"""
+        assert table.intern(b"rb2505") == 0
+        assert table.intern(b"au2506") == 1
+        assert len(table) == 2
+
+    def test_same_symbol_different_padding(self, table):
+        """测试不同填充的同一合约映射到同一 ID"""
+        a = table.intern(b"lc2505\x00\x00\x00\x00")
+        b = table.intern(b"lc2505   ")
+        c = table.intern("lc2505")
+        assert a == b == c
+
+    def test_resolve_returns_name(self, table):
+        """测试 resolve 同时返回合约代码"""
+        iid, name = table.resolve(b"si2507\x00\x00")
+        assert name == "si2507"
+        assert table.name(iid) == "si2507"
+
+    def test_invalid_symbols(self, table):
+        """测试空串与超长合约返回 INVALID_INSTRUMENT"""
+        assert table.intern(b"\x00\x00") == INVALID_INSTRUMENT
+        assert table.intern("x" * (MAX_SYMBOL_LEN + 1)) == INVALID_INSTRUMENT
+        assert len(table) == 0
+
+    def test_find_does_not_intern(self, table):
+        """测试 find 只查不登记"""
+        assert table.find("rb2505") == INVALID_INSTRUMENT
+        iid = table.intern("rb2505")
+        assert table.find("rb2505") == iid
+        assert len(table) == 1
+
+    def test_name_unknown_id(self, table):
+        """测试未知 ID 返回 None"""
+        assert table.name(42) is None
+
+    def test_native_table_delegation(self):
+        """测试 native 符号表存在时 ID 由原生表分配"""
+        native = MagicMock()
+        native.intern.return_value = 7
+        table = SymbolTable(native)
+        assert table.is_native
+        assert table.resolve(b"rb2505\x00") == (7, "rb2505")
+        # 命中原始字节缓存后不再调用原生表
+        table.resolve(b"rb2505\x00")
+        native.intern.assert_called_once_with("rb2505")
+        assert table.name(7) == "rb2505"
+
+
+class TestCleanerWithInstrumentId:
+    """DataCleaner 使用合约 ID 去重"""
+
+    def test_dedup_by_instrument_id(self):
+        """测试相同合约 ID + 时间的记录去重"""
+        dt = datetime.datetime(2025, 1, 29, 9, 30, 0)
+        cleaner = DataCleaner()
+        data_list = [
+            {"symbol": "rb2505", "instrument_id": 3, "datetime": dt, "last_price": 3500.0},
+            {"symbol": "rb2505", "instrument_id": 3, "datetime": dt, "last_price": 3501.0},
+            {"symbol": "au2506", "instrument_id": 4, "datetime": dt, "last_price": 520.0},
+        ]
+        result = cleaner.clean(data_list)
+        assert [d["instrument_id"] for d in result] == [3, 4]
@@ -0,0 +1,335 @@
+# -*- coding: utf-8 -*-
+"""行情批次与惰性视图单元测试
+测试 TickBatch/TickView（纯 Python 实现）的按需取值、游标迭代、失效检测、
+原始帧解码、双缓冲交换以及采集器批次分发；原始帧解码的黄金文件同时供原生检查程序
+（ctest: decoder_golden）比对，保证原生解码器与 Python 解析器逐字段一致
+"""
+import asyncio
+import datetime
+import random
+import struct
+from pathlib import Path
+
+import pytest
+
+from src.api.gfex_exanic_api import GfexExanicApi, _GFEX_L2_FMT
+from src.api.zy_zmq_api import CZCEL2_Quotation, DCEL1_Quotation
+from src.collector.async_collector import AsyncFuturesCollector
+from src.collector.base_collector import BaseFuturesCollector
+from src.processor.tick_view import StaleTickViewError, TickBatch, new_tick_batch
+from tests.conftest import make_tick
+
+
+def _tick(symbol="rb2505", price=3500.0):
+    return make_tick(
+        symbol, instrument_id=0, last_price=price, volume=10, open_interest=100.0,
+        bid_price_1=price - 1, bid_volume_1=1, ask_price_1=price + 1, ask_volume_1=2,
+        open_price=0.0, high_price=0.0, low_price=0.0, pre_close=0.0, pre_settlement=0.0,
+    )
+
+
+def _gfex_frame(contract=b"lc2505", price=80000.0):
+    levels = []
+    for i in range(5):
+        levels += [price - i - 1, 10 + i]
+    for i in range(5):
+        levels += [price + i + 1, 20 + i]
+    return struct.pack(
+        _GFEX_L2_FMT, 1, contract, price, 1, 500, 0.0, 1200, 0, b"10:15:30.250",
+        *levels, *([0] * 10),
+    )
+
+
+DECODER_GOLDEN = Path(__file__).parent / "data" / "tick_decoders.golden"
+_GOLDEN_FIELDS = (
+    "last_price", "volume", "turnover", "open_interest", "bid_price_1", "bid_volume_1", "ask_price_1",
+    "ask_volume_1", "open_price", "high_price", "low_price", "pre_close", "pre_settlement",
+)
+
+
+def _golden_frames():
+    """固定种子的原始帧：三种格式各若干条，含各种时间精度/价格精度/空盘口，以及长度不符的坏帧"""
+    rng = random.Random(77)
+    products = ("lc", "si", "m", "y", "i", "SR", "CF", "TA")
+
+    def symbol():
+        return f"{rng.choice(products)}{rng.randint(2501, 2512)}".encode()
+
+    def hms():
+        return rng.randint(0, 23), rng.randint(0, 59), rng.randint(0, 59)
+
+    for k in range(24):
+        price = rng.randint(2000, 90000) + rng.choice((0.0, 0.5, 0.25, 0.1))
+        levels = []
+        for side in (-1, 1):
+            for i in range(5):
+                levels += [price + side * (i + 1) * rng.choice((0.5, 1.0, 5.0)), rng.randint(0, 500)]
+        h, m, sec = hms()
+        gen_time = f"{h:02d}:{m:02d}:{sec:02d}"
+        if k % 4:
+            gen_time += "." + str(rng.randint(0, 999999)).zfill(6)[:k % 4 * 2]
+        volume = rng.randint(0, 10 ** 6)
+        yield "gfex_l2", struct.pack(
+            _GFEX_L2_FMT, 1, symbol(), price, rng.randint(0, 50), volume, volume * price * rng.uniform(5, 20),
+            rng.randint(0, 10 ** 6), rng.randint(-500, 500), gen_time.encode(), *levels,
+            *(rng.randint(0, 9) for _ in range(10)),
+        )
+    for _ in range(24):
+        q = DCEL1_Quotation()
+        q.Symbol = symbol()
+        q.TradeDate = rng.choice((20250129, 20250303, 20251231))
+        h, m, sec = hms()
+        q.Time = ((h * 100 + m) * 100 + sec) * 1000 + rng.randint(0, 999)
+        q.LastPrice = rng.randint(1000, 9000) + rng.choice((0.0, 0.5, 0.2))
+        q.TotalVolume = rng.randint(0, 10 ** 7)
+        q.TotalAmount = q.TotalVolume * q.LastPrice * 10
+        q.TotalPosition = rng.randint(0, 10 ** 6)
+        q.BuyPrice01, q.SellPrice01 = q.LastPrice - 1, q.LastPrice + 1
+        q.BuyVolume01, q.SellVolume01 = rng.randint(0, 300), rng.randint(0, 300)
+        q.OpenPrice, q.HighPrice, q.LowPrice = q.LastPrice - 3, q.LastPrice + 7.5, q.LastPrice - 9.3
+        q.PreClosePrice, q.PreSettlePrice = q.LastPrice - 2.1, q.LastPrice - 1.7
+        yield "dce_l1", bytes(q)
+    for _ in range(24):
+        q = CZCEL2_Quotation()
+        q.Symbol = symbol()
+        q.TradeDate = rng.choice((20250129, 20250303, 20251231))
+        h, m, sec = hms()
+        q.Time = (((h * 100 + m) * 100 + sec) * 1000 + rng.randint(0, 999)) * 1000 + rng.randint(0, 999)
+        q.PriceSize = rng.randint(0, 3)
+        q.LastPrice = rng.randint(10 ** 4, 10 ** 7)
+        q.OpenPrice, q.HighPrice, q.LowPrice = q.LastPrice - 3, q.LastPrice + 77, q.LastPrice - 91
+        q.TotalVolume = rng.randint(0, 10 ** 7)
+        q.TotalAmount = rng.randint(0, 10 ** 12)
+        q.TotalPosition = rng.randint(0, 10 ** 6)
+        q.SettlePrice = q.LastPrice - 13
+        q.DeriveBidPrice = rng.choice((0, q.LastPrice - 1))
+        q.DeriveAskPrice = rng.choice((0, q.LastPrice + 1))
+        q.DeriveBidLot, q.DeriveAskLot = rng.randint(0, 300), rng.randint(0, 300)
+        yield "czce_l1", bytes(q)
+    yield "gfex_l2", b"short"
+    yield "dce_l1", bytes(DCEL1_Quotation())[:-1]
+    yield "czce_l1", bytes(CZCEL2_Quotation()) + b"\x00"
+
+
+def golden_lines():
+    """用纯 Python 解析器解码 _golden_frames()，每帧一行：
+
+    <格式> <原始帧 hex> <合约> <日期 YYYYMMDD，GFEX 取本地日期记为 -> <当日微秒> <_GOLDEN_FIELDS...>
+    解码失败的帧记为 <格式> <原始帧 hex> rejected。浮点以 repr 输出，strtod 可按位还原。
+    """
+    lines = []
+    for kind, raw in _golden_frames():
+        b = TickBatch(1)
+        if not getattr(b, "append_" + kind)(raw):
+            lines.append(f"{kind} {raw.hex()} rejected")
+            continue
+        row = b[0].to_dict()
+        dt = row["datetime"]
+        date = "-" if kind == "gfex_l2" else dt.strftime("%Y%m%d")
+        time_us = ((dt.hour * 60 + dt.minute) * 60 + dt.second) * 1000000 + dt.microsecond
+        values = " ".join(repr(row[f]) for f in _GOLDEN_FIELDS)
+        lines.append(f"{kind} {raw.hex()} {row['symbol']} {date} {time_us} {values}")
+    return lines
+
+
+class TestTickBatch:
+    """纯 Python TickBatch / TickView 单元测试"""
+
+    @pytest.fixture
+    def batch(self):
+        b = TickBatch(4)
+        b.append_dict(_tick("rb2505", 3500.0))
+        b.append_dict(_tick("au2506", 520.0))
+        return b
+
+    def test_lazy_attributes(self, batch):
+        """测试视图按属性取值与 to_dict 物化"""
+        view = batch[1]
+        assert view.symbol == "au2506"
+        assert view.last_price == 520.0
+        assert view.to_dict() == _tick("au2506", 520.0)
+        assert batch[-1].symbol == "au2506"
+        with pytest.raises(IndexError):
+            batch[2]
+
+    def test_iteration_reuses_cursor_view(self, batch):
+        """测试迭代复用同一视图对象"""
+        views = [v for v in batch]
+        assert views[0] is views[1]
+        prices = [v.last_price for v in batch]
+        assert prices == [3500.0, 520.0]
+
+    def test_capacity(self, batch):
+        """测试批次已满时追加失败"""
+        assert batch.append_dict(_tick())
+        assert batch.append_dict(_tick())
+        assert batch.full
+        assert not batch.append_dict(_tick())
+        assert len(batch) == 4
+
+    def test_stale_after_clear(self, batch):
+        """测试 clear 后旧视图失效"""
+        view = batch[0]
+        batch.clear()
+        with pytest.raises(StaleTickViewError):
+            view.last_price
+
+    def test_swap_double_buffer(self, batch):
+        """测试 swap 交换内容且两边旧视图失效"""
+        spare = TickBatch(4)
+        view = batch[0]
+        batch.swap(spare)
+        assert len(batch) == 0 and len(spare) == 2
+        assert spare[0].symbol == "rb2505"
+        with pytest.raises(StaleTickViewError):
+            view.symbol
+
+    def test_append_gfex_l2(self):
+        """测试 GFEX L2 原始帧解码进批次"""
+        b = TickBatch(2)
+        assert b.append_gfex_l2(_gfex_frame())
+        v = b[0]
+        assert v.symbol == "lc2505"
+        assert v.exchange == "GFEX"
+        assert v.volume == 500
+        assert v.bid_price_1 == 79999.0 and v.ask_volume_1 == 20
+        assert v.datetime.time() == datetime.time(10, 15, 30, 250000)
+        assert not b.append_gfex_l2(b"short")
+
+    def test_append_dce_l1(self):
+        """测试 DCE L1 原始结构体解码进批次"""
+        q = DCEL1_Quotation()
+        q.Symbol = b"m2505"
+        q.TradeDate = 20250129
+        q.Time = 93000500
+        q.LastPrice = 2800.0
+        q.TotalVolume = 42
+        b = TickBatch(1)
+        assert b.append_dce_l1(bytes(q))
+        assert b[0].symbol == "m2505"
+        assert b[0].datetime == datetime.datetime(2025, 1, 29, 9, 30, 0, 500000)
+        assert not b.append_dce_l1(b"\x00" * 10)
+
+    def test_new_tick_batch_fallback(self):
+        """测试强制纯 Python 实现"""
+        assert isinstance(new_tick_batch(8, native=False), TickBatch)
+
+    def test_append_dict_rejects_incomplete(self):
+        """测试缺少合约或 datetime 的 dict 不占用槽位（与原生批次一致）"""
+        b = TickBatch(4)
+        assert not b.append_dict({k: v for k, v in _tick().items() if k != "datetime"})
+        assert not b.append_dict({k: v for k, v in _tick().items() if k not in ("symbol", "instrument_id")})
+        assert not b.append_dict(dict(_tick(), datetime="2025-01-29 09:30:00"))
+        assert len(b) == 0
+
+
+class TestDecoderGolden:
+    """原始帧解码黄金文件（原生检查程序 decoder_golden 以同一文件比对原生解码器）"""
+
+    def test_golden_matches_python_parsers(self):
+        """测试黄金文件与当前 Python 解析器输出一致（解析器变更后运行 python -m tests.test_tick_view 重新生成）"""
+        assert DECODER_GOLDEN.read_text().splitlines() == golden_lines()
+
+    def test_golden_covers_all_formats(self):
+        """测试黄金文件覆盖三种格式的正常帧与坏帧"""
+        lines = [line.split() for line in golden_lines()]
+        for kind in ("gfex_l2", "dce_l1", "czce_l1"):
+            assert any(f[0] == kind and f[2] == "rejected" for f in lines)
+            assert sum(f[0] == kind and f[2] != "rejected" for f in lines) >= 20
+
+
+class TestBatchDispatch:
+    """采集器批次接口与分发单元测试"""
+
+    def test_default_collect_batch_wraps_collect_data(self):
+        """测试基类 collect_batch 把 collect_data 结果装入批次"""
+
+        class _Collector(BaseFuturesCollector):
+            def init_connections(self):
+                return True
+
+            def subscribe_market(self):
+                return True
+
+            def collect_data(self):
+                return [_tick("rb2505"), _tick("au2506")]
+
+            def close_connections(self):
+                pass
+
+        batch = _Collector({"x": {"enable": True}}).collect_batch()
+        assert [v.symbol for v in batch] == ["rb2505", "au2506"]
+
+    def test_default_collect_batch_counts_dropped(self):
+        """测试基类 collect_batch 统计并记录无法装入批次的行情"""
+
+        class _Collector(BaseFuturesCollector):
+            def init_connections(self):
+                return True
+
+            def subscribe_market(self):
+                return True
+
+            def collect_data(self):
+                return [_tick("rb2505"), dict(_tick("au2506"), datetime=None), _tick("cu2505")]
+
+            def close_connections(self):
+                pass
+
+        collector = _Collector({"x": {"enable": True}})
+        batch = collector.collect_batch()
+        assert [v.symbol for v in batch] == ["rb2505", "cu2505"]
+        assert collector.batch_dropped == 1
+        collector.collect_batch()
+        assert collector.batch_dropped == 2
+
+    def test_batch_dispatch_requires_all_batch_sources(self):
+        """测试仅当所有行情源均为批次模式且未启用重排/优先级通道时按批次分发"""
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {"dispatch_interval": 0})
+        assert not collector.batch_dispatch
+        batched = GfexExanicApi("exanic0", tick_batch_capacity=4)
+        plain = GfexExanicApi("exanic0")
+        collector.collectors = [type("C", (), {"api": batched})()]
+        assert collector.batch_dispatch
+        collector.collectors.append(type("C", (), {"api": plain})())
+        assert not collector.batch_dispatch
+        reordered = AsyncFuturesCollector({"ctp": {"enable": True}}, {"reorder": {"enable": True}})
+        reordered.collectors = [type("C", (), {"api": batched})()]
+        assert not reordered.batch_dispatch
+
+    def test_gfex_swap_batch(self):
+        """测试 GFEX 批次模式双缓冲交换"""
+        api = GfexExanicApi("exanic0", tick_batch_capacity=4)
+        assert api.batch_mode
+        api._batch = new_tick_batch(4, native=False)
+        api._spare_batch = new_tick_batch(4, native=False)
+        api._batch.append_gfex_l2(_gfex_frame(b"lc2505"))
+        first = api.swap_batch()
+        assert [v.symbol for v in first] == ["lc2505"]
+        api._batch.append_gfex_l2(_gfex_frame(b"si2507"))
+        second = api.swap_batch()
+        assert [v.symbol for v in second] == ["si2507"]
+
+    def test_run_forever_batch_callback(self):
+        """测试 run_forever 向批次回调与 dict 回调分发同一批次"""
+        collector = AsyncFuturesCollector({"ctp": {"enable": True}}, {"dispatch_interval": 0})
+        batch = TickBatch(2)
+        batch.append_dict(_tick("rb2505"))
+        collector.collect_batches = lambda: [batch]
+        seen = {}
+
+        async def on_batch(b):
+            seen["batch"] = [v.last_price for v in b]
+
+        async def on_data(data_list):
+            seen["data"] = data_list
+            collector.stop()
+
+        asyncio.run(collector.run_forever(on_data, on_batch))
+        assert seen["batch"] == [3500.0]
+        assert seen["data"] == [_tick("rb2505")]
+
+
+if __name__ == "__main__":
+    DECODER_GOLDEN.parent.mkdir(exist_ok=True)
+    DECODER_GOLDEN.write_text("\n".join(golden_lines()) + "\n")
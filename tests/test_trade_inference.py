@@ -0,0 +1,165 @@
+# -*- coding: utf-8 -*-
+"""快照成交推断单元测试
+测试 TradeInference 的区间成交量/均价、报价/中间价/tick 规则方向判定、累计量回退与按交易日重置、
+乘数估计与配置，以及流水线 trades 阶段与边类型校验
+"""
+import datetime
+
+import pytest
+
+from src.processor.pipeline import Pipeline
+from src.processor.trade_inference import TradeInference, create_trade_inference, exchange_trading_day, product_of
+from src.utils.exceptions import ConfigError
+
+
+def _snap(seq, volume, turnover, last, bid=0.0, ask=0.0, iid=1, symbol="rb2505", day=29):
+    return {
+        "symbol": symbol,
+        "instrument_id": iid,
+        "exchange": "SHFE",
+        "last_price": last,
+        "volume": volume,
+        "turnover": turnover,
+        "datetime": datetime.datetime(2025, 1, day, 9, 30, 0, seq),
+        "bid_price_1": bid,
+        "ask_price_1": ask,
+    }
+
+
+class TestTradeInference:
+    """成交推断"""
+
+    def test_first_snapshot_is_baseline(self):
+        ti = TradeInference()
+        assert ti.infer([_snap(0, 100, 100 * 3500 * 10, 3500, 3499, 3501)]) == []
+
+    def test_quote_rule(self):
+        """成交价触及上一帧卖一为买方主动，触及买一为卖方主动"""
+        ti = TradeInference()
+        ti.set_multiplier(1, 10)
+        trades = ti.infer([
+            _snap(0, 100, 0.0, 3500, 3499, 3501),
+            _snap(1, 102, 2 * 3501 * 10, 3501, 3500, 3502),
+            _snap(2, 105, 2 * 3501 * 10 + 3 * 3500 * 10, 3500, 3499, 3501),
+        ])
+        assert [(t["volume"], t["price"], t["side"], t["rule"]) for t in trades] == [
+            (2, 3501.0, "B", "quote"),
+            (3, 3500.0, "S", "quote"),
+        ]
+        assert trades[0]["event"] == "trade"
+        assert trades[0]["bid_price_1"] == 3499 and trades[0]["ask_price_1"] == 3501
+
+    def test_mid_and_tick_rule(self):
+        """盘口内按中间价判定；恰在中间价时按 tick 规则，平价沿用上一笔方向"""
+        ti = TradeInference()
+        ti.set_multiplier(1, 1)
+        trades = ti.infer([
+            _snap(0, 0, 0.0, 100, 99, 103),
+            _snap(1, 1, 102.0, 102, 99, 103),    # 102 > 中间价 101
+            _snap(2, 2, 203.0, 101, 99, 103),    # 恰在中间价，比上一笔 102 低
+            _snap(3, 3, 304.0, 101, 99, 103),    # 平价，沿用卖方
+        ])
+        assert [(t["side"], t["rule"]) for t in trades] == [("B", "mid"), ("S", "tick"), ("S", "tick")]
+
+    def test_volume_rollback_resets(self):
+        """累计量回退或换日时只重建基准"""
+        ti = TradeInference()
+        ti.set_multiplier(1, 1)
+        trades = ti.infer([
+            _snap(0, 100, 10000.0, 100, 99, 101),
+            _snap(1, 5, 500.0, 100, 99, 101),
+            _snap(2, 6, 601.0, 101, 99, 101),
+            _snap(3, 10, 1001.0, 100, 99, 101, day=30),
+        ])
+        assert [(t["volume"], t["price"]) for t in trades] == [(1, 101.0)]
+
+    def test_night_session_keeps_trading_day(self):
+        """夜盘跨零点、周五夜盘到周一日盘同属一个交易日，不重建基准；新交易日的夜盘开盘才重置"""
+        ti = TradeInference()
+        ti.set_multiplier(1, 1)
+        stamps = [
+            (datetime.datetime(2025, 1, 30, 23, 59, 59), 100),  # 周四夜盘 -> 周五交易日
+            (datetime.datetime(2025, 1, 31, 0, 0, 1), 101),
+            (datetime.datetime(2025, 1, 31, 9, 0), 103),
+            (datetime.datetime(2025, 1, 31, 21, 0), 5),         # 周五夜盘 -> 下周一交易日
+            (datetime.datetime(2025, 2, 1, 0, 30), 6),
+            (datetime.datetime(2025, 2, 3, 9, 0), 8),
+        ]
+        trades = ti.infer([dict(_snap(0, v, 100.0 * v, 100, 99, 101), datetime=dt) for dt, v in stamps])
+        assert [t["volume"] for t in trades] == [1, 2, 1, 2]
+
+    def test_exchange_trading_day(self):
+        day = datetime.date
+        assert exchange_trading_day(datetime.datetime(2025, 1, 29, 14, 59)) == day(2025, 1, 29)
+        assert exchange_trading_day(datetime.datetime(2025, 1, 29, 21, 0)) == day(2025, 1, 30)
+        assert exchange_trading_day(datetime.datetime(2025, 1, 30, 1, 0)) == day(2025, 1, 30)
+        assert exchange_trading_day(datetime.datetime(2025, 1, 31, 21, 0)) == day(2025, 2, 3)
+        assert exchange_trading_day(datetime.datetime(2025, 2, 1, 2, 0)) == day(2025, 2, 3)
+
+    def test_estimates_multiplier(self):
+        ti = TradeInference()
+        ti.infer([
+            _snap(0, 10, 0.0, 3500, 3499, 3501),
+            _snap(1, 12, 2 * 3500.5 * 10, 3500, 3499, 3501),
+        ])
+        assert ti.multiplier(1) == 10
+
+    def test_independent_instruments(self):
+        ti = TradeInference()
+        trades = ti.infer([
+            _snap(0, 10, 0.0, 100, iid=1),
+            _snap(0, 50, 0.0, 200, iid=2, symbol="au2506"),
+            _snap(1, 11, 0.0, 100, iid=1),
+        ])
+        assert len(trades) == 1 and trades[0]["symbol"] == "rb2505" and trades[0]["volume"] == 1
+
+
+class TestFactory:
+    """配置工厂"""
+
+    def test_product_of(self):
+        assert product_of("rb2505") == "rb" and product_of("SR505") == "SR" and product_of("") == ""
+
+    def test_product_multipliers(self):
+        ti = create_trade_inference({"native": False, "multipliers": {"rb": 10}})
+        ti.infer([_snap(0, 10, 0.0, 3500, 3499, 3501)])
+        assert ti.multiplier(1) == 10
+
+
+class TestPipelineTradesStage:
+    """流水线 trades 阶段"""
+
+    def test_trades_stage(self, tmp_path):
+        pipe = Pipeline([
+            {"name": "trades", "type": "trades", "inputs": ["source"], "threads": 1, "native": False},
+            {"name": "store", "type": "file_storage", "inputs": ["trades"], "threads": 0,
+             "base_path": str(tmp_path)},
+        ]).start()
+        pipe.submit([_snap(0, 10, 0.0, 100, 99, 101), _snap(1, 12, 0.0, 101, 99, 101)])
+        pipe.close()
+        m = pipe.metrics()
+        assert m["trades"]["in"] == 2 and m["trades"]["out"] == 1
+        assert m["store"]["in"] == 1
+
+    def test_clean_rejects_trades(self):
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "trades", "type": "trades"},
+                {"name": "clean", "type": "clean", "inputs": ["trades"]},
+            ])
+
+    def test_passthrough_mixed_inputs(self):
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "trades", "type": "trades"},
+                {"name": "join", "type": "fanout", "inputs": ["source", "trades"]},
+            ])
+
+    def test_passthrough_keeps_type(self):
+        """透传阶段输出沿用上游类型：trades 之后的 filter 不能再接 trades"""
+        with pytest.raises(ConfigError):
+            Pipeline([
+                {"name": "trades", "type": "trades"},
+                {"name": "f", "type": "filter", "inputs": ["trades"]},
+                {"name": "again", "type": "trades", "inputs": ["f"]},
+            ])
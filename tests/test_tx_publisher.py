@@ -0,0 +1,198 @@
+# -*- coding: utf-8 -*-
+"""行情 TX 发布单元测试
+测试 UdpTickPublisher（纯 Python 实现，原生可用时同样覆盖）经软件帧环发送的帧结构、打包、
+合约过滤、发送时间戳与缓冲区满，以及 GfexExanicApi 在软件 RX/TX 替身上接收 L2 帧并转发
+"""
+import datetime
+import struct
+import threading
+import time
+from unittest.mock import patch
+
+import pytest
+
+from src.api import exanic_standin
+from src.api.exanic_standin import SoftFrameRing
+from src.api.gfex_exanic_api import _GFEX_L2_FMT, GfexExanicApi
+from src.api.tx_publisher import UdpTickPublisher, create_tx_publisher, decode_tick_frame
+from src.utils.exceptions import ConfigError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import make_tick
+
+TX = {"dst_ip": "239.1.1.7", "dst_port": 30001, "src_ip": "10.0.0.2"}
+
+
+def _tick(symbol, sec, volume):
+    return make_tick(symbol, sec * 1000 + 250, exchange="GFEX", last_price=10000.0 + sec, volume=volume,
+                     turnover=1.5e6, open_interest=321.0,
+                     bid_price_1=9999.0, bid_volume_1=3, ask_price_1=10001.0, ask_volume_1=4)
+
+
+def _rings():
+    rings = [SoftFrameRing]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "SoftFrameRing"):
+        rings.append(m.SoftFrameRing)
+    return rings
+
+
+def _drain(ring):
+    frames = []
+    while True:
+        frame = ring.receive_frame(2048)
+        if not frame:
+            return frames
+        frames.append(frame)
+
+
+@pytest.mark.parametrize("ring_cls", _rings())
+class TestUdpTickPublisher:
+    """紧凑 UDP 帧发布"""
+
+    def test_frame_roundtrip(self, ring_cls):
+        ring = ring_cls(64)
+        pub = create_tx_publisher(ring, TX)
+        assert pub.publish([_tick("lc2507", 1, 10)]) == 1
+        (frame,) = _drain(ring)
+        assert frame[:6] == bytes.fromhex("01005e010107")  # 组播 MAC 由 IP 推导
+        ip = frame[14:34]
+        assert sum(struct.unpack("!10H", ip)) % 0xFFFF == 0  # IP 头校验和
+        assert ip[12:16] == bytes([10, 0, 0, 2]) and ip[16:20] == bytes([239, 1, 1, 7])
+        seq, ticks = decode_tick_frame(frame, 30001)
+        assert seq == 1 and len(ticks) == 1
+        t = ticks[0]
+        expected = _tick("lc2507", 1, 10)
+        for key in expected:
+            assert t[key] == expected[key], key
+        assert decode_tick_frame(frame, 30002) == (0, [])
+
+    def test_ticks_per_frame(self, ring_cls):
+        ring = ring_cls(64)
+        pub = create_tx_publisher(ring, dict(TX, ticks_per_frame=2))
+        assert pub.publish([_tick("lc2507", s, s) for s in range(5)]) == 5
+        decoded = [decode_tick_frame(f) for f in _drain(ring)]
+        assert [seq for seq, _ in decoded] == [1, 2, 3]
+        assert [[t["volume"] for t in ticks] for _, ticks in decoded] == [[0, 1], [2, 3], [4]]
+        m = pub.metrics()
+        assert m["frames"] == 3 and m["ticks"] == 5 and m["seq"] == 3
+
+    def test_symbol_filter(self, ring_cls):
+        ring = ring_cls(64)
+        pub = create_tx_publisher(ring, dict(TX, symbols=["si2509"]))
+        bad = {"symbol": "si2509", "datetime": "2025-01-29 09:30:00"}
+        assert pub.publish([_tick("lc2507", 1, 1), _tick("si2509", 1, 2), bad]) == 1
+        (frame,) = _drain(ring)
+        assert [t["symbol"] for t in decode_tick_frame(frame)[1]] == ["si2509"]
+        assert pub.metrics()["filtered"] == 2
+
+    def test_tx_timestamps(self, ring_cls):
+        ring = ring_cls(64)
+        pub = create_tx_publisher(ring, TX)
+        before = time.monotonic_ns()
+        pub.publish([_tick("lc2507", 1, 1)])
+        pub.publish([_tick("lc2507", 2, 2)])
+        stamps = pub.tx_timestamps()
+        assert [seq for seq, _ in stamps] == [1, 2]
+        assert before <= stamps[0][1] < stamps[1][1] <= time.monotonic_ns()
+        assert stamps[1][1] == ring.get_tx_timestamp()
+        assert pub.tx_timestamps() == []
+        assert pub.metrics()["stamped"] == 2
+
+    def test_ring_full(self, ring_cls):
+        ring = ring_cls(2)
+        pub = create_tx_publisher(ring, TX)
+        assert pub.publish([_tick("lc2507", s, s) for s in range(3)]) == 2
+        assert pub.metrics()["errors"] == 1 and ring.dropped == 1
+
+
+class TestPublisherConfig:
+    """配置校验"""
+
+    def test_unicast_requires_mac(self):
+        with pytest.raises(ConfigError):
+            create_tx_publisher(SoftFrameRing(), {"dst_ip": "10.0.0.9"})
+        pub = create_tx_publisher(SoftFrameRing(), {"dst_ip": "10.0.0.9", "dst_mac": "02:00:00:00:00:09"})
+        assert pub.ticks_per_frame == 1
+
+    def test_python_fallback_without_tx_ops(self):
+        # 纯 Python 帧环不提供 tx_ops，即使原生可用也回退纯 Python 发布者
+        assert isinstance(create_tx_publisher(SoftFrameRing(), TX), UdpTickPublisher)
+
+
+def _gfex_frame(name, last_price, total_qty):
+    return struct.pack(
+        _GFEX_L2_FMT, 0, name.encode().ljust(20, b"\x00"), last_price, 1, total_qty, 1e6, 100, 0,
+        b"09:30:01.500".ljust(16, b"\x00"),
+        *([last_price - 5, 2] * 5), *([last_price + 5, 3] * 5), *([0] * 10),
+    )
+
+
+class TestGfexStandin:
+    """GfexExanicApi 在软件替身上接收并转发"""
+
+    def setup_method(self):
+        exanic_standin.reset()
+
+    def teardown_method(self):
+        exanic_standin.reset()
+
+    @staticmethod
+    def _wait_frames(wire, n, timeout=2.0):
+        frames = []
+        deadline = time.monotonic() + timeout
+        while len(frames) < n and time.monotonic() < deadline:
+            frames += wire.capture()
+            time.sleep(0.001)
+        return frames
+
+    @pytest.mark.parametrize("batch_capacity", [0, 64])
+    def test_republish(self, batch_capacity):
+        received = []
+        api = GfexExanicApi(
+            "exanic0", port_number=1, standin=True, tick_batch_capacity=batch_capacity,
+            tx_publisher=dict(TX, enable=True, symbols=["lc2507", "si2509"]),
+        )
+        wire = exanic_standin.port("exanic0", 1)
+        assert api.connect(received.append)
+        try:
+            for name, px, qty in (("lc2507", 75000.0, 10), ("ps2506", 50000.0, 3), ("si2509", 9000.0, 7)):
+                assert wire.inject(_gfex_frame(name, px, qty))
+            frames = self._wait_frames(wire, 2)
+        finally:
+            api.close()
+        ticks = [t for f in frames for t in decode_tick_frame(f, 30001)[1]]
+        assert [(t["symbol"], t["last_price"], t["volume"]) for t in ticks] == [
+            ("lc2507", 75000.0, 10), ("si2509", 9000.0, 7)]
+        assert ticks[0]["bid_price_1"] == 74995.0 and ticks[0]["ask_volume_1"] == 3
+        if batch_capacity == 0:
+            assert len(received) == 3
+        assert api.tx_metrics() is None  # close 后释放
+
+    def test_tx_disabled(self):
+        api = GfexExanicApi("exanic0", standin=True, tx_publisher={"enable": False})
+        assert api.connect(lambda msg: None)
+        assert api.tx_metrics() is None and api.tx_timestamps() == []
+        api.close()
+
+    def test_close_defers_release_until_receiver_exits(self):
+        """接收线程卡在回调里超过 join 超时：close 不立即释放缓冲区，线程退出后才释放"""
+        entered, gate = threading.Event(), threading.Event()
+
+        def stuck(msg):
+            entered.set()
+            gate.wait(10)
+
+        api = GfexExanicApi("exanic0", port_number=1, standin=True, tx_publisher=dict(TX, enable=True))
+        wire = exanic_standin.port("exanic0", 1)
+        with patch.object(exanic_standin, "release_rx_buffer") as rx_release, \
+                patch.object(exanic_standin, "release_tx_buffer") as tx_release:
+            assert api.connect(stuck)
+            assert wire.inject(_gfex_frame("lc2507", 75000.0, 10))
+            assert entered.wait(2)
+            api.close()
+            assert not rx_release.called and not tx_release.called
+            gate.set()
+            deadline = time.monotonic() + 2.0
+            while not rx_release.called and time.monotonic() < deadline:
+                time.sleep(0.01)
+            assert rx_release.call_count == 1 and tx_release.call_count == 1
@@ -0,0 +1,96 @@
+# -*- coding: utf-8 -*-
+"""空闲等待策略单元测试
+测试纯 Python WaitStrategy 各模式的阶段推进、notify 唤醒、耗时统计，以及配置工厂与 asyncio 版本
+"""
+import asyncio
+import threading
+import time
+
+import pytest
+
+from src.utils.exceptions import ConfigError
+from src.utils.wait_strategy import AsyncWaitStrategy, WaitStrategy, create_async_wait_strategy, create_wait_strategy
+
+
+class TestWaitPhases:
+    """各模式的阶段推进"""
+
+    def test_busy_spin(self):
+        w = WaitStrategy("busy_spin")
+        for _ in range(50):
+            w.idle()
+        s = w.stats()
+        assert s["spins"] == 50 and s["yields"] == 0 and s["parks"] == 0
+
+    def test_spin_yield(self):
+        w = WaitStrategy("spin_yield", spin_iters=5)
+        for _ in range(12):
+            w.idle()
+        s = w.stats()
+        assert s["spins"] == 5 and s["yields"] == 7 and s["parks"] == 0
+
+    def test_spin_park_escalates_and_reset(self):
+        w = WaitStrategy("spin_park", spin_iters=3, yield_iters=2, park_timeout=0.001)
+        for _ in range(7):
+            w.idle()
+        s = w.stats()
+        assert (s["spins"], s["yields"], s["parks"]) == (3, 2, 2)
+        assert s["park_time"] >= 0.0015
+        # 取到数据后回到自旋阶段
+        w.reset()
+        w.idle()
+        assert w.stats()["spins"] == 4
+
+    def test_timed_block(self):
+        w = WaitStrategy("timed_block", block_timeout=0.002)
+        t0 = time.perf_counter()
+        w.idle()
+        assert time.perf_counter() - t0 >= 0.0015
+        assert w.stats()["parks"] == 1
+
+
+class TestNotify:
+    """notify 提前唤醒休眠中的消费者"""
+
+    def test_notify_wakes_parked(self):
+        w = WaitStrategy("timed_block", block_timeout=5.0)
+        threading.Timer(0.02, w.notify).start()
+        t0 = time.perf_counter()
+        w.idle()
+        assert time.perf_counter() - t0 < 2.0
+        s = w.stats()
+        assert s["wakeups"] == 1 and s["parks"] == 1
+
+
+class TestFactory:
+    """配置工厂"""
+
+    def test_defaults_and_override(self):
+        w = create_wait_strategy(None, defaults={"mode": "timed_block", "block_timeout": 0.0001})
+        assert w.mode == "timed_block"
+        w = create_wait_strategy({"mode": "spin_yield", "spin_iters": 10},
+                                 defaults={"mode": "timed_block"})
+        assert w.mode == "spin_yield"
+        assert w.stats()["mode"] == "spin_yield"
+
+    def test_unknown_mode(self):
+        with pytest.raises(ConfigError):
+            create_wait_strategy({"mode": "nap"})
+        with pytest.raises(ConfigError):
+            WaitStrategy("nap")
+
+
+class TestAsyncWaitStrategy:
+    """asyncio 接收循环用的等待策略"""
+
+    def test_phases(self):
+        w = create_async_wait_strategy({"mode": "spin_park", "spin_iters": 2, "yield_iters": 1,
+                                        "park_timeout": 0.001})
+        assert isinstance(w, AsyncWaitStrategy)
+
+        async def run():
+            for _ in range(5):
+                await w.idle()
+        asyncio.run(run())
+        s = w.stats()
+        assert (s["spins"], s["yields"], s["parks"]) == (2, 1, 2)
@@ -0,0 +1,248 @@
+# -*- coding: utf-8 -*-
+"""看板 WebSocket 推送单元测试
+测试 WsFanoutServer（纯 Python 实现，原生可用时同样覆盖）的握手与查询参数订阅、按客户端合并
+（只推送最新值）、未知合约的待解析订阅、binary 载荷与 TX 发布格式一致、文本命令与错误回复、慢客户端不阻塞写表、ping 洪泛断开，
+以及流水线 ws_fanout 阶段与单线程校验
+"""
+import base64
+import datetime
+import hashlib
+import json
+import os
+import socket
+import struct
+import time
+
+import pytest
+
+from src.api.tx_publisher import decode_wire_payload
+from src.api.ws_fanout import WS_GUID, WsFanoutServer, create_ws_fanout
+from src.processor.pipeline import Pipeline
+from src.processor.symbol_table import get_symbol_table
+from src.utils.exceptions import ConfigError, StorageError
+from src.utils.native_loader import get_native_pybind
+from tests.conftest import BASE_TIME, make_tick
+
+
+
+def _tick(ms, symbol, last, volume=1):
+    return make_tick(symbol, ms, instrument_id=get_symbol_table().intern(symbol), last_price=last, volume=volume,
+                     turnover=last * volume * 10, open_interest=1000.0,
+                     bid_price_1=last - 1, bid_volume_1=3, ask_price_1=last + 1, ask_volume_1=4)
+
+
+def _servers():
+    servers = [WsFanoutServer]
+    m = get_native_pybind()
+    if m is not None and hasattr(m, "WsFanoutServer"):
+        servers.append(m.WsFanoutServer)
+    return servers
+
+
+class _Client:
+    """最小 WebSocket 客户端（阻塞 socket，带超时）"""
+
+    def __init__(self, port, path="/", rcvbuf=0):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.sock.settimeout(5)
+        if rcvbuf:
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, rcvbuf)
+        self.sock.connect(("127.0.0.1", port))
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall((
+            f"GET {path} HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n"
+        ).encode())
+        buf = b""
+        while b"\r\n\r\n" not in buf:
+            buf += self.sock.recv(4096)
+        self.head, self.buf = buf.split(b"\r\n\r\n", 1)
+        self.accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+
+    def send(self, text, op=0x1):
+        data = text.encode()
+        mask = os.urandom(4)
+        self.sock.sendall(bytes([0x80 | op, 0x80 | len(data)]) + mask
+                          + bytes(b ^ mask[i % 4] for i, b in enumerate(data)))
+
+    def recv(self):
+        while True:
+            if len(self.buf) >= 2:
+                n, h = self.buf[1] & 0x7F, 2
+                if n == 126 and len(self.buf) >= 4:
+                    n, h = struct.unpack_from("!H", self.buf, 2)[0], 4
+                elif n == 127 and len(self.buf) >= 10:
+                    n, h = struct.unpack_from("!Q", self.buf, 2)[0], 10
+                if n < 126 or h > 2:
+                    if len(self.buf) >= h + n:
+                        op, payload = self.buf[0] & 0x0F, self.buf[h:h + n]
+                        self.buf = self.buf[h + n:]
+                        return op, payload
+            data = self.sock.recv(65536)
+            if not data:
+                raise EOFError
+            self.buf += data
+
+    def recv_json(self):
+        op, payload = self.recv()
+        assert op == 0x1
+        return json.loads(payload)
+
+    def close(self):
+        self.sock.close()
+
+
+def _wait(cond, timeout=3.0):
+    deadline = time.time() + timeout
+    while not cond():
+        assert time.time() < deadline
+        time.sleep(0.01)
+
+
+@pytest.fixture(params=_servers())
+def server(request):
+    srv = request.param(port=0, rate=20.0, max_rate=100.0, max_clients=4)
+    srv.start()
+    yield srv
+    srv.stop()
+
+
+class TestWsFanoutServer:
+    """握手、订阅与合并推送"""
+
+    def test_handshake_and_conflation(self, server):
+        assert server.running and server.port > 0
+        c = _Client(server.port, "/?symbols=wsa2505,wsb2505&rate=50")
+        assert c.head.startswith(b"HTTP/1.1 101") and c.accept.encode() in c.head
+        _wait(lambda: server.stats()["clients"] == 1)
+        # 两轮推送之间多次更新，只推送最新值；未订阅合约不推送
+        server.publish([_tick(i, "wsa2505", 100.0 + i) for i in range(50)] + [_tick(0, "wsz2505", 1.0)])
+        msg = c.recv_json()
+        assert msg["seq"] == 1
+        assert [t["symbol"] for t in msg["ticks"]] == ["wsa2505"]
+        tick = msg["ticks"][0]
+        assert list(tick) == [
+            "symbol", "exchange", "datetime", "last_price", "volume", "turnover", "open_interest",
+            "bid_price_1", "bid_volume_1", "ask_price_1", "ask_volume_1",
+        ]
+        assert tick["last_price"] == 149.0 and tick["datetime"] == "2025-01-29T09:30:00.049000"
+        assert tick["turnover"] == 1490.0 and tick["ask_volume_1"] == 4
+        server.publish([_tick(60, "wsb2505", 7.5)])
+        msg = c.recv_json()
+        assert msg["seq"] == 2 and [t["last_price"] for t in msg["ticks"]] == [7.5]
+        c.close()
+        _wait(lambda: server.stats()["clients"] == 0)
+
+    def test_binary_and_commands(self, server):
+        server.publish([_tick(0, "wsc2505", 200.0)])
+        c = _Client(server.port)
+        c.send("bogus")
+        op, payload = c.recv()
+        assert op == 0x1 and json.loads(payload) == {"error": "unknown command"}
+        c.send("format binary")
+        c.send("subscribe wsc2505")
+        op, payload = c.recv()
+        assert op == 0x2
+        seq, ticks = decode_wire_payload(payload)
+        assert seq == 1 and len(ticks) == 1
+        assert ticks[0]["symbol"] == "wsc2505" and ticks[0]["last_price"] == 200.0
+        assert ticks[0]["datetime"] == BASE_TIME
+        # 取消订阅后不再推送；ping 仍回 pong
+        c.send("unsubscribe wsc2505")
+        time.sleep(0.1)
+        server.publish([_tick(10, "wsc2505", 201.0)])
+        c.send("hi", op=0x9)
+        op, payload = c.recv()
+        assert (op, payload) == (0xA, b"hi")
+        c.close()
+
+    def test_unknown_symbols_pending(self, server):
+        """订阅尚未出现的合约不登记进符号表；合约出现后自动推送，待解析个数有上限"""
+        table = get_symbol_table()
+        c = _Client(server.port, "/?rate=50")
+        before = len(table)
+        c.send("subscribe wse2505 " + " ".join(f"wsjunk{i}" for i in range(10)))
+        time.sleep(0.1)
+        assert len(table) == before and table.find("wse2505") < 0
+        server.publish([_tick(0, "wse2505", 300.0)])
+        msg = c.recv_json()
+        assert [t["symbol"] for t in msg["ticks"]] == ["wse2505"]
+        for k in range(0, 300, 6):
+            c.send("subscribe " + " ".join(f"wsflood{i}" for i in range(k, k + 6)))
+        op, payload = c.recv()
+        assert op == 0x1 and json.loads(payload) == {"error": "too many pending symbols"}
+        assert len(table) == before + 1
+        c.close()
+
+    def test_subscribe_all_and_slow_client(self, server):
+        slow = _Client(server.port, "/?symbols=*&rate=100")  # 从不读取
+        fast = _Client(server.port, "/?symbols=*&rate=100")
+        _wait(lambda: server.stats()["clients"] == 2)
+        symbols = [f"wsd{i:04d}" for i in range(300)]
+        start = time.time()
+        for k in range(40):
+            server.publish([_tick(k, s, 100.0 + k) for s in symbols])
+            time.sleep(0.01)
+        # 写表与客户端快慢无关
+        assert time.time() - start < 3.0
+        latest = {}
+        while True:
+            for t in fast.recv_json()["ticks"]:
+                latest[t["symbol"]] = t["last_price"]
+            if len(latest) == len(symbols) and all(v == 139.0 for v in latest.values()):
+                break
+        stats = server.stats()
+        assert stats["messages"] >= 2 and stats["ticks"] >= len(symbols)
+        slow.close()
+        fast.close()
+
+    def test_ping_flood_disconnects(self, server):
+        """只发 ping 不读的客户端：pong 积压有界，超过即断开，其他客户端照常推送"""
+        flood = _Client(server.port, rcvbuf=4096)
+        other = _Client(server.port, "/?symbols=wsf2505&rate=100")
+        _wait(lambda: server.stats()["clients"] == 2)
+        flood.sock.settimeout(0.5)
+        deadline = time.time() + 10.0
+        try:
+            while server.stats()["clients"] == 2 and time.time() < deadline:
+                flood.send("p" * 125, op=0x9)
+        except OSError:
+            pass  # 服务端已断开
+        _wait(lambda: server.stats()["clients"] == 1)
+        server.publish([_tick(0, "wsf2505", 101.0)])
+        assert other.recv_json()["ticks"][0]["last_price"] == 101.0
+        flood.close()
+        other.close()
+
+    def test_max_clients(self, server):
+        clients = [_Client(server.port) for _ in range(4)]
+        _wait(lambda: server.stats()["clients"] == 4)
+        extra = socket.create_connection(("127.0.0.1", server.port), timeout=5)
+        assert extra.recv(16) == b""
+        _wait(lambda: server.stats()["rejected"] >= 1)
+        for c in clients + [extra]:
+            c.close()
+
+
+class TestWsFanoutStage:
+    """配置与流水线阶段"""
+
+    def test_pipeline_stage(self):
+        received = []
+        pipeline = Pipeline([
+            {"name": "ws", "type": "ws_fanout", "threads": 0, "native": False, "port": 0, "rate": 50},
+            {"name": "sink", "type": "python", "inputs": ["ws"], "threads": 0,
+             "callable": "tests.test_alerts:collect_factory", "received": received},
+        ]).start()
+        ticks = [_tick(0, "wse2505", 10.0)]
+        pipeline.submit(ticks)
+        pipeline.close()
+        assert received == ticks
+
+    def test_config_errors(self):
+        with pytest.raises(ConfigError):
+            Pipeline([{"name": "ws", "type": "ws_fanout", "threads": 2}])
+        with pytest.raises(ConfigError):
+            create_ws_fanout({"format": "xml", "native": False})
+        with pytest.raises(StorageError):
+            create_ws_fanout({"host": "not-an-ip", "port": 0, "native": False})